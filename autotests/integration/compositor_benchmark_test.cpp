@@ -0,0 +1,404 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "composite.h"
+#include "core/output.h"
+#include "core/outputbackend.h"
+#include "core/renderbackend.h"
+#include "core/renderloop.h"
+#include "core/renderloop_p.h"
+#include "cursor.h"
+#include "effectloader.h"
+#include "effects.h"
+#include "internalwindow.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <KWayland/Client/surface.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QRasterWindow>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Every operator new call in the process is counted, the compositor and the test clients alike.
+static std::atomic<quint64> s_allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_compositor_benchmark-0");
+
+/**
+ * The FrameRecorder class records the timings of the frames presented on an output while it
+ * is alive: the time the compositor spent on the CPU, the time it took until the GPU was done
+ * as well, and the number of allocations made since the previous frame.
+ */
+class FrameRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameRecorder(Output *output)
+        : m_renderLoop(output->renderLoop())
+        , m_allocationCount(s_allocationCount.load(std::memory_order_relaxed))
+    {
+        connect(m_renderLoop, &RenderLoop::framePresented, this, &FrameRecorder::record);
+    }
+
+    int frameCount() const
+    {
+        return m_frames.count();
+    }
+
+    /**
+     * Waits until @a count more frames have been presented, something must schedule repaints.
+     */
+    bool waitForFrames(int count)
+    {
+        const int target = m_frames.count() + count;
+        QSignalSpy framePresentedSpy(m_renderLoop, &RenderLoop::framePresented);
+        while (m_frames.count() < target) {
+            if (!framePresentedSpy.wait()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    qreal averageCpuTime() const
+    {
+        if (m_frames.isEmpty()) {
+            return 0;
+        }
+        std::chrono::nanoseconds total = std::chrono::nanoseconds::zero();
+        for (const Frame &frame : m_frames) {
+            total += frame.cpuTime;
+        }
+        return std::chrono::duration<qreal, std::milli>(total).count() / m_frames.count();
+    }
+
+    QJsonObject toJson(const QString &scenario) const
+    {
+        QJsonArray frames;
+        for (const Frame &frame : m_frames) {
+            frames.append(QJsonObject{
+                {QStringLiteral("cpuTime"), qint64(frame.cpuTime.count())},
+                {QStringLiteral("renderTime"), qint64(frame.renderTime.count())},
+                {QStringLiteral("allocations"), qint64(frame.allocations)},
+            });
+        }
+        return QJsonObject{
+            {QStringLiteral("scenario"), scenario},
+            {QStringLiteral("frames"), frames},
+        };
+    }
+
+private:
+    void record()
+    {
+        const RenderLoopPrivate *renderLoopPrivate = RenderLoopPrivate::get(m_renderLoop);
+        const quint64 allocationCount = s_allocationCount.load(std::memory_order_relaxed);
+        m_frames.append(Frame{
+            .cpuTime = renderLoopPrivate->lastCpuRenderTime,
+            .renderTime = renderLoopPrivate->lastRenderTime,
+            .allocations = allocationCount - m_allocationCount,
+        });
+        m_allocationCount = allocationCount;
+    }
+
+    struct Frame
+    {
+        std::chrono::nanoseconds cpuTime;
+        std::chrono::nanoseconds renderTime;
+        quint64 allocations;
+    };
+
+    RenderLoop *m_renderLoop;
+    quint64 m_allocationCount;
+    QList<Frame> m_frames;
+};
+
+class BlurredWindow : public QRasterWindow
+{
+    Q_OBJECT
+
+public:
+    BlurredWindow()
+    {
+        setFlags(Qt::FramelessWindowHint);
+        // an empty region blurs behind the whole window
+        setProperty("kwin_blur", QVariant::fromValue(QRegion()));
+    }
+
+protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        QPainter painter(this);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(0, 0, width(), height(), QColor(255, 255, 255, 128));
+    }
+};
+
+/**
+ * Runs a few typical scenarios on the virtual backend and reports the timings of the frames.
+ *
+ * The average time the compositor spent on the CPU per frame is reported as the benchmark
+ * result of each scenario. If the KWIN_BENCHMARK_OUTPUT environment variable is set, the
+ * timings of every frame are written to the file it names as JSON.
+ */
+class CompositorBenchmarkTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+    void benchmarkOpenWindows();
+    void benchmarkOverview();
+    void benchmarkBlur();
+    void benchmarkInteractiveResize();
+
+private:
+    void report(const FrameRecorder &recorder, const QString &scenario);
+
+    QJsonArray m_results;
+};
+
+void CompositorBenchmarkTest::initTestCase()
+{
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(waylandServer()->init(s_socketName));
+    QMetaObject::invokeMethod(kwinApp()->outputBackend(), "setVirtualOutputs", Qt::DirectConnection, Q_ARG(QVector<QRect>, QVector<QRect>() << QRect(0, 0, 1280, 1024)));
+
+    // only the effects a scenario loads should be measured
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    const auto builtinNames = EffectLoader().listOfKnownEffects();
+    for (const QString &name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    qputenv("KWIN_EFFECTS_FORCE_ANIMATIONS", QByteArrayLiteral("1"));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QCOMPARE(Compositor::self()->backend()->compositingType(), KWin::OpenGLCompositing);
+}
+
+void CompositorBenchmarkTest::cleanupTestCase()
+{
+    const QString fileName = qEnvironmentVariable("KWIN_BENCHMARK_OUTPUT");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QJsonDocument(QJsonObject{{QStringLiteral("scenarios"), m_results}}).toJson());
+}
+
+void CompositorBenchmarkTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+    workspace()->setActiveOutput(QPoint(640, 512));
+    Cursors::self()->mouse()->setPos(QPoint(640, 512));
+}
+
+void CompositorBenchmarkTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+
+    auto effectsImpl = static_cast<EffectsHandlerImpl *>(effects);
+    effectsImpl->unloadAllEffects();
+    QVERIFY(effectsImpl->loadedEffects().isEmpty());
+}
+
+void CompositorBenchmarkTest::report(const FrameRecorder &recorder, const QString &scenario)
+{
+    m_results.append(recorder.toJson(scenario));
+    QTest::setBenchmarkResult(recorder.averageCpuTime(), QTest::WalltimeMilliseconds);
+}
+
+void CompositorBenchmarkTest::benchmarkOpenWindows()
+{
+    // this test measures the frames while a bunch of windows are opened and closed one by one
+    const int windowCount = 20;
+    FrameRecorder recorder(workspace()->activeOutput());
+
+    std::vector<std::unique_ptr<KWayland::Client::Surface>> surfaces;
+    std::vector<std::unique_ptr<Test::XdgToplevel>> shellSurfaces;
+    QList<Window *> windows;
+    for (int i = 0; i < windowCount; ++i) {
+        surfaces.emplace_back(Test::createSurface());
+        shellSurfaces.emplace_back(Test::createXdgToplevelSurface(surfaces.back().get()));
+        Window *window = Test::renderAndWaitForShown(surfaces.back().get(), QSize(400, 300), Qt::blue);
+        QVERIFY(window);
+        windows.append(window);
+    }
+
+    for (int i = windowCount - 1; i >= 0; --i) {
+        shellSurfaces[i].reset();
+        surfaces[i].reset();
+        QVERIFY(Test::waitForWindowClosed(windows[i]));
+    }
+
+    QVERIFY(recorder.frameCount() > 0);
+    report(recorder, QStringLiteral("open-windows"));
+}
+
+void CompositorBenchmarkTest::benchmarkOverview()
+{
+    // this test measures the frames while the overview is opened and closed
+    auto effectsImpl = static_cast<EffectsHandlerImpl *>(effects);
+    if (!effectsImpl->loadEffect(QStringLiteral("overview"))) {
+        QSKIP("The overview effect is not available");
+    }
+    Effect *overview = effectsImpl->findEffect(QStringLiteral("overview"));
+    QVERIFY(overview);
+
+    std::vector<std::unique_ptr<KWayland::Client::Surface>> surfaces;
+    std::vector<std::unique_ptr<Test::XdgToplevel>> shellSurfaces;
+    for (int i = 0; i < 5; ++i) {
+        surfaces.emplace_back(Test::createSurface());
+        shellSurfaces.emplace_back(Test::createXdgToplevelSurface(surfaces.back().get()));
+        QVERIFY(Test::renderAndWaitForShown(surfaces.back().get(), QSize(400, 300), Qt::blue));
+    }
+
+    FrameRecorder recorder(workspace()->activeOutput());
+    QVERIFY(QMetaObject::invokeMethod(overview, "toggle"));
+    QTRY_VERIFY(effectsImpl->activeFullScreenEffect());
+    QVERIFY(recorder.waitForFrames(30));
+    QVERIFY(QMetaObject::invokeMethod(overview, "toggle"));
+    QTRY_VERIFY(!effectsImpl->activeFullScreenEffect());
+
+    report(recorder, QStringLiteral("overview"));
+}
+
+void CompositorBenchmarkTest::benchmarkBlur()
+{
+    // this test measures the frames while a blurred window moves over other windows
+    auto effectsImpl = static_cast<EffectsHandlerImpl *>(effects);
+    if (!effectsImpl->loadEffect(QStringLiteral("blur"))) {
+        QSKIP("The blur effect is not supported");
+    }
+
+    std::vector<std::unique_ptr<KWayland::Client::Surface>> surfaces;
+    std::vector<std::unique_ptr<Test::XdgToplevel>> shellSurfaces;
+    for (int i = 0; i < 5; ++i) {
+        surfaces.emplace_back(Test::createSurface());
+        shellSurfaces.emplace_back(Test::createXdgToplevelSurface(surfaces.back().get()));
+        QVERIFY(Test::renderAndWaitForShown(surfaces.back().get(), QSize(400, 300), QColor::fromHsv(i * 60, 255, 255)));
+    }
+
+    QSignalSpy windowAddedSpy(workspace(), &Workspace::windowAdded);
+    BlurredWindow blurredWindow;
+    blurredWindow.setGeometry(0, 0, 300, 200);
+    blurredWindow.show();
+    QTRY_COMPARE(windowAddedSpy.count(), 1);
+    auto window = windowAddedSpy.first().first().value<InternalWindow *>();
+    QVERIFY(window);
+
+    FrameRecorder recorder(workspace()->activeOutput());
+    for (int i = 0; i < 60; ++i) {
+        window->move(QPointF(i * 10, i * 5));
+        QVERIFY(recorder.waitForFrames(1));
+    }
+
+    report(recorder, QStringLiteral("blur"));
+}
+
+void CompositorBenchmarkTest::benchmarkInteractiveResize()
+{
+    // this test measures the frames while a window is being resized interactively
+    std::unique_ptr<KWayland::Client::Surface> surface(Test::createSurface());
+    std::unique_ptr<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.get()));
+    Window *window = Test::renderAndWaitForShown(surface.get(), QSize(400, 300), Qt::blue);
+    QVERIFY(window);
+    QCOMPARE(workspace()->activeWindow(), window);
+
+    QSignalSpy surfaceConfigureRequestedSpy(shellSurface->xdgSurface(), &Test::XdgSurface::configureRequested);
+    QSignalSpy toplevelConfigureRequestedSpy(shellSurface.get(), &Test::XdgToplevel::configureRequested);
+    QSignalSpy frameGeometryChangedSpy(window, &Window::frameGeometryChanged);
+
+    workspace()->slotWindowResize();
+    QCOMPARE(workspace()->moveResizeWindow(), window);
+    QVERIFY(surfaceConfigureRequestedSpy.wait());
+
+    FrameRecorder recorder(workspace()->activeOutput());
+    for (int i = 0; i < 30; ++i) {
+        window->keyPressEvent(i % 2 ? Qt::Key_Down : Qt::Key_Right);
+        window->updateInteractiveMoveResize(Cursors::self()->mouse()->pos());
+        QVERIFY(surfaceConfigureRequestedSpy.wait());
+
+        shellSurface->xdgSurface()->ack_configure(surfaceConfigureRequestedSpy.last().at(0).value<quint32>());
+        Test::render(surface.get(), toplevelConfigureRequestedSpy.last().at(0).toSize(), Qt::blue);
+        QVERIFY(frameGeometryChangedSpy.wait());
+        QVERIFY(recorder.waitForFrames(1));
+    }
+
+    window->keyPressEvent(Qt::Key_Enter);
+    QCOMPARE(workspace()->moveResizeWindow(), nullptr);
+
+    report(recorder, QStringLiteral("interactive-resize"));
+
+    shellSurface.reset();
+    QVERIFY(Test::waitForWindowClosed(window));
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::CompositorBenchmarkTest)
+#include "compositor_benchmark_test.moc"
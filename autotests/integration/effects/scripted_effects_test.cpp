@@ -64,6 +64,7 @@ private Q_SLOTS:
     void testRedirect_data();
     void testRedirect();
     void testComplete();
+    void testRegisterAnimation();
 
 private:
     ScriptedEffect *loadEffect(const QString &name);
@@ -749,5 +750,52 @@ void ScriptedEffectsTest::testComplete()
     }
 }
 
+void ScriptedEffectsTest::testRegisterAnimation()
+{
+    // this test verifies that registered animations are started without calling into the script
+
+    auto effect = new ScriptedEffectWithDebugSpy;
+    QSignalSpy effectOutputSpy(effect, &ScriptedEffectWithDebugSpy::testOutput);
+    QVERIFY(effect->load(QStringLiteral("registerAnimationTest")));
+    QCOMPARE(effectOutputSpy.count(), 1);
+    QCOMPARE(effectOutputSpy.first().first(), QStringLiteral("1"));
+
+    // the scale and opacity animations are started when the window is added
+    std::unique_ptr<KWayland::Client::Surface> surface = Test::createSurface();
+    Test::XdgToplevel *shellSurface = Test::createXdgToplevelSurface(surface.get(), surface.get());
+    QVERIFY(shellSurface);
+    Window *window = Test::renderAndWaitForShown(surface.get(), QSize(100, 50), Qt::blue);
+    QVERIFY(window);
+    {
+        const auto state = effect->state();
+        QCOMPARE(state.count(), 1);
+        QCOMPARE(state.firstKey(), window->effectWindow());
+        const QList<AniData> animations = state.first().first;
+        QCOMPARE(animations.count(), 2);
+        QCOMPARE(animations[0].attribute, AnimationEffect::Scale);
+        QCOMPARE(animations[0].from, FPx2(0.2));
+        QCOMPARE(animations[0].to, FPx2(1.4));
+        QCOMPARE(animations[0].timeLine.duration(), 100ms);
+        QCOMPARE(animations[0].timeLine.easingCurve().type(), QEasingCurve::OutCubic);
+        QCOMPARE(animations[1].attribute, AnimationEffect::Opacity);
+        QCOMPARE(animations[1].from, FPx2(0.0));
+        QCOMPARE(animations[1].to, FPx2(1.0));
+        QCOMPARE(animations[1].timeLine.duration(), 100ms);
+    }
+    QTRY_COMPARE(effect->state().count(), 0);
+
+    // the script unregisters the animations when the window is minimized
+    window->setMinimized(true);
+    QCOMPARE(effectOutputSpy.count(), 2);
+    QCOMPARE(effectOutputSpy.last().first(), QStringLiteral("true"));
+
+    std::unique_ptr<KWayland::Client::Surface> otherSurface = Test::createSurface();
+    Test::XdgToplevel *otherShellSurface = Test::createXdgToplevelSurface(otherSurface.get(), otherSurface.get());
+    QVERIFY(otherShellSurface);
+    Window *otherWindow = Test::renderAndWaitForShown(otherSurface.get(), QSize(100, 50), Qt::blue);
+    QVERIFY(otherWindow);
+    QCOMPARE(effect->state().count(), 0);
+}
+
 WAYLANDTEST_MAIN(ScriptedEffectsTest)
 #include "scripted_effects_test.moc"
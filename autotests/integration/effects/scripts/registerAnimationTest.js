@@ -0,0 +1,24 @@
+"use strict";
+
+const id = effect.registerAnimation("windowAdded", {
+    windowFilter: ["normalWindow"],
+    duration: 100,
+    curve: QEasingCurve.OutCubic,
+    animations: [
+        {
+            type: Effect.Scale,
+            from: 0.2,
+            to: 1.4
+        },
+        {
+            type: Effect.Opacity,
+            from: 0.0,
+            to: 1.0
+        }
+    ]
+});
+sendTestResponse(id);
+
+effects.windowMinimized.connect(function (window) {
+    sendTestResponse(effect.unregisterAnimation(id));
+});
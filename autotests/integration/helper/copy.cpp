@@ -12,6 +12,9 @@
 #include <QRasterWindow>
 #include <QTimer>
 
+// the text that is copied, it can be made larger by passing its size in bytes as argument
+static QString s_text = QStringLiteral("test");
+
 class Window : public QRasterWindow
 {
     Q_OBJECT
@@ -42,13 +45,16 @@ void Window::focusInEvent(QFocusEvent *event)
     QRasterWindow::focusInEvent(event);
     // TODO: make it work without singleshot
     QTimer::singleShot(100, [] {
-        qApp->clipboard()->setText(QStringLiteral("test"));
+        qApp->clipboard()->setText(s_text);
     });
 }
 
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
+    if (argc > 1) {
+        s_text = QString(QString::fromLocal8Bit(argv[1]).toInt(), QLatin1Char('x'));
+    }
     std::unique_ptr<Window> w(new Window);
     w->setGeometry(QRect(0, 0, 100, 200));
     w->show();
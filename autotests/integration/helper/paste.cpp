@@ -7,6 +7,8 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include <QClipboard>
+#include <QDebug>
+#include <QElapsedTimer>
 #include <QGuiApplication>
 #include <QPainter>
 #include <QRasterWindow>
@@ -39,16 +41,26 @@ void Window::paintEvent(QPaintEvent *event)
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
+    // the text that is expected, see the copy helper
+    QString expected = QStringLiteral("test");
+    if (argc > 1) {
+        expected = QString(QString::fromLocal8Bit(argv[1]).toInt(), QLatin1Char('x'));
+    }
     QObject::connect(app.clipboard(), &QClipboard::changed, &app,
-                     [] {
-                         if (qApp->clipboard()->text() == QLatin1String("test")) {
+                     [expected] {
+                         QElapsedTimer timer;
+                         timer.start();
+                         const QString text = qApp->clipboard()->text();
+                         if (text == expected) {
+                             const qint64 elapsed = std::max<qint64>(timer.elapsed(), 1);
+                             qInfo() << "Received" << text.size() << "bytes in" << elapsed << "ms,"
+                                     << (text.size() / 1024.0 / 1024.0) / (elapsed / 1000.0) << "MiB/s";
                              QTimer::singleShot(100, qApp, &QCoreApplication::quit);
                          }
                      });
     std::unique_ptr<Window> w(new Window);
     w->setGeometry(QRect(0, 0, 100, 200));
     w->show();
-
     return app.exec();
 }
 
@@ -674,6 +674,19 @@ void InputMethodTest::testFakeEventFallback()
 
     keySpy.clear();
 
+    // Several characters can be committed at once, every one of them is typed
+    // separately, even if it's the same key.
+    zwp_input_method_context_v1_commit_string(context, 0, "aa");
+
+    QTRY_COMPARE(keySpy.count(), 4);
+
+    compare(keySpy.at(0), KEY_A, KWayland::Client::Keyboard::KeyState::Pressed);
+    compare(keySpy.at(1), KEY_A, KWayland::Client::Keyboard::KeyState::Released);
+    compare(keySpy.at(2), KEY_A, KWayland::Client::Keyboard::KeyState::Pressed);
+    compare(keySpy.at(3), KEY_A, KWayland::Client::Keyboard::KeyState::Released);
+
+    keySpy.clear();
+
     // Special keys are not sent through commit_string but instead use keysym.
     auto enter = input()->keyboard()->xkb()->toKeysym(KEY_ENTER);
     zwp_input_method_context_v1_keysym(context, 0, 0, enter, uint32_t(KWaylandServer::KeyboardKeyState::Pressed), 0);
@@ -0,0 +1,146 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "core/outputbackend.h"
+#include "scripting/scripting.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KConfigGroup>
+
+#include <QAction>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMenu>
+#include <QTemporaryDir>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_scripting_sharedengine-0");
+
+class SharedEngineTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testIsolation();
+    void testUnload();
+
+private:
+    bool createScript(const QString &pluginName, const QString &source);
+    QStringList userActionsMenuTitles();
+
+    QTemporaryDir m_dataDir;
+};
+
+bool SharedEngineTest::createScript(const QString &pluginName, const QString &source)
+{
+    const QDir packageDir(m_dataDir.filePath(QStringLiteral("kwin/scripts/") + pluginName));
+    if (!packageDir.mkpath(QStringLiteral("contents/code"))) {
+        return false;
+    }
+
+    const QJsonObject metaData{
+        {QStringLiteral("KPlugin"), QJsonObject{{QStringLiteral("Id"), pluginName}, {QStringLiteral("Name"), pluginName}}},
+        {QStringLiteral("KPackageStructure"), QStringLiteral("KWin/Script")},
+        {QStringLiteral("X-Plasma-API"), QStringLiteral("javascript")},
+        {QStringLiteral("X-Plasma-MainScript"), QStringLiteral("code/main.js")},
+    };
+    QFile metaDataFile(packageDir.filePath(QStringLiteral("metadata.json")));
+    if (!metaDataFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    metaDataFile.write(QJsonDocument(metaData).toJson());
+
+    QFile mainFile(packageDir.filePath(QStringLiteral("contents/code/main.js")));
+    if (!mainFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    mainFile.write(source.toUtf8());
+    return true;
+}
+
+QStringList SharedEngineTest::userActionsMenuTitles()
+{
+    QMenu menu;
+    QStringList titles;
+    const QList<QAction *> actions = Scripting::self()->actionsForUserActionMenu(nullptr, &menu);
+    for (QAction *action : actions) {
+        titles << action->text();
+    }
+    titles.sort();
+    return titles;
+}
+
+void SharedEngineTest::initTestCase()
+{
+    // both scripts declare the same global variable
+    QVERIFY(m_dataDir.isValid());
+    for (const QString &name : {QStringLiteral("first"), QStringLiteral("second")}) {
+        QVERIFY(createScript(QStringLiteral("sharedengine") + name, QStringLiteral(R"(
+            var title = "%1";
+            registerUserActionsMenu(function (window) {
+                return {text: title, triggered: function (action) {}};
+            });
+        )").arg(name)));
+    }
+    qputenv("XDG_DATA_DIRS", m_dataDir.path().toUtf8());
+
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(waylandServer()->init(s_socketName));
+    QMetaObject::invokeMethod(kwinApp()->outputBackend(), "setVirtualOutputs", Qt::DirectConnection, Q_ARG(QVector<QRect>, QVector<QRect>() << QRect(0, 0, 1280, 1024)));
+
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    config->group("Scripting").writeEntry("SharedEngine", true);
+    config->group("Plugins").writeEntry("sharedenginefirstEnabled", true);
+    config->group("Plugins").writeEntry("sharedenginesecondEnabled", true);
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QVERIFY(Scripting::self());
+}
+
+void SharedEngineTest::testIsolation()
+{
+    // the scripts run in the same engine, but each of them sees its own variable
+    for (const QString &name : {QStringLiteral("sharedenginefirst"), QStringLiteral("sharedenginesecond")}) {
+        QTRY_VERIFY(Scripting::self()->isScriptLoaded(name));
+        AbstractScript *script = Scripting::self()->findScript(name);
+        QVERIFY(script);
+        QTRY_VERIFY(script->running());
+    }
+    QCOMPARE(userActionsMenuTitles(), (QStringList{QStringLiteral("first"), QStringLiteral("second")}));
+}
+
+void SharedEngineTest::testUnload()
+{
+    // unloading one of the scripts restarts the other one in a new engine
+    auto config = kwinApp()->config();
+    config->group("Plugins").writeEntry("sharedenginesecondEnabled", false);
+    config->sync();
+    Scripting::self()->start();
+
+    QTRY_VERIFY(!Scripting::self()->isScriptLoaded(QStringLiteral("sharedenginesecond")));
+    QTRY_VERIFY(Scripting::self()->isScriptLoaded(QStringLiteral("sharedenginefirst")));
+    AbstractScript *script = Scripting::self()->findScript(QStringLiteral("sharedenginefirst"));
+    QVERIFY(script);
+    QTRY_VERIFY(script->running());
+    QCOMPARE(userActionsMenuTitles(), QStringList{QStringLiteral("first")});
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::SharedEngineTest)
+#include "sharedengine_test.moc"
@@ -0,0 +1,110 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "ftrace.h"
+#include "wayland_server.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_startup_benchmark-0");
+
+/**
+ * Measures how long it takes from starting kwin on the virtual backend until the first frame is
+ * presented, and checks the startup trace that is written along the way.
+ */
+class StartupBenchmarkTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkTimeToFirstFrame();
+    void testTrace();
+
+private:
+    QTemporaryDir m_traceDir;
+    QString m_traceFileName;
+    QElapsedTimer m_startupTimer;
+    qint64 m_timeToFirstFrame = 0;
+};
+
+void StartupBenchmarkTest::initTestCase()
+{
+    QVERIFY(m_traceDir.isValid());
+    m_traceFileName = m_traceDir.filePath(QStringLiteral("startup.json"));
+
+    FTraceLogger::create(kwinApp())->startChromeTrace(m_traceFileName);
+    QVERIFY(FTraceLogger::self()->isChromeTraceActive());
+
+    // the trace is written and stopped once the first frame has been presented
+    connect(FTraceLogger::self(), &FTraceLogger::enabledChanged, this, [this]() {
+        if (!FTraceLogger::self()->isChromeTraceActive() && !m_timeToFirstFrame) {
+            m_timeToFirstFrame = m_startupTimer.elapsed();
+        }
+    });
+    QSignalSpy traceStoppedSpy(FTraceLogger::self(), &FTraceLogger::enabledChanged);
+
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(waylandServer()->init(s_socketName));
+    QMetaObject::invokeMethod(kwinApp()->outputBackend(), "setVirtualOutputs", Qt::DirectConnection, Q_ARG(QVector<QRect>, QVector<QRect>() << QRect(0, 0, 1280, 1024)));
+
+    m_startupTimer.start();
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QTRY_VERIFY(!FTraceLogger::self()->isChromeTraceActive());
+    QVERIFY(!traceStoppedSpy.isEmpty());
+    QVERIFY(m_timeToFirstFrame > 0);
+}
+
+void StartupBenchmarkTest::benchmarkTimeToFirstFrame()
+{
+    // kwin can only be started once per process, so the one measurement is reported as it is
+    QTest::setBenchmarkResult(m_timeToFirstFrame, QTest::WalltimeMilliseconds);
+}
+
+void StartupBenchmarkTest::testTrace()
+{
+    QFile file(m_traceFileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    QVERIFY(document.isObject());
+
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+    QVERIFY(!events.isEmpty());
+
+    QStringList names;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        QVERIFY(event.contains(QStringLiteral("ts")));
+        QVERIFY(event.contains(QStringLiteral("pid")));
+        QVERIFY(event.contains(QStringLiteral("tid")));
+        const QString phase = event.value(QStringLiteral("ph")).toString();
+        if (phase == QLatin1String("X")) {
+            QVERIFY(event.value(QStringLiteral("dur")).toDouble() >= 0);
+        } else {
+            QCOMPARE(phase, QStringLiteral("i"));
+        }
+        names.append(event.value(QStringLiteral("name")).toString());
+    }
+    QVERIFY(names.contains(QStringLiteral("Compositor setup")));
+    QVERIFY(names.contains(QStringLiteral("Create effects handler")));
+    QVERIFY(names.contains(QStringLiteral("First frame presented")));
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::StartupBenchmarkTest)
+#include "startup_benchmark_test.moc"
@@ -71,9 +71,13 @@ void XwaylandSelectionsTest::testSync_data()
 {
     QTest::addColumn<QString>("copyPlatform");
     QTest::addColumn<QString>("pastePlatform");
+    QTest::addColumn<QStringList>("arguments");
 
-    QTest::newRow("x11->wayland") << QStringLiteral("xcb") << QStringLiteral("wayland");
-    QTest::newRow("wayland->x11") << QStringLiteral("wayland") << QStringLiteral("xcb");
+    QTest::newRow("x11->wayland") << QStringLiteral("xcb") << QStringLiteral("wayland") << QStringList();
+    QTest::newRow("wayland->x11") << QStringLiteral("wayland") << QStringLiteral("xcb") << QStringList();
+    // large selections are transferred incrementally, the paste helper logs the throughput
+    QTest::newRow("x11->wayland 16MiB") << QStringLiteral("xcb") << QStringLiteral("wayland") << QStringList{QString::number(16 << 20)};
+    QTest::newRow("wayland->x11 16MiB") << QStringLiteral("wayland") << QStringLiteral("xcb") << QStringList{QString::number(16 << 20)};
 }
 
 void XwaylandSelectionsTest::testSync()
@@ -90,6 +94,7 @@ void XwaylandSelectionsTest::testSync()
     QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
 
     // start the copy process
+    QFETCH(QStringList, arguments);
     QFETCH(QString, copyPlatform);
     environment.insert(QStringLiteral("QT_QPA_PLATFORM"), copyPlatform);
     environment.insert(QStringLiteral("WAYLAND_DISPLAY"), s_socketName);
@@ -97,6 +102,7 @@ void XwaylandSelectionsTest::testSync()
     copyProcess->setProcessEnvironment(environment);
     copyProcess->setProcessChannelMode(QProcess::ForwardedChannels);
     copyProcess->setProgram(copy);
+    copyProcess->setArguments(arguments);
     copyProcess->start();
     QVERIFY(copyProcess->waitForStarted());
 
@@ -118,6 +124,7 @@ void XwaylandSelectionsTest::testSync()
     pasteProcess->setProcessEnvironment(environment);
     pasteProcess->setProcessChannelMode(QProcess::ForwardedChannels);
     pasteProcess->setProgram(paste);
+    pasteProcess->setArguments(arguments);
     pasteProcess->start();
     QVERIFY(pasteProcess->waitForStarted());
 
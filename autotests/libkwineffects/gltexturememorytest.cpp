@@ -0,0 +1,112 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "libkwineffects/gltexturememory.h"
+
+#include <QtTest>
+
+using namespace KWin;
+
+class GLTextureMemoryTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testAccount();
+    void testEnforceBudget();
+    void testNoBudget();
+    void testOwner();
+};
+
+void GLTextureMemoryTest::testAccount()
+{
+    GLTextureMemory::account(GLTextureMemory::Category::Shadow, 100);
+    GLTextureMemory::account(GLTextureMemory::Category::Effect, 50);
+    QCOMPARE(GLTextureMemory::usage(GLTextureMemory::Category::Shadow), 100);
+    QCOMPARE(GLTextureMemory::usage(GLTextureMemory::Category::Effect), 50);
+    QCOMPARE(GLTextureMemory::totalUsage(), 150);
+
+    GLTextureMemory::account(GLTextureMemory::Category::Shadow, -100);
+    GLTextureMemory::account(GLTextureMemory::Category::Effect, -50);
+    QCOMPARE(GLTextureMemory::totalUsage(), 0);
+}
+
+void GLTextureMemoryTest::testEnforceBudget()
+{
+    GLTextureMemory::setBudget(100);
+
+    QVector<int> evicted;
+    auto makeEntry = [&evicted](int id, qint64 bytes, bool evictable) {
+        GLTextureMemory::account(GLTextureMemory::Category::Thumbnail, bytes);
+        return std::make_unique<GLTextureCacheEntry>([&evicted, id, bytes, evictable]() {
+            if (!evictable) {
+                return false;
+            }
+            GLTextureMemory::account(GLTextureMemory::Category::Thumbnail, -bytes);
+            evicted.append(id);
+            return true;
+        });
+    };
+
+    auto oldest = makeEntry(1, 60, true);
+    auto pinned = makeEntry(2, 60, false);
+    auto newer = makeEntry(3, 60, true);
+    // make sure the clock has advanced, so the last entry is the most recently used one
+    QTRY_VERIFY(std::chrono::steady_clock::now() > newer->lastUsed());
+    auto recent = makeEntry(4, 60, true);
+
+    // the oldest idle entry that can be released goes first, the recently used one is kept
+    GLTextureMemory::enforceBudget(recent->lastUsed() + std::chrono::seconds(1) - std::chrono::nanoseconds(1));
+    QCOMPARE(evicted, (QVector<int>{1, 3}));
+    QCOMPARE(GLTextureMemory::totalUsage(), 120);
+
+    GLTextureMemory::account(GLTextureMemory::Category::Thumbnail, -120);
+    GLTextureMemory::setBudget(0);
+}
+
+void GLTextureMemoryTest::testNoBudget()
+{
+    GLTextureMemory::setBudget(0);
+    GLTextureMemory::account(GLTextureMemory::Category::Other, 1000);
+
+    bool evicted = false;
+    GLTextureCacheEntry entry([&evicted]() {
+        evicted = true;
+        return true;
+    });
+    GLTextureMemory::enforceBudget(entry.lastUsed() + std::chrono::hours(1));
+    QVERIFY(!evicted);
+
+    GLTextureMemory::account(GLTextureMemory::Category::Other, -1000);
+}
+
+void GLTextureMemoryTest::testOwner()
+{
+    int first;
+    int second;
+    QCOMPARE(GLTextureMemory::owner(), nullptr);
+
+    QCOMPARE(GLTextureMemory::setOwner(&first), nullptr);
+    GLTextureMemory::accountOwner(GLTextureMemory::owner(), 100);
+    QCOMPARE(GLTextureMemory::setOwner(&second), &first);
+    GLTextureMemory::accountOwner(GLTextureMemory::owner(), 30);
+    QCOMPARE(GLTextureMemory::setOwner(nullptr), &second);
+    GLTextureMemory::accountOwner(GLTextureMemory::owner(), 1000);
+
+    QCOMPARE(GLTextureMemory::ownerUsage(&first), 100);
+    QCOMPARE(GLTextureMemory::ownerUsage(&second), 30);
+    QCOMPARE(GLTextureMemory::ownerUsage(nullptr), 0);
+
+    GLTextureMemory::accountOwner(&first, -100);
+    GLTextureMemory::accountOwner(&second, -30);
+    QCOMPARE(GLTextureMemory::ownerUsage(&first), 0);
+    QCOMPARE(GLTextureMemory::ownerUsage(&second), 0);
+}
+
+QTEST_GUILESS_MAIN(GLTextureMemoryTest)
+
+#include "gltexturememorytest.moc"
@@ -36,6 +36,7 @@ private Q_SLOTS:
     void testPriorDetect();
     void testDetect_data();
     void testDetect();
+    void testCachedExtensions();
 };
 
 void GLPlatformTest::cleanup()
@@ -293,5 +294,29 @@ void GLPlatformTest::testDetect()
     QCOMPARE(gl->preferBufferSubData(), settingsGroup.readEntry("PreferBufferSubData", false));
 }
 
+void GLPlatformTest::testCachedExtensions()
+{
+    // the extensions of a driver are remembered, a different driver version is queried again
+    s_gl = new MockGL;
+    s_gl->getString.vendor = QByteArrayLiteral("Intel");
+    s_gl->getString.renderer = QByteArrayLiteral("Mesa Intel(R) UHD Graphics 620 (KBL GT2)");
+    s_gl->getString.version = QByteArrayLiteral("4.6 (Core Profile) Mesa 23.0.0");
+    s_gl->getString.shadingLanguageVersion = QByteArrayLiteral("4.60");
+    s_gl->getString.extensions = QVector<QByteArray>{QByteArrayLiteral("GL_MESA_pack_invert")};
+
+    GLPlatform::instance()->detect(EglPlatformInterface);
+    QVERIFY(GLPlatform::instance()->supports(PackInvert));
+    cleanupGL();
+
+    s_gl->getString.extensions.clear();
+    GLPlatform::instance()->detect(EglPlatformInterface);
+    QVERIFY(GLPlatform::instance()->supports(PackInvert));
+    cleanupGL();
+
+    s_gl->getString.version = QByteArrayLiteral("4.6 (Core Profile) Mesa 23.0.1");
+    GLPlatform::instance()->detect(EglPlatformInterface);
+    QVERIFY(!GLPlatform::instance()->supports(PackInvert));
+}
+
 QTEST_GUILESS_MAIN(GLPlatformTest)
 #include "kwinglplatformtest.moc"
@@ -0,0 +1,122 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utils/damagejournal.h"
+
+#include <QtTest>
+
+using namespace KWin;
+
+class TestDamageJournal : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testAccumulate();
+    void testCapacity();
+    void testClear();
+    void testRectCountLimit();
+};
+
+static const QRegion s_fallback = QRect(0, 0, 1000, 1000);
+
+void TestDamageJournal::testEmpty()
+{
+    DamageJournal journal;
+    QCOMPARE(journal.accumulate(0, s_fallback), s_fallback);
+    QCOMPARE(journal.accumulate(1, s_fallback), s_fallback);
+    QCOMPARE(journal.lastDamage(), QRegion());
+}
+
+void TestDamageJournal::testAccumulate()
+{
+    DamageJournal journal;
+    const QRect rects[] = {QRect(0, 0, 10, 10), QRect(20, 0, 10, 10), QRect(40, 0, 10, 10), QRect(60, 0, 10, 10), QRect(80, 0, 10, 10)};
+
+    journal.add(rects[0]);
+    QCOMPARE(journal.lastDamage(), QRegion(rects[0]));
+    QCOMPARE(journal.accumulate(1, s_fallback), QRegion());
+    QCOMPARE(journal.accumulate(2, s_fallback), s_fallback);
+
+    journal.add(rects[1]);
+    journal.add(rects[2]);
+    QCOMPARE(journal.accumulate(2, s_fallback), QRegion(rects[2]));
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(rects[2]) | rects[1]);
+    QCOMPARE(journal.accumulate(4, s_fallback), s_fallback);
+
+    // the cached unions are updated as the regions are added
+    journal.add(rects[3]);
+    journal.add(rects[4]);
+    QCOMPARE(journal.accumulate(2, s_fallback), QRegion(rects[4]));
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(rects[4]) | rects[3]);
+    QCOMPARE(journal.accumulate(4, s_fallback), QRegion(rects[4]) | rects[3] | rects[2]);
+    QCOMPARE(journal.accumulate(5, s_fallback), QRegion(rects[4]) | rects[3] | rects[2] | rects[1]);
+
+    journal.add(rects[0]);
+    QCOMPARE(journal.accumulate(4, s_fallback), QRegion(rects[0]) | rects[4] | rects[3]);
+    QCOMPARE(journal.accumulate(6, s_fallback), QRegion(rects[0]) | rects[4] | rects[3] | rects[2] | rects[1]);
+}
+
+void TestDamageJournal::testCapacity()
+{
+    DamageJournal journal;
+    journal.setCapacity(3);
+    QCOMPARE(journal.capacity(), 3);
+
+    for (int i = 0; i < 5; ++i) {
+        journal.add(QRect(i * 20, 0, 10, 10));
+        QCOMPARE(journal.accumulate(3, s_fallback), i >= 2 ? QRegion(QRect(i * 20, 0, 10, 10)) | QRect((i - 1) * 20, 0, 10, 10) : s_fallback);
+    }
+    // the oldest regions have been dropped
+    QCOMPARE(journal.accumulate(4, s_fallback), s_fallback);
+
+    journal.setCapacity(2);
+    QCOMPARE(journal.accumulate(2, s_fallback), QRegion(QRect(80, 0, 10, 10)));
+    QCOMPARE(journal.accumulate(3, s_fallback), s_fallback);
+}
+
+void TestDamageJournal::testClear()
+{
+    DamageJournal journal;
+    journal.add(QRect(0, 0, 10, 10));
+    journal.add(QRect(20, 0, 10, 10));
+    journal.add(QRect(40, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(QRect(20, 0, 30, 10)) - QRect(30, 0, 10, 10));
+
+    journal.clear();
+    QCOMPARE(journal.accumulate(2, s_fallback), s_fallback);
+
+    journal.add(QRect(60, 0, 10, 10));
+    journal.add(QRect(80, 0, 10, 10));
+    journal.add(QRect(100, 0, 10, 10));
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(QRect(100, 0, 10, 10)) | QRect(80, 0, 10, 10));
+}
+
+void TestDamageJournal::testRectCountLimit()
+{
+    // fragmented damage is replaced by its bounding rect when it's accumulated
+    QRegion first;
+    QRegion second;
+    for (int i = 0; i < DamageJournal::maximumRectCount(); ++i) {
+        first += QRect(i * 20, 0, 10, 10);
+        second += QRect(i * 20, 40, 10, 10);
+    }
+
+    DamageJournal journal;
+    journal.add(first);
+    journal.add(second);
+    journal.add(QRect(0, 0, 10, 10));
+    QCOMPARE(journal.accumulate(2, s_fallback), QRegion(QRect(0, 0, 10, 10)));
+    // the second region alone is not fragmented enough, but with the last one it is
+    QCOMPARE(journal.accumulate(3, s_fallback), QRegion(second.boundingRect() | QRect(0, 0, 10, 10)));
+    QCOMPARE(journal.accumulate(4, s_fallback), QRegion(first.boundingRect() | second.boundingRect()));
+}
+
+QTEST_GUILESS_MAIN(TestDamageJournal)
+#include "test_damagejournal.moc"
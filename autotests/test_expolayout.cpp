@@ -0,0 +1,183 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "plugins/private/expolayout.h"
+
+#include <memory>
+#include <vector>
+
+class TestExpoLayout : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void cachedLayout();
+    void benchmarkLayout_data();
+    void benchmarkLayout();
+    void benchmarkFilter_data();
+    void benchmarkFilter();
+
+private:
+    void createCells(int count);
+    std::vector<QRect> geometries() const;
+
+    std::unique_ptr<ExpoLayout> m_layout;
+    std::vector<std::unique_ptr<ExpoCell>> m_cells;
+};
+
+void TestExpoLayout::init()
+{
+    m_layout = std::make_unique<ExpoLayout>();
+    m_layout->setSize(QSizeF(1920, 1080));
+}
+
+void TestExpoLayout::cleanup()
+{
+    m_cells.clear();
+    m_layout.reset();
+}
+
+void TestExpoLayout::createCells(int count)
+{
+    // the windows are scattered the same way every time, so the results are comparable
+    QRandomGenerator generator(count);
+    for (int i = 0; i < count; ++i) {
+        auto cell = std::make_unique<ExpoCell>();
+        cell->setPersistentKey(QString::number(i));
+        cell->setNaturalX(generator.bounded(1600));
+        cell->setNaturalY(generator.bounded(800));
+        cell->setNaturalWidth(100 + generator.bounded(1100));
+        cell->setNaturalHeight(100 + generator.bounded(700));
+        cell->setBottomMargin(20);
+        cell->setLayout(m_layout.get());
+        m_cells.push_back(std::move(cell));
+    }
+}
+
+std::vector<QRect> TestExpoLayout::geometries() const
+{
+    std::vector<QRect> geometries;
+    for (const auto &cell : m_cells) {
+        geometries.push_back(QRect(cell->x(), cell->y(), cell->width(), cell->height()));
+    }
+    return geometries;
+}
+
+void TestExpoLayout::cachedLayout()
+{
+    // filtering the windows and clearing the filter again should produce the same layout, the
+    // natural layout sorts the windows, so it doesn't matter in which order they're shown again
+    m_layout->setMode(ExpoLayout::LayoutNatural);
+    createCells(20);
+
+    m_layout->forceLayout();
+    const std::vector<QRect> original = geometries();
+
+    for (int i = 0; i < 10; ++i) {
+        m_cells[i]->setEnabled(false);
+    }
+    m_layout->forceLayout();
+    QVERIFY(geometries() != original);
+
+    // the windows that are still shown keep where they'd be without the cache
+    ExpoLayout uncached;
+    uncached.setMode(ExpoLayout::LayoutNatural);
+    uncached.setSize(m_layout->size());
+    std::vector<std::unique_ptr<ExpoCell>> copies;
+    for (int i = 10; i < 20; ++i) {
+        auto copy = std::make_unique<ExpoCell>();
+        copy->setPersistentKey(m_cells[i]->persistentKey());
+        copy->setNaturalX(m_cells[i]->naturalX());
+        copy->setNaturalY(m_cells[i]->naturalY());
+        copy->setNaturalWidth(m_cells[i]->naturalWidth());
+        copy->setNaturalHeight(m_cells[i]->naturalHeight());
+        copy->setBottomMargin(m_cells[i]->bottomMargin());
+        copy->setLayout(&uncached);
+        copies.push_back(std::move(copy));
+    }
+    uncached.forceLayout();
+    for (int i = 10; i < 20; ++i) {
+        const auto &copy = copies[i - 10];
+        QCOMPARE(QRect(m_cells[i]->x(), m_cells[i]->y(), m_cells[i]->width(), m_cells[i]->height()),
+                 QRect(copy->x(), copy->y(), copy->width(), copy->height()));
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        m_cells[i]->setEnabled(true);
+    }
+    m_layout->forceLayout();
+    QCOMPARE(geometries(), original);
+
+    // moving a window invalidates the cached layout
+    m_cells[0]->setNaturalX(m_cells[0]->naturalX() + 500);
+    m_layout->forceLayout();
+    QVERIFY(geometries() != original);
+}
+
+void TestExpoLayout::benchmarkLayout_data()
+{
+    QTest::addColumn<ExpoLayout::LayoutMode>("mode");
+    QTest::addColumn<int>("count");
+
+    for (int count : {10, 50, 100, 500}) {
+        QTest::addRow("closest, %d windows", count) << ExpoLayout::LayoutClosest << count;
+        QTest::addRow("natural, %d windows", count) << ExpoLayout::LayoutNatural << count;
+    }
+}
+
+void TestExpoLayout::benchmarkLayout()
+{
+    QFETCH(ExpoLayout::LayoutMode, mode);
+    QFETCH(int, count);
+    m_layout->setMode(mode);
+    createCells(count);
+
+    // the width is changed slightly every time, so each iteration lays the windows out again
+    int iteration = 0;
+    QBENCHMARK {
+        m_layout->setWidth(1920 + iteration++ % 16);
+        m_layout->forceLayout();
+    }
+}
+
+void TestExpoLayout::benchmarkFilter_data()
+{
+    QTest::addColumn<int>("count");
+
+    for (int count : {10, 50, 100, 500}) {
+        QTest::addRow("%d windows", count) << count;
+    }
+}
+
+void TestExpoLayout::benchmarkFilter()
+{
+    // typing a letter of the filter and erasing it again
+    QFETCH(int, count);
+    createCells(count);
+
+    QBENCHMARK {
+        for (int i = 0; i < count; i += 2) {
+            m_cells[i]->setEnabled(false);
+        }
+        m_layout->forceLayout();
+        for (int i = 0; i < count; i += 2) {
+            m_cells[i]->setEnabled(true);
+        }
+        m_layout->forceLayout();
+    }
+}
+
+QTEST_MAIN(TestExpoLayout)
+
+#include "test_expolayout.moc"
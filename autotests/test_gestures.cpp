@@ -67,6 +67,7 @@ private Q_SLOTS:
     void testSwipeMaxFingerStart_data();
     void testSwipeMaxFingerStart();
     void testNotEmitCallbacksBeforeDirectionDecided();
+    void testProgressOnlyEmittedOnChange();
 
     // swipe only
     void testSwipeGeometryStart_data();
@@ -656,6 +657,33 @@ void GestureTest::testNotEmitCallbacksBeforeDirectionDecided()
     QCOMPARE(contractSpy.count(), 1);
 }
 
+void GestureTest::testProgressOnlyEmittedOnChange()
+{
+    GestureRecognizer recognizer;
+    SwipeGesture gesture;
+    gesture.setDirection(SwipeDirection::Right);
+    gesture.setMinimumDelta(QPointF(100, 0));
+    recognizer.registerSwipeGesture(&gesture);
+
+    QSignalSpy progressSpy(&gesture, &SwipeGesture::progress);
+    QSignalSpy deltaProgressSpy(&gesture, &SwipeGesture::deltaProgress);
+
+    recognizer.startSwipeGesture(3);
+    recognizer.updateSwipeGesture(QPointF(50, 0));
+    QCOMPARE(progressSpy.count(), 1);
+    QCOMPARE(progressSpy.last().first().value<qreal>(), 0.5);
+
+    recognizer.updateSwipeGesture(QPointF(60, 0));
+    QCOMPARE(progressSpy.count(), 2);
+    QCOMPARE(progressSpy.last().first().value<qreal>(), 1.0);
+
+    // the progress saturated, only the delta keeps changing
+    recognizer.updateSwipeGesture(QPointF(10, 0));
+    QCOMPARE(progressSpy.count(), 2);
+    QCOMPARE(deltaProgressSpy.count(), 3);
+    QCOMPARE(deltaProgressSpy.last().first().toPointF(), QPointF(120, 0));
+}
+
 void GestureTest::testSwipeGeometryStart_data()
 {
     QTest::addColumn<QRect>("geometry");
@@ -0,0 +1,78 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "inputlatencymonitor.h"
+
+#include <QtTest>
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestLatencyHistogram : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testMeanMax();
+    void testPercentile();
+    void testOverflow();
+    void testReset();
+};
+
+void TestLatencyHistogram::testEmpty()
+{
+    LatencyHistogram histogram;
+    QCOMPARE(histogram.count(), 0u);
+    QCOMPARE(histogram.mean(), 0us);
+    QCOMPARE(histogram.max(), 0us);
+    QCOMPARE(histogram.percentile(0.5), 0us);
+}
+
+void TestLatencyHistogram::testMeanMax()
+{
+    LatencyHistogram histogram;
+    histogram.add(2ms);
+    histogram.add(4ms);
+    histogram.add(9ms);
+    QCOMPARE(histogram.count(), 3u);
+    QCOMPARE(histogram.mean(), 5ms);
+    QCOMPARE(histogram.max(), 9ms);
+}
+
+void TestLatencyHistogram::testPercentile()
+{
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 100; ++i) {
+        histogram.add(std::chrono::milliseconds(i));
+    }
+    // the percentiles are rounded up to the end of their bucket
+    QCOMPARE(histogram.percentile(0.5), 50500us);
+    QCOMPARE(histogram.percentile(0.9), 90500us);
+    QCOMPARE(histogram.percentile(1.0), 100ms);
+}
+
+void TestLatencyHistogram::testOverflow()
+{
+    LatencyHistogram histogram;
+    histogram.add(1ms);
+    histogram.add(1s);
+    QCOMPARE(histogram.percentile(0.5), 1500us);
+    QCOMPARE(histogram.percentile(1.0), 1s);
+    QCOMPARE(histogram.max(), 1s);
+}
+
+void TestLatencyHistogram::testReset()
+{
+    LatencyHistogram histogram;
+    histogram.add(3ms);
+    histogram.reset();
+    QCOMPARE(histogram.count(), 0u);
+    QCOMPARE(histogram.max(), 0us);
+}
+
+QTEST_MAIN(TestLatencyHistogram)
+#include "test_latencyhistogram.moc"
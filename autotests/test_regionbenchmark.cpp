@@ -0,0 +1,78 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utils/damagejournal.h"
+
+#include <QRandomGenerator>
+#include <QtTest>
+
+using namespace KWin;
+
+/**
+ * Measures the region operations that the compositor does every frame, such as accumulating
+ * the damage of the previous frames for the current back buffer.
+ */
+class TestRegionBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchmarkDamageJournalAccumulate_data();
+    void benchmarkDamageJournalAccumulate();
+};
+
+static const QRect s_screen(0, 0, 3840, 2160);
+
+/**
+ * Returns a region made of @a count small rects scattered over the screen, like the damage
+ * of a few blinking cursors and animated icons.
+ */
+static QRegion scatteredRegion(int count, QRandomGenerator &generator)
+{
+    QRegion region;
+    for (int i = 0; i < count; ++i) {
+        region += QRect(generator.bounded(s_screen.width()), generator.bounded(s_screen.height()), 4 + generator.bounded(60), 4 + generator.bounded(30));
+    }
+    return region & s_screen;
+}
+
+void TestRegionBenchmark::benchmarkDamageJournalAccumulate_data()
+{
+    QTest::addColumn<int>("bufferAge");
+    QTest::addColumn<int>("rectCount");
+
+    for (int bufferAge : {2, 3, 4}) {
+        for (int rectCount : {1, 8, 64}) {
+            QTest::addRow("buffer age %d, %d rects", bufferAge, rectCount) << bufferAge << rectCount;
+        }
+    }
+}
+
+void TestRegionBenchmark::benchmarkDamageJournalAccumulate()
+{
+    // a frame is added and the damage for the next buffer is accumulated
+    QFETCH(int, bufferAge);
+    QFETCH(int, rectCount);
+
+    QRandomGenerator generator(42);
+    QList<QRegion> damage;
+    for (int i = 0; i < 16; ++i) {
+        damage.append(scatteredRegion(rectCount, generator));
+    }
+
+    DamageJournal journal;
+    int frame = 0;
+    QBENCHMARK {
+        journal.add(damage[frame++ % damage.size()]);
+        const QRegion region = journal.accumulate(bufferAge, s_screen);
+        Q_UNUSED(region)
+    }
+}
+
+QTEST_GUILESS_MAIN(TestRegionBenchmark)
+#include "test_regionbenchmark.moc"
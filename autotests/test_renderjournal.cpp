@@ -0,0 +1,115 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "core/renderjournal.h"
+
+#include <QtTest>
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestRenderJournal : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testMinMaxAverage();
+    void testPercentile();
+    void testOutlier();
+    void testRingBuffer();
+    void testSafetyMargin();
+};
+
+void TestRenderJournal::testEmpty()
+{
+    RenderJournal journal;
+    QCOMPARE(journal.count(), 0);
+    QCOMPARE(journal.minimum(), 0ns);
+    QCOMPARE(journal.maximum(), 0ns);
+    QCOMPARE(journal.average(), 0ns);
+    QCOMPARE(journal.percentile(90), 0ns);
+    QCOMPARE(journal.exponentialAverage(), 0ns);
+    QCOMPARE(journal.standardDeviation(), 0ns);
+}
+
+void TestRenderJournal::testMinMaxAverage()
+{
+    RenderJournal journal;
+    journal.add(1ms);
+    journal.add(2ms);
+    journal.add(3ms);
+
+    QCOMPARE(journal.count(), 3);
+    QCOMPARE(journal.minimum(), std::chrono::nanoseconds(1ms));
+    QCOMPARE(journal.maximum(), std::chrono::nanoseconds(3ms));
+    QCOMPARE(journal.average(), std::chrono::nanoseconds(2ms));
+}
+
+void TestRenderJournal::testPercentile()
+{
+    RenderJournal journal;
+    for (int i = 1; i <= 10; ++i) {
+        journal.add(std::chrono::milliseconds(i));
+    }
+
+    QCOMPARE(journal.percentile(0), std::chrono::nanoseconds(1ms));
+    QCOMPARE(journal.percentile(50), std::chrono::nanoseconds(5ms));
+    QCOMPARE(journal.percentile(90), std::chrono::nanoseconds(9ms));
+    QCOMPARE(journal.percentile(100), std::chrono::nanoseconds(10ms));
+}
+
+void TestRenderJournal::testOutlier()
+{
+    RenderJournal journal;
+    for (int i = 0; i < RenderJournal::capacity() - 1; ++i) {
+        journal.add(2ms);
+    }
+    journal.add(50ms);
+
+    // A single outlier pins the maximum, but neither the 90th nor the 99th percentile.
+    QCOMPARE(journal.maximum(), std::chrono::nanoseconds(50ms));
+    QCOMPARE(journal.percentile(90), std::chrono::nanoseconds(2ms));
+    QCOMPARE(journal.percentile(99), std::chrono::nanoseconds(2ms));
+
+    // The exponential average is pulled up by the outlier, but only slightly.
+    QVERIFY(journal.exponentialAverage() > 2ms);
+    QVERIFY(journal.exponentialAverage() < 10ms);
+    QVERIFY(journal.standardDeviation() > 0ns);
+}
+
+void TestRenderJournal::testRingBuffer()
+{
+    RenderJournal journal;
+    journal.add(100ms);
+    for (int i = 0; i < RenderJournal::capacity(); ++i) {
+        journal.add(1ms);
+    }
+
+    // The oldest entry must have been evicted.
+    QCOMPARE(journal.count(), RenderJournal::capacity());
+    QCOMPARE(journal.percentile(100), std::chrono::nanoseconds(1ms));
+    QCOMPARE(journal.maximum(), std::chrono::nanoseconds(1ms));
+}
+
+void TestRenderJournal::testSafetyMargin()
+{
+    RenderJournal journal;
+    for (int i = 0; i < 20; ++i) {
+        journal.add(4ms);
+    }
+    QCOMPARE(journal.safetyMargin(1ms, 5ms), std::chrono::nanoseconds(1ms));
+
+    for (int i = 0; i < 20; ++i) {
+        journal.add(i % 2 ? 1ms : 12ms);
+    }
+    QCOMPARE(journal.safetyMargin(1ms, 5ms), std::chrono::nanoseconds(5ms));
+}
+
+QTEST_MAIN(TestRenderJournal)
+#include "test_renderjournal.moc"
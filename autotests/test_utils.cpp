@@ -13,10 +13,14 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include "utils/common.h"
 #include "utils/ramfile.h"
+#include "utils/spscqueue.h"
 
 #include <QtTest>
 
+#include <thread>
+
 using namespace KWin;
 
 class TestUtils : public QObject
@@ -25,6 +29,8 @@ class TestUtils : public QObject
 private Q_SLOTS:
     void testRamFile();
     void testSealedRamFile();
+    void testSpscQueue();
+    void testSimplifyDamage();
 };
 
 static const QByteArray s_testByteArray = QByteArrayLiteral("Test Data \0\1\2\3");
@@ -67,5 +73,52 @@ void TestUtils::testSealedRamFile()
 #endif
 }
 
+void TestUtils::testSpscQueue()
+{
+    SpscQueue<std::unique_ptr<int>> queue;
+    QVERIFY(!queue.front());
+    QVERIFY(!queue.pop());
+
+    constexpr int count = 100000;
+    std::thread producer([&queue] {
+        for (int i = 0; i < count; ++i) {
+            queue.push(std::make_unique<int>(i));
+        }
+    });
+
+    int expected = 0;
+    while (expected < count) {
+        if (std::unique_ptr<int> *front = queue.front()) {
+            QCOMPARE(**front, expected);
+            std::optional<std::unique_ptr<int>> value = queue.pop();
+            QVERIFY(value);
+            QCOMPARE(**value, expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    QVERIFY(!queue.pop());
+}
+
+void TestUtils::testSimplifyDamage()
+{
+    // a few rectangles that are far apart are kept
+    const QRegion sparse = QRegion(0, 0, 10, 10) + QRegion(100, 100, 10, 10);
+    QCOMPARE(simplifyDamage(sparse), sparse);
+
+    // rectangles that almost fill their bounding rectangle are merged
+    const QRegion dense = QRegion(0, 0, 100, 50) + QRegion(0, 50, 90, 50);
+    QCOMPARE(simplifyDamage(dense), QRegion(0, 0, 100, 100));
+
+    // lots of tiny rectangles are merged regardless of how sparse they are
+    QRegion scattered;
+    for (int i = 0; i < 100; ++i) {
+        scattered += QRect(i * 10, i * 10, 1, 1);
+    }
+    QCOMPARE(simplifyDamage(scattered), QRegion(scattered.boundingRect()));
+
+    QCOMPARE(simplifyDamage(QRegion()), QRegion());
+}
+
 QTEST_MAIN(TestUtils)
 #include "test_utils.moc"
@@ -31,6 +31,9 @@ Atoms::Atoms()
     , kde_net_wm_user_creation_time(QByteArrayLiteral("_KDE_NET_WM_USER_CREATION_TIME"))
     , net_wm_take_activity(QByteArrayLiteral("_NET_WM_TAKE_ACTIVITY"))
     , net_wm_window_opacity(QByteArrayLiteral("_NET_WM_WINDOW_OPACITY"))
+    , net_wm_name(QByteArrayLiteral("_NET_WM_NAME"))
+    , net_wm_icon_name(QByteArrayLiteral("_NET_WM_ICON_NAME"))
+    , net_wm_icon(QByteArrayLiteral("_NET_WM_ICON"))
     , xdnd_selection(QByteArrayLiteral("XdndSelection"))
     , xdnd_aware(QByteArrayLiteral("XdndAware"))
     , xdnd_enter(QByteArrayLiteral("XdndEnter"))
@@ -39,6 +39,9 @@ public:
     Xcb::Atom kde_net_wm_user_creation_time;
     Xcb::Atom net_wm_take_activity;
     Xcb::Atom net_wm_window_opacity;
+    Xcb::Atom net_wm_name;
+    Xcb::Atom net_wm_icon_name;
+    Xcb::Atom net_wm_icon;
     Xcb::Atom xdnd_selection;
     Xcb::Atom xdnd_aware;
     Xcb::Atom xdnd_enter;
@@ -10,6 +10,7 @@
 #include "core/renderloop_p.h"
 #include "drm_backend.h"
 #include "drm_gpu.h"
+#include "drm_layer.h"
 
 namespace KWin
 {
@@ -31,9 +32,11 @@ void DrmAbstractOutput::frameFailed() const
     RenderLoopPrivate::get(m_renderLoop.get())->notifyFrameFailed();
 }
 
-void DrmAbstractOutput::pageFlipped(std::chrono::nanoseconds timestamp) const
+void DrmAbstractOutput::pageFlipped(std::chrono::nanoseconds timestamp, uint64_t sequence, PresentationFlags flags) const
 {
-    RenderLoopPrivate::get(m_renderLoop.get())->notifyFrameCompleted(timestamp);
+    const DrmOutputLayer *layer = primaryLayer();
+    const std::chrono::nanoseconds renderTime = layer ? layer->queryRenderTime() : std::chrono::nanoseconds::zero();
+    RenderLoopPrivate::get(m_renderLoop.get())->notifyFrameCompleted(timestamp, renderTime, sequence, flags);
 }
 
 QVector<int32_t> DrmAbstractOutput::regionToRects(const QRegion &region) const
@@ -52,6 +55,11 @@ QVector<int32_t> DrmAbstractOutput::regionToRects(const QRegion &region) const
     return rects;
 }
 
+QList<DrmOutputLayer *> DrmAbstractOutput::overlayLayers() const
+{
+    return {};
+}
+
 DrmGpu *DrmAbstractOutput::gpu() const
 {
     return m_gpu;
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "core/output.h"
+#include "core/renderloop.h"
 
 namespace KWin
 {
@@ -25,13 +26,14 @@ public:
 
     RenderLoop *renderLoop() const override;
     void frameFailed() const;
-    void pageFlipped(std::chrono::nanoseconds timestamp) const;
+    void pageFlipped(std::chrono::nanoseconds timestamp, uint64_t sequence = 0, PresentationFlags flags = PresentationFlags()) const;
     QVector<int32_t> regionToRects(const QRegion &region) const;
     DrmGpu *gpu() const;
 
     virtual bool present() = 0;
     virtual DrmOutputLayer *primaryLayer() const = 0;
     virtual DrmOutputLayer *cursorLayer() const = 0;
+    virtual QList<DrmOutputLayer *> overlayLayers() const;
 
     void updateEnabled(bool enabled);
 
@@ -8,6 +8,7 @@
 */
 #include "drm_atomic_commit.h"
 #include "drm_blob.h"
+#include "drm_buffer.h"
 #include "drm_gpu.h"
 #include "drm_object.h"
 #include "drm_property.h"
@@ -24,6 +25,7 @@ DrmAtomicCommit::DrmAtomicCommit(DrmGpu *gpu)
 void DrmAtomicCommit::addProperty(const DrmProperty &prop, uint64_t value)
 {
     drmModeAtomicAddProperty(m_req.get(), prop.drmObject()->id(), prop.propId(), value);
+    m_properties[&prop] = value;
 }
 
 void DrmAtomicCommit::addBlob(const DrmProperty &prop, const std::shared_ptr<DrmBlob> &blob)
@@ -32,9 +34,24 @@ void DrmAtomicCommit::addBlob(const DrmProperty &prop, const std::shared_ptr<Drm
     m_blobs[&prop] = blob;
 }
 
+void DrmAtomicCommit::addBuffer(const std::shared_ptr<DrmFramebuffer> &buffer)
+{
+    m_buffers.push_back(buffer);
+}
+
+void DrmAtomicCommit::setPageflipAsync(bool async)
+{
+    m_async = async;
+}
+
+const QHash<const DrmProperty *, uint64_t> &DrmAtomicCommit::properties() const
+{
+    return m_properties;
+}
+
 bool DrmAtomicCommit::test()
 {
-    return drmModeAtomicCommit(m_gpu->fd(), m_req.get(), DRM_MODE_ATOMIC_TEST_ONLY | DRM_MODE_ATOMIC_NONBLOCK, m_gpu) == 0;
+    return drmModeAtomicCommit(m_gpu->fd(), m_req.get(), DRM_MODE_ATOMIC_TEST_ONLY | DRM_MODE_ATOMIC_NONBLOCK | (m_async ? DRM_MODE_PAGE_FLIP_ASYNC : 0), m_gpu) == 0;
 }
 
 bool DrmAtomicCommit::testAllowModeset()
@@ -44,7 +61,7 @@ bool DrmAtomicCommit::testAllowModeset()
 
 bool DrmAtomicCommit::commit()
 {
-    return drmModeAtomicCommit(m_gpu->fd(), m_req.get(), DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, m_gpu) == 0;
+    return drmModeAtomicCommit(m_gpu->fd(), m_req.get(), DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT | (m_async ? DRM_MODE_PAGE_FLIP_ASYNC : 0), m_gpu) == 0;
 }
 
 bool DrmAtomicCommit::commitModeset()
@@ -12,6 +12,7 @@
 #include <xf86drmMode.h>
 
 #include <QHash>
+#include <QVector>
 
 #include "drm_pointer.h"
 #include "drm_property.h"
@@ -22,6 +23,7 @@ namespace KWin
 class DrmGpu;
 class DrmProperty;
 class DrmBlob;
+class DrmFramebuffer;
 
 class DrmAtomicCommit
 {
@@ -35,6 +37,20 @@ public:
         addProperty(prop, prop.valueForEnum(enumValue));
     }
     void addBlob(const DrmProperty &prop, const std::shared_ptr<DrmBlob> &blob);
+    /**
+     * Keeps the @p buffer alive as long as the commit, so that it can be submitted later
+     */
+    void addBuffer(const std::shared_ptr<DrmFramebuffer> &buffer);
+    /**
+     * Asynchronous commits are applied right away instead of at the next vblank. The kernel only
+     * accepts them if they change nothing but the framebuffer of the primary plane
+     */
+    void setPageflipAsync(bool async);
+
+    /**
+     * @returns the values of all properties that were added to the commit
+     */
+    const QHash<const DrmProperty *, uint64_t> &properties() const;
 
     bool test();
     bool testAllowModeset();
@@ -47,6 +63,9 @@ private:
     DrmGpu *const m_gpu;
     DrmUniquePtr<drmModeAtomicReq> m_req;
     QHash<const DrmProperty *, std::shared_ptr<DrmBlob>> m_blobs;
+    QVector<std::shared_ptr<DrmFramebuffer>> m_buffers;
+    QHash<const DrmProperty *, uint64_t> m_properties;
+    bool m_async = false;
 };
 
 }
@@ -35,10 +35,13 @@
 #include <QCoreApplication>
 #include <QSocketNotifier>
 #include <QStringBuilder>
+#include <QtConcurrentRun>
 // system
 #include <algorithm>
 #include <cerrno>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <thread>
 #include <unistd.h>
 // drm
 #include <gbm.h>
@@ -73,7 +76,6 @@ static QStringList splitPathList(const QString &input, const QChar delimiter)
 DrmBackend::DrmBackend(Session *session, QObject *parent)
     : OutputBackend(parent)
     , m_udev(std::make_unique<Udev>())
-    , m_udevMonitor(m_udev->monitor())
     , m_session(session)
     , m_explicitGpus(splitPathList(qEnvironmentVariable("KWIN_DRM_DEVICES"), ':'))
     , m_dpmsFilter()
@@ -160,57 +162,56 @@ bool DrmBackend::initialize()
         return false;
     }
 
-    // setup udevMonitor
-    if (m_udevMonitor) {
-        m_udevMonitor->filterSubsystemDevType("drm");
-        const int fd = m_udevMonitor->fd();
-        if (fd != -1) {
-            m_socketNotifier = std::make_unique<QSocketNotifier>(fd, QSocketNotifier::Read);
-            connect(m_socketNotifier.get(), &QSocketNotifier::activated, this, &DrmBackend::handleUdevEvent);
-            m_udevMonitor->enable();
-        }
+    // the udev events are received and parsed on a worker thread
+    m_udevMonitor = std::make_unique<UdevMonitorThread>(QVector<QByteArray>{QByteArrayLiteral("drm")});
+    if (m_udevMonitor->isValid()) {
+        connect(m_udevMonitor.get(), &UdevMonitorThread::deviceEvent, this, &DrmBackend::handleUdevEvent);
     }
     return true;
 }
 
-void DrmBackend::handleUdevEvent()
+void DrmBackend::handleUdevEvent(const UdevDeviceEvent &event)
 {
-    while (auto device = m_udevMonitor->getDevice()) {
-        // Ignore the device seat if the KWIN_DRM_DEVICES envvar is set.
-        if (!m_explicitGpus.isEmpty()) {
-            if (!m_explicitGpus.contains(device->devNode())) {
-                continue;
-            }
-        } else {
-            if (device->seat() != m_session->seat()) {
-                continue;
-            }
+    // Ignore the device seat if the KWIN_DRM_DEVICES envvar is set.
+    if (!m_explicitGpus.isEmpty()) {
+        if (!m_explicitGpus.contains(event.devNode)) {
+            return;
+        }
+    } else {
+        if (event.seat != m_session->seat()) {
+            return;
         }
+    }
 
-        if (device->action() == QStringLiteral("add")) {
-            if (addGpu(device->devNode())) {
+    if (event.action == QStringLiteral("add")) {
+        if (addGpu(event.devNode)) {
+            // probing the displays can take a while, don't block the compositor meanwhile
+            probeOutputs();
+        }
+    } else if (event.action == QStringLiteral("remove")) {
+        DrmGpu *gpu = findGpu(event.devNum);
+        if (gpu) {
+            if (primaryGpu() == gpu) {
+                qCCritical(KWIN_DRM) << "Primary gpu has been removed! Quitting...";
+                QCoreApplication::exit(1);
+                return;
+            } else {
+                gpu->setRemoved();
                 updateOutputs();
             }
-        } else if (device->action() == QStringLiteral("remove")) {
-            DrmGpu *gpu = findGpu(device->devNum());
-            if (gpu) {
-                if (primaryGpu() == gpu) {
-                    qCCritical(KWIN_DRM) << "Primary gpu has been removed! Quitting...";
-                    QCoreApplication::exit(1);
-                    return;
-                } else {
-                    gpu->setRemoved();
-                    updateOutputs();
-                }
-            }
-        } else if (device->action() == QStringLiteral("change")) {
-            DrmGpu *gpu = findGpu(device->devNum());
-            if (!gpu) {
-                gpu = addGpu(device->devNode());
-            }
-            if (gpu && gpu->isActive()) {
-                qCDebug(KWIN_DRM) << "Received change event for monitored drm device" << gpu->devNode();
-                updateOutputs();
+        }
+    } else if (event.action == QStringLiteral("change")) {
+        DrmGpu *gpu = findGpu(event.devNum);
+        if (!gpu) {
+            gpu = addGpu(event.devNode);
+        }
+        if (gpu && gpu->isActive()) {
+            qCDebug(KWIN_DRM) << "Received change event for monitored drm device" << gpu->devNode();
+            if (event.lease) {
+                // nothing but the leases changed, the other outputs don't need to be probed and tested
+                gpu->updateLeases();
+            } else {
+                probeOutputs();
             }
         }
     }
@@ -263,13 +264,87 @@ void DrmBackend::removeOutput(DrmAbstractOutput *o)
     Q_EMIT outputRemoved(o);
 }
 
+namespace
+{
+struct GpuToProbe
+{
+    dev_t deviceId;
+    FileDescriptor fd;
+};
+}
+
+static DrmBackend::ProbeResults probeGpus(const std::vector<GpuToProbe> &gpus)
+{
+    std::vector<std::shared_ptr<DrmProbeResult>> results(gpus.size());
+    std::vector<std::thread> threads;
+    threads.reserve(gpus.size());
+    for (size_t i = 0; i < gpus.size(); i++) {
+        threads.emplace_back([&gpus, &results, i]() {
+            results[i] = DrmGpu::probe(gpus[i].fd.get());
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    DrmBackend::ProbeResults ret;
+    for (size_t i = 0; i < gpus.size(); i++) {
+        ret[gpus[i].deviceId] = results[i];
+    }
+    return ret;
+}
+
+static std::vector<GpuToProbe> gpusToProbe(const std::vector<std::unique_ptr<DrmGpu>> &gpus)
+{
+    std::vector<GpuToProbe> ret;
+    for (const auto &gpu : gpus) {
+        if (!gpu->isRemoved() && gpu->isActive()) {
+            // the gpu may be removed while it's being probed, the duplicate keeps the fd valid
+            ret.push_back(GpuToProbe{
+                .deviceId = gpu->deviceId(),
+                .fd = FileDescriptor(fcntl(gpu->fd(), F_DUPFD_CLOEXEC, 0)),
+            });
+        }
+    }
+    return ret;
+}
+
+void DrmBackend::probeOutputs()
+{
+    if (m_probeWatcher) {
+        // the running probe may have missed the change
+        m_probeAgain = true;
+        return;
+    }
+    m_probeWatcher = std::make_unique<QFutureWatcher<ProbeResults>>();
+    connect(m_probeWatcher.get(), &QFutureWatcher<ProbeResults>::finished, this, [this]() {
+        const ProbeResults results = m_probeWatcher->result();
+        m_probeWatcher.release()->deleteLater();
+        if (std::exchange(m_probeAgain, false)) {
+            probeOutputs();
+        } else {
+            applyProbeResults(results);
+        }
+    });
+    auto gpus = std::make_shared<std::vector<GpuToProbe>>(gpusToProbe(m_gpus));
+    m_probeWatcher->setFuture(QtConcurrent::run([gpus]() {
+        return probeGpus(*gpus);
+    }));
+}
+
 void DrmBackend::updateOutputs()
+{
+    // the gpus are probed in parallel, so this takes only as long as the slowest gpu
+    applyProbeResults(probeGpus(gpusToProbe(m_gpus)));
+}
+
+void DrmBackend::applyProbeResults(const ProbeResults &results)
 {
     for (auto it = m_gpus.begin(); it != m_gpus.end(); ++it) {
         if ((*it)->isRemoved()) {
             (*it)->removeOutputs();
         } else {
-            (*it)->updateOutputs();
+            // gpus that were added after the probe started probe themselves
+            (*it)->updateOutputs(results.value((*it)->deviceId()));
         }
     }
 
@@ -418,7 +493,18 @@ bool DrmBackend::applyOutputChanges(const OutputConfiguration &config)
 {
     QVector<DrmOutput *> toBeEnabled;
     QVector<DrmOutput *> toBeDisabled;
+    const auto revert = [&toBeEnabled, &toBeDisabled]() {
+        for (const auto &output : std::as_const(toBeEnabled)) {
+            output->revertQueuedChanges();
+        }
+        for (const auto &output : std::as_const(toBeDisabled)) {
+            output->revertQueuedChanges();
+        }
+    };
+    // queue the whole configuration first and test it with one commit per gpu
+    QVector<DrmGpu *> modesetGpus;
     for (const auto &gpu : std::as_const(m_gpus)) {
+        bool needsTest = false;
         const auto &outputs = gpu->drmOutputs();
         for (const auto &output : outputs) {
             if (output->isNonDesktop()) {
@@ -426,6 +512,7 @@ bool DrmBackend::applyOutputChanges(const OutputConfiguration &config)
             }
             if (const auto changeset = config.constChangeSet(output)) {
                 output->queueChanges(changeset);
+                needsTest |= output->pipeline()->hasPendingModesetChanges();
                 if (changeset->enabled) {
                     toBeEnabled << output;
                 } else {
@@ -433,15 +520,15 @@ bool DrmBackend::applyOutputChanges(const OutputConfiguration &config)
                 }
             }
         }
+        // changes like the position or the scale don't touch the kernel state, skip the test for them
+        if (!needsTest) {
+            continue;
+        }
         if (gpu->testPendingConfiguration() != DrmPipeline::Error::None) {
-            for (const auto &output : std::as_const(toBeEnabled)) {
-                output->revertQueuedChanges();
-            }
-            for (const auto &output : std::as_const(toBeDisabled)) {
-                output->revertQueuedChanges();
-            }
+            revert();
             return false;
         }
+        modesetGpus << gpu.get();
     }
     // first, apply changes to drm outputs.
     // This may remove the placeholder output and thus change m_outputs!
@@ -455,6 +542,13 @@ bool DrmBackend::applyOutputChanges(const OutputConfiguration &config)
             output->applyQueuedChanges(changeset);
         }
     }
+    // Then do one modeset per gpu. If outputs got enabled, it's deferred until
+    // all of them have presented a frame, so the whole change needs only one blank
+    for (const auto gpu : std::as_const(modesetGpus)) {
+        if (gpu->needsModeset()) {
+            gpu->maybeModeset();
+        }
+    }
     // only then apply changes to the virtual outputs
     for (const auto &gpu : std::as_const(m_gpus)) {
         const auto &outputs = gpu->virtualOutputs();
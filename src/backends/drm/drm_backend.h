@@ -11,6 +11,7 @@
 
 #include "dpmsinputeventfilter.h"
 
+#include <QFutureWatcher>
 #include <QPointer>
 #include <QSize>
 #include <QSocketNotifier>
@@ -25,14 +26,16 @@ namespace KWin
 
 class Session;
 class Udev;
-class UdevMonitor;
+class UdevMonitorThread;
 class UdevDevice;
+struct UdevDeviceEvent;
 
 class DrmAbstractOutput;
 class Cursor;
 class DrmGpu;
 class DrmVirtualOutput;
 class DrmRenderBackend;
+struct DrmProbeResult;
 
 class KWIN_EXPORT DrmBackend : public OutputBackend
 {
@@ -74,6 +77,8 @@ public:
     void releaseBuffers();
     void updateOutputs();
 
+    using ProbeResults = QHash<dev_t, std::shared_ptr<DrmProbeResult>>;
+
     const std::vector<std::unique_ptr<DrmGpu>> &gpus() const;
 
 public Q_SLOTS:
@@ -91,12 +96,13 @@ private:
     friend class DrmGpu;
     void addOutput(DrmAbstractOutput *output);
     void removeOutput(DrmAbstractOutput *output);
-    void handleUdevEvent();
+    void handleUdevEvent(const UdevDeviceEvent &event);
     DrmGpu *addGpu(const QString &fileName);
+    void probeOutputs();
+    void applyProbeResults(const ProbeResults &results);
 
     std::unique_ptr<Udev> m_udev;
-    std::unique_ptr<UdevMonitor> m_udevMonitor;
-    std::unique_ptr<QSocketNotifier> m_socketNotifier;
+    std::unique_ptr<UdevMonitorThread> m_udevMonitor;
     Session *m_session;
     QVector<DrmAbstractOutput *> m_outputs;
     DrmVirtualOutput *m_placeHolderOutput = nullptr;
@@ -105,6 +111,8 @@ private:
     std::vector<std::unique_ptr<DrmGpu>> m_gpus;
     std::unique_ptr<DpmsInputEventFilter> m_dpmsFilter;
     DrmRenderBackend *m_renderBackend = nullptr;
+    std::unique_ptr<QFutureWatcher<ProbeResults>> m_probeWatcher;
+    bool m_probeAgain = false;
 
     gbm_bo *createBo(const QSize &size, quint32 format, const QVector<uint64_t> &modifiers);
 };
@@ -9,6 +9,8 @@
 */
 #include "drm_buffer.h"
 
+#include "core/graphicsbuffer.h"
+#include "core/syncobjtimeline.h"
 #include "drm_gpu.h"
 #include "drm_logging.h"
 
@@ -96,9 +98,24 @@ DrmFramebuffer::DrmFramebuffer(const std::shared_ptr<DrmGpuBuffer> &buffer, uint
 {
 }
 
+DrmFramebuffer::DrmFramebuffer(const std::shared_ptr<DrmFramebuffer> &framebuffer, GraphicsBuffer *clientBuffer)
+    : m_framebufferId(framebuffer->framebufferId())
+    , m_gpu(framebuffer->m_gpu)
+    , m_buffer(framebuffer->m_buffer)
+    , m_parent(framebuffer)
+    , m_clientBuffer(clientBuffer)
+{
+    m_clientBuffer->ref();
+}
+
 DrmFramebuffer::~DrmFramebuffer()
 {
-    drmModeRmFB(m_gpu->fd(), m_framebufferId);
+    if (m_clientBuffer) {
+        m_clientBuffer->unref();
+    }
+    if (!m_parent) {
+        drmModeRmFB(m_gpu->fd(), m_framebufferId);
+    }
 }
 
 uint32_t DrmFramebuffer::framebufferId() const
@@ -114,6 +131,25 @@ DrmGpuBuffer *DrmFramebuffer::buffer() const
 void DrmFramebuffer::releaseBuffer()
 {
     m_buffer.reset();
+    if (m_clientBuffer) {
+        m_clientBuffer->unref();
+        m_clientBuffer = nullptr;
+    }
+}
+
+void DrmFramebuffer::setSyncFd(FileDescriptor &&fd)
+{
+    m_syncFd = std::move(fd);
+}
+
+const FileDescriptor &DrmFramebuffer::syncFd() const
+{
+    return m_syncFd;
+}
+
+void DrmFramebuffer::setReleasePoint(const std::shared_ptr<SyncReleasePoint> &releasePoint)
+{
+    m_releasePoint = releasePoint;
 }
 
 std::shared_ptr<DrmFramebuffer> DrmFramebuffer::createFramebuffer(const std::shared_ptr<DrmGpuBuffer> &buffer)
@@ -22,6 +22,8 @@ namespace KWin
 
 class DrmGpu;
 class DrmFramebuffer;
+class GraphicsBuffer;
+class SyncReleasePoint;
 
 class DrmGpuBuffer
 {
@@ -57,6 +59,11 @@ class DrmFramebuffer
 {
 public:
     DrmFramebuffer(const std::shared_ptr<DrmGpuBuffer> &buffer, uint32_t fbId);
+    /**
+     * Creates a framebuffer that presents @p framebuffer again, with its own sync fd and release
+     * point. It keeps @p clientBuffer referenced while it's in use
+     */
+    DrmFramebuffer(const std::shared_ptr<DrmFramebuffer> &framebuffer, GraphicsBuffer *clientBuffer);
     ~DrmFramebuffer();
 
     uint32_t framebufferId() const;
@@ -67,12 +74,27 @@ public:
 
     void releaseBuffer();
 
+    /**
+     * Sets a sync file that the kernel has to wait for before scanning out the buffer
+     */
+    void setSyncFd(FileDescriptor &&fd);
+    const FileDescriptor &syncFd() const;
+    /**
+     * Keeps the release point of the client buffer alive while it's used for scanout
+     */
+    void setReleasePoint(const std::shared_ptr<SyncReleasePoint> &releasePoint);
+
     static std::shared_ptr<DrmFramebuffer> createFramebuffer(const std::shared_ptr<DrmGpuBuffer> &buffer);
 
 protected:
     const uint32_t m_framebufferId;
     DrmGpu *const m_gpu;
     std::shared_ptr<DrmGpuBuffer> m_buffer;
+    // the framebuffer that owns the framebuffer id, if it's shared
+    const std::shared_ptr<DrmFramebuffer> m_parent;
+    GraphicsBuffer *m_clientBuffer = nullptr;
+    FileDescriptor m_syncFd;
+    std::shared_ptr<SyncReleasePoint> m_releasePoint;
 };
 
 }
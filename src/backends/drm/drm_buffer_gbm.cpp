@@ -155,9 +155,8 @@ void GbmBuffer::createFds()
 #endif
 }
 
-std::shared_ptr<GbmBuffer> GbmBuffer::importBuffer(DrmGpu *gpu, KWaylandServer::LinuxDmaBufV1ClientBuffer *clientBuffer)
+static gbm_bo *importDmaBufAttributes(DrmGpu *gpu, const DmaBufAttributes *attrs)
 {
-    const auto *attrs = clientBuffer->dmabufAttributes();
     gbm_bo *bo;
     if (attrs->modifier != DRM_FORMAT_MOD_INVALID || attrs->offset[0] > 0 || attrs->planeCount > 1) {
         gbm_import_fd_modifier_data data = {};
@@ -181,13 +180,27 @@ std::shared_ptr<GbmBuffer> GbmBuffer::importBuffer(DrmGpu *gpu, KWaylandServer::
         data.format = attrs->format;
         bo = gbm_bo_import(gpu->gbmDevice(), GBM_BO_IMPORT_FD, &data, GBM_BO_USE_SCANOUT);
     }
-    if (bo) {
+    return bo;
+}
+
+std::shared_ptr<GbmBuffer> GbmBuffer::importBuffer(DrmGpu *gpu, KWaylandServer::LinuxDmaBufV1ClientBuffer *clientBuffer)
+{
+    if (gbm_bo *bo = importDmaBufAttributes(gpu, clientBuffer->dmabufAttributes())) {
         return std::make_shared<GbmBuffer>(gpu, bo, clientBuffer, GBM_BO_USE_SCANOUT);
     } else {
         return nullptr;
     }
 }
 
+std::shared_ptr<GbmBuffer> GbmBuffer::importDmaBuf(DrmGpu *gpu, const DmaBufAttributes *attributes)
+{
+    if (gbm_bo *bo = importDmaBufAttributes(gpu, attributes)) {
+        return std::make_shared<GbmBuffer>(gpu, bo, GBM_BO_USE_SCANOUT);
+    } else {
+        return nullptr;
+    }
+}
+
 std::shared_ptr<GbmBuffer> GbmBuffer::importBuffer(DrmGpu *gpu, GbmBuffer *buffer, uint32_t flags)
 {
     const auto &fds = buffer->fds();
@@ -25,6 +25,7 @@ class LinuxDmaBufV1ClientBuffer;
 namespace KWin
 {
 
+struct DmaBufAttributes;
 class GbmSurface;
 class GraphicsBuffer;
 class GLTexture;
@@ -46,6 +47,10 @@ public:
     bool map(uint32_t flags);
 
     static std::shared_ptr<GbmBuffer> importBuffer(DrmGpu *gpu, KWaylandServer::LinuxDmaBufV1ClientBuffer *clientBuffer);
+    /**
+     * Imports the dmabuf without referencing the client buffer it belongs to
+     */
+    static std::shared_ptr<GbmBuffer> importDmaBuf(DrmGpu *gpu, const DmaBufAttributes *attributes);
     static std::shared_ptr<GbmBuffer> importBuffer(DrmGpu *gpu, GbmBuffer *buffer, uint32_t flags = GBM_BO_USE_SCANOUT);
 
 private:
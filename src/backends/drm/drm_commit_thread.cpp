@@ -0,0 +1,156 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "drm_commit_thread.h"
+#include "drm_atomic_commit.h"
+#include "drm_logging.h"
+#include "utils/realtime.h"
+
+#include <cerrno>
+#include <cstring>
+
+namespace KWin
+{
+
+// the time the kernel needs to program a commit before the vblank it targets
+static constexpr std::chrono::microseconds s_safetyMargin(1500);
+
+static std::chrono::steady_clock::time_point toTimePoint(std::chrono::nanoseconds timestamp)
+{
+    return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timestamp));
+}
+
+DrmCommitThread::DrmCommitThread()
+{
+    m_thread = std::thread(&DrmCommitThread::run, this);
+}
+
+DrmCommitThread::~DrmCommitThread()
+{
+    {
+        std::unique_lock lock(m_mutex);
+        m_quit = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+void DrmCommitThread::addCommit(std::unique_ptr<DrmAtomicCommit> &&commit, std::chrono::nanoseconds targetTimestamp)
+{
+    std::unique_ptr<DrmAtomicCommit> replaced;
+    {
+        std::unique_lock lock(m_mutex);
+        // the frames of the replaced commit are shown with the new one
+        replaced = std::move(m_pending);
+        m_pending = std::move(commit);
+        m_pendingTarget = targetTimestamp;
+        m_pendingFrames++;
+    }
+    m_condition.notify_all();
+}
+
+int DrmCommitThread::pageFlipped()
+{
+    std::unique_ptr<DrmAtomicCommit> previous;
+    int frames = 0;
+    {
+        std::unique_lock lock(m_mutex);
+        if (!m_submitted) {
+            return 0;
+        }
+        previous = std::move(m_current);
+        m_current = std::move(m_submitted);
+        frames = std::exchange(m_submittedFrames, 0);
+        m_pageflipPending = false;
+    }
+    m_condition.notify_all();
+    return frames;
+}
+
+void DrmCommitThread::flush()
+{
+    {
+        std::unique_lock lock(m_mutex);
+        m_flush = true;
+        m_condition.notify_all();
+        m_condition.wait(lock, [this]() {
+            // the kernel only accepts the queued commit once the pending page flip is done,
+            // which the caller has to wait for itself
+            return !m_committing && (!m_pending || m_pageflipPending);
+        });
+        m_flush = false;
+    }
+    handleFailedCommits();
+}
+
+bool DrmCommitThread::isBusy() const
+{
+    std::unique_lock lock(m_mutex);
+    return m_pending || m_submitted;
+}
+
+void DrmCommitThread::handleFailedCommits()
+{
+    std::vector<FailedCommit> failed;
+    {
+        std::unique_lock lock(m_mutex);
+        failed.swap(m_failed);
+    }
+    for (const FailedCommit &commit : failed) {
+        Q_EMIT commitFailed(commit.frames, commit.error);
+    }
+}
+
+void DrmCommitThread::run()
+{
+    gainRealTime();
+
+    std::unique_lock lock(m_mutex);
+    while (true) {
+        m_condition.wait(lock, [this]() {
+            return m_quit || (m_pending && !m_pageflipPending);
+        });
+        if (m_quit) {
+            return;
+        }
+        if (!m_flush && m_pendingTarget != std::chrono::nanoseconds::zero()) {
+            const auto deadline = toTimePoint(m_pendingTarget - s_safetyMargin);
+            if (std::chrono::steady_clock::now() < deadline) {
+                // the commit may be replaced or flushed in the meantime, check again afterwards
+                m_condition.wait_until(lock, deadline);
+                continue;
+            }
+        }
+
+        m_submitted = std::move(m_pending);
+        m_submittedFrames = std::exchange(m_pendingFrames, 0);
+        m_pageflipPending = true;
+        m_committing = true;
+        DrmAtomicCommit *commit = m_submitted.get();
+
+        // the page flip event is dispatched on the main thread and may arrive before the lock
+        // is taken again, the commit stays alive in m_current then
+        lock.unlock();
+        const bool success = commit->commit();
+        const int error = errno;
+        lock.lock();
+        m_committing = false;
+
+        if (!success) {
+            qCWarning(KWIN_DRM) << "Atomic commit failed in the commit thread:" << strerror(error);
+            m_failed.push_back(FailedCommit{
+                .commit = std::move(m_submitted),
+                .frames = std::exchange(m_submittedFrames, 0),
+                .error = error,
+            });
+            m_pageflipPending = false;
+            QMetaObject::invokeMethod(this, &DrmCommitThread::handleFailedCommits, Qt::QueuedConnection);
+        }
+        m_condition.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QObject>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace KWin
+{
+
+class DrmAtomicCommit;
+
+/**
+ * The DrmCommitThread class submits the atomic commits of a pipeline from a dedicated thread.
+ *
+ * Each commit is submitted as late as possible while still making it in time for the vblank
+ * it targets, so hiccups of the main thread between rendering a frame and presenting it don't
+ * delay the frame. If a commit is added while the previous one is still waiting, the previous
+ * one is replaced and never submitted; mailbox semantics.
+ *
+ * All methods except the thread's own loop must be called from the main thread. The commits
+ * are always destroyed on the main thread as well, as they keep drm framebuffers and blobs alive.
+ */
+class DrmCommitThread : public QObject
+{
+    Q_OBJECT
+
+public:
+    DrmCommitThread();
+    ~DrmCommitThread() override;
+
+    /**
+     * Queues the @p commit, to be presented at @p targetTimestamp. If the target timestamp is
+     * zero, the commit is submitted as soon as the kernel accepts a new commit.
+     */
+    void addCommit(std::unique_ptr<DrmAtomicCommit> &&commit, std::chrono::nanoseconds targetTimestamp);
+
+    /**
+     * Notifies the thread that the last submitted commit has been applied by the kernel. Returns
+     * the number of frames that the commit presented, including the frames it replaced.
+     */
+    int pageFlipped();
+
+    /**
+     * Submits the queued commit right away, without waiting for its deadline, and blocks until
+     * it has been handed to the kernel.
+     */
+    void flush();
+
+    /**
+     * Returns @c true if there's a commit that is either queued or waiting for its page flip.
+     */
+    bool isBusy() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted when submitting a commit failed, @p frames is the number of frames that got lost
+     * and @p error the errno of the commit.
+     */
+    void commitFailed(int frames, int error);
+
+private:
+    void run();
+    void handleFailedCommits();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+
+    // the commit waiting for its deadline
+    std::unique_ptr<DrmAtomicCommit> m_pending;
+    std::chrono::nanoseconds m_pendingTarget = std::chrono::nanoseconds::zero();
+    int m_pendingFrames = 0;
+    // the commit that waits for its page flip
+    std::unique_ptr<DrmAtomicCommit> m_submitted;
+    int m_submittedFrames = 0;
+    // the commit on the screen, it keeps the framebuffers alive until they're replaced
+    std::unique_ptr<DrmAtomicCommit> m_current;
+    struct FailedCommit
+    {
+        std::unique_ptr<DrmAtomicCommit> commit;
+        int frames;
+        int error;
+    };
+    std::vector<FailedCommit> m_failed;
+    bool m_pageflipPending = false;
+    bool m_committing = false;
+    bool m_flush = false;
+    bool m_quit = false;
+};
+
+}
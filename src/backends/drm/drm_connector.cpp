@@ -130,7 +130,8 @@ DrmConnector::DrmConnector(DrmGpu *gpu, uint32_t connectorId)
                                                                QByteArrayLiteral("Full aspect"),
                                                            })
     , m_pipeline(std::make_unique<DrmPipeline>(this))
-    , m_conn(drmModeGetConnector(gpu->fd(), connectorId))
+    // the encoders don't depend on the connected display, updateProperties() does the probing
+    , m_conn(drmModeGetConnectorCurrent(gpu->fd(), connectorId))
 {
     if (m_conn) {
         for (int i = 0; i < m_conn->count_encoders; ++i) {
@@ -215,8 +216,13 @@ Output::SubPixel DrmConnector::subpixel() const
 
 bool DrmConnector::updateProperties()
 {
-    if (auto connector = drmModeGetConnector(gpu()->fd(), id())) {
-        m_conn.reset(connector);
+    return updateProperties(DrmUniquePtr<drmModeConnector>(drmModeGetConnector(gpu()->fd(), id())));
+}
+
+bool DrmConnector::updateProperties(DrmUniquePtr<drmModeConnector> &&connector)
+{
+    if (connector) {
+        m_conn = std::move(connector);
     } else if (!m_conn) {
         return false;
     }
@@ -52,6 +52,10 @@ public:
     DrmConnector(DrmGpu *gpu, uint32_t connectorId);
 
     bool updateProperties() override;
+    /**
+     * Like updateProperties(), but with the connector state already queried from the kernel
+     */
+    bool updateProperties(DrmUniquePtr<drmModeConnector> &&connector);
     void disable(DrmAtomicCommit *commit) override;
 
     bool isCrtcSupported(DrmCrtc *crtc) const;
@@ -19,7 +19,7 @@
 namespace KWin
 {
 
-DrmCrtc::DrmCrtc(DrmGpu *gpu, uint32_t crtcId, int pipeIndex, DrmPlane *primaryPlane, DrmPlane *cursorPlane)
+DrmCrtc::DrmCrtc(DrmGpu *gpu, uint32_t crtcId, int pipeIndex, DrmPlane *primaryPlane, DrmPlane *cursorPlane, DrmPlane *overlayPlane)
     : DrmObject(gpu, crtcId, DRM_MODE_OBJECT_CRTC)
     , modeId(this, QByteArrayLiteral("MODE_ID"))
     , active(this, QByteArrayLiteral("ACTIVE"))
@@ -27,10 +27,13 @@ DrmCrtc::DrmCrtc(DrmGpu *gpu, uint32_t crtcId, int pipeIndex, DrmPlane *primaryP
     , gammaLut(this, QByteArrayLiteral("GAMMA_LUT"))
     , gammaLutSize(this, QByteArrayLiteral("GAMMA_LUT_SIZE"))
     , ctm(this, QByteArrayLiteral("CTM"))
+    , degammaLut(this, QByteArrayLiteral("DEGAMMA_LUT"))
+    , degammaLutSize(this, QByteArrayLiteral("DEGAMMA_LUT_SIZE"))
     , m_crtc(drmModeGetCrtc(gpu->fd(), crtcId))
     , m_pipeIndex(pipeIndex)
     , m_primaryPlane(primaryPlane)
     , m_cursorPlane(cursorPlane)
+    , m_overlayPlane(overlayPlane)
 {
 }
 
@@ -46,6 +49,8 @@ bool DrmCrtc::updateProperties()
     gammaLut.update(props);
     gammaLutSize.update(props);
     ctm.update(props);
+    degammaLut.update(props);
+    degammaLutSize.update(props);
 
     return !gpu()->atomicModeSetting() || (modeId.isValid() && active.isValid());
 }
@@ -98,6 +103,14 @@ int DrmCrtc::gammaRampSize() const
     return m_crtc->gamma_size;
 }
 
+int DrmCrtc::degammaRampSize() const
+{
+    if (degammaLut.isValid() && degammaLutSize.isValid() && degammaLutSize.value() <= 4096) {
+        return degammaLutSize.value();
+    }
+    return 0;
+}
+
 DrmPlane *DrmCrtc::primaryPlane() const
 {
     return m_primaryPlane;
@@ -108,6 +121,11 @@ DrmPlane *DrmCrtc::cursorPlane() const
     return m_cursorPlane;
 }
 
+DrmPlane *DrmCrtc::overlayPlane() const
+{
+    return m_overlayPlane;
+}
+
 void DrmCrtc::disable(DrmAtomicCommit *commit)
 {
     commit->addProperty(active, 0);
@@ -26,15 +26,20 @@ class DrmPlane;
 class DrmCrtc : public DrmObject
 {
 public:
-    DrmCrtc(DrmGpu *gpu, uint32_t crtcId, int pipeIndex, DrmPlane *primaryPlane, DrmPlane *cursorPlane);
+    DrmCrtc(DrmGpu *gpu, uint32_t crtcId, int pipeIndex, DrmPlane *primaryPlane, DrmPlane *cursorPlane, DrmPlane *overlayPlane = nullptr);
 
     void disable(DrmAtomicCommit *commit) override;
     bool updateProperties() override;
 
     int pipeIndex() const;
     int gammaRampSize() const;
+    /**
+     * @returns the size of the lut that is applied before the ctm, or 0 if there is none
+     */
+    int degammaRampSize() const;
     DrmPlane *primaryPlane() const;
     DrmPlane *cursorPlane() const;
+    DrmPlane *overlayPlane() const;
     drmModeModeInfo queryCurrentMode();
 
     std::shared_ptr<DrmFramebuffer> current() const;
@@ -50,6 +55,8 @@ public:
     DrmProperty gammaLut;
     DrmProperty gammaLutSize;
     DrmProperty ctm;
+    DrmProperty degammaLut;
+    DrmProperty degammaLutSize;
 
 private:
     DrmUniquePtr<drmModeCrtc> m_crtc;
@@ -58,6 +65,7 @@ private:
     int m_pipeIndex;
     DrmPlane *m_primaryPlane;
     DrmPlane *m_cursorPlane;
+    DrmPlane *m_overlayPlane;
 };
 
 }
@@ -35,6 +35,7 @@ void DmabufFeedback::renderingSurface()
 
 void DmabufFeedback::scanoutSuccessful(KWaylandServer::SurfaceInterface *surface)
 {
+    m_attemptedThisFrame = true;
     if (surface != m_surface) {
         if (m_surface && m_surface->dmabufFeedbackV1()) {
             m_surface->dmabufFeedbackV1()->setTranches({});
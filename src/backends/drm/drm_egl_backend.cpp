@@ -17,6 +17,7 @@
 #include "drm_dumb_swapchain.h"
 #include "drm_egl_cursor_layer.h"
 #include "drm_egl_layer.h"
+#include "drm_egl_overlay_layer.h"
 #include "drm_gbm_swapchain.h"
 #include "drm_gpu.h"
 #include "drm_logging.h"
@@ -27,15 +28,18 @@
 #include "kwineglutils_p.h"
 #include "options.h"
 #include "scene/surfaceitem_wayland.h"
+#include "utils/filedescriptor.h"
 #include "wayland/clientconnection.h"
 #include "wayland/linuxdmabufv1clientbuffer.h"
 #include "wayland/surface_interface.h"
+#include "wayland_server.h"
 // kwin libs
 #include "libkwineffects/kwineglimagetexture.h"
 #include "libkwineffects/kwinglplatform.h"
 // system
 #include <drm_fourcc.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <gbm.h>
 #include <unistd.h>
 
@@ -108,6 +112,11 @@ void EglGbmBackend::init()
     }
     initKWinGL();
     initWayland();
+
+    DrmGpu *gpu = m_backend->primaryGpu();
+    if (gpu->syncObjTimelinesSupported() && supportsNativeFence()) {
+        waylandServer()->initLinuxDrmSyncObj(FileDescriptor(fcntl(gpu->fd(), F_DUPFD_CLOEXEC, 0)));
+    }
 }
 
 bool EglGbmBackend::initRenderingContext()
@@ -227,6 +236,12 @@ OutputLayer *EglGbmBackend::cursorLayer(Output *output)
     return static_cast<DrmAbstractOutput *>(output)->cursorLayer();
 }
 
+QList<OutputLayer *> EglGbmBackend::overlayLayers(Output *output)
+{
+    const auto layers = static_cast<DrmAbstractOutput *>(output)->overlayLayers();
+    return QList<OutputLayer *>(layers.begin(), layers.end());
+}
+
 std::shared_ptr<GLTexture> EglGbmBackend::textureForOutput(Output *output) const
 {
     const auto drmOutput = static_cast<DrmAbstractOutput *>(output);
@@ -250,10 +265,18 @@ std::optional<GbmFormat> EglGbmBackend::gbmFormatForDrmFormat(uint32_t format) c
 }
 
 bool EglGbmBackend::prefer10bpc() const
+{
+    return forcedColorDepth() == 10;
+}
+
+std::optional<int> EglGbmBackend::forcedColorDepth() const
 {
     static bool ok = false;
     static const int preferred = qEnvironmentVariableIntValue("KWIN_DRM_PREFER_COLOR_DEPTH", &ok);
-    return !ok || preferred == 30;
+    if (!ok) {
+        return std::nullopt;
+    }
+    return preferred == 30 ? 10 : 8;
 }
 
 std::shared_ptr<DrmPipelineLayer> EglGbmBackend::createPrimaryLayer(DrmPipeline *pipeline)
@@ -266,6 +289,27 @@ std::shared_ptr<DrmOverlayLayer> EglGbmBackend::createCursorLayer(DrmPipeline *p
     return std::make_shared<EglGbmCursorLayer>(this, pipeline);
 }
 
+std::shared_ptr<DrmOverlayLayer> EglGbmBackend::createOverlayLayer(DrmPipeline *pipeline)
+{
+    if (!pipeline->gpu()->atomicModeSetting()) {
+        return nullptr;
+    }
+    return std::make_shared<EglGbmOverlayLayer>(this, pipeline);
+}
+
+std::shared_ptr<DmabufFeedback> EglGbmBackend::dmabufFeedback(DrmPipeline *pipeline)
+{
+    std::erase_if(m_dmabufFeedbacks, [](const auto &entry) {
+        return entry.second.expired();
+    });
+    if (auto feedback = m_dmabufFeedbacks[pipeline].lock()) {
+        return feedback;
+    }
+    auto feedback = std::make_shared<DmabufFeedback>(pipeline->gpu(), this);
+    m_dmabufFeedbacks[pipeline] = feedback;
+    return feedback;
+}
+
 std::shared_ptr<DrmOutputLayer> EglGbmBackend::createLayer(DrmVirtualOutput *output)
 {
     return std::make_shared<VirtualEglGbmLayer>(this, output);
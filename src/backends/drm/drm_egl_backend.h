@@ -39,6 +39,7 @@ class DrmGpu;
 class EglGbmLayer;
 class DrmOutputLayer;
 class DrmPipeline;
+class DmabufFeedback;
 
 struct GbmFormat
 {
@@ -64,12 +65,25 @@ public:
     void present(Output *output) override;
     OutputLayer *primaryLayer(Output *output) override;
     OutputLayer *cursorLayer(Output *output) override;
+    QList<OutputLayer *> overlayLayers(Output *output) override;
 
     void init() override;
     bool prefer10bpc() const override;
+    /**
+     * Returns the color depth that is forced with KWIN_DRM_PREFER_COLOR_DEPTH, if any. Otherwise
+     * the buffer format of an output follows the color depth of its contents.
+     */
+    std::optional<int> forcedColorDepth() const;
     std::shared_ptr<DrmPipelineLayer> createPrimaryLayer(DrmPipeline *pipeline) override;
     std::shared_ptr<DrmOverlayLayer> createCursorLayer(DrmPipeline *pipeline) override;
+    std::shared_ptr<DrmOverlayLayer> createOverlayLayer(DrmPipeline *pipeline) override;
     std::shared_ptr<DrmOutputLayer> createLayer(DrmVirtualOutput *output) override;
+    /**
+     * Returns the dmabuf feedback shared by the layers of the given @a pipeline. A surface can
+     * be a candidate for the primary and for the overlay plane, the layers have to agree on
+     * the feedback that is sent to it.
+     */
+    std::shared_ptr<DmabufFeedback> dmabufFeedback(DrmPipeline *pipeline);
 
     std::shared_ptr<GLTexture> textureForOutput(Output *requestedOutput) const override;
 
@@ -89,6 +103,7 @@ private:
     DrmBackend *m_backend;
     std::map<EglDisplay *, std::unique_ptr<EglContext>> m_contexts;
     QHash<EglDisplay *, QHash<uint32_t, GbmFormat>> m_formats;
+    std::map<DrmPipeline *, std::weak_ptr<DmabufFeedback>> m_dmabufFeedbacks;
 
     friend class EglGbmTexture;
 };
@@ -8,15 +8,24 @@
 */
 #include "drm_egl_cursor_layer.h"
 #include "drm_buffer.h"
+#include "drm_dumb_buffer.h"
 #include "drm_egl_backend.h"
 #include "drm_gpu.h"
+#include "drm_logging.h"
 #include "drm_pipeline.h"
 
+#include <drm_fourcc.h>
 #include <gbm.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace KWin
 {
 
+// one buffer on the screen, one in a pending commit and one to copy the next image into
+static constexpr int s_maxImportBuffers = 3;
+
 static TextureTransforms drmToTextureRotation(DrmPipeline *pipeline)
 {
     auto angle = DrmPlane::transformationToDegrees(pipeline->renderOrientation());
@@ -45,6 +54,7 @@ EglGbmCursorLayer::EglGbmCursorLayer(EglGbmBackend *eglBackend, DrmPipeline *pip
 
 std::optional<OutputLayerBeginFrameInfo> EglGbmCursorLayer::beginFrame()
 {
+    m_importedBuffer.reset();
     return m_surface.startRendering(m_pipeline->gpu()->cursorSize(), drmToTextureRotation(m_pipeline) | TextureTransform::MirrorY, m_pipeline->cursorFormats());
 }
 
@@ -60,7 +70,7 @@ QRegion EglGbmCursorLayer::currentDamage() const
 
 std::shared_ptr<DrmFramebuffer> EglGbmCursorLayer::currentBuffer() const
 {
-    return m_surface.currentBuffer();
+    return m_importedBuffer ? m_importedBuffer : m_surface.currentBuffer();
 }
 
 bool EglGbmCursorLayer::checkTestBuffer()
@@ -70,11 +80,67 @@ bool EglGbmCursorLayer::checkTestBuffer()
 
 void EglGbmCursorLayer::releaseBuffers()
 {
+    m_importedBuffer.reset();
+    m_importBuffers.clear();
     m_surface.destroyResources();
 }
 
 quint32 EglGbmCursorLayer::format() const
 {
-    return m_surface.currentBuffer()->buffer()->format();
+    return currentBuffer()->buffer()->format();
+}
+
+bool EglGbmCursorLayer::importCursorImage(const QImage &image)
+{
+    const QSize size = m_pipeline->gpu()->cursorSize();
+    if (image.width() > size.width() || image.height() > size.height() || !m_pipeline->cursorFormats().contains(DRM_FORMAT_ARGB8888)) {
+        return false;
+    }
+    if (!m_importBuffers.isEmpty() && m_importBuffers.front().buffer->size() != size) {
+        // buffers that are still on the screen are kept alive by the plane
+        m_importBuffers.clear();
+    }
+    // The buffer that is scanned out, or that a pending commit is about to put on the screen,
+    // must not be written to. Their framebuffers are referenced by the plane or the commit
+    auto it = std::find_if(m_importBuffers.begin(), m_importBuffers.end(), [this](const ImportBuffer &importBuffer) {
+        return importBuffer.framebuffer != m_importedBuffer && importBuffer.framebuffer.use_count() == 1;
+    });
+    if (it == m_importBuffers.end()) {
+        if (m_importBuffers.size() >= s_maxImportBuffers) {
+            return false;
+        }
+        auto buffer = DrmDumbBuffer::createDumbBuffer(m_pipeline->gpu(), size, DRM_FORMAT_ARGB8888);
+        if (!buffer || !buffer->map(QImage::Format_ARGB32)) {
+            return false;
+        }
+        auto framebuffer = DrmFramebuffer::createFramebuffer(buffer);
+        if (!framebuffer) {
+            qCWarning(KWIN_DRM, "Failed to create dumb framebuffer for the cursor: %s", strerror(errno));
+            return false;
+        }
+        m_importBuffers.push_back(ImportBuffer{
+            .buffer = buffer,
+            .framebuffer = framebuffer,
+        });
+        it = m_importBuffers.end() - 1;
+    }
+    const auto buffer = it->buffer;
+
+    // the cursor plane expects premultiplied alpha, copy the rows as they are
+    const QImage source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage *target = buffer->image();
+    const int rowSize = source.width() * 4;
+    for (int y = 0; y < target->height(); ++y) {
+        uchar *row = target->scanLine(y);
+        if (y < source.height()) {
+            std::memcpy(row, source.constScanLine(y), rowSize);
+            std::memset(row + rowSize, 0, target->bytesPerLine() - rowSize);
+        } else {
+            std::memset(row, 0, target->bytesPerLine());
+        }
+    }
+
+    m_importedBuffer = it->framebuffer;
+    return true;
 }
 }
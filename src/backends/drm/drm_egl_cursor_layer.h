@@ -15,6 +15,7 @@
 #include <QMap>
 #include <QPointer>
 #include <QRegion>
+#include <QVector>
 #include <epoxy/egl.h>
 #include <optional>
 
@@ -23,6 +24,7 @@ namespace KWin
 
 class EglGbmBackend;
 class DrmGbmBuffer;
+class DrmDumbBuffer;
 
 class EglGbmCursorLayer : public DrmOverlayLayer
 {
@@ -36,9 +38,19 @@ public:
     bool checkTestBuffer() override;
     void releaseBuffers() override;
     quint32 format() const override;
+    bool importCursorImage(const QImage &image) override;
 
 private:
     EglGbmLayerSurface m_surface;
+    struct ImportBuffer
+    {
+        std::shared_ptr<DrmDumbBuffer> buffer;
+        std::shared_ptr<DrmFramebuffer> framebuffer;
+    };
+    // the dumb buffers that cursor images are copied into. A buffer is only reused once the
+    // cursor plane and the commits no longer reference its framebuffer
+    QVector<ImportBuffer> m_importBuffers;
+    std::shared_ptr<DrmFramebuffer> m_importedBuffer;
 };
 
 }
@@ -51,15 +51,18 @@ static TextureTransforms drmToTextureRotation(DrmPipeline *pipeline)
 EglGbmLayer::EglGbmLayer(EglGbmBackend *eglBackend, DrmPipeline *pipeline)
     : DrmPipelineLayer(pipeline)
     , m_surface(pipeline->gpu(), eglBackend)
-    , m_dmabufFeedback(pipeline->gpu(), eglBackend)
+    , m_dmabufFeedback(eglBackend->dmabufFeedback(pipeline))
 {
 }
 
 std::optional<OutputLayerBeginFrameInfo> EglGbmLayer::beginFrame()
 {
     m_scanoutBuffer.reset();
-    m_dmabufFeedback.renderingSurface();
+    m_dmabufFeedback->renderingSurface();
 
+    if (DrmOutput *output = m_pipeline->output()) {
+        m_surface.setColorDepth(output->contentColorDepth());
+    }
     return m_surface.startRendering(m_pipeline->mode()->size(), drmToTextureRotation(m_pipeline) | TextureTransform::MirrorY, m_pipeline->formats());
 }
 
@@ -72,6 +75,11 @@ bool EglGbmLayer::endFrame(const QRegion &renderedRegion, const QRegion &damaged
     return ret;
 }
 
+std::chrono::nanoseconds EglGbmLayer::queryRenderTime() const
+{
+    return m_surface.queryRenderTime();
+}
+
 QRegion EglGbmLayer::currentDamage() const
 {
     return m_currentDamage;
@@ -109,6 +117,10 @@ bool EglGbmLayer::scanout(SurfaceItem *surfaceItem)
     if (surface->bufferTransform() != m_pipeline->output()->transform()) {
         return false;
     }
+    // explicit sync fences can only be passed to the kernel with atomic commits
+    if (surface->bufferAcquireTimeline() && !m_pipeline->gpu()->atomicModeSetting()) {
+        return false;
+    }
     const auto buffer = qobject_cast<KWaylandServer::LinuxDmaBufV1ClientBuffer *>(surface->buffer());
     if (!buffer) {
         return false;
@@ -118,7 +130,7 @@ bool EglGbmLayer::scanout(SurfaceItem *surfaceItem)
 
     const auto formats = m_pipeline->formats();
     if (!formats.contains(dmabufAttributes->format)) {
-        m_dmabufFeedback.scanoutFailed(surface, formats);
+        m_dmabufFeedback->scanoutFailed(surface, formats);
         return false;
     }
     if (dmabufAttributes->modifier == DRM_FORMAT_MOD_INVALID && m_pipeline->gpu()->platform()->gpuCount() > 1) {
@@ -128,21 +140,24 @@ bool EglGbmLayer::scanout(SurfaceItem *surfaceItem)
     if (!formats[dmabufAttributes->format].contains(dmabufAttributes->modifier)) {
         return false;
     }
-    const auto gbmBuffer = GbmBuffer::importBuffer(m_pipeline->gpu(), buffer);
-    if (!gbmBuffer) {
-        m_dmabufFeedback.scanoutFailed(surface, formats);
+    m_scanoutBuffer = m_pipeline->gpu()->importClientBuffer(buffer);
+    if (!m_scanoutBuffer) {
+        m_dmabufFeedback->scanoutFailed(surface, formats);
         return false;
     }
-    m_scanoutBuffer = DrmFramebuffer::createFramebuffer(gbmBuffer);
+    if (m_scanoutBuffer && surface->bufferAcquireTimeline()) {
+        // the acquire point has been signaled before the buffer was applied to the surface
+        m_scanoutBuffer->setReleasePoint(surface->bufferReleasePoint());
+    }
     if (m_scanoutBuffer && m_pipeline->testScanout()) {
-        m_dmabufFeedback.scanoutSuccessful(surface);
+        m_dmabufFeedback->scanoutSuccessful(surface);
         m_currentDamage = surfaceItem->damage();
         surfaceItem->resetDamage();
         // ensure the pixmap is updated when direct scanout ends
         surfaceItem->destroyPixmap();
         return true;
     } else {
-        m_dmabufFeedback.scanoutFailed(surface, formats);
+        m_dmabufFeedback->scanoutFailed(surface, formats);
         m_scanoutBuffer.reset();
         return false;
     }
@@ -38,13 +38,14 @@ public:
     QRegion currentDamage() const override;
     std::shared_ptr<GLTexture> texture() const override;
     void releaseBuffers() override;
+    std::chrono::nanoseconds queryRenderTime() const override;
 
 private:
     std::shared_ptr<DrmFramebuffer> m_scanoutBuffer;
     QRegion m_currentDamage;
 
     EglGbmLayerSurface m_surface;
-    DmabufFeedback m_dmabufFeedback;
+    const std::shared_ptr<DmabufFeedback> m_dmabufFeedback;
 };
 
 }
@@ -19,7 +19,9 @@
 #include "drm_output.h"
 #include "gbm_dmabuf.h"
 #include "kwineglutils_p.h"
+#include "libkwineffects/glrendertimequery.h"
 #include "libkwineffects/kwinglplatform.h"
+#include "platformsupport/scenes/opengl/eglnativefence.h"
 #include "scene/surfaceitem_wayland.h"
 #include "wayland/linuxdmabufv1clientbuffer.h"
 #include "wayland/surface_interface.h"
@@ -33,6 +35,9 @@ namespace KWin
 {
 
 static const QVector<uint64_t> linearModifier = {DRM_FORMAT_MOD_LINEAR};
+static constexpr size_t s_maxPendingTimeQueries = 3;
+// each one keeps its buffers allocated, so only keep a few
+static constexpr size_t s_maxOldSurfaces = 2;
 
 static gbm_format_name_desc formatName(uint32_t format)
 {
@@ -41,6 +46,12 @@ static gbm_format_name_desc formatName(uint32_t format)
     return ret;
 }
 
+static const char *importModeName(int mode)
+{
+    static const char *names[] = {"dmabuf", "linear dmabuf", "egl", "cpu"};
+    return names[mode];
+}
+
 EglGbmLayerSurface::EglGbmLayerSurface(DrmGpu *gpu, EglGbmBackend *eglBackend, BufferTarget target, FormatOption formatOption)
     : m_gpu(gpu)
     , m_eglBackend(eglBackend)
@@ -57,7 +68,7 @@ EglGbmLayerSurface::~EglGbmLayerSurface()
 void EglGbmLayerSurface::destroyResources()
 {
     m_surface = {};
-    m_oldSurface = {};
+    m_oldSurfaces.clear();
 }
 
 std::optional<OutputLayerBeginFrameInfo> EglGbmLayerSurface::startRendering(const QSize &bufferSize, TextureTransforms transformation, const QMap<uint32_t, QVector<uint64_t>> &formats)
@@ -90,6 +101,14 @@ std::optional<OutputLayerBeginFrameInfo> EglGbmLayerSurface::startRendering(cons
     }
     m_surface.currentBuffer = buffer;
 
+    if (!m_surface.freeTimeQueries.empty()) {
+        m_surface.timeQuery = std::move(m_surface.freeTimeQueries.back());
+        m_surface.freeTimeQueries.pop_back();
+    } else {
+        m_surface.timeQuery = std::make_shared<GLRenderTimeQuery>();
+    }
+    m_surface.timeQuery->begin();
+
     return OutputLayerBeginFrameInfo{
         .renderTarget = RenderTarget(fbo.get()),
         .repaint = repaint,
@@ -99,6 +118,14 @@ std::optional<OutputLayerBeginFrameInfo> EglGbmLayerSurface::startRendering(cons
 bool EglGbmLayerSurface::endRendering(const QRegion &damagedRegion)
 {
     m_surface.gbmSwapchain->damage(damagedRegion);
+    m_surface.timeQuery->end();
+    // with a deeper frame queue, several frames can wait for their page flip
+    m_surface.pendingTimeQueries.push_back(std::move(m_surface.timeQuery));
+    while (m_surface.pendingTimeQueries.size() > s_maxPendingTimeQueries) {
+        // the frame failed and never got a page flip
+        m_surface.freeTimeQueries.push_back(std::move(m_surface.pendingTimeQueries.front()));
+        m_surface.pendingTimeQueries.pop_front();
+    }
     glFlush();
     const auto buffer = importBuffer(m_surface, m_surface.currentBuffer);
     if (buffer) {
@@ -119,6 +146,30 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::currentBuffer() const
     return m_surface.currentFramebuffer;
 }
 
+std::chrono::nanoseconds EglGbmLayerSurface::queryRenderTime() const
+{
+    if (m_surface.pendingTimeQueries.empty()) {
+        return std::chrono::nanoseconds::zero();
+    }
+    std::shared_ptr<GLRenderTimeQuery> query = std::move(m_surface.pendingTimeQueries.front());
+    m_surface.pendingTimeQueries.pop_front();
+    m_surface.freeTimeQueries.push_back(query);
+    if (!m_eglBackend->contextObject()->makeCurrent()) {
+        return std::chrono::nanoseconds::zero();
+    }
+    return query->result();
+}
+
+void EglGbmLayerSurface::setColorDepth(int depth)
+{
+    m_colorDepth = depth;
+}
+
+int EglGbmLayerSurface::preferredColorDepth() const
+{
+    return m_eglBackend->forcedColorDepth().value_or(m_colorDepth);
+}
+
 bool EglGbmLayerSurface::doesSurfaceFit(const QSize &size, const QMap<uint32_t, QVector<uint64_t>> &formats) const
 {
     return doesSurfaceFit(m_surface, size, formats);
@@ -143,13 +194,26 @@ bool EglGbmLayerSurface::checkSurface(const QSize &size, const QMap<uint32_t, QV
     if (doesSurfaceFit(m_surface, size, formats)) {
         return true;
     }
-    if (doesSurfaceFit(m_oldSurface, size, formats)) {
-        m_surface = m_oldSurface;
+    const auto it = std::find_if(m_oldSurfaces.begin(), m_oldSurfaces.end(), [this, &size, &formats](const Surface &surface) {
+        return doesSurfaceFit(surface, size, formats);
+    });
+    if (it != m_oldSurfaces.end()) {
+        Surface surface = std::move(*it);
+        m_oldSurfaces.erase(it);
+        if (m_surface.gbmSwapchain) {
+            m_oldSurfaces.push_front(std::move(m_surface));
+        }
+        m_surface = std::move(surface);
         return true;
     }
-    if (const auto newSurface = createSurface(size, formats)) {
-        m_oldSurface = m_surface;
-        m_surface = newSurface.value();
+    if (auto newSurface = createSurface(size, formats)) {
+        if (m_surface.gbmSwapchain) {
+            m_oldSurfaces.push_front(std::move(m_surface));
+            while (m_oldSurfaces.size() > s_maxOldSurfaces) {
+                m_oldSurfaces.pop_back();
+            }
+        }
+        m_surface = std::move(newSurface.value());
         return true;
     }
     return false;
@@ -160,31 +224,34 @@ bool EglGbmLayerSurface::doesSurfaceFit(const Surface &surface, const QSize &siz
     const auto &swapchain = surface.gbmSwapchain;
     return swapchain
         && swapchain->size() == size
+        && surface.colorDepth == preferredColorDepth()
         && formats.contains(swapchain->format())
         && (surface.forceLinear || swapchain->modifier() == DRM_FORMAT_MOD_INVALID || formats[swapchain->format()].contains(swapchain->modifier()));
 }
 
 std::optional<EglGbmLayerSurface::Surface> EglGbmLayerSurface::createSurface(const QSize &size, const QMap<uint32_t, QVector<uint64_t>> &formats) const
 {
+    const int colorDepth = preferredColorDepth();
     QVector<GbmFormat> preferredFormats;
     QVector<GbmFormat> fallbackFormats;
     for (auto it = formats.begin(); it != formats.end(); it++) {
         const auto format = m_eglBackend->gbmFormatForDrmFormat(it.key());
         if (format.has_value() && format->bpp >= 24) {
-            if (format->bpp <= 32) {
+            if (format->bpp <= 32 || int(format->bpp) == colorDepth * 3) {
                 preferredFormats.push_back(format.value());
             } else {
                 fallbackFormats.push_back(format.value());
             }
         }
     }
-    const auto sort = [this](const auto &lhs, const auto &rhs) {
+    const auto sort = [colorDepth](const auto &lhs, const auto &rhs) {
+        const uint32_t bpp = colorDepth * 3;
         if (lhs.drmFormat == rhs.drmFormat) {
             // prefer having an alpha channel
             return lhs.alphaSize > rhs.alphaSize;
-        } else if (m_eglBackend->prefer10bpc() && ((lhs.bpp == 30) != (rhs.bpp == 30))) {
-            // prefer 10bpc / 30bpp formats
-            return lhs.bpp == 30;
+        } else if ((lhs.bpp == bpp) != (rhs.bpp == bpp)) {
+            // prefer formats that match the color depth of the contents
+            return lhs.bpp == bpp;
         } else {
             // fallback: prefer formats with lower bandwidth requirements
             return lhs.bpp < rhs.bpp;
@@ -204,35 +271,48 @@ std::optional<EglGbmLayerSurface::Surface> EglGbmLayerSurface::createSurface(con
     };
     const auto testFormats = [this, &sort, &doTestFormats](QVector<GbmFormat> &formats) -> std::optional<Surface> {
         std::sort(formats.begin(), formats.end(), sort);
-        if (const auto surface = doTestFormats(formats, MultiGpuImportMode::Dmabuf)) {
-            if (m_gpu != m_eglBackend->gpu()) {
-                qCDebug(KWIN_DRM) << "chose dmabuf import with format" << formatName(surface->gbmSwapchain->format()).name << "and modifier" << surface->gbmSwapchain->modifier();
-            }
-            return surface;
+        if (m_gpu == m_eglBackend->gpu()) {
+            return doTestFormats(formats, MultiGpuImportMode::Dmabuf);
         }
-        if (m_gpu != m_eglBackend->gpu()) {
-            if (const auto surface = doTestFormats(formats, MultiGpuImportMode::LinearDmabuf)) {
-                qCDebug(KWIN_DRM) << "chose linear dmabuf import with format" << formatName(surface->gbmSwapchain->format()).name << "and modifier" << surface->gbmSwapchain->modifier();
+        // sharing the buffer doesn't need a copy at all, nothing can beat that
+        for (const auto mode : {MultiGpuImportMode::Dmabuf, MultiGpuImportMode::LinearDmabuf}) {
+            if (auto surface = doTestFormats(formats, mode)) {
+                qCDebug(KWIN_DRM) << "chose" << importModeName(int(mode)) << "import with format" << formatName(surface->gbmSwapchain->format()).name << "and modifier" << surface->gbmSwapchain->modifier();
                 return surface;
             }
-            if (const auto surface = doTestFormats(formats, MultiGpuImportMode::Egl)) {
-                qCDebug(KWIN_DRM) << "chose egl import with format" << formatName(surface->gbmSwapchain->format()).name << "and modifier" << surface->gbmSwapchain->modifier();
-                return surface;
+        }
+        // Which copy is the cheapest depends a lot on the driver combination and on the bus
+        // between the GPUs, so measure them rather than relying on a fixed order. When both
+        // are equally fast, the EGL copy is preferred
+        std::optional<Surface> best;
+        std::chrono::nanoseconds bestCost = std::chrono::nanoseconds::max();
+        for (const auto mode : {MultiGpuImportMode::Egl, MultiGpuImportMode::DumbBuffer}) {
+            auto surface = doTestFormats(formats, mode);
+            if (!surface) {
+                continue;
             }
-            if (const auto surface = doTestFormats(formats, MultiGpuImportMode::DumbBuffer)) {
-                qCDebug(KWIN_DRM) << "chose cpu import with format" << formatName(surface->gbmSwapchain->format()).name << "and modifier" << surface->gbmSwapchain->modifier();
-                return surface;
+            const std::chrono::nanoseconds cost = measureImportCost(*surface);
+            qCDebug(KWIN_DRM) << importModeName(int(mode)) << "import with format" << formatName(surface->gbmSwapchain->format()).name
+                              << "and modifier" << surface->gbmSwapchain->modifier() << "takes"
+                              << std::chrono::duration_cast<std::chrono::microseconds>(cost).count() << "us";
+            if (!best || cost < bestCost) {
+                best = std::move(surface);
+                bestCost = cost;
             }
         }
-        return std::nullopt;
+        if (best) {
+            qCDebug(KWIN_DRM) << "chose" << importModeName(int(best->importMode)) << "import with format" << formatName(best->gbmSwapchain->format()).name << "and modifier" << best->gbmSwapchain->modifier();
+        }
+        return best;
     };
-    if (const auto ret = testFormats(preferredFormats)) {
-        return ret;
-    } else if (const auto ret = testFormats(fallbackFormats)) {
-        return ret;
-    } else {
-        return std::nullopt;
+    std::optional<Surface> ret = testFormats(preferredFormats);
+    if (!ret) {
+        ret = testFormats(fallbackFormats);
     }
+    if (ret) {
+        ret->colorDepth = colorDepth;
+    }
+    return ret;
 }
 
 std::optional<EglGbmLayerSurface::Surface> EglGbmLayerSurface::createSurface(const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers, MultiGpuImportMode importMode) const
@@ -298,6 +378,29 @@ std::shared_ptr<GbmSwapchain> EglGbmLayerSurface::createGbmSwapchain(DrmGpu *gpu
     return swapchain ? *swapchain : nullptr;
 }
 
+std::chrono::nanoseconds EglGbmLayerSurface::measureImportCost(Surface &surface) const
+{
+    // the surface has already been rendered to once while testing it. The first import of
+    // another buffer may still create textures and framebuffers, so take the faster of two
+    std::chrono::nanoseconds cost = std::chrono::nanoseconds::max();
+    for (int i = 0; i < 2; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        if (!doRenderTestBuffer(surface)) {
+            return std::chrono::nanoseconds::max();
+        }
+        if (surface.importMode == MultiGpuImportMode::Egl) {
+            // the copy is only queued up, wait for the secondary GPU to do it
+            if (const auto context = m_eglBackend->contextForGpu(m_gpu); context && context->makeCurrent()) {
+                glFinish();
+                context->doneCurrent();
+                m_eglBackend->makeCurrent();
+            }
+        }
+        cost = std::min<std::chrono::nanoseconds>(cost, std::chrono::steady_clock::now() - start);
+    }
+    return cost;
+}
+
 std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::doRenderTestBuffer(Surface &surface) const
 {
     const auto [buffer, repair] = surface.gbmSwapchain->acquire();
@@ -352,7 +455,17 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithEgl(Surface &surfa
     if (!context || context->isSoftwareRenderer()) {
         return nullptr;
     }
+    // Let the secondary GPU wait for the rendering on the primary one, instead of blocking
+    // here or relying on implicit synchronization
+    std::unique_ptr<EGLNativeFence> renderFence;
+    if (m_eglBackend->contextObject()->displayObject()->supportsNativeFence() && context->displayObject()->supportsNativeFence()
+        && m_eglBackend->makeCurrent()) {
+        renderFence = std::make_unique<EGLNativeFence>(m_eglBackend->eglDisplay());
+    }
     context->makeCurrent();
+    if (renderFence && renderFence->isValid()) {
+        EGLNativeFence(context->displayObject()->handle(), renderFence->fileDescriptor().duplicate()).waitSync();
+    }
     auto &sourceTexture = surface.importedTextureCache[sourceBuffer->bo()];
     if (!sourceTexture) {
         if (std::optional<DmaBufAttributes> attributes = dmaBufAttributesForBo(sourceBuffer->bo())) {
@@ -400,11 +513,24 @@ std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithEgl(Surface &surfa
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     context->shaderManager()->popShader();
+    // the kernel waits for the copy to finish before it scans out the buffer, without
+    // blocking either GPU. The in-fence is only available with atomic modesetting
+    FileDescriptor copyFence;
+    if (m_gpu->atomicModeSetting() && context->displayObject()->supportsNativeFence()) {
+        EGLNativeFence fence(context->displayObject()->handle());
+        if (fence.isValid()) {
+            copyFence = fence.fileDescriptor().duplicate();
+        }
+    }
     glFlush();
     // restore the old context
     context->doneCurrent();
     m_eglBackend->makeCurrent();
-    return DrmFramebuffer::createFramebuffer(localBuffer);
+    const auto ret = DrmFramebuffer::createFramebuffer(localBuffer);
+    if (ret && copyFence.isValid()) {
+        ret->setSyncFd(std::move(copyFence));
+    }
+    return ret;
 }
 
 std::shared_ptr<DrmFramebuffer> EglGbmLayerSurface::importWithCpu(Surface &surface, GbmBuffer *sourceBuffer) const
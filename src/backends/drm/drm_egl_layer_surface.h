@@ -12,7 +12,9 @@
 #include <QMap>
 #include <QPointer>
 #include <QRegion>
+#include <deque>
 #include <optional>
+#include <vector>
 
 #include "core/outputlayer.h"
 #include "drm_plane.h"
@@ -37,6 +39,7 @@ class EglGbmBackend;
 class SurfaceItem;
 class GLTexture;
 class GbmBuffer;
+class GLRenderTimeQuery;
 
 class EglGbmLayerSurface : public QObject
 {
@@ -64,6 +67,13 @@ public:
     std::shared_ptr<DrmFramebuffer> renderTestBuffer(const QSize &bufferSize, const QMap<uint32_t, QVector<uint64_t>> &formats);
 
     std::shared_ptr<DrmFramebuffer> currentBuffer() const;
+    std::chrono::nanoseconds queryRenderTime() const;
+
+    /**
+     * Sets the number of bits per color channel of the contents that are rendered. A buffer
+     * format with a higher color depth than 8 bits is only used while such contents are shown.
+     */
+    void setColorDepth(int depth);
 
 private:
     enum class MultiGpuImportMode {
@@ -84,13 +94,21 @@ private:
         std::shared_ptr<DrmFramebuffer> currentFramebuffer;
         QHash<gbm_bo *, std::pair<std::shared_ptr<GLTexture>, std::shared_ptr<GLFramebuffer>>> textureCache;
         bool forceLinear = false;
+        // the color depth the format has been chosen for
+        int colorDepth = 8;
+        std::shared_ptr<GLRenderTimeQuery> timeQuery;
+        // the queries of the frames waiting for their page flip, the oldest frame comes first
+        mutable std::deque<std::shared_ptr<GLRenderTimeQuery>> pendingTimeQueries;
+        mutable std::vector<std::shared_ptr<GLRenderTimeQuery>> freeTimeQueries;
     };
     bool checkSurface(const QSize &size, const QMap<uint32_t, QVector<uint64_t>> &formats);
     bool doesSurfaceFit(const Surface &surface, const QSize &size, const QMap<uint32_t, QVector<uint64_t>> &formats) const;
     std::optional<Surface> createSurface(const QSize &size, const QMap<uint32_t, QVector<uint64_t>> &formats) const;
     std::optional<Surface> createSurface(const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers, MultiGpuImportMode importMode) const;
     std::shared_ptr<GbmSwapchain> createGbmSwapchain(DrmGpu *gpu, const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers, bool forceLinear) const;
+    std::chrono::nanoseconds measureImportCost(Surface &surface) const;
 
+    int preferredColorDepth() const;
     std::shared_ptr<DrmFramebuffer> doRenderTestBuffer(Surface &surface) const;
     std::shared_ptr<DrmFramebuffer> importBuffer(Surface &surface, const std::shared_ptr<GbmBuffer> &sourceBuffer) const;
     std::shared_ptr<DrmFramebuffer> importDmabuf(GbmBuffer *sourceBuffer) const;
@@ -98,12 +116,15 @@ private:
     std::shared_ptr<DrmFramebuffer> importWithCpu(Surface &surface, GbmBuffer *sourceBuffer) const;
 
     Surface m_surface;
-    Surface m_oldSurface;
+    // recently used surfaces, to switch back to an earlier configuration without reallocating
+    // the buffers, the most recently used one comes first
+    std::deque<Surface> m_oldSurfaces;
 
     DrmGpu *const m_gpu;
     EglGbmBackend *const m_eglBackend;
     const BufferTarget m_bufferTarget;
     const FormatOption m_formatOption;
+    int m_colorDepth = 8;
 };
 
 }
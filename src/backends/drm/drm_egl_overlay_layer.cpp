@@ -0,0 +1,148 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "drm_egl_overlay_layer.h"
+#include "drm_backend.h"
+#include "drm_buffer_gbm.h"
+#include "drm_gpu.h"
+#include "drm_output.h"
+#include "drm_pipeline.h"
+#include "scene/surfaceitem_wayland.h"
+#include "wayland/linuxdmabufv1clientbuffer.h"
+#include "wayland/surface_interface.h"
+
+#include <drm_fourcc.h>
+
+namespace KWin
+{
+
+EglGbmOverlayLayer::EglGbmOverlayLayer(EglGbmBackend *eglBackend, DrmPipeline *pipeline)
+    : DrmOverlayLayer(pipeline)
+    , m_dmabufFeedback(eglBackend->dmabufFeedback(pipeline))
+{
+}
+
+std::optional<OutputLayerBeginFrameInfo> EglGbmOverlayLayer::beginFrame()
+{
+    return std::nullopt;
+}
+
+bool EglGbmOverlayLayer::endFrame(const QRegion &renderedRegion, const QRegion &damagedRegion)
+{
+    return false;
+}
+
+bool EglGbmOverlayLayer::scanout(SurfaceItem *surfaceItem)
+{
+    static bool valid;
+    static const bool overlaysDisabled = qEnvironmentVariableIntValue("KWIN_DRM_NO_OVERLAY_PLANES", &valid) == 1 && valid;
+    if (overlaysDisabled) {
+        return false;
+    }
+    // test commits are only possible with atomic modesetting, and they require a buffer on the primary plane
+    if (!m_pipeline->gpu()->atomicModeSetting() || !m_pipeline->primaryLayer()->currentBuffer()) {
+        return false;
+    }
+
+    SurfaceItemWayland *item = qobject_cast<SurfaceItemWayland *>(surfaceItem);
+    if (!item || !item->surface()) {
+        return false;
+    }
+    const auto surface = item->surface();
+    const auto output = m_pipeline->output();
+    // the overlay plane is neither rotated nor scaled, the buffer has to match the output pixels 1:1
+    if (output->transform() != Output::Transform::Normal || surface->bufferTransform() != Output::Transform::Normal) {
+        return false;
+    }
+    const auto buffer = qobject_cast<KWaylandServer::LinuxDmaBufV1ClientBuffer *>(surface->buffer());
+    if (!buffer) {
+        return false;
+    }
+    const QRectF logicalRect = item->mapToGlobal(item->rect()).translated(-output->geometry().topLeft());
+    const QRect deviceRect = QRectF(logicalRect.topLeft() * output->scale(), logicalRect.size() * output->scale()).toRect();
+    if (deviceRect.size() != buffer->size() || !QRect(QPoint(0, 0), output->pixelSize()).contains(deviceRect)) {
+        return false;
+    }
+
+    const DmaBufAttributes *dmabufAttributes = buffer->dmabufAttributes();
+    const auto formats = m_pipeline->overlayFormats();
+    if (!formats.contains(dmabufAttributes->format) || !formats[dmabufAttributes->format].contains(dmabufAttributes->modifier)) {
+        m_dmabufFeedback->scanoutFailed(surface, formats);
+        return false;
+    }
+    if (dmabufAttributes->modifier == DRM_FORMAT_MOD_INVALID && m_pipeline->gpu()->platform()->gpuCount() > 1) {
+        // importing a buffer from another GPU without an explicit modifier can mess up the buffer format
+        return false;
+    }
+    // every new configuration of the planes needs a test commit; a surface that moves, e.g. a
+    // video that is being dragged around, is only considered once it has stayed in place for a
+    // frame, the test results of configurations that were seen before are cached by the pipeline
+    const bool moved = surface != m_candidateSurface || deviceRect.topLeft() != m_candidatePosition;
+    m_candidateSurface = surface;
+    m_candidatePosition = deviceRect.topLeft();
+    if (moved) {
+        return false;
+    }
+    const auto previousBuffer = m_scanoutBuffer;
+    const QPoint previousPosition = m_position;
+    const bool wasVisible = m_visible;
+    m_scanoutBuffer = m_pipeline->gpu()->importClientBuffer(buffer);
+    if (m_scanoutBuffer && surface->bufferAcquireTimeline()) {
+        // the acquire point has been signaled before the buffer was applied to the surface
+        m_scanoutBuffer->setReleasePoint(surface->bufferReleasePoint());
+    }
+    m_position = deviceRect.topLeft();
+    m_visible = true;
+    if (m_scanoutBuffer && m_pipeline->testScanout()) {
+        m_dmabufFeedback->scanoutSuccessful(surface);
+        surfaceItem->resetDamage();
+        return true;
+    } else {
+        m_dmabufFeedback->scanoutFailed(surface, formats);
+        m_scanoutBuffer = previousBuffer;
+        m_position = previousPosition;
+        m_visible = wasVisible;
+        return false;
+    }
+}
+
+void EglGbmOverlayLayer::releaseScanout()
+{
+    // the compositor releases the layer whenever it has no surface for it in a frame, so
+    // this resets the feedback of a surface that is no longer put on the overlay plane
+    m_dmabufFeedback->renderingSurface();
+    m_visible = false;
+    m_scanoutBuffer.reset();
+}
+
+std::shared_ptr<DrmFramebuffer> EglGbmOverlayLayer::currentBuffer() const
+{
+    return m_scanoutBuffer;
+}
+
+bool EglGbmOverlayLayer::hasDirectScanoutBuffer() const
+{
+    return m_scanoutBuffer != nullptr;
+}
+
+bool EglGbmOverlayLayer::checkTestBuffer()
+{
+    return false;
+}
+
+void EglGbmOverlayLayer::releaseBuffers()
+{
+    m_visible = false;
+    m_scanoutBuffer.reset();
+}
+
+quint32 EglGbmOverlayLayer::format() const
+{
+    return m_scanoutBuffer ? m_scanoutBuffer->buffer()->format() : DRM_FORMAT_INVALID;
+}
+}
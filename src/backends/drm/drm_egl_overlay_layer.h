@@ -0,0 +1,58 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+#include "drm_dmabuf_feedback.h"
+#include "drm_layer.h"
+
+#include <QPointer>
+
+namespace KWaylandServer
+{
+class SurfaceInterface;
+}
+
+namespace KWin
+{
+
+class EglGbmBackend;
+
+/**
+ * The EglGbmOverlayLayer class represents an overlay plane of a crtc. It can't be rendered
+ * to, it is only used to scan out client buffers that don't cover the whole output.
+ *
+ * If the buffer of a surface that could be put on the overlay plane has a format or a modifier
+ * that the plane doesn't support, the client is asked to switch to one the plane supports
+ * through the dmabuf feedback of the surface. The feedback is reset once the surface isn't
+ * considered for the overlay plane anymore. It is shared with the primary layer of the pipeline,
+ * so the layers don't reset or override each other's feedback for the same surface.
+ */
+class EglGbmOverlayLayer : public DrmOverlayLayer
+{
+public:
+    EglGbmOverlayLayer(EglGbmBackend *eglBackend, DrmPipeline *pipeline);
+
+    std::optional<OutputLayerBeginFrameInfo> beginFrame() override;
+    bool endFrame(const QRegion &renderedRegion, const QRegion &damagedRegion) override;
+    bool scanout(SurfaceItem *surfaceItem) override;
+    void releaseScanout() override;
+    std::shared_ptr<DrmFramebuffer> currentBuffer() const override;
+    bool hasDirectScanoutBuffer() const override;
+    bool checkTestBuffer() override;
+    void releaseBuffers() override;
+    quint32 format() const override;
+
+private:
+    std::shared_ptr<DrmFramebuffer> m_scanoutBuffer;
+    const std::shared_ptr<DmabufFeedback> m_dmabufFeedback;
+    // the surface that was considered for the overlay plane in the previous frame, and where
+    QPointer<KWaylandServer::SurfaceInterface> m_candidateSurface;
+    QPoint m_candidatePosition;
+};
+
+}
@@ -12,8 +12,10 @@
 
 #include "core/renderloop_p.h"
 #include "core/session.h"
+#include "core/syncobjtimeline.h"
 #include "drm_atomic_commit.h"
 #include "drm_backend.h"
+#include "drm_buffer_gbm.h"
 #include "drm_connector.h"
 #include "drm_crtc.h"
 #include "drm_egl_backend.h"
@@ -25,6 +27,7 @@
 #include "drm_virtual_output.h"
 #include "gbm_dmabuf.h"
 #include "platformsupport/scenes/opengl/abstract_egl_backend.h"
+#include "wayland/linuxdmabufv1clientbuffer.h"
 // system
 #include <algorithm>
 #include <errno.h>
@@ -38,6 +41,10 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 
+#ifndef DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP
+#define DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP 0x15
+#endif
+
 namespace KWin
 {
 
@@ -73,6 +80,17 @@ DrmGpu::DrmGpu(DrmBackend *backend, const QString &devNode, int fd, dev_t device
     m_addFB2ModifiersSupported = drmGetCap(fd, DRM_CAP_ADDFB2_MODIFIERS, &capability) == 0 && capability == 1;
     qCDebug(KWIN_DRM) << "drmModeAddFB2WithModifiers is" << (m_addFB2ModifiersSupported ? "supported" : "not supported") << "on GPU" << m_devNode;
 
+    m_syncObjTimelinesSupported = drmGetCap(fd, DRM_CAP_SYNCOBJ_TIMELINE, &capability) == 0 && capability == 1;
+    if (m_syncObjTimelinesSupported) {
+        // transactions wait for acquire points with eventfds, which are only available since Linux 6.6
+        uint32_t handle = 0;
+        if (drmSyncobjCreate(fd, 0, &handle) == 0) {
+            m_syncObjTimelinesSupported = SyncTimeline(fd, handle).eventFd(1).isValid();
+        } else {
+            m_syncObjTimelinesSupported = false;
+        }
+    }
+
     // find out what driver this kms device is using
     DrmUniquePtr<drmVersion> version(drmGetVersion(fd));
     m_isNVidia = strstr(version->name, "nvidia-drm");
@@ -85,8 +103,9 @@ DrmGpu::DrmGpu(DrmBackend *backend, const QString &devNode, int fd, dev_t device
 
     initDrmResources();
 
-    if (m_atomicModeSetting == false) {
-        // only supported with legacy
+    if (m_atomicModeSetting) {
+        m_asyncPageflipSupported = drmGetCap(fd, DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP, &capability) == 0 && capability == 1;
+    } else {
         m_asyncPageflipSupported = drmGetCap(fd, DRM_CAP_ASYNC_PAGE_FLIP, &capability) == 0 && capability == 1;
     }
 }
@@ -94,6 +113,7 @@ DrmGpu::DrmGpu(DrmBackend *backend, const QString &devNode, int fd, dev_t device
 DrmGpu::~DrmGpu()
 {
     removeOutputs();
+    m_clientFramebuffers.clear();
     m_eglDisplay.reset();
     m_crtcs.clear();
     m_connectors.clear();
@@ -132,10 +152,16 @@ void DrmGpu::initDrmResources()
     // try atomic mode setting
     bool isEnvVarSet = false;
     bool noAMS = qEnvironmentVariableIntValue("KWIN_DRM_NO_AMS", &isEnvVarSet) != 0 && isEnvVarSet;
+    bool lowLatencyCursorSet = false;
+    const bool lowLatencyCursor = qEnvironmentVariableIntValue("KWIN_DRM_LOW_LATENCY_CURSOR", &lowLatencyCursorSet) == 1 && lowLatencyCursorSet;
     if (m_isVirtualMachine && !isEnvVarSet) {
         qCWarning(KWIN_DRM, "Atomic Mode Setting disabled on GPU %s because of cursor offset issues in virtual machines", qPrintable(m_devNode));
     } else if (noAMS) {
         qCWarning(KWIN_DRM) << "Atomic Mode Setting requested off via environment variable. Using legacy mode on GPU" << m_devNode;
+    } else if (lowLatencyCursor) {
+        // the legacy cursor ioctls move the cursor without waiting for a repaint, but they
+        // must not be mixed with atomic commits on the same device
+        qCWarning(KWIN_DRM) << "Low latency cursor requested via environment variable. Using legacy mode on GPU" << m_devNode;
     } else if (drmSetClientCap(m_fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
         qCWarning(KWIN_DRM) << "drmSetClientCap for Atomic Mode Setting failed. Using legacy mode on GPU" << m_devNode;
     } else {
@@ -171,12 +197,15 @@ void DrmGpu::initDrmResources()
         uint32_t crtcId = resources->crtcs[i];
         QVector<DrmPlane *> primaryCandidates;
         QVector<DrmPlane *> cursorCandidates;
+        QVector<DrmPlane *> overlayCandidates;
         for (const auto &plane : m_planes) {
             if (plane->isCrtcSupported(i) && !assignedPlanes.contains(plane.get())) {
                 if (plane->type.enumValue() == DrmPlane::TypeIndex::Primary) {
                     primaryCandidates.push_back(plane.get());
                 } else if (plane->type.enumValue() == DrmPlane::TypeIndex::Cursor) {
                     cursorCandidates.push_back(plane.get());
+                } else if (plane->type.enumValue() == DrmPlane::TypeIndex::Overlay) {
+                    overlayCandidates.push_back(plane.get());
                 }
             }
         }
@@ -203,11 +232,16 @@ void DrmGpu::initDrmResources()
         };
         DrmPlane *primary = findBestPlane(primaryCandidates);
         DrmPlane *cursor = findBestPlane(cursorCandidates);
+        // only take one overlay plane per crtc so that every crtc gets a chance to have one
+        DrmPlane *overlay = findBestPlane(overlayCandidates);
         assignedPlanes.push_back(primary);
         if (cursor) {
             assignedPlanes.push_back(cursor);
         }
-        auto crtc = std::make_unique<DrmCrtc>(this, crtcId, i, primary, cursor);
+        if (overlay) {
+            assignedPlanes.push_back(overlay);
+        }
+        auto crtc = std::make_unique<DrmCrtc>(this, crtcId, i, primary, cursor, overlay);
         if (!crtc->init()) {
             continue;
         }
@@ -216,21 +250,30 @@ void DrmGpu::initDrmResources()
     }
 }
 
-bool DrmGpu::updateOutputs()
+std::shared_ptr<DrmProbeResult> DrmGpu::probe(int fd)
 {
-    if (!m_isActive) {
-        return false;
+    auto ret = std::make_shared<DrmProbeResult>();
+    ret->resources.reset(drmModeGetResources(fd));
+    if (!ret->resources) {
+        return ret;
     }
-    waitIdle();
-    DrmUniquePtr<drmModeRes> resources(drmModeGetResources(m_fd));
-    if (!resources) {
-        qCWarning(KWIN_DRM) << "drmModeGetResources failed";
-        return false;
+    // the kernel probes the connectors of a device with its mode config lock held, querying
+    // them from several threads at once would only make the threads wait for each other
+    for (int i = 0; i < ret->resources->count_connectors; i++) {
+        const uint32_t id = ret->resources->connectors[i];
+        ret->connectors[id].reset(drmModeGetConnector(fd, id));
     }
+    return ret;
+}
 
+void DrmGpu::updateLeases()
+{
     // In principle these things are supposed to be detected through the wayland protocol.
     // In practice SteamVR doesn't always behave correctly
     DrmUniquePtr<drmModeLesseeListRes> lessees{drmModeListLessees(m_fd)};
+    if (!lessees) {
+        return;
+    }
     for (const auto &output : std::as_const(m_drmOutputs)) {
         if (output->lease()) {
             bool leaseActive = false;
@@ -245,6 +288,22 @@ bool DrmGpu::updateOutputs()
             }
         }
     }
+}
+
+bool DrmGpu::updateOutputs(const std::shared_ptr<DrmProbeResult> &probeResult)
+{
+    if (!m_isActive) {
+        return false;
+    }
+    waitIdle();
+    const std::shared_ptr<DrmProbeResult> probed = probeResult ? probeResult : probe(m_fd);
+    const DrmUniquePtr<drmModeRes> &resources = probed->resources;
+    if (!resources) {
+        qCWarning(KWIN_DRM) << "drmModeGetResources failed";
+        return false;
+    }
+
+    updateLeases();
 
     // check for added and removed connectors
     QVector<DrmConnector *> existing;
@@ -256,14 +315,14 @@ bool DrmGpu::updateOutputs()
         });
         if (it == m_connectors.end()) {
             auto conn = std::make_shared<DrmConnector>(this, currentConnector);
-            if (!conn->init()) {
+            if (!conn->updateProperties(std::move(probed->connectors[currentConnector]))) {
                 continue;
             }
             existing.push_back(conn.get());
             m_allObjects.push_back(conn.get());
             m_connectors.push_back(std::move(conn));
         } else {
-            (*it)->updateProperties();
+            (*it)->updateProperties(std::move(probed->connectors[currentConnector]));
             existing.push_back(it->get());
         }
     }
@@ -283,7 +342,7 @@ bool DrmGpu::updateOutputs()
             m_drmOutputs << output;
             addedOutputs << output;
             Q_EMIT outputAdded(output);
-            pipeline->setLayers(m_platform->renderBackend()->createPrimaryLayer(pipeline), m_platform->renderBackend()->createCursorLayer(pipeline));
+            pipeline->setLayers(m_platform->renderBackend()->createPrimaryLayer(pipeline), m_platform->renderBackend()->createCursorLayer(pipeline), m_platform->renderBackend()->createOverlayLayer(pipeline));
             pipeline->setActive(!conn->isNonDesktop());
             pipeline->applyPendingChanges();
         }
@@ -303,6 +362,10 @@ bool DrmGpu::updateOutputs()
     for (const auto &plane : std::as_const(m_planes)) {
         plane->updateProperties();
     }
+    // the hardware limits may have changed with the new configuration
+    for (const auto &pipeline : std::as_const(m_pipelines)) {
+        pipeline->invalidateScanoutTests();
+    }
     DrmPipeline::Error err = testPendingConfiguration();
     if (err == DrmPipeline::Error::None) {
         for (const auto &pipeline : std::as_const(m_pipelines)) {
@@ -476,6 +539,9 @@ void DrmGpu::waitIdle()
 {
     m_socketNotifier->setEnabled(false);
     while (true) {
+        for (DrmOutput *output : std::as_const(m_drmOutputs)) {
+            output->pipeline()->flushCommits();
+        }
         const bool idle = std::all_of(m_drmOutputs.constBegin(), m_drmOutputs.constEnd(), [](DrmOutput *output) {
             return !output->pipeline()->pageflipPending();
         });
@@ -547,7 +613,7 @@ void DrmGpu::pageFlipHandler(int fd, unsigned int sequence, unsigned int sec, un
     if (it == pipelines.end()) {
         qCWarning(KWIN_DRM, "received invalid page flip event for crtc %u", crtc_id);
     } else {
-        (*it)->pageFlipped(timestamp);
+        (*it)->pageFlipped(timestamp, sequence, PresentationFlag::HwClock | PresentationFlag::HwCompletion);
     }
 }
 
@@ -563,7 +629,7 @@ void DrmGpu::removeOutput(DrmOutput *output)
 {
     qCDebug(KWIN_DRM) << "Removing output" << output;
     m_pipelines.removeOne(output->pipeline());
-    output->pipeline()->setLayers(nullptr, nullptr);
+    output->pipeline()->setLayers(nullptr, nullptr, nullptr);
     m_drmOutputs.removeOne(output);
     Q_EMIT outputRemoved(output);
     output->unref();
@@ -677,6 +743,11 @@ bool DrmGpu::asyncPageflipSupported() const
     return m_asyncPageflipSupported;
 }
 
+bool DrmGpu::syncObjTimelinesSupported() const
+{
+    return m_syncObjTimelinesSupported;
+}
+
 bool DrmGpu::isNVidia() const
 {
     return m_isNVidia;
@@ -701,7 +772,9 @@ void DrmGpu::setActive(bool active)
                 output->renderLoop()->uninhibit();
             }
             // while the session was inactive, the output list may have changed
-            m_platform->updateOutputs();
+            if (!restoreState()) {
+                m_platform->updateOutputs();
+            }
         } else {
             for (const auto &output : std::as_const(m_drmOutputs)) {
                 output->renderLoop()->inhibit();
@@ -711,6 +784,68 @@ void DrmGpu::setActive(bool active)
     }
 }
 
+bool DrmGpu::restoreState()
+{
+    if (!m_atomicModeSetting) {
+        return false;
+    }
+    // Probing the connectors again takes a while, and finding a new crtc assignment needs several
+    // test commits. If the displays are still the same as before the session got deactivated,
+    // the previous state is restored with one commit instead, with the buffers kept across
+    DrmUniquePtr<drmModeRes> resources(drmModeGetResources(m_fd));
+    if (!resources || resources->count_connectors != int(m_connectors.size())) {
+        return false;
+    }
+    for (const auto &connector : m_connectors) {
+        const uint32_t id = connector->id();
+        if (std::find(resources->connectors, resources->connectors + resources->count_connectors, id) == resources->connectors + resources->count_connectors) {
+            return false;
+        }
+        // only query the state the kernel already knows about, without probing the display
+        DrmUniquePtr<drmModeConnector> current(drmModeGetConnectorCurrent(m_fd, id));
+        if (!current || (current->connection == DRM_MODE_CONNECTED) != connector->isConnected()) {
+            return false;
+        }
+        // a new edid blob means that the display or its modes have changed
+        DrmUniquePtr<drmModeObjectProperties> properties(drmModeObjectGetProperties(m_fd, id, DRM_MODE_OBJECT_CONNECTOR));
+        if (!properties) {
+            return false;
+        }
+        for (uint32_t i = 0; i < properties->count_props; i++) {
+            if (properties->props[i] == connector->edidProp.propId() && properties->prop_values[i] != connector->edidProp.value()) {
+                return false;
+            }
+        }
+    }
+
+    waitIdle();
+    // the other session may have changed anything about the crtcs and planes
+    for (const auto &crtc : std::as_const(m_crtcs)) {
+        crtc->updateProperties();
+    }
+    for (const auto &plane : std::as_const(m_planes)) {
+        plane->updateProperties();
+    }
+    QVector<DrmPipeline *> pipelines = m_pipelines;
+    for (const auto &output : std::as_const(m_drmOutputs)) {
+        if (output->lease()) {
+            pipelines.removeOne(output->pipeline());
+        }
+    }
+    if (pipelines.isEmpty() || DrmPipeline::commitPipelines(pipelines, DrmPipeline::CommitMode::TestAllowModeset, unusedObjects()) != DrmPipeline::Error::None) {
+        return false;
+    }
+    // the modeset, if one is needed, happens together with the next frame of every output
+    for (const auto &pipeline : std::as_const(pipelines)) {
+        pipeline->applyPendingChanges();
+    }
+    for (const auto &output : std::as_const(m_drmOutputs)) {
+        output->renderLoop()->scheduleRepaint();
+    }
+    qCDebug(KWIN_DRM) << "Restored the previous state of" << m_devNode;
+    return true;
+}
+
 bool DrmGpu::isActive() const
 {
     return m_isActive;
@@ -771,6 +906,7 @@ QVector<DrmObject *> DrmGpu::unusedObjects() const
             ret.removeOne(pipeline->crtc());
             ret.removeOne(pipeline->crtc()->primaryPlane());
             ret.removeOne(pipeline->crtc()->cursorPlane());
+            ret.removeOne(pipeline->crtc()->overlayPlane());
         }
     }
     return ret;
@@ -792,16 +928,45 @@ void DrmGpu::releaseBuffers()
     for (const auto &pipeline : std::as_const(m_pipelines)) {
         pipeline->primaryLayer()->releaseBuffers();
         pipeline->cursorLayer()->releaseBuffers();
+        if (pipeline->overlayLayer()) {
+            pipeline->overlayLayer()->releaseBuffers();
+        }
     }
     for (const auto &output : std::as_const(m_virtualOutputs)) {
         output->primaryLayer()->releaseBuffers();
     }
+    for (const auto &framebuffer : std::as_const(m_clientFramebuffers)) {
+        framebuffer->releaseBuffer();
+    }
+}
+
+std::shared_ptr<DrmFramebuffer> DrmGpu::importClientBuffer(KWaylandServer::LinuxDmaBufV1ClientBuffer *clientBuffer)
+{
+    auto it = m_clientFramebuffers.find(clientBuffer);
+    if (it == m_clientFramebuffers.end() || !(*it)->buffer()) {
+        const auto gbmBuffer = GbmBuffer::importDmaBuf(this, clientBuffer->dmabufAttributes());
+        if (!gbmBuffer) {
+            return nullptr;
+        }
+        auto framebuffer = DrmFramebuffer::createFramebuffer(gbmBuffer);
+        if (!framebuffer) {
+            return nullptr;
+        }
+        if (it == m_clientFramebuffers.end()) {
+            connect(clientBuffer, &QObject::destroyed, this, [this, clientBuffer]() {
+                m_clientFramebuffers.remove(clientBuffer);
+            });
+        }
+        it = m_clientFramebuffers.insert(clientBuffer, framebuffer);
+    }
+    // the cached framebuffer doesn't reference the client buffer, or it could never be released
+    return std::make_shared<DrmFramebuffer>(*it, clientBuffer);
 }
 
 void DrmGpu::recreateSurfaces()
 {
     for (const auto &pipeline : std::as_const(m_pipelines)) {
-        pipeline->setLayers(m_platform->renderBackend()->createPrimaryLayer(pipeline), m_platform->renderBackend()->createCursorLayer(pipeline));
+        pipeline->setLayers(m_platform->renderBackend()->createPrimaryLayer(pipeline), m_platform->renderBackend()->createCursorLayer(pipeline), m_platform->renderBackend()->createOverlayLayer(pipeline));
         pipeline->applyPendingChanges();
     }
     for (const auto &output : std::as_const(m_virtualOutputs)) {
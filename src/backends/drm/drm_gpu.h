@@ -11,6 +11,7 @@
 #include "drm_pipeline.h"
 #include "utils/filedescriptor.h"
 
+#include <QHash>
 #include <QPointer>
 #include <QSize>
 #include <QSocketNotifier>
@@ -19,9 +20,15 @@
 
 #include <epoxy/egl.h>
 #include <sys/types.h>
+#include <unordered_map>
 
 struct gbm_device;
 
+namespace KWaylandServer
+{
+class LinuxDmaBufV1ClientBuffer;
+}
+
 namespace KWin
 {
 
@@ -36,6 +43,17 @@ class DrmAbstractOutput;
 class DrmRenderBackend;
 class DrmVirtualOutput;
 class EglDisplay;
+class DrmFramebuffer;
+class GraphicsBuffer;
+
+/**
+ * The connectors of a gpu as reported by the kernel
+ */
+struct DrmProbeResult
+{
+    DrmUniquePtr<drmModeRes> resources;
+    std::unordered_map<uint32_t, DrmUniquePtr<drmModeConnector>> connectors;
+};
 
 class DrmLease : public QObject
 {
@@ -76,6 +94,7 @@ public:
     bool atomicModeSetting() const;
     bool addFB2ModifiersSupported() const;
     bool asyncPageflipSupported() const;
+    bool syncObjTimelinesSupported() const;
     bool isNVidia() const;
     gbm_device *gbmDevice() const;
     EglDisplay *eglDisplay() const;
@@ -93,7 +112,22 @@ public:
 
     void setEglDisplay(std::unique_ptr<EglDisplay> &&display);
 
-    bool updateOutputs();
+    /**
+     * Queries the connectors of the gpu behind @p fd from the kernel, which makes it probe the
+     * connected displays. That can take hundreds of milliseconds per display. The kernel probes
+     * the connectors of a gpu one after another, but different gpus can be probed at the same
+     * time. This doesn't touch any state of KWin and may be called from a worker thread
+     */
+    static std::shared_ptr<DrmProbeResult> probe(int fd);
+    /**
+     * Updates the outputs, with the results of an earlier probe() if @p probeResult is not null
+     */
+    bool updateOutputs(const std::shared_ptr<DrmProbeResult> &probeResult = nullptr);
+    /**
+     * Ends the leases that the lessees gave up. Unlike updateOutputs(), this doesn't probe
+     * the connectors or test the pipelines of the other outputs.
+     */
+    void updateLeases();
     void removeOutputs();
 
     DrmVirtualOutput *createVirtualOutput(const QString &name, const QSize &size, double scale);
@@ -106,6 +140,13 @@ public:
     void releaseBuffers();
     void recreateSurfaces();
 
+    /**
+     * Returns a framebuffer for the direct scanout of @p clientBuffer. The drm framebuffer is
+     * only created the first time and destroyed together with the client buffer, so clients
+     * that cycle through a few buffers don't cause any AddFB and RmFB calls
+     */
+    std::shared_ptr<DrmFramebuffer> importClientBuffer(KWaylandServer::LinuxDmaBufV1ClientBuffer *clientBuffer);
+
     FileDescriptor createNonMasterFd() const;
     std::unique_ptr<DrmLease> leaseOutputs(const QVector<DrmOutput *> &outputs);
 
@@ -120,6 +161,7 @@ private:
     void removeOutput(DrmOutput *output);
     void initDrmResources();
     void waitIdle();
+    bool restoreState();
 
     DrmPipeline::Error checkCrtcAssignment(QVector<DrmConnector *> connectors, const QVector<DrmCrtc *> &crtcs);
     DrmPipeline::Error testPipelines();
@@ -135,6 +177,7 @@ private:
     bool m_isNVidia;
     bool m_isVirtualMachine;
     bool m_asyncPageflipSupported = false;
+    bool m_syncObjTimelinesSupported = false;
     bool m_isRemoved = false;
     bool m_isActive = true;
     clockid_t m_presentationClock;
@@ -153,6 +196,7 @@ private:
 
     std::unique_ptr<QSocketNotifier> m_socketNotifier;
     QSize m_cursorSize;
+    QHash<GraphicsBuffer *, std::shared_ptr<DrmFramebuffer>> m_clientFramebuffers;
 };
 
 }
@@ -66,4 +66,9 @@ bool DrmOverlayLayer::isVisible() const
 {
     return m_visible;
 }
+
+bool DrmOverlayLayer::importCursorImage(const QImage &image)
+{
+    return false;
+}
 }
@@ -56,6 +56,13 @@ public:
     QPoint position() const;
     bool isVisible() const;
 
+    /**
+     * Copies the given cursor @a image into a buffer of the layer without rendering it. The
+     * pixels of the image must match the pixels of the output. Returns @c false if the layer
+     * can't do that, in which case the cursor has to be rendered.
+     */
+    virtual bool importCursorImage(const QImage &image);
+
 protected:
     QPoint m_position;
     bool m_visible = false;
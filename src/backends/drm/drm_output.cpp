@@ -39,6 +39,7 @@
 #include "core/renderlayer.h"
 #include "cursorsource.h"
 #include "scene/cursorscene.h"
+#include "wayland/surface_interface.h"
 
 namespace KWin
 {
@@ -49,6 +50,7 @@ DrmOutput::DrmOutput(const std::shared_ptr<DrmConnector> &conn)
     , m_connector(conn)
 {
     RenderLoopPrivate::get(m_renderLoop.get())->canDoTearing = gpu()->asyncPageflipSupported();
+    RenderLoopPrivate::get(m_renderLoop.get())->maxPendingFrameCount = m_pipeline->maxPendingFrameCount();
     m_pipeline->setOutput(this);
     m_renderLoop->setRefreshRate(m_pipeline->mode()->refreshRate());
 
@@ -62,6 +64,9 @@ DrmOutput::DrmOutput(const std::shared_ptr<DrmConnector> &conn)
     if (conn->vrrCapable.isValid() && conn->vrrCapable.value()) {
         capabilities |= Capability::Vrr;
         setVrrPolicy(RenderLoop::VrrPolicy::Automatic);
+        if (conn->edid()->minimumRefreshRate() > 0) {
+            RenderLoopPrivate::get(m_renderLoop.get())->minimumAdaptiveRefreshRate = conn->edid()->minimumRefreshRate() * 1000;
+        }
     }
     if (conn->broadcastRGB.isValid()) {
         capabilities |= Capability::RgbRange;
@@ -136,6 +141,26 @@ DrmLease *DrmOutput::lease() const
     return m_lease;
 }
 
+/**
+ * Returns the image of the cursor if its pixels can be put on the cursor plane as they are,
+ * otherwise the cursor has to be rendered.
+ */
+static QImage directCursorImage(CursorSource *source, qreal scale)
+{
+    if (auto surfaceSource = qobject_cast<SurfaceCursorSource *>(source)) {
+        // the image contains only the main surface
+        KWaylandServer::SurfaceInterface *surface = surfaceSource->surface();
+        if (!surface || !surface->below().isEmpty() || !surface->above().isEmpty() || surface->bufferTransform() != Output::Transform::Normal) {
+            return QImage();
+        }
+    }
+    const QImage image = source->image();
+    if (image.isNull() || image.devicePixelRatio() != scale || QSizeF(image.size()) / scale != source->size()) {
+        return QImage();
+    }
+    return image;
+}
+
 bool DrmOutput::setCursor(CursorSource *source)
 {
     static bool valid;
@@ -162,7 +187,14 @@ bool DrmOutput::setCursor(CursorSource *source)
     const QSizeF cursorSize = m_cursor.source->size();
     const QRectF cursorRect = QRectF(m_cursor.position, cursorSize);
     const QRectF nativeCursorRect = monitorMatrix.mapRect(cursorRect);
-    if (nativeCursorRect.width() <= m_gpu->cursorSize().width() && nativeCursorRect.height() <= m_gpu->cursorSize().height()) {
+    const bool fitsCursorPlane = nativeCursorRect.width() <= m_gpu->cursorSize().width() && nativeCursorRect.height() <= m_gpu->cursorSize().height();
+    if (fitsCursorPlane && DrmPlane::transformationToDegrees(m_pipeline->renderOrientation()) % 360 == 0) {
+        // copying the pixels doesn't wake up the gpu, which matters for animated cursors
+        if (const QImage image = directCursorImage(m_cursor.source, scale()); !image.isNull()) {
+            rendered = layer->importCursorImage(image);
+        }
+    }
+    if (fitsCursorPlane && !rendered) {
         if (auto beginInfo = layer->beginFrame()) {
             const RenderTarget &renderTarget = beginInfo->renderTarget;
 
@@ -276,6 +308,9 @@ bool DrmOutput::setDrmDpmsMode(DpmsMode mode)
         m_pipeline->applyPendingChanges();
         updateDpmsMode(mode);
         if (active) {
+            // The modeset is committed together with a freshly rendered frame. The last frame
+            // from before the output was turned off must not be shown again, the screen may
+            // have been locked in the meantime.
             m_gpu->platform()->checkOutputsAreOn();
             m_renderLoop->uninhibit();
             m_renderLoop->scheduleRepaint();
@@ -372,13 +407,16 @@ bool DrmOutput::present()
     if (needsModeset) {
         success = m_pipeline->maybeModeset();
     } else {
-        DrmPipeline::Error err = m_pipeline->present();
+        // without a fixed refresh rate there's no vblank to target
+        const bool fixedRefreshRate = m_pipeline->syncMode() == RenderLoopPrivate::SyncMode::Fixed;
+        DrmPipeline::Error err = m_pipeline->present(fixedRefreshRate ? renderLoopPrivate->nextPresentationTimestamp : std::chrono::nanoseconds::zero());
         success = err == DrmPipeline::Error::None;
         if (err == DrmPipeline::Error::InvalidArguments) {
             QTimer::singleShot(0, m_gpu->platform(), &DrmBackend::updateOutputs);
         }
     }
     if (success) {
+        renderLoopPrivate->notifyFrameCommitted();
         Q_EMIT outputChange(m_pipeline->primaryLayer()->currentDamage());
         return true;
     } else if (!needsModeset) {
@@ -432,10 +470,6 @@ void DrmOutput::applyQueuedChanges(const std::shared_ptr<OutputChangeSet> &props
     setState(next);
     setVrrPolicy(props->vrrPolicy.value_or(vrrPolicy()));
 
-    if (!isEnabled() && m_pipeline->needsModeset()) {
-        m_gpu->maybeModeset();
-    }
-
     m_renderLoop->setRefreshRate(refreshRate());
     m_renderLoop->scheduleRepaint();
 
@@ -461,21 +495,35 @@ DrmOutputLayer *DrmOutput::cursorLayer() const
     return m_pipeline->cursorLayer();
 }
 
+QList<DrmOutputLayer *> DrmOutput::overlayLayers() const
+{
+    if (const auto layer = m_pipeline->overlayLayer(); layer && m_pipeline->crtc() && m_pipeline->crtc()->overlayPlane()) {
+        return {layer};
+    }
+    return {};
+}
+
 bool DrmOutput::setGammaRamp(const std::shared_ptr<ColorTransformation> &transformation)
 {
     if (!m_pipeline->active()) {
         return false;
     }
-    m_pipeline->setGammaRamp(transformation);
-    m_pipeline->setCTM(QMatrix3x3());
-    if (DrmPipeline::commitPipelines({m_pipeline}, DrmPipeline::CommitMode::Test) == DrmPipeline::Error::None) {
-        m_pipeline->applyPendingChanges();
-        m_renderLoop->scheduleRepaint();
-        return true;
-    } else {
+    // Use the first lut of the crtc that the driver accepts the transformation in. Some drivers
+    // only support a gamma lut with some formats or not at all, the degamma lut maps the colors
+    // the same way as long as the ctm is the identity
+    for (const auto lut : {DrmPipeline::ColorLut::Gamma, DrmPipeline::ColorLut::Degamma}) {
+        if (!m_pipeline->setGammaRamp(transformation, lut)) {
+            continue;
+        }
+        m_pipeline->setCTM(QMatrix3x3());
+        if (DrmPipeline::commitPipelines({m_pipeline}, DrmPipeline::CommitMode::Test) == DrmPipeline::Error::None) {
+            m_pipeline->applyPendingChanges();
+            m_renderLoop->scheduleRepaint();
+            return true;
+        }
         m_pipeline->revertPendingChanges();
-        return false;
     }
+    return false;
 }
 
 bool DrmOutput::setCTM(const QMatrix3x3 &ctm)
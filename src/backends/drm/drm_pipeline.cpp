@@ -9,6 +9,7 @@
 
 #include "drm_pipeline.h"
 
+#include <algorithm>
 #include <errno.h>
 
 #include "core/session.h"
@@ -16,6 +17,7 @@
 #include "drm_backend.h"
 #include "drm_buffer.h"
 #include "drm_buffer_gbm.h"
+#include "drm_commit_thread.h"
 #include "drm_connector.h"
 #include "drm_crtc.h"
 #include "drm_egl_backend.h"
@@ -25,6 +27,8 @@
 #include "drm_output.h"
 #include "drm_plane.h"
 
+#include <QTimer>
+
 #include <drm_fourcc.h>
 #include <gbm.h>
 
@@ -33,6 +37,8 @@ namespace KWin
 
 static const QMap<uint32_t, QVector<uint64_t>> legacyFormats = {{DRM_FORMAT_XRGB8888, {}}};
 static const QMap<uint32_t, QVector<uint64_t>> legacyCursorFormats = {{DRM_FORMAT_ARGB8888, {}}};
+// night color transitions step through a few dozen temperatures, and back again
+static const int s_maxCachedGammaRamps = 64;
 
 DrmPipeline::DrmPipeline(DrmConnector *conn)
     : m_connector(conn)
@@ -46,6 +52,15 @@ DrmPipeline::~DrmPipeline()
     }
 }
 
+static constexpr int s_maxScanoutTests = 16;
+
+static bool useCommitThread()
+{
+    static bool valid;
+    static const bool enabled = qEnvironmentVariableIntValue("KWIN_DRM_USE_COMMIT_THREAD", &valid) == 1 && valid;
+    return enabled;
+}
+
 bool DrmPipeline::testScanout()
 {
     // TODO make the modeset check only be tested at most once per scanout cycle
@@ -53,7 +68,21 @@ bool DrmPipeline::testScanout()
         return false;
     }
     if (gpu()->atomicModeSetting()) {
-        return commitPipelines({this}, CommitMode::Test) == Error::None;
+        // Direct scanout is attempted every frame, and clients mostly cycle through a few buffers
+        // with the same properties. Test each configuration only once
+        const ScanoutTest test = scanoutTest();
+        const auto it = std::find_if(m_scanoutTests.cbegin(), m_scanoutTests.cend(), [&test](const auto &cached) {
+            return cached.first == test;
+        });
+        if (it != m_scanoutTests.cend()) {
+            return it->second;
+        }
+        const bool result = commitPipelines({this}, CommitMode::Test) == Error::None;
+        if (m_scanoutTests.size() >= s_maxScanoutTests) {
+            m_scanoutTests.removeFirst();
+        }
+        m_scanoutTests.push_back(std::make_pair(test, result));
+        return result;
     } else {
         if (m_pending.layer->currentBuffer()->buffer()->size() != m_pending.mode->size()) {
             // scaling isn't supported with the legacy API
@@ -65,10 +94,17 @@ bool DrmPipeline::testScanout()
     }
 }
 
-DrmPipeline::Error DrmPipeline::present()
+DrmPipeline::Error DrmPipeline::present(std::chrono::nanoseconds targetTimestamp)
 {
     Q_ASSERT(m_pending.crtc);
     if (gpu()->atomicModeSetting()) {
+        if (!m_commitThread && useCommitThread()) {
+            m_commitThread = std::make_unique<DrmCommitThread>();
+            QObject::connect(m_commitThread.get(), &DrmCommitThread::commitFailed, m_commitThread.get(), [this](int frames, int error) {
+                commitFailed(frames, error);
+            });
+        }
+        m_presentationTarget = targetTimestamp;
         return commitPipelines({this}, CommitMode::Commit);
     } else {
         if (m_pending.layer->hasDirectScanoutBuffer()) {
@@ -79,6 +115,46 @@ DrmPipeline::Error DrmPipeline::present()
     }
 }
 
+DrmPipeline::ScanoutTest DrmPipeline::scanoutTest() const
+{
+    const auto fb = m_pending.layer->currentBuffer();
+    const DrmGpuBuffer *buffer = fb->buffer();
+    ScanoutTest ret{
+        .crtc = m_pending.crtc,
+        .format = buffer->format(),
+        .modifier = buffer->modifier(),
+        .bufferSize = buffer->size(),
+        .modeSize = m_pending.mode->size(),
+        .transform = m_pending.renderOrientation,
+        .syncMode = m_pending.syncMode,
+        .contentType = m_pending.contentType,
+        .gamma = m_pending.gamma.get(),
+        .degamma = m_pending.degamma.get(),
+        .ctm = m_pending.ctm.get(),
+        .inFence = fb->syncFd().isValid(),
+    };
+    const auto cursor = cursorLayer();
+    if (cursor && cursor->isVisible()) {
+        ret.cursorVisible = true;
+        ret.cursorPosition = cursor->position();
+    }
+    const auto overlay = overlayLayer();
+    if (overlay && overlay->isVisible() && overlay->currentBuffer()) {
+        const DrmGpuBuffer *overlayBuffer = overlay->currentBuffer()->buffer();
+        ret.overlayFormat = overlayBuffer->format();
+        ret.overlayModifier = overlayBuffer->modifier();
+        ret.overlaySize = overlayBuffer->size();
+        ret.overlayPosition = overlay->position();
+        ret.overlayInFence = overlay->currentBuffer()->syncFd().isValid();
+    }
+    return ret;
+}
+
+void DrmPipeline::invalidateScanoutTests()
+{
+    m_scanoutTests.clear();
+}
+
 bool DrmPipeline::maybeModeset()
 {
     m_modesetPresentPending = true;
@@ -139,6 +215,9 @@ DrmPipeline::Error DrmPipeline::commitPipelinesAtomic(const QVector<DrmPipeline
             return errnoToError();
         }
         std::for_each(pipelines.begin(), pipelines.end(), std::mem_fn(&DrmPipeline::atomicModesetSuccessful));
+        for (const auto &pipeline : pipelines) {
+            pipeline->m_committedProperties = commit->properties();
+        }
         for (const auto &obj : unusedObjects) {
             if (auto crtc = dynamic_cast<DrmCrtc *>(obj)) {
                 crtc->flipBuffer();
@@ -156,9 +235,36 @@ DrmPipeline::Error DrmPipeline::commitPipelinesAtomic(const QVector<DrmPipeline
         return Error::None;
     }
     case CommitMode::Commit: {
-        if (!commit->commit()) {
+        DrmCommitThread *thread = pipelines.size() == 1 ? pipelines.front()->m_commitThread.get() : nullptr;
+        if (pipelines.size() == 1 && (!thread || !thread->isBusy())) {
+            // a queued commit may contain changes that an asynchronous commit would drop
+            if (auto asyncCommit = pipelines.front()->prepareAsyncCommit(commit.get())) {
+                if (!asyncCommit->commit()) {
+                    qCCritical(KWIN_DRM) << "Asynchronous atomic commit failed!" << strerror(errno);
+                    return errnoToError();
+                }
+                pipelines.front()->atomicCommitSuccessful();
+                return Error::None;
+            }
+        }
+        if (thread) {
+            // a commit that fails in the commit thread drops the frame, so test it right away
+            if (!commit->test()) {
+                qCWarning(KWIN_DRM) << "Atomic test for the commit thread failed!" << strerror(errno);
+                pipelines.front()->invalidateScanoutTests();
+                return errnoToError();
+            }
+            pipelines.front()->m_committedProperties = commit->properties();
+            thread->addCommit(std::move(commit), pipelines.front()->m_presentationTarget);
+        } else if (!commit->commit()) {
             qCCritical(KWIN_DRM) << "Atomic commit failed!" << strerror(errno);
+            // a cached scanout test may have let the configuration through
+            std::for_each(pipelines.begin(), pipelines.end(), std::mem_fn(&DrmPipeline::invalidateScanoutTests));
             return errnoToError();
+        } else {
+            for (const auto &pipeline : pipelines) {
+                pipeline->m_committedProperties = commit->properties();
+            }
         }
         std::for_each(pipelines.begin(), pipelines.end(), std::mem_fn(&DrmPipeline::atomicCommitSuccessful));
         Q_ASSERT(unusedObjects.isEmpty());
@@ -201,20 +307,101 @@ bool DrmPipeline::prepareAtomicPresentation(DrmAtomicCommit *commit)
     } else if (m_pending.ctm) {
         return false;
     }
+    if (m_pending.crtc->degammaLut.isValid()) {
+        commit->addBlob(m_pending.crtc->degammaLut, m_pending.degamma ? m_pending.degamma->blob() : nullptr);
+    } else if (m_pending.degamma) {
+        return false;
+    }
 
     const auto fb = m_pending.layer->currentBuffer().get();
     m_pending.crtc->primaryPlane()->set(commit, QPoint(0, 0), fb->buffer()->size(), centerBuffer(fb->buffer()->size(), m_pending.mode->size()));
+    commit->addBuffer(m_pending.layer->currentBuffer());
     commit->addProperty(m_pending.crtc->primaryPlane()->fbId, fb->framebufferId());
+    if (!addInFence(commit, m_pending.crtc->primaryPlane(), fb)) {
+        return false;
+    }
 
     if (auto plane = m_pending.crtc->cursorPlane()) {
         const auto layer = cursorLayer();
         plane->set(commit, QPoint(0, 0), gpu()->cursorSize(), QRect(layer->position(), gpu()->cursorSize()));
         commit->addProperty(plane->crtcId, layer->isVisible() ? m_pending.crtc->id() : 0);
         commit->addProperty(plane->fbId, layer->isVisible() ? layer->currentBuffer()->framebufferId() : 0);
+        if (layer->isVisible()) {
+            commit->addBuffer(layer->currentBuffer());
+        }
+    }
+    const auto overlay = overlayLayer();
+    const bool overlayVisible = overlay && overlay->isVisible() && overlay->currentBuffer();
+    if (auto plane = m_pending.crtc->overlayPlane()) {
+        if (overlayVisible) {
+            const QSize size = overlay->currentBuffer()->buffer()->size();
+            plane->set(commit, QPoint(0, 0), size, QRect(overlay->position(), size));
+            commit->addProperty(plane->crtcId, m_pending.crtc->id());
+            commit->addProperty(plane->fbId, overlay->currentBuffer()->framebufferId());
+            commit->addBuffer(overlay->currentBuffer());
+            if (!addInFence(commit, plane, overlay->currentBuffer().get())) {
+                return false;
+            }
+        } else {
+            plane->disable(commit);
+        }
+    } else if (overlayVisible) {
+        return false;
     }
     return true;
 }
 
+bool DrmPipeline::addInFence(DrmAtomicCommit *commit, DrmPlane *plane, DrmFramebuffer *framebuffer)
+{
+    if (!framebuffer->syncFd().isValid()) {
+        return true;
+    }
+    if (!plane->inFenceFd.isValid()) {
+        // without the property the buffer could be scanned out before the client is done with it
+        return false;
+    }
+    commit->addProperty(plane->inFenceFd, framebuffer->syncFd().get());
+    return true;
+}
+
+std::unique_ptr<DrmAtomicCommit> DrmPipeline::prepareAsyncCommit(const DrmAtomicCommit *commit)
+{
+    if (m_pending.syncMode != RenderLoopPrivate::SyncMode::Async && m_pending.syncMode != RenderLoopPrivate::SyncMode::AdaptiveAsync) {
+        return nullptr;
+    }
+    if (m_pending.needsModeset || m_current.crtc != m_pending.crtc || !gpu()->asyncPageflipSupported()) {
+        return nullptr;
+    }
+    // Only the framebuffer of the primary plane may change with an asynchronous commit. If anything
+    // else changed, for example the cursor or the overlay plane, the frame falls back to a
+    // synchronous commit; the next frames can tear again
+    DrmPlane *primary = m_pending.crtc->primaryPlane();
+    const auto &properties = commit->properties();
+    for (auto it = properties.begin(); it != properties.end(); ++it) {
+        if (it.key() == &primary->fbId || it.key() == &primary->inFenceFd) {
+            continue;
+        }
+        const auto committed = m_committedProperties.constFind(it.key());
+        if (committed == m_committedProperties.constEnd() || *committed != it.value()) {
+            return nullptr;
+        }
+    }
+
+    auto asyncCommit = std::make_unique<DrmAtomicCommit>(gpu());
+    asyncCommit->setPageflipAsync(true);
+    asyncCommit->addBuffer(m_pending.layer->currentBuffer());
+    asyncCommit->addProperty(primary->fbId, properties.value(&primary->fbId));
+    if (properties.contains(&primary->inFenceFd)) {
+        asyncCommit->addProperty(primary->inFenceFd, properties.value(&primary->inFenceFd));
+    }
+    if (!asyncCommit->test()) {
+        // some drivers don't support asynchronous flips with all formats and modifiers, or with in fences
+        qCDebug(KWIN_DRM) << "Asynchronous atomic test failed!" << strerror(errno);
+        return nullptr;
+    }
+    return asyncCommit;
+}
+
 void DrmPipeline::prepareAtomicDisable(DrmAtomicCommit *commit)
 {
     m_connector->disable(commit);
@@ -224,6 +411,9 @@ void DrmPipeline::prepareAtomicDisable(DrmAtomicCommit *commit)
         if (auto cursor = m_pending.crtc->cursorPlane()) {
             cursor->disable(commit);
         }
+        if (auto overlay = m_pending.crtc->overlayPlane()) {
+            overlay->disable(commit);
+        }
     }
 }
 
@@ -245,9 +435,11 @@ void DrmPipeline::prepareAtomicModeset(DrmAtomicCommit *commit)
         commit->addProperty(m_connector->underscanHBorder, hborder);
     }
     if (m_connector->maxBpc.isValid()) {
+        // allow 10 bpc unless it's disabled, so the buffer format can follow the contents
+        // without a modeset
         uint64_t preferred = 8;
-        if (auto backend = dynamic_cast<EglGbmBackend *>(gpu()->platform()->renderBackend()); backend && backend->prefer10bpc()) {
-            preferred = 10;
+        if (auto backend = dynamic_cast<EglGbmBackend *>(gpu()->platform()->renderBackend())) {
+            preferred = backend->forcedColorDepth().value_or(10);
         }
         commit->addProperty(m_connector->maxBpc, preferred);
     }
@@ -270,6 +462,11 @@ void DrmPipeline::prepareAtomicModeset(DrmAtomicCommit *commit)
             commit->addEnum(rotation, DrmPlane::Transformations(DrmPlane::Transformation::Rotate0));
         }
     }
+    if (m_pending.crtc->overlayPlane()) {
+        if (const auto &rotation = m_pending.crtc->overlayPlane()->rotation; rotation.isValid()) {
+            commit->addEnum(rotation, DrmPlane::Transformations(DrmPlane::Transformation::Rotate0));
+        }
+    }
 }
 
 uint32_t DrmPipeline::calculateUnderscan()
@@ -312,12 +509,33 @@ void DrmPipeline::atomicCommitSuccessful()
         if (m_pending.crtc->cursorPlane()) {
             m_pending.crtc->cursorPlane()->setNext(cursorLayer()->currentBuffer());
         }
+        if (m_pending.crtc->overlayPlane()) {
+            const auto overlay = overlayLayer();
+            m_pending.crtc->overlayPlane()->setNext(overlay && overlay->isVisible() ? overlay->currentBuffer() : nullptr);
+        }
     }
     m_current = m_pending;
 }
 
+void DrmPipeline::commitFailed(int frames, int error)
+{
+    m_committedProperties.clear();
+    invalidateScanoutTests();
+    m_pageflipPending = m_commitThread->isBusy();
+    if (!m_output) {
+        return;
+    }
+    for (int i = 0; i < frames; i++) {
+        m_output->frameFailed();
+    }
+    if (error == EINVAL) {
+        QTimer::singleShot(0, gpu()->platform(), &DrmBackend::updateOutputs);
+    }
+}
+
 void DrmPipeline::atomicModesetSuccessful()
 {
+    invalidateScanoutTests();
     atomicCommitSuccessful();
     m_pending.needsModeset = false;
     if (activePending()) {
@@ -381,8 +599,10 @@ DrmGpu *DrmPipeline::gpu() const
     return m_connector->gpu();
 }
 
-void DrmPipeline::pageFlipped(std::chrono::nanoseconds timestamp)
+void DrmPipeline::pageFlipped(std::chrono::nanoseconds timestamp, uint64_t sequence, PresentationFlags flags)
 {
+    // commits replaced in the commit thread are presented together with the one replacing them
+    const int frames = m_commitThread ? std::max(m_commitThread->pageFlipped(), 1) : 1;
     m_current.crtc->flipBuffer();
     if (m_current.crtc->primaryPlane()) {
         m_current.crtc->primaryPlane()->flipBuffer();
@@ -390,9 +610,17 @@ void DrmPipeline::pageFlipped(std::chrono::nanoseconds timestamp)
     if (m_current.crtc->cursorPlane()) {
         m_current.crtc->cursorPlane()->flipBuffer();
     }
-    m_pageflipPending = false;
+    if (m_current.crtc->overlayPlane()) {
+        m_current.crtc->overlayPlane()->flipBuffer();
+    }
+    m_pageflipPending = m_commitThread && m_commitThread->isBusy();
+    if (m_current.syncMode == RenderLoopPrivate::SyncMode::Fixed || m_current.syncMode == RenderLoopPrivate::SyncMode::Adaptive) {
+        flags |= PresentationFlag::VSync;
+    }
     if (m_output) {
-        m_output->pageFlipped(timestamp);
+        for (int i = 0; i < frames; i++) {
+            m_output->pageFlipped(timestamp, sequence, flags);
+        }
     }
 }
 
@@ -420,6 +648,15 @@ QMap<uint32_t, QVector<uint64_t>> DrmPipeline::cursorFormats() const
     }
 }
 
+QMap<uint32_t, QVector<uint64_t>> DrmPipeline::overlayFormats() const
+{
+    if (m_pending.crtc && m_pending.crtc->overlayPlane()) {
+        return m_pending.crtc->overlayPlane()->formats();
+    } else {
+        return {};
+    }
+}
+
 bool DrmPipeline::pruneModifier()
 {
     if (!m_pending.layer->currentBuffer()
@@ -441,6 +678,16 @@ bool DrmPipeline::needsModeset() const
     return m_pending.needsModeset;
 }
 
+bool DrmPipeline::hasPendingModesetChanges() const
+{
+    return m_pending.mode != m_next.mode
+        || m_pending.enabled != m_next.enabled
+        || m_pending.active != m_next.active
+        || m_pending.overscan != m_next.overscan
+        || m_pending.rgbRange != m_next.rgbRange
+        || m_pending.renderOrientation != m_next.renderOrientation;
+}
+
 bool DrmPipeline::activePending() const
 {
     return m_pending.crtc && m_pending.mode && m_pending.active;
@@ -456,6 +703,23 @@ bool DrmPipeline::pageflipPending() const
     return m_pageflipPending;
 }
 
+int DrmPipeline::maxPendingFrameCount() const
+{
+    if (!gpu()->atomicModeSetting() || !useCommitThread()) {
+        // the kernel rejects commits while a page flip is pending
+        return 1;
+    }
+    static const int maxPendingFrames = std::clamp(qEnvironmentVariableIntValue("KWIN_DRM_MAX_PENDING_FRAMES"), 1, 2);
+    return maxPendingFrames;
+}
+
+void DrmPipeline::flushCommits()
+{
+    if (m_commitThread) {
+        m_commitThread->flush();
+    }
+}
+
 bool DrmPipeline::modesetPresentPending() const
 {
     return m_modesetPresentPending;
@@ -472,7 +736,12 @@ DrmCrtc *DrmPipeline::currentCrtc() const
 }
 
 DrmGammaRamp::DrmGammaRamp(DrmCrtc *crtc, const std::shared_ptr<ColorTransformation> &transformation)
-    : m_lut(transformation, crtc->gammaRampSize())
+    : DrmGammaRamp(crtc, transformation, crtc->gammaRampSize())
+{
+}
+
+DrmGammaRamp::DrmGammaRamp(DrmCrtc *crtc, const std::shared_ptr<ColorTransformation> &transformation, int size)
+    : m_lut(transformation, size)
 {
     if (crtc->gpu()->atomicModeSetting()) {
         QVector<drm_color_lut> atomicLut(m_lut.size());
@@ -525,6 +794,11 @@ DrmOverlayLayer *DrmPipeline::cursorLayer() const
     return m_pending.cursorLayer.get();
 }
 
+DrmOverlayLayer *DrmPipeline::overlayLayer() const
+{
+    return m_pending.overlayLayer.get();
+}
+
 DrmPlane::Transformations DrmPipeline::renderOrientation() const
 {
     return m_pending.renderOrientation;
@@ -552,10 +826,15 @@ DrmConnector::DrmContentType DrmPipeline::contentType() const
 
 void DrmPipeline::setCrtc(DrmCrtc *crtc)
 {
-    if (crtc && m_pending.crtc && crtc->gammaRampSize() != m_pending.crtc->gammaRampSize() && m_pending.colorTransformation) {
-        m_pending.gamma = std::make_shared<DrmGammaRamp>(crtc, m_pending.colorTransformation);
-    }
+    const DrmCrtc *previous = m_pending.crtc;
     m_pending.crtc = crtc;
+    if (crtc && previous && m_pending.colorTransformation) {
+        const bool sizeChanged = m_pending.colorLut == ColorLut::Gamma ? crtc->gammaRampSize() != previous->gammaRampSize() : crtc->degammaRampSize() != previous->degammaRampSize();
+        if (sizeChanged && !setGammaRamp(m_pending.colorTransformation, m_pending.colorLut)) {
+            // the new crtc has no degamma lut
+            setGammaRamp(m_pending.colorTransformation, ColorLut::Gamma);
+        }
+    }
     if (crtc) {
         m_pending.formats = crtc->primaryPlane() ? crtc->primaryPlane()->formats() : legacyFormats;
     } else {
@@ -578,10 +857,11 @@ void DrmPipeline::setEnable(bool enable)
     m_pending.enabled = enable;
 }
 
-void DrmPipeline::setLayers(const std::shared_ptr<DrmPipelineLayer> &primaryLayer, const std::shared_ptr<DrmOverlayLayer> &cursorLayer)
+void DrmPipeline::setLayers(const std::shared_ptr<DrmPipelineLayer> &primaryLayer, const std::shared_ptr<DrmOverlayLayer> &cursorLayer, const std::shared_ptr<DrmOverlayLayer> &overlayLayer)
 {
     m_pending.layer = primaryLayer;
     m_pending.cursorLayer = cursorLayer;
+    m_pending.overlayLayer = overlayLayer;
 }
 
 void DrmPipeline::setRenderOrientation(DrmPlane::Transformations orientation)
@@ -604,10 +884,43 @@ void DrmPipeline::setRgbRange(Output::RgbRange range)
     m_pending.rgbRange = range;
 }
 
-void DrmPipeline::setGammaRamp(const std::shared_ptr<ColorTransformation> &transformation)
+bool DrmPipeline::setGammaRamp(const std::shared_ptr<ColorTransformation> &transformation, ColorLut lut)
 {
+    if (lut == ColorLut::Degamma) {
+        if (!gpu()->atomicModeSetting() || !m_pending.crtc->degammaRampSize()) {
+            return false;
+        }
+        // with the identity ctm and no gamma lut, the degamma lut maps the colors the same way
+        m_pending.degamma = gammaRamp(transformation, m_pending.crtc->degammaRampSize());
+        m_pending.gamma.reset();
+    } else {
+        m_pending.gamma = gammaRamp(transformation, m_pending.crtc->gammaRampSize());
+        m_pending.degamma.reset();
+    }
     m_pending.colorTransformation = transformation;
-    m_pending.gamma = std::make_shared<DrmGammaRamp>(m_pending.crtc, transformation);
+    m_pending.colorLut = lut;
+    return true;
+}
+
+std::shared_ptr<DrmGammaRamp> DrmPipeline::gammaRamp(const std::shared_ptr<ColorTransformation> &transformation, int size)
+{
+    // Color transformations are reused for the same settings, so are the ramps and their blobs
+    const auto it = std::find_if(m_gammaRamps.begin(), m_gammaRamps.end(), [this, &transformation, size](const auto &entry) {
+        return entry.first == m_pending.crtc && entry.second->lut().transformation() == transformation && int(entry.second->lut().size()) == size;
+    });
+    if (it != m_gammaRamps.end()) {
+        auto entry = *it;
+        m_gammaRamps.erase(it);
+        m_gammaRamps.push_back(entry);
+        return entry.second;
+    }
+
+    auto ramp = std::make_shared<DrmGammaRamp>(m_pending.crtc, transformation, size);
+    if (m_gammaRamps.size() >= s_maxCachedGammaRamps) {
+        m_gammaRamps.removeFirst();
+    }
+    m_gammaRamps.push_back(std::make_pair(m_pending.crtc, ramp));
+    return ramp;
 }
 
 static uint64_t doubleToFixed(double value)
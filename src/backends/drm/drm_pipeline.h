@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <QHash>
 #include <QPoint>
 #include <QSize>
 #include <QVector>
@@ -33,11 +34,13 @@ class GammaRamp;
 class DrmConnectorMode;
 class DrmPipelineLayer;
 class DrmOverlayLayer;
+class DrmCommitThread;
 
 class DrmGammaRamp
 {
 public:
     DrmGammaRamp(DrmCrtc *crtc, const std::shared_ptr<ColorTransformation> &transformation);
+    DrmGammaRamp(DrmCrtc *crtc, const std::shared_ptr<ColorTransformation> &transformation, int size);
 
     const ColorLUT &lut() const;
     std::shared_ptr<DrmBlob> blob() const;
@@ -67,12 +70,26 @@ public:
     /**
      * tests the pending commit first and commits it if the test passes
      * if the test fails, there is a guarantee for no lasting changes
+     *
+     * With atomic modesetting, the commit may be submitted later by the commit thread, as late
+     * as possible to still show up at @p targetTimestamp.
      */
-    Error present();
+    Error present(std::chrono::nanoseconds targetTimestamp = std::chrono::nanoseconds::zero());
     bool testScanout();
     bool maybeModeset();
+    /**
+     * Forgets the results of earlier scanout tests, they may not be valid anymore after a
+     * hotplug or a modeset.
+     */
+    void invalidateScanoutTests();
 
     bool needsModeset() const;
+    /**
+     * Whether the pending state differs from the next state in a way that requires
+     * a new test commit, i.e. in its mode, whether it's enabled or active, the overscan,
+     * the rgb range or the orientation of the buffers
+     */
+    bool hasPendingModesetChanges() const;
     void applyPendingChanges();
     void revertPendingChanges();
 
@@ -83,13 +100,23 @@ public:
     DrmCrtc *currentCrtc() const;
     DrmGpu *gpu() const;
 
-    void pageFlipped(std::chrono::nanoseconds timestamp);
+    void pageFlipped(std::chrono::nanoseconds timestamp, uint64_t sequence = 0, PresentationFlags flags = PresentationFlags());
     bool pageflipPending() const;
+    /**
+     * Hands a commit queued in the commit thread to the kernel without waiting for its deadline.
+     */
+    void flushCommits();
+    /**
+     * Returns the number of frames that may be queued up for presentation on this pipeline.
+     * Queuing more than one frame requires the commit thread.
+     */
+    int maxPendingFrameCount() const;
     bool modesetPresentPending() const;
     void resetModesetPresentPending();
 
     QMap<uint32_t, QVector<uint64_t>> formats() const;
     QMap<uint32_t, QVector<uint64_t>> cursorFormats() const;
+    QMap<uint32_t, QVector<uint64_t>> overlayFormats() const;
     bool pruneModifier();
 
     void setOutput(DrmOutput *output);
@@ -102,6 +129,7 @@ public:
     bool enabled() const;
     DrmPipelineLayer *primaryLayer() const;
     DrmOverlayLayer *cursorLayer() const;
+    DrmOverlayLayer *overlayLayer() const;
     DrmPlane::Transformations renderOrientation() const;
     RenderLoopPrivate::SyncMode syncMode() const;
     uint32_t overscan() const;
@@ -112,12 +140,24 @@ public:
     void setMode(const std::shared_ptr<DrmConnectorMode> &mode);
     void setActive(bool active);
     void setEnable(bool enable);
-    void setLayers(const std::shared_ptr<DrmPipelineLayer> &primaryLayer, const std::shared_ptr<DrmOverlayLayer> &cursorLayer);
+    void setLayers(const std::shared_ptr<DrmPipelineLayer> &primaryLayer, const std::shared_ptr<DrmOverlayLayer> &cursorLayer, const std::shared_ptr<DrmOverlayLayer> &overlayLayer);
     void setRenderOrientation(DrmPlane::Transformations orientation);
     void setSyncMode(RenderLoopPrivate::SyncMode mode);
     void setOverscan(uint32_t overscan);
     void setRgbRange(Output::RgbRange range);
-    void setGammaRamp(const std::shared_ptr<ColorTransformation> &transformation);
+    /**
+     * The luts of the crtc that a color transformation can be applied with. Both are applied
+     * after the planes are blended, so that the transformation also covers direct scanout
+     */
+    enum class ColorLut {
+        Gamma, // after the ctm
+        Degamma, // before the ctm
+    };
+    /**
+     * Applies @p transformation with the @p lut of the crtc, and none with the other lut.
+     * Returns @c false if the crtc doesn't have the lut
+     */
+    bool setGammaRamp(const std::shared_ptr<ColorTransformation> &transformation, ColorLut lut = ColorLut::Gamma);
     void setCTM(const QMatrix3x3 &ctm);
     void setContentType(DrmConnector::DrmContentType type);
 
@@ -145,17 +185,56 @@ private:
 
     // atomic modesetting only
     void atomicCommitSuccessful();
+    void commitFailed(int frames, int error);
     void atomicModesetSuccessful();
     void prepareAtomicModeset(DrmAtomicCommit *commit);
     bool prepareAtomicPresentation(DrmAtomicCommit *commit);
     void prepareAtomicDisable(DrmAtomicCommit *commit);
+    bool addInFence(DrmAtomicCommit *commit, DrmPlane *plane, DrmFramebuffer *framebuffer);
+    std::unique_ptr<DrmAtomicCommit> prepareAsyncCommit(const DrmAtomicCommit *commit);
+
+    // everything that the result of a scanout test depends on, except for the buffers themselves
+    struct ScanoutTest
+    {
+        DrmCrtc *crtc = nullptr;
+        uint32_t format = 0;
+        uint64_t modifier = 0;
+        QSize bufferSize;
+        QSize modeSize;
+        DrmPlane::Transformations transform;
+        RenderLoopPrivate::SyncMode syncMode = RenderLoopPrivate::SyncMode::Fixed;
+        DrmConnector::DrmContentType contentType = DrmConnector::DrmContentType::Graphics;
+        const DrmGammaRamp *gamma = nullptr;
+        const DrmGammaRamp *degamma = nullptr;
+        const DrmBlob *ctm = nullptr;
+        bool inFence = false;
+        bool cursorVisible = false;
+        QPoint cursorPosition;
+        uint32_t overlayFormat = 0;
+        uint64_t overlayModifier = 0;
+        QSize overlaySize;
+        QPoint overlayPosition;
+        bool overlayInFence = false;
+
+        bool operator==(const ScanoutTest &other) const = default;
+    };
+    ScanoutTest scanoutTest() const;
     static Error commitPipelinesAtomic(const QVector<DrmPipeline *> &pipelines, CommitMode mode, const QVector<DrmObject *> &unusedObjects);
+    std::shared_ptr<DrmGammaRamp> gammaRamp(const std::shared_ptr<ColorTransformation> &transformation, int size);
 
     DrmOutput *m_output = nullptr;
     DrmConnector *m_connector = nullptr;
 
     bool m_pageflipPending = false;
     bool m_modesetPresentPending = false;
+    std::unique_ptr<DrmCommitThread> m_commitThread;
+    std::chrono::nanoseconds m_presentationTarget = std::chrono::nanoseconds::zero();
+    // the property values of the last successful commit, to check if a commit can be asynchronous
+    QHash<const DrmProperty *, uint64_t> m_committedProperties;
+    // the results of recent scanout tests, the most recent one is last
+    QVector<std::pair<ScanoutTest, bool>> m_scanoutTests;
+    // recently used gamma ramps and the crtc they were made for, the most recent one is last
+    QVector<std::pair<DrmCrtc *, std::shared_ptr<DrmGammaRamp>>> m_gammaRamps;
 
     struct State
     {
@@ -169,12 +248,15 @@ private:
         Output::RgbRange rgbRange = Output::RgbRange::Automatic;
         RenderLoopPrivate::SyncMode syncMode = RenderLoopPrivate::SyncMode::Fixed;
         std::shared_ptr<ColorTransformation> colorTransformation;
+        ColorLut colorLut = ColorLut::Gamma;
         std::shared_ptr<DrmGammaRamp> gamma;
+        std::shared_ptr<DrmGammaRamp> degamma;
         std::shared_ptr<DrmBlob> ctm;
         DrmConnector::DrmContentType contentType = DrmConnector::DrmContentType::Graphics;
 
         std::shared_ptr<DrmPipelineLayer> layer;
         std::shared_ptr<DrmOverlayLayer> cursorLayer;
+        std::shared_ptr<DrmOverlayLayer> overlayLayer;
         QPoint cursorHotspot;
 
         // the transformation that buffers submitted to the pipeline should have
@@ -48,6 +48,7 @@ DrmPlane::DrmPlane(DrmGpu *gpu, uint32_t planeId)
                                                         QByteArrayLiteral("reflect-y"),
                                                     })
     , inFormats(this, QByteArrayLiteral("IN_FORMATS"))
+    , inFenceFd(this, QByteArrayLiteral("IN_FENCE_FD"))
 {
 }
 
@@ -72,6 +73,7 @@ bool DrmPlane::updateProperties()
     crtcId.update(props);
     rotation.update(props);
     inFormats.update(props);
+    inFenceFd.update(props);
 
     if (!type.isValid() || !srcX.isValid() || !srcY.isValid() || !srcW.isValid() || !srcH.isValid()
         || !crtcX.isValid() || !crtcY.isValid() || !crtcW.isValid() || !crtcH.isValid() || !fbId.isValid()) {
@@ -74,6 +74,7 @@ public:
     DrmProperty crtcId;
     DrmEnumProperty<Transformations> rotation;
     DrmProperty inFormats;
+    DrmProperty inFenceFd;
 
     static int32_t transformationToDegrees(Transformations transformation);
 
@@ -59,6 +59,12 @@ std::shared_ptr<DrmOverlayLayer> DrmQPainterBackend::createCursorLayer(DrmPipeli
     return std::make_shared<DrmCursorQPainterLayer>(pipeline);
 }
 
+std::shared_ptr<DrmOverlayLayer> DrmQPainterBackend::createOverlayLayer(DrmPipeline *pipeline)
+{
+    // QPainter doesn't import client buffers, there is nothing to put on overlay planes
+    return nullptr;
+}
+
 std::shared_ptr<DrmOutputLayer> DrmQPainterBackend::createLayer(DrmVirtualOutput *output)
 {
     return std::make_shared<DrmVirtualQPainterLayer>(output);
@@ -26,6 +26,7 @@ public:
 
     virtual std::shared_ptr<DrmPipelineLayer> createPrimaryLayer(DrmPipeline *pipeline) = 0;
     virtual std::shared_ptr<DrmOverlayLayer> createCursorLayer(DrmPipeline *pipeline) = 0;
+    virtual std::shared_ptr<DrmOverlayLayer> createOverlayLayer(DrmPipeline *pipeline) = 0;
     virtual std::shared_ptr<DrmOutputLayer> createLayer(DrmVirtualOutput *output) = 0;
 };
 
@@ -150,17 +150,21 @@ void Connection::deactivate()
 
 void Connection::handleEvent()
 {
-    QMutexLocker locker(&m_mutex);
-    const bool wasEmpty = m_eventQueue.empty();
-    do {
-        m_input->dispatch();
-        std::unique_ptr<Event> event = m_input->event();
-        if (!event) {
-            break;
-        }
-        m_eventQueue.push_back(std::move(event));
-    } while (true);
-    if (wasEmpty && !m_eventQueue.empty()) {
+    bool queued = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        do {
+            m_input->dispatch();
+            std::unique_ptr<Event> event = m_input->event();
+            if (!event) {
+                break;
+            }
+            m_eventQueue.push(std::move(event));
+            queued = true;
+        } while (true);
+    }
+    // the main thread resets the flag before draining the queue, so events can't get lost
+    if (queued && !m_eventsReadPending.exchange(true)) {
         Q_EMIT eventsRead();
     }
 }
@@ -264,10 +268,12 @@ static TabletPadId createTabletPadId(LibInput::Device *device)
 
 void Connection::processEvents()
 {
-    QMutexLocker locker(&m_mutex);
-    while (m_eventQueue.size() != 0) {
-        std::unique_ptr<Event> event = std::move(m_eventQueue.front());
-        m_eventQueue.pop_front();
+    m_eventsReadPending = false;
+    while (std::optional<std::unique_ptr<Event>> next = m_eventQueue.pop()) {
+        std::unique_ptr<Event> event = std::move(*next);
+        // the lock is only held for one event at a time, so the input thread can keep reading
+        // events while they're being processed
+        QMutexLocker locker(&m_mutex);
         switch (event->type()) {
         case LIBINPUT_EVENT_DEVICE_ADDED: {
             auto device = new Device(event->nativeDevice());
@@ -353,26 +359,37 @@ void Connection::processEvents()
         }
         case LIBINPUT_EVENT_POINTER_MOTION: {
             PointerEvent *pe = static_cast<PointerEvent *>(event.get());
-            auto delta = pe->delta();
-            auto deltaNonAccel = pe->deltaUnaccelerated();
-            auto latestTime = pe->time();
-            auto it = m_eventQueue.begin();
-            while (it != m_eventQueue.end()) {
-                if ((*it)->type() == LIBINPUT_EVENT_POINTER_MOTION) {
-                    std::unique_ptr<PointerEvent> p{static_cast<PointerEvent *>(it->release())};
-                    delta += p->delta();
-                    deltaNonAccel += p->deltaUnaccelerated();
-                    latestTime = p->time();
-                    it = m_eventQueue.erase(it);
-                } else {
+            // merge consecutive motion events of the device, so they go through the input
+            // filters only once, but keep every sample for the clients
+            QList<PointerMotionSample> samples;
+            while (std::unique_ptr<Event> *next = m_eventQueue.front()) {
+                if ((*next)->type() != LIBINPUT_EVENT_POINTER_MOTION || (*next)->device() != pe->device()) {
                     break;
                 }
+                if (samples.isEmpty()) {
+                    samples.append(PointerMotionSample{pe->delta(), pe->deltaUnaccelerated(), pe->time()});
+                }
+                std::unique_ptr<PointerEvent> p{static_cast<PointerEvent *>(m_eventQueue.pop()->release())};
+                samples.append(PointerMotionSample{p->delta(), p->deltaUnaccelerated(), p->time()});
+            }
+            if (samples.isEmpty()) {
+                Q_EMIT pe->device()->pointerMotion(pe->delta(), pe->deltaUnaccelerated(), pe->time(), pe->device());
+            } else {
+                Q_EMIT pe->device()->pointerMotionCoalesced(samples, pe->device());
             }
-            Q_EMIT pe->device()->pointerMotion(delta, deltaNonAccel, latestTime, pe->device());
             break;
         }
         case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE: {
             PointerEvent *pe = static_cast<PointerEvent *>(event.get());
+            // only the latest position matters
+            std::unique_ptr<PointerEvent> latest;
+            while (std::unique_ptr<Event> *next = m_eventQueue.front()) {
+                if ((*next)->type() != LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE || (*next)->device() != pe->device()) {
+                    break;
+                }
+                latest.reset(static_cast<PointerEvent *>(m_eventQueue.pop()->release()));
+                pe = latest.get();
+            }
             if (workspace()) {
                 Q_EMIT pe->device()->pointerMotionAbsolute(pe->absolutePos(workspace()->geometry().size()), pe->time(), pe->device());
             }
@@ -562,6 +579,8 @@ void Connection::processEvents()
             // nothing
             break;
         }
+        // libinput events must be destroyed while the context is locked
+        event.reset();
     }
 }
 
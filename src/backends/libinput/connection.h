@@ -9,6 +9,7 @@
 #pragma once
 
 #include "libkwineffects/kwinglobals.h"
+#include "utils/spscqueue.h"
 
 #include <KSharedConfig>
 
@@ -18,7 +19,7 @@
 #include <QSize>
 #include <QStringList>
 #include <QVector>
-#include <deque>
+#include <atomic>
 
 class QSocketNotifier;
 class QThread;
@@ -74,8 +75,10 @@ private:
     void applyScreenToDevice(Device *device);
     void doSetup();
     std::unique_ptr<QSocketNotifier> m_notifier;
+    // serializes the access to the libinput context between the input thread and the main thread
     QRecursiveMutex m_mutex;
-    std::deque<std::unique_ptr<Event>> m_eventQueue;
+    SpscQueue<std::unique_ptr<Event>> m_eventQueue;
+    std::atomic<bool> m_eventsReadPending = false;
     QVector<Device *> m_devices;
     KSharedConfigPtr m_config;
     std::unique_ptr<ConnectionAdaptor> m_connectionAdaptor;
@@ -8,13 +8,16 @@
 */
 #include "virtual_egl_backend.h"
 #include "core/gbmgraphicsbufferallocator.h"
+#include "libkwineffects/glrendertimequery.h"
 #include "libkwineffects/kwinglutils.h"
 #include "platformsupport/scenes/opengl/basiceglsurfacetexture_internal.h"
 #include "platformsupport/scenes/opengl/basiceglsurfacetexture_wayland.h"
+#include "scene/surfaceitem_wayland.h"
 #include "utils/softwarevsyncmonitor.h"
 #include "virtual_backend.h"
 #include "virtual_logging.h"
 #include "virtual_output.h"
+#include "wayland/surface_interface.h"
 
 #include <drm_fourcc.h>
 
@@ -54,7 +57,6 @@ VirtualEglSwapchain::VirtualEglSwapchain(const QSize &size, uint32_t format, Vir
     : m_backend(backend)
     , m_size(size)
     , m_format(format)
-    , m_allocator(std::make_unique<GbmGraphicsBufferAllocator>(backend->backend()->gbmDevice()))
 {
 }
 
@@ -71,7 +73,7 @@ std::shared_ptr<VirtualEglLayerBuffer> VirtualEglSwapchain::acquire()
         }
     }
 
-    GbmGraphicsBuffer *graphicsBuffer = m_allocator->allocate(m_size, m_format);
+    GbmGraphicsBuffer *graphicsBuffer = m_backend->graphicsBufferAllocator()->allocate(m_size, m_format);
     if (!graphicsBuffer) {
         qCWarning(KWIN_VIRTUAL) << "Failed to allocate layer swapchain buffer";
         return nullptr;
@@ -89,8 +91,16 @@ VirtualEglLayer::VirtualEglLayer(Output *output, VirtualEglBackend *backend)
 {
 }
 
+VirtualEglLayer::~VirtualEglLayer()
+{
+    m_backend->makeCurrent();
+}
+
 std::shared_ptr<GLTexture> VirtualEglLayer::texture() const
 {
+    if (m_scanoutTexture) {
+        return m_scanoutTexture;
+    }
     return m_current->texture();
 }
 
@@ -103,11 +113,19 @@ std::optional<OutputLayerBeginFrameInfo> VirtualEglLayer::beginFrame()
         m_swapchain = std::make_unique<VirtualEglSwapchain>(nativeSize, DRM_FORMAT_XRGB8888, m_backend);
     }
 
+    m_scanoutSurface.clear();
+    m_scanoutTexture.reset();
+
     m_current = m_swapchain->acquire();
     if (!m_current) {
         return std::nullopt;
     }
 
+    if (!m_renderTimeQuery) {
+        m_renderTimeQuery = std::make_unique<GLRenderTimeQuery>();
+    }
+    m_renderTimeQuery->begin();
+
     return OutputLayerBeginFrameInfo{
         .renderTarget = RenderTarget(m_current->framebuffer()),
         .repaint = infiniteRegion(),
@@ -116,11 +134,47 @@ std::optional<OutputLayerBeginFrameInfo> VirtualEglLayer::beginFrame()
 
 bool VirtualEglLayer::endFrame(const QRegion &renderedRegion, const QRegion &damagedRegion)
 {
+    m_renderTimeQuery->end();
     glFlush(); // flush pending rendering commands.
     Q_EMIT m_output->outputChange(damagedRegion);
     return true;
 }
 
+bool VirtualEglLayer::scanout(SurfaceItem *surfaceItem)
+{
+    SurfaceItemWayland *item = qobject_cast<SurfaceItemWayland *>(surfaceItem);
+    if (!item || !item->surface() || item->surface()->bufferTransform() != m_output->transform()) {
+        return false;
+    }
+    GraphicsBuffer *buffer = item->surface()->buffer();
+    if (!buffer || !buffer->dmabufAttributes() || buffer->size() != m_output->pixelSize()) {
+        return false;
+    }
+    m_backend->makeCurrent();
+    // the buffer is only sampled by the consumers of the output contents, e.g. screencasts
+    std::shared_ptr<GLTexture> texture = m_backend->importDmaBufAsTexture(*buffer->dmabufAttributes());
+    if (!texture) {
+        return false;
+    }
+    const QRegion damage = m_scanoutSurface == item->surface() ? surfaceItem->damage() : infiniteRegion();
+    surfaceItem->resetDamage();
+    // ensure the pixmap is updated when direct scanout ends
+    surfaceItem->destroyPixmap();
+    m_scanoutSurface = item->surface();
+    m_scanoutTexture = texture;
+    Q_EMIT m_output->outputChange(damage);
+    return true;
+}
+
+std::chrono::nanoseconds VirtualEglLayer::queryRenderTime() const
+{
+    if (!m_renderTimeQuery || m_scanoutTexture) {
+        return std::chrono::nanoseconds::zero();
+    }
+    m_backend->makeCurrent();
+    return m_renderTimeQuery->result();
+}
+
 quint32 VirtualEglLayer::format() const
 {
     return DRM_FORMAT_XRGB8888;
@@ -145,6 +199,14 @@ VirtualBackend *VirtualEglBackend::backend() const
     return m_backend;
 }
 
+GbmGraphicsBufferAllocator *VirtualEglBackend::graphicsBufferAllocator()
+{
+    if (!m_allocator) {
+        m_allocator = std::make_unique<GbmGraphicsBufferAllocator>(m_backend->gbmDevice());
+    }
+    return m_allocator.get();
+}
+
 bool VirtualEglBackend::initializeEgl()
 {
     initClientExtensions();
@@ -10,8 +10,14 @@
 
 #include "core/outputlayer.h"
 #include "platformsupport/scenes/opengl/abstract_egl_backend.h"
+#include <QPointer>
 #include <memory>
 
+namespace KWaylandServer
+{
+class SurfaceInterface;
+}
+
 namespace KWin
 {
 
@@ -19,6 +25,7 @@ class GbmGraphicsBuffer;
 class GbmGraphicsBufferAllocator;
 class VirtualBackend;
 class GLFramebuffer;
+class GLRenderTimeQuery;
 class GLTexture;
 class VirtualEglBackend;
 
@@ -51,7 +58,6 @@ private:
     VirtualEglBackend *m_backend;
     QSize m_size;
     uint32_t m_format;
-    std::unique_ptr<GbmGraphicsBufferAllocator> m_allocator;
     QVector<std::shared_ptr<VirtualEglLayerBuffer>> m_buffers;
 };
 
@@ -59,18 +65,25 @@ class VirtualEglLayer : public OutputLayer
 {
 public:
     VirtualEglLayer(Output *output, VirtualEglBackend *backend);
+    ~VirtualEglLayer() override;
 
     std::optional<OutputLayerBeginFrameInfo> beginFrame() override;
     bool endFrame(const QRegion &renderedRegion, const QRegion &damagedRegion) override;
+    bool scanout(SurfaceItem *surfaceItem) override;
 
     std::shared_ptr<GLTexture> texture() const;
     quint32 format() const override;
 
+    std::chrono::nanoseconds queryRenderTime() const override;
+
 private:
     VirtualEglBackend *const m_backend;
     Output *m_output;
     std::unique_ptr<VirtualEglSwapchain> m_swapchain;
     std::shared_ptr<VirtualEglLayerBuffer> m_current;
+    std::unique_ptr<GLRenderTimeQuery> m_renderTimeQuery;
+    QPointer<KWaylandServer::SurfaceInterface> m_scanoutSurface;
+    std::shared_ptr<GLTexture> m_scanoutTexture;
 };
 
 /**
@@ -91,6 +104,7 @@ public:
     void init() override;
 
     VirtualBackend *backend() const;
+    GbmGraphicsBufferAllocator *graphicsBufferAllocator();
 
 private:
     bool initializeEgl();
@@ -100,6 +114,7 @@ private:
     void removeOutput(Output *output);
 
     VirtualBackend *m_backend;
+    std::unique_ptr<GbmGraphicsBufferAllocator> m_allocator;
     std::map<Output *, std::unique_ptr<VirtualEglLayer>> m_outputs;
 };
 
@@ -9,6 +9,9 @@
 #include "virtual_output.h"
 #include "virtual_backend.h"
 
+#include "composite.h"
+#include "core/outputlayer.h"
+#include "core/renderbackend.h"
 #include "core/renderloop_p.h"
 #include "utils/softwarevsyncmonitor.h"
 
@@ -70,7 +73,15 @@ void VirtualOutput::updateEnabled(bool enabled)
 void VirtualOutput::vblank(std::chrono::nanoseconds timestamp)
 {
     RenderLoopPrivate *renderLoopPrivate = RenderLoopPrivate::get(m_renderLoop.get());
-    renderLoopPrivate->notifyFrameCompleted(timestamp);
+    // the frame has been presented a refresh cycle ago, so the GPU is usually done with it
+    // and reading the render time back doesn't stall
+    std::chrono::nanoseconds renderTime = std::chrono::nanoseconds::zero();
+    if (RenderBackend *backend = Compositor::self() ? Compositor::self()->backend() : nullptr) {
+        if (const OutputLayer *layer = backend->primaryLayer(this)) {
+            renderTime = layer->queryRenderTime();
+        }
+    }
+    renderLoopPrivate->notifyFrameCompleted(timestamp, renderTime);
 }
 
 }
@@ -13,6 +13,8 @@
 #include "libkwineffects/kwinglutils.h"
 #include "platformsupport/scenes/opengl/basiceglsurfacetexture_internal.h"
 #include "platformsupport/scenes/opengl/basiceglsurfacetexture_wayland.h"
+#include "scene/surfaceitem_wayland.h"
+#include "wayland/surface_interface.h"
 #include "wayland_backend.h"
 #include "wayland_display.h"
 #include "wayland_logging.h"
@@ -33,11 +35,8 @@ namespace KWin
 namespace Wayland
 {
 
-WaylandEglLayerBuffer::WaylandEglLayerBuffer(GbmGraphicsBuffer *buffer, WaylandEglBackend *backend)
-    : m_graphicsBuffer(buffer)
+static wl_buffer *createDmaBufBuffer(const DmaBufAttributes *attributes, WaylandEglBackend *backend)
 {
-    const DmaBufAttributes *attributes = buffer->dmabufAttributes();
-
     zwp_linux_buffer_params_v1 *params = zwp_linux_dmabuf_v1_create_params(backend->backend()->display()->linuxDmabuf()->handle());
     for (int i = 0; i < attributes->planeCount; ++i) {
         zwp_linux_buffer_params_v1_add(params,
@@ -49,9 +48,16 @@ WaylandEglLayerBuffer::WaylandEglLayerBuffer(GbmGraphicsBuffer *buffer, WaylandE
                                        attributes->modifier & 0xffffffff);
     }
 
-    m_buffer = zwp_linux_buffer_params_v1_create_immed(params, attributes->width, attributes->height, attributes->format, 0);
+    wl_buffer *buffer = zwp_linux_buffer_params_v1_create_immed(params, attributes->width, attributes->height, attributes->format, 0);
     zwp_linux_buffer_params_v1_destroy(params);
+    return buffer;
+}
 
+WaylandEglLayerBuffer::WaylandEglLayerBuffer(GbmGraphicsBuffer *buffer, WaylandEglBackend *backend)
+    : m_graphicsBuffer(buffer)
+{
+    const DmaBufAttributes *attributes = buffer->dmabufAttributes();
+    m_buffer = createDmaBufBuffer(attributes, backend);
     m_texture = backend->importDmaBufAsTexture(*attributes);
     m_framebuffer = std::make_unique<GLFramebuffer>(m_texture.get());
 }
@@ -94,10 +100,10 @@ WaylandEglLayerSwapchain::WaylandEglLayerSwapchain(const QSize &size, uint32_t f
     : m_backend(backend)
     , m_size(size)
 {
-    GbmGraphicsBufferAllocator allocator(backend->backend()->gbmDevice());
+    GbmGraphicsBufferAllocator *allocator = backend->graphicsBufferAllocator();
 
     for (int i = 0; i < 2; ++i) {
-        GbmGraphicsBuffer *buffer = allocator.allocate(size, format, modifiers);
+        GbmGraphicsBuffer *buffer = allocator->allocate(size, format, modifiers);
         if (!buffer) {
             qCWarning(KWIN_WAYLAND_BACKEND) << "Failed to allocate layer swapchain buffer";
             continue;
@@ -134,6 +140,60 @@ void WaylandEglLayerSwapchain::release(std::shared_ptr<WaylandEglLayerBuffer> bu
     }
 }
 
+WaylandEglScanoutBuffer::WaylandEglScanoutBuffer(GraphicsBuffer *buffer, WaylandEglBackend *backend)
+    : m_graphicsBuffer(buffer)
+    , m_backend(backend)
+{
+    m_buffer = createDmaBufBuffer(buffer->dmabufAttributes(), backend);
+
+    static const wl_buffer_listener listener = {
+        .release = [](void *userData, wl_buffer *buffer) {
+            WaylandEglScanoutBuffer *scanoutBuffer = static_cast<WaylandEglScanoutBuffer *>(userData);
+            if (scanoutBuffer->m_locked) {
+                scanoutBuffer->m_locked = false;
+                // this can destroy the client buffer, and this object with it
+                scanoutBuffer->m_graphicsBuffer->unref();
+            }
+        },
+    };
+    wl_buffer_add_listener(m_buffer, &listener, this);
+}
+
+WaylandEglScanoutBuffer::~WaylandEglScanoutBuffer()
+{
+    m_texture.reset();
+    wl_buffer_destroy(m_buffer);
+    if (m_locked) {
+        m_graphicsBuffer->unref();
+    }
+}
+
+GraphicsBuffer *WaylandEglScanoutBuffer::graphicsBuffer() const
+{
+    return m_graphicsBuffer;
+}
+
+wl_buffer *WaylandEglScanoutBuffer::buffer() const
+{
+    return m_buffer;
+}
+
+std::shared_ptr<GLTexture> WaylandEglScanoutBuffer::texture()
+{
+    if (!m_texture) {
+        m_texture = m_backend->importDmaBufAsTexture(*m_graphicsBuffer->dmabufAttributes());
+    }
+    return m_texture;
+}
+
+void WaylandEglScanoutBuffer::lock()
+{
+    if (!m_locked) {
+        m_locked = true;
+        m_graphicsBuffer->ref();
+    }
+}
+
 WaylandEglPrimaryLayer::WaylandEglPrimaryLayer(WaylandOutput *output, WaylandEglBackend *backend)
     : m_waylandOutput(output)
     , m_backend(backend)
@@ -142,6 +202,9 @@ WaylandEglPrimaryLayer::WaylandEglPrimaryLayer(WaylandOutput *output, WaylandEgl
 
 WaylandEglPrimaryLayer::~WaylandEglPrimaryLayer()
 {
+    // releasing the client buffers can destroy them, which removes them from the map
+    const auto scanoutBuffers = std::move(m_scanoutBuffers);
+    m_scanoutBuffers.clear();
 }
 
 GLFramebuffer *WaylandEglPrimaryLayer::fbo() const
@@ -151,6 +214,9 @@ GLFramebuffer *WaylandEglPrimaryLayer::fbo() const
 
 std::shared_ptr<GLTexture> WaylandEglPrimaryLayer::texture() const
 {
+    if (m_scanoutBuffer) {
+        return m_scanoutBuffer->texture();
+    }
     return m_buffer->texture();
 }
 
@@ -161,6 +227,12 @@ std::optional<OutputLayerBeginFrameInfo> WaylandEglPrimaryLayer::beginFrame()
         return std::nullopt;
     }
 
+    if (m_scanoutBuffer) {
+        // the contents of the swapchain buffers are outdated
+        m_scanoutBuffer = nullptr;
+        m_damageJournal.add(infiniteRegion());
+    }
+
     const QSize nativeSize = m_waylandOutput->pixelSize();
     if (!m_swapchain || m_swapchain->size() != nativeSize) {
         const WaylandLinuxDmabufV1 *dmabuf = m_backend->backend()->display()->linuxDmabuf();
@@ -198,9 +270,67 @@ bool WaylandEglPrimaryLayer::endFrame(const QRegion &renderedRegion, const QRegi
     return true;
 }
 
+bool WaylandEglPrimaryLayer::scanout(SurfaceItem *surfaceItem)
+{
+    static bool valid;
+    static const bool directScanoutDisabled = qEnvironmentVariableIntValue("KWIN_WAYLAND_NO_DIRECT_SCANOUT", &valid) == 1 && valid;
+    if (directScanoutDisabled) {
+        return false;
+    }
+
+    SurfaceItemWayland *item = qobject_cast<SurfaceItemWayland *>(surfaceItem);
+    if (!item || !item->surface()) {
+        return false;
+    }
+    const auto surface = item->surface();
+    if (surface->bufferTransform() != m_waylandOutput->transform()) {
+        return false;
+    }
+    // the fences can't be passed to the host compositor
+    if (surface->bufferAcquireTimeline()) {
+        return false;
+    }
+    GraphicsBuffer *buffer = surface->buffer();
+    if (!buffer || buffer->size() != m_waylandOutput->pixelSize()) {
+        return false;
+    }
+    const DmaBufAttributes *attributes = buffer->dmabufAttributes();
+    if (!attributes) {
+        return false;
+    }
+    const auto formats = m_backend->backend()->display()->linuxDmabuf()->formats();
+    if (!formats.value(attributes->format).contains(attributes->modifier)) {
+        return false;
+    }
+
+    auto it = m_scanoutBuffers.find(buffer);
+    if (it == m_scanoutBuffers.end()) {
+        it = m_scanoutBuffers.emplace(buffer, std::make_unique<WaylandEglScanoutBuffer>(buffer, m_backend)).first;
+        connect(buffer, &QObject::destroyed, this, [this, buffer]() {
+            m_scanoutBuffers.erase(buffer);
+        });
+    }
+    m_scanoutBuffer = it->second.get();
+
+    surfaceItem->resetDamage();
+    // ensure the pixmap is updated when direct scanout ends
+    surfaceItem->destroyPixmap();
+    return true;
+}
+
 void WaylandEglPrimaryLayer::present()
 {
     KWayland::Client::Surface *surface = m_waylandOutput->surface();
+    if (m_scanoutBuffer) {
+        const QRegion damage(QRect(QPoint(0, 0), m_waylandOutput->pixelSize()));
+        m_scanoutBuffer->lock();
+        surface->attachBuffer(m_scanoutBuffer->buffer());
+        surface->damage(damage);
+        surface->setScale(std::ceil(m_waylandOutput->scale()));
+        surface->commit();
+        Q_EMIT m_waylandOutput->outputChange(damage);
+        return;
+    }
     surface->attachBuffer(m_buffer->buffer());
     surface->damage(m_damageJournal.lastDamage());
     surface->setScale(std::ceil(m_waylandOutput->scale()));
@@ -266,6 +396,9 @@ quint32 WaylandEglCursorLayer::format() const
 
 quint32 WaylandEglPrimaryLayer::format() const
 {
+    if (m_scanoutBuffer) {
+        return m_scanoutBuffer->graphicsBuffer()->dmabufAttributes()->format;
+    }
     return m_buffer->graphicsBuffer()->dmabufAttributes()->format;
 }
 
@@ -294,6 +427,14 @@ WaylandBackend *WaylandEglBackend::backend() const
     return m_backend;
 }
 
+GbmGraphicsBufferAllocator *WaylandEglBackend::graphicsBufferAllocator()
+{
+    if (!m_allocator) {
+        m_allocator = std::make_unique<GbmGraphicsBufferAllocator>(m_backend->gbmDevice());
+    }
+    return m_allocator.get();
+}
+
 void WaylandEglBackend::cleanupSurfaces()
 {
     m_outputs.clear();
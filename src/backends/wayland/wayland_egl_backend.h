@@ -14,6 +14,7 @@
 #include "utils/damagejournal.h"
 
 #include <memory>
+#include <unordered_map>
 
 struct wl_buffer;
 
@@ -21,6 +22,8 @@ namespace KWin
 {
 class GLFramebuffer;
 class GbmGraphicsBuffer;
+class GbmGraphicsBufferAllocator;
+class GraphicsBuffer;
 
 namespace Wayland
 {
@@ -67,6 +70,37 @@ private:
     int m_index = 0;
 };
 
+/**
+ * The WaylandEglScanoutBuffer class represents a client buffer that is passed to the host
+ * compositor as is. The client buffer is kept referenced while the host compositor uses it.
+ */
+class WaylandEglScanoutBuffer
+{
+public:
+    WaylandEglScanoutBuffer(GraphicsBuffer *buffer, WaylandEglBackend *backend);
+    ~WaylandEglScanoutBuffer();
+
+    GraphicsBuffer *graphicsBuffer() const;
+    wl_buffer *buffer() const;
+
+    /**
+     * Returns the client buffer imported as a texture. The buffer is imported on the first call.
+     */
+    std::shared_ptr<GLTexture> texture();
+
+    /**
+     * Marks the buffer as used by the host compositor until it releases it.
+     */
+    void lock();
+
+private:
+    GraphicsBuffer *m_graphicsBuffer;
+    WaylandEglBackend *m_backend;
+    wl_buffer *m_buffer = nullptr;
+    std::shared_ptr<GLTexture> m_texture;
+    bool m_locked = false;
+};
+
 class WaylandEglPrimaryLayer : public OutputLayer
 {
 public:
@@ -79,6 +113,7 @@ public:
 
     std::optional<OutputLayerBeginFrameInfo> beginFrame() override;
     bool endFrame(const QRegion &renderedRegion, const QRegion &damagedRegion) override;
+    bool scanout(SurfaceItem *surfaceItem) override;
     quint32 format() const override;
 
 private:
@@ -86,6 +121,9 @@ private:
     DamageJournal m_damageJournal;
     std::unique_ptr<WaylandEglLayerSwapchain> m_swapchain;
     std::shared_ptr<WaylandEglLayerBuffer> m_buffer;
+    // the wl_buffers created for the client buffers that have been passed to the host compositor
+    std::unordered_map<GraphicsBuffer *, std::unique_ptr<WaylandEglScanoutBuffer>> m_scanoutBuffers;
+    WaylandEglScanoutBuffer *m_scanoutBuffer = nullptr;
     WaylandEglBackend *const m_backend;
 
     friend class WaylandEglBackend;
@@ -130,6 +168,7 @@ public:
     ~WaylandEglBackend() override;
 
     WaylandBackend *backend() const;
+    GbmGraphicsBufferAllocator *graphicsBufferAllocator();
 
     std::unique_ptr<SurfaceTexture> createSurfaceTextureInternal(SurfacePixmapInternal *pixmap) override;
     std::unique_ptr<SurfaceTexture> createSurfaceTextureWayland(SurfacePixmapWayland *pixmap) override;
@@ -154,6 +193,7 @@ private:
     };
 
     WaylandBackend *m_backend;
+    std::unique_ptr<GbmGraphicsBufferAllocator> m_allocator;
     std::map<Output *, Layers> m_outputs;
 };
 
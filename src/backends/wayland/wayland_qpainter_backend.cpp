@@ -92,8 +92,8 @@ WaylandQPainterBufferSlot::~WaylandQPainterBufferSlot()
     graphicsBuffer->drop();
 }
 
-WaylandQPainterSwapchain::WaylandQPainterSwapchain(WaylandOutput *output, const QSize &size, uint32_t format)
-    : m_allocator(std::make_unique<ShmGraphicsBufferAllocator>())
+WaylandQPainterSwapchain::WaylandQPainterSwapchain(WaylandOutput *output, ShmGraphicsBufferAllocator *allocator, const QSize &size, uint32_t format)
+    : m_allocator(allocator)
     , m_output(output)
     , m_size(size)
     , m_format(format)
@@ -137,8 +137,9 @@ void WaylandQPainterSwapchain::release(std::shared_ptr<WaylandQPainterBufferSlot
     }
 }
 
-WaylandQPainterPrimaryLayer::WaylandQPainterPrimaryLayer(WaylandOutput *output)
+WaylandQPainterPrimaryLayer::WaylandQPainterPrimaryLayer(WaylandOutput *output, WaylandQPainterBackend *backend)
     : m_waylandOutput(output)
+    , m_backend(backend)
 {
 }
 
@@ -162,7 +163,7 @@ std::optional<OutputLayerBeginFrameInfo> WaylandQPainterPrimaryLayer::beginFrame
 {
     const QSize nativeSize(m_waylandOutput->pixelSize());
     if (!m_swapchain || m_swapchain->size() != nativeSize) {
-        m_swapchain = std::make_unique<WaylandQPainterSwapchain>(m_waylandOutput, nativeSize, DRM_FORMAT_XRGB8888);
+        m_swapchain = std::make_unique<WaylandQPainterSwapchain>(m_waylandOutput, m_backend->graphicsBufferAllocator(), nativeSize, DRM_FORMAT_XRGB8888);
     }
 
     m_back = m_swapchain->acquire();
@@ -187,8 +188,9 @@ quint32 WaylandQPainterPrimaryLayer::format() const
     return DRM_FORMAT_RGBA8888;
 }
 
-WaylandQPainterCursorLayer::WaylandQPainterCursorLayer(WaylandOutput *output)
+WaylandQPainterCursorLayer::WaylandQPainterCursorLayer(WaylandOutput *output, WaylandQPainterBackend *backend)
     : m_output(output)
+    , m_backend(backend)
 {
 }
 
@@ -197,7 +199,7 @@ std::optional<OutputLayerBeginFrameInfo> WaylandQPainterCursorLayer::beginFrame(
     const auto tmp = size().expandedTo(QSize(64, 64));
     const QSize bufferSize(std::ceil(tmp.width()), std::ceil(tmp.height()));
     if (!m_swapchain || m_swapchain->size() != bufferSize) {
-        m_swapchain = std::make_unique<WaylandQPainterSwapchain>(m_output, bufferSize, DRM_FORMAT_ARGB8888);
+        m_swapchain = std::make_unique<WaylandQPainterSwapchain>(m_output, m_backend->graphicsBufferAllocator(), bufferSize, DRM_FORMAT_ARGB8888);
     }
 
     m_back = m_swapchain->acquire();
@@ -226,6 +228,7 @@ quint32 WaylandQPainterCursorLayer::format() const
 WaylandQPainterBackend::WaylandQPainterBackend(Wayland::WaylandBackend *b)
     : QPainterBackend()
     , m_backend(b)
+    , m_allocator(std::make_unique<ShmGraphicsBufferAllocator>())
 {
 
     const auto waylandOutputs = m_backend->waylandOutputs();
@@ -245,8 +248,8 @@ WaylandQPainterBackend::~WaylandQPainterBackend()
 void WaylandQPainterBackend::createOutput(Output *waylandOutput)
 {
     m_outputs[waylandOutput] = Layers{
-        .primaryLayer = std::make_unique<WaylandQPainterPrimaryLayer>(static_cast<WaylandOutput *>(waylandOutput)),
-        .cursorLayer = std::make_unique<WaylandQPainterCursorLayer>(static_cast<WaylandOutput *>(waylandOutput)),
+        .primaryLayer = std::make_unique<WaylandQPainterPrimaryLayer>(static_cast<WaylandOutput *>(waylandOutput), this),
+        .cursorLayer = std::make_unique<WaylandQPainterCursorLayer>(static_cast<WaylandOutput *>(waylandOutput), this),
     };
 }
 
@@ -265,5 +268,10 @@ OutputLayer *WaylandQPainterBackend::cursorLayer(Output *output)
     return m_outputs[output].cursorLayer.get();
 }
 
+ShmGraphicsBufferAllocator *WaylandQPainterBackend::graphicsBufferAllocator() const
+{
+    return m_allocator.get();
+}
+
 }
 }
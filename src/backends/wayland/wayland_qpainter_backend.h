@@ -49,7 +49,7 @@ public:
 class WaylandQPainterSwapchain
 {
 public:
-    WaylandQPainterSwapchain(WaylandOutput *output, const QSize &size, uint32_t format);
+    WaylandQPainterSwapchain(WaylandOutput *output, ShmGraphicsBufferAllocator *allocator, const QSize &size, uint32_t format);
 
     QSize size() const;
 
@@ -57,7 +57,7 @@ public:
     void release(std::shared_ptr<WaylandQPainterBufferSlot> buffer);
 
 private:
-    std::unique_ptr<ShmGraphicsBufferAllocator> m_allocator;
+    ShmGraphicsBufferAllocator *m_allocator;
     WaylandOutput *m_output;
     QSize m_size;
     uint32_t m_format;
@@ -67,7 +67,7 @@ private:
 class WaylandQPainterPrimaryLayer : public OutputLayer
 {
 public:
-    WaylandQPainterPrimaryLayer(WaylandOutput *output);
+    WaylandQPainterPrimaryLayer(WaylandOutput *output, WaylandQPainterBackend *backend);
 
     std::optional<OutputLayerBeginFrameInfo> beginFrame() override;
     bool endFrame(const QRegion &renderedRegion, const QRegion &damagedRegion) override;
@@ -79,6 +79,7 @@ public:
 
 private:
     WaylandOutput *m_waylandOutput;
+    WaylandQPainterBackend *m_backend;
     DamageJournal m_damageJournal;
 
     std::unique_ptr<WaylandQPainterSwapchain> m_swapchain;
@@ -92,7 +93,7 @@ class WaylandQPainterCursorLayer : public OutputLayer
     Q_OBJECT
 
 public:
-    explicit WaylandQPainterCursorLayer(WaylandOutput *output);
+    WaylandQPainterCursorLayer(WaylandOutput *output, WaylandQPainterBackend *backend);
 
     std::optional<OutputLayerBeginFrameInfo> beginFrame() override;
     bool endFrame(const QRegion &renderedRegion, const QRegion &damagedRegion) override;
@@ -100,6 +101,7 @@ public:
 
 private:
     WaylandOutput *m_output;
+    WaylandQPainterBackend *m_backend;
     std::unique_ptr<WaylandQPainterSwapchain> m_swapchain;
     std::shared_ptr<WaylandQPainterBufferSlot> m_back;
 };
@@ -115,6 +117,8 @@ public:
     OutputLayer *primaryLayer(Output *output) override;
     OutputLayer *cursorLayer(Output *output) override;
 
+    ShmGraphicsBufferAllocator *graphicsBufferAllocator() const;
+
 private:
     void createOutput(Output *waylandOutput);
 
@@ -125,6 +129,7 @@ private:
     };
 
     WaylandBackend *m_backend;
+    std::unique_ptr<ShmGraphicsBufferAllocator> m_allocator;
     std::map<Output *, Layers> m_outputs;
 };
 
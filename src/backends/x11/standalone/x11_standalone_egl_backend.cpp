@@ -413,7 +413,9 @@ bool EglSurfaceTextureX11::create()
 
 void EglSurfaceTextureX11::update(const QRegion &region)
 {
-    // mipmaps need to be updated
+    // The pixmap stays bound across damage events, the texture aliases its contents, so there
+    // is nothing to upload for the damaged region. With strict binding, the pixmap is rebound
+    // once when the texture is bound next, after the damage of the frame has been fetched.
     m_texture->setDirty();
 }
 
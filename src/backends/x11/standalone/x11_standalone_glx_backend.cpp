@@ -126,7 +126,6 @@ GlxBackend::GlxBackend(Display *display, X11StandaloneBackend *backend)
     , fbconfig(nullptr)
     , glxWindow(None)
     , ctx(nullptr)
-    , m_bufferAge(0)
     , m_x11Display(display)
     , m_backend(backend)
     , m_layer(std::make_unique<GlxLayer>(this))
@@ -250,9 +249,17 @@ void GlxBackend::init()
 
     bool haveSwapInterval = m_haveMESASwapControl || m_haveEXTSwapControl || m_haveSGISwapControl;
 
+    if (glPlatform->isVirtualBox()) {
+        // VirtualBox does not support glxQueryDrawable
+        // this should actually be in kwinglutils_funcs, but QueryDrawable seems not to be provided by an extension
+        // and the GLPlatform has not been initialized at the moment when initGLX() is called.
+        glXQueryDrawable = nullptr;
+    }
+
     setSupportsBufferAge(false);
 
-    if (hasExtension(QByteArrayLiteral("GLX_EXT_buffer_age"))) {
+    // the buffer age can only be used if it can be queried
+    if (hasExtension(QByteArrayLiteral("GLX_EXT_buffer_age")) && glXQueryDrawable) {
         const QByteArray useBufferAge = qgetenv("KWIN_USE_BUFFER_AGE");
 
         if (useBufferAge != "0") {
@@ -277,13 +284,6 @@ void GlxBackend::init()
         setSwapInterval(0); // disable vsync if possible
     }
 
-    if (glPlatform->isVirtualBox()) {
-        // VirtualBox does not support glxQueryDrawable
-        // this should actually be in kwinglutils_funcs, but QueryDrawable seems not to be provided by an extension
-        // and the GLPlatform has not been initialized at the moment when initGLX() is called.
-        glXQueryDrawable = nullptr;
-    }
-
     static bool forceSoftwareVsync = qEnvironmentVariableIntValue("KWIN_X11_FORCE_SOFTWARE_VSYNC");
     if (supportsSwapEvent && !forceSoftwareVsync) {
         // Nice, the GLX_INTEL_swap_event extension is available. We are going to receive
@@ -726,9 +726,6 @@ void GlxBackend::present(const QRegion &damage)
 
     if (fullRepaint) {
         glXSwapBuffers(display(), glxWindow);
-        if (supportsBufferAge()) {
-            glXQueryDrawable(display(), glxWindow, GLX_BACK_BUFFER_AGE_EXT, (GLuint *)&m_bufferAge);
-        }
     } else if (m_haveMESACopySubBuffer) {
         for (const QRect &r : damage) {
             // convert to OpenGL coordinates
@@ -757,7 +754,7 @@ void GlxBackend::screenGeometryChanged()
     Xcb::sync();
 
     // The back buffer contents are now undefined
-    m_bufferAge = 0;
+    m_damageJournal.clear();
     m_fbo = std::make_unique<GLFramebuffer>(0, size);
 }
 
@@ -772,7 +769,11 @@ OutputLayerBeginFrameInfo GlxBackend::beginFrame()
     makeCurrent();
 
     if (supportsBufferAge()) {
-        repaint = m_damageJournal.accumulate(m_bufferAge, infiniteRegion());
+        // The age is queried right before rendering rather than after swapping buffers,
+        // otherwise the query would stall until the swap completes with some drivers.
+        GLuint bufferAge = 0;
+        glXQueryDrawable(display(), glxWindow, GLX_BACK_BUFFER_AGE_EXT, &bufferAge);
+        repaint = m_damageJournal.accumulate(bufferAge, infiniteRegion());
     }
 
     glXWaitX();
@@ -866,7 +867,9 @@ bool GlxSurfaceTextureX11::create()
 
 void GlxSurfaceTextureX11::update(const QRegion &region)
 {
-    // mipmaps need to be updated
+    // The pixmap stays bound across damage events, the texture aliases its contents, so there
+    // is nothing to upload for the damaged region. With strict binding, the pixmap is rebound
+    // once when the texture is bound next, after the damage of the frame has been fetched.
     m_texture->setDirty();
 }
 
@@ -86,10 +86,10 @@ int X11WindowedEglLayerBuffer::age() const
 X11WindowedEglLayerSwapchain::X11WindowedEglLayerSwapchain(const QSize &size, uint32_t format, uint32_t depth, uint32_t bpp, const QVector<uint64_t> &modifiers, xcb_drawable_t drawable, X11WindowedEglBackend *backend)
     : m_size(size)
 {
-    GbmGraphicsBufferAllocator allocator(backend->backend()->gbmDevice());
+    GbmGraphicsBufferAllocator *allocator = backend->graphicsBufferAllocator();
 
     for (int i = 0; i < 2; ++i) {
-        GbmGraphicsBuffer *graphicsBuffer = allocator.allocate(size, format, modifiers);
+        GbmGraphicsBuffer *graphicsBuffer = allocator->allocate(size, format, modifiers);
         if (!graphicsBuffer) {
             qCCritical(KWIN_X11WINDOWED) << "Failed to allocate a buffer for an output layer";
             continue;
@@ -271,6 +271,14 @@ X11WindowedBackend *X11WindowedEglBackend::backend() const
     return m_backend;
 }
 
+GbmGraphicsBufferAllocator *X11WindowedEglBackend::graphicsBufferAllocator()
+{
+    if (!m_allocator) {
+        m_allocator = std::make_unique<GbmGraphicsBufferAllocator>(m_backend->gbmDevice());
+    }
+    return m_allocator.get();
+}
+
 bool X11WindowedEglBackend::initializeEgl()
 {
     initClientExtensions();
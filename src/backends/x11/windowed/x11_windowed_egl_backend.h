@@ -109,6 +109,7 @@ public:
     ~X11WindowedEglBackend() override;
 
     X11WindowedBackend *backend() const;
+    GbmGraphicsBufferAllocator *graphicsBufferAllocator();
 
     std::unique_ptr<SurfaceTexture> createSurfaceTextureInternal(SurfacePixmapInternal *pixmap) override;
     std::unique_ptr<SurfaceTexture> createSurfaceTextureWayland(SurfacePixmapWayland *pixmap) override;
@@ -132,6 +133,7 @@ private:
         std::unique_ptr<X11WindowedEglCursorLayer> cursorLayer;
     };
 
+    std::unique_ptr<GbmGraphicsBufferAllocator> m_allocator;
     std::map<Output *, Layers> m_outputs;
     X11WindowedBackend *m_backend;
 };
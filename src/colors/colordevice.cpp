@@ -12,10 +12,15 @@
 
 #include "3rdparty/colortemperature.h"
 
+#include <QFutureWatcher>
 #include <QTimer>
+#include <QtConcurrentRun>
 
 #include <lcms2.h>
 
+#include <map>
+#include <optional>
+
 namespace KWin
 {
 
@@ -30,6 +35,21 @@ struct CmsDeleter
 };
 using UniqueToneCurvePtr = std::unique_ptr<cmsToneCurve, CmsDeleter>;
 
+// a transition from day to night in steps of 50K takes less than that
+static const size_t s_maxCachedTransformations = 128;
+
+struct CachedTransformation
+{
+    std::shared_ptr<ColorTransformation> transformation;
+    QVector3D temperatureFactors;
+};
+
+struct PreparedTransformation
+{
+    uint temperature;
+    CachedTransformation transformation;
+};
+
 class ColorDevicePrivate
 {
 public:
@@ -40,9 +60,12 @@ public:
     };
     Q_DECLARE_FLAGS(DirtyToneCurves, DirtyToneCurveBit)
 
-    void rebuildPipeline();
+    std::optional<std::vector<std::unique_ptr<ColorPipelineStage>>> rebuildStages();
+    void applyTransformation();
 
     void updateTemperatureToneCurves();
+    void invalidateCachedTransformations();
+    void cacheTransformation(uint temperature, const CachedTransformation &transformation);
     void updateBrightnessToneCurves();
     void updateCalibrationToneCurves();
 
@@ -62,9 +85,37 @@ public:
     std::shared_ptr<ColorTransformation> transformation;
     // used if only limited per-channel multiplication is available
     QVector3D simpleTransformation = QVector3D(1, 1, 1);
+
+    // the stages are combined into a transformation on a worker thread
+    QFutureWatcher<std::shared_ptr<ColorTransformation>> watcher;
+    QVector3D pendingSimpleTransformation = QVector3D(1, 1, 1);
+    uint pendingTemperature = 6500;
+    QVector3D pendingTemperatureFactors = QVector3D(1, 1, 1);
+    uint pendingGeneration = 0;
+    bool updatePending = false;
+
+    // the transformations for the current brightness and profile, by temperature
+    std::map<uint, CachedTransformation> cachedTransformations;
+    QFutureWatcher<std::vector<PreparedTransformation>> prepareWatcher;
+    uint cacheGeneration = 0;
+    uint preparedGeneration = 0;
 };
 
-void ColorDevicePrivate::rebuildPipeline()
+void ColorDevicePrivate::invalidateCachedTransformations()
+{
+    cachedTransformations.clear();
+    cacheGeneration++;
+}
+
+void ColorDevicePrivate::cacheTransformation(uint temperature, const CachedTransformation &transformation)
+{
+    if (cachedTransformations.size() >= s_maxCachedTransformations) {
+        cachedTransformations.clear();
+    }
+    cachedTransformations[temperature] = transformation;
+}
+
+std::optional<std::vector<std::unique_ptr<ColorPipelineStage>>> ColorDevicePrivate::rebuildStages()
 {
     if (dirtyCurves & DirtyCalibrationToneCurve) {
         updateCalibrationToneCurves();
@@ -82,28 +133,71 @@ void ColorDevicePrivate::rebuildPipeline()
         if (auto s = calibrationStage->dup()) {
             stages.push_back(std::move(s));
         } else {
-            return;
+            return std::nullopt;
         }
     }
     if (brightnessStage) {
         if (auto s = brightnessStage->dup()) {
             stages.push_back(std::move(s));
         } else {
-            return;
+            return std::nullopt;
         }
     }
     if (temperatureStage) {
         if (auto s = temperatureStage->dup()) {
             stages.push_back(std::move(s));
         } else {
-            return;
+            return std::nullopt;
         }
     }
+    return stages;
+}
 
-    const auto tmp = std::make_shared<ColorTransformation>(std::move(stages));
-    if (tmp->valid()) {
-        transformation = tmp;
-        simpleTransformation = brightnessFactors * temperatureFactors;
+static std::shared_ptr<ColorTransformation> createTransformation(std::vector<std::unique_ptr<ColorPipelineStage>> stages)
+{
+    return std::make_shared<ColorTransformation>(std::move(stages));
+}
+
+static std::unique_ptr<ColorPipelineStage> createTemperatureStage(uint temperature, QVector3D *factors);
+
+static std::vector<PreparedTransformation> prepareTransformations(std::vector<std::unique_ptr<ColorPipelineStage>> baseStages, std::vector<uint> temperatures)
+{
+    std::vector<PreparedTransformation> prepared;
+    for (uint temperature : temperatures) {
+        std::vector<std::unique_ptr<ColorPipelineStage>> stages;
+        for (const auto &stage : baseStages) {
+            auto s = stage->dup();
+            if (!s) {
+                return prepared;
+            }
+            stages.push_back(std::move(s));
+        }
+        QVector3D temperatureFactors;
+        if (auto temperatureStage = createTemperatureStage(temperature, &temperatureFactors)) {
+            stages.push_back(std::move(temperatureStage));
+        }
+        const auto transformation = std::make_shared<ColorTransformation>(std::move(stages));
+        if (transformation->valid()) {
+            prepared.push_back(PreparedTransformation{
+                .temperature = temperature,
+                .transformation = {
+                    .transformation = transformation,
+                    .temperatureFactors = temperatureFactors,
+                },
+            });
+        }
+    }
+    return prepared;
+}
+
+void ColorDevicePrivate::applyTransformation()
+{
+    if (!output->setGammaRamp(transformation)) {
+        QMatrix3x3 ctm;
+        ctm(0, 0) = simpleTransformation.x();
+        ctm(1, 1) = simpleTransformation.y();
+        ctm(2, 2) = simpleTransformation.z();
+        output->setCTM(ctm);
     }
 }
 
@@ -117,12 +211,11 @@ QString ColorDevice::profile() const
     return d->profile;
 }
 
-void ColorDevicePrivate::updateTemperatureToneCurves()
+static std::unique_ptr<ColorPipelineStage> createTemperatureStage(uint temperature, QVector3D *factors)
 {
-    temperatureStage.reset();
-
+    *factors = QVector3D(1, 1, 1);
     if (temperature == 6500) {
-        return;
+        return nullptr;
     }
 
     // Note that cmsWhitePointFromTemp() returns a slightly green-ish white point.
@@ -139,7 +232,7 @@ void ColorDevicePrivate::updateTemperatureToneCurves()
                                           blackbodyColor[blackBodyColorIndex + 5],
                                           blendFactor);
 
-    temperatureFactors = QVector3D(xWhitePoint, yWhitePoint, zWhitePoint);
+    *factors = QVector3D(xWhitePoint, yWhitePoint, zWhitePoint);
 
     const double redCurveParams[] = {1.0, xWhitePoint, 0.0};
     const double greenCurveParams[] = {1.0, yWhitePoint, 0.0};
@@ -148,26 +241,32 @@ void ColorDevicePrivate::updateTemperatureToneCurves()
     UniqueToneCurvePtr redCurve(cmsBuildParametricToneCurve(nullptr, 2, redCurveParams));
     if (!redCurve) {
         qCWarning(KWIN_CORE) << "Failed to build the temperature tone curve for the red channel";
-        return;
+        return nullptr;
     }
     UniqueToneCurvePtr greenCurve(cmsBuildParametricToneCurve(nullptr, 2, greenCurveParams));
     if (!greenCurve) {
         qCWarning(KWIN_CORE) << "Failed to build the temperature tone curve for the green channel";
-        return;
+        return nullptr;
     }
     UniqueToneCurvePtr blueCurve(cmsBuildParametricToneCurve(nullptr, 2, blueCurveParams));
     if (!blueCurve) {
         qCWarning(KWIN_CORE) << "Failed to build the temperature tone curve for the blue channel";
-        return;
+        return nullptr;
     }
 
     // The ownership of the tone curves will be moved to the pipeline stage.
     cmsToneCurve *toneCurves[] = {redCurve.release(), greenCurve.release(), blueCurve.release()};
 
-    temperatureStage = std::make_unique<ColorPipelineStage>(cmsStageAllocToneCurves(nullptr, 3, toneCurves));
-    if (!temperatureStage) {
+    auto stage = std::make_unique<ColorPipelineStage>(cmsStageAllocToneCurves(nullptr, 3, toneCurves));
+    if (!stage) {
         qCWarning(KWIN_CORE) << "Failed to create the color temperature pipeline stage";
     }
+    return stage;
+}
+
+void ColorDevicePrivate::updateTemperatureToneCurves()
+{
+    temperatureStage = createTemperatureStage(temperature, &temperatureFactors);
 }
 
 void ColorDevicePrivate::updateBrightnessToneCurves()
@@ -245,6 +344,32 @@ ColorDevice::ColorDevice(Output *output, QObject *parent)
     d->updateTimer = new QTimer(this);
     d->updateTimer->setSingleShot(true);
     connect(d->updateTimer, &QTimer::timeout, this, &ColorDevice::update);
+    connect(&d->watcher, &QFutureWatcher<std::shared_ptr<ColorTransformation>>::finished, this, [this]() {
+        const std::shared_ptr<ColorTransformation> transformation = d->watcher.result();
+        if (transformation->valid()) {
+            d->transformation = transformation;
+            d->simpleTransformation = d->pendingSimpleTransformation;
+            if (d->pendingGeneration == d->cacheGeneration) {
+                d->cacheTransformation(d->pendingTemperature, CachedTransformation{transformation, d->pendingTemperatureFactors});
+            }
+        }
+        if (d->updatePending) {
+            // the settings have changed in the meantime, the result is outdated already
+            d->updatePending = false;
+            update();
+        } else {
+            d->applyTransformation();
+        }
+    });
+    connect(&d->prepareWatcher, &QFutureWatcher<std::vector<PreparedTransformation>>::finished, this, [this]() {
+        if (d->preparedGeneration != d->cacheGeneration) {
+            return;
+        }
+        const std::vector<PreparedTransformation> prepared = d->prepareWatcher.result();
+        for (const PreparedTransformation &transformation : prepared) {
+            d->cacheTransformation(transformation.temperature, transformation.transformation);
+        }
+    });
     connect(output, &Output::dpmsModeChanged, this, [this, output]() {
         if (output->dpmsMode() == Output::DpmsMode::On) {
             update();
@@ -280,6 +405,7 @@ void ColorDevice::setBrightness(uint brightness)
     }
     d->brightness = brightness;
     d->dirtyCurves |= ColorDevicePrivate::DirtyBrightnessToneCurve;
+    d->invalidateCachedTransformations();
     scheduleUpdate();
     Q_EMIT brightnessChanged();
 }
@@ -311,20 +437,78 @@ void ColorDevice::setProfile(const QString &profile)
     }
     d->profile = profile;
     d->dirtyCurves |= ColorDevicePrivate::DirtyCalibrationToneCurve;
+    d->invalidateCachedTransformations();
     scheduleUpdate();
     Q_EMIT profileChanged();
 }
 
 void ColorDevice::update()
 {
-    d->rebuildPipeline();
-    if (!d->output->setGammaRamp(d->transformation)) {
-        QMatrix3x3 ctm;
-        ctm(0, 0) = d->simpleTransformation.x();
-        ctm(1, 1) = d->simpleTransformation.y();
-        ctm(2, 2) = d->simpleTransformation.z();
-        d->output->setCTM(ctm);
+    if (d->watcher.isRunning()) {
+        d->updatePending = true;
+        return;
+    }
+    if (!d->dirtyCurves && d->transformation) {
+        d->applyTransformation();
+        return;
+    }
+    if (d->dirtyCurves == ColorDevicePrivate::DirtyTemperatureToneCurve) {
+        // The temperature stage stays dirty, it will be rebuilt once it's needed for another
+        // transformation
+        if (auto it = d->cachedTransformations.find(d->temperature); it != d->cachedTransformations.end()) {
+            d->transformation = it->second.transformation;
+            d->simpleTransformation = d->brightnessFactors * it->second.temperatureFactors;
+            d->applyTransformation();
+            return;
+        }
     }
+
+    auto stages = d->rebuildStages();
+    if (!stages) {
+        d->applyTransformation();
+        return;
+    }
+
+    // Combining the stages samples the whole pipeline, which is too slow to do on the main
+    // thread while night color transitions between temperatures
+    d->pendingSimpleTransformation = d->brightnessFactors * d->temperatureFactors;
+    d->pendingTemperature = d->temperature;
+    d->pendingTemperatureFactors = d->temperatureFactors;
+    d->pendingGeneration = d->cacheGeneration;
+    d->watcher.setFuture(QtConcurrent::run(createTransformation, std::move(*stages)));
+}
+
+void ColorDevice::prepareTemperatures(const QVector<uint> &temperatures)
+{
+    // the other stages must be up to date, they're shared by all prepared transformations
+    if (d->prepareWatcher.isRunning() || (d->dirtyCurves & ~ColorDevicePrivate::DirtyToneCurves(ColorDevicePrivate::DirtyTemperatureToneCurve))) {
+        return;
+    }
+
+    std::vector<uint> missing;
+    for (uint temperature : temperatures) {
+        if (temperature <= 6500 && !d->cachedTransformations.contains(temperature) && missing.size() < s_maxCachedTransformations) {
+            missing.push_back(temperature);
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    std::vector<std::unique_ptr<ColorPipelineStage>> baseStages;
+    for (const auto &stage : {d->calibrationStage.get(), d->brightnessStage.get()}) {
+        if (!stage) {
+            continue;
+        }
+        auto s = stage->dup();
+        if (!s) {
+            return;
+        }
+        baseStages.push_back(std::move(s));
+    }
+
+    d->preparedGeneration = d->cacheGeneration;
+    d->prepareWatcher.setFuture(QtConcurrent::run(prepareTransformations, std::move(baseStages), std::move(missing)));
 }
 
 void ColorDevice::scheduleUpdate()
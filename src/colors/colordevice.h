@@ -9,6 +9,7 @@
 #include "libkwineffects/kwinglobals.h"
 
 #include <QObject>
+#include <QVector>
 #include <memory>
 
 namespace KWin
@@ -53,6 +54,15 @@ public:
      */
     void setTemperature(uint temperature);
 
+    /**
+     * Builds the color transformations for the given color @a temperatures ahead of time, on a
+     * worker thread, so that changing the temperature to one of them later is cheap. This is
+     * meant for transitions, where the temperatures to come are known in advance.
+     *
+     * The prepared transformations are dropped when the brightness or the color profile change.
+     */
+    void prepareTemperatures(const QVector<uint> &temperatures);
+
     /**
      * Returns the color profile for this device.
      */
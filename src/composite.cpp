@@ -16,6 +16,7 @@
 #include "core/overlaywindow.h"
 #include "core/renderlayer.h"
 #include "core/renderloop.h"
+#include "core/renderloop_p.h"
 #include "cursordelegate_opengl.h"
 #include "cursordelegate_qpainter.h"
 #include "dbusinterface.h"
@@ -29,6 +30,7 @@
 #include "scene/itemrenderer_opengl.h"
 #include "scene/itemrenderer_qpainter.h"
 #include "scene/surfaceitem_x11.h"
+#include "scene/windowitem.h"
 #include "scene/workspacescene_opengl.h"
 #include "scene/workspacescene_qpainter.h"
 #include "shadow.h"
@@ -41,6 +43,7 @@
 #include "x11syncmanager.h"
 #include "x11window.h"
 
+#include "libkwineffects/gltexturememory.h"
 #include "libkwineffects/kwinglplatform.h"
 #include "libkwineffects/kwingltexture.h"
 
@@ -121,8 +124,15 @@ private:
 Compositor::Compositor(QObject *workspace)
     : QObject(workspace)
 {
-    connect(options, &Options::configChanged, this, &Compositor::configChanged);
+    connect(options, &Options::compositingSettingsChanged, this, &Compositor::configChanged);
     connect(options, &Options::animationSpeedChanged, this, &Compositor::configChanged);
+    connect(options, &Options::configChanged, this, []() {
+        // Unload the effects that have been disabled, reconfigure the effects whose settings
+        // have changed and load the effects that have been enabled
+        if (effects) {
+            effects->reconfigure();
+        }
+    });
 
     // 2 sec which should be enough to restart the compositor.
     static const int compositorLostMessageDelay = 2000;
@@ -148,7 +158,10 @@ Compositor::Compositor(QObject *workspace)
 
     // register DBus
     new CompositorDBusInterface(this);
-    FTraceLogger::create();
+    if (!FTraceLogger::self()) {
+        // it may have been created already to trace the startup
+        FTraceLogger::create();
+    }
 }
 
 Compositor::~Compositor()
@@ -236,6 +249,7 @@ bool Compositor::attemptQPainterCompositing()
 
 bool Compositor::setupStart()
 {
+    fTraceDuration("Compositor setup");
     if (kwinApp()->isTerminating()) {
         // Don't start while KWin is terminating. An event to restart might be lingering
         // in the event queue due to graphics reset.
@@ -318,6 +332,10 @@ bool Compositor::setupStart()
         QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
     }
 
+    if (auto openGLScene = qobject_cast<WorkspaceSceneOpenGL *>(m_scene.get())) {
+        openGLScene->warmUpShaders();
+    }
+
     Q_EMIT sceneCreated();
 
     return true;
@@ -370,6 +388,14 @@ void Compositor::startupWithWorkspace()
         }
         connect(workspace(), &Workspace::outputAdded, this, &Compositor::addOutput);
         connect(workspace(), &Workspace::outputRemoved, this, &Compositor::removeOutput);
+
+        if (FTraceLogger::self()->isChromeTraceActive() && !outputs.isEmpty()) {
+            // the startup trace ends once the first frame is on the screen
+            connect(outputs.constFirst()->renderLoop(), &RenderLoop::framePresented, this, []() {
+                fTrace("First frame presented");
+                FTraceLogger::self()->stopChromeTrace();
+            }, Qt::SingleShotConnection);
+        }
     }
 
     m_state = State::On;
@@ -379,8 +405,11 @@ void Compositor::startupWithWorkspace()
         window->setupCompositing();
     }
 
-    // Sets also the 'effects' pointer.
-    kwinApp()->createEffectsHandler(this, m_scene.get());
+    {
+        fTraceDuration("Create effects handler");
+        // Sets also the 'effects' pointer.
+        kwinApp()->createEffectsHandler(this, m_scene.get());
+    }
 
     Q_EMIT compositingToggled(true);
 
@@ -460,12 +489,15 @@ void Compositor::addSuperLayer(RenderLayer *layer)
 {
     m_superlayers.insert(layer->loop(), layer);
     connect(layer->loop(), &RenderLoop::frameRequested, this, &Compositor::handleFrameRequested);
+    connect(layer->loop(), &RenderLoop::framePresented, this, &Compositor::handleFramePresented);
 }
 
 void Compositor::removeSuperLayer(RenderLayer *layer)
 {
     m_superlayers.remove(layer->loop());
+    m_overlays.remove(layer->loop());
     disconnect(layer->loop(), &RenderLoop::frameRequested, this, &Compositor::handleFrameRequested);
+    disconnect(layer->loop(), &RenderLoop::framePresented, this, &Compositor::handleFramePresented);
     delete layer;
 }
 
@@ -599,15 +631,73 @@ void Compositor::reinitialize()
 
 void Compositor::handleFrameRequested(RenderLoop *renderLoop)
 {
+    // The outputs are composited one after another. If another output presents earlier and
+    // its compositing cycle would start before this one is done, composite it first, so a
+    // slow frame on one output doesn't make the other outputs miss their vblanks.
+    const RenderLoopPrivate *renderLoopPrivate = RenderLoopPrivate::get(renderLoop);
+    const std::chrono::nanoseconds finished = std::chrono::steady_clock::now().time_since_epoch() + renderLoopPrivate->expectedRenderTime;
+    QList<RenderLoop *> earlier;
+    for (auto it = m_superlayers.constBegin(); it != m_superlayers.constEnd(); ++it) {
+        const RenderLoopPrivate *other = RenderLoopPrivate::get(it.key());
+        if (it.key() != renderLoop && other->compositeTimer.isActive()
+            && other->nextRenderTimestamp < finished
+            && other->nextPresentationTimestamp < renderLoopPrivate->nextPresentationTimestamp) {
+            earlier.append(it.key());
+        }
+    }
+    std::sort(earlier.begin(), earlier.end(), [](RenderLoop *a, RenderLoop *b) {
+        return RenderLoopPrivate::get(a)->nextPresentationTimestamp < RenderLoopPrivate::get(b)->nextPresentationTimestamp;
+    });
+    for (RenderLoop *other : std::as_const(earlier)) {
+        // it may have been composited by a nested call already
+        if (RenderLoopPrivate::get(other)->compositeTimer.isActive()) {
+            RenderLoopPrivate::get(other)->dispatchNow();
+        }
+    }
+
     composite(renderLoop);
 }
 
+void Compositor::handleFramePresented(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp)
+{
+    Output *output = findOutput(renderLoop);
+    if (!output || !FTraceLogger::self()->isEnabled()) {
+        return;
+    }
+    // the newer frames may still be in flight
+    const QList<FrameTelemetry> frames = renderLoop->frameTelemetry(4);
+    const auto it = std::find_if(frames.crbegin(), frames.crend(), [timestamp](const FrameTelemetry &frame) {
+        return frame.flip == timestamp;
+    });
+    if (it == frames.crend()) {
+        return;
+    }
+    const FrameTelemetry &frame = *it;
+    const auto us = [](std::chrono::nanoseconds timestamp) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(timestamp).count();
+    };
+    // the timestamps of the frame, so missed vblanks can be found in the trace
+    fTrace("Frame (", output->name(), ") target_vblank=", us(frame.targetVblank),
+           " composite_start=", us(frame.compositeStart), " render_end=", us(frame.renderEnd),
+           " commit=", us(frame.commit), " flip=", us(frame.flip));
+}
+
 uint Compositor::outputFormat(Output *output)
 {
     OutputLayer *primaryLayer = m_backend->primaryLayer(output);
     return primaryLayer->format();
 }
 
+static bool isFullScreenSurface(SurfaceItem *surfaceItem)
+{
+    for (Item *item = surfaceItem; item; item = item->parentItem()) {
+        if (auto windowItem = qobject_cast<WindowItem *>(item)) {
+            return windowItem->window()->isFullScreen();
+        }
+    }
+    return false;
+}
+
 void Compositor::composite(RenderLoop *renderLoop)
 {
     if (m_backend->checkGraphicsReset()) {
@@ -628,10 +718,14 @@ void Compositor::composite(RenderLoop *renderLoop)
     superLayer->setOutputLayer(primaryLayer);
 
     SurfaceItem *scanoutCandidate = superLayer->delegate()->scanoutCandidate();
-    renderLoop->setFullscreenSurface(scanoutCandidate);
+    // the wallpaper can be scanned out as well, but it shouldn't enable adaptive sync or tearing
+    renderLoop->setFullscreenSurface(scanoutCandidate && isFullScreenSurface(scanoutCandidate) ? scanoutCandidate : nullptr);
     output->setContentType(scanoutCandidate ? scanoutCandidate->contentType() : ContentType::None);
 
     renderLoop->beginFrame();
+    const QRect previousOverlayRect = m_overlays.value(renderLoop).rect;
+    const SurfaceItem *previousOverlayItem = m_overlays.value(renderLoop).item;
+    QRect overlayRect;
     bool directScanout = false;
     if (scanoutCandidate) {
         const auto sublayers = superLayer->sublayers();
@@ -639,14 +733,37 @@ void Compositor::composite(RenderLoop *renderLoop)
             return sublayer->isVisible();
         });
         if (scanoutPossible && !output->directScanoutInhibited()) {
-            directScanout = primaryLayer->scanout(scanoutCandidate);
+            // surfaces stacked above the candidate, e.g. OSDs, have to go on an overlay layer
+            const QList<SurfaceItem *> overlayCandidates = superLayer->delegate()->scanoutOverlayCandidates();
+            if (overlayCandidates.isEmpty()) {
+                directScanout = primaryLayer->scanout(scanoutCandidate);
+            } else if (overlayCandidates.size() == 1) {
+                overlayRect = scanoutOverlay(output, superLayer, overlayCandidates.constFirst());
+                directScanout = !overlayRect.isEmpty() && primaryLayer->scanout(scanoutCandidate);
+            }
         }
     }
+    if (!directScanout) {
+        overlayRect = scanoutOverlay(output, superLayer, superLayer->delegate()->overlayCandidate());
+    }
 
     if (!directScanout) {
+        SurfaceItem *overlayItem = m_overlays.value(renderLoop).item;
+        superLayer->delegate()->setOverlaySurface(overlayItem);
+
         QRegion surfaceDamage = primaryLayer->repaints();
         primaryLayer->resetRepaints();
-        preparePaintPass(superLayer, &surfaceDamage);
+        QRegion opaque;
+        if (overlayItem && overlayItem->opaque().contains(overlayItem->rect().toRect())) {
+            opaque = overlayRect;
+        } else if (overlayItem && overlayItem != previousOverlayItem) {
+            // a translucent surface is blended with the primary plane, which still shows it
+            surfaceDamage += overlayRect;
+        }
+        preparePaintPass(superLayer, &surfaceDamage, opaque);
+        output->setContentColorDepth(superLayer->delegate()->contentColorDepth());
+        // the contents below the overlay aren't visible, but they have to be up to date once it goes away
+        surfaceDamage += QRegion(previousOverlayRect) - overlayRect;
 
         if (auto beginInfo = primaryLayer->beginFrame()) {
             auto &[renderTarget, repaint] = beginInfo.value();
@@ -656,6 +773,8 @@ void Compositor::composite(RenderLoop *renderLoop)
             paintPass(superLayer, renderTarget, bufferDamage);
             primaryLayer->endFrame(bufferDamage, surfaceDamage);
         }
+    } else if (!previousOverlayRect.isEmpty()) {
+        primaryLayer->addRepaint(previousOverlayRect);
     }
 
     postPaintPass(superLayer);
@@ -663,6 +782,13 @@ void Compositor::composite(RenderLoop *renderLoop)
 
     m_backend->present(output);
 
+    // drop idle caches between frames so the textures are not needed by a pending paint pass
+    if (m_backend->compositingType() == OpenGLCompositing
+        && GLTextureMemory::budget() > 0 && GLTextureMemory::totalUsage() > GLTextureMemory::budget()) {
+        m_scene->makeOpenGLContextCurrent();
+        GLTextureMemory::enforceBudget();
+    }
+
     // TODO: Put it inside the cursor layer once the cursor layer can be backed by a real output layer.
     if (waylandServer()) {
         const std::chrono::milliseconds frameTime =
@@ -677,6 +803,42 @@ void Compositor::composite(RenderLoop *renderLoop)
     }
 }
 
+QRect Compositor::scanoutOverlay(Output *output, RenderLayer *superLayer, SurfaceItem *candidate)
+{
+    const QList<OutputLayer *> overlayLayers = m_backend->overlayLayers(output);
+    OverlayState &state = m_overlays[output->renderLoop()];
+
+    QRect rect;
+    if (overlayLayers.isEmpty() || output->directScanoutInhibited()) {
+        candidate = nullptr;
+    }
+    if (candidate) {
+        rect = candidate->mapToGlobal(candidate->rect()).toAlignedRect().translated(-output->geometry().topLeft());
+        // sublayers, e.g. a software cursor, are painted on top of the primary layer only
+        const auto sublayers = superLayer->sublayers();
+        const bool covered = std::any_of(sublayers.begin(), sublayers.end(), [&rect](RenderLayer *sublayer) {
+            return sublayer->isVisible() && sublayer->mapToGlobal(sublayer->rect()).toAlignedRect().intersects(rect);
+        });
+        if (covered || !overlayLayers.constFirst()->scanout(candidate)) {
+            candidate = nullptr;
+            rect = QRect();
+        }
+    }
+
+    for (OutputLayer *overlayLayer : overlayLayers) {
+        if (!candidate || overlayLayer != overlayLayers.constFirst()) {
+            overlayLayer->releaseScanout();
+        }
+    }
+    if (state.item && state.item != candidate) {
+        // the damage of the surface has been dropped while it was on the overlay
+        state.item->destroyPixmap();
+    }
+    state.item = candidate;
+    state.rect = rect;
+    return rect;
+}
+
 void Compositor::prePaintPass(RenderLayer *layer)
 {
     layer->delegate()->prePaint();
@@ -695,15 +857,15 @@ void Compositor::postPaintPass(RenderLayer *layer)
     }
 }
 
-void Compositor::preparePaintPass(RenderLayer *layer, QRegion *repaint)
+void Compositor::preparePaintPass(RenderLayer *layer, QRegion *repaint, const QRegion &opaque)
 {
-    // TODO: Cull opaque region.
-    *repaint += layer->mapToGlobal(layer->repaints() + layer->delegate()->repaints());
+    // the repaints hidden behind an opaque overlay plane don't need to be painted
+    *repaint += layer->mapToGlobal(layer->repaints() + layer->delegate()->repaints()) - opaque;
     layer->resetRepaints();
     const auto sublayers = layer->sublayers();
     for (RenderLayer *sublayer : sublayers) {
         if (sublayer->isVisible()) {
-            preparePaintPass(sublayer, repaint);
+            preparePaintPass(sublayer, repaint, opaque);
         }
     }
 }
@@ -784,6 +946,17 @@ X11Compositor::X11Compositor(QObject *parent)
     if (qEnvironmentVariableIsSet("KWIN_MAX_FRAMES_TESTED")) {
         m_framesToTestForSafety = qEnvironmentVariableIntValue("KWIN_MAX_FRAMES_TESTED");
     }
+
+    m_fullscreenSuspendTimer.setSingleShot(true);
+    m_fullscreenSuspendTimer.setInterval(std::chrono::seconds(1));
+    connect(&m_fullscreenSuspendTimer, &QTimer::timeout, this, [this]() {
+        if (!m_suspended && canSuspendForFullscreen()) {
+            suspend(FullscreenSuspend);
+        }
+    });
+    connect(options, &Options::unredirectFullscreenChanged, this, &X11Compositor::updateFullscreenSuspend);
+    connect(workspace(), &Workspace::windowActivated, this, &X11Compositor::trackActiveWindow);
+    connect(workspace(), &Workspace::geometryChanged, this, &X11Compositor::updateFullscreenSuspend);
 }
 
 X11Compositor::~X11Compositor()
@@ -871,6 +1044,9 @@ void X11Compositor::start()
         if (m_suspended & ScriptSuspend) {
             reasons << QStringLiteral("Disabled by Script");
         }
+        if (m_suspended & FullscreenSuspend) {
+            reasons << QStringLiteral("Disabled by Fullscreen Window");
+        }
         qCInfo(KWIN_CORE) << "Compositing is suspended, reason:" << reasons;
         return;
     } else if (!compositingPossible()) {
@@ -1008,6 +1184,65 @@ void X11Compositor::updateClientCompositeBlocking(X11Window *c)
     }
 }
 
+void X11Compositor::trackActiveWindow(Window *window)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(m_activeWindowConnections)) {
+        disconnect(connection);
+    }
+    m_activeWindowConnections.clear();
+
+    if (window) {
+        m_activeWindowConnections = {
+            connect(window, &Window::fullScreenChanged, this, &X11Compositor::updateFullscreenSuspend),
+            connect(window, &Window::frameGeometryChanged, this, &X11Compositor::updateFullscreenSuspend),
+            connect(window, &Window::opacityChanged, this, &X11Compositor::updateFullscreenSuspend),
+        };
+    }
+    updateFullscreenSuspend();
+}
+
+bool X11Compositor::canSuspendForFullscreen() const
+{
+    if (!options->unredirectFullscreen()) {
+        return false;
+    }
+    X11Window *window = qobject_cast<X11Window *>(workspace()->activeWindow());
+    if (!window || !window->isFullScreen() || window->isDeleted()) {
+        return false;
+    }
+    // the window has to hide everything behind it on its output
+    if (window->hasAlpha() || window->opacity() < 1.0 || window->frameGeometry() != workspace()->clientArea(FullScreenArea, window)) {
+        return false;
+    }
+    // an active effect that paints on top of the window would be lost while compositing is
+    // suspended. Once it is suspended there is no effects handler to ask anymore
+    if (effects && static_cast<EffectsHandlerImpl *>(effects)->blocksDirectScanout()) {
+        return false;
+    }
+    return true;
+}
+
+void X11Compositor::updateFullscreenSuspend()
+{
+    if (canSuspendForFullscreen()) {
+        // only an active compositor is suspended, it's pointless if compositing is off anyway
+        if (!m_suspended && !m_fullscreenSuspendTimer.isActive()) {
+            m_fullscreenSuspendTimer.start();
+        }
+        return;
+    }
+
+    m_fullscreenSuspendTimer.stop();
+    if (m_suspended & FullscreenSuspend) {
+        // Do NOT attempt to call resume() from within the eventchain!
+        QMetaObject::invokeMethod(
+            this, [this]() {
+                resume(FullscreenSuspend);
+            },
+            Qt::QueuedConnection);
+    }
+}
+
 X11Compositor *X11Compositor::self()
 {
     return qobject_cast<X11Compositor *>(Compositor::self());
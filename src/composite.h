@@ -12,8 +12,10 @@
 #include "libkwineffects/kwinglobals.h"
 
 #include <QObject>
+#include <QPointer>
 #include <QRegion>
 #include <QTimer>
+#include <chrono>
 #include <memory>
 
 namespace KWin
@@ -32,6 +34,7 @@ class Window;
 class X11Window;
 class X11SyncManager;
 class RenderViewport;
+class SurfaceItem;
 
 class KWIN_EXPORT Compositor : public QObject
 {
@@ -180,6 +183,7 @@ protected Q_SLOTS:
 
 private Q_SLOTS:
     void handleFrameRequested(RenderLoop *renderLoop);
+    void handleFramePresented(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp);
 
 private:
     void initializeX11();
@@ -200,8 +204,9 @@ private:
 
     void prePaintPass(RenderLayer *layer);
     void postPaintPass(RenderLayer *layer);
-    void preparePaintPass(RenderLayer *layer, QRegion *repaint);
+    void preparePaintPass(RenderLayer *layer, QRegion *repaint, const QRegion &opaque);
     void paintPass(RenderLayer *layer, const RenderTarget &renderTarget, const QRegion &region);
+    QRect scanoutOverlay(Output *output, RenderLayer *superLayer, SurfaceItem *candidate);
 
     State m_state = State::Off;
     std::unique_ptr<CompositorSelectionOwner> m_selectionOwner;
@@ -212,6 +217,13 @@ private:
     std::unique_ptr<CursorScene> m_cursorScene;
     std::unique_ptr<RenderBackend> m_backend;
     QHash<RenderLoop *, RenderLayer *> m_superlayers;
+
+    struct OverlayState
+    {
+        QPointer<SurfaceItem> item;
+        QRect rect;
+    };
+    QHash<RenderLoop *, OverlayState> m_overlays;
     CompositingType m_selectedCompositor = NoCompositing;
 };
 
@@ -240,6 +252,7 @@ public:
         UserSuspend = 1 << 0,
         BlockRuleSuspend = 1 << 1,
         ScriptSuspend = 1 << 2,
+        FullscreenSuspend = 1 << 3,
         AllReasonSuspend = 0xff
     };
     Q_DECLARE_FLAGS(SuspendReasons, SuspendReason)
@@ -302,6 +315,12 @@ public:
 
     void updateClientCompositeBlocking(X11Window *client = nullptr);
 
+    /**
+     * Suspends compositing if the active window is a fullscreen X11 window that can be shown
+     * without compositing, or resumes it if that's no longer the case.
+     */
+    void updateFullscreenSuspend();
+
     static X11Compositor *self();
 
 protected:
@@ -312,6 +331,9 @@ protected:
 private:
     explicit X11Compositor(QObject *parent);
 
+    bool canSuspendForFullscreen() const;
+    void trackActiveWindow(Window *window);
+
     std::unique_ptr<QThread> m_openGLFreezeProtectionThread;
     std::unique_ptr<QTimer> m_openGLFreezeProtection;
     std::unique_ptr<X11SyncManager> m_syncManager;
@@ -320,6 +342,10 @@ private:
      */
     SuspendReasons m_suspended;
     int m_framesToTestForSafety = 3;
+    // delays suspending for a fullscreen window, so toggling fullscreen or switching
+    // between windows doesn't make compositing flicker on and off
+    QTimer m_fullscreenSuspendTimer;
+    QList<QMetaObject::Connection> m_activeWindowConnections;
 };
 
 }
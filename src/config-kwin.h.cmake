@@ -17,6 +17,7 @@
 #cmakedefine01 HAVE_MEMFD
 #cmakedefine01 HAVE_BREEZE_DECO
 #cmakedefine01 HAVE_SCHED_RESET_ON_FORK
+#cmakedefine01 HAVE_TIMERFD
 #cmakedefine01 HAVE_ACCESSIBILITY
 #cmakedefine01 HAVE_XKBCOMMON_NO_SECURE_GETENV
 #if HAVE_BREEZE_DECO
@@ -13,9 +13,30 @@
 
 #include "utils/common.h"
 
+#include <algorithm>
+#include <array>
+
 namespace KWin
 {
 
+// enough entries to not lose precision with the largest gamma ramps
+static const int s_toneCurveSize = 4096;
+static const int s_lutGridPoints = 33;
+
+static int sampleCombinedStages(const cmsUInt16Number in[], cmsUInt16Number out[], void *cargo)
+{
+    cmsPipelineEval16(in, out, static_cast<cmsPipeline *>(cargo));
+    return TRUE;
+}
+
+static void unlinkStages(cmsPipeline *pipeline)
+{
+    cmsStage *last = nullptr;
+    do {
+        cmsPipelineUnlinkStage(pipeline, cmsAT_END, &last);
+    } while (last);
+}
+
 ColorTransformation::ColorTransformation(std::vector<std::unique_ptr<ColorPipelineStage>> &&stages)
     : m_pipeline(cmsPipelineAlloc(nullptr, 3, 3))
     , m_stages(std::move(stages))
@@ -32,19 +53,78 @@ ColorTransformation::ColorTransformation(std::vector<std::unique_ptr<ColorPipeli
             return;
         }
     }
+    if (m_stages.size() > 1) {
+        compile();
+    }
 }
 
 ColorTransformation::~ColorTransformation()
 {
     if (m_pipeline) {
-        cmsStage *last = nullptr;
-        do {
-            cmsPipelineUnlinkStage(m_pipeline, cmsAT_END, &last);
-        } while (last);
+        unlinkStages(m_pipeline);
         cmsPipelineFree(m_pipeline);
     }
 }
 
+void ColorTransformation::compile()
+{
+    const bool toneCurvesOnly = std::all_of(m_stages.cbegin(), m_stages.cend(), [](const auto &stage) {
+        return cmsStageType(stage->stage()) == cmsSigCurveSetElemType;
+    });
+
+    cmsStage *combined = nullptr;
+    if (toneCurvesOnly) {
+        // The channels don't affect each other, so each of them can be tabulated on its own
+        std::array<std::vector<cmsUInt16Number>, 3> tables;
+        for (auto &table : tables) {
+            table.resize(s_toneCurveSize);
+        }
+        for (int i = 0; i < s_toneCurveSize; i++) {
+            const cmsUInt16Number value = (i * 0xFFFF) / (s_toneCurveSize - 1);
+            const cmsUInt16Number in[3] = {value, value, value};
+            cmsUInt16Number out[3] = {0, 0, 0};
+            cmsPipelineEval16(in, out, m_pipeline);
+            for (int channel = 0; channel < 3; channel++) {
+                tables[channel][i] = out[channel];
+            }
+        }
+
+        cmsToneCurve *toneCurves[3] = {nullptr, nullptr, nullptr};
+        for (int channel = 0; channel < 3; channel++) {
+            toneCurves[channel] = cmsBuildTabulatedToneCurve16(nullptr, s_toneCurveSize, tables[channel].data());
+        }
+        if (toneCurves[0] && toneCurves[1] && toneCurves[2]) {
+            // the stage makes its own copies of the tone curves
+            combined = cmsStageAllocToneCurves(nullptr, 3, toneCurves);
+        }
+        for (cmsToneCurve *toneCurve : toneCurves) {
+            if (toneCurve) {
+                cmsFreeToneCurve(toneCurve);
+            }
+        }
+    } else {
+        combined = cmsStageAllocCLut16bit(nullptr, s_lutGridPoints, 3, 3, nullptr);
+        if (combined && !cmsStageSampleCLut16bit(combined, sampleCombinedStages, m_pipeline, 0)) {
+            cmsStageFree(combined);
+            combined = nullptr;
+        }
+    }
+
+    if (!combined) {
+        // the stages still work as they are, just slower
+        qCWarning(KWIN_CORE) << "Failed to combine the color pipeline stages";
+        return;
+    }
+
+    unlinkStages(m_pipeline);
+    m_stages.clear();
+    m_stages.push_back(std::make_unique<ColorPipelineStage>(combined));
+    if (!cmsPipelineInsertStage(m_pipeline, cmsAT_END, combined)) {
+        qCWarning(KWIN_CORE) << "Failed to insert cmsPipeline stage!";
+        m_valid = false;
+    }
+}
+
 bool ColorTransformation::valid() const
 {
     return m_valid;
@@ -22,6 +22,16 @@ namespace KWin
 
 class ColorPipelineStage;
 
+/**
+ * The ColorTransformation class evaluates a chain of color pipeline stages.
+ *
+ * A chain of several stages is compiled into a single stage when the transformation is created,
+ * so sampling it later, e.g. for a gamma ramp, costs one lookup per sample regardless of how many
+ * stages it was made of. Chains of per-channel tone curves are fused into one set of tabulated
+ * tone curves, any other chain is sampled into a 3D lookup table.
+ *
+ * Creating a transformation doesn't touch any global state, so it may happen on a worker thread.
+ */
 class KWIN_EXPORT ColorTransformation
 {
 public:
@@ -33,8 +43,10 @@ public:
     std::tuple<uint16_t, uint16_t, uint16_t> transform(uint16_t r, uint16_t g, uint16_t b) const;
 
 private:
+    void compile();
+
     cmsPipeline *const m_pipeline;
-    const std::vector<std::unique_ptr<ColorPipelineStage>> m_stages;
+    std::vector<std::unique_ptr<ColorPipelineStage>> m_stages;
     bool m_valid = true;
 };
 
@@ -24,6 +24,10 @@ GbmGraphicsBufferAllocator::~GbmGraphicsBufferAllocator()
 
 GbmGraphicsBuffer *GbmGraphicsBufferAllocator::allocate(const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers)
 {
+    if (GraphicsBuffer *buffer = m_pool.take(size, format, modifiers)) {
+        return static_cast<GbmGraphicsBuffer *>(buffer);
+    }
+
     gbm_bo *bo = nullptr;
 
     if (!modifiers.isEmpty() && !(modifiers.size() == 1 && modifiers.first() == DRM_FORMAT_MOD_INVALID)) {
@@ -53,7 +57,9 @@ GbmGraphicsBuffer *GbmGraphicsBufferAllocator::allocate(const QSize &size, uint3
         return nullptr;
     }
 
-    return new GbmGraphicsBuffer(std::move(attributes.value()), bo);
+    auto buffer = new GbmGraphicsBuffer(std::move(attributes.value()), bo);
+    m_pool.manage(buffer, size, format, modifiers);
+    return buffer;
 }
 
 GbmGraphicsBuffer::GbmGraphicsBuffer(DmaBufAttributes attributes, gbm_bo *handle)
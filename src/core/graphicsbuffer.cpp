@@ -5,9 +5,12 @@
 */
 
 #include "core/graphicsbuffer.h"
+#include "core/graphicsbufferallocator.h"
 
 #include <drm_fourcc.h>
 
+#include <algorithm>
+
 namespace KWin
 {
 
@@ -37,7 +40,7 @@ void GraphicsBuffer::unref()
     --m_refCount;
     if (!m_refCount) {
         if (m_dropped) {
-            delete this;
+            discard();
         } else {
             Q_EMIT released();
         }
@@ -50,6 +53,16 @@ void GraphicsBuffer::drop()
     Q_EMIT dropped();
 
     if (!m_refCount) {
+        discard();
+    }
+}
+
+void GraphicsBuffer::discard()
+{
+    if (m_pool) {
+        m_dropped = false;
+        m_pool->recycle(this);
+    } else {
         delete this;
     }
 }
@@ -64,6 +77,22 @@ const ShmAttributes *GraphicsBuffer::shmAttributes() const
     return nullptr;
 }
 
+const SinglePixelAttributes *GraphicsBuffer::singlePixelAttributes() const
+{
+    return nullptr;
+}
+
+int GraphicsBuffer::colorDepth() const
+{
+    if (const DmaBufAttributes *attributes = dmabufAttributes()) {
+        return std::max(8, colorDepthFromDrmFormat(attributes->format));
+    }
+    if (const ShmAttributes *attributes = shmAttributes()) {
+        return std::max(8, colorDepthFromDrmFormat(attributes->format));
+    }
+    return 8;
+}
+
 bool GraphicsBuffer::alphaChannelFromDrmFormat(uint32_t format)
 {
     switch (format) {
@@ -101,4 +130,37 @@ bool GraphicsBuffer::alphaChannelFromDrmFormat(uint32_t format)
     }
 }
 
+int GraphicsBuffer::colorDepthFromDrmFormat(uint32_t format)
+{
+    switch (format) {
+    case DRM_FORMAT_XRGB8888:
+    case DRM_FORMAT_XBGR8888:
+    case DRM_FORMAT_RGBX8888:
+    case DRM_FORMAT_BGRX8888:
+    case DRM_FORMAT_ARGB8888:
+    case DRM_FORMAT_ABGR8888:
+    case DRM_FORMAT_RGBA8888:
+    case DRM_FORMAT_BGRA8888:
+    case DRM_FORMAT_RGB888:
+    case DRM_FORMAT_BGR888:
+        return 8;
+    case DRM_FORMAT_XRGB2101010:
+    case DRM_FORMAT_XBGR2101010:
+    case DRM_FORMAT_RGBX1010102:
+    case DRM_FORMAT_BGRX1010102:
+    case DRM_FORMAT_ARGB2101010:
+    case DRM_FORMAT_ABGR2101010:
+    case DRM_FORMAT_RGBA1010102:
+    case DRM_FORMAT_BGRA1010102:
+        return 10;
+    case DRM_FORMAT_XRGB16161616F:
+    case DRM_FORMAT_XBGR16161616F:
+    case DRM_FORMAT_ARGB16161616F:
+    case DRM_FORMAT_ABGR16161616F:
+        return 16;
+    default:
+        return -1;
+    }
+}
+
 } // namespace KWin
@@ -10,11 +10,14 @@
 #include "utils/filedescriptor.h"
 
 #include <QObject>
+#include <QPointer>
 #include <QSize>
 
 namespace KWin
 {
 
+class GraphicsBufferPool;
+
 struct DmaBufAttributes
 {
     int planeCount = 0;
@@ -37,12 +40,27 @@ struct ShmAttributes
     uint32_t format;
 };
 
+/**
+ * The color of a buffer that consists of a single pixel. The components are premultiplied
+ * by alpha and span the full range of uint32_t.
+ */
+struct SinglePixelAttributes
+{
+    uint32_t red = 0;
+    uint32_t green = 0;
+    uint32_t blue = 0;
+    uint32_t alpha = 0;
+};
+
 /**
  * The GraphicsBuffer class represents a chunk of memory containing graphics data.
  *
  * A graphics buffer can be referenced. In which case, it won't be destroyed until all
  * references are dropped. You can use the isDropped() function to check whether the
  * buffer has been marked as destroyed.
+ *
+ * A buffer that was allocated with a GraphicsBufferAllocator goes back to the pool of the
+ * allocator rather than being destroyed once it's dropped and not referenced anymore.
  */
 class KWIN_EXPORT GraphicsBuffer : public QObject
 {
@@ -63,8 +81,20 @@ public:
 
     virtual const DmaBufAttributes *dmabufAttributes() const;
     virtual const ShmAttributes *shmAttributes() const;
+    virtual const SinglePixelAttributes *singlePixelAttributes() const;
+
+    /**
+     * Returns the number of bits per color channel of the buffer, e.g. 8 for regular buffers
+     * and 10 or 16 for buffers with high color depth contents.
+     */
+    int colorDepth() const;
 
     static bool alphaChannelFromDrmFormat(uint32_t format);
+    /**
+     * Returns the number of bits per color channel of the given drm fourcc @a format, or -1
+     * if it's unknown.
+     */
+    static int colorDepthFromDrmFormat(uint32_t format);
 
 Q_SIGNALS:
     void released();
@@ -73,6 +103,12 @@ Q_SIGNALS:
 protected:
     int m_refCount = 0;
     bool m_dropped = false;
+
+private:
+    void discard();
+
+    QPointer<GraphicsBufferPool> m_pool;
+    friend class GraphicsBufferPool;
 };
 
 } // namespace KWin
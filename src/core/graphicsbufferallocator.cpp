@@ -5,10 +5,110 @@
 */
 
 #include "core/graphicsbufferallocator.h"
+#include "core/graphicsbuffer.h"
+
+#include <algorithm>
 
 namespace KWin
 {
 
+// how long a dropped buffer is kept around, and how many of them at most
+static const std::chrono::seconds s_idleTimeout(3);
+static const std::size_t s_maxIdleBuffers = 8;
+
+GraphicsBufferPool::GraphicsBufferPool(QObject *parent)
+    : QObject(parent)
+{
+    m_trimTimer.setSingleShot(true);
+    connect(&m_trimTimer, &QTimer::timeout, this, &GraphicsBufferPool::trim);
+}
+
+GraphicsBufferPool::~GraphicsBufferPool()
+{
+    clear();
+}
+
+GraphicsBuffer *GraphicsBufferPool::take(const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers)
+{
+    const Key key{
+        .size = size,
+        .format = format,
+        .modifiers = modifiers,
+    };
+
+    // the most recently dropped buffer is the most likely one to be still in the caches
+    auto it = std::find_if(m_idleBuffers.rbegin(), m_idleBuffers.rend(), [&key](const IdleBuffer &idle) {
+        return idle.key == key;
+    });
+    if (it == m_idleBuffers.rend()) {
+        return nullptr;
+    }
+
+    GraphicsBuffer *buffer = it->buffer;
+    m_idleBuffers.erase(std::next(it).base());
+    m_keys.insert(buffer, key);
+    return buffer;
+}
+
+void GraphicsBufferPool::manage(GraphicsBuffer *buffer, const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers)
+{
+    buffer->m_pool = this;
+    m_keys.insert(buffer, Key{
+                              .size = size,
+                              .format = format,
+                              .modifiers = modifiers,
+                          });
+}
+
+void GraphicsBufferPool::clear()
+{
+    m_trimTimer.stop();
+    const auto idleBuffers = std::move(m_idleBuffers);
+    m_idleBuffers.clear();
+    for (const IdleBuffer &idle : idleBuffers) {
+        m_keys.remove(idle.buffer);
+        delete idle.buffer;
+    }
+}
+
+void GraphicsBufferPool::recycle(GraphicsBuffer *buffer)
+{
+    auto key = m_keys.find(buffer);
+    Q_ASSERT(key != m_keys.end());
+
+    m_idleBuffers.push_back(IdleBuffer{
+        .key = key.value(),
+        .buffer = buffer,
+        .since = std::chrono::steady_clock::now(),
+    });
+
+    if (m_idleBuffers.size() > s_maxIdleBuffers) {
+        GraphicsBuffer *oldest = m_idleBuffers.front().buffer;
+        m_idleBuffers.erase(m_idleBuffers.begin());
+        m_keys.remove(oldest);
+        delete oldest;
+    }
+
+    if (!m_trimTimer.isActive()) {
+        m_trimTimer.start(s_idleTimeout);
+    }
+}
+
+void GraphicsBufferPool::trim()
+{
+    const auto threshold = std::chrono::steady_clock::now() - s_idleTimeout;
+    while (!m_idleBuffers.empty() && m_idleBuffers.front().since <= threshold) {
+        GraphicsBuffer *buffer = m_idleBuffers.front().buffer;
+        m_idleBuffers.erase(m_idleBuffers.begin());
+        m_keys.remove(buffer);
+        delete buffer;
+    }
+
+    if (!m_idleBuffers.empty()) {
+        m_trimTimer.start(std::chrono::ceil<std::chrono::milliseconds>(m_idleBuffers.front().since - threshold));
+    }
+}
+
 GraphicsBufferAllocator::GraphicsBufferAllocator()
 {
 }
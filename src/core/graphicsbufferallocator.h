@@ -8,14 +8,75 @@
 
 #include "kwin_export.h"
 
+#include <QHash>
+#include <QObject>
 #include <QSize>
+#include <QTimer>
 #include <QVector>
 
+#include <chrono>
+#include <vector>
+
 namespace KWin
 {
 
 class GraphicsBuffer;
 
+/**
+ * The GraphicsBufferPool class keeps the buffers of an allocator that have been dropped, so
+ * they can be handed out again instead of allocating new buffers with the same size, format
+ * and modifiers. Buffers that stay idle for a few seconds are destroyed.
+ */
+class KWIN_EXPORT GraphicsBufferPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GraphicsBufferPool(QObject *parent = nullptr);
+    ~GraphicsBufferPool() override;
+
+    /**
+     * Returns an idle buffer that was allocated with the given parameters, or @c null.
+     */
+    GraphicsBuffer *take(const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers);
+
+    /**
+     * Makes the given newly allocated @a buffer return to the pool instead of being destroyed
+     * when it's dropped and not referenced anymore.
+     */
+    void manage(GraphicsBuffer *buffer, const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers);
+
+    /**
+     * Destroys all idle buffers.
+     */
+    void clear();
+
+private:
+    struct Key
+    {
+        QSize size;
+        uint32_t format;
+        QVector<uint64_t> modifiers;
+
+        bool operator==(const Key &other) const = default;
+    };
+    struct IdleBuffer
+    {
+        Key key;
+        GraphicsBuffer *buffer;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    void recycle(GraphicsBuffer *buffer);
+    void trim();
+
+    QHash<GraphicsBuffer *, Key> m_keys;
+    std::vector<IdleBuffer> m_idleBuffers;
+    QTimer m_trimTimer;
+
+    friend class GraphicsBuffer;
+};
+
 class KWIN_EXPORT GraphicsBufferAllocator
 {
 public:
@@ -23,6 +84,9 @@ public:
     virtual ~GraphicsBufferAllocator();
 
     virtual GraphicsBuffer *allocate(const QSize &size, uint32_t format, const QVector<uint64_t> &modifiers = {}) = 0;
+
+protected:
+    GraphicsBufferPool m_pool;
 };
 
 } // namespace KWin
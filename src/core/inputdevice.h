@@ -52,6 +52,11 @@ Q_SIGNALS:
     void pointerButtonChanged(quint32 button, InputRedirection::PointerButtonState state, std::chrono::microseconds time, InputDevice *device);
     void pointerMotionAbsolute(const QPointF &position, std::chrono::microseconds time, InputDevice *device);
     void pointerMotion(const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device);
+    /**
+     * Emitted instead of pointerMotion() when several motion events arrived at once. The
+     * @a samples are in chronological order.
+     */
+    void pointerMotionCoalesced(const QList<KWin::PointerMotionSample> &samples, InputDevice *device);
     void pointerAxisChanged(InputRedirection::PointerAxis axis, qreal delta, qint32 deltaV120,
                             InputRedirection::PointerAxisSource source, std::chrono::microseconds time, InputDevice *device);
     void touchFrame(InputDevice *device);
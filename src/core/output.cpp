@@ -420,6 +420,16 @@ void Output::setContentType(ContentType contentType)
     m_contentType = contentType;
 }
 
+int Output::contentColorDepth() const
+{
+    return m_contentColorDepth;
+}
+
+void Output::setContentColorDepth(int depth)
+{
+    m_contentColorDepth = depth;
+}
+
 Output::Transform Output::panelOrientation() const
 {
     return m_information.panelOrientation;
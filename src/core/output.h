@@ -251,6 +251,13 @@ public:
     ContentType contentType() const;
     void setContentType(ContentType contentType);
 
+    /**
+     * The number of bits per color channel of the contents shown on the output, it's used
+     * to pick a buffer format that doesn't waste memory bandwidth on 8 bit contents.
+     */
+    int contentColorDepth() const;
+    void setContentColorDepth(int depth);
+
     bool isPlaceholder() const;
     bool isNonDesktop() const;
     Transform panelOrientation() const;
@@ -357,6 +364,7 @@ protected:
     int m_directScanoutCount = 0;
     int m_refCount = 1;
     ContentType m_contentType = ContentType::None;
+    int m_contentColorDepth = 8;
     friend class EffectScreenImpl; // to access m_effectScreen
 };
 
@@ -64,4 +64,13 @@ bool OutputLayer::scanout(SurfaceItem *surfaceItem)
     return false;
 }
 
+void OutputLayer::releaseScanout()
+{
+}
+
+std::chrono::nanoseconds OutputLayer::queryRenderTime() const
+{
+    return std::chrono::nanoseconds::zero();
+}
+
 } // namespace KWin
@@ -11,6 +11,7 @@
 
 #include <QObject>
 #include <QRegion>
+#include <chrono>
 #include <optional>
 
 namespace KWin
@@ -57,6 +58,18 @@ public:
      */
     virtual bool scanout(SurfaceItem *surfaceItem);
 
+    /**
+     * Stops scanning out the surface that was passed to the last successful scanout() call
+     * on a layer that is presented alongside the primary layer, e.g. an overlay layer.
+     */
+    virtual void releaseScanout();
+
+    /**
+     * Returns the time it took to render the last frame, including the time the GPU
+     * spent on it. Returns zero if the layer can't measure the render time.
+     */
+    virtual std::chrono::nanoseconds queryRenderTime() const;
+
 private:
     QRegion m_repaints;
     QPointF m_hotspot;
@@ -22,6 +22,11 @@ OutputLayer *RenderBackend::cursorLayer(Output *output)
     return nullptr;
 }
 
+QList<OutputLayer *> RenderBackend::overlayLayers(Output *output)
+{
+    return {};
+}
+
 OverlayWindow *RenderBackend::overlayWindow() const
 {
     return nullptr;
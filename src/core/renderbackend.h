@@ -46,6 +46,11 @@ public:
 
     virtual OutputLayer *primaryLayer(Output *output) = 0;
     virtual OutputLayer *cursorLayer(Output *output);
+    /**
+     * Returns the layers that can be used to scan out surfaces on top of the primary layer
+     * of the specified @a output, e.g. hardware overlay planes.
+     */
+    virtual QList<OutputLayer *> overlayLayers(Output *output);
     virtual void present(Output *output) = 0;
 
     virtual bool testImportBuffer(KWaylandServer::LinuxDmaBufV1ClientBuffer *buffer);
@@ -6,51 +6,112 @@
 
 #include "renderjournal.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace KWin
 {
 
+// The weight of the newest sample in the exponentially weighted moving average.
+static const double s_smoothingFactor = 0.1;
+
 RenderJournal::RenderJournal()
 {
 }
 
-void RenderJournal::beginFrame()
+void RenderJournal::add(std::chrono::nanoseconds renderTime)
+{
+    m_log[m_head] = renderTime;
+    m_head = (m_head + 1) % s_capacity;
+    m_count = std::min(m_count + 1, s_capacity);
+
+    const double sample = renderTime.count();
+    if (m_count == 1) {
+        m_exponentialAverage = sample;
+        m_exponentialVariance = 0;
+    } else {
+        const double delta = sample - m_exponentialAverage;
+        m_exponentialAverage += s_smoothingFactor * delta;
+        m_exponentialVariance = (1 - s_smoothingFactor) * (m_exponentialVariance + s_smoothingFactor * delta * delta);
+    }
+}
+
+int RenderJournal::count() const
 {
-    m_timer.start();
+    return m_count;
 }
 
-void RenderJournal::endFrame()
+template<typename Func>
+void RenderJournal::forEachRecent(int count, Func func) const
 {
-    std::chrono::nanoseconds duration(m_timer.nsecsElapsed());
-    if (m_log.count() >= m_size) {
-        m_log.dequeue();
+    count = std::min(count, m_count);
+    for (int i = 1; i <= count; ++i) {
+        func(m_log[(m_head - i + s_capacity) % s_capacity]);
     }
-    m_log.enqueue(duration);
 }
 
 std::chrono::nanoseconds RenderJournal::minimum() const
 {
-    auto it = std::min_element(m_log.constBegin(), m_log.constEnd());
-    return it != m_log.constEnd() ? (*it) : std::chrono::nanoseconds::zero();
+    if (!m_count) {
+        return std::chrono::nanoseconds::zero();
+    }
+    std::chrono::nanoseconds result = std::chrono::nanoseconds::max();
+    forEachRecent(s_recentCount, [&result](std::chrono::nanoseconds entry) {
+        result = std::min(result, entry);
+    });
+    return result;
 }
 
 std::chrono::nanoseconds RenderJournal::maximum() const
 {
-    auto it = std::max_element(m_log.constBegin(), m_log.constEnd());
-    return it != m_log.constEnd() ? (*it) : std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds result = std::chrono::nanoseconds::zero();
+    forEachRecent(s_recentCount, [&result](std::chrono::nanoseconds entry) {
+        result = std::max(result, entry);
+    });
+    return result;
 }
 
 std::chrono::nanoseconds RenderJournal::average() const
 {
-    if (m_log.isEmpty()) {
+    if (!m_count) {
         return std::chrono::nanoseconds::zero();
     }
 
     std::chrono::nanoseconds result = std::chrono::nanoseconds::zero();
-    for (const std::chrono::nanoseconds &entry : m_log) {
+    forEachRecent(s_recentCount, [&result](std::chrono::nanoseconds entry) {
         result += entry;
+    });
+
+    return result / std::min(m_count, s_recentCount);
+}
+
+std::chrono::nanoseconds RenderJournal::percentile(qreal percentile) const
+{
+    if (!m_count) {
+        return std::chrono::nanoseconds::zero();
     }
 
-    return result / m_log.count();
+    std::array<std::chrono::nanoseconds, s_capacity> sorted;
+    std::copy_n(m_log.begin(), m_count, sorted.begin());
+
+    const int rank = std::clamp(int(std::ceil(percentile / 100.0 * m_count)) - 1, 0, m_count - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + m_count);
+    return sorted[rank];
+}
+
+std::chrono::nanoseconds RenderJournal::exponentialAverage() const
+{
+    return std::chrono::nanoseconds(std::llround(m_exponentialAverage));
+}
+
+std::chrono::nanoseconds RenderJournal::standardDeviation() const
+{
+    return std::chrono::nanoseconds(std::llround(std::sqrt(m_exponentialVariance)));
+}
+
+std::chrono::nanoseconds RenderJournal::safetyMargin(std::chrono::nanoseconds minimum, std::chrono::nanoseconds maximum) const
+{
+    return std::clamp(2 * standardDeviation(), minimum, std::max(minimum, maximum));
 }
 
 } // namespace KWin
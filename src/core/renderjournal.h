@@ -8,8 +8,8 @@
 
 #include "libkwineffects/kwinglobals.h"
 
-#include <QElapsedTimer>
-#include <QQueue>
+#include <array>
+#include <chrono>
 
 namespace KWin
 {
@@ -17,6 +17,10 @@ namespace KWin
 /**
  * The RenderJournal class measures how long it takes to render frames and estimates how
  * long it will take to render the next frame.
+ *
+ * The journal keeps the render times of the last capacity() frames in a ring buffer. The
+ * minimum(), maximum() and average() estimates only consider the most recent frames while
+ * percentile() looks at the whole journal so a single outlier doesn't dominate the result.
  */
 class KWIN_EXPORT RenderJournal
 {
@@ -24,14 +28,23 @@ public:
     RenderJournal();
 
     /**
-     * This function must be called before starting rendering a new frame.
+     * Records the time it took to render a frame, that is the time from the moment the
+     * compositor started painting until both the CPU and the GPU have finished.
      */
-    void beginFrame();
+    void add(std::chrono::nanoseconds renderTime);
 
     /**
-     * This function must be called after finishing rendering a frame.
+     * Returns the number of frames that are currently recorded in the journal.
      */
-    void endFrame();
+    int count() const;
+
+    /**
+     * Returns the maximum number of frames that can be recorded in the journal.
+     */
+    static constexpr int capacity()
+    {
+        return s_capacity;
+    }
 
     /**
      * Returns the maximum estimated amount of time that it takes to render a single frame.
@@ -48,10 +61,43 @@ public:
      */
     std::chrono::nanoseconds average() const;
 
+    /**
+     * Returns the render time that is not exceeded by @a percentile percent of the recorded
+     * frames, @a percentile must be in the range [0, 100].
+     */
+    std::chrono::nanoseconds percentile(qreal percentile) const;
+
+    /**
+     * Returns the exponentially weighted moving average of the render time. Recent frames
+     * have a bigger weight than older frames.
+     */
+    std::chrono::nanoseconds exponentialAverage() const;
+
+    /**
+     * Returns the exponentially weighted standard deviation of the render time.
+     */
+    std::chrono::nanoseconds standardDeviation() const;
+
+    /**
+     * Returns the amount of time that should be added on top of the estimated render time
+     * to account for the jitter in render times. The margin grows with the variance of the
+     * render times, but is never smaller than @a minimum and never bigger than @a maximum.
+     */
+    std::chrono::nanoseconds safetyMargin(std::chrono::nanoseconds minimum, std::chrono::nanoseconds maximum) const;
+
 private:
-    QElapsedTimer m_timer;
-    QQueue<std::chrono::nanoseconds> m_log;
-    int m_size = 15;
+    template<typename Func>
+    void forEachRecent(int count, Func func) const;
+
+    // big enough that the 99th percentile isn't just the maximum
+    static constexpr int s_capacity = 256;
+    static constexpr int s_recentCount = 15;
+
+    std::array<std::chrono::nanoseconds, s_capacity> m_log;
+    int m_head = 0;
+    int m_count = 0;
+    double m_exponentialAverage = 0;
+    double m_exponentialVariance = 0;
 };
 
 } // namespace KWin
@@ -37,4 +37,23 @@ SurfaceItem *RenderLayerDelegate::scanoutCandidate() const
     return nullptr;
 }
 
+QList<SurfaceItem *> RenderLayerDelegate::scanoutOverlayCandidates() const
+{
+    return {};
+}
+
+SurfaceItem *RenderLayerDelegate::overlayCandidate() const
+{
+    return nullptr;
+}
+
+void RenderLayerDelegate::setOverlaySurface(SurfaceItem *item)
+{
+}
+
+int RenderLayerDelegate::contentColorDepth() const
+{
+    return 8;
+}
+
 } // namespace KWin
@@ -8,6 +8,7 @@
 
 #include "kwin_export.h"
 
+#include <QList>
 #include <QRegion>
 
 namespace KWin
@@ -52,6 +53,33 @@ public:
      */
     virtual SurfaceItem *scanoutCandidate() const;
 
+    /**
+     * Returns the surfaces that are stacked above the direct scanout candidate. Direct scanout
+     * is only possible if all of them can be put on overlay layers.
+     */
+    virtual QList<SurfaceItem *> scanoutOverlayCandidates() const;
+
+    /**
+     * Returns the surface that should be promoted to an overlay layer hint. Unlike the direct
+     * scanout candidate, it doesn't have to cover the whole render layer. This function is
+     * called after prePaint().
+     */
+    virtual SurfaceItem *overlayCandidate() const;
+
+    /**
+     * Tells the delegate that @a item is shown on an overlay layer in the current frame, so it
+     * must not be painted into the render layer. If the surface is translucent, the contents
+     * below it are still painted. This function is called after prePaint().
+     */
+    virtual void setOverlaySurface(SurfaceItem *item);
+
+    /**
+     * Returns the highest number of bits per color channel among the visible contents. The
+     * output switches to a buffer format with a higher color depth only while such contents
+     * are shown. This function is called after prePaint().
+     */
+    virtual int contentColorDepth() const;
+
     /**
      * This function is called when the compositor wants the render layer delegate
      * to repaint its contents.
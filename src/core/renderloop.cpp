@@ -28,17 +28,18 @@ RenderLoopPrivate *RenderLoopPrivate::get(RenderLoop *loop)
 RenderLoopPrivate::RenderLoopPrivate(RenderLoop *q)
     : q(q)
 {
-    compositeTimer.setSingleShot(true);
-    QObject::connect(&compositeTimer, &QTimer::timeout, q, [this]() {
+    QObject::connect(&compositeTimer, &PreciseTimer::timeout, q, [this]() {
         dispatch();
     });
 }
 
 void RenderLoopPrivate::scheduleRepaint()
 {
-    if (kwinApp()->isTerminating() || (compositeTimer.isActive() && !allowTearing)) {
+    // a repeated frame makes room for a new one
+    if (kwinApp()->isTerminating() || (compositeTimer.isActive() && !allowTearing && !lowFramerateCompensation)) {
         return;
     }
+    lowFramerateCompensation = false;
     if (vrrPolicy == RenderLoop::VrrPolicy::Always || (vrrPolicy == RenderLoop::VrrPolicy::Automatic && fullscreenItem != nullptr)) {
         presentMode = allowTearing ? SyncMode::AdaptiveAsync : SyncMode::Adaptive;
     } else {
@@ -48,14 +49,17 @@ void RenderLoopPrivate::scheduleRepaint()
     const std::chrono::nanoseconds currentTime(std::chrono::steady_clock::now().time_since_epoch());
 
     // Estimate when the next presentation will occur. Note that this is a prediction.
-    nextPresentationTimestamp = lastPresentationTimestamp + vblankInterval;
+    // The frames that are still queued are presented first.
+    nextPresentationTimestamp = lastPresentationTimestamp + vblankInterval * (pendingFrameCount + 1);
     if (nextPresentationTimestamp < currentTime && presentMode == SyncMode::Fixed) {
         nextPresentationTimestamp = lastPresentationTimestamp
-            + alignTimestamp(currentTime - lastPresentationTimestamp, vblankInterval);
+            + alignTimestamp(currentTime - lastPresentationTimestamp, vblankInterval)
+            + vblankInterval * pendingFrameCount;
     }
 
-    // Estimate when it's a good time to perform the next compositing cycle.
-    const std::chrono::nanoseconds safetyMargin = std::chrono::milliseconds(3);
+    // Estimate when it's a good time to perform the next compositing cycle. The safety
+    // margin grows with the jitter of the render times.
+    const std::chrono::nanoseconds safetyMargin = renderJournal.safetyMargin(std::chrono::milliseconds(1), std::min<std::chrono::nanoseconds>(std::chrono::milliseconds(5), vblankInterval / 4));
 
     std::chrono::nanoseconds renderTime;
     switch (q->latencyPolicy()) {
@@ -86,9 +90,25 @@ void RenderLoopPrivate::scheduleRepaint()
     case RenderTimeEstimatorAverage:
         renderTime = std::max(renderTime, renderJournal.average());
         break;
+    case RenderTimeEstimatorPercentile90:
+        renderTime = std::max(renderTime, renderJournal.percentile(90));
+        break;
+    case RenderTimeEstimatorPercentile99:
+        renderTime = std::max(renderTime, renderJournal.percentile(99));
+        break;
+    case RenderTimeEstimatorExponentialAverage:
+        renderTime = std::max(renderTime, renderJournal.exponentialAverage());
+        break;
     }
 
-    std::chrono::nanoseconds nextRenderTimestamp = nextPresentationTimestamp - renderTime - safetyMargin;
+    if (presentMode == SyncMode::Adaptive) {
+        // with adaptive sync the frame is shown as soon as it's ready, but not earlier
+        // than the highest refresh rate allows
+        nextPresentationTimestamp = std::max(nextPresentationTimestamp, currentTime + renderTime + safetyMargin);
+    }
+
+    nextRenderTimestamp = nextPresentationTimestamp - renderTime - safetyMargin;
+    expectedRenderTime = renderTime;
 
     // If we can't render the frame before the deadline, start compositing immediately.
     if (nextRenderTimestamp < currentTime) {
@@ -96,10 +116,10 @@ void RenderLoopPrivate::scheduleRepaint()
     }
 
     if (presentMode == SyncMode::Async || presentMode == SyncMode::AdaptiveAsync) {
-        compositeTimer.start(0);
+        nextRenderTimestamp = currentTime;
+        compositeTimer.start(std::chrono::nanoseconds::zero());
     } else {
-        const std::chrono::nanoseconds waitInterval = nextRenderTimestamp - currentTime;
-        compositeTimer.start(std::chrono::duration_cast<std::chrono::milliseconds>(waitInterval));
+        compositeTimer.start(nextRenderTimestamp - currentTime);
     }
 }
 
@@ -116,21 +136,108 @@ void RenderLoopPrivate::maybeScheduleRepaint()
     }
 }
 
+void RenderLoopPrivate::notifyContentFrame()
+{
+    const std::chrono::nanoseconds currentTime(std::chrono::steady_clock::now().time_since_epoch());
+    const std::chrono::nanoseconds delta = currentTime - lastContentFrameTimestamp;
+    if (delta < std::chrono::milliseconds(1)) {
+        // several repaints for the same commit, e.g. of subsurfaces
+        return;
+    }
+    lastContentFrameTimestamp = currentTime;
+    if (delta > std::chrono::seconds(1)) {
+        // the content was idle, it doesn't tell anything about the frame rate
+        contentFrameInterval = std::chrono::nanoseconds::zero();
+    } else if (contentFrameInterval == std::chrono::nanoseconds::zero()) {
+        contentFrameInterval = delta;
+    } else {
+        contentFrameInterval = (contentFrameInterval * 3 + delta) / 4;
+    }
+}
+
+void RenderLoopPrivate::scheduleLowFramerateCompensation()
+{
+    if (presentMode != SyncMode::Adaptive || !minimumAdaptiveRefreshRate || !fullscreenItem
+        || pendingFrameCount || inhibitCount || compositeTimer.isActive()) {
+        return;
+    }
+    // leave some headroom, the repeated frame can be late as well
+    const std::chrono::nanoseconds maximumFrameDuration(900'000'000'000ull / minimumAdaptiveRefreshRate);
+    if (contentFrameInterval <= maximumFrameDuration) {
+        return;
+    }
+    // Below the adaptive sync range the display would refresh on its own, and a new frame that
+    // arrives during such a refresh has to wait for it to finish. Show each frame of the content
+    // several times instead, at a rate within the range
+    const std::chrono::nanoseconds vblankInterval(1'000'000'000'000ull / refreshRate);
+    const int64_t multiplier = (contentFrameInterval.count() + maximumFrameDuration.count() - 1) / maximumFrameDuration.count();
+    const std::chrono::nanoseconds repeatInterval = std::max(contentFrameInterval / multiplier, vblankInterval);
+
+    // the repeated frame is a regular frame for the compositor, e.g. animations are advanced
+    // to the time at which it's presented
+    const std::chrono::nanoseconds currentTime(std::chrono::steady_clock::now().time_since_epoch());
+    const std::chrono::nanoseconds renderTime = renderJournal.maximum();
+    nextPresentationTimestamp = std::max(lastPresentationTimestamp + repeatInterval, currentTime + renderTime + std::chrono::milliseconds(1));
+    nextRenderTimestamp = nextPresentationTimestamp - renderTime - std::chrono::milliseconds(1);
+    expectedRenderTime = renderTime;
+    lowFramerateCompensation = true;
+    compositeTimer.start(nextRenderTimestamp - currentTime);
+}
+
+FrameTelemetry &RenderLoopPrivate::newestTelemetry()
+{
+    Q_ASSERT(telemetryCount > 0);
+    return telemetry[(telemetryCount - 1) % telemetryCapacity];
+}
+
+FrameTelemetry &RenderLoopPrivate::oldestPendingTelemetry()
+{
+    Q_ASSERT(!pendingTelemetry.empty());
+    return telemetry[pendingTelemetry.front() % telemetryCapacity];
+}
+
+void RenderLoopPrivate::notifyFrameCommitted()
+{
+    if (telemetryCount) {
+        newestTelemetry().commit = std::chrono::steady_clock::now().time_since_epoch();
+    }
+}
+
 void RenderLoopPrivate::notifyFrameFailed()
 {
     Q_ASSERT(pendingFrameCount > 0);
     pendingFrameCount--;
+    if (!pendingFeedback.empty()) {
+        // the feedback gets discarded
+        pendingFeedback.pop_front();
+    }
+    // the frame that has just been submitted is the one that failed
+    if (!pendingTelemetry.empty()) {
+        telemetry[pendingTelemetry.back() % telemetryCapacity].discarded = true;
+        pendingTelemetry.pop_back();
+    }
 
     if (!inhibitCount) {
         maybeScheduleRepaint();
     }
 }
 
-void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp)
+void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp, std::chrono::nanoseconds renderTime,
+                                             uint64_t sequence, PresentationFlags flags)
 {
     Q_ASSERT(pendingFrameCount > 0);
+    FrameTelemetry &frame = oldestPendingTelemetry();
+    pendingTelemetry.pop_front();
     pendingFrameCount--;
 
+    // The render time reported by the backend includes the time the GPU spent on the
+    // frame; if it's not available, only the time spent on the CPU is known.
+    renderJournal.add(std::max(pendingRenderTime, renderTime));
+    frame.flip = timestamp;
+    frame.renderTime = std::max(pendingRenderTime, renderTime);
+    lastCpuRenderTime = pendingRenderTime;
+    lastRenderTime = renderTime;
+
     if (lastPresentationTimestamp <= timestamp) {
         lastPresentationTimestamp = timestamp;
     } else {
@@ -141,8 +248,19 @@ void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp)
         lastPresentationTimestamp = std::chrono::steady_clock::now().time_since_epoch();
     }
 
+    if (!pendingFeedback.empty()) {
+        const bool variableRefreshRate = presentMode == SyncMode::Adaptive || presentMode == SyncMode::AdaptiveAsync;
+        const std::chrono::nanoseconds refreshCycleDuration = variableRefreshRate ? std::chrono::nanoseconds::zero() : std::chrono::nanoseconds(1'000'000'000'000ull / refreshRate);
+        const auto feedbacks = std::move(pendingFeedback.front());
+        pendingFeedback.pop_front();
+        for (const auto &feedback : feedbacks) {
+            feedback->presented(refreshCycleDuration, timestamp, sequence, flags);
+        }
+    }
+
     if (!inhibitCount) {
         maybeScheduleRepaint();
+        scheduleLowFramerateCompensation();
     }
 
     Q_EMIT q->framePresented(q, timestamp);
@@ -150,6 +268,8 @@ void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp)
 
 void RenderLoopPrivate::dispatch()
 {
+    lowFramerateCompensation = false;
+
     // On X11, we want to ignore repaints that are scheduled by windows right before
     // the Compositor starts repainting.
     pendingRepaint = true;
@@ -161,10 +281,18 @@ void RenderLoopPrivate::dispatch()
     pendingRepaint = false;
 }
 
+void RenderLoopPrivate::dispatchNow()
+{
+    compositeTimer.stop();
+    dispatch();
+}
+
 void RenderLoopPrivate::invalidate()
 {
     pendingReschedule = false;
     pendingFrameCount = 0;
+    pendingFeedback.clear();
+    pendingTelemetry.clear();
     compositeTimer.stop();
 }
 
@@ -198,14 +326,27 @@ void RenderLoop::uninhibit()
 
 void RenderLoop::beginFrame()
 {
+    d->pendingTelemetry.push_back(d->telemetryCount);
+    d->telemetry[d->telemetryCount++ % RenderLoopPrivate::telemetryCapacity] = FrameTelemetry{
+        .targetVblank = d->nextPresentationTimestamp,
+        .compositeStart = std::chrono::steady_clock::now().time_since_epoch(),
+    };
     d->pendingRepaint = false;
     d->pendingFrameCount++;
-    d->renderJournal.beginFrame();
+    d->pendingFeedback.emplace_back();
+    d->renderTimer.start();
 }
 
 void RenderLoop::endFrame()
 {
-    d->renderJournal.endFrame();
+    d->pendingRenderTime = std::chrono::nanoseconds(d->renderTimer.nsecsElapsed());
+    d->newestTelemetry().renderEnd = std::chrono::steady_clock::now().time_since_epoch();
+}
+
+void RenderLoop::addPresentationFeedback(std::unique_ptr<PresentationFeedback> &&feedback)
+{
+    Q_ASSERT(!d->pendingFeedback.empty());
+    d->pendingFeedback.back().push_back(std::move(feedback));
 }
 
 int RenderLoop::refreshRate() const
@@ -224,10 +365,13 @@ void RenderLoop::setRefreshRate(int refreshRate)
 
 void RenderLoop::scheduleRepaint(Item *item)
 {
+    if (item && item == d->fullscreenItem) {
+        d->notifyContentFrame();
+    }
     if (d->pendingRepaint || (d->fullscreenItem != nullptr && item != nullptr && item != d->fullscreenItem)) {
         return;
     }
-    if (!d->pendingFrameCount && !d->inhibitCount) {
+    if (d->pendingFrameCount < d->maxPendingFrameCount && !d->inhibitCount) {
         d->scheduleRepaint();
     } else {
         d->delayScheduleRepaint();
@@ -259,6 +403,18 @@ std::chrono::nanoseconds RenderLoop::nextPresentationTimestamp() const
     return d->nextPresentationTimestamp;
 }
 
+QList<FrameTelemetry> RenderLoop::frameTelemetry(int count) const
+{
+    const size_t available = std::min(d->telemetryCount, RenderLoopPrivate::telemetryCapacity);
+    const size_t n = std::min(available, size_t(std::max(count, 0)));
+    QList<FrameTelemetry> frames;
+    frames.reserve(n);
+    for (size_t i = d->telemetryCount - n; i < d->telemetryCount; ++i) {
+        frames.append(d->telemetry[i % RenderLoopPrivate::telemetryCapacity]);
+    }
+    return frames;
+}
+
 void RenderLoop::setFullscreenSurface(Item *surfaceItem)
 {
     d->fullscreenItem = surfaceItem;
@@ -9,14 +9,64 @@
 #include "libkwineffects/kwinglobals.h"
 #include "options.h"
 
+#include <QList>
 #include <QObject>
 
+#include <chrono>
+#include <memory>
+
 namespace KWin
 {
 
 class RenderLoopPrivate;
 class Item;
 
+enum class PresentationFlag {
+    VSync = 0x1,
+    HwClock = 0x2,
+    HwCompletion = 0x4,
+    ZeroCopy = 0x8,
+};
+Q_DECLARE_FLAGS(PresentationFlags, PresentationFlag)
+
+/**
+ * The FrameTelemetry struct records when a frame went through the stages of the render loop.
+ * The timestamps are sourced from the monotonic clock. A zero timestamp means that the frame
+ * hasn't reached the stage, e.g. because it's still in flight or it has been discarded, or
+ * that the backend doesn't report it.
+ */
+struct FrameTelemetry
+{
+    // the vblank the frame has been scheduled for
+    std::chrono::nanoseconds targetVblank = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds compositeStart = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds renderEnd = std::chrono::nanoseconds::zero();
+    // when the frame has been handed over to the display hardware
+    std::chrono::nanoseconds commit = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds flip = std::chrono::nanoseconds::zero();
+    // the time the frame took to render, including the time on the GPU if it's known
+    std::chrono::nanoseconds renderTime = std::chrono::nanoseconds::zero();
+    // the frame couldn't be presented, it has no flip timestamp
+    bool discarded = false;
+};
+
+/**
+ * The PresentationFeedback class is notified when the frame it has been attached to
+ * has been presented on the screen. If the frame is never presented, the feedback is
+ * destroyed without being notified.
+ */
+class KWIN_EXPORT PresentationFeedback
+{
+public:
+    virtual ~PresentationFeedback() = default;
+
+    /**
+     * @a refreshCycleDuration is zero if the refresh rate isn't fixed. @a sequence is
+     * the vblank counter of the output, or zero if it isn't known.
+     */
+    virtual void presented(std::chrono::nanoseconds refreshCycleDuration, std::chrono::nanoseconds timestamp, uint64_t sequence, PresentationFlags flags) = 0;
+};
+
 /**
  * The RenderLoop class represents the compositing scheduler on a particular output.
  *
@@ -59,6 +109,12 @@ public:
      */
     void endFrame();
 
+    /**
+     * Attaches @a feedback to the frame that is currently being rendered, i.e. between
+     * beginFrame() and endFrame().
+     */
+    void addPresentationFeedback(std::unique_ptr<PresentationFeedback> &&feedback);
+
     /**
      * Returns the refresh rate at which the output is being updated, in millihertz.
      */
@@ -87,6 +143,12 @@ public:
      */
     std::chrono::nanoseconds nextPresentationTimestamp() const;
 
+    /**
+     * Returns the telemetry of up to @a count most recent frames, the oldest one comes first.
+     * The frames that are still in flight are included.
+     */
+    QList<FrameTelemetry> frameTelemetry(int count) const;
+
     /**
      * Sets the surface that currently gets scanned out,
      * so that this RenderLoop can adjust its timing behavior to that surface
@@ -150,3 +212,5 @@ private:
 };
 
 } // namespace KWin
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KWin::PresentationFlags)
@@ -8,10 +8,14 @@
 
 #include "renderjournal.h"
 #include "renderloop.h"
+#include "utils/precisetimer.h"
 
-#include <QTimer>
+#include <QElapsedTimer>
 
+#include <array>
+#include <deque>
 #include <optional>
+#include <vector>
 
 namespace KWin
 {
@@ -23,22 +27,43 @@ public:
     explicit RenderLoopPrivate(RenderLoop *q);
 
     void dispatch();
+    /**
+     * Starts the scheduled compositing cycle right away, ahead of its timer.
+     */
+    void dispatchNow();
     void invalidate();
 
     void delayScheduleRepaint();
     void scheduleRepaint();
     void maybeScheduleRepaint();
 
+    void notifyContentFrame();
+    void scheduleLowFramerateCompensation();
+
+    void notifyFrameCommitted();
     void notifyFrameFailed();
-    void notifyFrameCompleted(std::chrono::nanoseconds timestamp);
+    void notifyFrameCompleted(std::chrono::nanoseconds timestamp, std::chrono::nanoseconds renderTime = std::chrono::nanoseconds::zero(),
+                              uint64_t sequence = 0, PresentationFlags flags = PresentationFlags());
 
     RenderLoop *q;
     std::chrono::nanoseconds lastPresentationTimestamp = std::chrono::nanoseconds::zero();
     std::chrono::nanoseconds nextPresentationTimestamp = std::chrono::nanoseconds::zero();
-    QTimer compositeTimer;
+    PreciseTimer compositeTimer;
+    // when the scheduled compositing cycle starts and how long it's expected to take
+    std::chrono::nanoseconds nextRenderTimestamp = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds expectedRenderTime = std::chrono::nanoseconds::zero();
     RenderJournal renderJournal;
+    QElapsedTimer renderTimer;
+    std::chrono::nanoseconds pendingRenderTime = std::chrono::nanoseconds::zero();
+    // the time the last presented frame took on the CPU, and in total if the backend knows it
+    std::chrono::nanoseconds lastCpuRenderTime = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds lastRenderTime = std::chrono::nanoseconds::zero();
     int refreshRate = 60000;
     int pendingFrameCount = 0;
+    // the number of frames that may be rendered ahead of the page flips
+    int maxPendingFrameCount = 1;
+    // presentation feedback of the frames in flight, the oldest frame comes first
+    std::deque<std::vector<std::unique_ptr<PresentationFeedback>>> pendingFeedback;
     int inhibitCount = 0;
     bool pendingReschedule = false;
     bool pendingRepaint = false;
@@ -46,6 +71,13 @@ public:
     std::optional<LatencyPolicy> latencyPolicy;
     Item *fullscreenItem = nullptr;
     bool allowTearing = false;
+    // the lowest refresh rate the output can do with adaptive sync, in mHz, or 0 if unknown
+    int minimumAdaptiveRefreshRate = 0;
+    // how often the fullscreen surface presents new frames, on average
+    std::chrono::nanoseconds contentFrameInterval = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds lastContentFrameTimestamp = std::chrono::nanoseconds::zero();
+    // whether the scheduled frame only repeats the last one, to stay in the adaptive sync range
+    bool lowFramerateCompensation = false;
 
     enum class SyncMode {
         Fixed,
@@ -56,6 +88,16 @@ public:
     };
     SyncMode presentMode = SyncMode::Fixed;
     bool canDoTearing = false;
+
+    // the telemetry of the most recent frames, the frames in flight are the last ones
+    static constexpr size_t telemetryCapacity = 256;
+    std::array<FrameTelemetry, telemetryCapacity> telemetry;
+    // the number of frames that have been recorded so far
+    size_t telemetryCount = 0;
+    // the numbers of the recorded frames that are in flight, oldest first
+    std::deque<size_t> pendingTelemetry;
+    FrameTelemetry &newestTelemetry();
+    FrameTelemetry &oldestPendingTelemetry();
 };
 
 } // namespace KWin
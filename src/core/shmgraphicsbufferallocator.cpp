@@ -50,6 +50,10 @@ ShmGraphicsBuffer *ShmGraphicsBufferAllocator::allocate(const QSize &size, uint3
         return nullptr;
     }
 
+    if (GraphicsBuffer *buffer = m_pool.take(size, format, modifiers)) {
+        return static_cast<ShmGraphicsBuffer *>(buffer);
+    }
+
     const int stride = size.width() * 4;
     const int bufferSize = size.height() * stride;
 
@@ -82,13 +86,15 @@ ShmGraphicsBuffer *ShmGraphicsBufferAllocator::allocate(const QSize &size, uint3
     }
 #endif
 
-    return new ShmGraphicsBuffer(ShmAttributes{
+    auto buffer = new ShmGraphicsBuffer(ShmAttributes{
         .fd = std::move(fd),
         .stride = stride,
         .offset = 0,
         .size = size,
         .format = format,
     });
+    m_pool.manage(buffer, size, format, modifiers);
+    return buffer;
 }
 
 } // namespace KWin
@@ -0,0 +1,108 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "core/syncobjtimeline.h"
+#include "utils/common.h"
+
+#include <sys/eventfd.h>
+#include <xf86drm.h>
+
+#ifndef DRM_IOCTL_SYNCOBJ_EVENTFD
+struct drm_syncobj_eventfd
+{
+    __u32 handle;
+    __u32 flags;
+    __u64 point;
+    __s32 fd;
+    __u32 pad;
+};
+#define DRM_IOCTL_SYNCOBJ_EVENTFD DRM_IOWR(0xCF, struct drm_syncobj_eventfd)
+#endif
+
+namespace KWin
+{
+
+SyncTimeline::SyncTimeline(int drmFd, uint32_t handle)
+    : m_drmFd(drmFd)
+    , m_handle(handle)
+{
+}
+
+SyncTimeline::~SyncTimeline()
+{
+    drmSyncobjDestroy(m_drmFd, m_handle);
+}
+
+FileDescriptor SyncTimeline::eventFd(uint64_t timelinePoint) const
+{
+    FileDescriptor fd(eventfd(0, EFD_CLOEXEC));
+    if (!fd.isValid()) {
+        return FileDescriptor{};
+    }
+    drm_syncobj_eventfd request{
+        .handle = m_handle,
+        .flags = 0,
+        .point = timelinePoint,
+        .fd = fd.get(),
+        .pad = 0,
+    };
+    if (drmIoctl(m_drmFd, DRM_IOCTL_SYNCOBJ_EVENTFD, &request) != 0) {
+        return FileDescriptor{};
+    }
+    return fd;
+}
+
+void SyncTimeline::signal(uint64_t timelinePoint)
+{
+    drmSyncobjTimelineSignal(m_drmFd, const_cast<uint32_t *>(&m_handle), &timelinePoint, 1);
+}
+
+void SyncTimeline::moveInto(uint64_t timelinePoint, const FileDescriptor &syncFile)
+{
+    uint32_t binaryHandle = 0;
+    if (drmSyncobjCreate(m_drmFd, 0, &binaryHandle) != 0) {
+        signal(timelinePoint);
+        return;
+    }
+    if (drmSyncobjImportSyncFile(m_drmFd, binaryHandle, syncFile.get()) != 0
+        || drmSyncobjTransfer(m_drmFd, m_handle, timelinePoint, binaryHandle, 0, 0) != 0) {
+        // don't leave the client waiting forever
+        signal(timelinePoint);
+    }
+    drmSyncobjDestroy(m_drmFd, binaryHandle);
+}
+
+SyncReleasePoint::SyncReleasePoint(const std::shared_ptr<SyncTimeline> &timeline, uint64_t timelinePoint)
+    : m_timeline(timeline)
+    , m_timelinePoint(timelinePoint)
+{
+}
+
+SyncReleasePoint::~SyncReleasePoint()
+{
+    if (m_releaseFence.isValid()) {
+        m_timeline->moveInto(m_timelinePoint, m_releaseFence);
+    } else {
+        m_timeline->signal(m_timelinePoint);
+    }
+}
+
+SyncTimeline *SyncReleasePoint::timeline() const
+{
+    return m_timeline.get();
+}
+
+uint64_t SyncReleasePoint::timelinePoint() const
+{
+    return m_timelinePoint;
+}
+
+void SyncReleasePoint::addReleaseFence(const FileDescriptor &fd)
+{
+    m_releaseFence = fd.duplicate();
+}
+
+} // namespace KWin
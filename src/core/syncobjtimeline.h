@@ -0,0 +1,81 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+#include "utils/filedescriptor.h"
+
+#include <memory>
+#include <stdint.h>
+
+namespace KWin
+{
+
+/**
+ * The SyncTimeline class represents a drm timeline syncobj. A point on the timeline is
+ * signaled once the work that is associated with it has been completed.
+ *
+ * The drm file descriptor must outlive the timeline.
+ */
+class KWIN_EXPORT SyncTimeline
+{
+public:
+    explicit SyncTimeline(int drmFd, uint32_t handle);
+    ~SyncTimeline();
+
+    /**
+     * Returns an eventfd that becomes readable once the specified @a timelinePoint is
+     * signaled. Unlike a sync file, the eventfd can be created before a fence has been
+     * attached to the point. Returns an invalid file descriptor if the kernel doesn't
+     * support syncobj eventfds.
+     */
+    FileDescriptor eventFd(uint64_t timelinePoint) const;
+
+    /**
+     * Signals the specified @a timelinePoint immediately.
+     */
+    void signal(uint64_t timelinePoint);
+
+    /**
+     * Attaches the fence contained in @a syncFile to the specified @a timelinePoint, the
+     * point gets signaled once the fence is signaled.
+     */
+    void moveInto(uint64_t timelinePoint, const FileDescriptor &syncFile);
+
+private:
+    const int m_drmFd;
+    const uint32_t m_handle;
+};
+
+/**
+ * The SyncReleasePoint class represents a point on a timeline that is signaled once
+ * the compositor doesn't use a buffer anymore. The point is signaled when the last
+ * reference to the release point is dropped.
+ */
+class KWIN_EXPORT SyncReleasePoint
+{
+public:
+    explicit SyncReleasePoint(const std::shared_ptr<SyncTimeline> &timeline, uint64_t timelinePoint);
+    ~SyncReleasePoint();
+
+    SyncTimeline *timeline() const;
+    uint64_t timelinePoint() const;
+
+    /**
+     * Adds a fence that has to be signaled before the release point can be signaled, e.g.
+     * a fence for rendering commands that read the buffer. Only the most recent fence is
+     * kept, the render commands of a single context are executed in order.
+     */
+    void addReleaseFence(const FileDescriptor &fd);
+
+private:
+    const std::shared_ptr<SyncTimeline> m_timeline;
+    const uint64_t m_timelinePoint;
+    FileDescriptor m_releaseFence;
+};
+
+} // namespace KWin
@@ -18,8 +18,12 @@
 #include "composite.h"
 #include "core/output.h"
 #include "core/renderbackend.h"
+#include "core/renderloop.h"
 #include "debug_console.h"
+#include "input.h"
+#include "inputlatencymonitor.h"
 #include "kwinadaptor.h"
+#include "libkwineffects/gltexturememory.h"
 #include "main.h"
 #include "placement.h"
 #include "pluginmanager.h"
@@ -217,6 +221,61 @@ QVariantMap DBusInterface::getWindowInfo(const QString &uuid)
     }
 }
 
+QVariantMap DBusInterface::inputLatency()
+{
+    if (InputLatencyMonitor *monitor = input() ? input()->latencyMonitor() : nullptr) {
+        return monitor->statistics();
+    }
+    return {};
+}
+
+void DBusInterface::resetInputLatency()
+{
+    if (InputLatencyMonitor *monitor = input() ? input()->latencyMonitor() : nullptr) {
+        monitor->reset();
+    }
+}
+
+QVariantMap DBusInterface::textureMemory()
+{
+    QVariantMap result;
+    for (int i = 0; i < GLTextureMemory::CategoryCount; ++i) {
+        const auto category = GLTextureMemory::Category(i);
+        result.insert(GLTextureMemory::categoryName(category), GLTextureMemory::usage(category));
+    }
+    result.insert(QStringLiteral("total"), GLTextureMemory::totalUsage());
+    result.insert(QStringLiteral("budget"), GLTextureMemory::budget());
+    return result;
+}
+
+static qint64 toMicroseconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+QVariantMap DBusInterface::frameTelemetry(int count)
+{
+    QVariantMap result;
+    const QList<Output *> outputs = workspace()->outputs();
+    for (Output *output : outputs) {
+        QVariantList frames;
+        const QList<FrameTelemetry> telemetry = output->renderLoop()->frameTelemetry(count);
+        for (const FrameTelemetry &frame : telemetry) {
+            frames.append(QVariantMap{
+                {QStringLiteral("targetVblank"), toMicroseconds(frame.targetVblank)},
+                {QStringLiteral("compositeStart"), toMicroseconds(frame.compositeStart)},
+                {QStringLiteral("renderEnd"), toMicroseconds(frame.renderEnd)},
+                {QStringLiteral("commit"), toMicroseconds(frame.commit)},
+                {QStringLiteral("flip"), toMicroseconds(frame.flip)},
+                {QStringLiteral("renderTime"), toMicroseconds(frame.renderTime)},
+                {QStringLiteral("discarded"), frame.discarded},
+            });
+        }
+        result.insert(output->name(), frames);
+    }
+    return result;
+}
+
 void DBusInterface::showDesktop(bool show)
 {
     workspace()->setShowingDesktop(show, true);
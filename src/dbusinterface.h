@@ -88,6 +88,32 @@ public Q_SLOTS: // METHODS
      */
     QVariantMap getWindowInfo(const QString &uuid);
 
+    /**
+     * Returns the latency between input events and their presentation on the screen.
+     *
+     * The map is keyed by output name. Every output has histogram summaries, in microseconds,
+     * of the time from the input event to the surface commit (eventToCommit), from the commit
+     * to the page flip (commitToPresent) and of the total (eventToPresent).
+     */
+    QVariantMap inputLatency();
+    Q_NOREPLY void resetInputLatency();
+
+    /**
+     * Returns the bytes allocated for textures by the compositor, per category, together with
+     * the total and the texture memory budget (0 if there is none).
+     */
+    QVariantMap textureMemory();
+
+    /**
+     * Returns the timing of up to @a count most recent frames of every output, keyed by output
+     * name. Every frame has the targeted vblank (targetVblank), when compositing started
+     * (compositeStart) and ended (renderEnd), when the frame was committed (commit) and
+     * flipped (flip) as monotonic timestamps, and its render time (renderTime), all in
+     * microseconds. A zero means the frame hasn't reached that stage or the backend doesn't
+     * report it.
+     */
+    QVariantMap frameTelemetry(int count);
+
     Q_NOREPLY void showDesktop(bool show);
 
 Q_SIGNALS:
@@ -9,13 +9,22 @@
 #include "debug_console.h"
 #include "composite.h"
 #include "core/inputdevice.h"
+#include "core/output.h"
+#include "core/renderloop.h"
+#include "effects.h"
 #include "input_event.h"
+#include "inputlatencymonitor.h"
+#include "inputmethod.h"
 #include "internalwindow.h"
 #include "keyboard_input.h"
+#include "libkwineffects/gltexturememory.h"
 #include "libkwineffects/kwinglplatform.h"
 #include "libkwineffects/kwinglutils.h"
 #include "main.h"
 #include "platformsupport/scenes/opengl/openglbackend.h"
+#include "scene/surfaceitem.h"
+#include "scene/windowitem.h"
+#include "utils/common.h"
 #include "utils/filedescriptor.h"
 #include "utils/subsurfacemonitor.h"
 #include "wayland/abstract_data_source.h"
@@ -40,6 +49,8 @@
 // frameworks
 #include <KLocalizedString>
 #include <NETWM>
+#include <QFile>
+#include <QFileDialog>
 // Qt
 #include <QFutureWatcher>
 #include <QMetaProperty>
@@ -47,6 +58,8 @@
 #include <QMouseEvent>
 #include <QScopeGuard>
 #include <QSortFilterProxyModel>
+#include <QTextStream>
+#include <QTimer>
 #include <QtConcurrentRun>
 
 #include <wayland-server-core.h>
@@ -590,6 +603,10 @@ static QString sourceString(const KWaylandServer::AbstractDataSource *const sour
 DebugConsole::DebugConsole()
     : QWidget()
     , m_ui(new Ui::DebugConsole)
+    , m_latencyTimer(new QTimer(this))
+    , m_textureMemoryTimer(new QTimer(this))
+    , m_effectsTimer(new QTimer(this))
+    , m_performanceTimer(new QTimer(this))
 {
     setAttribute(Qt::WA_ShowWithoutActivating);
     m_ui->setupUi(this);
@@ -615,10 +632,35 @@ DebugConsole::DebugConsole()
         m_ui->tabWidget->setTabEnabled(1, false);
         m_ui->tabWidget->setTabEnabled(2, false);
         m_ui->tabWidget->setTabEnabled(6, false);
+        m_ui->tabWidget->setTabEnabled(7, false);
         setWindowFlags(Qt::X11BypassWindowManagerHint);
     }
 
     connect(m_ui->quitButton, &QAbstractButton::clicked, this, &DebugConsole::deleteLater);
+    m_latencyTimer->setInterval(1000);
+    connect(m_latencyTimer, &QTimer::timeout, this, &DebugConsole::updateLatencyTab);
+    connect(m_ui->latencyResetButton, &QAbstractButton::clicked, this, [this]() {
+        input()->latencyMonitor()->reset();
+        updateLatencyTab();
+    });
+    m_textureMemoryTimer->setInterval(1000);
+    connect(m_textureMemoryTimer, &QTimer::timeout, this, &DebugConsole::updateTextureMemoryTab);
+    if (effects) {
+        m_ui->effectsProfileButton->setChecked(static_cast<EffectsHandlerImpl *>(effects)->isProfilingEnabled());
+        connect(m_ui->effectsProfileButton, &QAbstractButton::toggled, this, [this](bool checked) {
+            if (effects) {
+                static_cast<EffectsHandlerImpl *>(effects)->setProfilingEnabled(checked);
+                updateEffectsTab();
+            }
+        });
+    } else {
+        m_ui->tabWidget->setTabEnabled(9, false);
+    }
+    m_effectsTimer->setInterval(1000);
+    connect(m_effectsTimer, &QTimer::timeout, this, &DebugConsole::updateEffectsTab);
+    m_performanceTimer->setInterval(1000);
+    connect(m_performanceTimer, &QTimer::timeout, this, &DebugConsole::updatePerformanceTab);
+    connect(m_ui->performanceExportButton, &QAbstractButton::clicked, this, &DebugConsole::exportPerformanceData);
     connect(m_ui->tabWidget, &QTabWidget::currentChanged, this, [this](int index) {
         // delay creation of input event filter until the tab is selected
         if (index == 2 && !m_inputFilter) {
@@ -643,6 +685,43 @@ DebugConsole::DebugConsole()
                 m_ui->primarySource->setText(sourceString(source));
             });
         }
+        if (index == 7) {
+            updateLatencyTab();
+            m_latencyTimer->start();
+        } else {
+            m_latencyTimer->stop();
+        }
+        if (index == 8) {
+            updateTextureMemoryTab();
+            m_textureMemoryTimer->start();
+        } else {
+            m_textureMemoryTimer->stop();
+        }
+        if (index == 9) {
+            updateEffectsTab();
+            m_effectsTimer->start();
+        } else {
+            m_effectsTimer->stop();
+        }
+        if (index == 10) {
+            // the windows are watched only while the tab is shown, it can be expensive
+            if (m_windowActivity.isEmpty()) {
+                const auto windows = workspace()->windows();
+                for (Window *window : windows) {
+                    trackWindowActivity(window);
+                }
+                connect(workspace(), &Workspace::windowAdded, this, &DebugConsole::trackWindowActivity);
+                connect(workspace(), &Workspace::windowRemoved, this, [this](Window *window) {
+                    disconnect(window, &Window::damaged, this, nullptr);
+                    m_windowActivity.remove(window);
+                });
+            }
+            m_windowActivitySince = std::chrono::steady_clock::now();
+            m_performanceTimer->start();
+            updatePerformanceTab();
+        } else {
+            m_performanceTimer->stop();
+        }
     });
 
     initGLTab();
@@ -683,6 +762,275 @@ void DebugConsole::initGLTab()
     m_ui->openGLExtensionsLabel->setText(extensionsString(openGLExtensions()));
 }
 
+void DebugConsole::updateLatencyTab()
+{
+    const InputLatencyMonitor *monitor = input()->latencyMonitor();
+    const InputMethod *inputMethod = kwinApp()->inputMethod();
+    if (!monitor && !inputMethod) {
+        return;
+    }
+    auto histogramRows = [](const QString &title, const QVariantMap &histogram) {
+        const auto milliseconds = [&histogram](const QString &key) {
+            return QString::number(histogram.value(key).toLongLong() / 1000.0, 'f', 1);
+        };
+        QString text = tableHeaderRow(title);
+        text.append(tableRow(i18n("Samples"), histogram.value(QStringLiteral("count")).toUInt()));
+        text.append(tableRow(i18n("Mean (ms)"), milliseconds(QStringLiteral("mean"))));
+        text.append(tableRow(i18n("50th percentile (ms)"), milliseconds(QStringLiteral("p50"))));
+        text.append(tableRow(i18n("90th percentile (ms)"), milliseconds(QStringLiteral("p90"))));
+        text.append(tableRow(i18n("99th percentile (ms)"), milliseconds(QStringLiteral("p99"))));
+        text.append(tableRow(i18n("Maximum (ms)"), milliseconds(QStringLiteral("max"))));
+        return text;
+    };
+
+    QString text;
+    const QVariantMap statistics = monitor ? monitor->statistics() : QVariantMap();
+    for (auto it = statistics.constBegin(); it != statistics.constEnd(); ++it) {
+        const QVariantMap output = it.value().toMap();
+        text.append(QStringLiteral("<h2>%1</h2><table>").arg(it.key()));
+        text.append(histogramRows(i18n("Input event to surface commit"), output.value(QStringLiteral("eventToCommit")).toMap()));
+        text.append(histogramRows(i18n("Surface commit to presentation"), output.value(QStringLiteral("commitToPresent")).toMap()));
+        text.append(histogramRows(i18n("Input event to presentation"), output.value(QStringLiteral("eventToPresent")).toMap()));
+        text.append(QStringLiteral("</table>"));
+    }
+    if (inputMethod && inputMethod->keyLatency().count()) {
+        text.append(QStringLiteral("<h2>%1</h2><table>").arg(i18n("Input method")));
+        text.append(histogramRows(i18n("Key press to input method response"), inputMethod->keyLatency().toVariantMap()));
+        text.append(QStringLiteral("</table>"));
+    }
+    m_ui->latencyTextEdit->setHtml(text);
+}
+
+void DebugConsole::updateTextureMemoryTab()
+{
+    const auto mebibytes = [](qint64 bytes) {
+        return QString::number(bytes / (1024.0 * 1024.0), 'f', 1);
+    };
+
+    QString text = QStringLiteral("<table>");
+    text.append(tableHeaderRow(i18n("Allocated texture memory (MiB)")));
+    for (int i = 0; i < GLTextureMemory::CategoryCount; ++i) {
+        const auto category = GLTextureMemory::Category(i);
+        text.append(tableRow(GLTextureMemory::categoryName(category), mebibytes(GLTextureMemory::usage(category))));
+    }
+    text.append(tableRow(i18n("Total"), mebibytes(GLTextureMemory::totalUsage())));
+    const qint64 budget = GLTextureMemory::budget();
+    text.append(tableRow(i18n("Budget"), budget > 0 ? mebibytes(budget) : i18n("None")));
+    text.append(QStringLiteral("</table>"));
+    m_ui->textureMemoryTextEdit->setHtml(text);
+}
+
+void DebugConsole::updateEffectsTab()
+{
+    if (!effects) {
+        return;
+    }
+    const auto microseconds = [](const QVariant &value) {
+        return value.isValid() ? QString::number(value.toLongLong()) : i18n("n/a");
+    };
+
+    QString text = QStringLiteral("<table>");
+    const QVariantList statistics = static_cast<EffectsHandlerImpl *>(effects)->effectStatistics();
+    for (const QVariant &value : statistics) {
+        const QVariantMap effect = value.toMap();
+        text.append(tableHeaderRow(effect.value(QStringLiteral("name")).toString()));
+        if (effect.contains(QStringLiteral("frames"))) {
+            text.append(tableRow(i18n("Frames"), effect.value(QStringLiteral("frames")).toInt()));
+            text.append(tableRow(i18n("Pre-paint time per frame (µs)"), microseconds(effect.value(QStringLiteral("prePaintTime")))));
+            text.append(tableRow(i18n("Paint time per frame (µs)"), microseconds(effect.value(QStringLiteral("paintTime")))));
+            text.append(tableRow(i18n("Post-paint time per frame (µs)"), microseconds(effect.value(QStringLiteral("postPaintTime")))));
+            text.append(tableRow(i18n("GPU time per frame (µs)"), microseconds(effect.value(QStringLiteral("gpuTime")))));
+        }
+        const qint64 textureMemory = effect.value(QStringLiteral("textureMemory")).toLongLong();
+        text.append(tableRow(i18n("Texture memory (MiB)"), QString::number(textureMemory / (1024.0 * 1024.0), 'f', 1)));
+    }
+    text.append(QStringLiteral("</table>"));
+    m_ui->effectsTextEdit->setHtml(text);
+}
+
+void DebugConsole::trackWindowActivity(Window *window)
+{
+    m_windowActivity.insert(window, WindowActivity{});
+    connect(window, &Window::damaged, this, [this, window](Window *, const QRegion &region) {
+        if (!m_performanceTimer->isActive()) {
+            return;
+        }
+        WindowActivity &activity = m_windowActivity[window];
+        activity.updates++;
+        for (const QRect &rect : region) {
+            activity.damagedPixels += qint64(rect.width()) * rect.height();
+        }
+    });
+}
+
+/**
+ * Returns how much memory the buffers of the surfaces in the subtree of @a item take. Those
+ * are either imported as textures or uploaded to textures of the same size.
+ */
+static qint64 surfaceBufferMemory(const Item *item)
+{
+    qint64 bytes = 0;
+    if (auto surfaceItem = qobject_cast<const SurfaceItem *>(item)) {
+        if (const SurfacePixmap *pixmap = surfaceItem->pixmap()) {
+            const QSize size = pixmap->size();
+            bytes += qint64(size.width()) * size.height() * (pixmap->colorDepth() > 10 ? 8 : 4);
+        }
+    }
+    for (const Item *childItem : item->childItems()) {
+        bytes += surfaceBufferMemory(childItem);
+    }
+    return bytes;
+}
+
+void DebugConsole::updatePerformanceTab()
+{
+    using namespace std::chrono_literals;
+    const auto milliseconds = [](std::chrono::nanoseconds duration) {
+        return QString::number(duration.count() / 1000000.0, 'f', 2);
+    };
+    const auto mebibytes = [](qint64 bytes) {
+        return QString::number(bytes / (1024.0 * 1024.0), 'f', 1);
+    };
+
+    QList<QStringList> rows;
+    const auto addRow = [&rows](const QString &section, const QString &subject, const QString &metric, const QString &value) {
+        rows.append(QStringList{section, subject, metric, value});
+    };
+
+    const QString outputsSection = i18n("Outputs");
+    const auto outputs = workspace()->outputs();
+    for (Output *output : outputs) {
+        RenderLoop *renderLoop = output->renderLoop();
+        const QList<FrameTelemetry> frames = renderLoop->frameTelemetry(120);
+        const std::chrono::nanoseconds vblankInterval(renderLoop->refreshRate() > 0 ? 1'000'000'000'000 / renderLoop->refreshRate() : 0);
+
+        int presented = 0;
+        int missed = 0;
+        std::chrono::nanoseconds totalRenderTime = 0ns;
+        std::chrono::nanoseconds maxRenderTime = 0ns;
+        std::chrono::nanoseconds totalLatency = 0ns;
+        std::chrono::nanoseconds firstFlip = 0ns;
+        std::chrono::nanoseconds lastFlip = 0ns;
+        for (const FrameTelemetry &frame : frames) {
+            if (frame.flip == 0ns) {
+                continue;
+            }
+            if (presented == 0) {
+                firstFlip = frame.flip;
+            }
+            lastFlip = frame.flip;
+            presented++;
+            totalRenderTime += frame.renderTime;
+            maxRenderTime = std::max(maxRenderTime, frame.renderTime);
+            if (frame.compositeStart != 0ns) {
+                totalLatency += frame.flip - frame.compositeStart;
+            }
+            if (frame.targetVblank != 0ns && frame.flip > frame.targetVblank + vblankInterval / 2) {
+                missed++;
+            }
+        }
+
+        addRow(outputsSection, output->name(), i18n("Frames"), QString::number(presented));
+        if (presented == 0) {
+            continue;
+        }
+        const double framesPerSecond = presented > 1 ? (presented - 1) / std::chrono::duration<double>(lastFlip - firstFlip).count() : 0;
+        addRow(outputsSection, output->name(), i18n("Frames per second"), QString::number(framesPerSecond, 'f', 1));
+        addRow(outputsSection, output->name(), i18n("Mean render time (ms)"), milliseconds(totalRenderTime / presented));
+        addRow(outputsSection, output->name(), i18n("Maximum render time (ms)"), milliseconds(maxRenderTime));
+        addRow(outputsSection, output->name(), i18n("Mean composite start to flip (ms)"), milliseconds(totalLatency / presented));
+        addRow(outputsSection, output->name(), i18n("Missed vblanks"), QString::number(missed));
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::max(std::chrono::duration<double>(now - m_windowActivitySince).count(), 0.001);
+    m_windowActivitySince = now;
+
+    const QString windowsSection = i18n("Windows");
+    for (auto it = m_windowActivity.begin(); it != m_windowActivity.end(); ++it) {
+        Window *window = it.key();
+        WindowActivity &activity = it.value();
+        const QString subject = window->caption().isEmpty() ? window->resourceClass() : window->caption();
+        addRow(windowsSection, subject, i18n("Updates per second"), QString::number(activity.updates / seconds, 'f', 1));
+        addRow(windowsSection, subject, i18n("Damaged area (megapixels per second)"), QString::number(activity.damagedPixels / seconds / 1000000.0, 'f', 2));
+        if (const WindowItem *windowItem = window->windowItem()) {
+            addRow(windowsSection, subject, i18n("Buffer memory (MiB)"), mebibytes(surfaceBufferMemory(windowItem)));
+        }
+        activity = WindowActivity{};
+    }
+
+    if (effects) {
+        const QString effectsSection = i18n("Effects");
+        const QVariantList statistics = static_cast<EffectsHandlerImpl *>(effects)->effectStatistics();
+        for (const QVariant &value : statistics) {
+            const QVariantMap effect = value.toMap();
+            const QString subject = effect.value(QStringLiteral("name")).toString();
+            if (effect.contains(QStringLiteral("frames"))) {
+                const qint64 cpuTime = effect.value(QStringLiteral("prePaintTime")).toLongLong()
+                    + effect.value(QStringLiteral("paintTime")).toLongLong()
+                    + effect.value(QStringLiteral("postPaintTime")).toLongLong();
+                addRow(effectsSection, subject, i18n("CPU time per frame (µs)"), QString::number(cpuTime));
+                const QVariant gpuTime = effect.value(QStringLiteral("gpuTime"));
+                addRow(effectsSection, subject, i18n("GPU time per frame (µs)"), gpuTime.isValid() ? QString::number(gpuTime.toLongLong()) : i18n("n/a"));
+            }
+            addRow(effectsSection, subject, i18n("Texture memory (MiB)"), mebibytes(effect.value(QStringLiteral("textureMemory")).toLongLong()));
+        }
+    }
+
+    QString text;
+    QString section;
+    QString subject;
+    for (const QStringList &row : std::as_const(rows)) {
+        if (row[0] != section) {
+            if (!section.isEmpty()) {
+                text.append(QStringLiteral("</table>"));
+            }
+            section = row[0];
+            subject.clear();
+            text.append(QStringLiteral("<h2>%1</h2><table>").arg(section));
+        }
+        if (row[1] != subject) {
+            subject = row[1];
+            text.append(tableHeaderRow(subject.toHtmlEscaped()));
+        }
+        text.append(tableRow(row[2], row[3]));
+    }
+    if (!section.isEmpty()) {
+        text.append(QStringLiteral("</table>"));
+    }
+    m_ui->performanceTextEdit->setHtml(text);
+    m_performanceRows = rows;
+}
+
+void DebugConsole::exportPerformanceData()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, i18n("Export Performance Data"), QString(), i18n("CSV files (*.csv)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qCWarning(KWIN_CORE) << "Failed to open" << fileName << ":" << file.errorString();
+        return;
+    }
+    const auto field = [](QString value) {
+        if (value.contains(QLatin1Char(',')) || value.contains(QLatin1Char('"')) || value.contains(QLatin1Char('\n'))) {
+            value.replace(QLatin1Char('"'), QLatin1String("\"\""));
+            value = QLatin1Char('"') + value + QLatin1Char('"');
+        }
+        return value;
+    };
+    QTextStream stream(&file);
+    stream << "section,subject,metric,value\n";
+    for (const QStringList &row : std::as_const(m_performanceRows)) {
+        QStringList fields;
+        for (const QString &value : row) {
+            fields.append(field(value));
+        }
+        stream << fields.join(QLatin1Char(',')) << '\n';
+    }
+}
+
 template<typename T>
 QString keymapComponentToString(xkb_keymap *map, const T &count, std::function<const char *(xkb_keymap *, T)> f)
 {
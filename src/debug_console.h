@@ -14,12 +14,15 @@
 #include <kwin_export.h>
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QStyledItemDelegate>
 #include <QVector>
+#include <chrono>
 #include <functional>
 #include <memory>
 
 class QTextEdit;
+class QTimer;
 
 namespace KWaylandServer
 {
@@ -106,9 +109,29 @@ protected:
 private:
     void initGLTab();
     void updateKeyboardTab();
+    void updateLatencyTab();
+    void updateTextureMemoryTab();
+    void updateEffectsTab();
+    void updatePerformanceTab();
+    void trackWindowActivity(Window *window);
+    void exportPerformanceData();
+
+    struct WindowActivity
+    {
+        int updates = 0;
+        qint64 damagedPixels = 0;
+    };
 
     std::unique_ptr<Ui::DebugConsole> m_ui;
     std::unique_ptr<DebugConsoleFilter> m_inputFilter;
+    QTimer *m_latencyTimer;
+    QTimer *m_textureMemoryTimer;
+    QTimer *m_effectsTimer;
+    QTimer *m_performanceTimer;
+    QHash<Window *, WindowActivity> m_windowActivity;
+    std::chrono::steady_clock::time_point m_windowActivitySince;
+    // the section, the subject, the metric and the value of every row in the performance tab
+    QList<QStringList> m_performanceRows;
 };
 
 class SurfaceTreeModel : public QAbstractItemModel
@@ -11,6 +11,7 @@
 // config
 #include <config-kwin.h>
 // KWin
+#include "ftrace.h"
 #include "libkwineffects/kwineffects.h"
 #include "plugin.h"
 #include "scripting/scriptedeffect.h"
@@ -64,6 +65,15 @@ LoadEffectFlags AbstractEffectLoader::readConfig(const QString &effectName, bool
     return LoadEffectFlags();
 }
 
+bool AbstractEffectLoader::isLoadedEffectEnabled(const QString &name) const
+{
+    const auto it = m_enabledByDefault.constFind(name);
+    if (it == m_enabledByDefault.constEnd()) {
+        return true;
+    }
+    return readConfig(name, *it).testFlag(LoadEffectFlag::Load);
+}
+
 static const QString s_nameProperty = QStringLiteral("X-KDE-PluginInfo-Name");
 static const QString s_jsConstraint = QStringLiteral("[X-Plasma-API] == 'javascript'");
 static const QString s_serviceType = QStringLiteral("KWin/Effect");
@@ -128,6 +138,7 @@ bool ScriptedEffectLoader::loadEffect(const KPluginMetaData &effect, LoadEffectF
         return false;
     }
 
+    fTraceDuration("Load effect ", name);
     ScriptedEffect *e = ScriptedEffect::create(effect);
     if (!e) {
         qCDebug(KWIN_CORE) << "Could not initialize scripted effect: " << name;
@@ -138,6 +149,7 @@ bool ScriptedEffectLoader::loadEffect(const KPluginMetaData &effect, LoadEffectF
     });
 
     qCDebug(KWIN_CORE) << "Successfully loaded scripted effect: " << name;
+    m_enabledByDefault[name] = effect.isEnabledByDefault();
     Q_EMIT effectLoaded(e, name);
     m_loadedEffects << name;
     return true;
@@ -193,6 +205,7 @@ void ScriptedEffectLoader::clear()
 PluginEffectLoader::PluginEffectLoader(QObject *parent)
     : AbstractEffectLoader(parent)
     , m_pluginSubDirectory(QStringLiteral("kwin/effects/plugins"))
+    , m_queue(new EffectLoadQueue<PluginEffectLoader, KPluginMetaData>(this))
 {
 }
 
@@ -293,6 +306,7 @@ bool PluginEffectLoader::loadEffect(const KPluginMetaData &info, LoadEffectFlags
         return false;
     }
 
+    fTraceDuration("Load effect ", name);
     effects->makeOpenGLContextCurrent();
     if (!effectFactory->isSupported()) {
         qCDebug(KWIN_CORE) << "Effect is not supported: " << name;
@@ -314,6 +328,7 @@ bool PluginEffectLoader::loadEffect(const KPluginMetaData &info, LoadEffectFlags
     }
     // insert in our loaded effects
     m_loadedEffects << name;
+    m_enabledByDefault[name] = info.isEnabledByDefault();
     connect(e, &Effect::destroyed, this, [this, name]() {
         m_loadedEffects.removeAll(name);
     });
@@ -324,11 +339,13 @@ bool PluginEffectLoader::loadEffect(const KPluginMetaData &info, LoadEffectFlags
 
 void PluginEffectLoader::queryAndLoadAll()
 {
+    // The effects are created one at a time from the event loop, so the compositor can present
+    // frames in between, rather than only after all effects have been created
     const auto effects = findAllEffects();
     for (const auto &effect : effects) {
         const LoadEffectFlags flags = readConfig(effect.pluginId(), effect.isEnabledByDefault());
         if (flags.testFlag(LoadEffectFlag::Load)) {
-            loadEffect(effect, flags);
+            m_queue->enqueue(qMakePair(effect, flags));
         }
     }
 }
@@ -345,6 +362,7 @@ void PluginEffectLoader::setPluginSubDirectory(const QString &directory)
 
 void PluginEffectLoader::clear()
 {
+    m_queue->clear();
 }
 
 EffectLoader::EffectLoader(QObject *parent)
@@ -409,6 +427,13 @@ void EffectLoader::setConfig(KSharedConfig::Ptr config)
     }
 }
 
+bool EffectLoader::isLoadedEffectEnabled(const QString &name) const
+{
+    return std::all_of(m_loaders.cbegin(), m_loaders.cend(), [&name](const auto &loader) {
+        return loader->isLoadedEffectEnabled(name);
+    });
+}
+
 void EffectLoader::clear()
 {
     for (auto it = m_loaders.constBegin(); it != m_loaders.constEnd(); ++it) {
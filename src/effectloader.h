@@ -13,6 +13,7 @@
 #include <KSharedConfig>
 // Qt
 #include <QFlags>
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QPair>
@@ -156,6 +157,16 @@ public:
      */
     virtual void clear() = 0;
 
+    /**
+     * @brief Whether the configuration still asks for the Effect @p name to be loaded.
+     *
+     * This is meant to find the loaded Effects that have been disabled since they were loaded.
+     * The loader returns @c true for Effects it hasn't loaded.
+     *
+     * @param name The internal name of the loaded Effect
+     */
+    virtual bool isLoadedEffectEnabled(const QString &name) const;
+
 Q_SIGNALS:
     /**
      * @brief The loader emits this signal when it successfully loaded an effect.
@@ -182,6 +193,11 @@ protected:
      */
     LoadEffectFlags readConfig(const QString &effectName, bool defaultValue) const;
 
+    /**
+     * Whether the loaded Effects are enabled by default, used by isLoadedEffectEnabled().
+     */
+    QHash<QString, bool> m_enabledByDefault;
+
 private:
     KSharedConfig::Ptr m_config;
 };
@@ -319,6 +335,7 @@ private:
     EffectPluginFactory *factory(const KPluginMetaData &info) const;
     QStringList m_loadedEffects;
     QString m_pluginSubDirectory;
+    EffectLoadQueue<PluginEffectLoader, KPluginMetaData> *m_queue;
 };
 
 class KWIN_EXPORT EffectLoader : public AbstractEffectLoader
@@ -334,6 +351,7 @@ public:
     void queryAndLoadAll() override;
     void setConfig(KSharedConfig::Ptr config) override;
     void clear() override;
+    bool isLoadedEffectEnabled(const QString &name) const override;
 
 private:
     QList<AbstractEffectLoader *> m_loaders;
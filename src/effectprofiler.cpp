@@ -0,0 +1,189 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "effectprofiler.h"
+#include "libkwineffects/glrendertimequery.h"
+#include "libkwineffects/gltexturememory.h"
+
+namespace KWin
+{
+
+// the results of the timer queries are dropped if they're not available for that long
+static constexpr size_t s_maxPendingGpuSamples = 4096;
+
+EffectProfiler::EffectProfiler(bool openGL)
+    : m_timerQueries(openGL && GLRenderTimeQuery::isSupported())
+{
+}
+
+EffectProfiler::~EffectProfiler()
+{
+    for (const GpuSample &sample : m_gpuSamples) {
+        m_freeQueries.push_back(sample.query);
+    }
+    if (!m_freeQueries.empty()) {
+        glDeleteQueries(m_freeQueries.size(), m_freeQueries.data());
+    }
+}
+
+void EffectProfiler::startPaint()
+{
+    ++m_frame;
+    if (m_timerQueries) {
+        resolveGpuSamples();
+    }
+}
+
+void EffectProfiler::enter(Effect *effect, Phase phase)
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (!m_stack.empty()) {
+        charge(m_stack.back(), now);
+    }
+    m_stack.push_back(Frame{effect, phase, now});
+
+    // the scene is entered with a null effect, it isn't accounted
+    if (effect) {
+        Statistics &statistics = m_statistics[effect];
+        if (statistics.lastFrame != m_frame) {
+            statistics.lastFrame = m_frame;
+            ++statistics.frames;
+        }
+    }
+
+    if (phase == Phase::Paint) {
+        recordGpuTimestamp(effect);
+    }
+}
+
+void EffectProfiler::leave()
+{
+    Q_ASSERT(!m_stack.empty());
+    const auto now = std::chrono::steady_clock::now();
+    const Frame frame = m_stack.back();
+    m_stack.pop_back();
+    charge(frame, now);
+
+    if (!m_stack.empty()) {
+        m_stack.back().since = now;
+    }
+    if (frame.phase == Phase::Paint) {
+        // the commands that follow belong to the effect that called this one, if any
+        const bool nested = !m_stack.empty() && m_stack.back().phase == Phase::Paint;
+        recordGpuTimestamp(nested ? m_stack.back().effect : nullptr);
+    }
+}
+
+void EffectProfiler::charge(const Frame &frame, std::chrono::steady_clock::time_point now)
+{
+    auto it = m_statistics.find(frame.effect);
+    if (it != m_statistics.end()) {
+        it->cpuTime[int(frame.phase)] += now - frame.since;
+    }
+}
+
+void EffectProfiler::remove(Effect *effect)
+{
+    m_statistics.remove(effect);
+    for (GpuSample &sample : m_gpuSamples) {
+        if (sample.effect == effect) {
+            sample.effect = nullptr;
+        }
+    }
+}
+
+void EffectProfiler::addStatistics(Effect *effect, QVariantMap &map) const
+{
+    const auto it = m_statistics.constFind(effect);
+    if (it == m_statistics.constEnd() || !it->frames) {
+        return;
+    }
+    const auto microsecondsPerFrame = [frames = it->frames](std::chrono::nanoseconds time) {
+        return std::chrono::duration<double, std::micro>(time).count() / frames;
+    };
+    map[QStringLiteral("frames")] = it->frames;
+    map[QStringLiteral("prePaintTime")] = microsecondsPerFrame(it->cpuTime[int(Phase::PrePaint)]);
+    map[QStringLiteral("paintTime")] = microsecondsPerFrame(it->cpuTime[int(Phase::Paint)]);
+    map[QStringLiteral("postPaintTime")] = microsecondsPerFrame(it->cpuTime[int(Phase::PostPaint)]);
+    if (m_timerQueries) {
+        map[QStringLiteral("gpuTime")] = microsecondsPerFrame(it->gpuTime);
+    }
+}
+
+GLuint EffectProfiler::allocateQuery()
+{
+    if (m_freeQueries.empty()) {
+        m_freeQueries.resize(64);
+        glGenQueries(m_freeQueries.size(), m_freeQueries.data());
+    }
+    const GLuint query = m_freeQueries.back();
+    m_freeQueries.pop_back();
+    return query;
+}
+
+void EffectProfiler::recordGpuTimestamp(Effect *effect)
+{
+    if (!m_timerQueries) {
+        return;
+    }
+    const GLuint query = allocateQuery();
+    glQueryCounter(query, GL_TIMESTAMP);
+    m_gpuSamples.push_back(GpuSample{query, effect});
+}
+
+void EffectProfiler::resolveGpuSamples()
+{
+    if (m_gpuSamples.empty()) {
+        return;
+    }
+
+    // the queries complete in order, so the last one being available means all of them are
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(m_gpuSamples.back().query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available) {
+        GLint64 previous = 0;
+        for (size_t i = 0; i < m_gpuSamples.size(); ++i) {
+            GLint64 timestamp = 0;
+            glGetQueryObjecti64v(m_gpuSamples[i].query, GL_QUERY_RESULT, &timestamp);
+            if (i > 0 && m_gpuSamples[i - 1].effect && timestamp > previous) {
+                auto it = m_statistics.find(m_gpuSamples[i - 1].effect);
+                if (it != m_statistics.end()) {
+                    it->gpuTime += std::chrono::nanoseconds(timestamp - previous);
+                }
+            }
+            previous = timestamp;
+        }
+    } else if (m_gpuSamples.size() < s_maxPendingGpuSamples) {
+        return;
+    }
+
+    for (const GpuSample &sample : m_gpuSamples) {
+        m_freeQueries.push_back(sample.query);
+    }
+    m_gpuSamples.clear();
+}
+
+EffectProfiler::Scope::Scope(EffectProfiler *profiler, Effect *effect, Phase phase)
+    : m_profiler(profiler)
+    , m_previousOwner(GLTextureMemory::setOwner(effect))
+{
+    if (m_profiler) {
+        m_profiler->enter(effect, phase);
+    }
+}
+
+EffectProfiler::Scope::~Scope()
+{
+    if (m_profiler) {
+        m_profiler->leave();
+    }
+    GLTextureMemory::setOwner(m_previousOwner);
+}
+
+} // namespace KWin
@@ -0,0 +1,115 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QVariantMap>
+
+#include <epoxy/gl.h>
+
+#include <chrono>
+#include <vector>
+
+namespace KWin
+{
+
+class Effect;
+
+/**
+ * The EffectProfiler class measures how much time the effects spend in their paint hooks.
+ *
+ * Since the hooks of the effects are chained, the time an effect spends in the hooks of the
+ * effects after it is not accounted to it. If timer queries are supported, the time the GPU
+ * spends on the commands an effect issues in its paint hooks is measured as well, the results
+ * are read back one frame later so the profiler doesn't stall the pipeline.
+ *
+ * While an effect's hook runs, the textures it creates are accounted to it in GLTextureMemory.
+ */
+class EffectProfiler
+{
+public:
+    enum class Phase {
+        PrePaint,
+        Paint,
+        PostPaint,
+    };
+
+    explicit EffectProfiler(bool openGL);
+    ~EffectProfiler();
+
+    /**
+     * Starts measuring a new frame.
+     */
+    void startPaint();
+
+    void enter(Effect *effect, Phase phase);
+    void leave();
+
+    /**
+     * Forgets the statistics of the given @a effect, e.g. because it's being unloaded.
+     */
+    void remove(Effect *effect);
+
+    /**
+     * Adds the statistics of the given @a effect to @a map: the number of frames it was active
+     * in, and the average time it spent in each phase per frame, in microseconds.
+     */
+    void addStatistics(Effect *effect, QVariantMap &map) const;
+
+    /**
+     * The Scope class wraps a call into one of the hooks of an effect. The textures created
+     * meanwhile are accounted to the effect, and the call is measured if there is a profiler.
+     */
+    class Scope
+    {
+    public:
+        Scope(EffectProfiler *profiler, Effect *effect, Phase phase);
+        ~Scope();
+
+    private:
+        EffectProfiler *m_profiler;
+        const void *m_previousOwner;
+    };
+
+private:
+    struct Statistics
+    {
+        int frames = 0;
+        int lastFrame = -1;
+        std::chrono::nanoseconds cpuTime[3] = {};
+        std::chrono::nanoseconds gpuTime = std::chrono::nanoseconds::zero();
+    };
+    struct Frame
+    {
+        Effect *effect;
+        Phase phase;
+        std::chrono::steady_clock::time_point since;
+    };
+    struct GpuSample
+    {
+        GLuint query;
+        // the effect whose commands follow the timestamp, or null for the scene
+        Effect *effect;
+    };
+
+    void charge(const Frame &frame, std::chrono::steady_clock::time_point now);
+    void recordGpuTimestamp(Effect *effect);
+    void resolveGpuSamples();
+    GLuint allocateQuery();
+
+    const bool m_timerQueries;
+    int m_frame = 0;
+    QHash<Effect *, Statistics> m_statistics;
+    std::vector<Frame> m_stack;
+    std::vector<GpuSample> m_gpuSamples;
+    std::vector<GLuint> m_freeQueries;
+};
+
+} // namespace KWin
@@ -14,6 +14,7 @@
 
 #include "core/output.h"
 #include "effectloader.h"
+#include "effectprofiler.h"
 #include "effectsadaptor.h"
 #if KWIN_BUILD_ACTIVITIES
 #include "activities.h"
@@ -41,6 +42,7 @@
 #include "decorations/decorationbridge.h"
 #include "inputmethod.h"
 #include "inputpanelv1window.h"
+#include "libkwineffects/gltexturememory.h"
 #include "libkwineffects/kwinglutils.h"
 #include "libkwineffects/rendertarget.h"
 #include "libkwineffects/renderviewport.h"
@@ -119,6 +121,11 @@ static xcb_atom_t registerSupportProperty(const QByteArray &propertyName)
 
 //---------------------
 
+static QMap<QString, QString> effectSettings(const QString &name)
+{
+    return kwinApp()->config()->group(QLatin1String("Effect-") + name).entryMap();
+}
+
 EffectsHandlerImpl::EffectsHandlerImpl(Compositor *compositor, WorkspaceScene *scene)
     : EffectsHandler(Compositor::self()->backend()->compositingType())
     , keyboard_grab_effect(nullptr)
@@ -133,6 +140,7 @@ EffectsHandlerImpl::EffectsHandlerImpl(Compositor *compositor, WorkspaceScene *s
     connect(m_effectLoader, &AbstractEffectLoader::effectLoaded, this, [this](Effect *effect, const QString &name) {
         effect_order.insert(effect->requestedEffectChainPosition(), EffectPair(name, effect));
         loaded_effects << EffectPair(name, effect);
+        m_effectSettings[name] = effectSettings(name);
         effectsChanged();
     });
     m_effectLoader->setConfig(kwinApp()->config());
@@ -169,6 +177,7 @@ EffectsHandlerImpl::EffectsHandlerImpl(Compositor *compositor, WorkspaceScene *s
     });
     connect(ws, &Workspace::deletedRemoved, this, [this](KWin::Window *d) {
         Q_EMIT windowDeleted(d->effectWindow());
+        m_enabledWindowEffects.remove(d->effectWindow());
     });
     connect(ws->sessionManager(), &SessionManager::stateChanged, this, &KWin::EffectsHandler::sessionStateChanged);
     connect(vds, &VirtualDesktopManager::countChanged, this, &EffectsHandler::numberDesktopsChanged);
@@ -251,6 +260,8 @@ EffectsHandlerImpl::EffectsHandlerImpl(Compositor *compositor, WorkspaceScene *s
 EffectsHandlerImpl::~EffectsHandlerImpl()
 {
     unloadAllEffects();
+    // unloading the effects has made the context current, the profiler deletes its queries
+    m_profiler.reset();
 }
 
 void EffectsHandlerImpl::unloadAllEffects()
@@ -352,6 +363,27 @@ void EffectsHandlerImpl::setupWindowConnections(Window *window)
 
 void EffectsHandlerImpl::reconfigure()
 {
+    // The effects that have been disabled are unloaded and the effects whose settings have
+    // changed are reconfigured, then the effects that have been enabled are loaded.
+    const QStringList names = loadedEffects();
+    for (const QString &name : names) {
+        if (!m_effectLoader->isLoadedEffectEnabled(name)) {
+            unloadEffect(name);
+            continue;
+        }
+        QMap<QString, QString> settings = effectSettings(name);
+        QMap<QString, QString> &previousSettings = m_effectSettings[name];
+        if (previousSettings != settings) {
+            previousSettings = std::move(settings);
+            const auto it = std::find_if(loaded_effects.constBegin(), loaded_effects.constEnd(), [&name](const EffectPair &pair) {
+                return pair.first == name;
+            });
+            if (it != loaded_effects.constEnd()) {
+                makeOpenGLContextCurrent();
+                it->second->reconfigure(Effect::ReconfigureAll);
+            }
+        }
+    }
     m_effectLoader->queryAndLoadAll();
 }
 
@@ -359,7 +391,9 @@ void EffectsHandlerImpl::reconfigure()
 void EffectsHandlerImpl::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintScreenIterator++)->prePaintScreen(data, presentTime);
+        Effect *effect = *m_currentPaintScreenIterator++;
+        EffectProfiler::Scope scope(m_profiler.get(), effect, EffectProfiler::Phase::PrePaint);
+        effect->prePaintScreen(data, presentTime);
         --m_currentPaintScreenIterator;
     }
     // no special final code
@@ -368,9 +402,12 @@ void EffectsHandlerImpl::prePaintScreen(ScreenPrePaintData &data, std::chrono::m
 void EffectsHandlerImpl::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, EffectScreen *screen)
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintScreenIterator++)->paintScreen(renderTarget, viewport, mask, region, screen);
+        Effect *effect = *m_currentPaintScreenIterator++;
+        EffectProfiler::Scope scope(m_profiler.get(), effect, EffectProfiler::Phase::Paint);
+        effect->paintScreen(renderTarget, viewport, mask, region, screen);
         --m_currentPaintScreenIterator;
     } else {
+        EffectProfiler::Scope scope(m_profiler.get(), nullptr, EffectProfiler::Phase::Paint);
         m_scene->finalPaintScreen(renderTarget, viewport, mask, region, screen);
     }
 }
@@ -378,7 +415,9 @@ void EffectsHandlerImpl::paintScreen(const RenderTarget &renderTarget, const Ren
 void EffectsHandlerImpl::postPaintScreen()
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintScreenIterator++)->postPaintScreen();
+        Effect *effect = *m_currentPaintScreenIterator++;
+        EffectProfiler::Scope scope(m_profiler.get(), effect, EffectProfiler::Phase::PostPaint);
+        effect->postPaintScreen();
         --m_currentPaintScreenIterator;
     }
     // no special final code
@@ -386,8 +425,17 @@ void EffectsHandlerImpl::postPaintScreen()
 
 void EffectsHandlerImpl::prePaintWindow(EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime)
 {
-    if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintWindowIterator++)->prePaintWindow(w, data, presentTime);
+    if (!m_currentPaintWindowChain) {
+        m_currentPaintWindowChain = &windowEffects(w);
+        m_currentPaintWindowIterator = m_currentPaintWindowChain->constBegin();
+        prePaintWindow(w, data, presentTime);
+        m_currentPaintWindowChain = nullptr;
+        return;
+    }
+    if (m_currentPaintWindowIterator != m_currentPaintWindowChain->constEnd()) {
+        Effect *effect = *m_currentPaintWindowIterator++;
+        EffectProfiler::Scope scope(m_profiler.get(), effect, EffectProfiler::Phase::PrePaint);
+        effect->prePaintWindow(w, data, presentTime);
         --m_currentPaintWindowIterator;
     }
     // no special final code
@@ -395,18 +443,37 @@ void EffectsHandlerImpl::prePaintWindow(EffectWindow *w, WindowPrePaintData &dat
 
 void EffectsHandlerImpl::paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &region, WindowPaintData &data)
 {
-    if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintWindowIterator++)->paintWindow(renderTarget, viewport, w, mask, region, data);
+    if (!m_currentPaintWindowChain) {
+        m_currentPaintWindowChain = &windowEffects(w);
+        m_currentPaintWindowIterator = m_currentPaintWindowChain->constBegin();
+        paintWindow(renderTarget, viewport, w, mask, region, data);
+        m_currentPaintWindowChain = nullptr;
+        return;
+    }
+    if (m_currentPaintWindowIterator != m_currentPaintWindowChain->constEnd()) {
+        Effect *effect = *m_currentPaintWindowIterator++;
+        EffectProfiler::Scope scope(m_profiler.get(), effect, EffectProfiler::Phase::Paint);
+        effect->paintWindow(renderTarget, viewport, w, mask, region, data);
         --m_currentPaintWindowIterator;
     } else {
+        EffectProfiler::Scope scope(m_profiler.get(), nullptr, EffectProfiler::Phase::Paint);
         m_scene->finalPaintWindow(renderTarget, viewport, static_cast<EffectWindowImpl *>(w), mask, region, data);
     }
 }
 
 void EffectsHandlerImpl::postPaintWindow(EffectWindow *w)
 {
-    if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintWindowIterator++)->postPaintWindow(w);
+    if (!m_currentPaintWindowChain) {
+        m_currentPaintWindowChain = &windowEffects(w);
+        m_currentPaintWindowIterator = m_currentPaintWindowChain->constBegin();
+        postPaintWindow(w);
+        m_currentPaintWindowChain = nullptr;
+        return;
+    }
+    if (m_currentPaintWindowIterator != m_currentPaintWindowChain->constEnd()) {
+        Effect *effect = *m_currentPaintWindowIterator++;
+        EffectProfiler::Scope scope(m_profiler.get(), effect, EffectProfiler::Phase::PostPaint);
+        effect->postPaintWindow(w);
         --m_currentPaintWindowIterator;
     }
     // no special final code
@@ -424,10 +491,20 @@ Effect *EffectsHandlerImpl::provides(Effect::Feature ef)
 
 void EffectsHandlerImpl::drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &region, WindowPaintData &data)
 {
-    if (m_currentDrawWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentDrawWindowIterator++)->drawWindow(renderTarget, viewport, w, mask, region, data);
+    if (!m_currentDrawWindowChain) {
+        m_currentDrawWindowChain = &windowEffects(w);
+        m_currentDrawWindowIterator = m_currentDrawWindowChain->constBegin();
+        drawWindow(renderTarget, viewport, w, mask, region, data);
+        m_currentDrawWindowChain = nullptr;
+        return;
+    }
+    if (m_currentDrawWindowIterator != m_currentDrawWindowChain->constEnd()) {
+        Effect *effect = *m_currentDrawWindowIterator++;
+        EffectProfiler::Scope scope(m_profiler.get(), effect, EffectProfiler::Phase::Paint);
+        effect->drawWindow(renderTarget, viewport, w, mask, region, data);
         --m_currentDrawWindowIterator;
     } else {
+        EffectProfiler::Scope scope(m_profiler.get(), nullptr, EffectProfiler::Phase::Paint);
         m_scene->finalDrawWindow(renderTarget, viewport, static_cast<EffectWindowImpl *>(w), mask, region, data);
     }
 }
@@ -450,18 +527,54 @@ bool EffectsHandlerImpl::decorationsHaveAlpha() const
 // start another painting pass
 void EffectsHandlerImpl::startPaint()
 {
+    if (m_profiler) {
+        m_profiler->startPaint();
+    }
     m_activeEffects.clear();
     m_activeEffects.reserve(loaded_effects.count());
+    m_activeWindowEffects.clear();
+    m_activeWindowEffects.reserve(loaded_effects.count());
     for (QVector<KWin::EffectPair>::const_iterator it = loaded_effects.constBegin(); it != loaded_effects.constEnd(); ++it) {
         if (it->second->isActive()) {
             m_activeEffects << it->second;
+            if (!m_filteredEffects.contains(it->second)) {
+                m_activeWindowEffects << it->second;
+            }
+        }
+    }
+
+    // only the windows that an active filtered effect is enabled for get a chain of their own
+    m_windowEffectChains.clear();
+    if (m_activeWindowEffects.size() != m_activeEffects.size()) {
+        for (auto it = m_enabledWindowEffects.constBegin(); it != m_enabledWindowEffects.constEnd(); ++it) {
+            const QSet<Effect *> &enabled = it.value();
+            const bool hasActiveEffect = std::any_of(enabled.constBegin(), enabled.constEnd(), [this](Effect *effect) {
+                return m_activeEffects.contains(effect);
+            });
+            if (!hasActiveEffect) {
+                continue;
+            }
+            EffectsList &chain = m_windowEffectChains[it.key()];
+            chain.reserve(m_activeEffects.count());
+            for (Effect *effect : std::as_const(m_activeEffects)) {
+                if (!m_filteredEffects.contains(effect) || enabled.contains(effect)) {
+                    chain << effect;
+                }
+            }
         }
     }
-    m_currentDrawWindowIterator = m_activeEffects.constBegin();
-    m_currentPaintWindowIterator = m_activeEffects.constBegin();
+
+    m_currentDrawWindowChain = nullptr;
+    m_currentPaintWindowChain = nullptr;
     m_currentPaintScreenIterator = m_activeEffects.constBegin();
 }
 
+const EffectsHandlerImpl::EffectsList &EffectsHandlerImpl::windowEffects(EffectWindow *w) const
+{
+    const auto it = m_windowEffectChains.constFind(w);
+    return it != m_windowEffectChains.constEnd() ? *it : m_activeWindowEffects;
+}
+
 void EffectsHandlerImpl::slotOpacityChanged(Window *window, qreal oldOpacity)
 {
     if (window->opacity() == oldOpacity || !window->effectWindow()) {
@@ -481,13 +594,13 @@ void EffectsHandlerImpl::slotClientModalityChanged()
     Q_EMIT windowModalityChanged(static_cast<X11Window *>(sender())->effectWindow());
 }
 
-void EffectsHandlerImpl::slotWindowDamaged(Window *window)
+void EffectsHandlerImpl::slotWindowDamaged(Window *window, const QRegion &region)
 {
     if (!window->effectWindow()) {
         // can happen during tear down of window
         return;
     }
-    Q_EMIT windowDamaged(window->effectWindow());
+    Q_EMIT windowDamaged(window->effectWindow(), region);
 }
 
 void EffectsHandlerImpl::setActiveFullScreenEffect(Effect *e)
@@ -1050,6 +1163,31 @@ void EffectsHandlerImpl::setElevatedWindow(KWin::EffectWindow *w, bool set)
     }
 }
 
+void EffectsHandlerImpl::setWindowHooksFiltered(Effect *effect, bool filtered)
+{
+    if (filtered) {
+        m_filteredEffects.insert(effect);
+    } else {
+        m_filteredEffects.remove(effect);
+        for (auto it = m_enabledWindowEffects.begin(); it != m_enabledWindowEffects.end();) {
+            it->remove(effect);
+            it = it->isEmpty() ? m_enabledWindowEffects.erase(it) : std::next(it);
+        }
+    }
+}
+
+void EffectsHandlerImpl::setWindowHooksEnabled(Effect *effect, EffectWindow *w, bool enabled)
+{
+    if (enabled) {
+        m_enabledWindowEffects[w].insert(effect);
+    } else if (auto it = m_enabledWindowEffects.find(w); it != m_enabledWindowEffects.end()) {
+        it->remove(effect);
+        if (it->isEmpty()) {
+            m_enabledWindowEffects.erase(it);
+        }
+    }
+}
+
 void EffectsHandlerImpl::setTabBoxWindow(EffectWindow *w)
 {
 #if KWIN_BUILD_TABBOX
@@ -1322,6 +1460,7 @@ void EffectsHandlerImpl::unloadEffect(const QString &name)
     }
 
     qCDebug(KWIN_CORE) << "EffectsHandler::unloadEffect : Unloading Effect :" << name;
+    m_effectSettings.remove(name);
     destroyEffect((*it).second);
     effect_order.erase(it);
     effectsChanged();
@@ -1333,6 +1472,10 @@ void EffectsHandlerImpl::destroyEffect(Effect *effect)
 {
     makeOpenGLContextCurrent();
 
+    if (m_profiler) {
+        m_profiler->remove(effect);
+    }
+
     if (fullscreen_effect == effect) {
         setActiveFullScreenEffect(nullptr);
     }
@@ -1342,6 +1485,7 @@ void EffectsHandlerImpl::destroyEffect(Effect *effect)
     }
 
     stopMouseInterception(effect);
+    setWindowHooksFiltered(effect, false);
 
     const QList<QByteArray> properties = m_propertiesForEffects.keys();
     for (const QByteArray &property : properties) {
@@ -1356,6 +1500,7 @@ void EffectsHandlerImpl::reconfigureEffect(const QString &name)
     for (QVector<EffectPair>::const_iterator it = loaded_effects.constBegin(); it != loaded_effects.constEnd(); ++it) {
         if ((*it).first == name) {
             kwinApp()->config()->reparseConfiguration();
+            m_effectSettings[name] = effectSettings(name);
             makeOpenGLContextCurrent();
             (*it).second->reconfigure(Effect::ReconfigureAll);
             return;
@@ -1421,11 +1566,14 @@ void EffectsHandlerImpl::effectsChanged()
     std::copy(effect_order.constBegin(), effect_order.constEnd(),
               std::back_inserter(loaded_effects));
 
+    m_activeWindowEffects.clear();
+    m_windowEffectChains.clear();
+
     m_activeEffects.reserve(loaded_effects.count());
 
     m_currentPaintScreenIterator = m_activeEffects.constBegin();
-    m_currentPaintWindowIterator = m_activeEffects.constBegin();
-    m_currentDrawWindowIterator = m_activeEffects.constBegin();
+    m_currentPaintWindowChain = nullptr;
+    m_currentDrawWindowChain = nullptr;
 }
 
 QStringList EffectsHandlerImpl::activeEffects() const
@@ -1521,6 +1669,38 @@ QString EffectsHandlerImpl::debug(const QString &name, const QString &parameter)
     return QString();
 }
 
+void EffectsHandlerImpl::setProfilingEnabled(bool enabled)
+{
+    // the timer queries are created and deleted in the compositing context
+    makeOpenGLContextCurrent();
+    if (enabled) {
+        m_profiler = std::make_unique<EffectProfiler>(isOpenGLCompositing());
+    } else {
+        m_profiler.reset();
+    }
+}
+
+bool EffectsHandlerImpl::isProfilingEnabled() const
+{
+    return bool(m_profiler);
+}
+
+QVariantList EffectsHandlerImpl::effectStatistics() const
+{
+    QVariantList statistics;
+    for (const EffectPair &pair : loaded_effects) {
+        QVariantMap map{
+            {QStringLiteral("name"), pair.first},
+            {QStringLiteral("textureMemory"), GLTextureMemory::ownerUsage(pair.second)},
+        };
+        if (m_profiler) {
+            m_profiler->addStatistics(pair.second, map);
+        }
+        statistics.append(map);
+    }
+    return statistics;
+}
+
 bool EffectsHandlerImpl::makeOpenGLContextCurrent()
 {
     return m_scene->makeOpenGLContextCurrent();
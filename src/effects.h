@@ -17,6 +17,7 @@
 
 #include <QFont>
 #include <QHash>
+#include <QSet>
 
 #include <memory>
 
@@ -36,6 +37,7 @@ namespace KWin
 class Window;
 class Compositor;
 class EffectLoader;
+class EffectProfiler;
 class Group;
 class Unmanaged;
 class WindowPropertyNotifyX11Filter;
@@ -112,6 +114,8 @@ public:
     EffectWindow *findWindow(const QUuid &id) const override;
     EffectWindowList stackingOrder() const override;
     void setElevatedWindow(KWin::EffectWindow *w, bool set) override;
+    void setWindowHooksFiltered(Effect *effect, bool filtered) override;
+    void setWindowHooksEnabled(Effect *effect, EffectWindow *w, bool enabled) override;
 
     void setTabBoxWindow(EffectWindow *) override;
     EffectWindowList currentTabBoxWindowList() const override;
@@ -265,11 +269,25 @@ public Q_SLOTS:
     Q_SCRIPTABLE QString supportInformation(const QString &name) const;
     Q_SCRIPTABLE QString debug(const QString &name, const QString &parameter = QString()) const;
 
+    /**
+     * Starts or stops measuring the time the effects spend in their paint hooks. Enabling it
+     * again starts over.
+     */
+    Q_SCRIPTABLE void setProfilingEnabled(bool enabled);
+    Q_SCRIPTABLE bool isProfilingEnabled() const;
+    /**
+     * Returns a map for every loaded effect with its name and the texture memory it holds, in
+     * bytes. While profiling, the maps also contain the number of frames the effect was active
+     * in, and the average CPU time per frame it spent in prePaint, paint and postPaint, and the
+     * time the GPU spent on its commands if timer queries are supported, in microseconds.
+     */
+    Q_SCRIPTABLE QVariantList effectStatistics() const;
+
 protected Q_SLOTS:
     void slotWindowShown(KWin::Window *);
     void slotOpacityChanged(KWin::Window *window, qreal oldOpacity);
     void slotClientModalityChanged();
-    void slotWindowDamaged(KWin::Window *window);
+    void slotWindowDamaged(KWin::Window *window, const QRegion &region);
     void slotOutputAdded(Output *output);
     void slotOutputRemoved(Output *output);
 
@@ -314,7 +332,17 @@ private:
 
     typedef QVector<Effect *> EffectsList;
     typedef EffectsList::const_iterator EffectsIterator;
+    const EffectsList &windowEffects(EffectWindow *w) const;
+
     EffectsList m_activeEffects;
+    // the active effects that are called for every window
+    EffectsList m_activeWindowEffects;
+    // the chains of the windows that some filtered effects are enabled for, rebuilt in startPaint()
+    QHash<EffectWindow *, EffectsList> m_windowEffectChains;
+    QSet<Effect *> m_filteredEffects;
+    QHash<EffectWindow *, QSet<Effect *>> m_enabledWindowEffects;
+    const EffectsList *m_currentDrawWindowChain = nullptr;
+    const EffectsList *m_currentPaintWindowChain = nullptr;
     EffectsIterator m_currentDrawWindowIterator;
     EffectsIterator m_currentPaintWindowIterator;
     EffectsIterator m_currentPaintScreenIterator;
@@ -325,9 +353,12 @@ private:
     WorkspaceScene *m_scene;
     QList<Effect *> m_grabbedMouseEffects;
     EffectLoader *m_effectLoader;
+    // the settings of the loaded effects, to find the effects whose settings have changed
+    QHash<QString, QMap<QString, QString>> m_effectSettings;
     int m_trackingCursorChanges;
     std::unique_ptr<WindowPropertyNotifyX11Filter> m_x11WindowPropertyNotify;
     QList<EffectScreen *> m_effectScreens;
+    std::unique_ptr<EffectProfiler> m_profiler;
 };
 
 class EffectScreenImpl : public EffectScreen
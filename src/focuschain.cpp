@@ -13,14 +13,70 @@
 namespace KWin
 {
 
+FocusChain::Chain::Chain(const Chain &other)
+{
+    *this = other;
+}
+
+FocusChain::Chain &FocusChain::Chain::operator=(const Chain &other)
+{
+    if (this == &other) {
+        return *this;
+    }
+    // the iterators of the other chain point into its own list
+    m_windows = other.m_windows;
+    m_nodes.clear();
+    for (auto it = m_windows.begin(); it != m_windows.end(); ++it) {
+        m_nodes.insert(*it, it);
+    }
+    return *this;
+}
+
+Window *FocusChain::Chain::previous(Window *window) const
+{
+    auto it = m_nodes.constFind(window);
+    if (it == m_nodes.constEnd() || *it == m_windows.begin()) {
+        return nullptr;
+    }
+    return *std::prev(*it);
+}
+
+void FocusChain::Chain::append(Window *window)
+{
+    Q_ASSERT(!m_nodes.contains(window));
+    m_nodes.insert(window, m_windows.insert(m_windows.end(), window));
+}
+
+void FocusChain::Chain::prepend(Window *window)
+{
+    Q_ASSERT(!m_nodes.contains(window));
+    m_nodes.insert(window, m_windows.insert(m_windows.begin(), window));
+}
+
+void FocusChain::Chain::insertBefore(Window *window, Window *reference)
+{
+    Q_ASSERT(!m_nodes.contains(window));
+    Q_ASSERT(m_nodes.contains(reference));
+    m_nodes.insert(window, m_windows.insert(m_nodes.value(reference), window));
+}
+
+void FocusChain::Chain::remove(Window *window)
+{
+    auto it = m_nodes.find(window);
+    if (it != m_nodes.end()) {
+        m_windows.erase(*it);
+        m_nodes.erase(it);
+    }
+}
+
 void FocusChain::remove(Window *window)
 {
     for (auto it = m_desktopFocusChains.begin();
          it != m_desktopFocusChains.end();
          ++it) {
-        it.value().removeAll(window);
+        it.value().remove(window);
     }
-    m_mostRecentlyUsed.removeAll(window);
+    m_mostRecentlyUsed.remove(window);
 }
 
 void FocusChain::addDesktop(VirtualDesktop *desktop)
@@ -48,8 +104,8 @@ Window *FocusChain::getForActivation(VirtualDesktop *desktop, Output *output) co
         return nullptr;
     }
     const auto &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        auto tmp = chain.at(i);
+    for (auto chainIt = chain.rbegin(); chainIt != chain.rend(); ++chainIt) {
+        auto tmp = *chainIt;
         // TODO: move the check into Window
         if (!tmp->isShade() && tmp->isShown() && tmp->isOnCurrentActivity()
             && (!m_separateScreenFocus || tmp->output() == output)) {
@@ -94,7 +150,7 @@ void FocusChain::update(Window *window, FocusChain::Change change)
             if (window->isOnDesktop(it.key())) {
                 updateWindowInChain(window, change, chain);
             } else {
-                chain.removeAll(window);
+                chain.remove(window);
             }
         }
     }
@@ -119,9 +175,9 @@ void FocusChain::insertWindowIntoChain(Window *window, Chain &chain)
     if (chain.contains(window)) {
         return;
     }
-    if (m_activeWindow && m_activeWindow != window && !chain.empty() && chain.last() == m_activeWindow) {
+    if (m_activeWindow && m_activeWindow != window && !chain.isEmpty() && chain.last() == m_activeWindow) {
         // Add it after the active window
-        chain.insert(chain.size() - 1, window);
+        chain.insertBefore(window, m_activeWindow);
     } else {
         // Otherwise add as the first one
         chain.append(window);
@@ -151,13 +207,13 @@ void FocusChain::moveAfterWindowInChain(Window *window, Window *reference, Chain
         return;
     }
     if (Window::belongToSameApplication(reference, window)) {
-        chain.removeAll(window);
-        chain.insert(chain.indexOf(reference), window);
+        chain.remove(window);
+        chain.insertBefore(window, reference);
     } else {
-        chain.removeAll(window);
-        for (int i = chain.size() - 1; i >= 0; --i) {
-            if (Window::belongToSameApplication(reference, chain.at(i))) {
-                chain.insert(i, window);
+        chain.remove(window);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (Window::belongToSameApplication(reference, *it)) {
+                chain.insertBefore(window, *it);
                 break;
             }
         }
@@ -177,14 +233,13 @@ Window *FocusChain::nextMostRecentlyUsed(Window *reference) const
     if (m_mostRecentlyUsed.isEmpty()) {
         return nullptr;
     }
-    const int index = m_mostRecentlyUsed.indexOf(reference);
-    if (index == -1) {
+    if (!m_mostRecentlyUsed.contains(reference)) {
         return m_mostRecentlyUsed.first();
     }
-    if (index == 0) {
-        return m_mostRecentlyUsed.last();
+    if (Window *previous = m_mostRecentlyUsed.previous(reference)) {
+        return previous;
     }
-    return m_mostRecentlyUsed.at(index - 1);
+    return m_mostRecentlyUsed.last();
 }
 
 // copied from activation.cpp
@@ -200,8 +255,8 @@ Window *FocusChain::nextForDesktop(Window *reference, VirtualDesktop *desktop) c
         return nullptr;
     }
     const auto &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        auto window = chain.at(i);
+    for (auto chainIt = chain.rbegin(); chainIt != chain.rend(); ++chainIt) {
+        auto window = *chainIt;
         if (isUsableFocusCandidate(window, reference)) {
             return window;
         }
@@ -211,13 +266,13 @@ Window *FocusChain::nextForDesktop(Window *reference, VirtualDesktop *desktop) c
 
 void FocusChain::makeFirstInChain(Window *window, Chain &chain)
 {
-    chain.removeAll(window);
+    chain.remove(window);
     chain.append(window);
 }
 
 void FocusChain::makeLastInChain(Window *window, Chain &chain)
 {
-    chain.removeAll(window);
+    chain.remove(window);
     chain.prepend(window);
 }
 
@@ -13,6 +13,8 @@
 #include <QHash>
 #include <QObject>
 
+#include <list>
+
 namespace KWin
 {
 // forward declarations
@@ -173,7 +175,45 @@ public Q_SLOTS:
     void removeDesktop(VirtualDesktop *desktop);
 
 private:
-    using Chain = QList<Window *>;
+    /**
+     * A focus chain is a doubly linked list of windows with an index of the list nodes, so
+     * windows can be looked up, removed and inserted next to each other in constant time.
+     * The last window is the most recently used one.
+     */
+    class Chain
+    {
+    public:
+        using const_iterator = std::list<Window *>::const_iterator;
+        using const_reverse_iterator = std::list<Window *>::const_reverse_iterator;
+
+        Chain() = default;
+        Chain(const Chain &other);
+        Chain &operator=(const Chain &other);
+
+        bool isEmpty() const;
+        bool contains(Window *window) const;
+        Window *first() const;
+        Window *last() const;
+        /**
+         * Returns the window right before @p window, or @c null if @p window is the first one.
+         */
+        Window *previous(Window *window) const;
+
+        void append(Window *window);
+        void prepend(Window *window);
+        void insertBefore(Window *window, Window *reference);
+        void remove(Window *window);
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        const_reverse_iterator rbegin() const;
+        const_reverse_iterator rend() const;
+
+    private:
+        std::list<Window *> m_windows;
+        QHash<Window *, std::list<Window *>::iterator> m_nodes;
+    };
+
     /**
      * @brief Makes @p window the first Window in the given focus @p chain.
      *
@@ -206,6 +246,46 @@ private:
     VirtualDesktop *m_currentDesktop = nullptr;
 };
 
+inline bool FocusChain::Chain::isEmpty() const
+{
+    return m_windows.empty();
+}
+
+inline bool FocusChain::Chain::contains(Window *window) const
+{
+    return m_nodes.contains(window);
+}
+
+inline Window *FocusChain::Chain::first() const
+{
+    return m_windows.front();
+}
+
+inline Window *FocusChain::Chain::last() const
+{
+    return m_windows.back();
+}
+
+inline FocusChain::Chain::const_iterator FocusChain::Chain::begin() const
+{
+    return m_windows.cbegin();
+}
+
+inline FocusChain::Chain::const_iterator FocusChain::Chain::end() const
+{
+    return m_windows.cend();
+}
+
+inline FocusChain::Chain::const_reverse_iterator FocusChain::Chain::rbegin() const
+{
+    return m_windows.crbegin();
+}
+
+inline FocusChain::Chain::const_reverse_iterator FocusChain::Chain::rend() const
+{
+    return m_windows.crend();
+}
+
 inline bool FocusChain::contains(Window *window) const
 {
     return m_mostRecentlyUsed.contains(window);
@@ -10,13 +10,19 @@
 
 #include "ftrace.h"
 
+#include <QCoreApplication>
 #include <QDBusConnection>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QScopeGuard>
 #include <QTextStream>
+#include <QThread>
+#include <utility>
 
 namespace KWin
 {
@@ -34,13 +40,108 @@ FTraceLogger::FTraceLogger(QObject *parent)
 
 bool FTraceLogger::isEnabled() const
 {
-    return m_file.isOpen();
+    return m_file.isOpen() || !m_chromeTraceFileName.isEmpty();
+}
+
+void FTraceLogger::writeMarker(const QByteArray &marker)
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_file.isOpen()) {
+        return;
+    }
+    QTextStream stream(&m_file);
+    stream << marker << Qt::endl;
+}
+
+void FTraceLogger::recordChromeTraceEvent(const QByteArray &name, std::chrono::steady_clock::time_point timestamp, std::optional<std::chrono::steady_clock::duration> duration)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_chromeTraceFileName.isEmpty()) {
+        return;
+    }
+    m_chromeTraceEvents.push_back(ChromeTraceEvent{
+        .name = name,
+        .timestamp = timestamp,
+        .duration = duration,
+        .thread = quintptr(QThread::currentThreadId()),
+    });
+}
+
+void FTraceLogger::startChromeTrace(const QString &fileName)
+{
+    const bool wasEnabled = isEnabled();
+    {
+        QMutexLocker lock(&m_mutex);
+        m_chromeTraceFileName = fileName;
+        m_chromeTraceEvents.clear();
+    }
+    if (!wasEnabled) {
+        Q_EMIT enabledChanged();
+    }
+}
+
+void FTraceLogger::stopChromeTrace()
+{
+    QString fileName;
+    std::vector<ChromeTraceEvent> events;
+    {
+        QMutexLocker lock(&m_mutex);
+        fileName = std::exchange(m_chromeTraceFileName, QString());
+        events = std::exchange(m_chromeTraceEvents, {});
+    }
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    // The timestamps are in microseconds, relative to the earliest event. Durations are
+    // recorded when they end, so that's not necessarily the first one
+    auto origin = std::chrono::steady_clock::time_point::max();
+    for (const ChromeTraceEvent &event : events) {
+        origin = std::min(origin, event.timestamp);
+    }
+    const auto microseconds = [](std::chrono::steady_clock::duration duration) {
+        return double(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    };
+
+    QJsonArray traceEvents;
+    for (const ChromeTraceEvent &event : events) {
+        QJsonObject object{
+            {QStringLiteral("name"), QString::fromUtf8(event.name)},
+            {QStringLiteral("ts"), microseconds(event.timestamp - origin)},
+            {QStringLiteral("pid"), QCoreApplication::applicationPid()},
+            {QStringLiteral("tid"), QString::number(event.thread)},
+        };
+        if (event.duration) {
+            object[QStringLiteral("ph")] = QStringLiteral("X");
+            object[QStringLiteral("dur")] = microseconds(*event.duration);
+        } else {
+            object[QStringLiteral("ph")] = QStringLiteral("i");
+            object[QStringLiteral("s")] = QStringLiteral("g");
+        }
+        traceEvents.append(object);
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write the Chrome trace to" << fileName << ":" << file.errorString();
+    } else {
+        file.write(QJsonDocument(QJsonObject{{QStringLiteral("traceEvents"), traceEvents}}).toJson(QJsonDocument::Compact));
+    }
+
+    if (!isEnabled()) {
+        Q_EMIT enabledChanged();
+    }
+}
+
+bool FTraceLogger::isChromeTraceActive() const
+{
+    return !m_chromeTraceFileName.isEmpty();
 }
 
 void FTraceLogger::setEnabled(bool enabled)
 {
     QMutexLocker lock(&m_mutex);
-    if (enabled == isEnabled()) {
+    if (enabled == m_file.isOpen()) {
         return;
     }
 
@@ -115,7 +216,9 @@ QString FTraceLogger::filePath()
 
 FTraceDuration::~FTraceDuration()
 {
-    FTraceLogger::self()->trace(m_message, " end_ctx=", m_context);
+    const auto end = std::chrono::steady_clock::now();
+    FTraceLogger::self()->writeMarker(m_message + " end_ctx=" + QByteArray::number(m_context));
+    FTraceLogger::self()->recordChromeTraceEvent(m_message, m_start, end - m_start);
 }
 
 }
@@ -17,6 +17,10 @@
 #include <QObject>
 #include <QTextStream>
 
+#include <chrono>
+#include <optional>
+#include <vector>
+
 namespace KWin
 {
 /**
@@ -26,6 +30,9 @@ namespace KWin
  *  Set the KWIN_PERF_FTRACE environment variable before starting the application
  *  Calling on DBus /FTrace org.kde.kwin.FTrace.setEnabled true
  * After having created the ftrace mount
+ *
+ * The log messages can also be recorded in memory and written as a Chrome trace, see
+ * startChromeTrace().
  */
 class KWIN_EXPORT FTraceLogger : public QObject
 {
@@ -47,14 +54,29 @@ public:
     void trace(Args... args)
     {
         Q_ASSERT(isEnabled());
-        QMutexLocker lock(&m_mutex);
-        if (!m_file.isOpen()) {
-            return;
-        }
-        QTextStream stream(&m_file);
-        (stream << ... << args) << Qt::endl;
+        QByteArray message;
+        QTextStream stream(&message);
+        (stream << ... << args);
+        stream.flush();
+        writeMarker(message);
+        recordChromeTraceEvent(message, std::chrono::steady_clock::now(), std::nullopt);
     }
 
+    /**
+     * Starts recording the messages and durations in memory. They are written to @a fileName
+     * in the Chrome trace event format, which can be viewed with Perfetto or chrome://tracing,
+     * when stopChromeTrace() is called.
+     */
+    void startChromeTrace(const QString &fileName);
+
+    /**
+     * Writes the recorded Chrome trace and stops recording. Does nothing if no Chrome trace
+     * is being recorded.
+     */
+    void stopChromeTrace();
+
+    bool isChromeTraceActive() const;
+
 Q_SIGNALS:
     void enabledChanged();
 
@@ -62,10 +84,24 @@ public Q_SLOTS:
     Q_SCRIPTABLE void setEnabled(bool enabled);
 
 private:
+    struct ChromeTraceEvent
+    {
+        QByteArray name;
+        std::chrono::steady_clock::time_point timestamp;
+        std::optional<std::chrono::steady_clock::duration> duration; // without one, it's an instant event
+        quintptr thread;
+    };
+
     static QString filePath();
     bool open();
+    void writeMarker(const QByteArray &marker);
+    void recordChromeTraceEvent(const QByteArray &name, std::chrono::steady_clock::time_point timestamp, std::optional<std::chrono::steady_clock::duration> duration);
+
     QFile m_file;
     QMutex m_mutex;
+    QString m_chromeTraceFileName;
+    std::vector<ChromeTraceEvent> m_chromeTraceEvents;
+    friend class FTraceDuration;
     KWIN_SINGLETON(FTraceLogger)
 };
 
@@ -80,7 +116,8 @@ public:
         (stream << ... << args);
         stream.flush();
         m_context = ++s_context;
-        FTraceLogger::self()->trace(m_message, " begin_ctx=", m_context);
+        m_start = std::chrono::steady_clock::now();
+        FTraceLogger::self()->writeMarker(m_message + " begin_ctx=" + QByteArray::number(m_context));
     }
 
     ~FTraceDuration();
@@ -88,6 +125,7 @@ public:
 private:
     QByteArray m_message;
     quint32 m_context;
+    std::chrono::steady_clock::time_point m_start;
 };
 
 } // namespace KWin
@@ -95,8 +133,8 @@ private:
 /**
  * Optimised macro, arguments are only copied if tracing is enabled
  */
-#define fTrace(...)                              \
-    if (KWin::FTraceLogger::self()->isEnabled()) \
+#define fTrace(...)                                                            \
+    if (KWin::FTraceLogger::self() && KWin::FTraceLogger::self()->isEnabled()) \
         KWin::FTraceLogger::self()->trace(__VA_ARGS__);
 
 /**
@@ -104,4 +142,4 @@ private:
  * In GPUVis this will appear as a timed block with begin_ctx and end_ctx markers
  */
 #define fTraceDuration(...) \
-    std::unique_ptr<KWin::FTraceDuration> _duration(KWin::FTraceLogger::self()->isEnabled() ? new KWin::FTraceDuration(__VA_ARGS__) : nullptr);
+    std::unique_ptr<KWin::FTraceDuration> _duration(KWin::FTraceLogger::self() && KWin::FTraceLogger::self()->isEnabled() ? new KWin::FTraceDuration(__VA_ARGS__) : nullptr);
@@ -10,8 +10,10 @@
 
 #include <QDebug>
 #include <QRect>
+#include <algorithm>
 #include <cmath>
 #include <functional>
+#include <utility>
 
 namespace KWin
 {
@@ -104,7 +106,11 @@ void GestureRecognizer::unregisterSwipeGesture(KWin::SwipeGesture *gesture)
         m_destroyConnections.erase(it);
     }
     m_swipeGestures.removeAll(gesture);
-    if (m_activeSwipeGestures.removeOne(gesture)) {
+    const auto active = std::find_if(m_activeSwipeGestures.begin(), m_activeSwipeGestures.end(), [gesture](const ActiveSwipeGesture &active) {
+        return active.gesture == gesture;
+    });
+    if (active != m_activeSwipeGestures.end()) {
+        m_activeSwipeGestures.erase(active);
         Q_EMIT gesture->cancelled();
     }
 }
@@ -125,7 +131,11 @@ void GestureRecognizer::unregisterPinchGesture(KWin::PinchGesture *gesture)
         m_destroyConnections.erase(it);
     }
     m_pinchGestures.removeAll(gesture);
-    if (m_activePinchGestures.removeOne(gesture)) {
+    const auto active = std::find_if(m_activePinchGestures.begin(), m_activePinchGestures.end(), [gesture](const ActivePinchGesture &active) {
+        return active.gesture == gesture;
+    });
+    if (active != m_activePinchGestures.end()) {
+        m_activePinchGestures.erase(active);
         Q_EMIT gesture->cancelled();
     }
 }
@@ -189,13 +199,42 @@ int GestureRecognizer::startSwipeGesture(uint fingerCount, const QPointF &startP
             Q_UNREACHABLE();
         }
 
-        m_activeSwipeGestures << gesture;
+        const bool vertical = gesture->direction() == SwipeDirection::Up || gesture->direction() == SwipeDirection::Down;
+        qreal minimumDelta = 0;
+        if (gesture->isMinimumDeltaRelevant() && !gesture->minimumDelta().isNull()) {
+            minimumDelta = std::abs(vertical ? gesture->minimumDelta().y() : gesture->minimumDelta().x());
+        }
+        const bool fromBorder = gesture->minimumXIsRelevant() && gesture->maximumXIsRelevant()
+            && gesture->minimumYIsRelevant() && gesture->maximumYIsRelevant();
+
+        m_activeSwipeGestures.append(ActiveSwipeGesture{
+            .gesture = gesture,
+            .direction = gesture->direction(),
+            .vertical = vertical,
+            .minimumDelta = minimumDelta,
+            .fromBorder = fromBorder,
+            .progress = -1,
+            .progressChanged = false,
+        });
         count++;
         Q_EMIT gesture->started();
     }
     return count;
 }
 
+void GestureRecognizer::rejectSwipeGestures(SwipeDirection direction)
+{
+    auto it = std::remove_if(m_activeSwipeGestures.begin(), m_activeSwipeGestures.end(), [direction](const ActiveSwipeGesture &active) {
+        return active.direction != direction && !active.fromBorder;
+    });
+    // emit only after the array is consistent again, receivers may unregister gestures
+    const QVector<ActiveSwipeGesture> rejected(it, m_activeSwipeGestures.end());
+    m_activeSwipeGestures.erase(it, m_activeSwipeGestures.end());
+    for (const ActiveSwipeGesture &active : rejected) {
+        Q_EMIT active.gesture->cancelled();
+    }
+}
+
 void GestureRecognizer::updateSwipeGesture(const QPointF &delta)
 {
     m_currentDelta += delta;
@@ -233,46 +272,42 @@ void GestureRecognizer::updateSwipeGesture(const QPointF &delta)
         Q_UNREACHABLE();
     }
 
-    // Eliminate wrong gestures (takes two iterations)
-    for (int i = 0; i < 2; i++) {
-
-        if (m_activeSwipeGestures.isEmpty()) {
-            startSwipeGesture(m_currentFingerCount);
-        }
-
-        for (auto it = m_activeSwipeGestures.begin(); it != m_activeSwipeGestures.end();) {
-            auto g = static_cast<SwipeGesture *>(*it);
-
-            if (g->direction() != direction) {
-                // If a gesture was started from a touchscreen border never cancel it
-                if (!g->minimumXIsRelevant() || !g->maximumXIsRelevant() || !g->minimumYIsRelevant() || !g->maximumYIsRelevant()) {
-                    Q_EMIT g->cancelled();
-                    it = m_activeSwipeGestures.erase(it);
-                    continue;
-                }
-            }
-
-            it++;
-        }
+    // Eliminate wrong gestures, if none is left try again with a fresh set
+    if (m_activeSwipeGestures.isEmpty()) {
+        startSwipeGesture(m_currentFingerCount);
+    }
+    rejectSwipeGestures(direction);
+    if (m_activeSwipeGestures.isEmpty()) {
+        startSwipeGesture(m_currentFingerCount);
+        rejectSwipeGestures(direction);
     }
 
-    // Send progress update
-    for (SwipeGesture *g : std::as_const(m_activeSwipeGestures)) {
-        Q_EMIT g->progress(g->deltaToProgress(m_currentDelta));
-        Q_EMIT g->deltaProgress(m_currentDelta);
+    // Send progress update, a progress that didn't change (e.g. saturated at 1) is not reported again
+    for (ActiveSwipeGesture &g : m_activeSwipeGestures) {
+        const qreal distance = std::abs(g.vertical ? m_currentDelta.y() : m_currentDelta.x());
+        const qreal progress = g.minimumDelta > 0 ? std::min(distance / g.minimumDelta, 1.0) : 1.0;
+        g.progressChanged = progress != g.progress;
+        g.progress = progress;
+    }
+    const QVector<ActiveSwipeGesture> active = m_activeSwipeGestures;
+    for (const ActiveSwipeGesture &g : active) {
+        if (g.progressChanged) {
+            Q_EMIT g.gesture->progress(g.progress);
+        }
+        Q_EMIT g.gesture->deltaProgress(m_currentDelta);
     }
 }
 
 void GestureRecognizer::cancelActiveGestures()
 {
-    for (auto g : std::as_const(m_activeSwipeGestures)) {
-        Q_EMIT g->cancelled();
+    const QVector<ActiveSwipeGesture> swipeGestures = std::exchange(m_activeSwipeGestures, {});
+    const QVector<ActivePinchGesture> pinchGestures = std::exchange(m_activePinchGestures, {});
+    for (const ActiveSwipeGesture &g : swipeGestures) {
+        Q_EMIT g.gesture->cancelled();
     }
-    for (auto g : std::as_const(m_activePinchGestures)) {
-        Q_EMIT g->cancelled();
+    for (const ActivePinchGesture &g : pinchGestures) {
+        Q_EMIT g.gesture->cancelled();
     }
-    m_activeSwipeGestures.clear();
-    m_activePinchGestures.clear();
     m_currentScale = 0;
     m_currentDelta = QPointF(0, 0);
     m_currentSwipeAxis = Axis::None;
@@ -289,14 +324,14 @@ void GestureRecognizer::cancelSwipeGesture()
 void GestureRecognizer::endSwipeGesture()
 {
     const QPointF delta = m_currentDelta;
-    for (auto g : std::as_const(m_activeSwipeGestures)) {
-        if (static_cast<SwipeGesture *>(g)->minimumDeltaReached(delta)) {
-            Q_EMIT g->triggered();
+    const QVector<ActiveSwipeGesture> swipeGestures = std::exchange(m_activeSwipeGestures, {});
+    for (const ActiveSwipeGesture &g : swipeGestures) {
+        if (g.gesture->minimumDeltaReached(delta)) {
+            Q_EMIT g.gesture->triggered();
         } else {
-            Q_EMIT g->cancelled();
+            Q_EMIT g.gesture->cancelled();
         }
     }
-    m_activeSwipeGestures.clear();
     m_currentFingerCount = 0;
     m_currentDelta = QPointF(0, 0);
     m_currentSwipeAxis = Axis::None;
@@ -322,13 +357,31 @@ int GestureRecognizer::startPinchGesture(uint fingerCount)
         }
 
         // direction doesn't matter yet
-        m_activePinchGestures << gesture;
+        m_activePinchGestures.append(ActivePinchGesture{
+            .gesture = gesture,
+            .direction = gesture->direction(),
+            .minimumScaleDelta = gesture->minimumScaleDelta(),
+            .progress = -1,
+            .progressChanged = false,
+        });
         count++;
         Q_EMIT gesture->started();
     }
     return count;
 }
 
+void GestureRecognizer::rejectPinchGestures(PinchDirection direction)
+{
+    auto it = std::remove_if(m_activePinchGestures.begin(), m_activePinchGestures.end(), [direction](const ActivePinchGesture &active) {
+        return active.direction != direction;
+    });
+    const QVector<ActivePinchGesture> rejected(it, m_activePinchGestures.end());
+    m_activePinchGestures.erase(it, m_activePinchGestures.end());
+    for (const ActivePinchGesture &active : rejected) {
+        Q_EMIT active.gesture->cancelled();
+    }
+}
+
 void GestureRecognizer::updatePinchGesture(qreal scale, qreal angleDelta, const QPointF &posDelta)
 {
     m_currentScale = scale;
@@ -341,26 +394,27 @@ void GestureRecognizer::updatePinchGesture(qreal scale, qreal angleDelta, const
         direction = PinchDirection::Expanding;
     }
 
-    // Eliminate wrong gestures (takes two iterations)
-    for (int i = 0; i < 2; i++) {
-        if (m_activePinchGestures.isEmpty()) {
-            startPinchGesture(m_currentFingerCount);
-        }
-
-        for (auto it = m_activePinchGestures.begin(); it != m_activePinchGestures.end();) {
-            auto g = static_cast<PinchGesture *>(*it);
-
-            if (g->direction() != direction) {
-                Q_EMIT g->cancelled();
-                it = m_activePinchGestures.erase(it);
-                continue;
-            }
-            it++;
-        }
+    // Eliminate wrong gestures, if none is left try again with a fresh set
+    if (m_activePinchGestures.isEmpty()) {
+        startPinchGesture(m_currentFingerCount);
+    }
+    rejectPinchGestures(direction);
+    if (m_activePinchGestures.isEmpty()) {
+        startPinchGesture(m_currentFingerCount);
+        rejectPinchGestures(direction);
     }
 
-    for (PinchGesture *g : std::as_const(m_activePinchGestures)) {
-        Q_EMIT g->progress(g->scaleDeltaToProgress(scale));
+    const qreal scaleDelta = std::abs(scale - 1);
+    for (ActivePinchGesture &g : m_activePinchGestures) {
+        const qreal progress = std::clamp(scaleDelta / g.minimumScaleDelta, 0.0, 1.0);
+        g.progressChanged = progress != g.progress;
+        g.progress = progress;
+    }
+    const QVector<ActivePinchGesture> active = m_activePinchGestures;
+    for (const ActivePinchGesture &g : active) {
+        if (g.progressChanged) {
+            Q_EMIT g.gesture->progress(g.progress);
+        }
     }
 }
 
@@ -374,15 +428,15 @@ void GestureRecognizer::cancelPinchGesture()
 
 void GestureRecognizer::endPinchGesture() // because fingers up
 {
-    for (auto g : std::as_const(m_activePinchGestures)) {
-        if (g->minimumScaleDeltaReached(m_currentScale)) {
-            Q_EMIT g->triggered();
+    m_activeSwipeGestures.clear();
+    const QVector<ActivePinchGesture> pinchGestures = std::exchange(m_activePinchGestures, {});
+    for (const ActivePinchGesture &g : pinchGestures) {
+        if (g.gesture->minimumScaleDeltaReached(m_currentScale)) {
+            Q_EMIT g.gesture->triggered();
         } else {
-            Q_EMIT g->cancelled();
+            Q_EMIT g.gesture->cancelled();
         }
     }
-    m_activeSwipeGestures.clear();
-    m_activePinchGestures.clear();
     m_currentScale = 1;
     m_currentFingerCount = 0;
     m_currentSwipeAxis = Axis::None;
@@ -202,11 +202,37 @@ private:
         Vertical,
         None,
     };
+    /**
+     * The thresholds of an active gesture are copied out of the gesture objects when a
+     * gesture sequence starts, so updates only have to walk one contiguous array.
+     */
+    struct ActiveSwipeGesture
+    {
+        SwipeGesture *gesture;
+        SwipeDirection direction;
+        bool vertical;
+        // the absolute minimum delta along the swipe axis, or 0 if progress is always 1
+        qreal minimumDelta;
+        // gestures started from a touchscreen border are never cancelled by a direction change
+        bool fromBorder;
+        qreal progress;
+        bool progressChanged;
+    };
+    struct ActivePinchGesture
+    {
+        PinchGesture *gesture;
+        PinchDirection direction;
+        qreal minimumScaleDelta;
+        qreal progress;
+        bool progressChanged;
+    };
     int startSwipeGesture(uint fingerCount, const QPointF &startPos, StartPositionBehavior startPosBehavior);
+    void rejectSwipeGestures(SwipeDirection direction);
+    void rejectPinchGestures(PinchDirection direction);
     QVector<SwipeGesture *> m_swipeGestures;
     QVector<PinchGesture *> m_pinchGestures;
-    QVector<SwipeGesture *> m_activeSwipeGestures;
-    QVector<PinchGesture *> m_activePinchGestures;
+    QVector<ActiveSwipeGesture> m_activeSwipeGestures;
+    QVector<ActivePinchGesture> m_activePinchGestures;
     QMap<Gesture *, QMetaObject::Connection> m_destroyConnections;
 
     QPointF m_currentDelta = QPointF(0, 0);
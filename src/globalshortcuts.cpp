@@ -118,6 +118,26 @@ void GlobalShortcutsManager::objectDeleted(QObject *object)
             ++it;
         }
     }
+    rebuildLookupTables();
+}
+
+static quint64 lookupKey(Qt::KeyboardModifiers modifiers, quint32 value)
+{
+    return (quint64(modifiers.toInt()) << 32) | value;
+}
+
+void GlobalShortcutsManager::rebuildLookupTables()
+{
+    m_pointerShortcuts.clear();
+    m_axisShortcuts.clear();
+    for (int i = 0; i < m_shortcuts.size(); ++i) {
+        const Shortcut &shortcut = m_shortcuts[i].shortcut();
+        if (const auto pointerShortcut = std::get_if<PointerButtonShortcut>(&shortcut)) {
+            m_pointerShortcuts.insert(lookupKey(pointerShortcut->pointerModifiers, pointerShortcut->pointerButtons.toInt()), i);
+        } else if (const auto axisShortcut = std::get_if<PointerAxisShortcut>(&shortcut)) {
+            m_axisShortcuts.insert(lookupKey(axisShortcut->axisModifiers, axisShortcut->axisDirection), i);
+        }
+    }
 }
 
 bool GlobalShortcutsManager::addIfNotExists(GlobalShortcut sc, DeviceType device)
@@ -136,6 +156,7 @@ bool GlobalShortcutsManager::addIfNotExists(GlobalShortcut sc, DeviceType device
     }
     connect(sc.action(), &QAction::destroyed, this, &GlobalShortcutsManager::objectDeleted);
     m_shortcuts.push_back(std::move(sc));
+    rebuildLookupTables();
     return true;
 }
 
@@ -176,6 +197,7 @@ void GlobalShortcutsManager::forceRegisterTouchscreenSwipe(SwipeDirection direct
     m_touchscreenGestureRecognizer->registerSwipeGesture(shortcut.swipeGesture());
     connect(shortcut.action(), &QAction::destroyed, this, &GlobalShortcutsManager::objectDeleted);
     m_shortcuts.push_back(std::move(shortcut));
+    rebuildLookupTables();
 }
 
 bool GlobalShortcutsManager::processKey(Qt::KeyboardModifiers mods, int keyQt)
@@ -225,29 +247,24 @@ bool GlobalShortcutsManager::processKeyRelease(Qt::KeyboardModifiers mods, int k
     return false;
 }
 
-template<typename ShortcutKind, typename... Args>
-bool match(QVector<GlobalShortcut> &shortcuts, Args... args)
-{
-    for (auto &sc : shortcuts) {
-        if (std::holds_alternative<ShortcutKind>(sc.shortcut())) {
-            if (std::get<ShortcutKind>(sc.shortcut()) == ShortcutKind{args...}) {
-                sc.invoke();
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
-// TODO(C++20): use ranges for a nicer way of filtering by shortcut type
 bool GlobalShortcutsManager::processPointerPressed(Qt::KeyboardModifiers mods, Qt::MouseButtons pointerButtons)
 {
-    return match<PointerButtonShortcut>(m_shortcuts, mods, pointerButtons);
+    const auto it = m_pointerShortcuts.constFind(lookupKey(mods, pointerButtons.toInt()));
+    if (it == m_pointerShortcuts.constEnd()) {
+        return false;
+    }
+    m_shortcuts[*it].invoke();
+    return true;
 }
 
 bool GlobalShortcutsManager::processAxis(Qt::KeyboardModifiers mods, PointerAxisDirection axis)
 {
-    return match<PointerAxisShortcut>(m_shortcuts, mods, axis);
+    const auto it = m_axisShortcuts.constFind(lookupKey(mods, axis));
+    if (it == m_axisShortcuts.constEnd()) {
+        return false;
+    }
+    m_shortcuts[*it].invoke();
+    return true;
 }
 
 void GlobalShortcutsManager::processSwipeStart(DeviceType device, uint fingerCount)
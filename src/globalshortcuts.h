@@ -10,6 +10,7 @@
 // KWin
 #include "libkwineffects/kwinglobals.h"
 // Qt
+#include <QHash>
 #include <QKeySequence>
 
 #include <memory>
@@ -114,8 +115,13 @@ public:
 private:
     void objectDeleted(QObject *object);
     bool addIfNotExists(GlobalShortcut sc, DeviceType device = DeviceType::Touchpad);
+    void rebuildLookupTables();
 
     QVector<GlobalShortcut> m_shortcuts;
+    // the indices of the pointer and axis shortcuts in m_shortcuts, keyed by the modifiers and
+    // the buttons or the axis, so pointer events don't have to walk all shortcuts
+    QHash<quint64, int> m_pointerShortcuts;
+    QHash<quint64, int> m_axisShortcuts;
 
     std::unique_ptr<KGlobalAccelD> m_kglobalAccel;
     KGlobalAccelInterface *m_kglobalAccelInterface = nullptr;
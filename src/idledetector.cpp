@@ -7,18 +7,17 @@
 #include "idledetector.h"
 #include "input.h"
 
+#include <algorithm>
+#include <optional>
+
 namespace KWin
 {
 
 IdleDetector::IdleDetector(std::chrono::milliseconds timeout, QObject *parent)
     : QObject(parent)
-    , m_timer(new QTimer(this))
+    , m_timeout(timeout)
+    , m_since(std::chrono::steady_clock::now())
 {
-    m_timer->setSingleShot(true);
-    m_timer->setInterval(timeout);
-    connect(m_timer, &QTimer::timeout, this, &IdleDetector::markAsIdle);
-    m_timer->start();
-
     input()->addIdleDetector(this);
 }
 
@@ -40,18 +39,26 @@ void IdleDetector::setInhibited(bool inhibited)
         return;
     }
     m_isInhibited = inhibited;
-    if (inhibited) {
-        m_timer->stop();
-    } else {
-        m_timer->start();
+    if (!inhibited) {
+        // the timeout starts over
+        m_since = std::chrono::steady_clock::now();
+    }
+    if (m_scheduler) {
+        m_scheduler->reschedule();
     }
 }
 
 void IdleDetector::activity()
 {
     if (!m_isInhibited) {
-        m_timer->start();
+        m_since = std::chrono::steady_clock::now();
+        if (m_scheduler) {
+            m_scheduler->m_idleDetectors.removeOne(this);
+        }
         markAsResumed();
+        if (m_scheduler) {
+            m_scheduler->reschedule();
+        }
     }
 }
 
@@ -71,4 +78,103 @@ void IdleDetector::markAsResumed()
     }
 }
 
+IdleScheduler::IdleScheduler(QObject *parent)
+    : QObject(parent)
+    , m_lastActivity(std::chrono::steady_clock::now())
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &IdleScheduler::checkDeadlines);
+}
+
+IdleScheduler::~IdleScheduler()
+{
+    for (IdleDetector *detector : std::as_const(m_detectors)) {
+        detector->m_scheduler = nullptr;
+    }
+}
+
+void IdleScheduler::add(IdleDetector *detector)
+{
+    Q_ASSERT(!m_detectors.contains(detector));
+    detector->m_scheduler = this;
+    m_detectors.append(detector);
+    reschedule();
+}
+
+void IdleScheduler::remove(IdleDetector *detector)
+{
+    if (m_detectors.removeOne(detector)) {
+        m_idleDetectors.removeOne(detector);
+        detector->m_scheduler = nullptr;
+    }
+}
+
+QList<IdleDetector *> IdleScheduler::detectors() const
+{
+    return m_detectors;
+}
+
+void IdleScheduler::activity()
+{
+    m_lastActivity = std::chrono::steady_clock::now();
+    if (m_idleDetectors.isEmpty()) {
+        // the timer fires at a deadline that is too early now, and is armed again then
+        return;
+    }
+
+    const QList<IdleDetector *> idleDetectors = m_idleDetectors;
+    for (IdleDetector *detector : idleDetectors) {
+        // the slots connected to resumed() may remove other detectors
+        if (!m_detectors.contains(detector) || detector->m_isInhibited) {
+            continue;
+        }
+        m_idleDetectors.removeOne(detector);
+        detector->markAsResumed();
+    }
+    reschedule();
+}
+
+std::chrono::steady_clock::time_point IdleScheduler::deadline(const IdleDetector *detector) const
+{
+    return std::max(m_lastActivity, detector->m_since) + detector->m_timeout;
+}
+
+void IdleScheduler::reschedule()
+{
+    std::optional<std::chrono::steady_clock::time_point> next;
+    for (const IdleDetector *detector : std::as_const(m_detectors)) {
+        if (detector->m_isIdle || detector->m_isInhibited) {
+            continue;
+        }
+        const auto detectorDeadline = deadline(detector);
+        if (!next || detectorDeadline < *next) {
+            next = detectorDeadline;
+        }
+    }
+    if (!next) {
+        m_timer.stop();
+        return;
+    }
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*next - std::chrono::steady_clock::now());
+    m_timer.start(std::max(remaining, std::chrono::milliseconds::zero()));
+}
+
+void IdleScheduler::checkDeadlines()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const QList<IdleDetector *> detectors = m_detectors;
+    for (IdleDetector *detector : detectors) {
+        // the slots connected to idle() may remove other detectors
+        if (!m_detectors.contains(detector) || detector->m_isIdle || detector->m_isInhibited) {
+            continue;
+        }
+        if (deadline(detector) <= now) {
+            m_idleDetectors.append(detector);
+            detector->markAsIdle();
+        }
+    }
+    reschedule();
+}
+
 } // namespace KWin
@@ -10,9 +10,13 @@
 
 #include <QTimer>
 
+#include <chrono>
+
 namespace KWin
 {
 
+class IdleScheduler;
+
 class KWIN_EXPORT IdleDetector : public QObject
 {
     Q_OBJECT
@@ -34,9 +38,51 @@ private:
     void markAsIdle();
     void markAsResumed();
 
-    QTimer *m_timer;
+    IdleScheduler *m_scheduler = nullptr;
+    const std::chrono::milliseconds m_timeout;
+    // when the detector was created, uninhibited or explicitly told about activity
+    std::chrono::steady_clock::time_point m_since;
     bool m_isIdle = false;
     bool m_isInhibited = false;
+
+    friend class IdleScheduler;
+};
+
+/**
+ * The IdleScheduler class drives all idle detectors with a single timer that is armed for the
+ * nearest deadline. User activity only records a timestamp and resumes the detectors that are
+ * idle, the timer is not touched. When it fires, the detectors whose deadlines have passed
+ * become idle, and the timer is armed for the next deadline.
+ */
+class KWIN_EXPORT IdleScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IdleScheduler(QObject *parent = nullptr);
+    ~IdleScheduler() override;
+
+    void add(IdleDetector *detector);
+    void remove(IdleDetector *detector);
+    QList<IdleDetector *> detectors() const;
+
+    /**
+     * Marks that the user has done something, e.g. moved the pointer.
+     */
+    void activity();
+
+private:
+    void reschedule();
+    void checkDeadlines();
+    std::chrono::steady_clock::time_point deadline(const IdleDetector *detector) const;
+
+    QTimer m_timer;
+    std::chrono::steady_clock::time_point m_lastActivity;
+    QList<IdleDetector *> m_detectors;
+    // the detectors that may need to be resumed on activity
+    QList<IdleDetector *> m_idleDetectors;
+
+    friend class IdleDetector;
 };
 
 } // namespace KWin
@@ -22,6 +22,7 @@
 #include "idledetector.h"
 #include "input_event.h"
 #include "input_event_spy.h"
+#include "inputlatencymonitor.h"
 #include "inputmethod.h"
 #include "keyboard_input.h"
 #include "main.h"
@@ -48,6 +49,7 @@
 #include "wayland/surface_interface.h"
 #include "wayland/tablet_v2_interface.h"
 #include "wayland_server.h"
+#include "windowhittestindex.h"
 #include "workspace.h"
 #include "xkb.h"
 #include "xwayland/xwayland_interface.h"
@@ -97,7 +99,10 @@ static KWaylandServer::PointerAxisSource kwinAxisSourceToKWaylandAxisSource(Inpu
     }
 }
 
-InputEventFilter::InputEventFilter() = default;
+InputEventFilter::InputEventFilter(EventTypes eventTypes)
+    : m_eventTypes(eventTypes)
+{
+}
 
 InputEventFilter::~InputEventFilter()
 {
@@ -111,6 +116,11 @@ bool InputEventFilter::pointerEvent(MouseEvent *event, quint32 nativeButton)
     return false;
 }
 
+bool InputEventFilter::handlesLockedPointerMotion() const
+{
+    return true;
+}
+
 bool InputEventFilter::wheelEvent(WheelEvent *event)
 {
     return false;
@@ -262,7 +272,11 @@ bool InputEventFilter::passToInputMethod(QKeyEvent *event)
             return true;
         }
         auto newState = event->type() == QEvent::KeyPress ? KWaylandServer::KeyboardKeyState::Pressed : KWaylandServer::KeyboardKeyState::Released;
-        keyboardGrab->sendKey(waylandServer()->display()->nextSerial(), event->timestamp(), event->nativeScanCode(), newState);
+        const quint32 serial = waylandServer()->display()->nextSerial();
+        keyboardGrab->sendKey(serial, event->timestamp(), event->nativeScanCode(), newState);
+        if (newState == KWaylandServer::KeyboardKeyState::Pressed) {
+            kwinApp()->inputMethod()->trackKeyPress(serial);
+        }
         return true;
     } else {
         return false;
@@ -272,6 +286,11 @@ bool InputEventFilter::passToInputMethod(QKeyEvent *event)
 class VirtualTerminalFilter : public InputEventFilter
 {
 public:
+    VirtualTerminalFilter()
+        : InputEventFilter(KeyEvents)
+    {
+    }
+
     bool keyEvent(KeyEvent *event) override
     {
         // really on press and not on release? X11 switches on press.
@@ -289,6 +308,11 @@ public:
 class TerminateServerFilter : public InputEventFilter
 {
 public:
+    TerminateServerFilter()
+        : InputEventFilter(KeyEvents)
+    {
+    }
+
     bool keyEvent(KeyEvent *event) override
     {
         if (event->type() == QEvent::KeyPress && !event->isAutoRepeat()) {
@@ -305,6 +329,15 @@ public:
 class LockScreenFilter : public InputEventFilter
 {
 public:
+    LockScreenFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | KeyEvents | TouchEvents | GestureEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return waylandServer()->isScreenLocked();
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         if (!waylandServer()->isScreenLocked()) {
@@ -509,6 +542,15 @@ private:
 class EffectsFilter : public InputEventFilter
 {
 public:
+    EffectsFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | KeyEvents | TouchEvents | TabletToolEvents | TabletPadEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return effects && static_cast<EffectsHandlerImpl *>(effects)->isMouseInterception();
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         if (!effects) {
@@ -594,6 +636,15 @@ public:
 class MoveResizeFilter : public InputEventFilter
 {
 public:
+    MoveResizeFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | KeyEvents | TouchEvents | TabletToolEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return workspace()->moveResizeWindow() != nullptr;
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         Window *window = workspace()->moveResizeWindow();
@@ -704,6 +755,15 @@ private:
 class WindowSelectorFilter : public InputEventFilter
 {
 public:
+    WindowSelectorFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | KeyEvents | TouchEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return m_active;
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         if (!m_active) {
@@ -870,11 +930,16 @@ class GlobalShortcutFilter : public InputEventFilter
 {
 public:
     GlobalShortcutFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | KeyEvents | TouchEvents | GestureEvents)
     {
         m_powerDown.setSingleShot(true);
         m_powerDown.setInterval(1000);
     }
 
+    bool handlesLockedPointerMotion() const override
+    {
+        return false;
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         if (event->type() == QEvent::MouseButtonPress) {
@@ -1037,7 +1102,7 @@ public:
             if (m_touchPoints.count() >= 3 && !m_gestureCancelled) {
                 m_gestureTaken = true;
                 m_syntheticCancel = true;
-                input()->processFilters(std::bind(&InputEventFilter::touchCancel, std::placeholders::_1));
+                input()->processFilters(InputEventFilter::TouchEvents, std::bind(&InputEventFilter::touchCancel, std::placeholders::_1));
                 m_syntheticCancel = false;
                 input()->shortcuts()->processSwipeStart(DeviceType::Touchscreen, m_touchPoints.count());
                 return true;
@@ -1177,6 +1242,16 @@ std::pair<bool, bool> performWindowWheelAction(QWheelEvent *event, Window *windo
 
 class InternalWindowEventFilter : public InputEventFilter
 {
+public:
+    InternalWindowEventFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | KeyEvents | TouchEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return input()->pointer()->focus() && input()->pointer()->focus()->isInternal();
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         if (!input()->pointer()->focus() || !input()->pointer()->focus()->isInternal()) {
@@ -1373,6 +1448,15 @@ private:
 class DecorationEventFilter : public InputEventFilter
 {
 public:
+    DecorationEventFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | TouchEvents | TabletToolEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return input()->pointer()->decoration() != nullptr;
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         auto decoration = input()->pointer()->decoration();
@@ -1587,6 +1671,15 @@ private:
 class TabBoxInputFilter : public InputEventFilter
 {
 public:
+    TabBoxInputFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | KeyEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return workspace()->tabbox() && workspace()->tabbox()->isGrabbed();
+    }
     bool pointerEvent(MouseEvent *event, quint32 button) override
     {
         if (!workspace()->tabbox() || !workspace()->tabbox()->isGrabbed()) {
@@ -1626,6 +1719,15 @@ public:
 class ScreenEdgeInputFilter : public InputEventFilter
 {
 public:
+    ScreenEdgeInputFilter()
+        : InputEventFilter(PointerEvents | TouchEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return false;
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         workspace()->screenEdges()->isEntered(event);
@@ -1682,6 +1784,15 @@ private:
 class WindowActionInputFilter : public InputEventFilter
 {
 public:
+    WindowActionInputFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | TouchEvents | TabletToolEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return false;
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         if (event->type() != QEvent::MouseButtonPress) {
@@ -1751,6 +1862,11 @@ public:
 class InputKeyboardFilter : public InputEventFilter
 {
 public:
+    InputKeyboardFilter()
+        : InputEventFilter(KeyEvents)
+    {
+    }
+
     bool keyEvent(KeyEvent *event) override
     {
         return passToInputMethod(event);
@@ -1763,6 +1879,15 @@ public:
 class ForwardInputFilter : public InputEventFilter
 {
 public:
+    ForwardInputFilter()
+        : InputEventFilter(PointerEvents | WheelEvents | KeyEvents | TouchEvents | GestureEvents)
+    {
+    }
+
+    bool handlesLockedPointerMotion() const override
+    {
+        return false;
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         auto seat = waylandServer()->seat();
@@ -1771,7 +1896,11 @@ public:
         case QEvent::MouseMove: {
             seat->notifyPointerMotion(event->globalPos());
             MouseEvent *e = static_cast<MouseEvent *>(event);
-            if (!e->delta().isNull()) {
+            if (const auto history = e->motionHistory(); !history.isEmpty()) {
+                for (const PointerMotionSample &sample : history) {
+                    seat->relativePointerMotion(sample.delta, sample.deltaNonAccelerated, sample.time);
+                }
+            } else if (!e->delta().isNull()) {
                 seat->relativePointerMotion(e->delta(), e->deltaUnaccelerated(), e->timestamp());
             }
             seat->notifyPointerFrame();
@@ -1999,6 +2128,7 @@ class TabletInputFilter : public QObject, public InputEventFilter
 {
 public:
     TabletInputFilter()
+        : InputEventFilter(TabletToolEvents | TabletPadEvents)
     {
         const auto devices = input()->devices();
         for (InputDevice *device : devices) {
@@ -2379,12 +2509,17 @@ class DragAndDropInputFilter : public QObject, public InputEventFilter
     Q_OBJECT
 public:
     DragAndDropInputFilter()
+        : InputEventFilter(PointerEvents | KeyEvents | TouchEvents)
     {
         m_raiseTimer.setSingleShot(true);
         m_raiseTimer.setInterval(250);
         connect(&m_raiseTimer, &QTimer::timeout, this, &DragAndDropInputFilter::raiseDragTarget);
     }
 
+    bool handlesLockedPointerMotion() const override
+    {
+        return waylandServer()->seat()->isDragPointer();
+    }
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override
     {
         auto seat = waylandServer()->seat();
@@ -2598,6 +2733,7 @@ InputRedirection::InputRedirection(QObject *parent)
     , m_tablet(new TabletInputRedirection(this))
     , m_touch(new TouchInputRedirection(this))
     , m_shortcuts(new GlobalShortcutsManager(this))
+    , m_idleScheduler(new IdleScheduler(this))
 {
     qRegisterMetaType<KWin::InputRedirection::KeyboardKeyState>();
     qRegisterMetaType<KWin::InputRedirection::PointerButtonState>();
@@ -2620,17 +2756,42 @@ void InputRedirection::installInputEventFilter(InputEventFilter *filter)
 {
     Q_ASSERT(!m_filters.contains(filter));
     m_filters << filter;
+    updateFilterTable();
 }
 
 void InputRedirection::prependInputEventFilter(InputEventFilter *filter)
 {
     Q_ASSERT(!m_filters.contains(filter));
     m_filters.prepend(filter);
+    updateFilterTable();
 }
 
 void InputRedirection::uninstallInputEventFilter(InputEventFilter *filter)
 {
-    m_filters.removeOne(filter);
+    if (m_filters.removeOne(filter)) {
+        updateFilterTable();
+    }
+}
+
+void InputRedirection::updateFilterTable()
+{
+    for (int i = 0; i < InputEventFilter::EventTypeCount; ++i) {
+        QList<InputEventFilter *> filters;
+        for (InputEventFilter *filter : std::as_const(m_filters)) {
+            if (filter->eventTypes() & InputEventFilter::EventType(1 << i)) {
+                filters.append(filter);
+            }
+        }
+        m_filterTable[i] = filters;
+    }
+}
+
+bool InputRedirection::canForwardLockedPointerMotion() const
+{
+    const QList<InputEventFilter *> &filters = m_filterTable[std::countr_zero(uint(InputEventFilter::PointerEvents))];
+    return std::none_of(filters.cbegin(), filters.cend(), [](const InputEventFilter *filter) {
+        return filter->handlesLockedPointerMotion();
+    });
 }
 
 void InputRedirection::installInputEventSpy(InputEventSpy *spy)
@@ -2655,6 +2816,7 @@ void InputRedirection::init()
 void InputRedirection::setupWorkspace()
 {
     connect(workspace(), &Workspace::outputsChanged, this, &InputRedirection::updateScreens);
+    m_hitTestIndex = new WindowHitTestIndex(this);
     if (waylandServer()) {
         m_keyboard->init();
         m_pointer->init();
@@ -2859,6 +3021,8 @@ void InputRedirection::setupInputFilters()
     installInputEventSpy(new HideCursorSpy);
     installInputEventSpy(new UserActivitySpy);
     installInputEventSpy(new WindowInteractedSpy);
+    m_latencyMonitor = new InputLatencyMonitor;
+    installInputEventSpy(m_latencyMonitor);
     if (hasGlobalShortcutSupport) {
         installInputEventFilter(new TerminateServerFilter);
     }
@@ -2912,6 +3076,8 @@ void InputRedirection::addInputDevice(InputDevice *device)
             m_pointer, &PointerInputRedirection::processMotionAbsolute);
     connect(device, &InputDevice::pointerMotion,
             m_pointer, &PointerInputRedirection::processMotion);
+    connect(device, &InputDevice::pointerMotionCoalesced,
+            m_pointer, &PointerInputRedirection::processMotionCoalesced);
     connect(device, &InputDevice::pointerButtonChanged,
             m_pointer, &PointerInputRedirection::processButton);
     connect(device, &InputDevice::pointerAxisChanged,
@@ -2948,7 +3114,7 @@ void InputRedirection::addInputDevice(InputDevice *device)
     auto handleSwitchEvent = [this](SwitchEvent::State state, std::chrono::microseconds time, InputDevice *device) {
         SwitchEvent event(state, time, device);
         processSpies(std::bind(&InputEventSpy::switchEvent, std::placeholders::_1, &event));
-        processFilters(std::bind(&InputEventFilter::switchEvent, std::placeholders::_1, &event));
+        processFilters(InputEventFilter::SwitchEvents, std::bind(&InputEventFilter::switchEvent, std::placeholders::_1, &event));
     };
     connect(device, &InputDevice::switchToggledOn, this,
             std::bind(handleSwitchEvent, SwitchEvent::State::On, std::placeholders::_1, std::placeholders::_2));
@@ -3141,21 +3307,18 @@ Qt::MouseButtons InputRedirection::qtButtonStates() const
 
 void InputRedirection::simulateUserActivity()
 {
-    for (IdleDetector *idleDetector : std::as_const(m_idleDetectors)) {
-        idleDetector->activity();
-    }
+    m_idleScheduler->activity();
 }
 
 void InputRedirection::addIdleDetector(IdleDetector *detector)
 {
-    Q_ASSERT(!m_idleDetectors.contains(detector));
     detector->setInhibited(!m_idleInhibitors.isEmpty());
-    m_idleDetectors.append(detector);
+    m_idleScheduler->add(detector);
 }
 
 void InputRedirection::removeIdleDetector(IdleDetector *detector)
 {
-    m_idleDetectors.removeOne(detector);
+    m_idleScheduler->remove(detector);
 }
 
 QList<Window *> InputRedirection::idleInhibitors() const
@@ -3167,7 +3330,8 @@ void InputRedirection::addIdleInhibitor(Window *inhibitor)
 {
     if (!m_idleInhibitors.contains(inhibitor)) {
         m_idleInhibitors.append(inhibitor);
-        for (IdleDetector *idleDetector : std::as_const(m_idleDetectors)) {
+        const QList<IdleDetector *> idleDetectors = m_idleScheduler->detectors();
+        for (IdleDetector *idleDetector : idleDetectors) {
             idleDetector->setInhibited(true);
         }
     }
@@ -3176,7 +3340,8 @@ void InputRedirection::addIdleInhibitor(Window *inhibitor)
 void InputRedirection::removeIdleInhibitor(Window *inhibitor)
 {
     if (m_idleInhibitors.removeOne(inhibitor) && m_idleInhibitors.isEmpty()) {
-        for (IdleDetector *idleDetector : std::as_const(m_idleDetectors)) {
+        const QList<IdleDetector *> idleDetectors = m_idleScheduler->detectors();
+        for (IdleDetector *idleDetector : idleDetectors) {
             idleDetector->setInhibited(false);
         }
     }
@@ -3194,33 +3359,40 @@ Window *InputRedirection::findToplevel(const QPointF &pos)
             return nullptr;
         }
     }
-    const QList<Window *> &stacking = Workspace::self()->stackingOrder();
-    if (stacking.isEmpty()) {
-        return nullptr;
-    }
-    auto it = stacking.end();
-    do {
-        --it;
-        Window *window = (*it);
+    const auto accepts = [isScreenLocked, &pos](Window *window) {
         if (window->isDeleted()) {
             // a deleted window doesn't get mouse events
-            continue;
+            return false;
         }
         if (!window->isOnCurrentActivity() || !window->isOnCurrentDesktop() || window->isMinimized() || window->isHiddenInternal()) {
-            continue;
+            return false;
         }
         if (!window->readyForPainting()) {
-            continue;
+            return false;
         }
         if (isScreenLocked) {
             if (!window->isLockScreen() && !window->isInputMethod() && !window->isLockScreenOverlay()) {
-                continue;
+                return false;
             }
         }
-        if (window->hitTest(pos)) {
-            return window;
+        return window->hitTest(pos);
+    };
+    if (m_hitTestIndex && m_hitTestIndex->covers(pos)) {
+        for (Window *window : m_hitTestIndex->candidates(pos)) {
+            if (accepts(window)) {
+                return window;
+            }
+        }
+        return nullptr;
+    }
+    // the index only covers the outputs, positions outside of them need a walk of the windows
+    // on the current desktop
+    const QList<Window *> stacking = Workspace::self()->windowsOn(VirtualDesktopManager::self()->currentDesktop());
+    for (auto it = stacking.crbegin(); it != stacking.crend(); ++it) {
+        if (accepts(*it)) {
+            return *it;
         }
-    } while (it != stacking.begin());
+    }
     return nullptr;
 }
 
@@ -20,6 +20,9 @@
 #include <KSharedConfig>
 #include <QSet>
 
+#include <array>
+#include <bit>
+#include <chrono>
 #include <functional>
 
 class KGlobalAccelInterface;
@@ -32,6 +35,7 @@ class QWheelEvent;
 namespace KWin
 {
 class IdleDetector;
+class IdleScheduler;
 class Window;
 class GlobalShortcutsManager;
 class InputEventFilter;
@@ -41,6 +45,8 @@ class PointerInputRedirection;
 class TabletInputRedirection;
 class TouchInputRedirection;
 class WindowSelectorFilter;
+class WindowHitTestIndex;
+class InputLatencyMonitor;
 class SwitchEvent;
 class TabletEvent;
 class TabletToolId;
@@ -57,6 +63,141 @@ class DecoratedClientImpl;
 class InputBackend;
 class InputDevice;
 
+/**
+ * One relative motion event as it was reported by the device. Consecutive motion events are
+ * merged before they're processed, the individual samples are kept for clients that need
+ * them, e.g. relative pointer motion.
+ */
+struct PointerMotionSample
+{
+    QPointF delta;
+    QPointF deltaNonAccelerated;
+    std::chrono::microseconds time;
+};
+
+/**
+ * Base class for filtering input events inside InputRedirection.
+ *
+ * The idea behind the InputEventFilter is to have task oriented
+ * filters. E.g. there is one filter taking care of a locked screen,
+ * one to take care of interacting with window decorations, etc.
+ *
+ * A concrete subclass can reimplement the virtual methods and decide
+ * whether an event should be filtered out or not by returning either
+ * @c true or @c false. E.g. the lock screen filter can easily ensure
+ * that all events are filtered out.
+ *
+ * As soon as a filter returns @c true the processing is stopped. If
+ * a filter returns @c false the next one is invoked. This means a filter
+ * installed early gets to see more events than a filter installed later on.
+ *
+ * Deleting an instance of InputEventFilter automatically uninstalls it from
+ * InputRedirection.
+ *
+ * A filter declares the kinds of events it is interested in when it's constructed,
+ * InputRedirection doesn't invoke it for any other kind of event.
+ */
+class KWIN_EXPORT InputEventFilter
+{
+public:
+    enum EventType {
+        PointerEvents = 1 << 0,
+        WheelEvents = 1 << 1,
+        KeyEvents = 1 << 2,
+        TouchEvents = 1 << 3,
+        GestureEvents = 1 << 4,
+        SwitchEvents = 1 << 5,
+        TabletToolEvents = 1 << 6,
+        TabletPadEvents = 1 << 7,
+        AllEvents = 0xff,
+    };
+    Q_DECLARE_FLAGS(EventTypes, EventType)
+    static constexpr int EventTypeCount = 8;
+
+    explicit InputEventFilter(EventTypes eventTypes = AllEvents);
+    virtual ~InputEventFilter();
+
+    /**
+     * Returns the kinds of events this filter gets invoked for.
+     */
+    EventTypes eventTypes() const
+    {
+        return m_eventTypes;
+    }
+
+    /**
+     * Event filter for pointer events which can be described by a QMouseEvent.
+     *
+     * Please note that the button translation in QMouseEvent cannot cover all
+     * possible buttons. Because of that also the @p nativeButton code is passed
+     * through the filter. For internal areas it's fine to use @p event, but for
+     * passing to client windows the @p nativeButton should be used.
+     *
+     * @param event The event information about the move or button press/release
+     * @param nativeButton The native key code of the button, for move events 0
+     * @return @c true to stop further event processing, @c false to pass to next filter
+     */
+    virtual bool pointerEvent(MouseEvent *event, quint32 nativeButton);
+    /**
+     * Returns @c true if the filter may handle the motion of a locked pointer right now. While
+     * none of the pointer event filters does, the relative motion of a locked pointer is sent
+     * to the client without going through the filter chain.
+     *
+     * The default implementation returns @c true.
+     */
+    virtual bool handlesLockedPointerMotion() const;
+    /**
+     * Event filter for pointer axis events.
+     *
+     * @param event The event information about the axis event
+     * @return @c true to stop further event processing, @c false to pass to next filter
+     */
+    virtual bool wheelEvent(WheelEvent *event);
+    /**
+     * Event filter for keyboard events.
+     *
+     * @param event The event information about the key event
+     * @return @c true to stop further event processing, @c false to pass to next filter.
+     */
+    virtual bool keyEvent(KeyEvent *event);
+    virtual bool touchDown(qint32 id, const QPointF &pos, std::chrono::microseconds time);
+    virtual bool touchMotion(qint32 id, const QPointF &pos, std::chrono::microseconds time);
+    virtual bool touchUp(qint32 id, std::chrono::microseconds time);
+    virtual bool touchCancel();
+    virtual bool touchFrame();
+
+    virtual bool pinchGestureBegin(int fingerCount, std::chrono::microseconds time);
+    virtual bool pinchGestureUpdate(qreal scale, qreal angleDelta, const QPointF &delta, std::chrono::microseconds time);
+    virtual bool pinchGestureEnd(std::chrono::microseconds time);
+    virtual bool pinchGestureCancelled(std::chrono::microseconds time);
+
+    virtual bool swipeGestureBegin(int fingerCount, std::chrono::microseconds time);
+    virtual bool swipeGestureUpdate(const QPointF &delta, std::chrono::microseconds time);
+    virtual bool swipeGestureEnd(std::chrono::microseconds time);
+    virtual bool swipeGestureCancelled(std::chrono::microseconds time);
+
+    virtual bool holdGestureBegin(int fingerCount, std::chrono::microseconds time);
+    virtual bool holdGestureEnd(std::chrono::microseconds time);
+    virtual bool holdGestureCancelled(std::chrono::microseconds time);
+
+    virtual bool switchEvent(SwitchEvent *event);
+
+    virtual bool tabletToolEvent(TabletEvent *event);
+    virtual bool tabletToolButtonEvent(uint button, bool pressed, const TabletToolId &tabletToolId, std::chrono::microseconds time);
+    virtual bool tabletPadButtonEvent(uint button, bool pressed, const TabletPadId &tabletPadId, std::chrono::microseconds time);
+    virtual bool tabletPadStripEvent(int number, int position, bool isFinger, const TabletPadId &tabletPadId, std::chrono::microseconds time);
+    virtual bool tabletPadRingEvent(int number, int position, bool isFinger, const TabletPadId &tabletPadId, std::chrono::microseconds time);
+
+protected:
+    void passToWaylandServer(QKeyEvent *event);
+    bool passToInputMethod(QKeyEvent *event);
+
+private:
+    const EventTypes m_eventTypes;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(InputEventFilter::EventTypes)
+
 /**
  * @brief This class is responsible for redirecting incoming input to the surface which currently
  * has input or send enter/leave events.
@@ -146,6 +287,14 @@ public:
     void prependInputEventFilter(InputEventFilter *filter);
     void uninstallInputEventFilter(InputEventFilter *filter);
 
+    /**
+     * Returns @c true if none of the installed pointer event filters would handle the motion
+     * of a locked pointer.
+     *
+     * @see InputEventFilter::handlesLockedPointerMotion
+     */
+    bool canForwardLockedPointerMotion() const;
+
     /**
      * Installs the @p spy for spying on events.
      */
@@ -172,7 +321,16 @@ public:
     }
 
     /**
-     * Sends an event through all InputFilters.
+     * Returns the monitor of the input to presentation latency, or @c null if the latency
+     * can't be measured, e.g. on X11.
+     */
+    InputLatencyMonitor *latencyMonitor() const
+    {
+        return m_latencyMonitor;
+    }
+
+    /**
+     * Sends an event through all InputFilters that handle events of the given @p type.
      * The method @p function is invoked on each input filter. Processing is stopped if
      * a filter returns @c true for @p function.
      *
@@ -186,9 +344,11 @@ public:
      * bind.
      */
     template<class UnaryPredicate>
-    void processFilters(UnaryPredicate function)
+    void processFilters(InputEventFilter::EventType type, UnaryPredicate function)
     {
-        std::any_of(m_filters.constBegin(), m_filters.constEnd(), function);
+        // a copy, a filter can get uninstalled while the event is being processed
+        const QList<InputEventFilter *> filters = m_filterTable[std::countr_zero(uint(type))];
+        std::any_of(filters.constBegin(), filters.constEnd(), function);
     }
 
     /**
@@ -312,6 +472,7 @@ private:
     void updateLeds(LEDs leds);
     void updateAvailableInputDevices();
     void addInputBackend(std::unique_ptr<InputBackend> &&inputBackend);
+    void updateFilterTable();
     KeyboardInputRedirection *m_keyboard;
     PointerInputRedirection *m_pointer;
     TabletInputRedirection *m_tablet;
@@ -323,11 +484,15 @@ private:
     std::vector<std::unique_ptr<InputBackend>> m_inputBackends;
     QList<InputDevice *> m_inputDevices;
 
-    QList<IdleDetector *> m_idleDetectors;
+    IdleScheduler *m_idleScheduler;
     QList<Window *> m_idleInhibitors;
     WindowSelectorFilter *m_windowSelector = nullptr;
+    WindowHitTestIndex *m_hitTestIndex = nullptr;
+    InputLatencyMonitor *m_latencyMonitor = nullptr;
 
     QVector<InputEventFilter *> m_filters;
+    // the installed filters split up by the kinds of events they handle, in installation order
+    std::array<QList<InputEventFilter *>, InputEventFilter::EventTypeCount> m_filterTable;
     QVector<InputEventSpy *> m_spies;
     KConfigWatcher::Ptr m_inputConfigWatcher;
 
@@ -346,91 +511,6 @@ private:
     friend class ForwardInputFilter;
 };
 
-/**
- * Base class for filtering input events inside InputRedirection.
- *
- * The idea behind the InputEventFilter is to have task oriented
- * filters. E.g. there is one filter taking care of a locked screen,
- * one to take care of interacting with window decorations, etc.
- *
- * A concrete subclass can reimplement the virtual methods and decide
- * whether an event should be filtered out or not by returning either
- * @c true or @c false. E.g. the lock screen filter can easily ensure
- * that all events are filtered out.
- *
- * As soon as a filter returns @c true the processing is stopped. If
- * a filter returns @c false the next one is invoked. This means a filter
- * installed early gets to see more events than a filter installed later on.
- *
- * Deleting an instance of InputEventFilter automatically uninstalls it from
- * InputRedirection.
- */
-class KWIN_EXPORT InputEventFilter
-{
-public:
-    InputEventFilter();
-    virtual ~InputEventFilter();
-
-    /**
-     * Event filter for pointer events which can be described by a QMouseEvent.
-     *
-     * Please note that the button translation in QMouseEvent cannot cover all
-     * possible buttons. Because of that also the @p nativeButton code is passed
-     * through the filter. For internal areas it's fine to use @p event, but for
-     * passing to client windows the @p nativeButton should be used.
-     *
-     * @param event The event information about the move or button press/release
-     * @param nativeButton The native key code of the button, for move events 0
-     * @return @c true to stop further event processing, @c false to pass to next filter
-     */
-    virtual bool pointerEvent(MouseEvent *event, quint32 nativeButton);
-    /**
-     * Event filter for pointer axis events.
-     *
-     * @param event The event information about the axis event
-     * @return @c true to stop further event processing, @c false to pass to next filter
-     */
-    virtual bool wheelEvent(WheelEvent *event);
-    /**
-     * Event filter for keyboard events.
-     *
-     * @param event The event information about the key event
-     * @return @c true to stop further event processing, @c false to pass to next filter.
-     */
-    virtual bool keyEvent(KeyEvent *event);
-    virtual bool touchDown(qint32 id, const QPointF &pos, std::chrono::microseconds time);
-    virtual bool touchMotion(qint32 id, const QPointF &pos, std::chrono::microseconds time);
-    virtual bool touchUp(qint32 id, std::chrono::microseconds time);
-    virtual bool touchCancel();
-    virtual bool touchFrame();
-
-    virtual bool pinchGestureBegin(int fingerCount, std::chrono::microseconds time);
-    virtual bool pinchGestureUpdate(qreal scale, qreal angleDelta, const QPointF &delta, std::chrono::microseconds time);
-    virtual bool pinchGestureEnd(std::chrono::microseconds time);
-    virtual bool pinchGestureCancelled(std::chrono::microseconds time);
-
-    virtual bool swipeGestureBegin(int fingerCount, std::chrono::microseconds time);
-    virtual bool swipeGestureUpdate(const QPointF &delta, std::chrono::microseconds time);
-    virtual bool swipeGestureEnd(std::chrono::microseconds time);
-    virtual bool swipeGestureCancelled(std::chrono::microseconds time);
-
-    virtual bool holdGestureBegin(int fingerCount, std::chrono::microseconds time);
-    virtual bool holdGestureEnd(std::chrono::microseconds time);
-    virtual bool holdGestureCancelled(std::chrono::microseconds time);
-
-    virtual bool switchEvent(SwitchEvent *event);
-
-    virtual bool tabletToolEvent(TabletEvent *event);
-    virtual bool tabletToolButtonEvent(uint button, bool pressed, const TabletToolId &tabletToolId, std::chrono::microseconds time);
-    virtual bool tabletPadButtonEvent(uint button, bool pressed, const TabletPadId &tabletPadId, std::chrono::microseconds time);
-    virtual bool tabletPadStripEvent(int number, int position, bool isFinger, const TabletPadId &tabletPadId, std::chrono::microseconds time);
-    virtual bool tabletPadRingEvent(int number, int position, bool isFinger, const TabletPadId &tabletPadId, std::chrono::microseconds time);
-
-protected:
-    void passToWaylandServer(QKeyEvent *event);
-    bool passToInputMethod(QKeyEvent *event);
-};
-
 class KWIN_EXPORT InputDeviceHandler : public QObject
 {
     Q_OBJECT
@@ -65,6 +65,20 @@ public:
         m_nativeButton = button;
     }
 
+    /**
+     * Returns the individual motion events that were merged into this event, or an empty
+     * list if the event corresponds to a single motion event.
+     */
+    QList<PointerMotionSample> motionHistory() const
+    {
+        return m_motionHistory;
+    }
+
+    void setMotionHistory(const QList<PointerMotionSample> &history)
+    {
+        m_motionHistory = history;
+    }
+
 private:
     QPointF m_delta;
     QPointF m_deltaUnccelerated;
@@ -72,6 +86,7 @@ private:
     InputDevice *m_device;
     Qt::KeyboardModifiers m_modifiersRelevantForShortcuts = Qt::KeyboardModifiers();
     quint32 m_nativeButton = 0;
+    QList<PointerMotionSample> m_motionHistory;
 };
 
 // TODO: Don't derive from QWheelEvent, this event is quite domain specific.
@@ -0,0 +1,222 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "inputlatencymonitor.h"
+#include "core/output.h"
+#include "core/renderloop.h"
+#include "input_event.h"
+#include "wayland/seat_interface.h"
+#include "wayland/subcompositor_interface.h"
+#include "wayland/surface_interface.h"
+#include "wayland_server.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <cmath>
+
+namespace KWin
+{
+
+void LatencyHistogram::add(std::chrono::microseconds latency)
+{
+    latency = std::max(latency, std::chrono::microseconds::zero());
+    const size_t bucket = std::min<size_t>(latency / bucketWidth, m_buckets.size() - 1);
+    m_buckets[bucket]++;
+    m_count++;
+    m_sum += latency;
+    m_max = std::max(m_max, latency);
+}
+
+void LatencyHistogram::reset()
+{
+    *this = LatencyHistogram();
+}
+
+uint LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+std::chrono::microseconds LatencyHistogram::mean() const
+{
+    return m_count ? m_sum / m_count : std::chrono::microseconds::zero();
+}
+
+std::chrono::microseconds LatencyHistogram::max() const
+{
+    return m_max;
+}
+
+std::chrono::microseconds LatencyHistogram::percentile(qreal fraction) const
+{
+    if (!m_count) {
+        return std::chrono::microseconds::zero();
+    }
+    const uint threshold = std::max<uint>(1, std::ceil(m_count * fraction));
+    uint seen = 0;
+    for (size_t i = 0; i < m_buckets.size() - 1; ++i) {
+        seen += m_buckets[i];
+        if (seen >= threshold) {
+            return std::min(m_max, bucketWidth * (i + 1));
+        }
+    }
+    return m_max;
+}
+
+QVariantMap LatencyHistogram::toVariantMap() const
+{
+    // the values are in microseconds
+    return QVariantMap{
+        {QStringLiteral("count"), m_count},
+        {QStringLiteral("mean"), qlonglong(mean().count())},
+        {QStringLiteral("p50"), qlonglong(percentile(0.5).count())},
+        {QStringLiteral("p90"), qlonglong(percentile(0.9).count())},
+        {QStringLiteral("p99"), qlonglong(percentile(0.99).count())},
+        {QStringLiteral("max"), qlonglong(m_max.count())},
+    };
+}
+
+static std::chrono::microseconds now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+InputLatencyMonitor::InputLatencyMonitor(QObject *parent)
+    : QObject(parent)
+{
+    connect(workspace(), &Workspace::outputRemoved, this, [this](Output *output) {
+        if (m_outputs.erase(output)) {
+            disconnect(output->renderLoop(), nullptr, this, nullptr);
+        }
+    });
+}
+
+InputLatencyMonitor::~InputLatencyMonitor() = default;
+
+void InputLatencyMonitor::pointerEvent(MouseEvent *event)
+{
+    handleEvent(waylandServer()->seat()->focusedPointerSurface(), event->timestamp());
+}
+
+void InputLatencyMonitor::wheelEvent(WheelEvent *event)
+{
+    handleEvent(waylandServer()->seat()->focusedPointerSurface(), event->timestamp());
+}
+
+void InputLatencyMonitor::keyEvent(KeyEvent *event)
+{
+    handleEvent(waylandServer()->seat()->focusedKeyboardSurface(), event->timestamp());
+}
+
+void InputLatencyMonitor::touchDown(qint32 id, const QPointF &pos, std::chrono::microseconds time)
+{
+    handleEvent(waylandServer()->seat()->focusedTouchSurface(), time);
+}
+
+void InputLatencyMonitor::touchMotion(qint32 id, const QPointF &pos, std::chrono::microseconds time)
+{
+    handleEvent(waylandServer()->seat()->focusedTouchSurface(), time);
+}
+
+void InputLatencyMonitor::touchUp(qint32 id, std::chrono::microseconds time)
+{
+    handleEvent(waylandServer()->seat()->focusedTouchSurface(), time);
+}
+
+void InputLatencyMonitor::handleEvent(KWaylandServer::SurfaceInterface *surface, std::chrono::microseconds time)
+{
+    if (!surface || m_pendingEvents.contains(surface)) {
+        return;
+    }
+    m_pendingEvents.insert(surface, time);
+    connect(surface, &KWaylandServer::SurfaceInterface::committed, this, [this, surface]() {
+        handleCommit(surface);
+    });
+    connect(surface, &KWaylandServer::SurfaceInterface::aboutToBeDestroyed, this, [this, surface]() {
+        m_pendingEvents.remove(surface);
+    });
+}
+
+void InputLatencyMonitor::handleCommit(KWaylandServer::SurfaceInterface *surface)
+{
+    const auto it = m_pendingEvents.find(surface);
+    if (it == m_pendingEvents.end()) {
+        return;
+    }
+    const std::chrono::microseconds eventTime = *it;
+    m_pendingEvents.erase(it);
+    disconnect(surface, nullptr, this, nullptr);
+
+    KWaylandServer::SurfaceInterface *mainSurface = surface;
+    if (auto subSurface = surface->subSurface()) {
+        mainSurface = subSurface->mainSurface();
+    }
+    const Window *window = waylandServer()->findWindow(mainSurface);
+    if (!window || !window->output()) {
+        return;
+    }
+
+    const std::chrono::microseconds commitTime = now();
+    OutputLatency &latency = outputLatency(window->output());
+    latency.eventToCommit.add(commitTime - eventTime);
+    latency.pending.append(PendingFrame{
+        .eventTime = eventTime,
+        .commitTime = commitTime,
+    });
+}
+
+void InputLatencyMonitor::handlePresented(Output *output, std::chrono::nanoseconds timestamp)
+{
+    const auto it = m_outputs.find(output);
+    if (it == m_outputs.end()) {
+        return;
+    }
+    OutputLatency &latency = it->second;
+    const auto presentTime = std::chrono::duration_cast<std::chrono::microseconds>(timestamp);
+    for (const PendingFrame &frame : std::as_const(latency.pending)) {
+        latency.commitToPresent.add(presentTime - frame.commitTime);
+        latency.eventToPresent.add(presentTime - frame.eventTime);
+    }
+    latency.pending.clear();
+}
+
+InputLatencyMonitor::OutputLatency &InputLatencyMonitor::outputLatency(Output *output)
+{
+    auto it = m_outputs.find(output);
+    if (it == m_outputs.end()) {
+        it = m_outputs.emplace(output, OutputLatency()).first;
+        connect(output->renderLoop(), &RenderLoop::framePresented, this, [this, output](RenderLoop *, std::chrono::nanoseconds timestamp) {
+            handlePresented(output, timestamp);
+        });
+    }
+    return it->second;
+}
+
+QVariantMap InputLatencyMonitor::statistics() const
+{
+    QVariantMap statistics;
+    for (const auto &[output, latency] : m_outputs) {
+        statistics.insert(output->name(), QVariantMap{
+                                              {QStringLiteral("eventToCommit"), latency.eventToCommit.toVariantMap()},
+                                              {QStringLiteral("commitToPresent"), latency.commitToPresent.toVariantMap()},
+                                              {QStringLiteral("eventToPresent"), latency.eventToPresent.toVariantMap()},
+                                          });
+    }
+    return statistics;
+}
+
+void InputLatencyMonitor::reset()
+{
+    for (auto &[output, latency] : m_outputs) {
+        latency.eventToCommit.reset();
+        latency.commitToPresent.reset();
+        latency.eventToPresent.reset();
+        latency.pending.clear();
+    }
+}
+
+} // namespace KWin
@@ -0,0 +1,114 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "input_event_spy.h"
+
+#include <QHash>
+#include <QObject>
+#include <QVariantMap>
+
+#include <array>
+#include <chrono>
+#include <map>
+
+namespace KWaylandServer
+{
+class SurfaceInterface;
+}
+
+namespace KWin
+{
+
+class Output;
+
+/**
+ * The LatencyHistogram class accumulates latency samples in buckets of half a millisecond.
+ */
+class KWIN_EXPORT LatencyHistogram
+{
+public:
+    void add(std::chrono::microseconds latency);
+    void reset();
+
+    uint count() const;
+    std::chrono::microseconds mean() const;
+    std::chrono::microseconds max() const;
+    /**
+     * Returns the latency below which the given @a fraction of the samples lie, with the
+     * precision of one bucket.
+     */
+    std::chrono::microseconds percentile(qreal fraction) const;
+
+    QVariantMap toVariantMap() const;
+
+    static constexpr std::chrono::microseconds bucketWidth = std::chrono::microseconds(500);
+
+private:
+    // the last bucket collects everything that took longer than 200ms
+    std::array<uint, 401> m_buckets = {};
+    uint m_count = 0;
+    std::chrono::microseconds m_sum = std::chrono::microseconds::zero();
+    std::chrono::microseconds m_max = std::chrono::microseconds::zero();
+};
+
+/**
+ * The InputLatencyMonitor class measures how long it takes until an input event shows up on
+ * the screen.
+ *
+ * The timestamp of an input event is remembered for the surface that has the focus of the
+ * input device. When that surface commits, the time between the input event and the commit
+ * is recorded, and the time between the commit and the next presentation on the output of
+ * the window. The histograms are kept per output.
+ */
+class KWIN_EXPORT InputLatencyMonitor : public QObject, public InputEventSpy
+{
+    Q_OBJECT
+
+public:
+    explicit InputLatencyMonitor(QObject *parent = nullptr);
+    ~InputLatencyMonitor() override;
+
+    /**
+     * Returns the latency histograms, keyed by output name.
+     */
+    QVariantMap statistics() const;
+    void reset();
+
+    void pointerEvent(MouseEvent *event) override;
+    void wheelEvent(WheelEvent *event) override;
+    void keyEvent(KeyEvent *event) override;
+    void touchDown(qint32 id, const QPointF &pos, std::chrono::microseconds time) override;
+    void touchMotion(qint32 id, const QPointF &pos, std::chrono::microseconds time) override;
+    void touchUp(qint32 id, std::chrono::microseconds time) override;
+
+private:
+    struct PendingFrame
+    {
+        std::chrono::microseconds eventTime;
+        std::chrono::microseconds commitTime;
+    };
+    struct OutputLatency
+    {
+        LatencyHistogram eventToCommit;
+        LatencyHistogram commitToPresent;
+        LatencyHistogram eventToPresent;
+        QList<PendingFrame> pending;
+    };
+
+    void handleEvent(KWaylandServer::SurfaceInterface *surface, std::chrono::microseconds time);
+    void handleCommit(KWaylandServer::SurfaceInterface *surface);
+    void handlePresented(Output *output, std::chrono::nanoseconds timestamp);
+    OutputLatency &outputLatency(Output *output);
+
+    // the earliest input event every surface hasn't reacted to yet
+    QHash<KWaylandServer::SurfaceInterface *, std::chrono::microseconds> m_pendingEvents;
+    std::map<Output *, OutputLatency> m_outputs;
+};
+
+} // namespace KWin
@@ -508,6 +508,7 @@ static quint32 keysymToKeycode(quint32 sym)
 
 void InputMethod::keysymReceived(quint32 serial, quint32 time, quint32 sym, bool pressed, quint32 modifiers)
 {
+    finishKeyPress(std::nullopt);
     if (auto t1 = waylandServer()->seat()->textInputV1(); t1 && t1->isEnabled()) {
         if (pressed) {
             t1->keysymPressed(time, sym, modifiers);
@@ -538,6 +539,7 @@ void InputMethod::keysymReceived(quint32 serial, quint32 time, quint32 sym, bool
 
 void InputMethod::commitString(qint32 serial, const QString &text)
 {
+    finishKeyPress(std::nullopt);
     if (auto t1 = waylandServer()->seat()->textInputV1(); t1 && t1->isEnabled()) {
         t1->commitString(text.toUtf8());
         t1->setPreEditCursor(0);
@@ -557,29 +559,37 @@ void InputMethod::commitString(qint32 serial, const QString &text)
         // The application has no way of communicating with the input method.
         // So instead, try to convert what we get from the input method into
         // keycodes and send those as fake input to the client.
-        auto keys = textToKey(text);
-        if (keys.empty()) {
-            return;
-        }
+        sendFakeText(text);
+    }
+}
 
-        // First, send all the extracted keys as pressed keys to the client.
-        for (const auto &key : keys) {
-            waylandServer()->seat()->notifyKeyboardKey(key, KWaylandServer::KeyboardKeyState::Pressed);
-        }
+void InputMethod::sendFakeText(const QString &text)
+{
+    if (text.isEmpty()) {
+        return;
+    }
 
-        // Then, send key release for those keys in reverse.
-        for (auto itr = keys.rbegin(); itr != keys.rend(); ++itr) {
-            // Since we are faking key events, we do not have distinct press/release
-            // events. So instead, just queue the button release so it gets sent
-            // a few moments after the press.
-            auto key = *itr;
-            QMetaObject::invokeMethod(
-                this, [key]() {
-                    waylandServer()->seat()->notifyKeyboardKey(key, KWaylandServer::KeyboardKeyState::Released);
-                },
-                Qt::QueuedConnection);
-        }
+    // The input method can commit several characters at once if the keys are typed quickly,
+    // every character is typed separately.
+    const auto keys = textToKey(text.left(1));
+
+    // First, send all the extracted keys as pressed keys to the client.
+    for (const auto &key : keys) {
+        waylandServer()->seat()->notifyKeyboardKey(key, KWaylandServer::KeyboardKeyState::Pressed);
     }
+
+    // Since we are faking key events, we do not have distinct press/release
+    // events. So instead, just queue the button release so it gets sent
+    // a few moments after the press. The next character is typed after that,
+    // a key that is pressed again before it's released would be lost.
+    QMetaObject::invokeMethod(
+        this, [this, keys, remaining = text.mid(1)]() {
+            for (auto itr = keys.rbegin(); itr != keys.rend(); ++itr) {
+                waylandServer()->seat()->notifyKeyboardKey(*itr, KWaylandServer::KeyboardKeyState::Released);
+            }
+            sendFakeText(remaining);
+        },
+        Qt::QueuedConnection);
 }
 
 void InputMethod::deleteSurroundingText(int32_t index, uint32_t length)
@@ -687,6 +697,7 @@ void InputMethod::setPreeditStyling(quint32 index, quint32 length, quint32 style
 
 void InputMethod::setPreeditString(uint32_t serial, const QString &text, const QString &commit)
 {
+    finishKeyPress(std::nullopt);
     auto t1 = waylandServer()->seat()->textInputV1();
     if (t1 && t1->isEnabled()) {
         t1->preEdit(text.toUtf8(), commit.toUtf8());
@@ -731,8 +742,10 @@ void InputMethod::setPreeditString(uint32_t serial, const QString &text, const Q
     resetPendingPreedit();
 }
 
-void InputMethod::key(quint32 /*serial*/, quint32 /*time*/, quint32 keyCode, bool pressed)
+void InputMethod::key(quint32 serial, quint32 /*time*/, quint32 keyCode, bool pressed)
 {
+    // the input method forwards the keys it doesn't handle with their original serial
+    finishKeyPress(serial);
     waylandServer()->seat()->notifyKeyboardKey(keyCode,
                                                pressed ? KWaylandServer::KeyboardKeyState::Pressed : KWaylandServer::KeyboardKeyState::Released);
 }
@@ -926,8 +939,50 @@ KWaylandServer::InputMethodGrabV1 *InputMethod::keyboardGrab()
     return isActive() ? m_keyboardGrab : nullptr;
 }
 
+void InputMethod::trackKeyPress(quint32 serial)
+{
+    const auto now = std::chrono::steady_clock::now();
+    // the input method doesn't have to respond to every key, e.g. a modifier
+    while (!m_pendingKeyPresses.empty() && now - m_pendingKeyPresses.front().sent > std::chrono::seconds(1)) {
+        m_pendingKeyPresses.pop_front();
+    }
+    m_pendingKeyPresses.push_back(PendingKeyPress{
+        .serial = serial,
+        .sent = now,
+    });
+}
+
+void InputMethod::finishKeyPress(std::optional<quint32> serial)
+{
+    if (m_pendingKeyPresses.empty()) {
+        return;
+    }
+    auto it = m_pendingKeyPresses.begin();
+    if (serial) {
+        it = std::find_if(m_pendingKeyPresses.begin(), m_pendingKeyPresses.end(), [&serial](const PendingKeyPress &keyPress) {
+            return keyPress.serial == *serial;
+        });
+        if (it == m_pendingKeyPresses.end()) {
+            return;
+        }
+    }
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - it->sent);
+    m_keyLatency.add(latency);
+    if (latency > std::chrono::milliseconds(50)) {
+        qCDebug(KWIN_VIRTUALKEYBOARD) << "The input method took" << latency.count() << "us to respond to a key press";
+    }
+    // the input method handles the keys in order, so the ones sent earlier are done as well
+    m_pendingKeyPresses.erase(m_pendingKeyPresses.begin(), it + 1);
+}
+
+const LatencyHistogram &InputMethod::keyLatency() const
+{
+    return m_keyLatency;
+}
+
 void InputMethod::installKeyboardGrab(KWaylandServer::InputMethodGrabV1 *keyboardGrab)
 {
+    m_pendingKeyPresses.clear();
     auto xkb = input()->keyboard()->xkb();
     m_keyboardGrab = keyboardGrab;
     keyboardGrab->sendKeymap(xkb->keymapContents());
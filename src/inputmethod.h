@@ -8,8 +8,12 @@
 */
 #pragma once
 
+#include "inputlatencymonitor.h"
 #include "wayland/textinput_v2_interface.h"
 
+#include <chrono>
+#include <deque>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -74,6 +78,16 @@ public:
     bool activeClientSupportsTextInput() const;
     void forceActivate();
 
+    /**
+     * Remembers that the key press with the given @a serial has been sent to the input method
+     * through the keyboard grab. Any number of key presses can be in flight.
+     */
+    void trackKeyPress(quint32 serial);
+    /**
+     * Returns how long the input method takes to respond to key presses.
+     */
+    const LatencyHistogram &keyLatency() const;
+
 Q_SIGNALS:
     void panelChanged();
     void activeChanged(bool active);
@@ -122,6 +136,8 @@ private:
     bool touchEventTriggered() const;
     void resetPendingPreedit();
     void refreshActive();
+    void finishKeyPress(std::optional<quint32> serial);
+    void sendFakeText(const QString &text);
 
     struct
     {
@@ -141,6 +157,15 @@ private:
     uint m_inputMethodCrashes = 0;
     QString m_inputMethodCommand;
 
+    struct PendingKeyPress
+    {
+        quint32 serial;
+        std::chrono::steady_clock::time_point sent;
+    };
+    // the key presses the input method hasn't responded to yet, oldest first
+    std::deque<PendingKeyPress> m_pendingKeyPresses;
+    LatencyHistogram m_keyLatency;
+
     bool m_hasPendingModifiers = false;
     bool m_activeClientSupportsTextInput = false;
     bool m_shouldShowPanel = false;
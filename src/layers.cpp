@@ -76,12 +76,14 @@
 #include "utils/common.h"
 #include "virtualdesktops.h"
 #include "wayland_server.h"
+#include "windowpartitions.h"
 #include "workspace.h"
 #include "x11window.h"
 
 #include <array>
 
 #include <QDebug>
+#include <QHash>
 #include <QQueue>
 
 namespace KWin
@@ -100,13 +102,25 @@ void Workspace::updateStackingOrder(bool propagate_new_windows)
         return;
     }
     QList<Window *> new_stacking_order = constrainedStackingOrder();
-    bool changed = (force_restacking || new_stacking_order != stacking_order);
+    const bool force = force_restacking;
+    bool changed = (force || new_stacking_order != stacking_order);
     force_restacking = false;
-    stacking_order = new_stacking_order;
+    const QList<Window *> old_stacking_order = std::exchange(stacking_order, new_stacking_order);
     if (changed || propagate_new_windows) {
         propagateWindows(propagate_new_windows);
 
-        for (int i = 0; i < stacking_order.size(); ++i) {
+        // a raise or a lower only shifts the windows between the old and the new position
+        int first = 0;
+        int last = stacking_order.size() - 1;
+        if (!force && old_stacking_order.size() == stacking_order.size()) {
+            while (first <= last && old_stacking_order[first] == stacking_order[first]) {
+                ++first;
+            }
+            while (last >= first && old_stacking_order[last] == stacking_order[last]) {
+                --last;
+            }
+        }
+        for (int i = first; i <= last; ++i) {
             stacking_order[i]->setStackingOrder(i);
         }
 
@@ -227,7 +241,7 @@ Window *Workspace::topWindowOnDesktop(VirtualDesktop *desktop, Output *output, b
     // TODO    Q_ASSERT( block_stacking_updates == 0 );
     QList<Window *> list;
     if (!unconstrained) {
-        list = stacking_order;
+        list = windowsOn(desktop, output);
     } else {
         list = unconstrained_stacking_order;
     }
@@ -251,6 +265,11 @@ Window *Workspace::topWindowOnDesktop(VirtualDesktop *desktop, Output *output, b
     return nullptr;
 }
 
+QList<Window *> Workspace::windowsOn(VirtualDesktop *desktop, Output *output) const
+{
+    return m_windowPartitions->windows(desktop, output);
+}
+
 Window *Workspace::findDesktop(bool topmost, VirtualDesktop *desktop) const
 {
     // TODO    Q_ASSERT( block_stacking_updates == 0 );
@@ -531,6 +550,15 @@ QList<Window *> Workspace::constrainedStackingOrder()
         stacking += windows[layer];
     }
 
+    // Most constraints are already satisfied, e.g. transients are usually raised together with
+    // their parents. The positions are looked up in a hash rather than searched in the list,
+    // so only the constraints that actually move a window cost more than constant time.
+    QHash<Window *, int> positions;
+    positions.reserve(stacking.count());
+    for (int i = 0; i < stacking.count(); ++i) {
+        positions.insert(stacking[i], i);
+    }
+
     // Apply the stacking order constraints. First, we enqueue the root constraints, i.e.
     // the ones that are not affected by other constraints.
     QQueue<Constraint *> constraints;
@@ -550,13 +578,16 @@ QList<Window *> Workspace::constrainedStackingOrder()
     while (!constraints.isEmpty()) {
         Constraint *constraint = constraints.dequeue();
 
-        const int belowIndex = stacking.indexOf(constraint->below);
-        const int aboveIndex = stacking.indexOf(constraint->above);
+        const int belowIndex = positions.value(constraint->below, -1);
+        const int aboveIndex = positions.value(constraint->above, -1);
         if (belowIndex == -1 || aboveIndex == -1) {
             continue;
         } else if (aboveIndex < belowIndex) {
             stacking.removeAt(aboveIndex);
             stacking.insert(belowIndex, constraint->above);
+            for (int i = aboveIndex; i <= belowIndex; ++i) {
+                positions[stacking[i]] = i;
+            }
         }
 
         for (Constraint *child : std::as_const(constraint->children)) {
@@ -0,0 +1,83 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "libkwineffects/glrendertimequery.h"
+#include "libkwineffects/kwinglplatform.h"
+#include "libkwineffects/kwinglutils.h"
+
+namespace KWin
+{
+
+bool GLRenderTimeQuery::isSupported()
+{
+    static const bool disabled = qEnvironmentVariableIntValue("KWIN_NO_TIMER_QUERY") == 1;
+    if (disabled) {
+        return false;
+    }
+    if (GLPlatform::instance()->isGLES()) {
+        return hasGLExtension(QByteArrayLiteral("GL_EXT_disjoint_timer_query"));
+    } else {
+        return hasGLVersion(3, 3) || hasGLExtension(QByteArrayLiteral("GL_ARB_timer_query"));
+    }
+}
+
+GLRenderTimeQuery::GLRenderTimeQuery()
+{
+    if (isSupported()) {
+        glGenQueries(1, &m_query);
+    }
+}
+
+GLRenderTimeQuery::~GLRenderTimeQuery()
+{
+    if (m_query) {
+        glDeleteQueries(1, &m_query);
+    }
+}
+
+void GLRenderTimeQuery::begin()
+{
+    if (m_query) {
+        glGetInteger64v(GL_TIMESTAMP, &m_gpuProbe.start);
+    }
+    m_cpuProbe.start = std::chrono::steady_clock::now();
+}
+
+void GLRenderTimeQuery::end()
+{
+    m_hasResult = true;
+    if (m_query) {
+        glQueryCounter(m_query, GL_TIMESTAMP);
+    }
+    m_cpuProbe.end = std::chrono::steady_clock::now();
+}
+
+std::chrono::nanoseconds GLRenderTimeQuery::result()
+{
+    if (!m_hasResult) {
+        return std::chrono::nanoseconds::zero();
+    }
+    m_hasResult = false;
+
+    const std::chrono::nanoseconds cpuTime = m_cpuProbe.end - m_cpuProbe.start;
+    if (!m_query) {
+        return cpuTime;
+    }
+
+    glGetQueryObjecti64v(m_query, GL_QUERY_RESULT, &m_gpuProbe.end);
+    const std::chrono::nanoseconds gpuTime(m_gpuProbe.end - m_gpuProbe.start);
+
+    // The GPU timestamps are unreliable if the GPU got disjoint, e.g. due to a power
+    // state change; fall back to the CPU time in that case.
+    if (gpuTime < std::chrono::nanoseconds::zero()) {
+        return cpuTime;
+    }
+    return std::max(gpuTime, cpuTime);
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "libkwineffects/kwinglutils_export.h"
+
+#include <chrono>
+#include <epoxy/gl.h>
+
+namespace KWin
+{
+
+/**
+ * The GLRenderTimeQuery class measures how long it takes the CPU and the GPU to render
+ * a frame. If timer queries are not supported, only the CPU time is measured.
+ */
+class KWINGLUTILS_EXPORT GLRenderTimeQuery
+{
+public:
+    explicit GLRenderTimeQuery();
+    ~GLRenderTimeQuery();
+
+    /**
+     * Marks the start of rendering. The OpenGL context must be current.
+     */
+    void begin();
+
+    /**
+     * Marks the end of rendering. The OpenGL context must be current.
+     */
+    void end();
+
+    /**
+     * Returns the time it took to render the frame, from begin() until both the CPU and
+     * the GPU have finished. The OpenGL context must be current. If the GPU is still busy,
+     * this function will block. Returns zero if no frame has been measured.
+     */
+    std::chrono::nanoseconds result();
+
+    static bool isSupported();
+
+private:
+    GLuint m_query = 0;
+    bool m_hasResult = false;
+    struct
+    {
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+    } m_cpuProbe;
+    struct
+    {
+        GLint64 start = 0;
+        GLint64 end = 0;
+    } m_gpuProbe;
+};
+
+}
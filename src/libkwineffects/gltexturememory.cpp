@@ -0,0 +1,170 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "libkwineffects/gltexturememory.h"
+#include "logging_p.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <utility>
+
+namespace KWin
+{
+
+// entries used this recently would be created again right away, evicting them doesn't help
+static constexpr std::chrono::seconds s_minimumIdleTime(1);
+
+static std::array<qint64, GLTextureMemory::CategoryCount> s_usage{};
+static qint64 s_budget = qEnvironmentVariableIntValue("KWIN_TEXTURE_MEMORY_BUDGET") * qint64(1024 * 1024);
+static QVector<GLTextureCacheEntry *> s_cacheEntries;
+static const void *s_owner = nullptr;
+static std::unordered_map<const void *, qint64> s_ownerUsage;
+
+qint64 GLTextureMemory::usage(Category category)
+{
+    return s_usage[int(category)];
+}
+
+qint64 GLTextureMemory::totalUsage()
+{
+    qint64 total = 0;
+    for (qint64 usage : s_usage) {
+        total += usage;
+    }
+    return total;
+}
+
+QString GLTextureMemory::categoryName(Category category)
+{
+    switch (category) {
+    case Category::Surface:
+        return QStringLiteral("surface");
+    case Category::Decoration:
+        return QStringLiteral("decoration");
+    case Category::Shadow:
+        return QStringLiteral("shadow");
+    case Category::Thumbnail:
+        return QStringLiteral("thumbnail");
+    case Category::Effect:
+        return QStringLiteral("effect");
+    case Category::Other:
+        return QStringLiteral("other");
+    }
+    Q_UNREACHABLE();
+}
+
+qint64 GLTextureMemory::budget()
+{
+    return s_budget;
+}
+
+void GLTextureMemory::setBudget(qint64 bytes)
+{
+    s_budget = bytes;
+}
+
+void GLTextureMemory::account(Category category, qint64 bytes)
+{
+    s_usage[int(category)] += bytes;
+}
+
+const void *GLTextureMemory::setOwner(const void *owner)
+{
+    return std::exchange(s_owner, owner);
+}
+
+const void *GLTextureMemory::owner()
+{
+    return s_owner;
+}
+
+qint64 GLTextureMemory::ownerUsage(const void *owner)
+{
+    const auto it = s_ownerUsage.find(owner);
+    return it != s_ownerUsage.end() ? it->second : 0;
+}
+
+void GLTextureMemory::accountOwner(const void *owner, qint64 bytes)
+{
+    if (!owner || !bytes) {
+        return;
+    }
+    auto it = s_ownerUsage.try_emplace(owner, 0).first;
+    it->second += bytes;
+    if (!it->second) {
+        s_ownerUsage.erase(it);
+    }
+}
+
+void GLTextureMemory::enforceBudget()
+{
+    enforceBudget(std::chrono::steady_clock::now());
+}
+
+void GLTextureMemory::enforceBudget(std::chrono::steady_clock::time_point now)
+{
+    if (s_budget <= 0 || totalUsage() <= s_budget) {
+        return;
+    }
+
+    QVector<GLTextureCacheEntry *> candidates;
+    for (GLTextureCacheEntry *entry : std::as_const(s_cacheEntries)) {
+        if (now - entry->lastUsed() >= s_minimumIdleTime) {
+            candidates.append(entry);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const GLTextureCacheEntry *a, const GLTextureCacheEntry *b) {
+        return a->lastUsed() < b->lastUsed();
+    });
+
+    int evicted = 0;
+    for (GLTextureCacheEntry *entry : std::as_const(candidates)) {
+        if (totalUsage() <= s_budget) {
+            break;
+        }
+        // evicting an entry may destroy other entries, e.g. by deleting their owner
+        if (s_cacheEntries.contains(entry) && entry->evict()) {
+            ++evicted;
+        }
+    }
+
+    if (evicted) {
+        qCDebug(LIBKWINGLUTILS) << "Evicted" << evicted << "texture cache entries, texture memory:" << totalUsage() << "budget:" << s_budget;
+    }
+}
+
+GLTextureCacheEntry::GLTextureCacheEntry(std::function<bool()> evict)
+    : m_evict(std::move(evict))
+    , m_lastUsed(std::chrono::steady_clock::now())
+{
+    s_cacheEntries.append(this);
+}
+
+GLTextureCacheEntry::~GLTextureCacheEntry()
+{
+    s_cacheEntries.removeOne(this);
+}
+
+void GLTextureCacheEntry::touch()
+{
+    m_lastUsed = std::chrono::steady_clock::now();
+}
+
+std::chrono::steady_clock::time_point GLTextureCacheEntry::lastUsed() const
+{
+    return m_lastUsed;
+}
+
+bool GLTextureCacheEntry::evict()
+{
+    return m_evict();
+}
+
+} // namespace KWin
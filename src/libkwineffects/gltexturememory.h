@@ -0,0 +1,115 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "libkwineffects/kwinglutils_export.h"
+
+#include <QString>
+
+#include <chrono>
+#include <functional>
+
+namespace KWin
+{
+
+/**
+ * The GLTextureMemory class keeps track of the memory allocated for GLTextures, by the kind of
+ * content they hold. Textures that wrap memory allocated elsewhere, e.g. client buffers
+ * imported with an EGLImage, are not taken into account.
+ *
+ * If a budget is set with KWIN_TEXTURE_MEMORY_BUDGET, in MiB, the least recently used cache
+ * entries are evicted whenever the allocated memory exceeds it.
+ */
+class KWINGLUTILS_EXPORT GLTextureMemory
+{
+public:
+    enum class Category {
+        Surface,
+        Decoration,
+        Shadow,
+        Thumbnail,
+        Effect,
+        Other,
+    };
+    static constexpr int CategoryCount = int(Category::Other) + 1;
+
+    /**
+     * Returns the number of bytes allocated for textures in the given @p category.
+     */
+    static qint64 usage(Category category);
+    static qint64 totalUsage();
+    static QString categoryName(Category category);
+
+    /**
+     * Returns the texture memory budget in bytes, or @c 0 if there is none.
+     */
+    static qint64 budget();
+    static void setBudget(qint64 bytes);
+
+    /**
+     * Evicts the least recently used cache entries until the allocated memory is within the
+     * budget. Entries that have been used within the last second are kept. This must be called
+     * with the compositor's OpenGL context current and when no frame is being painted.
+     */
+    static void enforceBudget();
+    /**
+     * @internal
+     */
+    static void enforceBudget(std::chrono::steady_clock::time_point now);
+
+    /**
+     * Sets the @p owner that textures created from now on are accounted to, in addition to their
+     * category, e.g. the effect whose code is running. Returns the previous owner.
+     */
+    static const void *setOwner(const void *owner);
+    static const void *owner();
+
+    /**
+     * Returns the number of bytes allocated for the textures that were created while @p owner
+     * was set.
+     */
+    static qint64 ownerUsage(const void *owner);
+
+    /**
+     * @internal
+     */
+    static void account(Category category, qint64 bytes);
+    /**
+     * @internal
+     */
+    static void accountOwner(const void *owner, qint64 bytes);
+};
+
+/**
+ * The GLTextureCacheEntry class represents textures that can be dropped when the texture memory
+ * budget is exceeded and created again when they are needed, e.g. the contents of a window
+ * thumbnail. The owner calls touch() whenever the textures are used.
+ */
+class KWINGLUTILS_EXPORT GLTextureCacheEntry
+{
+public:
+    /**
+     * The @p evict function releases the textures, it returns @c false if they are needed and
+     * can't be released right now.
+     */
+    explicit GLTextureCacheEntry(std::function<bool()> evict);
+    ~GLTextureCacheEntry();
+
+    void touch();
+    std::chrono::steady_clock::time_point lastUsed() const;
+
+private:
+    bool evict();
+
+    std::function<bool()> m_evict;
+    std::chrono::steady_clock::time_point m_lastUsed;
+
+    friend class GLTextureMemory;
+    Q_DISABLE_COPY_MOVE(GLTextureCacheEntry)
+};
+
+} // namespace KWin
@@ -17,6 +17,8 @@
 #include <QVector3D>
 #include <QtDebug>
 
+#include <algorithm>
+
 namespace KWin
 {
 
@@ -865,6 +867,39 @@ static float fixOvershoot(float f, const AniData &d, short int dir, float s = 1.
     }
 }
 
+static QRect rotationBounds(EffectWindow *w, const AniData &anim)
+{
+    // Whatever the axis, the projection is orthographic, so the window stays within the circle
+    // around the rotation origin that touches its farthest corner. The origin moves between
+    // the source and the target anchor.
+    const QRectF frame = w->frameGeometry();
+    const QRectF rect(QPointF(0, 0), frame.size());
+    const uint sAnchor = AnimationEffect::metaData(AnimationEffect::SourceAnchor, anim.meta);
+    const uint tAnchor = AnimationEffect::metaData(AnimationEffect::TargetAnchor, anim.meta);
+    const QPointF origins[] = {
+        frame.topLeft() + QPointF(xCoord(rect, sAnchor), yCoord(rect, sAnchor)),
+        frame.topLeft() + QPointF(xCoord(rect, tAnchor), yCoord(rect, tAnchor)),
+    };
+
+    const QRectF expanded = w->expandedGeometry();
+    const QPointF corners[] = {
+        expanded.topLeft(),
+        expanded.topRight(),
+        expanded.bottomRight(),
+        expanded.bottomLeft(),
+    };
+
+    qreal radius = 0;
+    for (const QPointF &origin : origins) {
+        for (const QPointF &corner : corners) {
+            radius = std::max(radius, std::hypot(corner.x() - origin.x(), corner.y() - origin.y()));
+        }
+    }
+
+    const QRectF span = QRectF(origins[0], origins[1]).normalized();
+    return span.adjusted(-radius, -radius, radius, radius).toAlignedRect();
+}
+
 void AnimationEffect::updateLayerRepaints()
 {
     Q_D(AnimationEffect);
@@ -891,10 +926,20 @@ void AnimationEffect::updateLayerRepaints()
             case ShaderUniform:
                 createRegion = true;
                 break;
-            case Rotation:
-                createRegion = false;
-                *layerRect = QRect(QPoint(0, 0), effects->virtualScreenSize());
-                goto region_creation; // sic! no need to do anything else
+            case Rotation: {
+                const bool moved = std::any_of(entry->first.constBegin(), animEnd, [](const AniData &other) {
+                    return other.attribute == Translation || other.attribute == Position || other.attribute == Size || other.attribute == Scale;
+                });
+                if (moved) {
+                    // the rotated window could end up anywhere
+                    createRegion = false;
+                    *layerRect = QRect(QPoint(0, 0), effects->virtualScreenSize());
+                    goto region_creation; // sic! no need to do anything else
+                }
+                createRegion = true;
+                rects << rotationBounds(entry.key(), *anim);
+                break;
+            }
             case Generic:
                 d->m_needSceneRepaint = true; // we don't know whether this will change visual stacking order
                 return; // sic! no need to do anything else
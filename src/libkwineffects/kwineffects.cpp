@@ -25,6 +25,7 @@
 #include <kconfiggroup.h>
 #include <ksharedconfig.h>
 
+#include <limits>
 #include <optional>
 
 namespace KWin
@@ -396,6 +397,62 @@ WindowPaintData &WindowPaintData::operator+=(const QVector3D &translation)
     return *this;
 }
 
+//****************************************
+// AnimationDamage
+//****************************************
+
+void AnimationDamage::paint(WindowPrePaintData &data, const QRectF &bounds)
+{
+    m_current = bounds;
+    data.paint += (m_previous | m_current).toAlignedRect();
+}
+
+void AnimationDamage::repaint()
+{
+    if (!m_current.isEmpty()) {
+        effects->addRepaint(m_current.toAlignedRect());
+    }
+    m_previous = m_current;
+}
+
+QRectF AnimationDamage::bounds() const
+{
+    return m_current;
+}
+
+QRectF AnimationDamage::transformedBounds(EffectWindow *w, const WindowPaintData &data, const QMatrix4x4 &viewportProjection, qreal scale)
+{
+    // mirrors the transformations that the item renderer applies to the window item
+    const QPointF origin = w->pos();
+    QMatrix4x4 model;
+    model.translate(origin.x() * scale, origin.y() * scale);
+    model *= data.toMatrix(scale);
+
+    // the perspective division commutes with the inverted orthographic projection
+    const QMatrix4x4 mapping = viewportProjection.inverted() * data.projectionMatrix() * model;
+
+    const QRectF geometry = w->expandedGeometry();
+    const QPointF corners[] = {
+        geometry.topLeft(),
+        geometry.topRight(),
+        geometry.bottomRight(),
+        geometry.bottomLeft(),
+    };
+
+    qreal left = std::numeric_limits<qreal>::max();
+    qreal top = std::numeric_limits<qreal>::max();
+    qreal right = std::numeric_limits<qreal>::lowest();
+    qreal bottom = std::numeric_limits<qreal>::lowest();
+    for (const QPointF &corner : corners) {
+        const QPointF mapped = mapping.map((corner - origin) * scale) / scale;
+        left = std::min(left, mapped.x());
+        top = std::min(top, mapped.y());
+        right = std::max(right, mapped.x());
+        bottom = std::max(bottom, mapped.y());
+    }
+    return QRectF(QPointF(left, top), QPointF(right, bottom));
+}
+
 //****************************************
 // Effect
 //****************************************
@@ -161,7 +161,7 @@ typedef QList<KWin::EffectWindow *> EffectWindowList;
 
 #define KWIN_EFFECT_API_MAKE_VERSION(major, minor) ((major) << 8 | (minor))
 #define KWIN_EFFECT_API_VERSION_MAJOR 0
-#define KWIN_EFFECT_API_VERSION_MINOR 236
+#define KWIN_EFFECT_API_VERSION_MINOR 241
 #define KWIN_EFFECT_API_VERSION KWIN_EFFECT_API_MAKE_VERSION( \
     KWIN_EFFECT_API_VERSION_MAJOR, KWIN_EFFECT_API_VERSION_MINOR)
 
@@ -178,6 +178,24 @@ enum DataRole {
     WindowUnminimizedGrabRole,
     WindowForceBlurRole, ///< For fullscreen effects to enforce blurring of windows,
     WindowForceBackgroundContrastRole, ///< For fullscreen effects to enforce the background contrast,
+    /**
+     * The color matrix of the background contrast behind the window, set by the background
+     * contrast effect together with WindowBackgroundContrastRegionRole.
+     * @since 6.0
+     */
+    WindowBackgroundContrastMatrixRole,
+    /**
+     * The region of the background contrast relative to the window, set by the background
+     * contrast effect before the window is painted.
+     * @since 6.0
+     */
+    WindowBackgroundContrastRegionRole,
+    /**
+     * Set while the window is drawn by an effect that has already applied the background contrast
+     * when sampling the backdrop of the window, the background contrast effect skips its own pass.
+     * @since 6.0
+     */
+    WindowBackgroundContrastAppliedRole,
 };
 
 /**
@@ -1123,6 +1141,27 @@ public:
     // window will be temporarily painted as if being at the top of the stack
     Q_SCRIPTABLE virtual void setElevatedWindow(KWin::EffectWindow *w, bool set) = 0;
 
+    /**
+     * Restricts the window paint methods of the @p effect, i.e. prePaintWindow(), paintWindow(),
+     * postPaintWindow() and drawWindow(), to the windows it has been enabled for with
+     * setWindowHooksEnabled(). The other windows skip the effect in their chains.
+     *
+     * This is meant for effects that only ever touch a few windows, so they don't cost anything
+     * for the rest. Changes take effect with the next rendered frame. An effect should still
+     * cope with being called for other windows, e.g. when another effect paints them directly.
+     *
+     * @since 6.0
+     */
+    virtual void setWindowHooksFiltered(Effect *effect, bool filtered) = 0;
+    /**
+     * Enables or disables the window paint methods of the filtered @p effect for the window @p w.
+     * The window is forgotten when it's deleted.
+     *
+     * @see setWindowHooksFiltered
+     * @since 6.0
+     */
+    virtual void setWindowHooksEnabled(Effect *effect, EffectWindow *w, bool enabled) = 0;
+
     virtual void setTabBoxWindow(EffectWindow *) = 0;
     virtual EffectWindowList currentTabBoxWindowList() const = 0;
     virtual void refTabBox() = 0;
@@ -1643,10 +1682,11 @@ Q_SIGNALS:
      * Signal emitted when an area of a window is scheduled for repainting.
      * Use this signal in an effect if another area needs to be synced as well.
      * @param w The window which is scheduled for repainting
-     * @param r Always empty.
+     * @param region The damaged area in global coordinates, an infinite region if the
+     * whole window has been damaged, e.g. its decoration or shadow
      * @since 4.7
      */
-    void windowDamaged(KWin::EffectWindow *w);
+    void windowDamaged(KWin::EffectWindow *w, const QRegion &region);
     /**
      * Signal emitted when a tabbox is added.
      * An effect who wants to replace the tabbox with itself should use refTabBox.
@@ -3327,6 +3367,52 @@ public:
     EffectScreen *screen = nullptr;
 };
 
+/**
+ * The AnimationDamage class helps effects that transform windows to repaint only the area
+ * that an animated window covers, instead of the whole screen.
+ *
+ * Each frame, the effect reports the bounds of the window in prePaintWindow() with paint(),
+ * which adds them and the bounds of the previous frame to the painted region, so the window
+ * is drawn at its new place and the area it has left is cleared. In postPaintScreen(), the
+ * effect calls repaint() to schedule the next frame, also once after the animation has ended.
+ *
+ * @since 6.0
+ */
+class KWINEFFECTS_EXPORT AnimationDamage
+{
+public:
+    /**
+     * Adds the @p bounds of the window in the frame that is about to be painted, as well as
+     * the bounds of the previous frame, to the painted region in @p data.
+     */
+    void paint(WindowPrePaintData &data, const QRectF &bounds);
+
+    /**
+     * Schedules a repaint of the bounds of the last painted frame.
+     */
+    void repaint();
+
+    /**
+     * Returns the bounds of the window in the last painted frame.
+     */
+    QRectF bounds() const;
+
+    /**
+     * Returns the bounding rectangle of the window @p w, in logical coordinates, when it's
+     * painted with the transformations and the projection matrix of @p data. The
+     * @p viewportProjection is the regular projection matrix of a viewport with the given
+     * @p scale, it's used to map the result back into the logical coordinate space.
+     *
+     * If the effect doesn't change the projection matrix, @p data should be constructed with
+     * the @p viewportProjection.
+     */
+    static QRectF transformedBounds(EffectWindow *w, const WindowPaintData &data, const QMatrix4x4 &viewportProjection, qreal scale);
+
+private:
+    QRectF m_previous;
+    QRectF m_current;
+};
+
 /**
  * @internal
  */
@@ -773,20 +773,7 @@ void GLPlatform::detect(OpenGLPlatformInterface platformInterface)
     m_platformInterface = platformInterface;
 
     m_context = std::make_unique<OpenGlContext>();
-
-    if (!isGLES() && m_context->hasVersion(Version(3, 0))) {
-        int count;
-        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
-
-        for (int i = 0; i < count; i++) {
-            const char *name = (const char *)glGetStringi(GL_EXTENSIONS, i);
-            m_extensions.insert(name);
-        }
-    } else {
-        const QByteArray extensions = (const char *)glGetString(GL_EXTENSIONS);
-        QList<QByteArray> extensionsList = extensions.split(' ');
-        m_extensions = {extensionsList.constBegin(), extensionsList.constEnd()};
-    }
+    m_extensions = m_context->openglExtensions();
 
     // Parse the Mesa version
     const auto versionTokens = m_context->openglVersionString().toByteArray().split(' ');
@@ -1359,6 +1346,11 @@ QByteArrayView GLPlatform::glShadingLanguageVersionString() const
     return m_glsl_version;
 }
 
+QSet<QByteArray> GLPlatform::extensions() const
+{
+    return m_extensions;
+}
+
 bool GLPlatform::isLooseBinding() const
 {
     return m_looseBinding;
@@ -374,6 +374,10 @@ public:
      * @since 4.9
      */
     QByteArrayView glShadingLanguageVersionString() const;
+    /**
+     * @returns the extensions supported by the driver.
+     */
+    QSet<QByteArray> extensions() const;
     /**
      * @returns Whether the driver supports loose texture binding.
      * @since 4.9
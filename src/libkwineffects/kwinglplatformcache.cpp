@@ -0,0 +1,58 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwinglplatformcache_p.h"
+
+#include <QCryptographicHash>
+#include <QHash>
+
+namespace KWin
+{
+
+static QHash<QByteArray, QSet<QByteArray>> s_extensions;
+
+static bool isCacheEnabled()
+{
+    static const bool enabled = qgetenv("KWIN_GL_PLATFORM_CACHE") != QByteArrayLiteral("0");
+    return enabled;
+}
+
+static QByteArray driverKey(QByteArrayView vendor, QByteArrayView renderer, QByteArrayView version)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(vendor);
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(renderer);
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(version);
+    return hash.result();
+}
+
+std::optional<QSet<QByteArray>> GLPlatformCache::loadExtensions(QByteArrayView vendor, QByteArrayView renderer, QByteArrayView version)
+{
+    if (!isCacheEnabled() || version.isEmpty()) {
+        return std::nullopt;
+    }
+
+    const auto it = s_extensions.constFind(driverKey(vendor, renderer, version));
+    if (it == s_extensions.constEnd()) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+void GLPlatformCache::storeExtensions(QByteArrayView vendor, QByteArrayView renderer, QByteArrayView version, const QSet<QByteArray> &extensions)
+{
+    if (!isCacheEnabled() || version.isEmpty() || extensions.isEmpty()) {
+        return;
+    }
+    s_extensions.insert(driverKey(vendor, renderer, version), extensions);
+}
+
+} // namespace KWin
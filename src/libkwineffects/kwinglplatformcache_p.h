@@ -0,0 +1,46 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QSet>
+
+#include <optional>
+
+namespace KWin
+{
+
+/**
+ * The GLPlatformCache remembers the extensions reported by an OpenGL driver, so they don't have
+ * to be queried one by one every time a context is created, e.g. when the compositor is restarted
+ * after a GPU reset.
+ *
+ * The extensions are keyed by the vendor, renderer and version strings of the driver. They are
+ * only kept in memory for the lifetime of the process; the strings don't reflect overrides such
+ * as MESA_EXTENSION_OVERRIDE or drirc options, which may be different in the next session.
+ *
+ * Set KWIN_GL_PLATFORM_CACHE=0 to disable the cache.
+ */
+class GLPlatformCache
+{
+public:
+    /**
+     * Returns the extensions stored for the driver identified by @p vendor, @p renderer and
+     * @p version, or @c std::nullopt if they are unknown.
+     */
+    static std::optional<QSet<QByteArray>> loadExtensions(QByteArrayView vendor, QByteArrayView renderer, QByteArrayView version);
+
+    /**
+     * Stores the @p extensions of the driver identified by @p vendor, @p renderer and @p version.
+     */
+    static void storeExtensions(QByteArrayView vendor, QByteArrayView renderer, QByteArrayView version, const QSet<QByteArray> &extensions);
+};
+
+} // namespace KWin
@@ -0,0 +1,165 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwinglshadercache_p.h"
+#include "libkwineffects/kwinglplatform.h"
+#include "libkwineffects/kwinglutils.h"
+#include "logging_p.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+namespace KWin
+{
+
+static const quint32 s_magic = 0x4b575343; // "KWSC"
+static const quint32 s_version = 1;
+
+static std::unique_ptr<GLShaderCache> s_shaderCache;
+static bool s_shaderCacheInitialized = false;
+
+GLShaderCache::GLShaderCache(const QString &directory, const QVector<GLint> &formats)
+    : m_directory(directory)
+    , m_formats(formats)
+{
+}
+
+GLShaderCache *GLShaderCache::instance()
+{
+    if (s_shaderCacheInitialized) {
+        return s_shaderCache.get();
+    }
+    s_shaderCacheInitialized = true;
+
+    if (qgetenv("KWIN_GL_SHADER_CACHE") == QByteArrayLiteral("0")) {
+        return nullptr;
+    }
+
+    const GLPlatform *platform = GLPlatform::instance();
+    if (platform->isGLES()) {
+        if (!hasGLVersion(3, 0)) {
+            return nullptr;
+        }
+    } else if (!hasGLVersion(4, 1) && !hasGLExtension(QByteArrayLiteral("GL_ARB_get_program_binary"))) {
+        return nullptr;
+    }
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0) {
+        return nullptr;
+    }
+    QVector<GLint> formats(formatCount);
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+
+    // The binaries are only compatible with the driver build that produced them
+    QCryptographicHash driverHash(QCryptographicHash::Sha1);
+    driverHash.addData(platform->glVendorString());
+    driverHash.addData(platform->glRendererString());
+    driverHash.addData(platform->glVersionString());
+    driverHash.addData(platform->glShadingLanguageVersionString());
+
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+        + QLatin1String("/kwin/shaders/") + QString::fromLatin1(driverHash.result().toHex());
+    if (!QDir().mkpath(directory)) {
+        qCWarning(LIBKWINGLUTILS) << "Failed to create the shader cache directory" << directory;
+        return nullptr;
+    }
+
+    s_shaderCache.reset(new GLShaderCache(directory, formats));
+    return s_shaderCache.get();
+}
+
+void GLShaderCache::cleanup()
+{
+    s_shaderCache.reset();
+    s_shaderCacheInitialized = false;
+}
+
+QString GLShaderCache::filePath(const QByteArray &key) const
+{
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(key.toHex());
+}
+
+bool GLShaderCache::load(GLuint program, const QByteArray &key)
+{
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 format = 0;
+    QByteArray checksum;
+    QByteArray binary;
+    stream >> magic >> version >> format >> checksum >> binary;
+
+    if (stream.status() != QDataStream::Ok || magic != s_magic || version != s_version
+        || !m_formats.contains(format) || QCryptographicHash::hash(binary, QCryptographicHash::Sha1) != checksum) {
+        qCDebug(LIBKWINGLUTILS) << "Discarding invalid shader binary" << file.fileName();
+        file.remove();
+        return false;
+    }
+
+    glProgramBinary(program, format, binary.constData(), binary.size());
+
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == 0) {
+        qCDebug(LIBKWINGLUTILS) << "The driver rejected the shader binary" << file.fileName();
+        file.remove();
+        return false;
+    }
+
+    return true;
+}
+
+void GLShaderCache::store(GLuint program, const QByteArray &key)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    QByteArray binary(length, Qt::Uninitialized);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return;
+    }
+    binary.resize(written);
+
+    // Writing the file can take a while, don't block the compositor on it
+    QThreadPool::globalInstance()->start([path = filePath(key), format, binary]() {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCWarning(LIBKWINGLUTILS) << "Failed to open" << file.fileName() << "for writing";
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << s_magic << s_version << qint32(format) << QCryptographicHash::hash(binary, QCryptographicHash::Sha1) << binary;
+
+        if (!file.commit()) {
+            qCWarning(LIBKWINGLUTILS) << "Failed to write" << file.fileName();
+        }
+    });
+}
+
+} // namespace KWin
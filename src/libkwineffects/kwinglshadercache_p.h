@@ -0,0 +1,62 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <epoxy/gl.h>
+
+#include <memory>
+
+namespace KWin
+{
+
+/**
+ * The GLShaderCache stores the binaries of linked shader programs on disk, so the programs
+ * don't have to be compiled again the next time they are needed, e.g. after a restart.
+ *
+ * The binaries are keyed by a hash of the sources of the program and are stored in a directory
+ * specific to the driver and the GPU. A binary is only used if its checksum matches and the
+ * driver accepts it, otherwise the program is compiled from the sources as usual.
+ *
+ * Set KWIN_GL_SHADER_CACHE=0 to disable the cache.
+ */
+class GLShaderCache
+{
+public:
+    /**
+     * Returns the cache for the current OpenGL context, or @c null if program binaries are
+     * not supported by the driver.
+     */
+    static GLShaderCache *instance();
+    static void cleanup();
+
+    /**
+     * Loads the binary stored for @p key into @p program. Returns @c true if the program
+     * has been linked successfully.
+     */
+    bool load(GLuint program, const QByteArray &key);
+
+    /**
+     * Stores the binary of the linked @p program for @p key. The file is written in the
+     * background.
+     */
+    void store(GLuint program, const QByteArray &key);
+
+private:
+    explicit GLShaderCache(const QString &directory, const QVector<GLint> &formats);
+
+    QString filePath(const QByteArray &key) const;
+
+    QString m_directory;
+    QVector<GLint> m_formats;
+};
+
+} // namespace KWin
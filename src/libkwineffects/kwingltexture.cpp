@@ -16,16 +16,171 @@
 #include "libkwineffects/kwinglutils_funcs.h"
 
 #include "kwingltexture_p.h"
+#include "logging_p.h"
 
 #include <QImage>
 #include <QPixmap>
+#include <QThread>
+#include <QThreadPool>
 #include <QVector2D>
 #include <QVector3D>
 #include <QVector4D>
 
+#include <deque>
+#include <optional>
+
 namespace KWin
 {
 
+//****************************************
+// GLUploadBuffer
+//****************************************
+
+/**
+ * A persistently mapped pixel buffer that is used as a ring buffer to stage texture
+ * uploads. Every upload is guarded by a fence, so a range is only reused after the
+ * GPU has finished reading from it.
+ */
+class GLUploadBuffer
+{
+public:
+    ~GLUploadBuffer();
+
+    GLuint buffer() const
+    {
+        return m_buffer;
+    }
+    uint8_t *map() const
+    {
+        return m_map;
+    }
+
+    std::optional<size_t> allocate(size_t size);
+    void fence(size_t offset, size_t size);
+
+private:
+    bool reallocate(size_t size);
+    void deleteFences();
+
+    struct Fence
+    {
+        GLsync sync;
+        size_t begin;
+        size_t end;
+    };
+
+    GLuint m_buffer = 0;
+    uint8_t *m_map = nullptr;
+    size_t m_size = 0;
+    size_t m_head = 0;
+    std::deque<Fence> m_fences;
+};
+
+GLUploadBuffer::~GLUploadBuffer()
+{
+    deleteFences();
+    if (m_buffer) {
+        // This also unmaps the buffer
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+void GLUploadBuffer::deleteFences()
+{
+    for (const Fence &fence : m_fences) {
+        glDeleteSync(fence.sync);
+    }
+    m_fences.clear();
+}
+
+bool GLUploadBuffer::reallocate(size_t size)
+{
+    deleteFences();
+    if (m_buffer) {
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        m_map = nullptr;
+    }
+
+    // Start with enough space for a few full hd windows
+    m_size = std::max<size_t>(size, 32 * 1024 * 1024);
+    m_head = 0;
+
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_size, nullptr, GL_DYNAMIC_STORAGE_BIT | access);
+    m_map = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_size, access));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!m_map) {
+        qCWarning(LIBKWINGLUTILS) << "Failed to map the texture upload buffer";
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        m_size = 0;
+        return false;
+    }
+    return true;
+}
+
+std::optional<size_t> GLUploadBuffer::allocate(size_t size)
+{
+    // Keep the ranges aligned, so the offsets are suitable for any pixel format
+    size = (size + 15) & ~size_t(15);
+
+    if (size > m_size / 2) {
+        if (!reallocate(size * 2)) {
+            return std::nullopt;
+        }
+    }
+
+    // Handle wrap-around
+    if (m_head + size > m_size) {
+        m_head = 0;
+    }
+
+    // Find the most recent upload that still uses the requested range. The GPU finishes
+    // commands in order, so all fences before that one are signaled as well
+    auto last = m_fences.end();
+    for (auto it = m_fences.begin(); it != m_fences.end(); ++it) {
+        if (it->begin < m_head + size && m_head < it->end) {
+            last = it;
+        }
+    }
+    if (last != m_fences.end()) {
+        GLint status;
+        glGetSynciv(last->sync, GL_SYNC_STATUS, 1, nullptr, &status);
+        if (status != GL_SIGNALED) {
+            qCDebug(LIBKWINGLUTILS) << "Stalling on texture upload fence";
+            const GLenum ret = glClientWaitSync(last->sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            if (ret == GL_TIMEOUT_EXPIRED || ret == GL_WAIT_FAILED) {
+                qCCritical(LIBKWINGLUTILS) << "Wait failed";
+                return std::nullopt;
+            }
+        }
+        for (auto it = m_fences.begin(); it != std::next(last); ++it) {
+            glDeleteSync(it->sync);
+        }
+        m_fences.erase(m_fences.begin(), std::next(last));
+    }
+
+    const size_t offset = m_head;
+    m_head += size;
+    return offset;
+}
+
+void GLUploadBuffer::fence(size_t offset, size_t size)
+{
+    if (auto sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)) {
+        m_fences.push_back(Fence{
+            .sync = sync,
+            .begin = offset,
+            .end = offset + size,
+        });
+    }
+}
+
 //****************************************
 // GLTexture
 //****************************************
@@ -38,6 +193,7 @@ bool GLTexturePrivate::s_supportsTextureSwizzle = false;
 bool GLTexturePrivate::s_supportsTextureFormatRG = false;
 bool GLTexturePrivate::s_supportsTexture16Bit = false;
 uint GLTexturePrivate::s_fbo = 0;
+std::unique_ptr<GLUploadBuffer> GLTexturePrivate::s_uploadBuffer;
 
 // Table of GL formats/types associated with different values of QImage::Format.
 // Zero values indicate a direct upload is not feasible.
@@ -82,6 +238,34 @@ struct
     {0, 0, 0}, // QImage::Format_BGR888
 };
 
+static qint64 textureMemorySize(GLenum internalFormat, const QSize &size, int levels)
+{
+    int bytesPerPixel;
+    switch (internalFormat) {
+    case GL_R8:
+        bytesPerPixel = 1;
+        break;
+    case GL_RG8:
+    case GL_R16:
+        bytesPerPixel = 2;
+        break;
+    case GL_RGBA16:
+    case GL_RGBA16F:
+        bytesPerPixel = 8;
+        break;
+    case GL_RGBA32F:
+        bytesPerPixel = 16;
+        break;
+    default:
+        // most drivers pad 24 bit formats to 32 bits as well
+        bytesPerPixel = 4;
+        break;
+    }
+    const qint64 baseLevel = qint64(size.width()) * size.height() * bytesPerPixel;
+    // a full mipmap chain adds a third
+    return levels > 1 ? baseLevel * 4 / 3 : baseLevel;
+}
+
 GLTexture::GLTexture(GLenum target)
     : d_ptr(new GLTexturePrivate())
 {
@@ -178,6 +362,7 @@ GLTexture::GLTexture(const QImage &image, GLenum target)
 
     unbind();
     setFilter(GL_LINEAR);
+    d->setMemorySize(textureMemorySize(d->m_internalFormat, d->m_size, d->m_mipLevels));
 }
 
 GLTexture::GLTexture(const QPixmap &pixmap, GLenum target)
@@ -232,6 +417,7 @@ GLTexture::GLTexture(GLenum internalFormat, int width, int height, int levels, b
     }
 
     unbind();
+    d->setMemorySize(textureMemorySize(d->m_internalFormat, d->m_size, levels));
 }
 
 GLTexture::GLTexture(GLenum internalFormat, const QSize &size, int levels, bool needsMutability)
@@ -300,6 +486,14 @@ GLTexturePrivate::~GLTexturePrivate()
     if (m_texture != 0 && !m_foreign) {
         glDeleteTextures(1, &m_texture);
     }
+    setMemorySize(0);
+}
+
+void GLTexturePrivate::setMemorySize(qint64 bytes)
+{
+    GLTextureMemory::account(m_memoryCategory, bytes - m_memorySize);
+    GLTextureMemory::accountOwner(m_memoryOwner, bytes - m_memorySize);
+    m_memorySize = bytes;
 }
 
 void GLTexturePrivate::initStatic()
@@ -327,12 +521,24 @@ void GLTexturePrivate::initStatic()
 
         s_supportsUnpack = hasGLExtension(QByteArrayLiteral("GL_EXT_unpack_subimage"));
     }
+
+    bool haveUploadBuffer;
+    if (!GLPlatform::instance()->isGLES()) {
+        haveUploadBuffer = (hasGLVersion(4, 4) || hasGLExtension(QByteArrayLiteral("GL_ARB_buffer_storage")))
+            && (hasGLVersion(3, 2) || hasGLExtension(QByteArrayLiteral("GL_ARB_sync")));
+    } else {
+        haveUploadBuffer = hasGLVersion(3, 0) && hasGLExtension(QByteArrayLiteral("GL_EXT_buffer_storage"));
+    }
+    if (haveUploadBuffer && qgetenv("KWIN_PERSISTENT_PBO") != QByteArrayLiteral("0")) {
+        s_uploadBuffer = std::make_unique<GLUploadBuffer>();
+    }
 }
 
 void GLTexturePrivate::cleanup()
 {
     s_supportsFramebufferObjects = false;
     s_supportsARGB32 = false;
+    s_uploadBuffer.reset();
     if (s_fbo) {
         glDeleteFramebuffers(1, &s_fbo);
         s_fbo = 0;
@@ -361,6 +567,32 @@ void GLTexture::setSize(const QSize &size)
     d->updateMatrix();
 }
 
+static void uploadFormatFor(QImage::Format format, GLenum *glFormat, GLenum *type, QImage::Format *uploadFormat)
+{
+    if (!GLPlatform::instance()->isGLES()) {
+        if (format < sizeof(formatTable) / sizeof(formatTable[0]) && formatTable[format].internalFormat
+            && !(formatTable[format].type == GL_UNSIGNED_SHORT && !GLTexturePrivate::s_supportsTexture16Bit)) {
+            *glFormat = formatTable[format].format;
+            *type = formatTable[format].type;
+            *uploadFormat = format;
+        } else {
+            *glFormat = GL_BGRA;
+            *type = GL_UNSIGNED_INT_8_8_8_8_REV;
+            *uploadFormat = QImage::Format_ARGB32_Premultiplied;
+        }
+    } else {
+        if (GLTexturePrivate::s_supportsARGB32) {
+            *glFormat = GL_BGRA_EXT;
+            *type = GL_UNSIGNED_BYTE;
+            *uploadFormat = QImage::Format_ARGB32_Premultiplied;
+        } else {
+            *glFormat = GL_RGBA;
+            *type = GL_UNSIGNED_BYTE;
+            *uploadFormat = QImage::Format_RGBA8888_Premultiplied;
+        }
+    }
+}
+
 void GLTexture::update(const QImage &image, const QPoint &offset, const QRect &src)
 {
     if (image.isNull() || isNull()) {
@@ -373,30 +605,8 @@ void GLTexture::update(const QImage &image, const QPoint &offset, const QRect &s
     GLenum glFormat;
     GLenum type;
     QImage::Format uploadFormat;
-    if (!GLPlatform::instance()->isGLES()) {
-        const QImage::Format index = image.format();
+    uploadFormatFor(image.format(), &glFormat, &type, &uploadFormat);
 
-        if (index < sizeof(formatTable) / sizeof(formatTable[0]) && formatTable[index].internalFormat
-            && !(formatTable[index].type == GL_UNSIGNED_SHORT && !d->s_supportsTexture16Bit)) {
-            glFormat = formatTable[index].format;
-            type = formatTable[index].type;
-            uploadFormat = index;
-        } else {
-            glFormat = GL_BGRA;
-            type = GL_UNSIGNED_INT_8_8_8_8_REV;
-            uploadFormat = QImage::Format_ARGB32_Premultiplied;
-        }
-    } else {
-        if (d->s_supportsARGB32) {
-            glFormat = GL_BGRA_EXT;
-            type = GL_UNSIGNED_BYTE;
-            uploadFormat = QImage::Format_ARGB32_Premultiplied;
-        } else {
-            glFormat = GL_RGBA;
-            type = GL_UNSIGNED_BYTE;
-            uploadFormat = QImage::Format_RGBA8888_Premultiplied;
-        }
-    }
     bool useUnpack = d->s_supportsUnpack && image.format() == uploadFormat && !src.isNull();
 
     QImage im;
@@ -437,6 +647,188 @@ void GLTexture::update(const QImage &image, const QPoint &offset, const QRect &s
     }
 }
 
+namespace
+{
+struct StagedRows
+{
+    uint8_t *data;
+    int width;
+    int height;
+    int stride;
+};
+}
+
+static QThreadPool *conversionPool()
+{
+    static QThreadPool pool;
+    return &pool;
+}
+
+static void convertRows(const StagedRows &rows, QImage::Format from, QImage::Format to)
+{
+    const QImage converted = QImage(rows.data, rows.width, rows.height, rows.stride, from).convertToFormat(to);
+    const int rowSize = rows.width * converted.depth() / 8;
+    for (int y = 0; y < rows.height; ++y) {
+        memcpy(rows.data + y * rows.stride, converted.constScanLine(y), rowSize);
+    }
+}
+
+/**
+ * Converts the staged pixels in place. Large updates are split in bands of rows, which are
+ * converted by a pool of worker threads. Qt has vectorized converters for the common formats.
+ */
+static void convertStagedRows(const std::vector<StagedRows> &rects, QImage::Format from, QImage::Format to)
+{
+    constexpr int minimumBandHeight = 32;
+    constexpr int minimumParallelPixels = 256 * 256;
+
+    qint64 pixels = 0;
+    for (const StagedRows &rect : rects) {
+        pixels += qint64(rect.width) * rect.height;
+    }
+    if (pixels < minimumParallelPixels || QThread::idealThreadCount() < 2) {
+        for (const StagedRows &rect : rects) {
+            convertRows(rect, from, to);
+        }
+        return;
+    }
+
+    std::vector<StagedRows> bands;
+    const qint64 bandPixels = std::max<qint64>(pixels / QThread::idealThreadCount(), minimumParallelPixels / 4);
+    for (const StagedRows &rect : rects) {
+        const int bandHeight = std::max<int>(minimumBandHeight, bandPixels / rect.width);
+        for (int y = 0; y < rect.height; y += bandHeight) {
+            bands.push_back(StagedRows{
+                .data = rect.data + y * rect.stride,
+                .width = rect.width,
+                .height = std::min(bandHeight, rect.height - y),
+                .stride = rect.stride,
+            });
+        }
+    }
+
+    QThreadPool *pool = conversionPool();
+    for (size_t i = 1; i < bands.size(); ++i) {
+        pool->start([band = bands[i], from, to]() {
+            convertRows(band, from, to);
+        });
+    }
+    convertRows(bands.front(), from, to);
+    pool->waitForDone();
+}
+
+void GLTexture::update(const QImage &image, const QRegion &region)
+{
+    if (image.isNull() || isNull() || region.isEmpty()) {
+        return;
+    }
+
+    Q_D(GLTexture);
+    Q_ASSERT(!d->m_foreign);
+
+    GLenum glFormat;
+    GLenum type;
+    QImage::Format uploadFormat;
+    uploadFormatFor(image.format(), &glFormat, &type, &uploadFormat);
+
+    const QRegion damage = region & image.rect() & QRect(QPoint(0, 0), d->m_size);
+    const bool convert = image.format() != uploadFormat;
+    const int bytesPerPixel = image.depth() / 8;
+    const int uploadBytesPerPixel = QImage::toPixelFormat(uploadFormat).bitsPerPixel() / 8;
+    const int stagedBytesPerPixel = std::max(bytesPerPixel, uploadBytesPerPixel);
+
+    // Without a pixel buffer, pixels that don't need to be converted are uploaded directly. Rows
+    // that shrink during the conversion need to be uploaded with a row length
+    if (image.depth() % 8 != 0 || (!d->s_uploadBuffer && !convert) || (stagedBytesPerPixel != uploadBytesPerPixel && !d->s_supportsUnpack)) {
+        for (const QRect &rect : damage) {
+            update(image, rect.topLeft(), rect);
+        }
+        return;
+    }
+
+    // Rows are padded to the default unpack alignment of 4
+    size_t size = 0;
+    for (const QRect &rect : damage) {
+        size += ((rect.width() * stagedBytesPerPixel + 3) & ~3) * rect.height();
+    }
+
+    std::optional<size_t> offset;
+    if (d->s_uploadBuffer) {
+        offset = d->s_uploadBuffer->allocate(size);
+    }
+    // The mapping of the pixel buffer is write only and reading it back can be very slow,
+    // so pixels that need to be converted are staged in system memory
+    std::vector<uint8_t> localStorage;
+    uint8_t *staging;
+    if (convert) {
+        localStorage.resize(size);
+        staging = localStorage.data();
+    } else if (offset) {
+        staging = d->s_uploadBuffer->map() + *offset;
+    } else {
+        for (const QRect &rect : damage) {
+            update(image, rect.topLeft(), rect);
+        }
+        return;
+    }
+
+    // The shm buffers of clients can only be safely read on this thread, so the pixels are
+    // copied first and converted afterwards
+    std::vector<StagedRows> stagedRects;
+    stagedRects.reserve(damage.rectCount());
+    size_t rectOffset = 0;
+    for (const QRect &rect : damage) {
+        const int rowSize = rect.width() * bytesPerPixel;
+        const int stride = (rect.width() * stagedBytesPerPixel + 3) & ~3;
+        uint8_t *dst = staging + rectOffset;
+        for (int y = 0; y < rect.height(); ++y) {
+            memcpy(dst + y * stride, image.constScanLine(rect.y() + y) + rect.x() * bytesPerPixel, rowSize);
+        }
+        stagedRects.push_back(StagedRows{
+            .data = dst,
+            .width = rect.width(),
+            .height = rect.height(),
+            .stride = stride,
+        });
+        rectOffset += stride * rect.height();
+    }
+
+    if (convert) {
+        convertStagedRows(stagedRects, image.format(), uploadFormat);
+        if (offset) {
+            memcpy(d->s_uploadBuffer->map() + *offset, staging, size);
+        }
+    }
+
+    bind();
+    if (offset) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, d->s_uploadBuffer->buffer());
+    }
+
+    int i = 0;
+    for (const QRect &rect : damage) {
+        const StagedRows &rows = stagedRects[i++];
+        const bool padded = rows.stride != ((rect.width() * uploadBytesPerPixel + 3) & ~3);
+        if (padded) {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, rows.stride / uploadBytesPerPixel);
+        }
+        const uintptr_t pixels = offset ? *offset + (rows.data - staging) : reinterpret_cast<uintptr_t>(rows.data);
+        glTexSubImage2D(d->m_target, 0, rect.x(), rect.y(), rect.width(), rect.height(), glFormat, type, reinterpret_cast<const void *>(pixels));
+        if (padded) {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        }
+    }
+
+    if (offset) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    unbind();
+
+    if (offset) {
+        d->s_uploadBuffer->fence(*offset, size);
+    }
+}
+
 void GLTexture::discard()
 {
     d_ptr = new GLTexturePrivate();
@@ -449,8 +841,11 @@ void GLTexture::bind()
 
     glBindTexture(d->m_target, d->m_texture);
 
+    // the texture is refreshed once per batch of damage, not every time it's bound, e.g. by
+    // thumbnails or by effects that paint the window several times in a frame
     if (d->m_markedDirty) {
         d->onDamage();
+        d->m_markedDirty = false;
     }
     if (d->m_filterChanged) {
         GLenum minFilter = GL_NEAREST;
@@ -593,6 +988,22 @@ GLenum GLTexture::internalFormat() const
     return d->m_internalFormat;
 }
 
+void GLTexture::setMemoryCategory(GLTextureMemory::Category category)
+{
+    Q_D(GLTexture);
+    if (d->m_memoryCategory != category) {
+        GLTextureMemory::account(d->m_memoryCategory, -d->m_memorySize);
+        GLTextureMemory::account(category, d->m_memorySize);
+        d->m_memoryCategory = category;
+    }
+}
+
+GLTextureMemory::Category GLTexture::memoryCategory() const
+{
+    Q_D(const GLTexture);
+    return d->m_memoryCategory;
+}
+
 void GLTexture::clear()
 {
     Q_D(GLTexture);
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include "libkwineffects/gltexturememory.h"
 #include "libkwineffects/kwinglutils_export.h"
 
 #include <QExplicitlySharedDataPointer>
@@ -114,6 +115,13 @@ public:
     QMatrix4x4 matrix(TextureCoordinateType type) const;
 
     void update(const QImage &image, const QPoint &offset = QPoint(0, 0), const QRect &src = QRect());
+    /**
+     * Uploads the parts of @a image in @a region to the same location in the texture.
+     *
+     * If persistently mapped buffers are supported, the pixels are staged in a pixel
+     * buffer object and all rects are uploaded in one go without waiting for the GPU.
+     */
+    void update(const QImage &image, const QRegion &region);
     virtual void discard();
     void bind();
     void unbind();
@@ -126,6 +134,13 @@ public:
     GLenum filter() const;
     GLenum internalFormat() const;
 
+    /**
+     * Sets the category the memory allocated for the texture is accounted to in
+     * GLTextureMemory. The default is GLTextureMemory::Category::Other.
+     */
+    void setMemoryCategory(GLTextureMemory::Category category);
+    GLTextureMemory::Category memoryCategory() const;
+
     QImage toImage() const;
 
     /** @short
@@ -133,6 +148,9 @@ public:
      */
     void clear();
     /**
+     * Marks the contents of the texture as modified. The texture is refreshed the next time
+     * it's bound, which resets the dirty flag.
+     *
      * @deprecated track modifications to the texture yourself
      */
     void setDirty();
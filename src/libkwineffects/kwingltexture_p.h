@@ -24,6 +24,7 @@
 namespace KWin
 {
 // forward declarations
+class GLUploadBuffer;
 class GLVertexBuffer;
 
 class KWINGLUTILS_EXPORT GLTexturePrivate
@@ -36,6 +37,10 @@ public:
     virtual void onDamage();
 
     void updateMatrix();
+    /**
+     * Accounts @p bytes of texture memory to the texture, replacing what was accounted before.
+     */
+    void setMemorySize(qint64 bytes);
 
     GLuint m_texture;
     GLenum m_target;
@@ -54,6 +59,10 @@ public:
     bool m_immutable;
     bool m_foreign;
     int m_mipLevels;
+    qint64 m_memorySize = 0;
+    // the owner when the texture was created, see GLTextureMemory::setOwner()
+    const void *m_memoryOwner = GLTextureMemory::owner();
+    GLTextureMemory::Category m_memoryCategory = GLTextureMemory::Category::Other;
 
     int m_unnormalizeActive; // 0 - no, otherwise refcount
     int m_normalizeActive; // 0 - no, otherwise refcount
@@ -71,6 +80,7 @@ public:
     static bool s_supportsTextureFormatRG;
     static bool s_supportsTexture16Bit;
     static GLuint s_fbo;
+    static std::unique_ptr<GLUploadBuffer> s_uploadBuffer;
 
 private:
     friend void KWin::cleanupGL();
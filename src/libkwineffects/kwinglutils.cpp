@@ -13,12 +13,15 @@
 // need to call GLTexturePrivate::initStatic()
 #include "kwingltexture_p.h"
 
+#include "kwinglshadercache_p.h"
+
 #include "libkwineffects/kwineffects.h"
 #include "libkwineffects/kwinglplatform.h"
 #include "libkwineffects/rendertarget.h"
 #include "libkwineffects/renderviewport.h"
 #include "logging_p.h"
 
+#include <QCryptographicHash>
 #include <QFile>
 #include <QHash>
 #include <QImage>
@@ -29,8 +32,10 @@
 #include <QVector3D>
 #include <QVector4D>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <deque>
 
 #define DEBUG_GLFRAMEBUFFER 0
@@ -132,18 +137,9 @@ static void initDebugOutput()
 
 void initGL(const std::function<resolveFuncPtr(const char *)> &resolveFunction)
 {
-    // Get list of supported OpenGL extensions
-    if (hasGLVersion(3, 0)) {
-        int count;
-        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
-
-        for (int i = 0; i < count; i++) {
-            const QByteArray name = (const char *)glGetStringi(GL_EXTENSIONS, i);
-            glExtensions << name;
-        }
-    } else {
-        glExtensions = QByteArray((const char *)glGetString(GL_EXTENSIONS)).split(' ');
-    }
+    // The list of supported OpenGL extensions has been queried by GLPlatform::detect() already
+    const QSet<QByteArray> extensions = GLPlatform::instance()->extensions();
+    glExtensions = QList<QByteArray>(extensions.constBegin(), extensions.constEnd());
 
     // handle OpenGL extensions functions
     glResolveFunctions(resolveFunction);
@@ -158,6 +154,7 @@ void initGL(const std::function<resolveFuncPtr(const char *)> &resolveFunction)
 void cleanupGL()
 {
     ShaderManager::cleanup();
+    GLShaderCache::cleanup();
     GLTexturePrivate::cleanup();
     GLFramebuffer::cleanup();
     GLVertexBuffer::cleanup();
@@ -231,6 +228,7 @@ GLShader::GLShader(unsigned int flags)
     : mValid(false)
     , mLocationsResolved(false)
     , mExplicitLinking(flags & ExplicitLinking)
+    , mDeferredCompilation(false)
 {
     mProgram = glCreateProgram();
 }
@@ -239,6 +237,7 @@ GLShader::GLShader(const QString &vertexfile, const QString &fragmentfile, unsig
     : mValid(false)
     , mLocationsResolved(false)
     , mExplicitLinking(flags & ExplicitLinking)
+    , mDeferredCompilation(false)
 {
     mProgram = glCreateProgram();
     loadFromFiles(vertexfile, fragmentfile);
@@ -272,6 +271,28 @@ bool GLShader::loadFromFiles(const QString &vertexFile, const QString &fragmentF
 
 bool GLShader::link()
 {
+    // linking resets the uniforms
+    mUniformCache.clear();
+
+    QByteArray key;
+    if (mDeferredCompilation) {
+        mDeferredCompilation = false;
+        key = cacheKey();
+
+        const bool loaded = GLShaderCache::instance()->load(mProgram, key);
+        const bool compiled = loaded || compileSources(mVertexSource, mFragmentSource);
+        mVertexSource.clear();
+        mFragmentSource.clear();
+        if (loaded) {
+            mValid = true;
+            return true;
+        } else if (!compiled) {
+            mValid = false;
+            return false;
+        }
+        glProgramParameteri(mProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     // Be optimistic
     mValid = true;
 
@@ -297,9 +318,25 @@ bool GLShader::link()
         qCDebug(LIBKWINGLUTILS) << "Shader link log:" << log;
     }
 
+    if (mValid && !key.isEmpty()) {
+        GLShaderCache::instance()->store(mProgram, key);
+    }
+
     return mValid;
 }
 
+QByteArray GLShader::cacheKey() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(mVertexSource);
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(mFragmentSource);
+    hash.addData(QByteArrayView("\0", 1));
+    // the locations are baked into the binary
+    hash.addData(mBindings);
+    return hash.result();
+}
+
 const QByteArray GLShader::prepareSource(GLenum shaderType, const QByteArray &source) const
 {
     // Prepare the source code
@@ -366,6 +403,25 @@ bool GLShader::load(const QByteArray &vertexSource, const QByteArray &fragmentSo
 
     mValid = false;
 
+    if (GLShaderCache::instance()) {
+        // The program might be in the shader cache, compile it in link() only if it's not
+        mVertexSource = vertexSource;
+        mFragmentSource = fragmentSource;
+        mDeferredCompilation = true;
+    } else if (!compileSources(vertexSource, fragmentSource)) {
+        return false;
+    }
+
+    if (mExplicitLinking) {
+        return true;
+    }
+
+    // link() sets mValid
+    return link();
+}
+
+bool GLShader::compileSources(const QByteArray &vertexSource, const QByteArray &fragmentSource)
+{
     // Compile the vertex shader
     if (!vertexSource.isEmpty()) {
         bool success = compile(mProgram, GL_VERTEX_SHADER, vertexSource);
@@ -384,23 +440,20 @@ bool GLShader::load(const QByteArray &vertexSource, const QByteArray &fragmentSo
         }
     }
 
-    if (mExplicitLinking) {
-        return true;
-    }
-
-    // link() sets mValid
-    return link();
+    return true;
 }
 
 void GLShader::bindAttributeLocation(const char *name, int index)
 {
     glBindAttribLocation(mProgram, index, name);
+    mBindings += QByteArrayLiteral("attribute ") + name + ' ' + QByteArray::number(index) + '\n';
 }
 
 void GLShader::bindFragDataLocation(const char *name, int index)
 {
     if (!GLPlatform::instance()->isGLES() && (hasGLVersion(3, 0) || hasGLExtension(QByteArrayLiteral("GL_EXT_gpu_shader4")))) {
         glBindFragDataLocation(mProgram, index, name);
+        mBindings += QByteArrayLiteral("fragdata ") + name + ' ' + QByteArray::number(index) + '\n';
     }
 }
 
@@ -531,9 +584,29 @@ bool GLShader::setUniform(const char *name, const QColor &color)
     return setUniform(location, color);
 }
 
+bool GLShader::updateUniformCache(int location, const void *value, size_t size)
+{
+    Q_ASSERT(size <= sizeof(CachedUniform::value));
+    for (CachedUniform &uniform : mUniformCache) {
+        if (uniform.location == location) {
+            if (uniform.size == size && std::memcmp(uniform.value.data(), value, size) == 0) {
+                return false;
+            }
+            uniform.size = size;
+            std::memcpy(uniform.value.data(), value, size);
+            return true;
+        }
+    }
+    CachedUniform &uniform = mUniformCache.emplace_back();
+    uniform.location = location;
+    uniform.size = size;
+    std::memcpy(uniform.value.data(), value, size);
+    return true;
+}
+
 bool GLShader::setUniform(int location, float value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, &value, sizeof(value))) {
         glUniform1f(location, value);
     }
     return (location >= 0);
@@ -541,7 +614,7 @@ bool GLShader::setUniform(int location, float value)
 
 bool GLShader::setUniform(int location, int value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, &value, sizeof(value))) {
         glUniform1i(location, value);
     }
     return (location >= 0);
@@ -549,7 +622,7 @@ bool GLShader::setUniform(int location, int value)
 
 bool GLShader::setUniform(int location, const QVector2D &value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, &value, sizeof(GLfloat) * 2)) {
         glUniform2fv(location, 1, (const GLfloat *)&value);
     }
     return (location >= 0);
@@ -557,7 +630,7 @@ bool GLShader::setUniform(int location, const QVector2D &value)
 
 bool GLShader::setUniform(int location, const QVector3D &value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, &value, sizeof(GLfloat) * 3)) {
         glUniform3fv(location, 1, (const GLfloat *)&value);
     }
     return (location >= 0);
@@ -565,7 +638,7 @@ bool GLShader::setUniform(int location, const QVector3D &value)
 
 bool GLShader::setUniform(int location, const QVector4D &value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, &value, sizeof(GLfloat) * 4)) {
         glUniform4fv(location, 1, (const GLfloat *)&value);
     }
     return (location >= 0);
@@ -573,7 +646,7 @@ bool GLShader::setUniform(int location, const QVector4D &value)
 
 bool GLShader::setUniform(int location, const QMatrix4x4 &value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, value.constData(), sizeof(GLfloat) * 16)) {
         glUniformMatrix4fv(location, 1, GL_FALSE, value.constData());
     }
     return (location >= 0);
@@ -581,8 +654,9 @@ bool GLShader::setUniform(int location, const QMatrix4x4 &value)
 
 bool GLShader::setUniform(int location, const QColor &color)
 {
-    if (location >= 0) {
-        glUniform4f(location, color.redF(), color.greenF(), color.blueF(), color.alphaF());
+    const GLfloat value[] = {GLfloat(color.redF()), GLfloat(color.greenF()), GLfloat(color.blueF()), GLfloat(color.alphaF())};
+    if (location >= 0 && updateUniformCache(location, value, sizeof(value))) {
+        glUniform4fv(location, 1, value);
     }
     return (location >= 0);
 }
@@ -984,7 +1058,14 @@ GLFramebuffer *GLFramebuffer::popFramebuffer()
 {
     GLFramebuffer *ret = s_fbos.pop();
     if (!s_fbos.isEmpty()) {
-        s_fbos.top()->bind();
+        // only rebind if a different framebuffer is on top of the stack, but always restore
+        // the viewport like bind() does, it may have been changed in the meantime
+        GLFramebuffer *top = s_fbos.top();
+        if (top != ret) {
+            top->bind();
+        } else {
+            glViewport(0, 0, top->size().width(), top->size().height());
+        }
     } else {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
@@ -1606,13 +1687,9 @@ public:
         m_index = (m_index + 1) % Count;
     }
 
-    size_t average() const
+    size_t peak() const
     {
-        size_t sum = 0;
-        for (size_t size : m_array) {
-            sum += size;
-        }
-        return sum / Count;
+        return *std::max_element(m_array.begin(), m_array.end());
     }
 
 private:
@@ -1682,6 +1759,8 @@ public:
     static bool haveSyncFences;
     static bool hasMapBufferRange;
     static bool supportsIndexedQuads;
+    static constexpr size_t s_framesInFlight = 3;
+    static constexpr int s_shrinkFrameCount = 600;
     QByteArray dataStore;
     bool persistent;
     bool useColor;
@@ -1694,7 +1773,9 @@ public:
     intptr_t baseAddress;
     uint8_t *map;
     std::deque<BufferFence> fences;
-    FrameSizesArray<4> frameSizes;
+    FrameSizesArray<60> frameSizes;
+    int smallFrameCount = 0;
+    GLVertexBuffer::Statistics statistics;
     VertexAttrib attrib[VertexAttributeCount];
     Bitfield enabledArrays;
     static std::unique_ptr<IndexBuffer> s_indexBuffer;
@@ -1788,9 +1869,14 @@ void GLVertexBufferPrivate::reallocatePersistentBuffer(size_t size)
         glGenBuffers(1, &buffer);
     }
 
-    // Round the size up to 64 kb
-    size_t minSize = std::max<size_t>(frameSizes.average() * 3, 128 * 1024);
-    bufferSize = std::max(size, minSize);
+    // Leave room for three frames in flight, so the ring only waits for the GPU when it
+    // falls behind by more than two frames. Round the size up to 64 kb
+    const size_t minSize = std::max<size_t>(frameSizes.peak() * s_framesInFlight, 128 * 1024);
+    bufferSize = align(std::max(size, minSize), 64 * 1024);
+
+    statistics.bufferSize = bufferSize;
+    statistics.reallocations++;
+    qCDebug(LIBKWINGLUTILS) << "Allocated a persistently mapped buffer of" << bufferSize << "bytes, peak frame size:" << frameSizes.peak();
 
     const GLbitfield storage = GL_DYNAMIC_STORAGE_BIT;
     const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
@@ -1818,8 +1904,13 @@ bool GLVertexBufferPrivate::awaitFence(intptr_t end)
     const BufferFence &fence = fences.front();
 
     if (!fence.signaled()) {
-        qCDebug(LIBKWINGLUTILS) << "Stalling on VBO fence";
+        const auto stallStart = std::chrono::steady_clock::now();
         const GLenum ret = glClientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        const auto stallTime = std::chrono::steady_clock::now() - stallStart;
+
+        statistics.stalls++;
+        statistics.stallTime += stallTime;
+        qCDebug(LIBKWINGLUTILS) << "Stalled on VBO fence for" << std::chrono::duration_cast<std::chrono::microseconds>(stallTime).count() << "us";
 
         if (ret == GL_TIMEOUT_EXPIRED || ret == GL_WAIT_FAILED) {
             qCCritical(LIBKWINGLUTILS) << "Wait failed";
@@ -1839,7 +1930,8 @@ bool GLVertexBufferPrivate::awaitFence(intptr_t end)
 GLvoid *GLVertexBufferPrivate::getIdleRange(size_t size)
 {
     if (unlikely(size > bufferSize)) {
-        reallocatePersistentBuffer(size * 2);
+        // frameSize already includes this upload, the next frames will likely be as large
+        reallocatePersistentBuffer(std::max(size * 2, frameSize * s_framesInFlight));
     }
 
     // Handle wrap-around
@@ -2139,11 +2231,23 @@ void GLVertexBuffer::endOfFrame()
     // Emit a fence if we have uploaded data
     if (d->frameSize > 0) {
         d->frameSizes.push(d->frameSize);
+        d->statistics.lastFrameSize = d->frameSize;
+        d->statistics.peakFrameSize = d->frameSizes.peak();
+
+        // Grow the buffer as soon as it can't hold three frames of the recent peak, and
+        // shrink it only after the frames have been small for a while, so e.g. opening
+        // overview doesn't reallocate every time
+        const size_t demand = d->frameSizes.peak() * GLVertexBufferPrivate::s_framesInFlight;
+        bool reallocate = demand > d->bufferSize;
+        if (demand * 4 < d->bufferSize && d->bufferSize > 128 * 1024) {
+            reallocate = ++d->smallFrameCount >= GLVertexBufferPrivate::s_shrinkFrameCount;
+        } else {
+            d->smallFrameCount = 0;
+        }
         d->frameSize = 0;
 
         // Force the buffer to be reallocated at the beginning of the next frame
-        // if the average frame size is greater than half the size of the buffer
-        if (unlikely(d->frameSizes.average() > d->bufferSize / 2)) {
+        if (unlikely(reallocate)) {
             deleteAll(d->fences);
             glDeleteBuffers(1, &d->buffer);
 
@@ -2151,6 +2255,7 @@ void GLVertexBuffer::endOfFrame()
             d->bufferSize = 0;
             d->nextOffset = 0;
             d->map = nullptr;
+            d->smallFrameCount = 0;
         } else {
             if (auto sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)) {
                 d->fences.push_back(BufferFence{
@@ -2177,6 +2282,11 @@ void GLVertexBuffer::beginFrame()
     }
 }
 
+GLVertexBuffer::Statistics GLVertexBuffer::statistics() const
+{
+    return d->statistics;
+}
+
 void GLVertexBuffer::initStatic()
 {
     if (GLPlatform::instance()->isGLES()) {
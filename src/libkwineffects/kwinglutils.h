@@ -18,6 +18,10 @@
 #include <QSize>
 #include <QStack>
 
+#include <array>
+#include <chrono>
+#include <vector>
+
 /** @addtogroup kwineffects */
 /** @{ */
 
@@ -85,6 +89,11 @@ public:
     bool setUniform(const char *name, const QMatrix4x4 &value);
     bool setUniform(const char *name, const QColor &color);
 
+    /**
+     * The values of the uniforms are remembered, setting a uniform to the value it already
+     * has doesn't upload it again. The uniforms of the shader must not be changed with
+     * glUniform*() directly.
+     */
     bool setUniform(int location, float value);
     bool setUniform(int location, int value);
     bool setUniform(int location, const QVector2D &value);
@@ -157,16 +166,34 @@ protected:
     void resolveLocations();
 
 private:
+    bool compileSources(const QByteArray &vertexSource, const QByteArray &fragmentSource);
+    QByteArray cacheKey() const;
+    bool updateUniformCache(int location, const void *value, size_t size);
+
+    struct CachedUniform
+    {
+        int location;
+        size_t size;
+        std::array<GLfloat, 16> value;
+    };
+
     unsigned int mProgram;
     bool mValid : 1;
     bool mLocationsResolved : 1;
     bool mExplicitLinking : 1;
+    bool mDeferredCompilation : 1;
+    // kept until link() if the program may be loaded from the shader cache
+    QByteArray mVertexSource;
+    QByteArray mFragmentSource;
+    QByteArray mBindings;
     int mMatrixLocation[MatrixCount];
     int mVec2Location[Vec2UniformCount];
     int mVec4Location[Vec4UniformCount];
     int mFloatLocation[FloatUniformCount];
     int mIntLocation[IntUniformCount];
     int mColorLocation[ColorUniformCount];
+    // the values of the uniforms that have been set so far
+    std::vector<CachedUniform> mUniformCache;
 
     friend class ShaderManager;
 };
@@ -702,6 +729,25 @@ public:
      */
     void beginFrame();
 
+    /**
+     * Statistics about the uploads to a persistently mapped buffer, e.g. the streaming buffer.
+     */
+    struct Statistics
+    {
+        size_t bufferSize = 0;
+        size_t lastFrameSize = 0;
+        size_t peakFrameSize = 0;
+        uint reallocations = 0;
+        uint stalls = 0;
+        std::chrono::nanoseconds stallTime = std::chrono::nanoseconds::zero();
+    };
+
+    /**
+     * Returns the upload statistics of the buffer, they are only collected for
+     * persistently mapped buffers.
+     */
+    Statistics statistics() const;
+
     /**
      * @internal
      */
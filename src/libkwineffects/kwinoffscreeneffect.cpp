@@ -10,25 +10,142 @@
 #include "libkwineffects/rendertarget.h"
 #include "libkwineffects/renderviewport.h"
 
+#include <algorithm>
+#include <deque>
+
 namespace KWin
 {
 
+// the sizes of the pooled textures are rounded up to this, so windows of similar sizes share them
+static constexpr int s_poolGranularity = 64;
+// the memory that the idle textures in the pool may keep allocated
+static constexpr qint64 s_poolMemoryLimit = 128 * 1024 * 1024;
+
+static QSize poolBucketSize(const QSize &size)
+{
+    const auto roundUp = [](int value) {
+        return std::max(1, (value + s_poolGranularity - 1) / s_poolGranularity) * s_poolGranularity;
+    };
+    return QSize(roundUp(size.width()), roundUp(size.height()));
+}
+
+static qint64 textureBytes(const GLTexture *texture)
+{
+    const int bytesPerPixel = texture->internalFormat() == GL_RGBA16F ? 8 : 4;
+    return qint64(texture->width()) * texture->height() * bytesPerPixel;
+}
+
+struct OffscreenTarget
+{
+    std::unique_ptr<GLTexture> texture;
+    std::unique_ptr<GLFramebuffer> framebuffer;
+};
+
+/**
+ * The OffscreenTargetPool class keeps the render targets of unredirected windows around, so
+ * the next redirected window of a similar size reuses them instead of allocating new ones. The
+ * pool is shared by all offscreen effects and goes away together with the last of them.
+ */
+class OffscreenTargetPool
+{
+public:
+    OffscreenTargetPool();
+
+    static std::shared_ptr<OffscreenTargetPool> shared();
+
+    OffscreenTarget acquire(const QSize &size, GLenum format);
+    void release(OffscreenTarget &&target);
+
+private:
+    void trim(qint64 limit);
+
+    // the most recently released targets are at the back
+    std::deque<OffscreenTarget> m_idle;
+    qint64 m_idleBytes = 0;
+    std::unique_ptr<GLTextureCacheEntry> m_cacheEntry;
+};
+
+OffscreenTargetPool::OffscreenTargetPool()
+    : m_cacheEntry(std::make_unique<GLTextureCacheEntry>([this]() {
+        trim(0);
+        return true;
+    }))
+{
+}
+
+std::shared_ptr<OffscreenTargetPool> OffscreenTargetPool::shared()
+{
+    static std::weak_ptr<OffscreenTargetPool> pool;
+    std::shared_ptr<OffscreenTargetPool> ret = pool.lock();
+    if (!ret) {
+        ret = std::make_shared<OffscreenTargetPool>();
+        pool = ret;
+    }
+    return ret;
+}
+
+OffscreenTarget OffscreenTargetPool::acquire(const QSize &size, GLenum format)
+{
+    const QSize bucket = poolBucketSize(size);
+    for (auto it = m_idle.rbegin(); it != m_idle.rend(); ++it) {
+        if (it->texture->size() == bucket && it->texture->internalFormat() == format) {
+            OffscreenTarget target = std::move(*it);
+            m_idle.erase(std::next(it).base());
+            m_idleBytes -= textureBytes(target.texture.get());
+            return target;
+        }
+    }
+
+    OffscreenTarget target;
+    target.texture = std::make_unique<GLTexture>(format, bucket);
+    target.texture->setMemoryCategory(GLTextureMemory::Category::Effect);
+    target.texture->setFilter(GL_LINEAR);
+    target.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    target.framebuffer = std::make_unique<GLFramebuffer>(target.texture.get());
+    return target;
+}
+
+void OffscreenTargetPool::release(OffscreenTarget &&target)
+{
+    if (!target.texture) {
+        return;
+    }
+    m_idleBytes += textureBytes(target.texture.get());
+    m_idle.push_back(std::move(target));
+    m_cacheEntry->touch();
+    trim(s_poolMemoryLimit);
+}
+
+void OffscreenTargetPool::trim(qint64 limit)
+{
+    while (m_idleBytes > limit && !m_idle.empty()) {
+        m_idleBytes -= textureBytes(m_idle.front().texture.get());
+        m_idle.pop_front();
+    }
+}
+
 struct OffscreenData
 {
 public:
+    OffscreenData();
     virtual ~OffscreenData();
-    void setDirty();
+    void addDamage(EffectWindow *window, const QRegion &region);
     void setShader(GLShader *newShader);
     void setVertexSnappingMode(RenderGeometry::VertexSnappingMode mode);
 
     void paint(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *window, const QRegion &region,
                const WindowPaintData &data, const WindowQuadList &quads);
 
-    void maybeRender(EffectWindow *window);
+    void maybeRender(EffectWindow *window, GLenum format);
 
 private:
-    std::unique_ptr<GLTexture> m_texture;
-    std::unique_ptr<GLFramebuffer> m_fbo;
+    std::shared_ptr<OffscreenTargetPool> m_pool;
+    OffscreenTarget m_target;
+    // the size of the window contents in the top-left corner of the texture
+    QSize m_contentSize;
+    std::unique_ptr<GLTextureCacheEntry> m_cacheEntry;
+    // the damaged part of the texture, relative to the expanded geometry of the window
+    QRegion m_damage;
     bool m_isDirty = true;
     GLShader *m_shader = nullptr;
     RenderGeometry::VertexSnappingMode m_vertexSnappingMode = RenderGeometry::VertexSnappingMode::Round;
@@ -37,10 +154,13 @@ private:
 class OffscreenEffectPrivate
 {
 public:
+    // keeps the pooled targets alive between animations
+    std::shared_ptr<OffscreenTargetPool> pool = OffscreenTargetPool::shared();
     std::map<EffectWindow *, std::unique_ptr<OffscreenData>> windows;
     QMetaObject::Connection windowDamagedConnection;
     QMetaObject::Connection windowDeletedConnection;
     RenderGeometry::VertexSnappingMode vertexSnappingMode = RenderGeometry::VertexSnappingMode::Round;
+    bool live = true;
 };
 
 OffscreenEffect::OffscreenEffect(QObject *parent)
@@ -89,30 +209,58 @@ void OffscreenEffect::apply(EffectWindow *window, int mask, WindowPaintData &dat
 {
 }
 
-void OffscreenData::maybeRender(EffectWindow *window)
+void OffscreenData::maybeRender(EffectWindow *window, GLenum format)
 {
     QRectF logicalGeometry = window->expandedGeometry();
     // FIXME no render target, as this isn't always called from rendering code
     // The texture size should take the scale into account though...
     QSize textureSize = logicalGeometry.toAlignedRect().size();
 
-    if (!m_texture || m_texture->size() != textureSize) {
-        m_texture.reset(new GLTexture(GL_RGBA8, textureSize));
-        m_texture->setFilter(GL_LINEAR);
-        m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
-        m_fbo.reset(new GLFramebuffer(m_texture.get()));
+    if (!m_target.texture || m_target.texture->size() != poolBucketSize(textureSize) || m_target.texture->internalFormat() != format) {
+        m_pool->release(std::move(m_target));
+        m_target = m_pool->acquire(textureSize, format);
         m_isDirty = true;
     }
-
-    if (m_isDirty) {
-        RenderTarget renderTarget(m_fbo.get());
-        RenderViewport viewport(logicalGeometry, 1, renderTarget);
-        GLFramebuffer::pushFramebuffer(m_fbo.get());
+    if (m_contentSize != textureSize) {
+        m_contentSize = textureSize;
+        m_isDirty = true;
+    }
+    if (!m_cacheEntry) {
+        // the contents can always be rendered again
+        m_cacheEntry = std::make_unique<GLTextureCacheEntry>([this]() {
+            m_target = OffscreenTarget{};
+            m_isDirty = true;
+            return true;
+        });
+    }
+    m_cacheEntry->touch();
+
+    if (m_isDirty || !m_damage.isEmpty()) {
+        // the texture can be larger than the window, which is rendered in its top-left corner
+        const QSize bucketSize = m_target.texture->size();
+        RenderTarget renderTarget(m_target.framebuffer.get());
+        RenderViewport viewport(QRectF(logicalGeometry.topLeft(), bucketSize), 1, renderTarget);
+        GLFramebuffer::pushFramebuffer(m_target.framebuffer.get());
         glClearColor(0.0, 0.0, 0.0, 0.0);
-        glClear(GL_COLOR_BUFFER_BIT);
+
+        // unless the whole window has changed, only the damaged part is rendered again
+        QRegion region = infiniteRegion();
+        if (m_isDirty) {
+            glClear(GL_COLOR_BUFFER_BIT);
+        } else {
+            region = m_damage.translated(logicalGeometry.toAlignedRect().topLeft());
+            const QRectF targetRect = viewport.mapToRenderTarget(viewport.renderRect());
+            glEnable(GL_SCISSOR_TEST);
+            for (const QRect &rect : region) {
+                const QRect deviceRect = viewport.mapToRenderTarget(rect);
+                glScissor(deviceRect.x(), targetRect.height() - (deviceRect.y() + deviceRect.height()), deviceRect.width(), deviceRect.height());
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+            glDisable(GL_SCISSOR_TEST);
+        }
 
         QMatrix4x4 projectionMatrix;
-        projectionMatrix.ortho(QRectF(0, 0, logicalGeometry.width(), logicalGeometry.height()));
+        projectionMatrix.ortho(QRectF(0, 0, bucketSize.width(), bucketSize.height()));
 
         WindowPaintData data;
         data.setXTranslation(-logicalGeometry.x());
@@ -121,20 +269,41 @@ void OffscreenData::maybeRender(EffectWindow *window)
         data.setProjectionMatrix(projectionMatrix);
 
         const int mask = Effect::PAINT_WINDOW_TRANSFORMED | Effect::PAINT_WINDOW_TRANSLUCENT;
-        effects->drawWindow(renderTarget, viewport, window, mask, infiniteRegion(), data);
+        effects->drawWindow(renderTarget, viewport, window, mask, region, data);
 
         GLFramebuffer::popFramebuffer();
         m_isDirty = false;
+        m_damage = QRegion();
     }
 }
 
+OffscreenData::OffscreenData()
+    : m_pool(OffscreenTargetPool::shared())
+{
+}
+
 OffscreenData::~OffscreenData()
 {
+    m_pool->release(std::move(m_target));
 }
 
-void OffscreenData::setDirty()
+void OffscreenData::addDamage(EffectWindow *window, const QRegion &region)
 {
-    m_isDirty = true;
+    if (m_isDirty) {
+        return;
+    }
+    if (region == infiniteRegion()) {
+        m_isDirty = true;
+        m_damage = QRegion();
+        return;
+    }
+
+    // the window can move before it's rendered again, the damage is kept relative to it;
+    // grow it a little so fractional window positions don't leave stale pixels behind
+    const QPoint origin = window->expandedGeometry().toAlignedRect().topLeft();
+    for (const QRect &rect : region) {
+        m_damage += rect.translated(-origin).adjusted(-1, -1, 1, 1);
+    }
 }
 
 void OffscreenData::setShader(GLShader *newShader)
@@ -164,7 +333,10 @@ void OffscreenData::paint(const RenderTarget &renderTarget, const RenderViewport
     for (auto &quad : quads) {
         geometry.appendWindowQuad(quad, scale);
     }
-    geometry.postProcessTextureCoordinates(m_texture->matrix(NormalizedCoordinates));
+    QMatrix4x4 textureMatrix = m_target.texture->matrix(NormalizedCoordinates);
+    textureMatrix.scale(qreal(m_contentSize.width()) / m_target.texture->width(),
+                        qreal(m_contentSize.height()) / m_target.texture->height());
+    geometry.postProcessTextureCoordinates(textureMatrix);
 
     GLVertex2D *map = static_cast<GLVertex2D *>(vbo->map(geometry.count() * sizeof(GLVertex2D)));
     geometry.copy(std::span(map, geometry.count()));
@@ -181,8 +353,8 @@ void OffscreenData::paint(const RenderTarget &renderTarget, const RenderViewport
     shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp * data.toMatrix(scale));
     shader->setUniform(GLShader::ModulationConstant, QVector4D(rgb, rgb, rgb, a));
     shader->setUniform(GLShader::Saturation, data.saturation());
-    shader->setUniform(GLShader::TextureWidth, m_texture->width());
-    shader->setUniform(GLShader::TextureHeight, m_texture->height());
+    shader->setUniform(GLShader::TextureWidth, m_target.texture->width());
+    shader->setUniform(GLShader::TextureHeight, m_target.texture->height());
 
     const bool clipping = region != infiniteRegion();
     const QRegion clipRegion = clipping ? viewport.mapToRenderTarget(region) : infiniteRegion();
@@ -194,9 +366,9 @@ void OffscreenData::paint(const RenderTarget &renderTarget, const RenderViewport
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    m_texture->bind();
+    m_target.texture->bind();
     vbo->draw(clipRegion, GL_TRIANGLES, 0, geometry.count(), clipping);
-    m_texture->unbind();
+    m_target.texture->unbind();
 
     glDisable(GL_BLEND);
     if (clipping) {
@@ -229,14 +401,17 @@ void OffscreenEffect::drawWindow(const RenderTarget &renderTarget, const RenderV
     quads.append(quad);
     apply(window, mask, data, quads);
 
-    offscreenData->maybeRender(window);
+    offscreenData->maybeRender(window, renderTarget.intermediateFormat());
     offscreenData->paint(renderTarget, viewport, window, region, data, quads);
 }
 
-void OffscreenEffect::handleWindowDamaged(EffectWindow *window)
+void OffscreenEffect::handleWindowDamaged(EffectWindow *window, const QRegion &region)
 {
+    if (!d->live) {
+        return;
+    }
     if (const auto it = d->windows.find(window); it != d->windows.end()) {
-        it->second->setDirty();
+        it->second->addDamage(window, region);
     }
 }
 
@@ -263,6 +438,11 @@ void OffscreenEffect::destroyConnections()
     d->windowDeletedConnection = {};
 }
 
+void OffscreenEffect::setLive(bool live)
+{
+    d->live = live;
+}
+
 void OffscreenEffect::setVertexSnappingMode(RenderGeometry::VertexSnappingMode mode)
 {
     d->vertexSnappingMode = mode;
@@ -280,6 +460,8 @@ public:
 class CrossFadeEffectPrivate
 {
 public:
+    // keeps the pooled targets alive between animations
+    std::shared_ptr<OffscreenTargetPool> pool = OffscreenTargetPool::shared();
     std::map<EffectWindow *, std::unique_ptr<CrossFadeWindowData>> windows;
     qreal progress;
 };
@@ -363,7 +545,8 @@ void CrossFadeEffect::redirect(EffectWindow *window)
     window->setData(WindowForceBackgroundContrastRole, QVariant());
 
     effects->makeOpenGLContextCurrent();
-    offscreenData->maybeRender(window);
+    // the snapshot is taken outside of a paint pass, there is no render target to match
+    offscreenData->maybeRender(window, GL_RGBA8);
     offscreenData->frameGeometryAtCapture = window->frameGeometry();
 
     window->setData(WindowForceBlurRole, blurRole);
@@ -71,8 +71,19 @@ protected:
      */
     void setVertexSnappingMode(RenderGeometry::VertexSnappingMode mode);
 
+    /**
+     * If @p live is @c false, the redirected windows are rendered only once and changes to
+     * their contents are not shown until they are unredirected, which is cheaper for short
+     * animations of windows that update constantly, e.g. videos. The windows are still
+     * rendered again if their size changes.
+     *
+     * The default is @c true, only the damaged parts of the windows are rendered again.
+     * @since 6.0
+     */
+    void setLive(bool live);
+
 private Q_SLOTS:
-    void handleWindowDamaged(EffectWindow *window);
+    void handleWindowDamaged(EffectWindow *window, const QRegion &region);
     void handleWindowDeleted(EffectWindow *window);
 
 private:
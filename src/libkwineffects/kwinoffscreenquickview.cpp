@@ -9,7 +9,11 @@
 
 #include "libkwineffects/kwinoffscreenquickview.h"
 
+#include "libkwineffects/kwineffects.h"
+#include "libkwineffects/kwinglplatform.h"
 #include "libkwineffects/kwinglutils.h"
+#include "libkwineffects/rendertarget.h"
+#include "libkwineffects/renderviewport.h"
 #include "logging_p.h"
 
 #include <QGuiApplication>
@@ -30,6 +34,8 @@
 #include <QQuickRenderTarget>
 #include <private/qeventpoint_p.h> // for QMutableEventPoint
 
+#include <epoxy/egl.h>
+
 namespace KWin
 {
 
@@ -41,6 +47,8 @@ public:
     std::unique_ptr<QOffscreenSurface> m_offscreenSurface;
     std::unique_ptr<QOpenGLContext> m_glcontext;
     std::unique_ptr<QOpenGLFramebufferObject> m_fbo;
+    // the render target if the scene graph renders with the compositor's own context
+    std::unique_ptr<GLFramebuffer> m_framebuffer;
 
     std::unique_ptr<QTimer> m_repaintTimer;
     QImage m_image;
@@ -50,6 +58,8 @@ public:
     bool m_useBlit = false;
     bool m_visible = true;
     bool m_automaticRepaint = true;
+    // if m_glcontext wraps the compositor's context rather than being a context of its own
+    bool m_useSceneContext = false;
 
     QList<QEventPoint> touchPoints;
     QPointingDevice *touchDevice;
@@ -57,6 +67,9 @@ public:
     ulong lastMousePressTime = 0;
     Qt::MouseButton lastMousePressButton = Qt::NoButton;
 
+    bool makeCurrent();
+    void renderFrame();
+    void doneCurrent();
     void releaseResources();
 
     void updateTouchState(Qt::TouchPointState state, qint32 id, const QPointF &pos);
@@ -107,27 +120,41 @@ OffscreenQuickView::OffscreenQuickView(QObject *parent, ExportMode exportMode)
 
         d->m_view->setFormat(format);
 
-        auto shareContext = QOpenGLContext::globalShareContext();
-        d->m_glcontext.reset(new QOpenGLContext);
-        d->m_glcontext->setShareContext(shareContext);
-        d->m_glcontext->setFormat(format);
-        d->m_glcontext->create();
-
-        // and the offscreen surface
-        d->m_offscreenSurface.reset(new QOffscreenSurface);
-        d->m_offscreenSurface->setFormat(d->m_glcontext->format());
-        d->m_offscreenSurface->create();
-
-        d->m_glcontext->makeCurrent(d->m_offscreenSurface.get());
-        d->m_view->setGraphicsDevice(QQuickGraphicsDevice::fromOpenGLContext(d->m_glcontext.get()));
-        d->m_renderControl->initialize();
-        d->m_glcontext->doneCurrent();
+        // With EGL, the scene graph can render with the compositor's context, which avoids
+        // switching contexts every frame and shares all objects including the VAOs.
+        if (exportMode == ExportMode::Texture && effects && GLPlatform::instance()->platformInterface() == EglPlatformInterface
+            && effects->makeOpenGLContextCurrent()) {
+            d->m_glcontext.reset(QNativeInterface::QEGLContext::fromNative(eglGetCurrentContext(), eglGetCurrentDisplay()));
+            if (d->m_glcontext) {
+                d->m_useSceneContext = true;
+                d->m_view->setGraphicsDevice(QQuickGraphicsDevice::fromOpenGLContext(d->m_glcontext.get()));
+                d->m_renderControl->initialize();
+            }
+        }
 
-        // On Wayland, contexts are implicitly shared and QOpenGLContext::globalShareContext() is null.
-        if (shareContext && !d->m_glcontext->shareContext()) {
-            qCDebug(LIBKWINEFFECTS) << "Failed to create a shared context, falling back to raster rendering";
-            // still render via GL, but blit for presentation
-            d->m_useBlit = true;
+        if (!d->m_useSceneContext) {
+            auto shareContext = QOpenGLContext::globalShareContext();
+            d->m_glcontext.reset(new QOpenGLContext);
+            d->m_glcontext->setShareContext(shareContext);
+            d->m_glcontext->setFormat(format);
+            d->m_glcontext->create();
+
+            // and the offscreen surface
+            d->m_offscreenSurface.reset(new QOffscreenSurface);
+            d->m_offscreenSurface->setFormat(d->m_glcontext->format());
+            d->m_offscreenSurface->create();
+
+            d->m_glcontext->makeCurrent(d->m_offscreenSurface.get());
+            d->m_view->setGraphicsDevice(QQuickGraphicsDevice::fromOpenGLContext(d->m_glcontext.get()));
+            d->m_renderControl->initialize();
+            d->m_glcontext->doneCurrent();
+
+            // On Wayland, contexts are implicitly shared and QOpenGLContext::globalShareContext() is null.
+            if (shareContext && !d->m_glcontext->shareContext()) {
+                qCDebug(LIBKWINEFFECTS) << "Failed to create a shared context, falling back to raster rendering";
+                // still render via GL, but blit for presentation
+                d->m_useBlit = true;
+            }
         }
     }
 
@@ -156,7 +183,7 @@ OffscreenQuickView::~OffscreenQuickView()
 
     if (d->m_glcontext) {
         // close the view whilst we have an active GL context
-        d->m_glcontext->makeCurrent(d->m_offscreenSurface.get());
+        d->makeCurrent();
     }
 
     // Always delete render control first.
@@ -209,49 +236,93 @@ void OffscreenQuickView::update()
     bool usingGl = d->m_glcontext != nullptr;
 
     if (usingGl) {
-        if (!d->m_glcontext->makeCurrent(d->m_offscreenSurface.get())) {
+        if (!d->makeCurrent()) {
             // probably a context loss event, kwin is about to reset all the effects anyway
             return;
         }
 
         const QSize nativeSize = d->m_view->size() * d->m_view->effectiveDevicePixelRatio();
-        if (!d->m_fbo || d->m_fbo->size() != nativeSize) {
-            d->m_textureExport.reset(nullptr);
-            d->m_fbo.reset(new QOpenGLFramebufferObject(nativeSize, QOpenGLFramebufferObject::CombinedDepthStencil));
-            if (!d->m_fbo->isValid()) {
-                d->m_fbo.reset();
-                d->m_glcontext->doneCurrent();
-                return;
+        GLuint texture = 0;
+        if (d->m_useSceneContext) {
+            // the texture is exported as is, the scene graph creates the depth and stencil buffers itself
+            if (!d->m_textureExport || d->m_textureExport->size() != nativeSize) {
+                d->m_framebuffer.reset();
+                d->m_textureExport = std::make_unique<GLTexture>(GL_RGBA8, nativeSize);
+                d->m_textureExport->setMemoryCategory(GLTextureMemory::Category::Effect);
+                d->m_framebuffer = std::make_unique<GLFramebuffer>(d->m_textureExport.get());
+                if (!d->m_framebuffer->valid()) {
+                    d->m_framebuffer.reset();
+                    d->m_textureExport.reset();
+                    return;
+                }
+            }
+            texture = d->m_textureExport->texture();
+            // the framebuffer stack restores the compositor's framebuffer and viewport afterwards
+            GLFramebuffer::pushFramebuffer(d->m_framebuffer.get());
+        } else {
+            if (!d->m_fbo || d->m_fbo->size() != nativeSize) {
+                d->m_textureExport.reset(nullptr);
+                d->m_fbo.reset(new QOpenGLFramebufferObject(nativeSize, QOpenGLFramebufferObject::CombinedDepthStencil));
+                if (!d->m_fbo->isValid()) {
+                    d->m_fbo.reset();
+                    d->doneCurrent();
+                    return;
+                }
             }
+            texture = d->m_fbo->texture();
         }
 
-        QQuickRenderTarget renderTarget = QQuickRenderTarget::fromOpenGLTexture(d->m_fbo->texture(), d->m_fbo->size());
+        QQuickRenderTarget renderTarget = QQuickRenderTarget::fromOpenGLTexture(texture, nativeSize);
         renderTarget.setDevicePixelRatio(d->m_view->devicePixelRatio());
 
         d->m_view->setRenderTarget(renderTarget);
     }
 
-    d->m_renderControl->polishItems();
-    d->m_renderControl->beginFrame();
-    d->m_renderControl->sync();
-    d->m_renderControl->render();
-    d->m_renderControl->endFrame();
-
-    if (usingGl) {
-        QQuickOpenGLUtils::resetOpenGLState();
-    }
+    d->renderFrame();
 
     if (d->m_useBlit) {
         d->m_image = d->m_view->grabWindow();
     }
 
-    if (usingGl) {
+    if (d->m_useSceneContext) {
+        GLFramebuffer::popFramebuffer();
+    } else if (usingGl) {
         QOpenGLFramebufferObject::bindDefault();
-        d->m_glcontext->doneCurrent();
+        d->doneCurrent();
     }
     Q_EMIT repaintNeeded();
 }
 
+bool OffscreenQuickView::renderDirectly(const RenderTarget &renderTarget, const RenderViewport &viewport)
+{
+    if (!d->m_visible || !d->m_useSceneContext || d->m_view->size().isEmpty() || opacity() != 1.0) {
+        return false;
+    }
+
+    GLTexture *texture = renderTarget.texture();
+    const QSize nativeSize = d->m_view->size() * d->m_view->effectiveDevicePixelRatio();
+    if (!texture || renderTarget.size() != nativeSize
+        || viewport.renderRect() != QRectF(geometry()) || viewport.scale() != d->m_view->effectiveDevicePixelRatio()) {
+        return false;
+    }
+    // the textures of imported buffers, e.g. the ones of the outputs, store the rows top to bottom
+    const TextureTransforms contentTransforms = texture->contentTransforms();
+    if (contentTransforms != TextureTransforms() && contentTransforms != TextureTransform::MirrorY) {
+        return false;
+    }
+
+    QQuickRenderTarget quickRenderTarget = QQuickRenderTarget::fromOpenGLTexture(texture->texture(), nativeSize);
+    quickRenderTarget.setDevicePixelRatio(d->m_view->devicePixelRatio());
+    quickRenderTarget.setMirrorVertically(contentTransforms == TextureTransform::MirrorY);
+    d->m_view->setRenderTarget(quickRenderTarget);
+
+    // the framebuffer stack restores the framebuffer and the viewport of the render target afterwards
+    GLFramebuffer::pushFramebuffer(renderTarget.framebuffer());
+    d->renderFrame();
+    GLFramebuffer::popFramebuffer();
+    return true;
+}
+
 void OffscreenQuickView::forwardMouseEvent(QEvent *e)
 {
     if (!d->m_visible) {
@@ -411,7 +482,7 @@ GLTexture *OffscreenQuickView::bufferAsTexture()
             return nullptr;
         }
         d->m_textureExport.reset(new GLTexture(d->m_image));
-    } else {
+    } else if (!d->m_useSceneContext) {
         if (!d->m_fbo) {
             return nullptr;
         }
@@ -439,12 +510,41 @@ void OffscreenQuickView::setGeometry(const QRect &rect)
     Q_EMIT geometryChanged(oldGeometry, rect);
 }
 
+bool OffscreenQuickView::Private::makeCurrent()
+{
+    if (m_useSceneContext) {
+        return effects->makeOpenGLContextCurrent();
+    }
+    return m_glcontext->makeCurrent(m_offscreenSurface.get());
+}
+
+void OffscreenQuickView::Private::renderFrame()
+{
+    m_renderControl->polishItems();
+    m_renderControl->beginFrame();
+    m_renderControl->sync();
+    m_renderControl->render();
+    m_renderControl->endFrame();
+
+    if (m_glcontext) {
+        QQuickOpenGLUtils::resetOpenGLState();
+    }
+}
+
+void OffscreenQuickView::Private::doneCurrent()
+{
+    // the compositor's context stays current
+    if (!m_useSceneContext) {
+        m_glcontext->doneCurrent();
+    }
+}
+
 void OffscreenQuickView::Private::releaseResources()
 {
     if (m_glcontext) {
-        m_glcontext->makeCurrent(m_offscreenSurface.get());
+        makeCurrent();
         m_view->releaseResources();
-        m_glcontext->doneCurrent();
+        doneCurrent();
     } else {
         m_view->releaseResources();
     }
@@ -94,6 +94,21 @@ public:
      */
     void update();
 
+    /**
+     * Renders the current scene graph straight into the given @a renderTarget rather than
+     * into the own buffer of the view, which saves compositing that buffer afterwards.
+     *
+     * This is only possible if the scene graph renders with the compositor's own context,
+     * the view covers the whole @a viewport with matching scale and is fully opaque, and the
+     * render target is a texture that is at most mirrored vertically. Returns @c false without
+     * rendering anything otherwise, the view has to be updated and composited as usual then.
+     *
+     * Note that the view clears the covered area of the render target.
+     *
+     * @since 6.0
+     */
+    bool renderDirectly(const RenderTarget &renderTarget, const RenderViewport &viewport);
+
     /** The invisble root item of the window*/
     QQuickItem *contentItem() const;
     QQuickWindow *window() const;
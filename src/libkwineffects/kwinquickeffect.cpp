@@ -344,13 +344,8 @@ void QuickSceneEffect::activateView(QuickSceneView *view)
 // Screen views are repainted just before kwin performs its compositing cycle to avoid stalling for vblank
 void QuickSceneEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
 {
-    if (effects->waylandDisplay()) {
-        const auto it = d->views.find(data.screen);
-        if (it != d->views.end() && it->second->isDirty()) {
-            it->second->update();
-            it->second->resetDirty();
-        }
-    } else {
+    // on wayland, the views are rendered in paintScreen(), possibly straight into the output
+    if (!effects->waylandDisplay()) {
         for (const auto &[screen, screenView] : d->views) {
             if (screenView->isDirty()) {
                 screenView->update();
@@ -365,7 +360,17 @@ void QuickSceneEffect::paintScreen(const RenderTarget &renderTarget, const Rende
     if (effects->waylandDisplay()) {
         const auto it = d->views.find(screen);
         if (it != d->views.end()) {
-            effects->renderOffscreenQuickView(renderTarget, viewport, it->second.get());
+            QuickSceneView *screenView = it->second.get();
+            if (screenView->renderDirectly(renderTarget, viewport)) {
+                // the buffer of the view is stale now and needs to be updated if it's used again
+                screenView->markDirty();
+                return;
+            }
+            if (screenView->isDirty()) {
+                screenView->update();
+                screenView->resetDirty();
+            }
+            effects->renderOffscreenQuickView(renderTarget, viewport, screenView);
         }
     } else {
         for (const auto &[screen, screenView] : d->views) {
@@ -7,6 +7,7 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "openglcontext.h"
+#include "kwinglplatformcache_p.h"
 
 #include <QByteArray>
 #include <QList>
@@ -87,6 +88,10 @@ Version Version::parseString(QByteArrayView versionString)
 
 static QSet<QByteArray> getExtensions(OpenGlContext *context)
 {
+    if (auto cached = GLPlatformCache::loadExtensions(context->vendor(), context->renderer(), context->openglVersionString())) {
+        return *cached;
+    }
+
     QSet<QByteArray> ret;
     if (!context->isOpenglES() && context->hasVersion(Version(3, 0))) {
         int count;
@@ -101,6 +106,7 @@ static QSet<QByteArray> getExtensions(OpenGlContext *context)
         QList<QByteArray> extensionsList = extensions.split(' ');
         ret = {extensionsList.constBegin(), extensionsList.constEnd()};
     }
+    GLPlatformCache::storeExtensions(context->vendor(), context->renderer(), context->openglVersionString(), ret);
     return ret;
 }
 
@@ -151,6 +157,11 @@ bool OpenGlContext::hasOpenglExtension(QByteArrayView name) const
     });
 }
 
+const QSet<QByteArray> &OpenGlContext::openglExtensions() const
+{
+    return m_extensions;
+}
+
 bool OpenGlContext::isSoftwareRenderer() const
 {
     return m_renderer.contains("softpipe") || m_renderer.contains("Software Rasterizer") || m_renderer.contains("llvmpipe");
@@ -53,6 +53,7 @@ public:
     QByteArrayView renderer() const;
     bool isOpenglES() const;
     bool hasOpenglExtension(QByteArrayView name) const;
+    const QSet<QByteArray> &openglExtensions() const;
     bool isSoftwareRenderer() const;
 
 protected:
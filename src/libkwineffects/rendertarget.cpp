@@ -5,6 +5,7 @@
 */
 
 #include "libkwineffects/rendertarget.h"
+#include "libkwineffects/kwinglplatform.h"
 #include "libkwineffects/kwinglutils.h"
 
 namespace KWin
@@ -62,6 +63,24 @@ GLTexture *RenderTarget::texture() const
     return m_framebuffer->colorAttachment();
 }
 
+GLenum RenderTarget::intermediateFormat() const
+{
+    const GLTexture *texture = m_framebuffer ? m_framebuffer->colorAttachment() : nullptr;
+    if (!texture) {
+        return GL_RGBA8;
+    }
+    switch (texture->internalFormat()) {
+    case GL_RGB10_A2:
+    case GL_RGBA16F: {
+        // GL_RGB10_A2 has only two bits of alpha, translucent contents need a float format
+        static const bool floatSupported = !GLPlatform::instance()->isGLES() || hasGLExtension(QByteArrayLiteral("GL_EXT_color_buffer_half_float"));
+        return floatSupported ? GL_RGBA16F : GL_RGBA8;
+    }
+    default:
+        return GL_RGBA8;
+    }
+}
+
 QImage *RenderTarget::image() const
 {
     return m_image;
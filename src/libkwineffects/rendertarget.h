@@ -10,6 +10,7 @@
 
 #include <QImage>
 #include <QMatrix4x4>
+#include <epoxy/gl.h>
 #include <variant>
 
 namespace KWin
@@ -33,6 +34,13 @@ public:
     GLFramebuffer *framebuffer() const;
     GLTexture *texture() const;
 
+    /**
+     * Returns the internal format for offscreen textures whose contents end up in this render
+     * target. It's GL_RGBA8, unless the render target has a higher color depth, in which case
+     * the offscreen textures must not lose the extra precision.
+     */
+    GLenum intermediateFormat() const;
+
 private:
     QImage *m_image = nullptr;
     GLFramebuffer *m_framebuffer = nullptr;
@@ -40,6 +40,7 @@
 
 // KDE
 #include <KAboutData>
+#include <KConfigGroup>
 #include <KLocalizedString>
 // Qt
 #include <QCommandLineParser>
@@ -334,6 +335,10 @@ void Application::createPlatformCursor(QObject *parent)
 std::unique_ptr<OutlineVisual> Application::createOutline(Outline *outline)
 {
     if (Compositor::compositing()) {
+        // the default outline doesn't need any QML, only custom themes do
+        if (!config()->group(QStringLiteral("Outline")).hasKey("QmlPath")) {
+            return std::make_unique<ItemOutlineVisual>(outline);
+        }
         return std::make_unique<CompositedOutlineVisual>(outline);
     }
     return nullptr;
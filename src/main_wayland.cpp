@@ -18,6 +18,7 @@
 #include "core/outputbackend.h"
 #include "core/session.h"
 #include "effects.h"
+#include "ftrace.h"
 #include "inputmethod.h"
 #include "tabletmodemanager.h"
 #include "utils/realtime.h"
@@ -137,15 +138,24 @@ void ApplicationWayland::performStartup()
     // first load options - done internally by a different thread
     createOptions();
 
-    if (!outputBackend()->initialize()) {
-        std::exit(1);
+    {
+        fTraceDuration("Initialize output backend");
+        if (!outputBackend()->initialize()) {
+            std::exit(1);
+        }
     }
 
-    createInput();
-    createInputMethod();
-    createTabletModeManager();
+    {
+        fTraceDuration("Create input");
+        createInput();
+        createInputMethod();
+        createTabletModeManager();
+    }
 
-    WaylandCompositor::create();
+    {
+        fTraceDuration("Create compositor");
+        WaylandCompositor::create();
+    }
 
     connect(Compositor::self(), &Compositor::sceneCreated, outputBackend(), &OutputBackend::sceneInitialized);
     connect(Compositor::self(), &Compositor::sceneCreated, this, &ApplicationWayland::continueStartupWithScene, Qt::SingleShotConnection);
@@ -154,9 +164,15 @@ void ApplicationWayland::performStartup()
 void ApplicationWayland::continueStartupWithScene()
 {
     // Note that we start accepting client connections after creating the Workspace.
-    createWorkspace();
-    createColorManager();
-    createPlugins();
+    {
+        fTraceDuration("Create workspace");
+        createWorkspace();
+        createColorManager();
+    }
+    {
+        fTraceDuration("Create plugins");
+        createPlugins();
+    }
 
     if (!waylandServer()->start()) {
         qFatal("Failed to initialze the Wayland server, exiting now");
@@ -167,6 +183,7 @@ void ApplicationWayland::continueStartupWithScene()
         m_xwayland->xwaylandLauncher()->setListenFDs(m_xwaylandListenFds);
         m_xwayland->xwaylandLauncher()->setDisplayName(m_xwaylandDisplay);
         m_xwayland->xwaylandLauncher()->setXauthority(m_xwaylandXauthority);
+        fTraceDuration("Start Xwayland");
         m_xwayland->init();
     }
     startSession();
@@ -394,6 +411,11 @@ int main(int argc, char *argv[])
                                              QStringLiteral("/path/to/session"));
     parser.addOption(exitWithSessionOption);
 
+    QCommandLineOption startupTraceOption(QStringLiteral("startup-trace"),
+                                          i18n("Write a trace of the startup up to the first presented frame to the given file, in the Chrome trace format."),
+                                          QStringLiteral("/path/to/trace.json"));
+    parser.addOption(startupTraceOption);
+
     parser.addPositionalArgument(QStringLiteral("applications"),
                                  i18n("Applications to start once Wayland and Xwayland server are started"),
                                  QStringLiteral("[/path/to/application...]"));
@@ -401,6 +423,10 @@ int main(int argc, char *argv[])
     parser.process(a);
     a.processCommandLine(&parser);
 
+    if (parser.isSet(startupTraceOption)) {
+        KWin::FTraceLogger::create(&a)->startChromeTrace(parser.value(startupTraceOption));
+    }
+
 #if KWIN_BUILD_ACTIVITIES
     if (parser.isSet(noActivitiesOption)) {
         a.setUseKActivities(false);
@@ -517,9 +543,12 @@ int main(int argc, char *argv[])
         }
     }
 
-    if (!server->init(flags)) {
-        std::cerr << "FATAL ERROR: could not create Wayland server" << std::endl;
-        return 1;
+    {
+        fTraceDuration("Initialize Wayland server");
+        if (!server->init(flags)) {
+            std::cerr << "FATAL ERROR: could not create Wayland server" << std::endl;
+            return 1;
+        }
     }
 
     switch (backendType) {
@@ -62,11 +62,23 @@ OnScreenNotification::OnScreenNotification(QObject *parent)
         if (m_visible) {
             show();
         } else {
+            if (m_visualShown) {
+                m_visual->hide();
+                m_visualShown = false;
+            }
             m_timer->stop();
             m_spy.reset();
             m_containsPointer = false;
         }
     });
+    // the QML component binds to the properties, the visual needs to be told
+    const auto updateVisual = [this]() {
+        if (m_visible && m_visualShown) {
+            m_visual->show(m_message, m_iconName);
+        }
+    };
+    connect(this, &OnScreenNotification::messageChanged, this, updateVisual);
+    connect(this, &OnScreenNotification::iconNameChanged, this, updateVisual);
 }
 
 OnScreenNotification::~OnScreenNotification()
@@ -87,6 +99,11 @@ void OnScreenNotification::setEngine(QQmlEngine *engine)
     m_qmlEngine = engine;
 }
 
+void OnScreenNotification::setVisual(std::unique_ptr<OnScreenNotificationVisual> &&visual)
+{
+    m_visual = std::move(visual);
+}
+
 bool OnScreenNotification::isVisible() const
 {
     return m_visible;
@@ -146,8 +163,20 @@ void OnScreenNotification::setTimeout(int timeout)
 void OnScreenNotification::show()
 {
     Q_ASSERT(m_visible);
-    ensureQmlContext();
-    ensureQmlComponent();
+    m_visualShown = m_visual && m_visual->show(m_message, m_iconName);
+    if (m_visualShown) {
+        // the window of the QML component follows the visible property, don't show it as well
+        if (QQuickWindow *w = qobject_cast<QQuickWindow *>(m_mainItem.get())) {
+            w->hide();
+            w->destroy();
+        }
+        m_mainItem.reset();
+        m_qmlComponent.reset();
+    } else {
+        // e.g. without compositing, the QML component shows the notification in a window
+        ensureQmlContext();
+        ensureQmlComponent();
+    }
     createInputSpy();
     if (m_timer->interval() != 0) {
         m_timer->start();
@@ -188,21 +217,41 @@ void OnScreenNotification::ensureQmlComponent()
 void OnScreenNotification::createInputSpy()
 {
     Q_ASSERT(!m_spy);
-    if (auto w = qobject_cast<QQuickWindow *>(m_mainItem.get())) {
-        m_spy.reset(new OnScreenNotificationInputEventSpy(this));
-        input()->installInputEventSpy(m_spy.get());
-        if (!m_animation) {
+    auto w = m_visualShown ? nullptr : qobject_cast<QQuickWindow *>(m_mainItem.get());
+    if (!w && !m_visualShown) {
+        return;
+    }
+    m_spy.reset(new OnScreenNotificationInputEventSpy(this));
+    input()->installInputEventSpy(m_spy.get());
+    // the notification may be drawn differently than the last time it was shown
+    if (m_animation) {
+        auto propertyAnimation = qobject_cast<QPropertyAnimation *>(m_animation);
+        if ((propertyAnimation ? propertyAnimation->targetObject() : nullptr) != w) {
+            delete m_animation;
+            m_animation = nullptr;
+        }
+    }
+    if (!m_animation) {
+        if (w) {
             m_animation = new QPropertyAnimation(w, "opacity", this);
-            m_animation->setStartValue(1.0);
-            m_animation->setEndValue(0.0);
-            m_animation->setDuration(250);
-            m_animation->setEasingCurve(QEasingCurve::InOutCubic);
+        } else {
+            m_animation = new QVariantAnimation(this);
+            connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
+                m_visual->setOpacity(value.toReal());
+            });
         }
+        m_animation->setStartValue(1.0);
+        m_animation->setEndValue(0.0);
+        m_animation->setDuration(250);
+        m_animation->setEasingCurve(QEasingCurve::InOutCubic);
     }
 }
 
 QRect OnScreenNotification::geometry() const
 {
+    if (m_visualShown) {
+        return m_visual->geometry();
+    }
     if (QQuickWindow *w = qobject_cast<QQuickWindow *>(m_mainItem.get())) {
         return w->geometry();
     }
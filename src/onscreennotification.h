@@ -9,10 +9,11 @@
 
 #include <KSharedConfig>
 #include <QObject>
+#include <QRect>
 #include <memory>
 
-class QPropertyAnimation;
 class QTimer;
+class QVariantAnimation;
 class QQmlContext;
 class QQmlComponent;
 class QQmlEngine;
@@ -22,6 +23,24 @@ namespace KWin
 
 class OnScreenNotificationInputEventSpy;
 
+/**
+ * The OnScreenNotificationVisual draws the notification without a QML component.
+ */
+class OnScreenNotificationVisual
+{
+public:
+    virtual ~OnScreenNotificationVisual() = default;
+
+    /**
+     * Shows the notification, or updates it if it's already shown. Returns @c false if the
+     * notification can't be drawn right now, e.g. because compositing is off.
+     */
+    virtual bool show(const QString &message, const QString &iconName) = 0;
+    virtual void hide() = 0;
+    virtual QRect geometry() const = 0;
+    virtual void setOpacity(qreal opacity) = 0;
+};
+
 class OnScreenNotification : public QObject
 {
     Q_OBJECT
@@ -47,6 +66,11 @@ public:
 
     void setConfig(KSharedConfigPtr config);
     void setEngine(QQmlEngine *engine);
+    /**
+     * Sets the @a visual that draws the notification instead of the QML component. The QML
+     * component is still used whenever the visual can't draw the notification.
+     */
+    void setVisual(std::unique_ptr<OnScreenNotificationVisual> &&visual);
 
     void setContainsPointer(bool contains);
     void setSkipCloseAnimation(bool skip);
@@ -71,8 +95,10 @@ private:
     std::unique_ptr<QQmlComponent> m_qmlComponent;
     QQmlEngine *m_qmlEngine = nullptr;
     std::unique_ptr<QObject> m_mainItem;
+    std::unique_ptr<OnScreenNotificationVisual> m_visual;
+    bool m_visualShown = false;
     std::unique_ptr<OnScreenNotificationInputEventSpy> m_spy;
-    QPropertyAnimation *m_animation = nullptr;
+    QVariantAnimation *m_animation = nullptr;
     bool m_containsPointer = false;
 };
 }
@@ -15,6 +15,8 @@
 #include "core/outputbackend.h"
 #include "utils/common.h"
 
+#include <utility>
+
 #ifndef KCMRULES
 
 #include <QProcess>
@@ -56,6 +58,7 @@ Options::Options(QObject *parent)
     , m_hideUtilityWindowsForInactive(false)
     , m_xwaylandCrashPolicy(Options::defaultXwaylandCrashPolicy())
     , m_xwaylandMaxCrashCount(Options::defaultXwaylandMaxCrashCount())
+    , m_xwaylandPrestart(Options::defaultXwaylandPrestart())
     , m_xwaylandEavesdrops(Options::defaultXwaylandEavesdrops())
     , m_latencyPolicy(Options::defaultLatencyPolicy())
     , m_renderTimeEstimator(Options::defaultRenderTimeEstimator())
@@ -68,6 +71,7 @@ Options::Options(QObject *parent)
     , m_glPreferBufferSwap(Options::defaultGlPreferBufferSwap())
     , m_glPlatformInterface(Options::defaultGlPlatformInterface())
     , m_windowsBlockCompositing(true)
+    , m_unredirectFullscreen(false)
     , OpTitlebarDblClick(Options::defaultOperationTitlebarDblClick())
     , CmdActiveTitlebar1(Options::defaultCommandActiveTitlebar1())
     , CmdActiveTitlebar2(Options::defaultCommandActiveTitlebar2())
@@ -102,6 +106,20 @@ Options::Options(QObject *parent)
             workspace()->reconfigure();
         }
     });
+
+    // Only the settings the compositor depends on need a compositing restart, all the other
+    // settings are applied by the objects listening to their change signals
+    for (auto signal : {&Options::compositingModeChanged, &Options::useCompositingChanged,
+                        &Options::hiddenPreviewsChanged, &Options::glSmoothScaleChanged,
+                        &Options::glStrictBindingChanged, &Options::glStrictBindingFollowsDriverChanged,
+                        &Options::glPreferBufferSwapChanged, &Options::glPlatformInterfaceChanged,
+                        &Options::windowsBlockCompositingChanged, &Options::unredirectFullscreenChanged,
+                        &Options::latencyPolicyChanged, &Options::renderTimeEstimatorChanged,
+                        &Options::allowTearingChanged}) {
+        connect(this, signal, this, [this]() {
+            m_compositingSettingsChanged = true;
+        });
+    }
 }
 
 Options::~Options()
@@ -149,6 +167,15 @@ void Options::setXwaylandMaxCrashCount(int maxCrashCount)
     Q_EMIT xwaylandMaxCrashCountChanged();
 }
 
+void Options::setXwaylandPrestart(bool prestart)
+{
+    if (m_xwaylandPrestart == prestart) {
+        return;
+    }
+    m_xwaylandPrestart = prestart;
+    Q_EMIT xwaylandPrestartChanged();
+}
+
 void Options::setXwaylandEavesdrops(XwaylandEavesdropsMode mode)
 {
     if (m_xwaylandEavesdrops == mode) {
@@ -610,6 +637,15 @@ void Options::setWindowsBlockCompositing(bool value)
     Q_EMIT windowsBlockCompositingChanged();
 }
 
+void Options::setUnredirectFullscreen(bool value)
+{
+    if (m_unredirectFullscreen == value) {
+        return;
+    }
+    m_unredirectFullscreen = value;
+    Q_EMIT unredirectFullscreenChanged();
+}
+
 void Options::setGlPreferBufferSwap(char glPreferBufferSwap)
 {
     if (glPreferBufferSwap == 'a') {
@@ -714,6 +750,7 @@ void Options::reparseConfiguration()
 
 void Options::updateSettings()
 {
+    m_compositingSettingsChanged = false;
     loadConfig();
     // Read button tooltip animation effect from kdeglobals
     // Since we want to allow users to enable window decoration tooltips
@@ -726,6 +763,9 @@ void Options::updateSettings()
     // Driver-specific config detection
     reloadCompositingSettings();
 
+    if (std::exchange(m_compositingSettingsChanged, false)) {
+        Q_EMIT compositingSettingsChanged();
+    }
     Q_EMIT configChanged();
 }
 
@@ -789,6 +829,7 @@ void Options::syncFromKcfgc()
     setActivationDesktopPolicy(m_settings->activationDesktopPolicy());
     setXwaylandCrashPolicy(m_settings->xwaylandCrashPolicy());
     setXwaylandMaxCrashCount(m_settings->xwaylandMaxCrashCount());
+    setXwaylandPrestart(m_settings->xwaylandPrestart());
     setXwaylandEavesdrops(XwaylandEavesdropsMode(m_settings->xwaylandEavesdrops()));
     setPlacement(m_settings->placement());
     setAutoRaise(m_settings->autoRaise());
@@ -808,6 +849,7 @@ void Options::syncFromKcfgc()
     setElectricBorderTiling(m_settings->electricBorderTiling());
     setElectricBorderCornerRatio(m_settings->electricBorderCornerRatio());
     setWindowsBlockCompositing(m_settings->windowsBlockCompositing());
+    setUnredirectFullscreen(m_settings->unredirectFullscreen());
     setLatencyPolicy(m_settings->latencyPolicy());
     setRenderTimeEstimator(m_settings->renderTimeEstimator());
     setAllowTearing(m_settings->allowTearing());
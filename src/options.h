@@ -65,6 +65,9 @@ enum RenderTimeEstimator {
     RenderTimeEstimatorMinimum,
     RenderTimeEstimatorMaximum,
     RenderTimeEstimatorAverage,
+    RenderTimeEstimatorPercentile90,
+    RenderTimeEstimatorPercentile99,
+    RenderTimeEstimatorExponentialAverage,
 };
 
 /**
@@ -98,6 +101,10 @@ class KWIN_EXPORT Options : public QObject
     Q_PROPERTY(FocusPolicy focusPolicy READ focusPolicy WRITE setFocusPolicy NOTIFY focusPolicyChanged)
     Q_PROPERTY(XwaylandCrashPolicy xwaylandCrashPolicy READ xwaylandCrashPolicy WRITE setXwaylandCrashPolicy NOTIFY xwaylandCrashPolicyChanged)
     Q_PROPERTY(int xwaylandMaxCrashCount READ xwaylandMaxCrashCount WRITE setXwaylandMaxCrashCount NOTIFY xwaylandMaxCrashCountChanged)
+    /**
+     * Whether the Xwayland server is started right away rather than when the first X11 client connects.
+     */
+    Q_PROPERTY(bool xwaylandPrestart READ xwaylandPrestart WRITE setXwaylandPrestart NOTIFY xwaylandPrestartChanged)
     Q_PROPERTY(bool nextFocusPrefersMouse READ isNextFocusPrefersMouse WRITE setNextFocusPrefersMouse NOTIFY nextFocusPrefersMouseChanged)
     /**
      * Whether clicking on a window raises it in FocusFollowsMouse
@@ -218,6 +225,10 @@ class KWIN_EXPORT Options : public QObject
     Q_PROPERTY(GlSwapStrategy glPreferBufferSwap READ glPreferBufferSwap WRITE setGlPreferBufferSwap NOTIFY glPreferBufferSwapChanged)
     Q_PROPERTY(KWin::OpenGLPlatformInterface glPlatformInterface READ glPlatformInterface WRITE setGlPlatformInterface NOTIFY glPlatformInterfaceChanged)
     Q_PROPERTY(bool windowsBlockCompositing READ windowsBlockCompositing WRITE setWindowsBlockCompositing NOTIFY windowsBlockCompositingChanged)
+    /**
+     * Whether compositing is suspended while a fullscreen X11 window is active, X11 only.
+     */
+    Q_PROPERTY(bool unredirectFullscreen READ unredirectFullscreen WRITE setUnredirectFullscreen NOTIFY unredirectFullscreenChanged)
     Q_PROPERTY(LatencyPolicy latencyPolicy READ latencyPolicy WRITE setLatencyPolicy NOTIFY latencyPolicyChanged)
     Q_PROPERTY(RenderTimeEstimator renderTimeEstimator READ renderTimeEstimator WRITE setRenderTimeEstimator NOTIFY renderTimeEstimatorChanged)
     Q_PROPERTY(bool allowTearing READ allowTearing WRITE setAllowTearing NOTIFY allowTearingChanged)
@@ -281,6 +292,10 @@ public:
     {
         return m_xwaylandMaxCrashCount;
     }
+    bool xwaylandPrestart() const
+    {
+        return m_xwaylandPrestart;
+    }
     XwaylandEavesdropsMode xwaylandEavesdrops() const
     {
         return m_xwaylandEavesdrops;
@@ -708,6 +723,11 @@ public:
         return m_windowsBlockCompositing;
     }
 
+    bool unredirectFullscreen() const
+    {
+        return m_unredirectFullscreen;
+    }
+
     QStringList modifierOnlyDBusShortcut(Qt::KeyboardModifier mod) const;
     LatencyPolicy latencyPolicy() const;
     RenderTimeEstimator renderTimeEstimator() const;
@@ -717,6 +737,7 @@ public:
     void setFocusPolicy(FocusPolicy focusPolicy);
     void setXwaylandCrashPolicy(XwaylandCrashPolicy crashPolicy);
     void setXwaylandMaxCrashCount(int maxCrashCount);
+    void setXwaylandPrestart(bool prestart);
     void setXwaylandEavesdrops(XwaylandEavesdropsMode mode);
     void setNextFocusPrefersMouse(bool nextFocusPrefersMouse);
     void setClickRaise(bool clickRaise);
@@ -769,6 +790,7 @@ public:
     void setGlPreferBufferSwap(char glPreferBufferSwap);
     void setGlPlatformInterface(OpenGLPlatformInterface interface);
     void setWindowsBlockCompositing(bool set);
+    void setUnredirectFullscreen(bool set);
     void setLatencyPolicy(LatencyPolicy policy);
     void setRenderTimeEstimator(RenderTimeEstimator estimator);
     void setAllowTearing(bool allow);
@@ -894,6 +916,10 @@ public:
     {
         return 3;
     }
+    static bool defaultXwaylandPrestart()
+    {
+        return false;
+    }
     static XwaylandEavesdropsMode defaultXwaylandEavesdrops()
     {
         return None;
@@ -927,6 +953,7 @@ Q_SIGNALS:
     void focusPolicyIsResonableChanged();
     void xwaylandCrashPolicyChanged();
     void xwaylandMaxCrashCountChanged();
+    void xwaylandPrestartChanged();
     void xwaylandEavesdropsChanged();
     void nextFocusPrefersMouseChanged();
     void clickRaiseChanged();
@@ -979,8 +1006,14 @@ Q_SIGNALS:
     void glPreferBufferSwapChanged();
     void glPlatformInterfaceChanged();
     void windowsBlockCompositingChanged();
+    void unredirectFullscreenChanged();
     void animationSpeedChanged();
     void latencyPolicyChanged();
+    /**
+     * Emitted by updateSettings() before configChanged() if a setting that requires
+     * restarting the compositor has changed.
+     */
+    void compositingSettingsChanged();
     void configChanged();
     void renderTimeEstimatorChanged();
     void allowTearingChanged();
@@ -1013,6 +1046,7 @@ private:
     bool m_hideUtilityWindowsForInactive;
     XwaylandCrashPolicy m_xwaylandCrashPolicy;
     int m_xwaylandMaxCrashCount;
+    bool m_xwaylandPrestart;
     XwaylandEavesdropsMode m_xwaylandEavesdrops;
     LatencyPolicy m_latencyPolicy;
     RenderTimeEstimator m_renderTimeEstimator;
@@ -1027,6 +1061,7 @@ private:
     GlSwapStrategy m_glPreferBufferSwap;
     OpenGLPlatformInterface m_glPlatformInterface;
     bool m_windowsBlockCompositing;
+    bool m_unredirectFullscreen;
 
     WindowOperation OpTitlebarDblClick;
     WindowOperation opMaxButtonRightClick = defaultOperationMaxButtonRightClick();
@@ -1058,6 +1093,7 @@ private:
     bool condensed_title;
 
     bool m_allowTearing = true;
+    bool m_compositingSettingsChanged = false;
 
     QHash<Qt::KeyboardModifier, QStringList> m_modifierOnlyShortcuts;
 
@@ -5,11 +5,24 @@
 
 */
 #include "osd.h"
+#include "composite.h"
+#include "core/output.h"
 #include "main.h"
 #include "onscreennotification.h"
+#include "scene/imageitem.h"
+#include "scene/itemrenderer.h"
+#include "scene/workspacescene.h"
 #include "scripting/scripting.h"
+#include "virtualdesktops.h"
 #include "workspace.h"
 
+#include <KConfigGroup>
+
+#include <QFontMetrics>
+#include <QGuiApplication>
+#include <QIcon>
+#include <QPainter>
+#include <QPalette>
 #include <QQmlEngine>
 #include <QThread>
 
@@ -18,11 +31,119 @@ namespace KWin
 namespace OSD
 {
 
+/**
+ * Draws the notification into an image item on top of the windows, like the default
+ * plasma theme: an icon and a label on a rounded background.
+ */
+class ItemOnScreenNotificationVisual : public OnScreenNotificationVisual
+{
+public:
+    ItemOnScreenNotificationVisual()
+    {
+        // the item belongs to the scene, which is destroyed before compositingToggled
+        m_compositingConnection = QObject::connect(Compositor::self(), &Compositor::aboutToToggleCompositing, [this]() {
+            m_item.reset();
+        });
+    }
+
+    ~ItemOnScreenNotificationVisual() override
+    {
+        QObject::disconnect(m_compositingConnection);
+    }
+
+    bool show(const QString &message, const QString &iconName) override
+    {
+        WorkspaceScene *scene = Compositor::self()->scene();
+        if (!scene) {
+            return false;
+        }
+        if (!m_item) {
+            m_item.reset(scene->renderer()->createImageItem(scene, scene->overlayItem()));
+        }
+
+        constexpr int padding = 12;
+        constexpr int spacing = 6;
+        constexpr int iconSize = 32;
+        const QFont font = QGuiApplication::font();
+        const QSize textSize = QFontMetrics(font).size(0, message);
+        const bool hasIcon = !iconName.isEmpty();
+        const QSize size(2 * padding + textSize.width() + (hasIcon ? iconSize + spacing : 0),
+                         2 * padding + std::max(textSize.height(), hasIcon ? iconSize : 0));
+
+        Output *output = workspace()->activeOutput();
+        const qreal scale = output->scale();
+        QImage image(size * scale, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(scale);
+        image.fill(Qt::transparent);
+
+        const QPalette palette = QGuiApplication::palette();
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        QColor background = palette.color(QPalette::Window);
+        background.setAlphaF(0.95);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(background);
+        painter.drawRoundedRect(QRectF(QPointF(0, 0), size), 6, 6);
+        int x = padding;
+        if (hasIcon) {
+            const QRect iconRect(x, (size.height() - iconSize) / 2, iconSize, iconSize);
+            painter.drawPixmap(iconRect, QIcon::fromTheme(iconName).pixmap(iconRect.size(), scale));
+            x += iconSize + spacing;
+        }
+        painter.setPen(palette.color(QPalette::WindowText));
+        painter.setFont(font);
+        painter.drawText(QRect(x, 0, textSize.width(), size.height()), Qt::AlignLeft | Qt::AlignVCenter, message);
+        painter.end();
+
+        // the same place as the one of on-screen display windows, see Placement::placeOnScreenDisplay()
+        const QRectF area = workspace()->clientArea(PlacementArea, output, VirtualDesktopManager::self()->currentDesktop());
+        m_geometry = QRect(QPoint(area.left() + (area.width() - size.width()) / 2,
+                                  area.top() + 2 * area.height() / 3 - size.height() / 2),
+                           size);
+
+        m_item->setImage(image);
+        m_item->setPosition(m_geometry.topLeft());
+        m_item->setSize(m_geometry.size());
+        m_item->scheduleRepaint(m_item->rect());
+        m_item->setVisible(true);
+        return true;
+    }
+
+    void hide() override
+    {
+        if (m_item) {
+            m_item->setVisible(false);
+            m_item->setOpacity(1.0);
+        }
+    }
+
+    QRect geometry() const override
+    {
+        return m_item && m_item->isVisible() ? m_geometry : QRect();
+    }
+
+    void setOpacity(qreal opacity) override
+    {
+        if (m_item) {
+            m_item->setOpacity(opacity);
+        }
+    }
+
+private:
+    std::unique_ptr<ImageItem> m_item;
+    QRect m_geometry;
+    QMetaObject::Connection m_compositingConnection;
+};
+
 static OnScreenNotification *create()
 {
     auto osd = new OnScreenNotification(workspace());
     osd->setConfig(kwinApp()->config());
     osd->setEngine(Scripting::self()->qmlEngine());
+    // the default notification doesn't need any QML, only custom themes do
+    if (Compositor::self() && !kwinApp()->config()->group(QStringLiteral("OnScreenNotification")).hasKey("QmlPath")) {
+        osd->setVisual(std::make_unique<ItemOnScreenNotificationVisual>());
+    }
     return osd;
 }
 
@@ -34,11 +155,6 @@ static OnScreenNotification *osd()
 
 void show(const QString &message, const QString &iconName, int timeout)
 {
-    if (!kwinApp()->shouldUseWaylandForCompositing()) {
-        // FIXME: only supported on Wayland
-        return;
-    }
-
     if (QThread::currentThread() != qGuiApp->thread()) {
         QTimer::singleShot(0, QCoreApplication::instance(), [message, iconName, timeout] {
             show(message, iconName, timeout);
@@ -65,10 +181,6 @@ void show(const QString &message, const QString &iconName)
 
 void hide(HideFlags flags)
 {
-    if (!kwinApp()->shouldUseWaylandForCompositing()) {
-        // FIXME: only supported on Wayland
-        return;
-    }
     osd()->setSkipCloseAnimation(flags.testFlag(HideFlag::SkipCloseAnimation));
     osd()->setVisible(false);
 }
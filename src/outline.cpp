@@ -12,12 +12,17 @@
 // KWin
 #include "composite.h"
 #include "main.h"
+#include "scene/imageitem.h"
+#include "scene/itemrenderer.h"
+#include "scene/workspacescene.h"
 #include "scripting/scripting.h"
 #include "utils/common.h"
 // Frameworks
 #include <KConfigGroup>
 // Qt
 #include <QDebug>
+#include <QGuiApplication>
+#include <QPalette>
 #include <QQmlComponent>
 #include <QQmlContext>
 #include <QQmlEngine>
@@ -31,6 +36,10 @@ Outline::Outline()
     : m_active(false)
 {
     connect(Compositor::self(), &Compositor::compositingToggled, this, &Outline::compositingChanged);
+    // the visual may hold items of the scene, which is destroyed before compositingToggled
+    connect(Compositor::self(), &Compositor::aboutToToggleCompositing, this, [this]() {
+        m_visual.reset();
+    });
 }
 
 Outline::~Outline() = default;
@@ -185,4 +194,79 @@ void CompositedOutlineVisual::show()
     }
 }
 
+static constexpr qreal s_outlineBorderWidth = 2;
+
+static QImage solidImage(const QColor &color)
+{
+    QImage image(1, 1, QImage::Format_ARGB32_Premultiplied);
+    image.fill(color);
+    return image;
+}
+
+ItemOutlineVisual::ItemOutlineVisual(Outline *outline)
+    : OutlineVisual(outline)
+{
+}
+
+ItemOutlineVisual::~ItemOutlineVisual()
+{
+    // the child items have to go before their parent
+    m_fillItem.reset();
+    for (auto &item : m_borderItems) {
+        item.reset();
+    }
+}
+
+void ItemOutlineVisual::show()
+{
+    if (!m_rootItem) {
+        WorkspaceScene *scene = Compositor::self()->scene();
+        m_rootItem = std::make_unique<Item>(scene, scene->overlayItem());
+
+        // the 1x1 images are stretched over the items, the color is the same as the one of the plasma theme
+        QColor color = QGuiApplication::palette().color(QPalette::Highlight);
+        m_fillItem.reset(scene->renderer()->createImageItem(scene, m_rootItem.get()));
+        m_fillItem->setImage(solidImage(QColor(color.red(), color.green(), color.blue(), 64)));
+        for (auto &item : m_borderItems) {
+            item.reset(scene->renderer()->createImageItem(scene, m_rootItem.get()));
+            item->setImage(solidImage(color));
+        }
+
+        QObject::connect(m_outline, &Outline::geometryChanged, m_rootItem.get(), [this]() {
+            updateGeometry();
+        });
+    }
+    updateGeometry();
+    m_rootItem->setVisible(true);
+}
+
+void ItemOutlineVisual::hide()
+{
+    if (m_rootItem) {
+        m_rootItem->setVisible(false);
+    }
+}
+
+void ItemOutlineVisual::updateGeometry()
+{
+    const QRectF geometry = m_outline->geometry();
+    const qreal border = std::min({s_outlineBorderWidth, geometry.width() / 2, geometry.height() / 2});
+    m_rootItem->setPosition(geometry.topLeft());
+
+    m_fillItem->setPosition(QPointF(border, border));
+    m_fillItem->setSize(geometry.size() - QSizeF(2 * border, 2 * border));
+
+    // top, bottom, left and right. The vertical borders don't cover the corners
+    const std::array<QRectF, 4> borders{
+        QRectF(0, 0, geometry.width(), border),
+        QRectF(0, geometry.height() - border, geometry.width(), border),
+        QRectF(0, border, border, geometry.height() - 2 * border),
+        QRectF(geometry.width() - border, border, border, geometry.height() - 2 * border),
+    };
+    for (size_t i = 0; i < borders.size(); ++i) {
+        m_borderItems[i]->setPosition(borders[i].topLeft());
+        m_borderItems[i]->setSize(borders[i].size());
+    }
+}
+
 } // namespace
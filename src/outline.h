@@ -14,6 +14,7 @@
 #include <memory>
 
 #include <kwin_export.h>
+#include <array>
 #include <memory>
 
 class QQmlContext;
@@ -21,6 +22,8 @@ class QQmlComponent;
 
 namespace KWin
 {
+class ImageItem;
+class Item;
 class OutlineVisual;
 
 /**
@@ -143,4 +146,25 @@ private:
     std::unique_ptr<QQmlComponent> m_qmlComponent;
     std::unique_ptr<QObject> m_mainItem;
 };
+
+/**
+ * The ItemOutlineVisual draws the outline with a few items on top of the windows in the
+ * scene, so showing it doesn't need a QML component. It's used unless a custom QML theme
+ * is configured.
+ */
+class ItemOutlineVisual : public OutlineVisual
+{
+public:
+    ItemOutlineVisual(Outline *outline);
+    ~ItemOutlineVisual() override;
+    void show() override;
+    void hide() override;
+
+private:
+    void updateGeometry();
+
+    std::unique_ptr<Item> m_rootItem;
+    std::unique_ptr<ImageItem> m_fillItem;
+    std::array<std::unique_ptr<ImageItem>, 4> m_borderItems;
+};
 }
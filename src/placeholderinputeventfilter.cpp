@@ -12,6 +12,11 @@
 namespace KWin
 {
 
+PlaceholderInputEventFilter::PlaceholderInputEventFilter()
+    : InputEventFilter(PointerEvents | WheelEvents | KeyEvents | TouchEvents)
+{
+}
+
 bool PlaceholderInputEventFilter::pointerEvent(MouseEvent *event, quint32 nativeButton)
 {
     return true;
@@ -24,6 +24,8 @@
 #include <QTextStream>
 #include <QTimer>
 
+#include <vector>
+
 namespace KWin
 {
 
@@ -153,6 +155,23 @@ static inline bool isIrrelevant(const Window *window, const Window *regarding, V
         || window->isDesktop();
 };
 
+/**
+ * Returns the windows that the placement of @a window on @a desktop has to take into account,
+ * in the stacking order. The placement strategies test many candidate positions, the windows
+ * are filtered only once rather than for every candidate.
+ */
+static QList<Window *> relevantWindows(const Window *window, VirtualDesktop *desktop)
+{
+    QList<Window *> windows;
+    const QList<Window *> &stackingOrder = workspace()->stackingOrder();
+    for (Window *other : stackingOrder) {
+        if (!isIrrelevant(other, window, desktop)) {
+            windows.append(other);
+        }
+    }
+    return windows;
+}
+
 /**
  * Place the client \a c according to a really smart placement algorithm :-)
  */
@@ -195,6 +214,35 @@ void Placement::placeSmart(Window *window, const QRectF &area, PlacementPolicy /
 
     bool first_pass = true; // CT lame flag. Don't like it. What else would do?
 
+    struct Obstacle
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+        int weight;
+    };
+    std::vector<Obstacle> obstacles;
+    const QList<Window *> others = relevantWindows(window, desktop);
+    obstacles.reserve(others.size());
+    for (const Window *client : others) {
+        const int left = client->x();
+        const int top = client->y();
+        int weight = 1;
+        if (client->keepAbove()) {
+            weight = 16;
+        } else if (client->keepBelow() && !client->isDock()) { // ignore KeepBelow windows
+            weight = 0; // for placement (see X11Window::belongsToLayer() for Dock)
+        }
+        obstacles.push_back(Obstacle{
+            .left = left,
+            .top = top,
+            .right = int(left + client->width()),
+            .bottom = int(top + client->height()),
+            .weight = weight,
+        });
+    }
+
     // loop over possible positions
     do {
         // test if enough room in x and y directions
@@ -209,15 +257,11 @@ void Placement::placeSmart(Window *window, const QRectF &area, PlacementPolicy /
             cxr = x + cw;
             cyt = y;
             cyb = y + ch;
-            for (auto l = workspace()->stackingOrder().constBegin(); l != workspace()->stackingOrder().constEnd(); ++l) {
-                auto client = *l;
-                if (isIrrelevant(client, window, desktop)) {
-                    continue;
-                }
-                xl = client->x();
-                yt = client->y();
-                xr = xl + client->width();
-                yb = yt + client->height();
+            for (const Obstacle &obstacle : obstacles) {
+                xl = obstacle.left;
+                yt = obstacle.top;
+                xr = obstacle.right;
+                yb = obstacle.bottom;
 
                 // if windows overlap, calc the overall overlapping
                 if ((cxl < xr) && (cxr > xl) && (cyt < yb) && (cyb > yt)) {
@@ -225,13 +269,7 @@ void Placement::placeSmart(Window *window, const QRectF &area, PlacementPolicy /
                     xr = std::min(cxr, xr);
                     yt = std::max(cyt, yt);
                     yb = std::min(cyb, yb);
-                    if (client->keepAbove()) {
-                        overlap += 16 * (xr - xl) * (yb - yt);
-                    } else if (client->keepBelow() && !client->isDock()) { // ignore KeepBelow windows
-                        overlap += 0; // for placement (see X11Window::belongsToLayer() for Dock)
-                    } else {
-                        overlap += (xr - xl) * (yb - yt);
-                    }
+                    overlap += obstacle.weight * (xr - xl) * (yb - yt);
                 }
             }
         }
@@ -263,16 +301,11 @@ void Placement::placeSmart(Window *window, const QRectF &area, PlacementPolicy /
             }
 
             // compare to the position of each client on the same desk
-            for (auto l = workspace()->stackingOrder().constBegin(); l != workspace()->stackingOrder().constEnd(); ++l) {
-                auto client = *l;
-                if (isIrrelevant(client, window, desktop)) {
-                    continue;
-                }
-
-                xl = client->x();
-                yt = client->y();
-                xr = xl + client->width();
-                yb = yt + client->height();
+            for (const Obstacle &obstacle : obstacles) {
+                xl = obstacle.left;
+                yt = obstacle.top;
+                xr = obstacle.right;
+                yb = obstacle.bottom;
 
                 // if not enough room above or under the current tested client
                 // determine the first non-overlapped x position
@@ -301,16 +334,11 @@ void Placement::placeSmart(Window *window, const QRectF &area, PlacementPolicy /
             }
 
             // test the position of each window on the desk
-            for (auto l = workspace()->stackingOrder().constBegin(); l != workspace()->stackingOrder().constEnd(); ++l) {
-                auto client = *l;
-                if (isIrrelevant(client, window, desktop)) {
-                    continue;
-                }
-
-                xl = client->x();
-                yt = client->y();
-                xr = xl + client->width();
-                yb = yt + client->height();
+            for (const Obstacle &obstacle : obstacles) {
+                xl = obstacle.left;
+                yt = obstacle.top;
+                xr = obstacle.right;
+                yb = obstacle.bottom;
 
                 // if not enough room to the left or right of the current tested client
                 // determine the first non-overlapped y position
@@ -588,15 +616,16 @@ void Placement::cascadeIfCovering(Window *window, const QRectF &area)
 
     QRectF possibleGeo = window->frameGeometry();
     bool noOverlap = false;
+    const QList<Window *> others = relevantWindows(window, desktop);
 
     // cascade until confirmed no total overlap or not enough space to cascade
     while (!noOverlap) {
         noOverlap = true;
         QRectF coveredArea;
         // check current position candidate for overlaps with other windows
-        for (auto l = workspace()->stackingOrder().crbegin(); l != workspace()->stackingOrder().crend(); ++l) {
+        for (auto l = others.crbegin(); l != others.crend(); ++l) {
             auto other = *l;
-            if (isIrrelevant(other, window, desktop) || !other->frameGeometry().intersects(possibleGeo)) {
+            if (!other->frameGeometry().intersects(possibleGeo)) {
                 continue;
             }
 
@@ -8,6 +8,7 @@
 */
 #include "platformsupport/scenes/opengl/abstract_egl_backend.h"
 #include "composite.h"
+#include "core/graphicsbuffer.h"
 #include "core/outputbackend.h"
 #include "options.h"
 #include "utils/common.h"
@@ -83,6 +84,7 @@ void AbstractEglBackend::cleanup()
     for (const EGLImageKHR &image : m_importedBuffers) {
         eglDestroyImageKHR(m_display->handle(), image);
     }
+    m_importedTextures.clear();
 
     cleanupSurfaces();
     cleanupGL();
@@ -122,34 +124,6 @@ void AbstractEglBackend::initKWinGL()
     initGL(&getProcAddress);
 }
 
-static int bpcForFormat(uint32_t format)
-{
-    switch (format) {
-    case DRM_FORMAT_XRGB8888:
-    case DRM_FORMAT_XBGR8888:
-    case DRM_FORMAT_RGBX8888:
-    case DRM_FORMAT_BGRX8888:
-    case DRM_FORMAT_ARGB8888:
-    case DRM_FORMAT_ABGR8888:
-    case DRM_FORMAT_RGBA8888:
-    case DRM_FORMAT_BGRA8888:
-    case DRM_FORMAT_RGB888:
-    case DRM_FORMAT_BGR888:
-        return 8;
-    case DRM_FORMAT_XRGB2101010:
-    case DRM_FORMAT_XBGR2101010:
-    case DRM_FORMAT_RGBX1010102:
-    case DRM_FORMAT_BGRX1010102:
-    case DRM_FORMAT_ARGB2101010:
-    case DRM_FORMAT_ABGR2101010:
-    case DRM_FORMAT_RGBA1010102:
-    case DRM_FORMAT_BGRA1010102:
-        return 10;
-    default:
-        return -1;
-    }
-}
-
 void AbstractEglBackend::initWayland()
 {
     if (!WaylandServer::self()) {
@@ -180,32 +154,41 @@ void AbstractEglBackend::initWayland()
         }
     }
 
-    auto filterFormats = [this](int bpc) {
+    auto filterFormats = [this](auto predicate) {
         const auto formats = m_display->supportedDrmFormats();
         QHash<uint32_t, QVector<uint64_t>> set;
         for (auto it = formats.constBegin(); it != formats.constEnd(); it++) {
-            if (bpcForFormat(it.key()) == bpc) {
+            if (predicate(GraphicsBuffer::colorDepthFromDrmFormat(it.key()))) {
                 set.insert(it.key(), it.value());
             }
         }
         return set;
     };
-    if (prefer10bpc()) {
+    const bool prefer10 = prefer10bpc();
+    if (prefer10) {
         m_tranches.append({
             .device = deviceId(),
             .flags = {},
-            .formatTable = filterFormats(10),
+            .formatTable = filterFormats([](int bpc) {
+                return bpc == 10;
+            }),
         });
     }
     m_tranches.append({
         .device = deviceId(),
         .flags = {},
-        .formatTable = filterFormats(8),
+        .formatTable = filterFormats([](int bpc) {
+            return bpc == 8;
+        }),
     });
+    // formats with a higher color depth are still supported, the outputs switch to a matching
+    // buffer format while such contents are shown
     m_tranches.append({
         .device = deviceId(),
         .flags = {},
-        .formatTable = filterFormats(-1),
+        .formatTable = filterFormats([prefer10](int bpc) {
+            return bpc != 8 && (bpc != 10 || !prefer10);
+        }),
     });
 
     KWaylandServer::LinuxDmaBufV1ClientBufferIntegration *dmabuf = waylandServer()->linuxDmabuf();
@@ -298,6 +281,38 @@ EGLImageKHR AbstractEglBackend::importBufferAsImage(KWaylandServer::LinuxDmaBufV
     return image;
 }
 
+std::shared_ptr<GLTexture> AbstractEglBackend::importBufferAsTexture(KWaylandServer::LinuxDmaBufV1ClientBuffer *buffer)
+{
+    auto it = m_importedTextures.constFind(buffer);
+    if (Q_LIKELY(it != m_importedTextures.constEnd())) {
+        return *it;
+    }
+
+    EGLImageKHR image = importBufferAsImage(buffer);
+    if (Q_UNLIKELY(image == EGL_NO_IMAGE_KHR)) {
+        return nullptr;
+    }
+
+    auto texture = std::make_shared<GLTexture>(GL_TEXTURE_2D);
+    texture->setSize(buffer->size());
+    texture->create();
+    texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    texture->setFilter(GL_LINEAR);
+    texture->bind();
+    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, static_cast<GLeglImageOES>(image));
+    texture->unbind();
+    texture->setContentTransform(TextureTransform::MirrorY);
+
+    m_importedTextures[buffer] = texture;
+    connect(buffer, &QObject::destroyed, this, [this, buffer]() {
+        // surfaces that still show the buffer keep their reference to the texture
+        makeCurrent();
+        m_importedTextures.remove(buffer);
+    });
+
+    return texture;
+}
+
 EGLImageKHR AbstractEglBackend::importDmaBufAsImage(const DmaBufAttributes &dmabuf) const
 {
     return m_display->importDmaBufAsImage(dmabuf);
@@ -49,6 +49,12 @@ public:
     std::shared_ptr<GLTexture> importDmaBufAsTexture(const DmaBufAttributes &attributes) const;
     EGLImageKHR importDmaBufAsImage(const DmaBufAttributes &attributes) const;
     EGLImageKHR importBufferAsImage(KWaylandServer::LinuxDmaBufV1ClientBuffer *buffer);
+    /**
+     * Returns a texture that is bound to the dmabuf of the given @a buffer. The texture shares
+     * the storage with the buffer, it is shared by all surfaces that attach the buffer and is
+     * released when the buffer is destroyed.
+     */
+    std::shared_ptr<GLTexture> importBufferAsTexture(KWaylandServer::LinuxDmaBufV1ClientBuffer *buffer);
 
 protected:
     AbstractEglBackend(dev_t deviceId = 0);
@@ -77,6 +83,7 @@ private:
     const dev_t m_deviceId;
     QVector<KWaylandServer::LinuxDmaBufV1Feedback::Tranche> m_tranches;
     QHash<KWaylandServer::LinuxDmaBufV1ClientBuffer *, EGLImageKHR> m_importedBuffers;
+    QHash<GraphicsBuffer *, std::shared_ptr<GLTexture>> m_importedTextures;
 };
 
 }
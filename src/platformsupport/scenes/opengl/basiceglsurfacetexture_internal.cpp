@@ -78,6 +78,7 @@ bool BasicEGLSurfaceTextureInternal::updateFromImage(const QRegion &region)
 
     if (!m_texture) {
         m_texture.reset(new GLTexture(image));
+        m_texture->setMemoryCategory(GLTextureMemory::Category::Surface);
     } else {
         const QRegion nativeRegion = scale(region, image.devicePixelRatio());
         for (const QRect &rect : nativeRegion) {
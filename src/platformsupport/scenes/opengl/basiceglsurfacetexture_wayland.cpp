@@ -67,6 +67,7 @@ bool BasicEGLSurfaceTextureWayland::loadShmTexture(KWaylandServer::ShmClientBuff
     }
 
     m_texture.reset(new GLTexture(image));
+    m_texture->setMemoryCategory(GLTextureMemory::Category::Surface);
     m_texture->setFilter(GL_LINEAR);
     m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
     m_texture->setContentTransform(TextureTransform::MirrorY);
@@ -88,29 +89,16 @@ void BasicEGLSurfaceTextureWayland::updateShmTexture(KWaylandServer::ShmClientBu
         return;
     }
 
-    const QRegion damage = mapRegion(m_pixmap->item()->surfaceToBufferMatrix(), region);
-    for (const QRect &rect : damage) {
-        m_texture->update(image, rect.topLeft(), rect);
-    }
+    m_texture->update(image, mapRegion(m_pixmap->item()->surfaceToBufferMatrix(), region));
 }
 
 bool BasicEGLSurfaceTextureWayland::loadDmabufTexture(KWaylandServer::LinuxDmaBufV1ClientBuffer *buffer)
 {
-    EGLImageKHR image = backend()->importBufferAsImage(buffer);
-    if (Q_UNLIKELY(image == EGL_NO_IMAGE_KHR)) {
+    m_texture = backend()->importBufferAsTexture(buffer);
+    if (Q_UNLIKELY(!m_texture)) {
         qCritical(KWIN_OPENGL) << "Invalid dmabuf-based wl_buffer";
         return false;
     }
-
-    m_texture.reset(new GLTexture(GL_TEXTURE_2D));
-    m_texture->setSize(buffer->size());
-    m_texture->create();
-    m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
-    m_texture->setFilter(GL_LINEAR);
-    m_texture->bind();
-    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, static_cast<GLeglImageOES>(image));
-    m_texture->unbind();
-    m_texture->setContentTransform(TextureTransform::MirrorY);
     m_bufferType = BufferType::DmaBuf;
 
     return true;
@@ -124,9 +112,11 @@ void BasicEGLSurfaceTextureWayland::updateDmabufTexture(KWaylandServer::LinuxDma
         return;
     }
 
-    m_texture->bind();
-    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, static_cast<GLeglImageOES>(backend()->importBufferAsImage(buffer)));
-    m_texture->unbind();
+    // The texture shares the storage with the buffer, the texture of a buffer that has been
+    // attached before, possibly to another surface, can be used as is.
+    if (std::shared_ptr<GLTexture> texture = backend()->importBufferAsTexture(buffer)) {
+        m_texture = std::move(texture);
+    }
 }
 
 } // namespace KWin
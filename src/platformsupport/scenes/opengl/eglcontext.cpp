@@ -186,11 +186,23 @@ bool EglContext::isValid() const
     return EGL_NO_CONTEXT;
 }
 
+static GLenum internalFormatForDrmFormat(uint32_t format)
+{
+    switch (GraphicsBuffer::colorDepthFromDrmFormat(format)) {
+    case 10:
+        return GL_RGB10_A2;
+    case 16:
+        return GL_RGBA16F;
+    default:
+        return GL_RGBA8;
+    }
+}
+
 std::shared_ptr<GLTexture> EglContext::importDmaBufAsTexture(const DmaBufAttributes &attributes) const
 {
     EGLImageKHR image = m_display->importDmaBufAsImage(attributes);
     if (image != EGL_NO_IMAGE_KHR) {
-        return std::make_shared<EGLImageTexture>(m_display->handle(), image, GL_RGBA8, QSize(attributes.width, attributes.height));
+        return std::make_shared<EGLImageTexture>(m_display->handle(), image, internalFormatForDrmFormat(attributes.format), QSize(attributes.width, attributes.height));
     } else {
         qCWarning(KWIN_OPENGL) << "Failed to record frame: Error creating EGLImageKHR - " << getEglErrorString();
         return nullptr;
@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2020 Vlad Zahorodnii <vlad.zahorodnii@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwin_export.h"
+#include "utils/filedescriptor.h"
+
+#include <QtGlobal>
+
+#include <epoxy/egl.h>
+
+namespace KWin
+{
+
+class KWIN_EXPORT EGLNativeFence
+{
+public:
+    /**
+     * Inserts a fence into the command stream of the current context.
+     */
+    explicit EGLNativeFence(::EGLDisplay display);
+    /**
+     * Imports the sync file @a fd as a fence, e.g. to let the current context wait for it.
+     */
+    explicit EGLNativeFence(::EGLDisplay display, FileDescriptor &&fd);
+    ~EGLNativeFence();
+
+    bool isValid() const;
+    const FileDescriptor &fileDescriptor() const;
+
+    /**
+     * Makes the current context wait for the fence on the GPU side before executing
+     * later commands. Returns @c false if that isn't possible.
+     */
+    bool waitSync() const;
+
+private:
+    EGLSyncKHR m_sync = EGL_NO_SYNC_KHR;
+    ::EGLDisplay m_display = EGL_NO_DISPLAY;
+    FileDescriptor m_fileDescriptor;
+
+    Q_DISABLE_COPY(EGLNativeFence)
+};
+
+} // namespace KWin
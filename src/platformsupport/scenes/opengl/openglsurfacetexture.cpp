@@ -34,4 +34,9 @@ GLTexture *OpenGLSurfaceTexture::texture() const
     return m_texture.get();
 }
 
+std::shared_ptr<GLTexture> OpenGLSurfaceTexture::textureRef() const
+{
+    return m_texture;
+}
+
 } // namespace KWin
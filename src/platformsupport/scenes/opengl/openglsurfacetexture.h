@@ -24,13 +24,18 @@ public:
 
     OpenGLBackend *backend() const;
     GLTexture *texture() const;
+    /**
+     * Returns a reference to the current texture, which stays valid after the surface texture
+     * has moved on to another one, e.g. because a new buffer has been attached.
+     */
+    std::shared_ptr<GLTexture> textureRef() const;
 
     virtual bool create() = 0;
     virtual void update(const QRegion &region) = 0;
 
 protected:
     OpenGLBackend *m_backend;
-    std::unique_ptr<GLTexture> m_texture;
+    std::shared_ptr<GLTexture> m_texture;
 };
 
 } // namespace KWin
@@ -0,0 +1,196 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "qpainterblit.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace KWin
+{
+
+namespace
+{
+enum class Operation {
+    Copy, // the pixels are copied as is
+    CopyOpaque, // the pixels are copied, their unused alpha channel is set
+    Blend, // the premultiplied pixels are blended over the target
+};
+
+struct Blit
+{
+    // the bits are looked up once, QImage may not be detached from the worker threads
+    uchar *targetBits;
+    qsizetype targetStride;
+    QRect targetRect;
+    const uchar *sourceBits;
+    qsizetype sourceStride;
+    QRect sourceRect;
+    int scale;
+    Operation operation;
+};
+}
+
+static QThreadPool *blitPool()
+{
+    static QThreadPool pool;
+    return &pool;
+}
+
+// The loops below have no branches, so the compiler can vectorize them for whichever
+// instruction set kwin is built for
+
+static void copyOpaqueRow(uint32_t *dst, const uint32_t *src, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        dst[i] = src[i] | 0xff000000;
+    }
+}
+
+static void blendRow(uint32_t *dst, const uint32_t *src, int count)
+{
+    // dst = src + dst * (255 - src.alpha) / 255, two channels are multiplied at once
+    for (int i = 0; i < count; ++i) {
+        const uint32_t s = src[i];
+        const uint32_t d = dst[i];
+        const uint32_t inverseAlpha = 255 - (s >> 24);
+
+        uint32_t rb = (d & 0x00ff00ff) * inverseAlpha + 0x00800080;
+        rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+        uint32_t ag = ((d >> 8) & 0x00ff00ff) * inverseAlpha + 0x00800080;
+        ag = (ag + ((ag >> 8) & 0x00ff00ff)) & 0xff00ff00;
+
+        dst[i] = s + (rb | ag);
+    }
+}
+
+static void processRow(uint32_t *dst, const uint32_t *src, int count, Operation operation)
+{
+    switch (operation) {
+    case Operation::Copy:
+        std::memcpy(dst, src, count * sizeof(uint32_t));
+        break;
+    case Operation::CopyOpaque:
+        copyOpaqueRow(dst, src, count);
+        break;
+    case Operation::Blend:
+        blendRow(dst, src, count);
+        break;
+    }
+}
+
+static void blitRows(const Blit &blit, const QRect &rect)
+{
+    const int sourceX = blit.sourceRect.x() + (rect.x() - blit.targetRect.x()) / blit.scale;
+    std::vector<uint32_t> scaledRow;
+    if (blit.scale > 1) {
+        scaledRow.resize(rect.width());
+    }
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        const int sourceY = blit.sourceRect.y() + (y - blit.targetRect.y()) / blit.scale;
+        const auto sourceRow = reinterpret_cast<const uint32_t *>(blit.sourceBits + sourceY * blit.sourceStride);
+        const auto targetRow = reinterpret_cast<uint32_t *>(blit.targetBits + y * blit.targetStride) + rect.x();
+
+        if (blit.scale == 1) {
+            processRow(targetRow, sourceRow + sourceX, rect.width(), blit.operation);
+        } else {
+            // the phase of the first pixel depends on where the rect starts
+            const int phase = (rect.x() - blit.targetRect.x()) % blit.scale;
+            for (int x = 0; x < rect.width(); ++x) {
+                scaledRow[x] = sourceRow[sourceX + (phase + x) / blit.scale];
+            }
+            processRow(targetRow, scaledRow.data(), rect.width(), blit.operation);
+        }
+    }
+}
+
+static bool isSupportedFormat(QImage::Format format)
+{
+    return format == QImage::Format_ARGB32_Premultiplied || format == QImage::Format_RGB32;
+}
+
+bool blitImage(QImage *target, const QRect &targetRect, const QImage &source, const QRect &sourceRect, const QRegion &clip, BlitMode mode, bool parallel)
+{
+    if (!isSupportedFormat(target->format()) || !isSupportedFormat(source.format())) {
+        return false;
+    }
+    if (sourceRect.isEmpty() || !source.rect().contains(sourceRect)) {
+        return false;
+    }
+
+    const int scale = targetRect.width() / sourceRect.width();
+    if (scale < 1 || targetRect.width() != sourceRect.width() * scale || targetRect.height() != sourceRect.height() * scale) {
+        return false;
+    }
+
+    Operation operation;
+    if (source.format() == QImage::Format_RGB32) {
+        operation = target->format() == QImage::Format_RGB32 ? Operation::Copy : Operation::CopyOpaque;
+    } else if (mode == BlitMode::SourceOver) {
+        operation = Operation::Blend;
+    } else if (target->format() == QImage::Format_ARGB32_Premultiplied) {
+        operation = Operation::Copy;
+    } else {
+        // the alpha channel would have to be composited onto black
+        return false;
+    }
+
+    const QRegion region = clip & targetRect & target->rect();
+    if (region.isEmpty()) {
+        return true;
+    }
+
+    const Blit blit{
+        .targetBits = target->bits(),
+        .targetStride = target->bytesPerLine(),
+        .targetRect = targetRect,
+        .sourceBits = source.constBits(),
+        .sourceStride = source.bytesPerLine(),
+        .sourceRect = sourceRect,
+        .scale = scale,
+        .operation = operation,
+    };
+
+    constexpr int minimumBandHeight = 32;
+    constexpr int minimumParallelPixels = 256 * 256;
+
+    qint64 pixels = 0;
+    for (const QRect &rect : region) {
+        pixels += qint64(rect.width()) * rect.height();
+    }
+    if (!parallel || pixels < minimumParallelPixels || QThread::idealThreadCount() < 2) {
+        for (const QRect &rect : region) {
+            blitRows(blit, rect);
+        }
+        return true;
+    }
+
+    std::vector<QRect> bands;
+    const qint64 bandPixels = std::max<qint64>(pixels / QThread::idealThreadCount(), minimumParallelPixels / 4);
+    for (const QRect &rect : region) {
+        const int bandHeight = std::max<int>(minimumBandHeight, bandPixels / rect.width());
+        for (int y = rect.top(); y <= rect.bottom(); y += bandHeight) {
+            bands.push_back(QRect(rect.x(), y, rect.width(), std::min(bandHeight, rect.bottom() + 1 - y)));
+        }
+    }
+
+    QThreadPool *pool = blitPool();
+    for (size_t i = 1; i < bands.size(); ++i) {
+        pool->start([&blit, band = bands[i]]() {
+            blitRows(blit, band);
+        });
+    }
+    blitRows(blit, bands.front());
+    pool->waitForDone();
+    return true;
+}
+
+} // namespace KWin
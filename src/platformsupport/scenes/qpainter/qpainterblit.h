@@ -0,0 +1,34 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QImage>
+#include <QRegion>
+
+namespace KWin
+{
+
+enum class BlitMode {
+    Source,
+    SourceOver,
+};
+
+/**
+ * Copies or blends the pixels of @a source in @a sourceRect onto @a target at @a targetRect,
+ * clipped to @a clip, without going through QPainter. The target rect must be an integer
+ * multiple of the source rect, bigger pixels are repeated like with nearest sampling.
+ *
+ * This only handles premultiplied 32 bit formats, which cover nearly all the buffers the
+ * QPainter scene deals with. Returns @c false if the images can't be blitted, in which case
+ * the caller has to fall back to QPainter.
+ *
+ * If @a parallel is @c true, large areas are split in bands of rows, which are processed by a
+ * pool of worker threads.
+ */
+bool blitImage(QImage *target, const QRect &targetRect, const QImage &source, const QRect &sourceRect, const QRegion &clip, BlitMode mode, bool parallel = true);
+
+} // namespace KWin
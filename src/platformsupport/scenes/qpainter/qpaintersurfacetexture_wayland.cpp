@@ -5,6 +5,7 @@
 */
 
 #include "qpaintersurfacetexture_wayland.h"
+#include "qpainterblit.h"
 #include "scene/surfaceitem_wayland.h"
 #include "utils/common.h"
 #include "wayland/shmclientbuffer.h"
@@ -41,12 +42,19 @@ void QPainterSurfaceTextureWayland::update(const QRegion &region)
     }
 
     const QImage image = buffer->data();
-    const QRegion dirtyRegion = mapRegion(m_pixmap->item()->surfaceToBufferMatrix(), region);
-    QPainter painter(&m_image);
-    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    const QRegion dirtyRegion = mapRegion(m_pixmap->item()->surfaceToBufferMatrix(), region) & image.rect();
+    if (dirtyRegion.isEmpty()) {
+        return;
+    }
 
     // The buffer data is copied as the buffer interface returns a QImage
     // which doesn't own the data of the underlying wl_shm_buffer object.
+    if (blitImage(&m_image, image.rect(), image, image.rect(), dirtyRegion, BlitMode::Source)) {
+        return;
+    }
+
+    QPainter painter(&m_image);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
     for (const QRect &rect : dirtyRegion) {
         painter.drawImage(rect, image, rect);
     }
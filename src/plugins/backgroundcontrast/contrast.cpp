@@ -77,6 +77,11 @@ ContrastEffect::ContrastEffect()
 
 ContrastEffect::~ContrastEffect()
 {
+    const EffectWindowList windowList = effects->stackingOrder();
+    for (EffectWindow *window : windowList) {
+        unpublishContrast(window);
+    }
+
     // When compositing is restarted, avoid removing the manager immediately.
     if (s_contrastManager) {
         s_contrastManagerRemoveTimer->start(1000);
@@ -166,6 +171,32 @@ void ContrastEffect::updateContrastRegion(EffectWindow *w)
         };
     } else {
         m_windowData.remove(w);
+        unpublishContrast(w);
+    }
+}
+
+void ContrastEffect::publishContrast(EffectWindow *w)
+{
+    // The blur effect samples the backdrop of the window before this effect does, if it blurs
+    // the same region it can apply the color matrix in its last pass, see drawWindow()
+    const auto it = m_windowData.constFind(w);
+    if (it == m_windowData.constEnd()) {
+        return;
+    }
+    const QRegion region = contrastRegion(w);
+    if (w->data(WindowBackgroundContrastRegionRole).value<QRegion>() != region) {
+        w->setData(WindowBackgroundContrastRegionRole, QVariant::fromValue(region));
+    }
+    if (w->data(WindowBackgroundContrastMatrixRole).value<QMatrix4x4>() != it->colorMatrix) {
+        w->setData(WindowBackgroundContrastMatrixRole, QVariant::fromValue(it->colorMatrix));
+    }
+}
+
+void ContrastEffect::unpublishContrast(EffectWindow *w)
+{
+    if (w->data(WindowBackgroundContrastRegionRole).isValid()) {
+        w->setData(WindowBackgroundContrastRegionRole, QVariant());
+        w->setData(WindowBackgroundContrastMatrixRole, QVariant());
     }
 }
 
@@ -378,9 +409,17 @@ bool ContrastEffect::shouldContrast(const EffectWindow *w, int mask, const Windo
     return true;
 }
 
+void ContrastEffect::prePaintWindow(EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime)
+{
+    if (m_shader && m_shader->isValid()) {
+        publishContrast(w);
+    }
+    effects->prePaintWindow(w, data, presentTime);
+}
+
 void ContrastEffect::drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &region, WindowPaintData &data)
 {
-    if (shouldContrast(w, mask, data)) {
+    if (!w->data(WindowBackgroundContrastAppliedRole).toBool() && shouldContrast(w, mask, data)) {
         const QRect screen = viewport.renderRect().toRect();
         QRegion shape = region & contrastRegion(w).translated(w->pos().toPoint()) & screen;
 
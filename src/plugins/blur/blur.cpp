@@ -7,6 +7,7 @@
 */
 
 #include "blur.h"
+#include "blurcomputeshader.h"
 #include "blurshader.h"
 // KConfigSkeleton
 #include "blurconfig.h"
@@ -44,6 +45,12 @@ BlurEffect::BlurEffect()
 {
     initConfig<BlurConfig>();
     m_shader = new BlurShader(this);
+    if (BlurComputeShader::supported()) {
+        m_computeShader = std::make_unique<BlurComputeShader>();
+        if (!m_computeShader->isValid()) {
+            m_computeShader.reset();
+        }
+    }
 
     initBlurStrengthValues();
     reconfigure(ReconfigureAll);
@@ -122,6 +129,9 @@ void BlurEffect::screenRemoved(EffectScreen *screen)
     disconnect(screen, &EffectScreen::geometryChanged, this, nullptr);
     effects->makeOpenGLContextCurrent();
     m_screenData.erase(screen);
+    std::erase_if(m_blurCache, [screen](const auto &entry) {
+        return entry.first.second == screen;
+    });
 }
 
 void BlurEffect::screenGeometryChanged(EffectScreen *screen)
@@ -137,8 +147,13 @@ void BlurEffect::screenGeometryChanged(EffectScreen *screen)
     effects->doneOpenGLContextCurrent();
 }
 
-void BlurEffect::updateTexture(EffectScreen *screen)
+void BlurEffect::updateTexture(EffectScreen *screen, GLenum intermediateFormat)
 {
+    // the cached results were produced with the old textures and blur strength
+    std::erase_if(m_blurCache, [screen](const auto &entry) {
+        return entry.first.second == screen;
+    });
+
     ScreenData data;
     /* Reserve memory for:
      *  - The original sized texture (1)
@@ -173,6 +188,11 @@ void BlurEffect::updateTexture(EffectScreen *screen)
         }
     }
 
+    // the screen has a higher color depth, don't blur with less precision
+    if (intermediateFormat != GL_RGBA8) {
+        textureFormat = intermediateFormat;
+    }
+
     // Note that we currently render the entire blur effect in logical
     // coordinates - this means that when using high DPI screens the underlying
     // texture will be low DPI. This isn't really visible since we're blurring
@@ -180,6 +200,7 @@ void BlurEffect::updateTexture(EffectScreen *screen)
     const auto screenSize = screen ? screen->geometry().size() : effects->virtualScreenSize();
     for (int i = 0; i <= m_downSampleIterations; i++) {
         data.renderTargetTextures.push_back(std::make_unique<GLTexture>(textureFormat, screenSize / (1 << i)));
+        data.renderTargetTextures.back()->setMemoryCategory(GLTextureMemory::Category::Effect);
         data.renderTargetTextures.back()->setFilter(GL_LINEAR);
         data.renderTargetTextures.back()->setWrapMode(GL_CLAMP_TO_EDGE);
 
@@ -188,6 +209,7 @@ void BlurEffect::updateTexture(EffectScreen *screen)
 
     // This last set is used as a temporary helper texture
     data.renderTargetTextures.push_back(std::make_unique<GLTexture>(textureFormat, screenSize));
+    data.renderTargetTextures.back()->setMemoryCategory(GLTextureMemory::Category::Effect);
     data.renderTargetTextures.back()->setFilter(GL_LINEAR);
     data.renderTargetTextures.back()->setWrapMode(GL_CLAMP_TO_EDGE);
 
@@ -216,6 +238,7 @@ void BlurEffect::updateTexture(EffectScreen *screen)
     // Copysample
     data.renderTargetStack.push(data.renderTargets.front().get());
 
+    data.intermediateFormat = intermediateFormat;
     m_screenData[screen] = std::move(data);
 }
 
@@ -367,6 +390,14 @@ void BlurEffect::slotWindowAdded(EffectWindow *w)
 void BlurEffect::slotWindowDeleted(EffectWindow *w)
 {
     blurRegions.remove(w);
+    if (std::any_of(m_blurCache.begin(), m_blurCache.end(), [w](const auto &entry) {
+            return entry.first.first == w;
+        })) {
+        effects->makeOpenGLContextCurrent();
+        std::erase_if(m_blurCache, [w](const auto &entry) {
+            return entry.first.first == w;
+        });
+    }
     auto it = windowBlurChangedConnections.find(w);
     if (it == windowBlurChangedConnections.end()) {
         return;
@@ -552,8 +583,26 @@ void BlurEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseco
     m_paintedArea = QRegion();
     m_currentBlur = QRegion();
     m_currentScreen = effects->waylandDisplay() ? data.screen : nullptr;
+    m_blurGroups.clear();
+    m_blurGroupOfWindow.clear();
+    m_blurGroupPaintedArea = QRegion();
+    m_blurGroupOpen = false;
 
     effects->prePaintScreen(data, presentTime);
+
+    // the window paint regions don't describe what ends up behind a window in these cases
+    if ((data.mask & PAINT_SCREEN_TRANSFORMED) || effects->activeFullScreenEffect()) {
+        invalidateBlurCache(m_currentScreen);
+    }
+}
+
+void BlurEffect::invalidateBlurCache(EffectScreen *screen)
+{
+    for (auto &[key, cache] : m_blurCache) {
+        if (key.second == screen) {
+            cache.dirty = true;
+        }
+    }
 }
 
 void BlurEffect::prePaintWindow(EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime)
@@ -590,6 +639,33 @@ void BlurEffect::prePaintWindow(EffectWindow *w, WindowPrePaintData &data, std::
     const QRegion blurArea = blurRegion(w).translated(w->pos().toPoint()) & screen;
     const QRegion expandedBlur = (w->isDock() ? blurArea : expand(blurArea)) & screen;
 
+    // anything painted underneath the blurred area makes the cached blur stale, damage of
+    // the window itself doesn't
+    auto cache = m_blurCache.find({w, m_currentScreen});
+    if (cache != m_blurCache.end() && m_paintedArea.intersects(expandedBlur)) {
+        cache->second.dirty = true;
+    }
+
+    if (!expandedBlur.isEmpty()) {
+        // Docks don't use the extended blur and windows with a valid cache don't run the
+        // passes, both end the current group, as does painting behind this window.
+        const bool cached = cache != m_blurCache.end() && !cache->second.dirty;
+        const bool isDock = w->isDock() || (w->transientFor() && w->transientFor()->isDock());
+        if (isDock || cached) {
+            m_blurGroupOpen = false;
+        } else {
+            if (!m_blurGroupOpen || m_blurGroupPaintedArea.intersects(expandedBlur)) {
+                m_blurGroups.append(BlurGroup());
+                m_blurGroupPaintedArea = QRegion();
+                m_blurGroupOpen = true;
+            }
+            BlurGroup &group = m_blurGroups.last();
+            group.region |= expandedBlur;
+            group.windowCount++;
+            m_blurGroupOfWindow[w] = m_blurGroups.size() - 1;
+        }
+    }
+
     // if this window or a window underneath the blurred area is painted again we have to
     // blur everything
     if (m_paintedArea.intersects(expandedBlur) || data.paint.intersects(blurArea)) {
@@ -605,6 +681,10 @@ void BlurEffect::prePaintWindow(EffectWindow *w, WindowPrePaintData &data, std::
 
     m_paintedArea -= data.opaque;
     m_paintedArea |= data.paint;
+
+    if (m_blurGroupOpen) {
+        m_blurGroupPaintedArea |= data.paint;
+    }
 }
 
 bool BlurEffect::shouldBlur(const EffectWindow *w, int mask, const WindowPaintData &data) const
@@ -631,8 +711,29 @@ bool BlurEffect::shouldBlur(const EffectWindow *w, int mask, const WindowPaintDa
     return true;
 }
 
+std::optional<QMatrix4x4> BlurEffect::backgroundContrastMatrix(const EffectWindow *w, int mask, const WindowPaintData &data) const
+{
+    // The background contrast effect publishes its color matrix, it can be applied in the last
+    // upsample pass if it covers exactly the blurred region and would be applied at all
+    const QVariant matrix = w->data(WindowBackgroundContrastMatrixRole);
+    if (!matrix.isValid() || w->data(WindowBackgroundContrastRegionRole).value<QRegion>() != blurRegion(w)) {
+        return std::nullopt;
+    }
+
+    if (!w->data(WindowForceBackgroundContrastRole).toBool()) {
+        const bool scaled = !qFuzzyCompare(data.xScale(), 1.0) && !qFuzzyCompare(data.yScale(), 1.0);
+        const bool translated = data.xTranslation() || data.yTranslation();
+        if (effects->activeFullScreenEffect() || scaled || translated || (mask & PAINT_WINDOW_TRANSFORMED)) {
+            return std::nullopt;
+        }
+    }
+
+    return matrix.value<QMatrix4x4>();
+}
+
 void BlurEffect::drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &region, WindowPaintData &data)
 {
+    bool contrastApplied = false;
     if (shouldBlur(w, mask, data)) {
         const QRect screen = viewport.renderRect().toRect();
         QRegion shape = blurRegion(w).translated(w->pos().toPoint());
@@ -663,12 +764,21 @@ void BlurEffect::drawWindow(const RenderTarget &renderTarget, const RenderViewpo
         shape &= region;
 
         if (!shape.isEmpty()) {
-            doBlur(renderTarget, viewport, shape, screen, data.opacity(), w->isDock() || transientForIsDock, w->frameGeometry().toRect());
+            contrastApplied = doBlur(renderTarget, viewport, w, shape, screen, data.opacity(), w->isDock() || transientForIsDock, w->frameGeometry().toRect(), backgroundContrastMatrix(w, mask, data));
         }
     }
 
+    if (contrastApplied) {
+        // Let the background contrast effect know that it doesn't need to sample the backdrop again
+        w->setData(WindowBackgroundContrastAppliedRole, true);
+    }
+
     // Draw the window over the blurred area
     effects->drawWindow(renderTarget, viewport, w, mask, region, data);
+
+    if (contrastApplied) {
+        w->setData(WindowBackgroundContrastAppliedRole, QVariant());
+    }
 }
 
 void BlurEffect::generateNoiseTexture()
@@ -698,19 +808,84 @@ void BlurEffect::generateNoiseTexture()
     m_noiseTexture->setWrapMode(GL_REPEAT);
 }
 
-void BlurEffect::doBlur(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRegion &shape, const QRect &screen, const float opacity, bool isDock, QRect windowRect)
+/**
+ * Returns the @a rect in the coordinates of the texture of the given downsample @a level.
+ */
+static QRect scaledRect(const QRect &rect, int level, const QSize &textureSize)
+{
+    const qreal scale = 1 << level;
+    return QRectF(rect.x() / scale, rect.y() / scale, rect.width() / scale, rect.height() / scale).toAlignedRect() & QRect(QPoint(0, 0), textureSize);
+}
+
+BlurEffect::BlurCache *BlurEffect::findBlurCache(EffectWindow *w, const QRect &screen, const QRect &sourceRect)
+{
+    if (!GLFramebuffer::blitSupported()) {
+        return nullptr;
+    }
+    // only cache what is painted on the screen itself, not e.g. into window thumbnails
+    const QRect screenGeometry = m_currentScreen ? m_currentScreen->geometry() : effects->virtualScreenGeometry();
+    if (screen != screenGeometry) {
+        return nullptr;
+    }
+
+    BlurCache &cache = m_blurCache[{w, m_currentScreen}];
+    const auto &sourceTexture = m_screenData[m_currentScreen].renderTargetTextures[1];
+    if (!cache.texture || cache.texture->size() != sourceRect.size() || cache.texture->internalFormat() != sourceTexture->internalFormat()) {
+        cache.texture = std::make_unique<GLTexture>(sourceTexture->internalFormat(), sourceRect.size());
+        cache.texture->setMemoryCategory(GLTextureMemory::Category::Effect);
+        cache.texture->setFilter(GL_LINEAR);
+        cache.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+        cache.framebuffer = std::make_unique<GLFramebuffer>(cache.texture.get());
+        cache.dirty = true;
+    }
+    if (!cache.framebuffer->valid()) {
+        m_blurCache.erase({w, m_currentScreen});
+        return nullptr;
+    }
+    if (!cache.cacheEntry) {
+        // the map nodes are stable, the entry dies with the cache
+        cache.cacheEntry = std::make_unique<GLTextureCacheEntry>([&cache]() {
+            cache.framebuffer.reset();
+            cache.texture.reset();
+            cache.dirty = true;
+            return true;
+        });
+    }
+    cache.cacheEntry->touch();
+    return &cache;
+}
+
+bool BlurEffect::doBlur(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, const QRegion &shape, const QRect &screen, const float opacity, bool isDock, QRect windowRect, const std::optional<QMatrix4x4> &colorMatrix)
 {
+    // the output switches between buffer formats depending on the color depth of its contents
+    if (const GLenum format = renderTarget.intermediateFormat(); m_screenData[m_currentScreen].intermediateFormat != format) {
+        updateTexture(m_currentScreen, format);
+    }
     const auto &outputData = m_screenData[m_currentScreen];
-    const QRegion expandedBlurRegion = expand(shape) & expand(screen);
+    const QRegion windowBlurRegion = expand(shape) & expand(screen);
+    QRegion expandedBlurRegion = windowBlurRegion;
 
     const bool useSRGB = outputData.renderTargetTextures.front()->internalFormat() == GL_SRGB8_ALPHA8;
 
+    // Windows in a blur group share the down and upsample passes, the first one to be painted
+    // blurs the area of the whole group
+    BlurGroup *group = nullptr;
+    bool blurredByGroup = false;
+    if (auto it = m_blurGroupOfWindow.constFind(w); it != m_blurGroupOfWindow.constEnd() && m_blurGroups[*it].windowCount > 1) {
+        group = &m_blurGroups[*it];
+        if (group->blurred && ((windowBlurRegion & screen) - group->region).isEmpty()) {
+            blurredByGroup = true;
+        } else if (!group->blurred) {
+            expandedBlurRegion = (windowBlurRegion | group->region) & expand(screen);
+        }
+    }
+
     // Upload geometry for the down and upsample iterations
     GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
     vbo->reset();
 
     if (!uploadGeometry(vbo, expandedBlurRegion, shape)) {
-        return;
+        return false;
     }
 
     const QRect logicalSourceRect = expandedBlurRegion.boundingRect() & screen;
@@ -720,43 +895,109 @@ void BlurEffect::doBlur(const RenderTarget &renderTarget, const RenderViewport &
     projection.ortho(viewport.renderRect().x(), viewport.renderRect().x() + viewport.renderRect().width(),
                      viewport.renderRect().y() + viewport.renderRect().height(), viewport.renderRect().y(), 0, 65535);
 
-    /*
-     * If the window is a dock or panel we avoid the "extended blur" effect.
-     * Extended blur is when windows that are not under the blurred area affect
-     * the final blur result.
-     * We want to avoid this on panels, because it looks really weird and ugly
-     * when maximized windows or windows near the panel affect the dock blur.
-     */
-    if (isDock) {
-        // This assumes the source frame buffer is in device coordinates, while
-        // our target framebuffer is in logical coordinates. It's a bit ugly but
-        // to fix it properly we probably need to do blits in normalized
-        // coordinates.
-        outputData.renderTargets.back()->blitFromRenderTarget(renderTarget, viewport, logicalSourceRect, logicalSourceRect.translated(-screen.topLeft()));
-        GLFramebuffer::pushFramebuffers(outputData.renderTargetStack);
+    // The blurred result ends up in the first downsampled texture, which is half the size of the screen
+    const auto &blurredTexture = outputData.renderTargetTextures[1];
+    const QRect localSourceRect = logicalSourceRect.translated(-screen.topLeft());
+    const QRect blurredRect = scaledRect((windowBlurRegion.boundingRect() & screen).translated(-screen.topLeft()), 1, blurredTexture->size());
 
+    BlurCache *cache = blurredRect.isEmpty() ? nullptr : findBlurCache(w, screen, blurredRect);
+    const auto storeBlurCache = [&]() {
+        if (!cache) {
+            return;
+        }
+        // Copy the texels as they are, the sRGB conversion only applies to the upscale
+        if (useSRGB) {
+            glDisable(GL_FRAMEBUFFER_SRGB);
+        }
+        GLFramebuffer::pushFramebuffer(outputData.renderTargets[1].get());
+        cache->framebuffer->blitFromFramebuffer(blurredRect, QRect(QPoint(0, 0), blurredRect.size()), GL_NEAREST);
+        GLFramebuffer::popFramebuffer();
+        if (useSRGB) {
+            glEnable(GL_FRAMEBUFFER_SRGB);
+        }
+        cache->sourceRect = blurredRect;
+        cache->shape = shape;
+        cache->isDock = isDock;
+        cache->dirty = false;
+    };
+
+    if (blurredByGroup) {
+        // The passes for an earlier window of the group covered this one as well
         if (useSRGB) {
             glEnable(GL_FRAMEBUFFER_SRGB);
         }
-
         vbo->bindArrays();
-        copyScreenSampleTexture(outputData, viewport, outputData.renderTargetStack.top()->size(), vbo, blurRectCount, shape.boundingRect().translated(-screen.topLeft()), projection);
-    } else {
-        RenderTarget offscreenRT(outputData.renderTargetStack.top());
-        outputData.renderTargetStack.top()->blitFromRenderTarget(renderTarget, viewport, logicalSourceRect, logicalSourceRect.translated(-screen.topLeft()));
-        GLFramebuffer::pushFramebuffers(outputData.renderTargetStack);
+        storeBlurCache();
+    } else if (cache && !cache->dirty && cache->isDock == isDock && cache->sourceRect == blurredRect && (shape - cache->shape).isEmpty()) {
+        // Nothing changed behind the window, restore the blurred texture and skip straight to the upscale
+        GLFramebuffer::pushFramebuffer(cache->framebuffer.get());
+        outputData.renderTargets[1]->blitFromFramebuffer(QRect(QPoint(0, 0), blurredRect.size()), blurredRect, GL_NEAREST);
+        GLFramebuffer::popFramebuffer();
 
         if (useSRGB) {
             glEnable(GL_FRAMEBUFFER_SRGB);
         }
+        vbo->bindArrays();
+    } else if (m_computeShader && outputData.renderTargetTextures.front()->internalFormat() == GL_RGBA8) {
+        // Same passes as below, but the down and upsample passes write straight into the textures,
+        // the compute shaders can only write to rgba8 images
+        if (isDock) {
+            outputData.renderTargets.back()->blitFromRenderTarget(renderTarget, viewport, logicalSourceRect, localSourceRect);
+            GLFramebuffer::pushFramebuffer(outputData.renderTargets.front().get());
+            vbo->bindArrays();
+            copyScreenSampleTexture(outputData, viewport, outputData.renderTargets.front()->size(), vbo, blurRectCount, shape.boundingRect().translated(-screen.topLeft()), projection);
+        } else {
+            outputData.renderTargets.front()->blitFromRenderTarget(renderTarget, viewport, logicalSourceRect, localSourceRect);
+        }
 
-        // Remove the m_renderTargets[0] from the top of the stack that we will not use
-        GLFramebuffer::popFramebuffer();
+        computeBlur(outputData, localSourceRect);
+        vbo->bindArrays();
+        storeBlurCache();
+    } else {
+        /*
+         * If the window is a dock or panel we avoid the "extended blur" effect.
+         * Extended blur is when windows that are not under the blurred area affect
+         * the final blur result.
+         * We want to avoid this on panels, because it looks really weird and ugly
+         * when maximized windows or windows near the panel affect the dock blur.
+         */
+        if (isDock) {
+            // This assumes the source frame buffer is in device coordinates, while
+            // our target framebuffer is in logical coordinates. It's a bit ugly but
+            // to fix it properly we probably need to do blits in normalized
+            // coordinates.
+            outputData.renderTargets.back()->blitFromRenderTarget(renderTarget, viewport, logicalSourceRect, logicalSourceRect.translated(-screen.topLeft()));
+            GLFramebuffer::pushFramebuffers(outputData.renderTargetStack);
+
+            if (useSRGB) {
+                glEnable(GL_FRAMEBUFFER_SRGB);
+            }
+
+            vbo->bindArrays();
+            copyScreenSampleTexture(outputData, viewport, outputData.renderTargetStack.top()->size(), vbo, blurRectCount, shape.boundingRect().translated(-screen.topLeft()), projection);
+        } else {
+            RenderTarget offscreenRT(outputData.renderTargetStack.top());
+            outputData.renderTargetStack.top()->blitFromRenderTarget(renderTarget, viewport, logicalSourceRect, logicalSourceRect.translated(-screen.topLeft()));
+            GLFramebuffer::pushFramebuffers(outputData.renderTargetStack);
+
+            if (useSRGB) {
+                glEnable(GL_FRAMEBUFFER_SRGB);
+            }
+
+            // Remove the m_renderTargets[0] from the top of the stack that we will not use
+            GLFramebuffer::popFramebuffer();
+        }
+
+        vbo->bindArrays();
+        downSampleTexture(outputData, vbo, blurRectCount, projection);
+        upSampleTexture(outputData, vbo, blurRectCount, projection);
+        storeBlurCache();
     }
 
-    vbo->bindArrays();
-    downSampleTexture(outputData, vbo, blurRectCount, projection);
-    upSampleTexture(outputData, vbo, blurRectCount, projection);
+    if (group && !blurredByGroup) {
+        // the shared textures now hold either the blur of the whole group or only of this window
+        group->blurred = (group->region - expandedBlurRegion).isEmpty();
+    }
 
     // Modulate the blurred texture with the window opacity if the window isn't opaque
     if (opacity < 1.0) {
@@ -772,7 +1013,11 @@ void BlurEffect::doBlur(const RenderTarget &renderTarget, const RenderViewport &
         glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
     }
 
-    upscaleRenderToScreen(outputData, renderTarget, viewport, vbo, blurRectCount, shape.rectCount() * 6, windowRect.topLeft());
+    // The background contrast is only folded into the upsample if the result is the same as
+    // applying it to the blurred backdrop afterwards, i.e. there's no blending, no sRGB encoding
+    // and no noise, which the contrast would otherwise be applied to as well
+    const bool applyColorMatrix = colorMatrix && opacity >= 1.0 && !useSRGB && m_noiseStrength == 0;
+    upscaleRenderToScreen(outputData, renderTarget, viewport, vbo, blurRectCount, shape.rectCount() * 6, windowRect.topLeft(), applyColorMatrix ? *colorMatrix : QMatrix4x4());
 
     if (useSRGB) {
         glDisable(GL_FRAMEBUFFER_SRGB);
@@ -804,9 +1049,10 @@ void BlurEffect::doBlur(const RenderTarget &renderTarget, const RenderViewport &
     }
 
     vbo->unbindArrays();
+    return applyColorMatrix;
 }
 
-void BlurEffect::upscaleRenderToScreen(const ScreenData &data, const RenderTarget &renderTarget, const RenderViewport &viewport, GLVertexBuffer *vbo, int vboStart, int blurRectCount, QPoint windowPosition)
+void BlurEffect::upscaleRenderToScreen(const ScreenData &data, const RenderTarget &renderTarget, const RenderViewport &viewport, GLVertexBuffer *vbo, int vboStart, int blurRectCount, QPoint windowPosition, const QMatrix4x4 &colorMatrix)
 {
     const auto &tex = data.renderTargetTextures[1];
     tex->bind();
@@ -819,6 +1065,7 @@ void BlurEffect::upscaleRenderToScreen(const ScreenData &data, const RenderTarge
     fragCoordToUv.scale(1.0 / renderTarget.size().width(), 1.0 / renderTarget.size().height());
     m_shader->setFragCoordToUv(fragCoordToUv);
     m_shader->setTargetTextureSize(tex->size() * viewport.scale());
+    m_shader->setColorMatrix(colorMatrix);
 
     m_shader->setOffset(m_offset);
     QMatrix4x4 projection = viewport.projectionMatrix();
@@ -878,6 +1125,7 @@ void BlurEffect::upSampleTexture(const ScreenData &data, GLVertexBuffer *vbo, in
     m_shader->bind(BlurShader::UpSampleType);
     m_shader->setOffset(m_offset);
     m_shader->setModelViewProjectionMatrix(projection);
+    m_shader->setColorMatrix(QMatrix4x4());
 
     for (int i = m_downSampleIterations - 1; i >= 1; i--) {
         const auto &tex = data.renderTargetTextures[i];
@@ -897,6 +1145,25 @@ void BlurEffect::upSampleTexture(const ScreenData &data, GLVertexBuffer *vbo, in
     m_shader->unbind();
 }
 
+void BlurEffect::computeBlur(const ScreenData &data, const QRect &sourceRect)
+{
+    for (int i = 1; i <= m_downSampleIterations; i++) {
+        const QRect rect = scaledRect(sourceRect, i, data.renderTargetTextures[i]->size());
+        if (!rect.isEmpty()) {
+            m_computeShader->dispatch(BlurComputeShader::DownSamplePass, data.renderTargetTextures[i - 1].get(), data.renderTargetTextures[i].get(), rect, m_offset);
+        }
+    }
+
+    for (int i = m_downSampleIterations - 1; i >= 1; i--) {
+        const QRect rect = scaledRect(sourceRect, i, data.renderTargetTextures[i]->size());
+        if (!rect.isEmpty()) {
+            m_computeShader->dispatch(BlurComputeShader::UpSamplePass, data.renderTargetTextures[i + 1].get(), data.renderTargetTextures[i].get(), rect, m_offset);
+        }
+    }
+
+    m_computeShader->finish();
+}
+
 void BlurEffect::copyScreenSampleTexture(const ScreenData &data, const RenderViewport &viewport, const QSize &fboSize, GLVertexBuffer *vbo, int blurRectCount, const QRect &boundingRect, const QMatrix4x4 &projection)
 {
     m_shader->bind(BlurShader::CopySampleType);
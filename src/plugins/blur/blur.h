@@ -15,6 +15,8 @@
 #include <QVector2D>
 #include <QVector>
 
+#include <optional>
+
 namespace KWaylandServer
 {
 class BlurManagerInterface;
@@ -25,6 +27,7 @@ namespace KWin
 
 static const int borderSize = 5;
 
+class BlurComputeShader;
 class BlurShader;
 
 class BlurEffect : public KWin::Effect
@@ -72,18 +75,52 @@ private:
         std::vector<std::unique_ptr<GLTexture>> renderTargetTextures;
         std::vector<std::unique_ptr<GLFramebuffer>> renderTargets;
         QStack<GLFramebuffer *> renderTargetStack;
+        // the intermediate format of the render target the textures have been made for
+        GLenum intermediateFormat = GL_RGBA8;
+    };
+
+    /**
+     * The blurred background of a window, as it was left in the first downsampled texture
+     * before the final upsample to the screen. It can be reused for as long as nothing was
+     * painted behind the window.
+     */
+    struct BlurCache
+    {
+        std::unique_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+        std::unique_ptr<GLTextureCacheEntry> cacheEntry;
+        QRect sourceRect; // in the coordinates of the first downsampled texture
+        QRegion shape;
+        bool isDock = false;
+        bool dirty = true;
+    };
+
+    /**
+     * Consecutive blurred windows, in stacking order, where nothing painted between the first
+     * and a later window touches the area behind the later one. Their backgrounds can be
+     * blurred in one go when the first of them is painted.
+     */
+    struct BlurGroup
+    {
+        QRegion region;
+        int windowCount = 0;
+        // whether the shared textures currently hold the blur of the whole region
+        bool blurred = false;
     };
 
     QRect expand(const QRect &rect) const;
     QRegion expand(const QRegion &region) const;
     void initBlurStrengthValues();
-    void updateTexture(EffectScreen *screen);
+    void updateTexture(EffectScreen *screen, GLenum intermediateFormat = GL_RGBA8);
     QRegion blurRegion(const EffectWindow *w) const;
     QRegion decorationBlurRegion(const EffectWindow *w) const;
     bool decorationSupportsBlurBehind(const EffectWindow *w) const;
     bool shouldBlur(const EffectWindow *w, int mask, const WindowPaintData &data) const;
+    std::optional<QMatrix4x4> backgroundContrastMatrix(const EffectWindow *w, int mask, const WindowPaintData &data) const;
     void updateBlurRegion(EffectWindow *w);
-    void doBlur(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRegion &shape, const QRect &screen, const float opacity, bool isDock, QRect windowRect);
+    bool doBlur(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, const QRegion &shape, const QRect &screen, const float opacity, bool isDock, QRect windowRect, const std::optional<QMatrix4x4> &colorMatrix);
+    BlurCache *findBlurCache(EffectWindow *w, const QRect &screen, const QRect &sourceRect);
+    void invalidateBlurCache(EffectScreen *screen);
     void uploadRegion(QVector2D *&map, const QRegion &region);
     Q_REQUIRED_RESULT bool uploadGeometry(GLVertexBuffer *vbo, const QRegion &expandedBlurRegion, const QRegion &blurRegion);
     void generateNoiseTexture();
@@ -91,14 +128,16 @@ private:
     void screenRemoved(EffectScreen *screen);
     void screenGeometryChanged(EffectScreen *screen);
 
-    void upscaleRenderToScreen(const ScreenData &data, const RenderTarget &renderTarget, const RenderViewport &viewport, GLVertexBuffer *vbo, int vboStart, int blurRectCount, QPoint windowPosition);
+    void upscaleRenderToScreen(const ScreenData &data, const RenderTarget &renderTarget, const RenderViewport &viewport, GLVertexBuffer *vbo, int vboStart, int blurRectCount, QPoint windowPosition, const QMatrix4x4 &colorMatrix);
     void applyNoise(const ScreenData &data, const RenderTarget &renderTarget, const RenderViewport &viewport, GLVertexBuffer *vbo, int vboStart, int blurRectCount, QPoint windowPosition);
     void downSampleTexture(const ScreenData &data, GLVertexBuffer *vbo, int blurRectCount, const QMatrix4x4 &projection);
     void upSampleTexture(const ScreenData &data, GLVertexBuffer *vbo, int blurRectCount, const QMatrix4x4 &projection);
+    void computeBlur(const ScreenData &data, const QRect &sourceRect);
     void copyScreenSampleTexture(const ScreenData &data, const RenderViewport &viewport, const QSize &fboSize, GLVertexBuffer *vbo, int blurRectCount, const QRect &boundingRect, const QMatrix4x4 &projection);
 
 private:
     BlurShader *m_shader;
+    std::unique_ptr<BlurComputeShader> m_computeShader;
     std::map<EffectScreen *, ScreenData> m_screenData;
 
     std::unique_ptr<GLTexture> m_noiseTexture;
@@ -133,6 +172,11 @@ private:
 
     QMap<EffectWindow *, QMetaObject::Connection> windowBlurChangedConnections;
     QMap<const EffectWindow *, QRegion> blurRegions;
+    std::map<std::pair<const EffectWindow *, EffectScreen *>, BlurCache> m_blurCache;
+    QVector<BlurGroup> m_blurGroups;
+    QHash<const EffectWindow *, int> m_blurGroupOfWindow;
+    QRegion m_blurGroupPaintedArea; // painted since the first window of the last group
+    bool m_blurGroupOpen = false;
 
     static KWaylandServer::BlurManagerInterface *s_blurManager;
     static QTimer *s_blurManagerRemoveTimer;
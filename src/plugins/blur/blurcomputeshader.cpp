@@ -0,0 +1,143 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "blurcomputeshader.h"
+
+#include "libkwineffects/kwinglplatform.h"
+
+#include <QFile>
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(KWIN_BLUR, "kwin_effect_blur", QtWarningMsg)
+
+namespace KWin
+{
+
+static const int s_workGroupSize = 8;
+
+BlurComputeShader::BlurComputeShader()
+{
+    if (!supported()) {
+        return;
+    }
+
+    m_downSample = loadProgram(QStringLiteral(":/effects/blur/shaders/downsample.comp"));
+    m_upSample = loadProgram(QStringLiteral(":/effects/blur/shaders/upsample.comp"));
+    m_valid = m_downSample.program && m_upSample.program;
+}
+
+BlurComputeShader::~BlurComputeShader()
+{
+    if (m_downSample.program) {
+        glDeleteProgram(m_downSample.program);
+    }
+    if (m_upSample.program) {
+        glDeleteProgram(m_upSample.program);
+    }
+}
+
+bool BlurComputeShader::supported()
+{
+    if (qEnvironmentVariableIntValue("KWIN_BLUR_NO_COMPUTE")) {
+        return false;
+    }
+    if (GLPlatform::instance()->isGLES()) {
+        return hasGLVersion(3, 1);
+    }
+    return hasGLVersion(4, 3);
+}
+
+BlurComputeShader::Program BlurComputeShader::loadProgram(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(KWIN_BLUR) << "Failed to read" << fileName;
+        return Program{};
+    }
+
+    QByteArray source = GLPlatform::instance()->isGLES()
+        ? QByteArrayLiteral("#version 310 es\nprecision highp float;\n")
+        : QByteArrayLiteral("#version 430\n");
+    source += file.readAll();
+
+    const GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    const char *sourceData = source.constData();
+    glShaderSource(shader, 1, &sourceData, nullptr);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint logLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        QByteArray log(logLength, 0);
+        glGetShaderInfoLog(shader, logLength, nullptr, log.data());
+        qCWarning(KWIN_BLUR) << "Failed to compile" << fileName << log;
+        glDeleteShader(shader);
+        return Program{};
+    }
+
+    Program program;
+    program.program = glCreateProgram();
+    glAttachShader(program.program, shader);
+    glLinkProgram(program.program);
+    glDeleteShader(shader);
+
+    glGetProgramiv(program.program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint logLength = 0;
+        glGetProgramiv(program.program, GL_INFO_LOG_LENGTH, &logLength);
+        QByteArray log(logLength, 0);
+        glGetProgramInfoLog(program.program, logLength, nullptr, log.data());
+        qCWarning(KWIN_BLUR) << "Failed to link" << fileName << log;
+        glDeleteProgram(program.program);
+        return Program{};
+    }
+
+    program.offsetLocation = glGetUniformLocation(program.program, "offset");
+    program.halfpixelLocation = glGetUniformLocation(program.program, "halfpixel");
+    program.renderTextureSizeLocation = glGetUniformLocation(program.program, "renderTextureSize");
+    program.targetRectLocation = glGetUniformLocation(program.program, "targetRect");
+    return program;
+}
+
+void BlurComputeShader::dispatch(PassType type, GLTexture *source, GLTexture *target, const QRect &rect, float offset)
+{
+    const Program &program = type == DownSamplePass ? m_downSample : m_upSample;
+    const QSize targetSize = target->size();
+
+    // textures have their origin in the bottom left corner
+    const QRect texelRect(rect.x(), targetSize.height() - (rect.y() + rect.height()), rect.width(), rect.height());
+
+    glUseProgram(program.program);
+    glUniform1f(program.offsetLocation, offset);
+    glUniform2f(program.halfpixelLocation, 0.5 / targetSize.width(), 0.5 / targetSize.height());
+    glUniform2f(program.renderTextureSizeLocation, targetSize.width(), targetSize.height());
+    glUniform4i(program.targetRectLocation, texelRect.x(), texelRect.y(), texelRect.width(), texelRect.height());
+
+    glActiveTexture(GL_TEXTURE0);
+    source->bind();
+    glBindImageTexture(0, target->texture(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+    glDispatchCompute((texelRect.width() + s_workGroupSize - 1) / s_workGroupSize,
+                      (texelRect.height() + s_workGroupSize - 1) / s_workGroupSize,
+                      1);
+
+    // the next pass samples what this one wrote
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void BlurComputeShader::finish()
+{
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    glUseProgram(0);
+
+    // restore whatever the shader manager thinks is bound
+    if (GLShader *shader = ShaderManager::instance()->getBoundShader()) {
+        shader->bind();
+    }
+}
+
+} // namespace KWin
@@ -0,0 +1,72 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "libkwineffects/kwinglutils.h"
+
+#include <QRect>
+
+namespace KWin
+{
+
+/**
+ * The BlurComputeShader class runs the dual kawase down- and upsample passes as compute
+ * dispatches, which write straight into the textures without binding framebuffers or
+ * uploading geometry for every pass.
+ *
+ * It requires OpenGL 4.3 or OpenGL ES 3.1 and only works with RGBA8 textures, because
+ * sRGB formats can't be used with image load/store.
+ */
+class BlurComputeShader
+{
+public:
+    BlurComputeShader();
+    ~BlurComputeShader();
+
+    static bool supported();
+    bool isValid() const;
+
+    enum PassType {
+        DownSamplePass,
+        UpSamplePass,
+    };
+
+    /**
+     * Samples @a source and writes the @a rect of @a target, in texel coordinates with the
+     * origin in the top left corner.
+     */
+    void dispatch(PassType type, GLTexture *source, GLTexture *target, const QRect &rect, float offset);
+
+    /**
+     * Makes the results of the previous dispatches visible to texture fetches and framebuffer
+     * operations such as blits.
+     */
+    void finish();
+
+private:
+    struct Program
+    {
+        GLuint program = 0;
+        int offsetLocation = -1;
+        int halfpixelLocation = -1;
+        int renderTextureSizeLocation = -1;
+        int targetRectLocation = -1;
+    };
+
+    static Program loadProgram(const QString &fileName);
+
+    Program m_downSample;
+    Program m_upSample;
+    bool m_valid = false;
+
+    Q_DISABLE_COPY(BlurComputeShader)
+};
+
+inline bool BlurComputeShader::isValid() const
+{
+    return m_valid;
+}
+
+} // namespace KWin
@@ -55,6 +55,7 @@ BlurShader::BlurShader(QObject *parent)
         m_offsetLocationUpsample = m_shaderUpsample->uniformLocation("offset");
         m_fragCoordToUvLocationUpsample = m_shaderUpsample->uniformLocation("fragCoordToUv");
         m_halfpixelLocationUpsample = m_shaderUpsample->uniformLocation("halfpixel");
+        m_colorMatrixLocationUpsample = m_shaderUpsample->uniformLocation("colorMatrix");
 
         m_mvpMatrixLocationCopysample = m_shaderCopysample->uniformLocation("modelViewProjectionMatrix");
         m_renderTextureSizeLocationCopysample = m_shaderCopysample->uniformLocation("renderTextureSize");
@@ -84,6 +85,7 @@ BlurShader::BlurShader(QObject *parent)
         m_shaderUpsample->setUniform(m_offsetLocationUpsample, float(1.0));
         m_shaderUpsample->setUniform(m_fragCoordToUvLocationUpsample, QMatrix4x4());
         m_shaderUpsample->setUniform(m_halfpixelLocationUpsample, QVector2D(1.0, 1.0));
+        m_shaderUpsample->setUniform(m_colorMatrixLocationUpsample, QMatrix4x4());
         ShaderManager::instance()->popShader();
 
         ShaderManager::instance()->pushShader(m_shaderCopysample.get());
@@ -239,6 +241,20 @@ void BlurShader::setFragCoordToUv(const QMatrix4x4 &fragCoordToUv)
     m_shaderUpsample->setUniform(m_fragCoordToUvLocationUpsample, fragCoordToUv);
 }
 
+void BlurShader::setColorMatrix(const QMatrix4x4 &colorMatrix)
+{
+    if (!isValid()) {
+        return;
+    }
+    Q_ASSERT(m_activeSampleType == UpSampleType);
+    if (colorMatrix == m_colorMatrixUpsample) {
+        return;
+    }
+
+    m_colorMatrixUpsample = colorMatrix;
+    m_shaderUpsample->setUniform(m_colorMatrixLocationUpsample, colorMatrix);
+}
+
 void BlurShader::setNoiseTextureSize(const QSize &noiseTextureSize)
 {
     const QVector2D noiseTexSize(noiseTextureSize.width(), noiseTextureSize.height());
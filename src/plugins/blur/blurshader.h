@@ -41,6 +41,7 @@ public:
     void setOffset(float offset);
     void setTargetTextureSize(const QSize &renderTextureSize);
     void setFragCoordToUv(const QMatrix4x4 &fragCoordToUv);
+    void setColorMatrix(const QMatrix4x4 &colorMatrix);
     void setNoiseTextureSize(const QSize &noiseTextureSize);
     void setTexturePosition(const QPoint &texPos);
     void setBlurRect(const QRect &blurRect, const QSizeF &screenSize);
@@ -60,6 +61,7 @@ private:
     int m_offsetLocationUpsample;
     int m_fragCoordToUvLocationUpsample;
     int m_halfpixelLocationUpsample;
+    int m_colorMatrixLocationUpsample;
 
     int m_mvpMatrixLocationCopysample;
     int m_renderTextureSizeLocationCopysample;
@@ -80,6 +82,7 @@ private:
 
     float m_offsetUpsample = 0.0;
     QMatrix4x4 m_matrixUpsample;
+    QMatrix4x4 m_colorMatrixUpsample;
 
     QMatrix4x4 m_matrixCopysample;
 
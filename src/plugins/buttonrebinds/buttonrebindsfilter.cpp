@@ -196,6 +196,12 @@ void ButtonRebindsFilter::loadConfig(const KConfigGroup &group)
     }
 }
 
+bool ButtonRebindsFilter::handlesLockedPointerMotion() const
+{
+    // only the buttons are rebound
+    return false;
+}
+
 bool ButtonRebindsFilter::pointerEvent(KWin::MouseEvent *event, quint32 nativeButton)
 {
     if (event->type() != QEvent::MouseButtonPress && event->type() != QEvent::MouseButtonRelease) {
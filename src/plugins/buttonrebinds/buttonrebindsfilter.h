@@ -72,6 +72,7 @@ public:
 
     explicit ButtonRebindsFilter();
     bool pointerEvent(KWin::MouseEvent *event, quint32 nativeButton) override;
+    bool handlesLockedPointerMotion() const override;
     bool tabletPadButtonEvent(uint button, bool pressed, const KWin::TabletPadId &tabletPadId, std::chrono::microseconds time) override;
     bool tabletToolButtonEvent(uint button, bool pressed, const KWin::TabletToolId &tabletToolId, std::chrono::microseconds time) override;
 
@@ -108,15 +108,32 @@ void GlideEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::millisec
         ++animationIt;
     }
 
-    data.mask |= PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS;
-
+    // The animated windows are repainted with their bounds, the screen can be painted with
+    // the damaged region only.
     effects->prePaintScreen(data, presentTime);
 }
 
 void GlideEffect::prePaintWindow(EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime)
 {
-    if (m_animations.contains(w)) {
+    auto animationIt = m_animations.find(w);
+    if (animationIt != m_animations.end()) {
         data.setTransformed();
+
+        // The transformation depends on the viewport, so the window can look different on every
+        // screen it's painted on. Predict the bounds on each screen and unite them.
+        QRectF bounds;
+        const auto screens = effects->screens();
+        for (const EffectScreen *screen : screens) {
+            const QRectF screenGeometry = screen->geometry();
+            const qreal scale = screen->devicePixelRatio();
+            QMatrix4x4 projection;
+            projection.ortho(scaledRect(screenGeometry, scale));
+
+            WindowPaintData paintData(projection);
+            transformWindow(w, *animationIt, screenGeometry, scale, QMatrix4x4(), paintData);
+            bounds |= AnimationDamage::transformedBounds(w, paintData, projection, scale).intersected(screenGeometry);
+        }
+        (*animationIt).damage.paint(data, bounds);
     }
 
     effects->prePaintWindow(w, data, presentTime);
@@ -130,6 +147,14 @@ void GlideEffect::paintWindow(const RenderTarget &renderTarget, const RenderView
         return;
     }
 
+    transformWindow(w, *animationIt, viewport.renderRect(), viewport.scale(), renderTarget.transformation(), data);
+
+    effects->paintWindow(renderTarget, viewport, w, mask, region, data);
+}
+
+void GlideEffect::transformWindow(EffectWindow *w, const GlideAnimation &animation, const QRectF &renderRect, qreal scale,
+                                  const QMatrix4x4 &renderTargetTransformation, WindowPaintData &data) const
+{
     // Perspective projection distorts objects near edges
     // of the viewport. This is critical because distortions
     // near edges of the viewport are not desired with this effect.
@@ -140,9 +165,9 @@ void GlideEffect::paintWindow(const RenderTarget &renderTarget, const RenderView
     //  [move to the origin] -> [rotate] -> [translate] ->
     //    -> [perspective projection] -> [reverse "move to the origin"]
 
-    const QMatrix4x4 oldProjMatrix = createPerspectiveMatrix(viewport.renderRect(), viewport.scale(), renderTarget.transformation());
+    const QMatrix4x4 oldProjMatrix = createPerspectiveMatrix(renderRect, scale, renderTargetTransformation);
     const auto frame = w->frameGeometry();
-    const QRectF windowGeo = scaledRect(frame, viewport.scale());
+    const QRectF windowGeo = scaledRect(frame, scale);
     const QVector3D invOffset = oldProjMatrix.map(QVector3D(windowGeo.center()));
     QMatrix4x4 invOffsetMatrix;
     invOffsetMatrix.translate(invOffset.x(), invOffset.y());
@@ -150,11 +175,11 @@ void GlideEffect::paintWindow(const RenderTarget &renderTarget, const RenderView
     data.setProjectionMatrix(invOffsetMatrix * oldProjMatrix);
 
     // Move the center of the window to the origin.
-    const QPointF offset = viewport.renderRect().center() - w->frameGeometry().center();
+    const QPointF offset = renderRect.center() - w->frameGeometry().center();
     data.translate(offset.x(), offset.y());
 
     const GlideParams params = w->isDeleted() ? m_outParams : m_inParams;
-    const qreal t = (*animationIt).timeLine.value();
+    const qreal t = animation.timeLine.value();
 
     switch (params.edge) {
     case RotationEdge::Top:
@@ -191,14 +216,13 @@ void GlideEffect::paintWindow(const RenderTarget &renderTarget, const RenderView
 
     data.setZTranslation(-interpolate(params.distance.from, params.distance.to, t));
     data.multiplyOpacity(interpolate(params.opacity.from, params.opacity.to, t));
-
-    effects->paintWindow(renderTarget, viewport, w, mask, region, data);
 }
 
 void GlideEffect::postPaintScreen()
 {
     auto animationIt = m_animations.begin();
     while (animationIt != m_animations.end()) {
+        (*animationIt).damage.repaint();
         if ((*animationIt).timeLine.done()) {
             animationIt = m_animations.erase(animationIt);
         } else {
@@ -206,7 +230,6 @@ void GlideEffect::postPaintScreen()
         }
     }
 
-    effects->addRepaintFull();
     effects->postPaintScreen();
 }
 
@@ -248,7 +271,7 @@ void GlideEffect::windowAdded(EffectWindow *w)
     animation.timeLine.setDuration(m_duration);
     animation.timeLine.setEasingCurve(QEasingCurve::InCurve);
 
-    effects->addRepaintFull();
+    w->addRepaintFull();
 }
 
 void GlideEffect::windowClosed(EffectWindow *w)
@@ -280,7 +303,7 @@ void GlideEffect::windowClosed(EffectWindow *w)
     animation.timeLine.setDuration(m_duration);
     animation.timeLine.setEasingCurve(QEasingCurve::OutCurve);
 
-    effects->addRepaintFull();
+    w->addRepaintFull();
 }
 
 void GlideEffect::windowDataChanged(EffectWindow *w, int role)
@@ -295,6 +318,7 @@ void GlideEffect::windowDataChanged(EffectWindow *w, int role)
 
     auto animationIt = m_animations.find(w);
     if (animationIt != m_animations.end()) {
+        (*animationIt).damage.repaint();
         m_animations.erase(animationIt);
     }
 }
@@ -23,6 +23,7 @@ struct GlideAnimation
     EffectWindowDeletedRef deletedRef;
     EffectWindowVisibleRef visibleRef;
     TimeLine timeLine;
+    AnimationDamage damage;
 };
 
 class GlideEffect : public Effect
@@ -79,6 +80,8 @@ private Q_SLOTS:
 
 private:
     bool isGlideWindow(EffectWindow *w) const;
+    void transformWindow(EffectWindow *w, const GlideAnimation &animation, const QRectF &renderRect, qreal scale,
+                         const QMatrix4x4 &renderTargetTransformation, WindowPaintData &data) const;
 
     std::chrono::milliseconds m_duration;
     QHash<EffectWindow *, GlideAnimation> m_animations;
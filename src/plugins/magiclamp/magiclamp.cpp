@@ -25,6 +25,8 @@ MagicLampEffect::MagicLampEffect()
     connect(effects, &EffectsHandler::windowUnminimized, this, &MagicLampEffect::slotWindowUnminimized);
 
     setVertexSnappingMode(RenderGeometry::VertexSnappingMode::None);
+    // the animation is short, the contents of the window needn't be updated meanwhile
+    setLive(false);
 }
 
 bool MagicLampEffect::supported()
@@ -52,10 +54,6 @@ void MagicLampEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::mill
         ++animationIt;
     }
 
-    // We need to mark the screen windows as transformed. Otherwise the
-    // whole screen won't be repainted, resulting in artefacts.
-    data.mask |= PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS;
-
     effects->prePaintScreen(data, presentTime);
 }
 
@@ -63,9 +61,16 @@ void MagicLampEffect::prePaintWindow(EffectWindow *w, WindowPrePaintData &data,
 {
     // Schedule window for transformation if the animation is still in
     //  progress
-    if (m_animations.contains(w)) {
+    auto animationIt = m_animations.find(w);
+    if (animationIt != m_animations.end()) {
         // We'll transform this window
         data.setTransformed();
+
+        // The window is squeezed towards the icon, or the cursor if there's no icon geometry,
+        // it never leaves the area between them.
+        const QRectF icon = w->iconGeometry();
+        const QRectF target = icon.isValid() ? icon : QRectF(cursorPos(), QSizeF(1, 1));
+        (*animationIt).damage.paint(data, w->expandedGeometry() | target);
     }
 
     effects->prePaintWindow(w, data, presentTime);
@@ -304,6 +309,7 @@ void MagicLampEffect::postPaintScreen()
 {
     auto animationIt = m_animations.begin();
     while (animationIt != m_animations.end()) {
+        (*animationIt).damage.repaint();
         if ((*animationIt).timeLine.done()) {
             unredirect(animationIt.key());
             animationIt = m_animations.erase(animationIt);
@@ -312,15 +318,17 @@ void MagicLampEffect::postPaintScreen()
         }
     }
 
-    effects->addRepaintFull();
-
     // Call the next effect.
     effects->postPaintScreen();
 }
 
 void MagicLampEffect::slotWindowDeleted(EffectWindow *w)
 {
-    m_animations.remove(w);
+    auto animationIt = m_animations.find(w);
+    if (animationIt != m_animations.end()) {
+        (*animationIt).damage.repaint();
+        m_animations.erase(animationIt);
+    }
 }
 
 void MagicLampEffect::slotWindowMinimized(EffectWindow *w)
@@ -341,7 +349,7 @@ void MagicLampEffect::slotWindowMinimized(EffectWindow *w)
     }
 
     redirect(w);
-    effects->addRepaintFull();
+    w->addRepaintFull();
 }
 
 void MagicLampEffect::slotWindowUnminimized(EffectWindow *w)
@@ -362,7 +370,7 @@ void MagicLampEffect::slotWindowUnminimized(EffectWindow *w)
     }
 
     redirect(w);
-    effects->addRepaintFull();
+    w->addRepaintFull();
 }
 
 bool MagicLampEffect::isActive() const
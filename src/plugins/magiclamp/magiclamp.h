@@ -18,6 +18,7 @@ struct MagicLampAnimation
 {
     EffectWindowVisibleRef visibleRef;
     TimeLine timeLine;
+    AnimationDamage damage;
 };
 
 class MagicLampEffect : public OffscreenEffect
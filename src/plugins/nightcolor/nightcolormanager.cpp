@@ -325,6 +325,7 @@ void NightColorManager::resetQuickAdjustTimer(int targetTemp)
             interval = 1;
         }
         m_quickAdjustTimer->start(interval);
+        prepareGammaRamps(targetTemp);
     } else {
         resetSlowUpdateStartTimer();
     }
@@ -420,6 +421,7 @@ void NightColorManager::resetSlowUpdateTimer()
             interval = 1;
         }
         m_slowUpdateTimer->start(interval);
+        prepareGammaRamps(targetTemp);
     }
 }
 
@@ -648,6 +650,26 @@ void NightColorManager::commitGammaRamps(int temperature)
     setCurrentTemperature(temperature);
 }
 
+void NightColorManager::prepareGammaRamps(int targetTemp)
+{
+    // The temperatures of a transition are known in advance, so their gamma ramps can be
+    // built before the timer gets to them
+    QVector<uint> temperatures;
+    for (int temperature = m_currentTemp; temperature != targetTemp;) {
+        if (temperature < targetTemp) {
+            temperature = std::min(temperature + TEMPERATURE_STEP, targetTemp);
+        } else {
+            temperature = std::max(temperature - TEMPERATURE_STEP, targetTemp);
+        }
+        temperatures.append(temperature);
+    }
+
+    const QVector<ColorDevice *> devices = kwinApp()->colorManager()->devices();
+    for (ColorDevice *device : devices) {
+        device->prepareTemperatures(temperatures);
+    }
+}
+
 void NightColorManager::autoLocationUpdate(double latitude, double longitude)
 {
     qCDebug(KWIN_NIGHTCOLOR, "Received new location (lat: %f, lng: %f)", latitude, longitude);
@@ -251,6 +251,7 @@ private:
     bool daylight() const;
 
     void commitGammaRamps(int temperature);
+    void prepareGammaRamps(int targetTemp);
 
     void setEnabled(bool enabled);
     void setRunning(bool running);
@@ -10,7 +10,12 @@
 
 #include "expolayout.h"
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
+
+// enough to go back and forth between a few filters without laying the windows out again
+static const std::size_t s_maxCachedLayouts = 8;
 
 ExpoCell::ExpoCell(QObject *parent)
     : QObject(parent)
@@ -284,20 +289,52 @@ void ExpoLayout::forceLayout()
 
 void ExpoLayout::updatePolish()
 {
-    if (!m_cells.isEmpty()) {
-        switch (m_mode) {
-        case LayoutClosest:
-            calculateWindowTransformationsClosest();
-            break;
-        case LayoutNatural:
-            calculateWindowTransformationsNatural();
-            break;
-        case LayoutNone:
-            resetTransformations();
-            break;
+    if (m_cells.isEmpty()) {
+        setReady();
+        return;
+    }
+    if (m_mode == LayoutNone) {
+        resetTransformations();
+        setReady();
+        return;
+    }
+
+    if (m_mode == LayoutNatural) {
+        // As we are using pseudo-random movement (See "slot") we need to make sure the list
+        // is always sorted the same way no matter which window is currently active.
+        std::sort(m_cells.begin(), m_cells.end(), [](const ExpoCell *a, const ExpoCell *b) {
+            return a->persistentKey() < b->persistentKey();
+        });
+    }
+
+    LayoutKey key = layoutKey();
+    auto cached = std::find_if(m_layoutCache.begin(), m_layoutCache.end(), [&key](const CachedLayout &layout) {
+        return layout.key == key;
+    });
+    if (cached != m_layoutCache.end()) {
+        CachedLayout layout = std::move(*cached);
+        m_layoutCache.erase(cached);
+        m_layoutCache.push_front(std::move(layout));
+    } else {
+        std::vector<QRect> geometries = m_mode == LayoutNatural ? calculateWindowTransformationsNatural() : calculateWindowTransformationsClosest();
+        m_layoutCache.push_front(CachedLayout{
+            .key = std::move(key),
+            .geometries = std::move(geometries),
+        });
+        if (m_layoutCache.size() > s_maxCachedLayouts) {
+            m_layoutCache.pop_back();
         }
     }
 
+    const std::vector<QRect> &geometries = m_layoutCache.front().geometries;
+    for (int i = 0; i < m_cells.count(); ++i) {
+        ExpoCell *cell = m_cells[i];
+        cell->setX(geometries[i].x());
+        cell->setY(geometries[i].y());
+        cell->setWidth(geometries[i].width());
+        cell->setHeight(geometries[i].height());
+    }
+
     setReady();
 }
 
@@ -322,6 +359,26 @@ void ExpoLayout::geometryChange(const QRectF &newGeometry, const QRectF &oldGeom
     QQuickItem::geometryChange(newGeometry, oldGeometry);
 }
 
+ExpoLayout::LayoutKey ExpoLayout::layoutKey() const
+{
+    LayoutKey key{
+        .mode = m_mode,
+        .fillGaps = m_fillGaps,
+        .spacing = m_spacing,
+        .size = QSize(width(), height()),
+        .cells = {},
+    };
+    key.cells.reserve(m_cells.count());
+    for (const ExpoCell *cell : m_cells) {
+        key.cells.push_back(LayoutKey::Cell{
+            .persistentKey = cell->persistentKey(),
+            .naturalRect = cell->naturalRect(),
+            .margins = cell->margins(),
+        });
+    }
+    return key;
+}
+
 static int distance(const QPoint &a, const QPoint &b)
 {
     const int xdiff = a.x() - b.x();
@@ -329,7 +386,7 @@ static int distance(const QPoint &a, const QPoint &b)
     return int(std::sqrt(qreal(xdiff * xdiff + ydiff * ydiff)));
 }
 
-static QRect centered(ExpoCell *cell, const QRect &bounds)
+static QRect centered(const ExpoCell *cell, const QRect &bounds)
 {
     const QSize scaled = QSize(cell->naturalWidth(), cell->naturalHeight())
                              .scaled(bounds.size(), Qt::KeepAspectRatio);
@@ -340,7 +397,7 @@ static QRect centered(ExpoCell *cell, const QRect &bounds)
                  scaled.height());
 }
 
-void ExpoLayout::calculateWindowTransformationsClosest()
+std::vector<QRect> ExpoLayout::calculateWindowTransformationsClosest() const
 {
     QRect area = QRect(0, 0, width(), height());
     const int columns = int(std::ceil(std::sqrt(qreal(m_cells.count()))));
@@ -349,9 +406,7 @@ void ExpoLayout::calculateWindowTransformationsClosest()
     // Assign slots
     const int slotWidth = area.width() / columns;
     const int slotHeight = area.height() / rows;
-    QVector<ExpoCell *> takenSlots;
-    takenSlots.resize(rows * columns);
-    takenSlots.fill(nullptr);
+    std::vector<int> takenSlots(rows * columns, -1);
 
     // precalculate all slot centers
     QVector<QPoint> slotCenters;
@@ -363,19 +418,30 @@ void ExpoLayout::calculateWindowTransformationsClosest()
         }
     }
 
+    // The distances between the windows and the slots don't change while the windows are
+    // shuffled around, so they are computed only once
+    std::vector<int> distances(m_cells.count() * rows * columns);
+    for (int cell = 0; cell < m_cells.count(); ++cell) {
+        const QPoint pos = m_cells[cell]->naturalRect().center();
+        for (int i = 0; i < columns * rows; ++i) {
+            distances[cell * rows * columns + i] = distance(pos, slotCenters[i]);
+        }
+    }
+
     // Assign each window to the closest available slot
-    QList<ExpoCell *> tmpList = m_cells; // use a QLinkedList copy instead?
-    while (!tmpList.isEmpty()) {
-        ExpoCell *cell = tmpList.first();
+    std::deque<int> tmpList(m_cells.count());
+    std::iota(tmpList.begin(), tmpList.end(), 0);
+    while (!tmpList.empty()) {
+        const int cell = tmpList.front();
+        tmpList.pop_front();
         int slotCandidate = -1, slotCandidateDistance = INT_MAX;
-        const QPoint pos = cell->naturalRect().center();
 
         for (int i = 0; i < columns * rows; ++i) { // all slots
-            const int dist = distance(pos, slotCenters[i]);
+            const int dist = distances[cell * rows * columns + i];
             if (dist < slotCandidateDistance) { // window is interested in this slot
-                ExpoCell *occupier = takenSlots[i];
+                const int occupier = takenSlots[i];
                 Q_ASSERT(occupier != cell);
-                if (!occupier || dist < distance(occupier->naturalRect().center(), slotCenters[i])) {
+                if (occupier == -1 || dist < distances[occupier * rows * columns + i]) {
                     // either nobody lives here, or we're better - takeover the slot if it's our best
                     slotCandidate = i;
                     slotCandidateDistance = dist;
@@ -383,18 +449,18 @@ void ExpoLayout::calculateWindowTransformationsClosest()
             }
         }
         Q_ASSERT(slotCandidate != -1);
-        if (takenSlots[slotCandidate]) {
-            tmpList << takenSlots[slotCandidate]; // occupier needs a new home now :p
+        if (takenSlots[slotCandidate] != -1) {
+            tmpList.push_back(takenSlots[slotCandidate]); // occupier needs a new home now :p
         }
-        tmpList.removeAll(cell);
         takenSlots[slotCandidate] = cell; // ...and we rumble in =)
     }
 
+    std::vector<QRect> geometries(m_cells.count());
     for (int slot = 0; slot < columns * rows; ++slot) {
-        ExpoCell *cell = takenSlots[slot];
-        if (!cell) { // some slots might be empty
+        if (takenSlots[slot] == -1) { // some slots might be empty
             continue;
         }
+        const ExpoCell *cell = m_cells[takenSlots[slot]];
 
         // Work out where the slot is
         QRect target(area.x() + (slot % columns) * slotWidth,
@@ -424,68 +490,53 @@ void ExpoLayout::calculateWindowTransformationsClosest()
                 scale * cell->naturalWidth(), scale * cell->naturalHeight());
         }
 
-        cell->setX(target.x());
-        cell->setY(target.y());
-        cell->setWidth(target.width());
-        cell->setHeight(target.height());
+        geometries[takenSlots[slot]] = target;
     }
+    return geometries;
 }
 
-static inline int heightForWidth(ExpoCell *cell, int width)
+static inline int heightForWidth(const ExpoCell *cell, int width)
 {
     return int((width / qreal(cell->naturalWidth())) * cell->naturalHeight());
 }
 
-static bool isOverlappingAny(ExpoCell *w, const QHash<ExpoCell *, QRect> &targets, const QRegion &border, int spacing)
+static bool isOverlappingAny(int w, const std::vector<QRect> &targets, const QRect &area, const QRect &border, int spacing)
 {
-    QHash<ExpoCell *, QRect>::const_iterator winTarget = targets.find(w);
-    if (winTarget == targets.constEnd()) {
-        return false;
-    }
-    if (border.intersects(*winTarget)) {
+    const QRect &winTarget = targets[w];
+    // Same as intersecting the region between the area and the border, without building it
+    if (!area.contains(winTarget) && border.intersects(winTarget)) {
         return true;
     }
     const QMargins halfSpacing(spacing / 2, spacing / 2, spacing / 2, spacing / 2);
+    const QRect spaced = winTarget.marginsAdded(halfSpacing);
 
-    // Is there a better way to do this?
-    QHash<ExpoCell *, QRect>::const_iterator target;
-    for (target = targets.constBegin(); target != targets.constEnd(); ++target) {
-        if (target == winTarget) {
+    for (int i = 0; i < int(targets.size()); ++i) {
+        if (i == w) {
             continue;
         }
-        if (winTarget->marginsAdded(halfSpacing).intersects(target->marginsAdded(halfSpacing))) {
+        if (spaced.intersects(targets[i].marginsAdded(halfSpacing))) {
             return true;
         }
     }
     return false;
 }
 
-void ExpoLayout::calculateWindowTransformationsNatural()
+std::vector<QRect> ExpoLayout::calculateWindowTransformationsNatural() const
 {
     const QRect area = QRect(0, 0, width(), height());
+    const int count = m_cells.count();
 
-    // As we are using pseudo-random movement (See "slot") we need to make sure the list
-    // is always sorted the same way no matter which window is currently active.
-    std::sort(m_cells.begin(), m_cells.end(), [](const ExpoCell *a, const ExpoCell *b) {
-        return a->persistentKey() < b->persistentKey();
-    });
-
+    // The targets are indexed the same way as the cells, which are sorted by updatePolish().
+    // The preferred direction of a window is its index modulo 4. This is used when the window
+    // is on the edge of the screen to try to use as much screen real estate as possible.
     QRect bounds;
-    int direction = 0;
-    QHash<ExpoCell *, QRect> targets;
-    QHash<ExpoCell *, int> directions;
+    std::vector<QRect> targets;
+    targets.reserve(count);
 
-    for (ExpoCell *cell : std::as_const(m_cells)) {
+    for (const ExpoCell *cell : m_cells) {
         const QRect cellRect(cell->naturalX(), cell->naturalY(), cell->naturalWidth(), cell->naturalHeight());
-        targets[cell] = cellRect;
-        // Reuse the unused "slot" as a preferred direction attribute. This is used when the window
-        // is on the edge of the screen to try to use as much screen real estate as possible.
-        directions[cell] = direction;
+        targets.push_back(cellRect);
         bounds = bounds.united(cellRect);
-        direction++;
-        if (direction == 4) {
-            direction = 0;
-        }
     }
 
     // Iterate over all windows, if two overlap push them apart _slightly_ as we try to
@@ -494,9 +545,9 @@ void ExpoLayout::calculateWindowTransformationsNatural()
     bool overlap;
     do {
         overlap = false;
-        for (ExpoCell *cell : std::as_const(m_cells)) {
+        for (int cell = 0; cell < count; ++cell) {
             QRect *target_w = &targets[cell];
-            for (ExpoCell *e : std::as_const(m_cells)) {
+            for (int e = 0; e < count; ++e) {
                 if (cell == e) {
                     continue;
                 }
@@ -538,10 +589,10 @@ void ExpoLayout::calculateWindowTransformationsNatural()
                     diff = QPoint(0, 0);
                     if (xSection != 1 || ySection != 1) { // Remove this if you want the center to pull as well
                         if (xSection == 1) {
-                            xSection = (directions[cell] / 2 ? 2 : 0);
+                            xSection = ((cell % 4) / 2 ? 2 : 0);
                         }
                         if (ySection == 1) {
-                            ySection = (directions[cell] % 2 ? 2 : 0);
+                            ySection = ((cell % 4) % 2 ? 2 : 0);
                         }
                     }
                     if (xSection == 0 && ySection == 0) {
@@ -585,27 +636,25 @@ void ExpoLayout::calculateWindowTransformationsNatural()
                    area.height() / scale);
 
     // Move all windows back onto the screen and set their scale
-    QHash<ExpoCell *, QRect>::iterator target = targets.begin();
-    while (target != targets.end()) {
-        target->setRect((target->x() - bounds.x()) * scale + area.x(),
-                        (target->y() - bounds.y()) * scale + area.y(),
-                        target->width() * scale,
-                        target->height() * scale);
-        ++target;
+    for (QRect &target : targets) {
+        target.setRect((target.x() - bounds.x()) * scale + area.x(),
+                       (target.y() - bounds.y()) * scale + area.y(),
+                       target.width() * scale,
+                       target.height() * scale);
     }
 
     // Try to fill the gaps by enlarging windows if they have the space
     if (m_fillGaps) {
         // Don't expand onto or over the border
-        QRegion borderRegion(area.adjusted(-200, -200, 200, 200));
-        borderRegion ^= area;
+        const QRect border = area.adjusted(-200, -200, 200, 200);
 
         bool moved;
         do {
             moved = false;
-            for (ExpoCell *cell : std::as_const(m_cells)) {
+            for (int i = 0; i < count; ++i) {
+                const ExpoCell *cell = m_cells[i];
                 QRect oldRect;
-                QRect *target = &targets[cell];
+                QRect *target = &targets[i];
                 // This may cause some slight distortion if the windows are enlarged a large amount
                 int widthDiff = m_accuracy;
                 int heightDiff = heightForWidth(cell, target->width() + widthDiff) - target->height();
@@ -621,7 +670,7 @@ void ExpoLayout::calculateWindowTransformationsNatural()
                                 target->y() - yDiff - heightDiff,
                                 target->width() + widthDiff,
                                 target->height() + heightDiff);
-                if (isOverlappingAny(cell, targets, borderRegion, m_spacing)) {
+                if (isOverlappingAny(i, targets, area, border, m_spacing)) {
                     *target = oldRect;
                 } else {
                     moved = true;
@@ -635,7 +684,7 @@ void ExpoLayout::calculateWindowTransformationsNatural()
                                 target->y() + yDiff,
                                 target->width() + widthDiff,
                                 target->height() + heightDiff);
-                if (isOverlappingAny(cell, targets, borderRegion, m_spacing)) {
+                if (isOverlappingAny(i, targets, area, border, m_spacing)) {
                     *target = oldRect;
                 } else {
                     moved = true;
@@ -649,7 +698,7 @@ void ExpoLayout::calculateWindowTransformationsNatural()
                                 target->y() + yDiff,
                                 target->width() + widthDiff,
                                 target->height() + heightDiff);
-                if (isOverlappingAny(cell, targets, borderRegion, m_spacing)) {
+                if (isOverlappingAny(i, targets, area, border, m_spacing)) {
                     *target = oldRect;
                 } else {
                     moved = true;
@@ -663,7 +712,7 @@ void ExpoLayout::calculateWindowTransformationsNatural()
                                 target->y() - yDiff - heightDiff,
                                 target->width() + widthDiff,
                                 target->height() + heightDiff);
-                if (isOverlappingAny(cell, targets, borderRegion, m_spacing)) {
+                if (isOverlappingAny(i, targets, area, border, m_spacing)) {
                     *target = oldRect;
                 } else {
                     moved = true;
@@ -674,8 +723,9 @@ void ExpoLayout::calculateWindowTransformationsNatural()
         // The expanding code above can actually enlarge windows over 1.0/2.0 scale, we don't like this
         // We can't add this to the loop above as it would cause a never-ending loop so we have to make
         // do with the less-than-optimal space usage with using this method.
-        for (ExpoCell *cell : std::as_const(m_cells)) {
-            QRect *target = &targets[cell];
+        for (int i = 0; i < count; ++i) {
+            const ExpoCell *cell = m_cells[i];
+            QRect *target = &targets[i];
             qreal scale = target->width() / qreal(cell->naturalWidth());
             if (scale > 2.0 || (scale > 1.0 && (cell->naturalWidth() > 300 || cell->naturalHeight() > 300))) {
                 scale = (cell->naturalWidth() > 300 || cell->naturalHeight() > 300) ? 1.0 : 2.0;
@@ -687,14 +737,10 @@ void ExpoLayout::calculateWindowTransformationsNatural()
         }
     }
 
-    for (ExpoCell *cell : std::as_const(m_cells)) {
-        const QRect rect = centered(cell, targets.value(cell).marginsRemoved(cell->margins()));
-
-        cell->setX(rect.x());
-        cell->setY(rect.y());
-        cell->setWidth(rect.width());
-        cell->setHeight(rect.height());
+    for (int i = 0; i < count; ++i) {
+        targets[i] = centered(m_cells[i], targets[i].marginsRemoved(m_cells[i]->margins()));
     }
+    return targets;
 }
 
 void ExpoLayout::resetTransformations()
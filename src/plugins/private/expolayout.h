@@ -10,7 +10,9 @@
 #include <QQuickItem>
 #include <QRect>
 
+#include <deque>
 #include <optional>
+#include <vector>
 
 class ExpoCell;
 
@@ -60,11 +62,43 @@ Q_SIGNALS:
     void readyChanged();
 
 private:
-    void calculateWindowTransformationsClosest();
-    void calculateWindowTransformationsNatural();
+    /**
+     * The inputs of a layout pass, the resulting geometries depend on nothing else.
+     */
+    struct LayoutKey
+    {
+        struct Cell
+        {
+            QString persistentKey;
+            QRect naturalRect;
+            QMargins margins;
+
+            bool operator==(const Cell &other) const = default;
+        };
+
+        LayoutMode mode;
+        bool fillGaps;
+        int spacing;
+        QSize size;
+        std::vector<Cell> cells;
+
+        bool operator==(const LayoutKey &other) const = default;
+    };
+
+    struct CachedLayout
+    {
+        LayoutKey key;
+        std::vector<QRect> geometries;
+    };
+
+    LayoutKey layoutKey() const;
+    std::vector<QRect> calculateWindowTransformationsClosest() const;
+    std::vector<QRect> calculateWindowTransformationsNatural() const;
     void resetTransformations();
 
     QList<ExpoCell *> m_cells;
+    // the most recently used layouts first, so typing and erasing a filter doesn't lay out again
+    std::deque<CachedLayout> m_layoutCache;
     LayoutMode m_mode = LayoutNatural;
     int m_accuracy = 20;
     int m_spacing = 10;
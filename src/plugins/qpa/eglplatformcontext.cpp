@@ -36,9 +36,18 @@ EGLPlatformContext::EGLPlatformContext(QOpenGLContext *context, ::EGLDisplay dis
     create(context->format(), kwinApp()->outputBackend()->sceneEglGlobalShareContext());
 }
 
+EGLPlatformContext::EGLPlatformContext(::EGLContext nativeContext, ::EGLDisplay display)
+    : m_eglDisplay(display)
+    , m_context(nativeContext)
+    , m_adopted(true)
+{
+    m_format.setRenderableType(isOpenGLES() ? QSurfaceFormat::OpenGLES : QSurfaceFormat::OpenGL);
+    updateFormatFromContext();
+}
+
 EGLPlatformContext::~EGLPlatformContext()
 {
-    if (m_context != EGL_NO_CONTEXT) {
+    if (m_context != EGL_NO_CONTEXT && !m_adopted) {
         eglDestroyContext(m_eglDisplay, m_context);
     }
 }
@@ -64,7 +73,8 @@ static EGLSurface eglSurfaceForPlatformSurface(QPlatformSurface *surface)
 
 bool EGLPlatformContext::makeCurrent(QPlatformSurface *surface)
 {
-    const EGLSurface eglSurface = eglSurfaceForPlatformSurface(surface);
+    // the config of an adopted context is unknown, it's only used surfaceless, as kwin does
+    const EGLSurface eglSurface = m_adopted && surface->surface()->surfaceClass() == QSurface::Offscreen ? EGL_NO_SURFACE : eglSurfaceForPlatformSurface(surface);
 
     const bool ok = eglMakeCurrent(eglDisplay(), eglSurface, eglSurface, eglContext());
     if (!ok) {
@@ -87,6 +97,10 @@ bool EGLPlatformContext::makeCurrent(QPlatformSurface *surface)
 
 void EGLPlatformContext::doneCurrent()
 {
+    if (m_adopted) {
+        // kwin expects its own context to stay current
+        return;
+    }
     eglMakeCurrent(m_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
 }
 
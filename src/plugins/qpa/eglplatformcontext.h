@@ -23,6 +23,11 @@ class EGLPlatformContext : public QPlatformOpenGLContext
 {
 public:
     EGLPlatformContext(QOpenGLContext *context, ::EGLDisplay display);
+    /**
+     * Wraps the existing @a nativeContext, e.g. the one of the scene. The native context is
+     * neither destroyed nor released by the platform context.
+     */
+    EGLPlatformContext(::EGLContext nativeContext, ::EGLDisplay display);
     ~EGLPlatformContext() override;
 
     bool makeCurrent(QPlatformSurface *surface) override;
@@ -45,6 +50,7 @@ private:
     EGLConfig m_config = EGL_NO_CONFIG_KHR;
     ::EGLContext m_context = EGL_NO_CONTEXT;
     QSurfaceFormat m_format;
+    bool m_adopted = false;
 };
 
 } // namespace QPA
@@ -21,6 +21,7 @@
 #include "workspace.h"
 
 #include <QCoreApplication>
+#include <QOpenGLContext>
 #include <QTimer>
 #include <QtConcurrentRun>
 
@@ -29,6 +30,7 @@
 #include <qpa/qwindowsysteminterface.h>
 
 #include <QtGui/private/qgenericunixeventdispatcher_p.h>
+#include <QtGui/private/qopenglcontext_p.h>
 #include <QtGui/private/qgenericunixfontdatabase_p.h>
 #include <QtGui/private/qgenericunixthemes_p.h>
 #include <QtGui/private/qunixeventdispatcher_qpa_p.h>
@@ -154,6 +156,14 @@ QPlatformOpenGLContext *Integration::createPlatformOpenGLContext(QOpenGLContext
     return nullptr;
 }
 
+QOpenGLContext *Integration::createOpenGLContext(::EGLContext context, ::EGLDisplay display, QOpenGLContext *) const
+{
+    // the wrapped context is the scene context or shares with it already
+    auto openglContext = new QOpenGLContext;
+    QOpenGLContextPrivate::get(openglContext)->adopt(new EGLPlatformContext(context, display));
+    return openglContext;
+}
+
 void Integration::handleWorkspaceCreated()
 {
     connect(workspace(), &Workspace::outputAdded,
@@ -14,6 +14,7 @@
 #include <QObject>
 #include <QtGui/private/qgenericunixservices_p.h>
 #include <qpa/qplatformintegration.h>
+#include <qpa/qplatformopenglcontext.h>
 
 namespace KWin
 {
@@ -25,7 +26,7 @@ namespace QPA
 
 class Screen;
 
-class Integration : public QObject, public QPlatformIntegration
+class Integration : public QObject, public QPlatformIntegration, public QNativeInterface::Private::QEGLIntegration
 {
     Q_OBJECT
 public:
@@ -41,6 +42,7 @@ public:
     QStringList themeNames() const override;
     QPlatformTheme *createPlatformTheme(const QString &name) const override;
     QPlatformOpenGLContext *createPlatformOpenGLContext(QOpenGLContext *context) const override;
+    QOpenGLContext *createOpenGLContext(::EGLContext context, ::EGLDisplay display, QOpenGLContext *shareContext) const override;
     QPlatformNativeInterface *nativeInterface() const override;
     QPlatformServices *services() const override;
     void initialize() override;
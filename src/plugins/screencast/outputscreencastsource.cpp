@@ -59,6 +59,19 @@ void OutputScreenCastSource::render(GLFramebuffer *target)
         return;
     }
 
+    const TextureTransforms transforms = outputTexture->contentTransforms();
+    const bool rotated = (transforms & TextureTransform::Rotate90) || (transforms & TextureTransform::Rotate180) || (transforms & TextureTransform::Rotate270);
+    if (GLFramebuffer::blitSupported() && !rotated && outputTexture->size() == target->size()) {
+        // Nothing needs to be scaled or rotated, copy the output contents without a shader pass.
+        GLFramebuffer sourceFramebuffer(outputTexture.get());
+        if (sourceFramebuffer.valid()) {
+            GLFramebuffer::pushFramebuffer(&sourceFramebuffer);
+            target->blitFromFramebuffer(QRect(), QRect(), GL_NEAREST, transforms & TextureTransform::MirrorX, !(transforms & TextureTransform::MirrorY));
+            GLFramebuffer::popFramebuffer();
+            return;
+        }
+    }
+
     ShaderBinder shaderBinder(ShaderTrait::MapTexture);
     QMatrix4x4 projectionMatrix;
     projectionMatrix.scale(1, -1);
@@ -75,6 +88,11 @@ std::chrono::nanoseconds OutputScreenCastSource::clock() const
     return m_output->renderLoop()->lastPresentationTimestamp();
 }
 
+RenderLoop *OutputScreenCastSource::renderLoop() const
+{
+    return m_output->renderLoop();
+}
+
 uint OutputScreenCastSource::refreshRate() const
 {
     return m_output->refreshRate();
@@ -30,6 +30,7 @@ public:
     void render(GLFramebuffer *target) override;
     void render(spa_data *spa, spa_video_format format) override;
     std::chrono::nanoseconds clock() const override;
+    RenderLoop *renderLoop() const override;
 
 private:
     QPointer<Output> m_output;
@@ -12,7 +12,8 @@
 
 #include <KLocalizedString>
 
-#include <QSocketNotifier>
+#include <QCoreApplication>
+#include <QThread>
 
 namespace KWin
 {
@@ -24,10 +25,27 @@ PipeWireCore::PipeWireCore()
     pwCoreEvents.error = &PipeWireCore::onCoreError;
 }
 
+PipeWireCore::Locker::Locker(PipeWireCore *core)
+    : m_loop(core->pwThreadLoop)
+{
+    if (m_loop) {
+        pw_thread_loop_lock(m_loop);
+    }
+}
+
+PipeWireCore::Locker::~Locker()
+{
+    if (m_loop) {
+        pw_thread_loop_unlock(m_loop);
+    }
+}
+
 PipeWireCore::~PipeWireCore()
 {
-    if (pwMainLoop) {
-        pw_loop_leave(pwMainLoop);
+    if (pwThreadLoop) {
+        // the PipeWire thread may be waiting for the main thread
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+        pw_thread_loop_stop(pwThreadLoop);
     }
 
     if (pwCore) {
@@ -38,8 +56,8 @@ PipeWireCore::~PipeWireCore()
         pw_context_destroy(pwContext);
     }
 
-    if (pwMainLoop) {
-        pw_loop_destroy(pwMainLoop);
+    if (pwThreadLoop) {
+        pw_thread_loop_destroy(pwThreadLoop);
     }
 }
 
@@ -48,35 +66,36 @@ void PipeWireCore::onCoreError(void *data, uint32_t id, int seq, int res, const
     qCWarning(KWIN_SCREENCAST) << "PipeWire remote error: " << message;
     if (id == PW_ID_CORE && res == -EPIPE) {
         PipeWireCore *pw = static_cast<PipeWireCore *>(data);
-        Q_EMIT pw->pipewireFailed(QString::fromUtf8(message));
+        pw->runOnMainThread([pw, message] {
+            Q_EMIT pw->pipewireFailed(QString::fromUtf8(message));
+        });
     }
 }
 
 bool PipeWireCore::init()
 {
-    pwMainLoop = pw_loop_new(nullptr);
-    if (!pwMainLoop) {
+    pwThreadLoop = pw_thread_loop_new("kwin-pipewire", nullptr);
+    if (!pwThreadLoop) {
         qCWarning(KWIN_SCREENCAST, "Failed to create PipeWire loop: %s", strerror(errno));
         m_error = i18n("Failed to start main PipeWire loop");
         return false;
     }
-    pw_loop_enter(pwMainLoop);
-
-    QSocketNotifier *notifier = new QSocketNotifier(pw_loop_get_fd(pwMainLoop), QSocketNotifier::Read, this);
-    connect(notifier, &QSocketNotifier::activated, this, [this] {
-        int result = pw_loop_iterate(pwMainLoop, 0);
-        if (result < 0) {
-            qCWarning(KWIN_SCREENCAST) << "pipewire_loop_iterate failed: " << result;
-        }
-    });
+    pwLoop = pw_thread_loop_get_loop(pwThreadLoop);
 
-    pwContext = pw_context_new(pwMainLoop, nullptr, 0);
+    pwContext = pw_context_new(pwLoop, nullptr, 0);
     if (!pwContext) {
         qCWarning(KWIN_SCREENCAST) << "Failed to create PipeWire context";
         m_error = i18n("Failed to create PipeWire context");
         return false;
     }
 
+    if (pw_thread_loop_start(pwThreadLoop) < 0) {
+        qCWarning(KWIN_SCREENCAST) << "Failed to start main PipeWire loop";
+        m_error = i18n("Failed to start main PipeWire loop");
+        return false;
+    }
+
+    Locker locker(this);
     pwCore = pw_context_connect(pwContext, nullptr, 0);
     if (!pwCore) {
         qCWarning(KWIN_SCREENCAST) << "Failed to connect PipeWire context";
@@ -84,16 +103,33 @@ bool PipeWireCore::init()
         return false;
     }
 
-    if (pw_loop_iterate(pwMainLoop, 0) < 0) {
-        qCWarning(KWIN_SCREENCAST) << "Failed to start main PipeWire loop";
-        m_error = i18n("Failed to start main PipeWire loop");
-        return false;
-    }
-
     pw_core_add_listener(pwCore, &coreListener, &pwCoreEvents, this);
     return true;
 }
 
+void PipeWireCore::runOnMainThread(const std::function<void()> &function)
+{
+    if (QThread::currentThread() == thread()) {
+        function();
+        return;
+    }
+
+    // the PipeWire thread holds the lock while it dispatches the events, waiting releases it
+    // so the main thread can use the PipeWire objects meanwhile
+    bool done = false;
+    QMetaObject::invokeMethod(
+        this, [this, &function, &done] {
+            Locker locker(this);
+            function();
+            done = true;
+            pw_thread_loop_signal(pwThreadLoop, false);
+        },
+        Qt::QueuedConnection);
+    while (!done) {
+        pw_thread_loop_wait(pwThreadLoop);
+    }
+}
+
 std::shared_ptr<PipeWireCore> PipeWireCore::self()
 {
     static std::weak_ptr<PipeWireCore> global;
@@ -14,13 +14,33 @@
 #include <pipewire/pipewire.h>
 #include <spa/utils/hook.h>
 
+#include <functional>
+
 namespace KWin
 {
 
+/**
+ * The PipeWire loop runs on its own thread so that a slow or stalled consumer doesn't hold
+ * up the compositor. The PipeWire objects may only be used while the loop is locked, the
+ * events they emit are dispatched on the PipeWire thread.
+ */
 class PipeWireCore : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * Locks the PipeWire loop for the lifetime of the locker. The lock is recursive.
+     */
+    class Locker
+    {
+    public:
+        explicit Locker(PipeWireCore *core);
+        ~Locker();
+
+    private:
+        pw_thread_loop *m_loop;
+    };
+
     PipeWireCore();
 
     static void onCoreError(void *data, uint32_t id, int seq, int res, const char *message);
@@ -31,9 +51,16 @@ public:
 
     static std::shared_ptr<PipeWireCore> self();
 
+    /**
+     * Runs @a function on the main thread and returns once it has finished. If it's called on
+     * the PipeWire thread, the loop must be locked, it gets released while the function runs.
+     */
+    void runOnMainThread(const std::function<void()> &function);
+
     struct pw_core *pwCore = nullptr;
     struct pw_context *pwContext = nullptr;
-    struct pw_loop *pwMainLoop = nullptr;
+    struct pw_thread_loop *pwThreadLoop = nullptr;
+    struct pw_loop *pwLoop = nullptr;
     spa_hook coreListener;
     QString m_error;
 
@@ -12,6 +12,10 @@
 #include <composite.h>
 #include <core/output.h>
 #include <drm_fourcc.h>
+#include <libkwineffects/kwineffects.h>
+#include <libkwineffects/rendertarget.h>
+#include <libkwineffects/renderviewport.h>
+#include <scene/itemrenderer.h>
 #include <scene/workspacescene.h>
 #include <workspace.h>
 
@@ -27,6 +31,19 @@ RegionScreenCastSource::RegionScreenCastSource(const QRect &region, qreal scale,
 {
     Q_ASSERT(m_region.isValid());
     Q_ASSERT(m_scale > 0);
+
+    // the source is shared by all the streams of the region, update it once per output frame
+    // before the streams record their frames
+    const auto allOutputs = workspace()->outputs();
+    for (Output *output : allOutputs) {
+        if (output->geometry().intersects(m_region)) {
+            connect(output, &Output::outputChange, this, [this, output](const QRegion &damagedRegion) {
+                if (!damagedRegion.isEmpty()) {
+                    updateOutput(output);
+                }
+            });
+        }
+    }
 }
 
 QSize RegionScreenCastSource::textureSize() const
@@ -48,6 +65,11 @@ void RegionScreenCastSource::updateOutput(Output *output)
 {
     m_last = output->renderLoop()->lastPresentationTimestamp();
 
+    if (rendersScene()) {
+        m_sceneDirty = true;
+        return;
+    }
+
     if (m_renderedTexture) {
         const std::shared_ptr<GLTexture> outputTexture = Compositor::self()->scene()->textureForOutput(output);
         const auto outputGeometry = output->geometry();
@@ -74,8 +96,60 @@ std::chrono::nanoseconds RegionScreenCastSource::clock() const
     return m_last;
 }
 
+/**
+ * Whether the region is painted from the scene rather than assembled from the textures of
+ * the outputs. If the region spans several outputs, the contents would be copied and resampled
+ * per output, so the scene is painted once with the projection of the region instead. The
+ * effects that paint on the screen are only seen in the textures of the outputs though, so
+ * a region within a single output is always copied from its texture.
+ */
+bool RegionScreenCastSource::rendersScene() const
+{
+    int count = 0;
+    const auto allOutputs = workspace()->outputs();
+    for (Output *output : allOutputs) {
+        if (output->geometry().intersects(m_region)) {
+            if (++count > 1) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void RegionScreenCastSource::renderScene(GLFramebuffer *target)
+{
+    QMatrix4x4 projectionMatrix;
+    projectionMatrix.scale(1, -1);
+    projectionMatrix.ortho(m_region);
+
+    WindowPaintData data;
+    data.setProjectionMatrix(projectionMatrix);
+
+    WorkspaceScene *scene = Compositor::self()->scene();
+    RenderTarget renderTarget(target);
+    RenderViewport viewport(m_region, m_scale, renderTarget);
+    GLFramebuffer::pushFramebuffer(target);
+    scene->renderer()->renderBackground(renderTarget, viewport, infiniteRegion());
+    scene->renderer()->renderItem(renderTarget, viewport, scene->containerItem(), 0, infiniteRegion(), data);
+    GLFramebuffer::popFramebuffer();
+}
+
 void RegionScreenCastSource::ensureTexture()
 {
+    if (rendersScene()) {
+        if (!m_renderedTexture) {
+            m_renderedTexture.reset(new GLTexture(GL_RGBA8, textureSize()));
+            m_target.reset(new GLFramebuffer(m_renderedTexture.get()));
+            m_sceneDirty = true;
+        }
+        if (m_sceneDirty) {
+            renderScene(m_target.get());
+            m_sceneDirty = false;
+        }
+        return;
+    }
+
     if (!m_renderedTexture) {
         m_renderedTexture.reset(new GLTexture(GL_RGBA8, textureSize()));
         m_target.reset(new GLFramebuffer(m_renderedTexture.get()));
@@ -90,6 +164,12 @@ void RegionScreenCastSource::ensureTexture()
 
 void RegionScreenCastSource::render(GLFramebuffer *target)
 {
+    if (rendersScene()) {
+        // the stream buffer has the size of the region, paint straight into it
+        renderScene(target);
+        return;
+    }
+
     ensureTexture();
 
     GLFramebuffer::pushFramebuffer(target);
@@ -112,6 +192,11 @@ void RegionScreenCastSource::render(spa_data *spa, spa_video_format format)
     grabTexture(m_renderedTexture.get(), spa, format);
 }
 
+RenderLoop *RegionScreenCastSource::renderLoop() const
+{
+    return nullptr;
+}
+
 uint RegionScreenCastSource::refreshRate() const
 {
     uint ret = 0;
@@ -31,6 +31,7 @@ public:
     void render(GLFramebuffer *target) override;
     void render(spa_data *spa, spa_video_format format) override;
     std::chrono::nanoseconds clock() const override;
+    RenderLoop *renderLoop() const override;
 
     QRect region() const
     {
@@ -40,16 +41,20 @@ public:
     {
         return m_scale;
     }
-    void updateOutput(Output *output);
 
 private:
+    void updateOutput(Output *output);
     void ensureTexture();
+    bool rendersScene() const;
+    void renderScene(GLFramebuffer *target);
 
     const QRect m_region;
     const qreal m_scale;
     std::unique_ptr<GLFramebuffer> m_target;
     std::unique_ptr<GLTexture> m_renderedTexture;
     std::chrono::nanoseconds m_last;
+    // set when the scene has to be painted again before the next frame is taken
+    bool m_sceneDirty = true;
 };
 
 } // namespace KWin
@@ -10,6 +10,7 @@
 #include "composite.h"
 #include "core/output.h"
 #include "core/outputbackend.h"
+#include "core/renderloop.h"
 #include "effects.h"
 #include "libkwineffects/kwingltexture.h"
 #include "outputscreencastsource.h"
@@ -25,6 +26,8 @@
 
 #include <KLocalizedString>
 
+#include <utility>
+
 namespace KWin
 {
 
@@ -54,11 +57,30 @@ static QRegion scaleRegion(const QRegion &_region, qreal scale)
     return region;
 }
 
+template<typename Source, typename Key, typename... Args>
+static std::shared_ptr<Source> sharedSource(QHash<Key, std::weak_ptr<Source>> &sources, const Key &key, Args &&...args)
+{
+    for (auto it = sources.begin(); it != sources.end();) {
+        if (it->expired()) {
+            it = sources.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (auto source = sources.value(key).lock()) {
+        return source;
+    }
+    auto source = std::make_shared<Source>(std::forward<Args>(args)...);
+    sources.insert(key, source);
+    return source;
+}
+
 class WindowStream : public ScreenCastStream
 {
 public:
-    WindowStream(Window *window, QObject *parent)
-        : ScreenCastStream(new WindowScreenCastSource(window), parent)
+    WindowStream(Window *window, const std::shared_ptr<WindowScreenCastSource> &source, QObject *parent)
+        : ScreenCastStream(source, parent)
         , m_window(window)
     {
         m_timer.setInterval(0);
@@ -73,7 +95,8 @@ private:
     void startFeeding()
     {
         connect(m_window, &Window::damaged, this, &WindowStream::markDirty);
-        markDirty();
+        m_damage = QRect(QPoint(0, 0), m_window->clientGeometry().size().toSize());
+        m_timer.start();
     }
 
     void stopFeeding()
@@ -82,18 +105,29 @@ private:
         m_timer.stop();
     }
 
-    void markDirty()
+    void markDirty(Window *, const QRegion &region)
     {
-        m_timer.start();
+        // the frames are driven by the commits of the window rather than by the output, only
+        // the parts of the window that have changed are repainted and sent
+        const QRect windowRect(QPoint(0, 0), m_window->clientGeometry().size().toSize());
+        if (region == infiniteRegion()) {
+            m_damage = windowRect;
+        } else {
+            m_damage += region.translated(-m_window->clientGeometry().topLeft().toPoint()) & windowRect;
+        }
+        if (!m_damage.isEmpty()) {
+            m_timer.start();
+        }
     }
 
     void bufferToStream()
     {
-        recordFrame(QRegion(0, 0, m_window->width(), m_window->height()));
+        recordFrame(std::exchange(m_damage, QRegion()));
     }
 
     Window *m_window;
     QTimer m_timer;
+    QRegion m_damage;
 };
 
 void ScreencastManager::streamWindow(KWaylandServer::ScreencastStreamV1Interface *waylandStream,
@@ -106,7 +140,7 @@ void ScreencastManager::streamWindow(KWaylandServer::ScreencastStreamV1Interface
         return;
     }
 
-    auto stream = new WindowStream(window, this);
+    auto stream = new WindowStream(window, sharedSource(m_windowSources, window, window), this);
     stream->setCursorMode(mode, 1, window->clientGeometry());
     if (mode != KWaylandServer::ScreencastV1Interface::CursorMode::Hidden) {
         connect(window, &Window::clientGeometryChanged, stream, [window, stream, mode]() {
@@ -124,10 +158,32 @@ void ScreencastManager::streamVirtualOutput(KWaylandServer::ScreencastStreamV1In
                                             KWaylandServer::ScreencastV1Interface::CursorMode mode)
 {
     auto output = kwinApp()->outputBackend()->createVirtualOutput(name, size, scale);
-    streamOutput(stream, output, mode);
+    ScreenCastStream *castStream = streamOutput(stream, output, mode);
     connect(stream, &KWaylandServer::ScreencastStreamV1Interface::finished, output, [output] {
         kwinApp()->outputBackend()->removeVirtualOutput(output);
     });
+    if (!castStream) {
+        return;
+    }
+
+    // nothing else shows the virtual output, so it's composited only while the stream is
+    // consumed, and not faster than the consumer takes the frames
+    RenderLoop *renderLoop = output->renderLoop();
+    renderLoop->inhibit();
+    // the inhibition must stay balanced, whatever the order of the state changes of the stream
+    auto inhibited = std::make_shared<bool>(true);
+    connect(castStream, &ScreenCastStream::startStreaming, output, [output, castStream, renderLoop, inhibited]() {
+        const uint framerate = castStream->framerate();
+        renderLoop->setRefreshRate(framerate > 0 ? std::min<int>(framerate * 1000, output->refreshRate()) : output->refreshRate());
+        if (std::exchange(*inhibited, false)) {
+            renderLoop->uninhibit();
+        }
+    });
+    connect(castStream, &ScreenCastStream::pauseStreaming, output, [renderLoop, inhibited]() {
+        if (!std::exchange(*inhibited, true)) {
+            renderLoop->inhibit();
+        }
+    });
 }
 
 void ScreencastManager::streamWaylandOutput(KWaylandServer::ScreencastStreamV1Interface *waylandStream,
@@ -137,16 +193,16 @@ void ScreencastManager::streamWaylandOutput(KWaylandServer::ScreencastStreamV1In
     streamOutput(waylandStream, output->handle(), mode);
 }
 
-void ScreencastManager::streamOutput(KWaylandServer::ScreencastStreamV1Interface *waylandStream,
-                                     Output *streamOutput,
-                                     KWaylandServer::ScreencastV1Interface::CursorMode mode)
+ScreenCastStream *ScreencastManager::streamOutput(KWaylandServer::ScreencastStreamV1Interface *waylandStream,
+                                                  Output *streamOutput,
+                                                  KWaylandServer::ScreencastV1Interface::CursorMode mode)
 {
     if (!streamOutput) {
         waylandStream->sendFailed(i18n("Could not find output"));
-        return;
+        return nullptr;
     }
 
-    auto stream = new ScreenCastStream(new OutputScreenCastSource(streamOutput), this);
+    auto stream = new ScreenCastStream(sharedSource(m_outputSources, streamOutput, streamOutput), this);
     stream->setObjectName(streamOutput->name());
     stream->setCursorMode(mode, streamOutput->scale(), streamOutput->geometry());
     auto bufferToStream = [stream, streamOutput](const QRegion &damagedRegion) {
@@ -158,7 +214,7 @@ void ScreencastManager::streamOutput(KWaylandServer::ScreencastStreamV1Interface
         Compositor::self()->scene()->addRepaint(streamOutput->geometry());
         connect(streamOutput, &Output::outputChange, stream, bufferToStream);
     });
-    integrateStreams(waylandStream, stream);
+    return integrateStreams(waylandStream, stream) ? stream : nullptr;
 }
 
 static QString rectToString(const QRect &rect)
@@ -173,8 +229,9 @@ void ScreencastManager::streamRegion(KWaylandServer::ScreencastStreamV1Interface
         return;
     }
 
-    auto source = new RegionScreenCastSource(geometry, scale);
-    auto stream = new ScreenCastStream(source, this);
+    const auto shared = sharedSource(m_regionSources, rectToString(geometry) + QLatin1Char('@') + QString::number(scale), geometry, scale);
+    RegionScreenCastSource *source = shared.get();
+    auto stream = new ScreenCastStream(shared, this);
     stream->setObjectName(rectToString(geometry));
     stream->setCursorMode(mode, scale, geometry);
 
@@ -192,7 +249,6 @@ void ScreencastManager::streamRegion(KWaylandServer::ScreencastStreamV1Interface
 
                     const QRect streamRegion = source->region();
                     const QRegion region = output->pixelSize() != output->modeSize() ? output->geometry() : damagedRegion;
-                    source->updateOutput(output);
                     stream->recordFrame(scaleRegion(region.translated(-streamRegion.topLeft()).intersected(streamRegion), source->scale()));
                 };
                 connect(output, &Output::outputChange, stream, bufferToStream);
@@ -206,7 +262,7 @@ void ScreencastManager::streamRegion(KWaylandServer::ScreencastStreamV1Interface
     integrateStreams(waylandStream, stream);
 }
 
-void ScreencastManager::integrateStreams(KWaylandServer::ScreencastStreamV1Interface *waylandStream, ScreenCastStream *stream)
+bool ScreencastManager::integrateStreams(KWaylandServer::ScreencastStreamV1Interface *waylandStream, ScreenCastStream *stream)
 {
     connect(waylandStream, &KWaylandServer::ScreencastStreamV1Interface::finished, stream, &ScreenCastStream::stop);
     connect(stream, &ScreenCastStream::stopStreaming, waylandStream, [stream, waylandStream] {
@@ -219,7 +275,9 @@ void ScreencastManager::integrateStreams(KWaylandServer::ScreencastStreamV1Inter
     if (!stream->init()) {
         waylandStream->sendFailed(stream->error());
         delete stream;
+        return false;
     }
+    return true;
 }
 
 } // namespace KWin
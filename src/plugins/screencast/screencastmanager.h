@@ -12,10 +12,17 @@
 
 #include "wayland/screencast_v1_interface.h"
 
+#include <QHash>
+#include <memory>
+
 namespace KWin
 {
 class Output;
+class OutputScreenCastSource;
+class RegionScreenCastSource;
 class ScreenCastStream;
+class Window;
+class WindowScreenCastSource;
 
 class ScreencastManager : public Plugin
 {
@@ -31,7 +38,7 @@ private:
     void streamWaylandOutput(KWaylandServer::ScreencastStreamV1Interface *stream,
                              KWaylandServer::OutputInterface *output,
                              KWaylandServer::ScreencastV1Interface::CursorMode mode);
-    void
+    ScreenCastStream *
     streamOutput(KWaylandServer::ScreencastStreamV1Interface *stream, Output *output, KWaylandServer::ScreencastV1Interface::CursorMode mode);
     void streamVirtualOutput(KWaylandServer::ScreencastStreamV1Interface *stream,
                              const QString &name,
@@ -43,9 +50,17 @@ private:
                       qreal scale,
                       KWaylandServer::ScreencastV1Interface::CursorMode mode);
 
-    void integrateStreams(KWaylandServer::ScreencastStreamV1Interface *waylandStream, ScreenCastStream *stream);
+    /**
+     * Returns @c false if the @a stream failed to initialize, it's deleted in that case.
+     */
+    bool integrateStreams(KWaylandServer::ScreencastStreamV1Interface *waylandStream, ScreenCastStream *stream);
 
     KWaylandServer::ScreencastV1Interface *m_screencast;
+
+    // streams capturing the same thing share the source, so it's only rendered once per frame
+    QHash<Output *, std::weak_ptr<OutputScreenCastSource>> m_outputSources;
+    QHash<Window *, std::weak_ptr<WindowScreenCastSource>> m_windowSources;
+    QHash<QString, std::weak_ptr<RegionScreenCastSource>> m_regionSources;
 };
 
 } // namespace KWin
@@ -15,6 +15,7 @@ namespace KWin
 
 class GLFramebuffer;
 class GLTexture;
+class RenderLoop;
 
 class ScreenCastSource : public QObject
 {
@@ -31,6 +32,11 @@ public:
     virtual void render(GLFramebuffer *target) = 0;
     virtual void render(spa_data *spa, spa_video_format format) = 0;
     virtual std::chrono::nanoseconds clock() const = 0;
+    /**
+     * Returns the render loop that drives the updates of this source, or @c null if the
+     * contents come from several outputs.
+     */
+    virtual RenderLoop *renderLoop() const = 0;
 
 Q_SIGNALS:
     void closed();
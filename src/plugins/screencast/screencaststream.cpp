@@ -9,9 +9,9 @@
 #include "screencaststream.h"
 #include "composite.h"
 #include "core/renderbackend.h"
+#include "core/renderloop.h"
 #include "cursor.h"
 #include "dmabuftexture.h"
-#include "eglnativefence.h"
 #include "kwinscreencast_logging.h"
 #include "libkwineffects/kwineffects.h"
 #include "libkwineffects/kwinglplatform.h"
@@ -19,15 +19,20 @@
 #include "libkwineffects/kwinglutils.h"
 #include "main.h"
 #include "pipewirecore.h"
+#include "platformsupport/scenes/opengl/abstract_egl_backend.h"
+#include "platformsupport/scenes/opengl/eglnativefence.h"
 #include "platformsupport/scenes/opengl/openglbackend.h"
 #include "scene/workspacescene.h"
 #include "screencastsource.h"
+#include "screencastutils.h"
 #include "utils/common.h"
 
 #include <KLocalizedString>
 
+#include <QCoreApplication>
 #include <QLoggingCategory>
 #include <QPainter>
+#include <QTextStream>
 
 #include <spa/buffer/meta.h>
 
@@ -71,12 +76,31 @@ static spa_video_format drmFourCCToSpaVideoFormat(quint32 format)
     }
 }
 
+/**
+ * The events of the stream are emitted on the PipeWire thread, the handlers run on the main
+ * thread since they use the scene and the OpenGL context, the PipeWire thread waits for them.
+ */
+template<auto handler, typename... Args>
+void ScreenCastStream::dispatch(void *data, Args... args)
+{
+    ScreenCastStream *stream = static_cast<ScreenCastStream *>(data);
+    stream->m_dispatching++;
+    stream->pwCore->runOnMainThread([&] {
+        handler(data, args...);
+    });
+    stream->m_dispatching--;
+}
+
 void ScreenCastStream::onStreamStateChanged(void *data, pw_stream_state old, pw_stream_state state, const char *error_message)
 {
     ScreenCastStream *pw = static_cast<ScreenCastStream *>(data);
     qCDebug(KWIN_SCREENCAST) << "state changed" << pw_stream_state_as_string(old) << " -> " << pw_stream_state_as_string(state) << error_message;
 
-    pw->m_streaming = false;
+    const bool wasStreaming = std::exchange(pw->m_streaming, false);
+    if (wasStreaming && state != PW_STREAM_STATE_STREAMING) {
+        // e.g. paused by the consumer or failed, startStreaming() follows if it recovers
+        Q_EMIT pw->pauseStreaming();
+    }
     switch (state) {
     case PW_STREAM_STATE_ERROR:
         qCWarning(KWIN_SCREENCAST) << "Stream error: " << error_message;
@@ -173,16 +197,18 @@ void ScreenCastStream::onStreamParamChanged(void *data, uint32_t id, const struc
         std::sort(receivedModifiers.begin(), receivedModifiers.end());
         receivedModifiers.erase(std::unique(receivedModifiers.begin(), receivedModifiers.end()), receivedModifiers.end());
     }
-    if (modifierProperty && (!pw->m_dmabufParams || !receivedModifiers.contains(pw->m_dmabufParams->modifier))) {
+    const bool yuv = pw->videoFormat.format == SPA_VIDEO_FORMAT_NV12;
+    const quint32 drmFormat = yuv ? DRM_FORMAT_NV12 : pw->m_drmFormat;
+    if (modifierProperty && (!pw->m_dmabufParams || pw->m_dmabufParams->format != drmFormat || !receivedModifiers.contains(pw->m_dmabufParams->modifier))) {
         if (modifierProperty->flags & SPA_POD_PROP_FLAG_DONT_FIXATE) {
             // DRM_MOD_INVALID should be used as a last option. Do not just remove it it's the only
             // item on the list
             if (receivedModifiers.count() > 1) {
                 receivedModifiers.removeAll(DRM_FORMAT_MOD_INVALID);
             }
-            pw->m_dmabufParams = kwinApp()->outputBackend()->testCreateDmaBuf(pw->m_resolution, pw->m_drmFormat, receivedModifiers);
+            pw->m_dmabufParams = kwinApp()->outputBackend()->testCreateDmaBuf(pw->m_resolution, drmFormat, receivedModifiers);
         } else {
-            pw->m_dmabufParams = kwinApp()->outputBackend()->testCreateDmaBuf(pw->m_resolution, pw->m_drmFormat, {DRM_FORMAT_MOD_INVALID});
+            pw->m_dmabufParams = kwinApp()->outputBackend()->testCreateDmaBuf(pw->m_resolution, drmFormat, {DRM_FORMAT_MOD_INVALID});
         }
 
         // In case we fail to use any modifier from the list of offered ones, remove these
@@ -190,7 +216,7 @@ void ScreenCastStream::onStreamParamChanged(void *data, uint32_t id, const struc
         // be used and clients can go for it over and over
         if (!pw->m_dmabufParams.has_value()) {
             for (uint64_t modifier : receivedModifiers) {
-                pw->m_modifiers.removeAll(modifier);
+                (yuv ? pw->m_yuvModifiers : pw->m_modifiers).removeAll(modifier);
             }
         // Also in case DRM_FORMAT_MOD_INVALID was used and didn't fail, we still need to
         // set it as our modifier, otherwise it would be set to default value (0) which is
@@ -200,7 +226,7 @@ void ScreenCastStream::onStreamParamChanged(void *data, uint32_t id, const struc
         }
 
         qCDebug(KWIN_SCREENCAST) << "Stream dmabuf modifiers received, offering our best suited modifier" << pw->m_dmabufParams.has_value();
-        char buffer[2048];
+        char buffer[4096];
         auto params = pw->buildFormats(pw->m_dmabufParams.has_value(), buffer);
         pw_stream_update_params(pw->pwStream, params.data(), params.count());
         return;
@@ -225,15 +251,21 @@ void ScreenCastStream::onStreamAddBuffer(void *data, pw_buffer *buffer)
         dmabuff = kwinApp()->outputBackend()->createDmaBufTexture(*stream->m_dmabufParams);
     }
 
-    if (dmabuff) {
-        spa_data->maxsize = dmabuff->attributes().pitch[0] * stream->m_resolution.height();
+    if (dmabuff && dmabuff->attributes().format == DRM_FORMAT_NV12 && !stream->createYuvPlanes(buffer, dmabuff->attributes())) {
+        qCWarning(KWIN_SCREENCAST) << "Failed to import the planes of an NV12 buffer";
+        dmabuff.reset();
+    }
 
+    if (dmabuff) {
         const DmaBufAttributes &dmabufAttribs = dmabuff->attributes();
         Q_ASSERT(buffer->buffer->n_datas >= uint(dmabufAttribs.planeCount));
         for (int i = 0; i < dmabufAttribs.planeCount; ++i) {
+            // the chroma plane of NV12 buffers has half the height
+            const int planeHeight = i == 0 ? stream->m_resolution.height() : (stream->m_resolution.height() + 1) / 2;
             buffer->buffer->datas[i].type = SPA_DATA_DmaBuf;
             buffer->buffer->datas[i].fd = dmabufAttribs.fd[i].get();
             buffer->buffer->datas[i].data = nullptr;
+            buffer->buffer->datas[i].maxsize = dmabufAttribs.pitch[i] * planeHeight;
         }
         stream->m_dmabufDataForPwBuffer.insert(buffer, dmabuff);
 #ifdef F_SEAL_SEAL // Disable memfd on systems that don't have it, like BSD < 12
@@ -247,6 +279,7 @@ void ScreenCastStream::onStreamAddBuffer(void *data, pw_buffer *buffer)
         const int stride = SPA_ROUND_UP_N(stream->m_resolution.width() * bytesPerPixel, 4);
         spa_data->maxsize = stride * stream->m_resolution.height();
         spa_data->type = SPA_DATA_MemFd;
+        stream->m_bufferDamage.insert(buffer, QRect(QPoint(0, 0), stream->m_resolution));
         spa_data->fd = memfd_create("kwin-screencast-memfd", MFD_CLOEXEC | MFD_ALLOW_SEALING);
         if (spa_data->fd == -1) {
             qCCritical(KWIN_SCREENCAST) << "memfd: Can't create memfd";
@@ -285,6 +318,13 @@ void ScreenCastStream::onStreamRemoveBuffer(void *data, pw_buffer *buffer)
 {
     ScreenCastStream *stream = static_cast<ScreenCastStream *>(data);
     stream->m_dmabufDataForPwBuffer.remove(buffer);
+    stream->m_bufferDamage.remove(buffer);
+    if (auto it = stream->m_yuvPlanes.find(buffer); it != stream->m_yuvPlanes.end()) {
+        if (Compositor::self()) {
+            static_cast<OpenGLBackend *>(Compositor::self()->backend())->makeCurrent();
+        }
+        stream->m_yuvPlanes.erase(it);
+    }
 
     struct spa_buffer *spa_buffer = buffer->buffer;
     struct spa_data *spa_data = spa_buffer->datas;
@@ -303,28 +343,29 @@ void ScreenCastStream::onStreamRenegotiateFormat(void *data, uint64_t)
     ScreenCastStream *stream = static_cast<ScreenCastStream *>(data);
 
     stream->m_streaming = false; // pause streaming as we wait for the renegotiation
-    char buffer[2048];
+    char buffer[4096];
     auto params = stream->buildFormats(stream->m_dmabufParams.has_value(), buffer);
     pw_stream_update_params(stream->pwStream, params.data(), params.count());
 }
 
-ScreenCastStream::ScreenCastStream(ScreenCastSource *source, QObject *parent)
+ScreenCastStream::ScreenCastStream(const std::shared_ptr<ScreenCastSource> &source, QObject *parent)
     : QObject(parent)
     , m_source(source)
     , m_resolution(source->textureSize())
 {
-    connect(source, &ScreenCastSource::closed, this, [this] {
+    connect(source.get(), &ScreenCastSource::closed, this, [this] {
         m_streaming = false;
         Q_EMIT stopStreaming();
     });
 
     pwStreamEvents.version = PW_VERSION_STREAM_EVENTS;
-    pwStreamEvents.add_buffer = &ScreenCastStream::onStreamAddBuffer;
-    pwStreamEvents.remove_buffer = &ScreenCastStream::onStreamRemoveBuffer;
-    pwStreamEvents.state_changed = &ScreenCastStream::onStreamStateChanged;
-    pwStreamEvents.param_changed = &ScreenCastStream::onStreamParamChanged;
+    pwStreamEvents.add_buffer = &ScreenCastStream::dispatch<&ScreenCastStream::onStreamAddBuffer, pw_buffer *>;
+    pwStreamEvents.remove_buffer = &ScreenCastStream::dispatch<&ScreenCastStream::onStreamRemoveBuffer, pw_buffer *>;
+    pwStreamEvents.state_changed = &ScreenCastStream::dispatch<&ScreenCastStream::onStreamStateChanged, pw_stream_state, pw_stream_state, const char *>;
+    pwStreamEvents.param_changed = &ScreenCastStream::dispatch<&ScreenCastStream::onStreamParamChanged, uint32_t, const struct spa_pod *>;
 
-    connect(&m_pendingFrame, &QTimer::timeout, this, [this] {
+    connect(&m_pendingFrame, &PreciseTimer::timeout, this, [this] {
+        m_frameRequested = false;
         recordFrame(m_pendingDamages);
     });
 }
@@ -332,8 +373,32 @@ ScreenCastStream::ScreenCastStream(ScreenCastSource *source, QObject *parent)
 ScreenCastStream::~ScreenCastStream()
 {
     m_stopped = true;
-    if (pwStream) {
-        pw_stream_destroy(pwStream);
+    while (pwCore) {
+        PipeWireCore::Locker locker(pwCore.get());
+        // run the events that the PipeWire thread waits for, the stream can be destroyed once
+        // it has returned from them
+        QCoreApplication::sendPostedEvents(pwCore.get(), QEvent::MetaCall);
+        if (m_dispatching) {
+            continue;
+        }
+        if (pwRenegotiate) {
+            pw_loop_destroy_source(pwCore->pwLoop, pwRenegotiate);
+        }
+        if (pwStream) {
+            pw_stream_destroy(pwStream);
+        }
+        break;
+    }
+    if (Compositor::self()) {
+        static_cast<OpenGLBackend *>(Compositor::self()->backend())->makeCurrent();
+        m_cursor.textures.clear();
+        m_yuvPlanes.clear();
+        m_yuv.framebuffer.reset();
+        m_yuv.texture.reset();
+        m_yuv.shader.reset();
+        if (m_readback.pixelBuffer) {
+            glDeleteBuffers(1, &m_readback.pixelBuffer);
+        }
     }
 }
 
@@ -353,7 +418,8 @@ bool ScreenCastStream::init()
         return false;
     }
 
-    pwRenegotiate = pw_loop_add_event(pwCore.get()->pwMainLoop, onStreamRenegotiateFormat, this);
+    PipeWireCore::Locker locker(pwCore.get());
+    pwRenegotiate = pw_loop_add_event(pwCore->pwLoop, &ScreenCastStream::dispatch<&ScreenCastStream::onStreamRenegotiateFormat, uint64_t>, this);
 
     return true;
 }
@@ -374,6 +440,7 @@ uint ScreenCastStream::nodeId()
 
 bool ScreenCastStream::createStream()
 {
+    PipeWireCore::Locker locker(pwCore.get());
     const QByteArray objname = "kwin-screencast-" + objectName().toUtf8();
     pwStream = pw_stream_new(pwCore->pwCore, objname, nullptr);
 
@@ -399,7 +466,23 @@ bool ScreenCastStream::createStream()
     }
     m_hasDmaBuf = kwinApp()->outputBackend()->testCreateDmaBuf(m_resolution, m_drmFormat, {DRM_FORMAT_MOD_INVALID}).has_value();
 
-    char buffer[2048];
+    // NV12 buffers are rendered by importing each plane on its own, so the modifiers have to
+    // work for the single channel formats too
+    const auto nv12Modifiers = supported.constFind(DRM_FORMAT_NV12);
+    const auto lumaModifiers = supported.constFind(DRM_FORMAT_R8);
+    const auto chromaModifiers = supported.constFind(DRM_FORMAT_GR88);
+    if (m_hasDmaBuf && nv12Modifiers != supported.constEnd() && lumaModifiers != supported.constEnd() && chromaModifiers != supported.constEnd()) {
+        m_yuvModifiers.clear();
+        for (uint64_t modifier : *nv12Modifiers) {
+            if (lumaModifiers->contains(modifier) && chromaModifiers->contains(modifier)) {
+                m_yuvModifiers.append(modifier);
+            }
+        }
+        m_yuvModifiers += DRM_FORMAT_MOD_INVALID;
+        m_hasYuvDmaBuf = kwinApp()->outputBackend()->testCreateDmaBuf(m_resolution, DRM_FORMAT_NV12, {DRM_FORMAT_MOD_INVALID}).has_value();
+    }
+
+    char buffer[4096];
     QVector<const spa_pod *> params = buildFormats(false, buffer);
 
     pw_stream_add_listener(pwStream, &streamListener, &pwStreamEvents, this);
@@ -444,22 +527,38 @@ void ScreenCastStream::recordFrame(const QRegion &_damagedRegion)
         return;
     }
 
-    if (videoFormat.max_framerate.num != 0 && !m_lastSent.isNull()) {
-        auto frameInterval = (1000. * videoFormat.max_framerate.denom / videoFormat.max_framerate.num);
-        auto lastSentAgo = m_lastSent.msecsTo(QDateTime::currentDateTimeUtc());
-        if (lastSentAgo < frameInterval) {
+    // the previous frame is still being processed, coalesce the damage and record a frame
+    // once the buffer has been queued
+    if (m_pendingBuffer) {
+        m_pendingDamages |= damagedRegion;
+        m_frameRequested = true;
+        return;
+    }
+
+    const std::chrono::nanoseconds presentationTime = frameTime();
+    if (videoFormat.max_framerate.num != 0 && m_lastFrameTime != std::chrono::nanoseconds::zero()) {
+        const std::chrono::nanoseconds interval = frameInterval();
+        const std::chrono::nanoseconds nextFrameTime = m_lastFrameTime + interval;
+        // presentation timestamps jitter a bit, but they must not be rounded to the previous vblank
+        const uint refreshRate = m_source->refreshRate();
+        const std::chrono::nanoseconds tolerance = refreshRate ? std::chrono::nanoseconds(500'000'000'000ull / refreshRate) : interval / 4;
+        if (presentationTime < nextFrameTime - tolerance) {
             m_pendingDamages |= damagedRegion;
             if (!m_pendingFrame.isActive()) {
-                m_pendingFrame.start(frameInterval - lastSentAgo);
+                // make sure the damage gets sent if the source doesn't repaint anymore
+                const auto now = std::chrono::steady_clock::now().time_since_epoch();
+                m_pendingFrame.start(std::max(nextFrameTime - now, std::chrono::nanoseconds::zero()));
             }
             return;
         }
     }
 
+    m_pendingFrame.stop();
+    m_frameRequested = false;
+    damagedRegion |= m_pendingDamages;
     m_pendingDamages = {};
-    if (m_pendingBuffer) {
-        qCWarning(KWIN_SCREENCAST) << "Dropping a screencast frame because the compositor is slow";
-        return;
+    for (QRegion &bufferDamage : m_bufferDamage) {
+        bufferDamage += damagedRegion;
     }
 
     if (m_waitForNewBuffers) {
@@ -472,24 +571,30 @@ void ScreenCastStream::recordFrame(const QRegion &_damagedRegion)
         m_resolution = size;
         m_waitForNewBuffers = true;
         m_dmabufParams = std::nullopt;
-        pw_loop_signal_event(pwCore.get()->pwMainLoop, pwRenegotiate);
+        pw_loop_signal_event(pwCore->pwLoop, pwRenegotiate);
         return;
     }
 
-    const char *error = "";
-    auto state = pw_stream_get_state(pwStream, &error);
-    if (state != PW_STREAM_STATE_STREAMING) {
-        if (error) {
-            qCWarning(KWIN_SCREENCAST) << "Failed to record frame: stream is not active" << error;
+    // the loop is locked only to take the buffer, the frame is rendered without holding it
+    struct pw_buffer *buffer = nullptr;
+    {
+        PipeWireCore::Locker locker(pwCore.get());
+        const char *error = "";
+        auto state = pw_stream_get_state(pwStream, &error);
+        if (state != PW_STREAM_STATE_STREAMING) {
+            if (error) {
+                qCWarning(KWIN_SCREENCAST) << "Failed to record frame: stream is not active" << error;
+            }
+            return;
         }
-        return;
-    }
 
-    struct pw_buffer *buffer = pw_stream_dequeue_buffer(pwStream);
+        buffer = pw_stream_dequeue_buffer(pwStream);
+    }
 
     if (!buffer) {
         return;
     }
+    m_lastFrameTime = presentationTime;
 
     struct spa_buffer *spa_buffer = buffer->buffer;
     struct spa_data *spa_data = spa_buffer->datas;
@@ -497,6 +602,7 @@ void ScreenCastStream::recordFrame(const QRegion &_damagedRegion)
     uint8_t *data = (uint8_t *)spa_data->data;
     if (!data && spa_buffer->datas->type != SPA_DATA_DmaBuf) {
         qCWarning(KWIN_SCREENCAST) << "Failed to record frame: invalid buffer data";
+        PipeWireCore::Locker locker(pwCore.get());
         pw_stream_queue_buffer(pwStream, buffer);
         return;
     }
@@ -511,6 +617,7 @@ void ScreenCastStream::recordFrame(const QRegion &_damagedRegion)
 
         if ((stride * size.height()) > spa_data->maxsize) {
             qCDebug(KWIN_SCREENCAST) << "Failed to record frame: frame is too big";
+            PipeWireCore::Locker locker(pwCore.get());
             pw_stream_queue_buffer(pwStream, buffer);
             return;
         }
@@ -518,14 +625,15 @@ void ScreenCastStream::recordFrame(const QRegion &_damagedRegion)
         spa_data->chunk->stride = stride;
         spa_data->chunk->size = stride * size.height();
 
-        m_source->render(spa_data, videoFormat.format);
+        // only the parts that changed since this buffer has been used the last time need to be copied
+        const QRegion copyRegion = m_bufferDamage.value(buffer, QRect(QPoint(0, 0), size)) & QRect(QPoint(0, 0), size);
+        m_bufferDamage[buffer] = QRegion();
 
-        auto cursor = Cursors::self()->currentCursor();
-        if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded && exclusiveContains(m_cursor.viewport, cursor->pos())) {
-            QImage dest(data, size.width(), size.height(), stride, hasAlpha ? QImage::Format_RGBA8888_Premultiplied : QImage::Format_RGB888);
-            QPainter painter(&dest);
-            const auto position = (cursor->pos() - m_cursor.viewport.topLeft() - cursor->hotspot()) * m_cursor.scale;
-            painter.drawImage(QRect{position.toPoint(), cursor->image().size()}, cursor->image());
+        // the cursor is composited on the gpu when reading back asynchronously, otherwise it
+        // gets painted once the contents have been copied into the buffer
+        if (!canReadbackAsync() || !startReadback(buffer, size, bpp, copyRegion)) {
+            m_source->render(spa_data, videoFormat.format);
+            m_bufferDamage[buffer] += paintCursor(data, size, stride);
         }
     } else {
         auto &buf = m_dmabufDataForPwBuffer[buffer];
@@ -536,46 +644,29 @@ void ScreenCastStream::recordFrame(const QRegion &_damagedRegion)
         for (int i = 0; i < dmabufAttribs.planeCount; ++i) {
             buffer->buffer->datas[i].chunk->stride = dmabufAttribs.pitch[i];
             buffer->buffer->datas[i].chunk->offset = dmabufAttribs.offset[i];
+            buffer->buffer->datas[i].chunk->size = buffer->buffer->datas[i].maxsize;
         }
-        spa_data->chunk->size = spa_data->maxsize;
-
-        m_source->render(buf->framebuffer());
-
-        auto cursor = Cursors::self()->currentCursor();
-        if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded && exclusiveContains(m_cursor.viewport, cursor->pos())) {
-            if (!cursor->image().isNull()) {
-                GLFramebuffer::pushFramebuffer(buf->framebuffer());
-
-                QRect r(QPoint(), size);
-                auto shader = ShaderManager::instance()->pushShader(ShaderTrait::MapTexture);
 
-                QMatrix4x4 mvp;
-                mvp.ortho(r);
-                shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
-
-                if (!m_cursor.texture || m_cursor.lastKey != cursor->image().cacheKey()) {
-                    m_cursor.texture.reset(new GLTexture(cursor->image()));
-                }
-
-                m_cursor.texture->setContentTransform(TextureTransforms());
-                const auto cursorRect = cursorGeometry(cursor);
-                mvp.translate(cursorRect.left(), r.height() - cursorRect.top() - cursor->image().height());
-                shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+        const bool yuv = m_yuvPlanes.contains(buffer);
+        if (yuv && (!m_yuv.texture || m_yuv.texture->size() != size)) {
+            m_yuv.framebuffer.reset();
+            m_yuv.texture = std::make_unique<GLTexture>(GL_RGBA8, size);
+            m_yuv.texture->setFilter(GL_LINEAR);
+            m_yuv.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+            m_yuv.framebuffer = std::make_unique<GLFramebuffer>(m_yuv.texture.get());
+        }
+        GLFramebuffer *target = yuv ? m_yuv.framebuffer.get() : buf->framebuffer();
 
-                glEnable(GL_BLEND);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-                m_cursor.texture->render(cursorRect.size(), m_cursor.scale);
-                glDisable(GL_BLEND);
+        m_source->render(target);
 
-                ShaderManager::instance()->popShader();
-                GLFramebuffer::popFramebuffer();
+        if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded) {
+            const QRect cursorRect = renderCursor(target, size);
+            damagedRegion += QRegion{m_cursor.lastRect.toAlignedRect()} | cursorRect;
+            m_cursor.lastRect = cursorRect;
+        }
 
-                damagedRegion += QRegion{m_cursor.lastRect.toAlignedRect()} | cursorRect.toAlignedRect();
-                m_cursor.lastRect = cursorRect;
-            } else {
-                damagedRegion |= m_cursor.lastRect.toAlignedRect();
-                m_cursor.lastRect = {};
-            }
+        if (yuv && !convertToYuv(buffer)) {
+            spa_data->chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
         }
     }
 
@@ -589,6 +680,283 @@ void ScreenCastStream::recordFrame(const QRegion &_damagedRegion)
     tryEnqueue(buffer);
 }
 
+bool ScreenCastStream::createYuvPlanes(pw_buffer *buffer, const DmaBufAttributes &attributes)
+{
+    if (attributes.planeCount != 2) {
+        return false;
+    }
+
+    auto importPlane = [&attributes](int plane, uint32_t format, const QSize &size) {
+        DmaBufAttributes planeAttributes{
+            .planeCount = 1,
+            .width = size.width(),
+            .height = size.height(),
+            .format = format,
+            .modifier = attributes.modifier,
+        };
+        planeAttributes.fd[0] = attributes.fd[plane].duplicate();
+        planeAttributes.offset[0] = attributes.offset[plane];
+        planeAttributes.pitch[0] = attributes.pitch[plane];
+        return static_cast<AbstractEglBackend *>(Compositor::self()->backend())->importDmaBufAsTexture(planeAttributes);
+    };
+
+    const QSize size(attributes.width, attributes.height);
+    YuvPlanes planes{
+        .luma = importPlane(0, DRM_FORMAT_R8, size),
+        .chroma = importPlane(1, DRM_FORMAT_GR88, (size + QSize(1, 1)) / 2),
+    };
+    if (!planes.luma || !planes.chroma) {
+        return false;
+    }
+    planes.lumaFramebuffer = std::make_unique<GLFramebuffer>(planes.luma.get());
+    planes.chromaFramebuffer = std::make_unique<GLFramebuffer>(planes.chroma.get());
+    if (!planes.lumaFramebuffer->valid() || !planes.chromaFramebuffer->valid()) {
+        return false;
+    }
+
+    m_yuvPlanes[buffer] = std::move(planes);
+    return true;
+}
+
+/**
+ * Returns the matrix that converts non-linear RGB to limited range Y'CbCr with the given
+ * luma coefficients of the red and the blue channel. The rows that are not needed are zero.
+ */
+static QMatrix4x4 yuvMatrix(float kr, float kb, bool chroma)
+{
+    const float kg = 1 - kr - kb;
+    const float lumaScale = 219.0 / 255.0;
+    const float chromaScale = 224.0 / 255.0;
+    const float cbScale = chromaScale / (2 * (1 - kb));
+    const float crScale = chromaScale / (2 * (1 - kr));
+    if (!chroma) {
+        return QMatrix4x4(kr * lumaScale, kg * lumaScale, kb * lumaScale, 16.0 / 255.0,
+                          0, 0, 0, 0,
+                          0, 0, 0, 0,
+                          0, 0, 0, 0);
+    }
+    return QMatrix4x4(-kr * cbScale, -kg * cbScale, (1 - kb) * cbScale, 128.0 / 255.0,
+                      (1 - kr) * crScale, -kg * crScale, -kb * crScale, 128.0 / 255.0,
+                      0, 0, 0, 0,
+                      0, 0, 0, 0);
+}
+
+bool ScreenCastStream::convertToYuv(pw_buffer *buffer)
+{
+    if (!m_yuv.shader) {
+        const bool gles = GLPlatform::instance()->isGLES();
+        const bool core = gles ? GLPlatform::instance()->glslVersion() >= Version(3, 0) : GLPlatform::instance()->glslVersion() >= Version(1, 40);
+
+        QByteArray fragmentSource;
+        QTextStream stream(&fragmentSource);
+        if (core) {
+            stream << (gles ? "#version 300 es\n\n" : "#version 140\n\n");
+        }
+        if (gles) {
+            stream << "precision highp float;\n";
+        }
+        stream << "uniform sampler2D sampler;\n";
+        stream << "uniform mat4 colorMatrix;\n";
+        stream << (core ? "in" : "varying") << " vec2 texcoord0;\n";
+        if (core) {
+            stream << "out vec4 fragColor;\n";
+        }
+        stream << "\nvoid main(void)\n{\n";
+        stream << "    vec3 rgb = " << (core ? "texture" : "texture2D") << "(sampler, texcoord0).rgb;\n";
+        stream << "    " << (core ? "fragColor" : "gl_FragColor") << " = colorMatrix * vec4(rgb, 1.0);\n";
+        stream << "}\n";
+        stream.flush();
+
+        m_yuv.shader = ShaderManager::instance()->generateCustomShader(ShaderTrait::MapTexture, QByteArray(), fragmentSource);
+        m_yuv.colorMatrixLocation = m_yuv.shader->uniformLocation("colorMatrix");
+    }
+    if (!m_yuv.shader->isValid()) {
+        return false;
+    }
+
+    const YuvPlanes &planes = m_yuvPlanes.at(buffer);
+    const bool bt601 = videoFormat.color_matrix == SPA_VIDEO_COLOR_MATRIX_BT601;
+    const float kr = bt601 ? 0.299 : 0.2126;
+    const float kb = bt601 ? 0.114 : 0.0722;
+
+    // the planes have the same layout as the texture, draw it over the whole viewport
+    const float vertices[] = {-1, -1, 1, -1, -1, 1, 1, 1};
+    const float texcoords[] = {0, 0, 1, 0, 0, 1, 1, 1};
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    vbo->reset();
+    vbo->setData(4, 2, vertices, texcoords);
+
+    ShaderManager::instance()->pushShader(m_yuv.shader.get());
+    m_yuv.shader->setUniform(GLShader::ModelViewProjectionMatrix, QMatrix4x4());
+    m_yuv.texture->bind();
+
+    // the chroma plane has a quarter of the samples, linear filtering averages each 2x2 block
+    m_yuv.shader->setUniform(m_yuv.colorMatrixLocation, yuvMatrix(kr, kb, false));
+    GLFramebuffer::pushFramebuffer(planes.lumaFramebuffer.get());
+    vbo->render(GL_TRIANGLE_STRIP);
+    GLFramebuffer::popFramebuffer();
+
+    m_yuv.shader->setUniform(m_yuv.colorMatrixLocation, yuvMatrix(kr, kb, true));
+    GLFramebuffer::pushFramebuffer(planes.chromaFramebuffer.get());
+    vbo->render(GL_TRIANGLE_STRIP);
+    GLFramebuffer::popFramebuffer();
+
+    m_yuv.texture->unbind();
+    ShaderManager::instance()->popShader();
+    return true;
+}
+
+QRect ScreenCastStream::paintCursor(uchar *data, const QSize &size, uint stride)
+{
+    auto cursor = Cursors::self()->currentCursor();
+    if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded && exclusiveContains(m_cursor.viewport, cursor->pos())) {
+        QImage dest(data, size.width(), size.height(), stride, m_source->hasAlphaChannel() ? QImage::Format_RGBA8888_Premultiplied : QImage::Format_RGB888);
+        QPainter painter(&dest);
+        const auto position = (cursor->pos() - m_cursor.viewport.topLeft() - cursor->hotspot()) * m_cursor.scale;
+        const QRect cursorRect(position.toPoint(), cursor->image().size());
+        painter.drawImage(cursorRect, cursor->image());
+        return cursorRect;
+    }
+    return QRect();
+}
+
+GLTexture *ScreenCastStream::cursorTexture(Cursor *cursor)
+{
+    if (m_cursor.textureSource != cursor->source()) {
+        m_cursor.textureSource = cursor->source();
+        m_cursor.textures.clear();
+    }
+
+    const QImage image = cursor->image();
+    auto it = m_cursor.textures.find(image.cacheKey());
+    if (it == m_cursor.textures.end()) {
+        // animated cursors have a handful of frames, anything beyond that is a source
+        // that keeps producing new images
+        if (m_cursor.textures.size() >= 32) {
+            m_cursor.textures.clear();
+        }
+        auto texture = std::make_unique<GLTexture>(image);
+        texture->setContentTransform(TextureTransforms());
+        it = m_cursor.textures.emplace(image.cacheKey(), std::move(texture)).first;
+    }
+    return it->second.get();
+}
+
+QRect ScreenCastStream::renderCursor(GLFramebuffer *target, const QSize &size)
+{
+    auto cursor = Cursors::self()->currentCursor();
+    if (!exclusiveContains(m_cursor.viewport, cursor->pos()) || cursor->image().isNull()) {
+        return QRect();
+    }
+
+    GLTexture *texture = cursorTexture(cursor);
+    const auto cursorRect = cursorGeometry(cursor);
+
+    GLFramebuffer::pushFramebuffer(target);
+    auto shader = ShaderManager::instance()->pushShader(ShaderTrait::MapTexture);
+
+    QMatrix4x4 mvp;
+    mvp.ortho(QRect(QPoint(), size));
+    mvp.translate(cursorRect.left(), size.height() - cursorRect.top() - cursor->image().height());
+    shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    texture->render(cursorRect.size(), m_cursor.scale);
+    glDisable(GL_BLEND);
+
+    ShaderManager::instance()->popShader();
+    GLFramebuffer::popFramebuffer();
+
+    return cursorRect.toAlignedRect();
+}
+
+bool ScreenCastStream::canReadbackAsync() const
+{
+    // without native fences, the buffer is enqueued right away and the copy can't be deferred
+    return Compositor::self()->scene()->supportsNativeFence() && hasGLVersion(3, 0);
+}
+
+bool ScreenCastStream::startReadback(pw_buffer *buffer, const QSize &size, int bytesPerPixel, const QRegion &region)
+{
+    spa_data *spa = buffer->buffer->datas;
+    if (!m_readback.texture || m_readback.texture->size() != size) {
+        m_readback.framebuffer.reset();
+        m_readback.texture = std::make_unique<GLTexture>(GL_RGBA8, size);
+        m_readback.framebuffer = std::make_unique<GLFramebuffer>(m_readback.texture.get());
+    }
+    if (!m_readback.framebuffer->valid()) {
+        return false;
+    }
+    if (!m_readback.pixelBuffer) {
+        glGenBuffers(1, &m_readback.pixelBuffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readback.pixelBuffer);
+    if (m_readback.bufferSize != spa->chunk->size) {
+        m_readback.bufferSize = spa->chunk->size;
+        glBufferData(GL_PIXEL_PACK_BUFFER, m_readback.bufferSize, nullptr, GL_STREAM_READ);
+    }
+
+    m_source->render(m_readback.framebuffer.get());
+
+    QRegion readRegion = region;
+    if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded) {
+        // the area under the cursor has to be copied again the next time this buffer is used
+        const QRect cursorRect = renderCursor(m_readback.framebuffer.get(), size) & QRect(QPoint(0, 0), size);
+        readRegion += cursorRect;
+        m_bufferDamage[buffer] += cursorRect;
+    }
+
+    // too many small reads are slower than reading a bit more
+    m_readback.region = readRegion.rectCount() > 16 ? QRegion(readRegion.boundingRect()) : readRegion;
+    m_readback.bytesPerPixel = bytesPerPixel;
+
+    GLFramebuffer::pushFramebuffer(m_readback.framebuffer.get());
+    // the framebuffer contents are top-down already, the rows don't need to be mirrored. The
+    // rows of the pixel buffer have the same layout as the pipewire buffer
+    glPixelStorei(GL_PACK_ROW_LENGTH, size.width());
+    for (const QRect &rect : std::as_const(m_readback.region)) {
+        const uintptr_t offset = rect.y() * spa->chunk->stride + rect.x() * bytesPerPixel;
+        glReadPixels(rect.x(), rect.y(), rect.width(), rect.height(), closestGLType(videoFormat.format), GL_UNSIGNED_BYTE, reinterpret_cast<void *>(offset));
+    }
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    GLFramebuffer::popFramebuffer();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_readback.pending = true;
+    return true;
+}
+
+void ScreenCastStream::finishReadback(spa_data *spa)
+{
+    m_readback.pending = false;
+    static_cast<OpenGLBackend *>(Compositor::self()->backend())->makeCurrent();
+
+    const uint stride = spa->chunk->stride;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readback.pixelBuffer);
+    const auto pixels = static_cast<const uchar *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, spa->chunk->size, GL_MAP_READ_BIT));
+    if (pixels) {
+        auto data = static_cast<uchar *>(spa->data);
+        for (const QRect &rect : std::as_const(m_readback.region)) {
+            const int rowSize = rect.width() * m_readback.bytesPerPixel;
+            for (int y = rect.top(); y <= rect.bottom(); ++y) {
+                const uint offset = y * stride + rect.x() * m_readback.bytesPerPixel;
+                memcpy(data + offset, pixels + offset, rowSize);
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        qCWarning(KWIN_SCREENCAST) << "Failed to map the readback buffer";
+        spa->chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
+        spa->chunk->size = 0;
+        if (auto it = m_bufferDamage.find(m_pendingBuffer); it != m_bufferDamage.end()) {
+            *it = QRect(QPoint(0, 0), m_resolution);
+        }
+    }
+    m_readback.region = QRegion();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
 void ScreenCastStream::addHeader(spa_buffer *spaBuffer)
 {
     spa_meta_header *spaHeader = (spa_meta_header *)spa_buffer_find_meta_data(spaBuffer, SPA_META_Header, sizeof(spaHeader));
@@ -639,6 +1007,7 @@ void ScreenCastStream::recordCursor()
         return;
     }
 
+    PipeWireCore::Locker locker(pwCore.get());
     const char *error = "";
     auto state = pw_stream_get_state(pwStream, &error);
     if (state != PW_STREAM_STATE_STREAMING) {
@@ -686,7 +1055,7 @@ void ScreenCastStream::tryEnqueue(pw_buffer *buffer)
             glFinish();
             enqueue();
         } else {
-            m_pendingNotifier = std::make_unique<QSocketNotifier>(m_pendingFence->fileDescriptor(), QSocketNotifier::Read);
+            m_pendingNotifier = std::make_unique<QSocketNotifier>(m_pendingFence->fileDescriptor().get(), QSocketNotifier::Read);
             connect(m_pendingNotifier.get(), &QSocketNotifier::activated, this, &ScreenCastStream::enqueue);
         }
     } else {
@@ -705,21 +1074,53 @@ void ScreenCastStream::enqueue()
     m_pendingNotifier.reset();
 
     if (!m_streaming) {
+        if (m_readback.pending) {
+            m_readback.pending = false;
+            m_bufferDamage[m_pendingBuffer] = QRect(QPoint(0, 0), m_resolution);
+        }
         return;
     }
+    if (m_readback.pending) {
+        finishReadback(m_pendingBuffer->buffer->datas);
+    }
+    PipeWireCore::Locker locker(pwCore.get());
     pw_stream_queue_buffer(pwStream, m_pendingBuffer);
+    m_pendingBuffer = nullptr;
 
-    if (m_pendingBuffer->buffer->datas[0].chunk->flags != SPA_CHUNK_FLAG_CORRUPTED) {
-        m_lastSent = QDateTime::currentDateTimeUtc();
+    if (m_frameRequested && !m_pendingFrame.isActive()) {
+        m_pendingFrame.start(std::chrono::nanoseconds::zero());
     }
+}
 
-    m_pendingBuffer = nullptr;
+std::chrono::nanoseconds ScreenCastStream::frameTime() const
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    if (RenderLoop *renderLoop = m_source->renderLoop()) {
+        // the contents get presented on the next vblank, if the source is idle it's in the past
+        return std::max(renderLoop->nextPresentationTimestamp(), now);
+    }
+    return now;
+}
+
+std::chrono::nanoseconds ScreenCastStream::frameInterval() const
+{
+    const std::chrono::nanoseconds streamInterval(1'000'000'000ull * videoFormat.max_framerate.denom / videoFormat.max_framerate.num);
+    const uint refreshRate = m_source->refreshRate();
+    if (!refreshRate) {
+        return streamInterval;
+    }
+
+    // use every nth vblank, rounding up so the stream never gets more frames than it asked for.
+    // Refresh rates tend to be slightly off, e.g. 59.95Hz, so leave some slack
+    const std::chrono::nanoseconds vblankInterval(1'000'000'000'000ull / refreshRate);
+    const int64_t divisor = std::max<int64_t>(1, (streamInterval.count() * 100 / vblankInterval.count() + 98) / 100);
+    return vblankInterval * divisor;
 }
 
-QVector<const spa_pod *> ScreenCastStream::buildFormats(bool fixate, char buffer[2048])
+QVector<const spa_pod *> ScreenCastStream::buildFormats(bool fixate, char buffer[4096])
 {
     const auto format = drmFourCCToSpaVideoFormat(m_drmFormat);
-    spa_pod_builder podBuilder = SPA_POD_BUILDER_INIT(buffer, 2048);
+    spa_pod_builder podBuilder = SPA_POD_BUILDER_INIT(buffer, 4096);
     spa_fraction defFramerate = SPA_FRACTION(0, 1);
     spa_fraction minFramerate = SPA_FRACTION(1, 1);
     spa_fraction maxFramerate = SPA_FRACTION(m_source->refreshRate() / 1000, 1);
@@ -727,13 +1128,18 @@ QVector<const spa_pod *> ScreenCastStream::buildFormats(bool fixate, char buffer
     spa_rectangle resolution = SPA_RECTANGLE(uint32_t(m_resolution.width()), uint32_t(m_resolution.height()));
 
     QVector<const spa_pod *> params;
-    params.reserve(fixate + m_hasDmaBuf + 1);
+    params.reserve(fixate + m_hasDmaBuf + m_hasYuvDmaBuf + 1);
     if (fixate) {
-        params.append(buildFormat(&podBuilder, SPA_VIDEO_FORMAT_BGRA, &resolution, &defFramerate, &minFramerate, &maxFramerate, {m_dmabufParams->modifier}, SPA_POD_PROP_FLAG_MANDATORY));
+        const spa_video_format fixatedFormat = m_dmabufParams->format == DRM_FORMAT_NV12 ? SPA_VIDEO_FORMAT_NV12 : SPA_VIDEO_FORMAT_BGRA;
+        params.append(buildFormat(&podBuilder, fixatedFormat, &resolution, &defFramerate, &minFramerate, &maxFramerate, {m_dmabufParams->modifier}, SPA_POD_PROP_FLAG_MANDATORY));
     }
     if (m_hasDmaBuf) {
         params.append(buildFormat(&podBuilder, SPA_VIDEO_FORMAT_BGRA, &resolution, &defFramerate, &minFramerate, &maxFramerate, m_modifiers, SPA_POD_PROP_FLAG_MANDATORY | SPA_POD_PROP_FLAG_DONT_FIXATE));
     }
+    // hardware video encoders take YUV buffers, offering them saves a conversion on the cpu
+    if (m_hasYuvDmaBuf) {
+        params.append(buildFormat(&podBuilder, SPA_VIDEO_FORMAT_NV12, &resolution, &defFramerate, &minFramerate, &maxFramerate, m_yuvModifiers, SPA_POD_PROP_FLAG_MANDATORY | SPA_POD_PROP_FLAG_DONT_FIXATE));
+    }
     params.append(buildFormat(&podBuilder, format, &resolution, &defFramerate, &minFramerate, &maxFramerate, {}, SPA_POD_PROP_FLAG_MANDATORY | SPA_POD_PROP_FLAG_DONT_FIXATE));
     return params;
 }
@@ -765,6 +1171,12 @@ spa_pod *ScreenCastStream::buildFormat(struct spa_pod_builder *b, enum spa_video
         spa_pod_builder_add(b, SPA_FORMAT_VIDEO_format, SPA_POD_Id(format), 0);
     }
 
+    if (format == SPA_VIDEO_FORMAT_NV12) {
+        /* the consumer picks the matrix, the conversion produces limited range */
+        spa_pod_builder_add(b, SPA_FORMAT_VIDEO_colorMatrix, SPA_POD_CHOICE_ENUM_Id(3, SPA_VIDEO_COLOR_MATRIX_BT709, SPA_VIDEO_COLOR_MATRIX_BT709, SPA_VIDEO_COLOR_MATRIX_BT601), 0);
+        spa_pod_builder_add(b, SPA_FORMAT_VIDEO_colorRange, SPA_POD_Id(SPA_VIDEO_COLOR_RANGE_16_235), 0);
+    }
+
     if (!modifiers.isEmpty()) {
         spa_pod_builder_prop(b, SPA_FORMAT_VIDEO_modifier, modifiersFlags);
         spa_pod_builder_push_choice(b, &f[1], SPA_CHOICE_Enum, 0);
@@ -783,12 +1195,8 @@ spa_pod *ScreenCastStream::buildFormat(struct spa_pod_builder *b, enum spa_video
 
 QRectF ScreenCastStream::cursorGeometry(Cursor *cursor) const
 {
-    if (!m_cursor.texture) {
-        return {};
-    }
-
     const auto position = (cursor->pos() - m_cursor.viewport.topLeft() - cursor->hotspot()) * m_cursor.scale;
-    return QRectF{position, m_cursor.texture->size()};
+    return QRectF{position, cursor->image().size()};
 }
 
 void ScreenCastStream::sendCursorData(Cursor *cursor, spa_meta_cursor *spa_meta_cursor)
@@ -13,17 +13,17 @@
 #include "core/outputbackend.h"
 #include "dmabuftexture.h"
 #include "libkwineffects/kwinglobals.h"
+#include "utils/precisetimer.h"
 #include "wayland/screencast_v1_interface.h"
 
-#include <QDateTime>
 #include <QHash>
 #include <QObject>
 #include <QSize>
 #include <QSocketNotifier>
-#include <QTimer>
 #include <chrono>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 
 #include <pipewire/pipewire.h>
 #include <spa/param/format-utils.h>
@@ -34,7 +34,10 @@ namespace KWin
 {
 
 class Cursor;
+class CursorSource;
 class EGLNativeFence;
+class GLFramebuffer;
+class GLShader;
 class GLTexture;
 class PipeWireCore;
 class ScreenCastSource;
@@ -43,7 +46,7 @@ class KWIN_EXPORT ScreenCastStream : public QObject
 {
     Q_OBJECT
 public:
-    explicit ScreenCastStream(ScreenCastSource *source, QObject *parent);
+    explicit ScreenCastStream(const std::shared_ptr<ScreenCastSource> &source, QObject *parent);
     ~ScreenCastStream();
 
     bool init();
@@ -70,6 +73,11 @@ public Q_SLOTS:
 Q_SIGNALS:
     void streamReady(quint32 nodeId);
     void startStreaming();
+    /**
+     * Emitted when the stream leaves the streaming state, e.g. when the consumer pauses it or
+     * after an error. startStreaming() is emitted again if it resumes.
+     */
+    void pauseStreaming();
     void stopStreaming();
 
 private:
@@ -78,9 +86,11 @@ private:
     static void onStreamAddBuffer(void *data, pw_buffer *buffer);
     static void onStreamRemoveBuffer(void *data, pw_buffer *buffer);
     static void onStreamRenegotiateFormat(void *data, uint64_t);
+    template<auto handler, typename... Args>
+    static void dispatch(void *data, Args... args);
 
     bool createStream();
-    QVector<const spa_pod *> buildFormats(bool fixate, char buffer[2048]);
+    QVector<const spa_pod *> buildFormats(bool fixate, char buffer[4096]);
     void updateParams();
     void coreFailed(const QString &errorMessage);
     void sendCursorData(Cursor *cursor, spa_meta_cursor *spa_cursor);
@@ -89,16 +99,24 @@ private:
     void newStreamParams();
     void tryEnqueue(pw_buffer *buffer);
     void enqueue();
+    bool canReadbackAsync() const;
+    bool startReadback(pw_buffer *buffer, const QSize &size, int bytesPerPixel, const QRegion &region);
+    void finishReadback(spa_data *spa);
+    QRect paintCursor(uchar *data, const QSize &size, uint stride);
+    bool createYuvPlanes(pw_buffer *buffer, const DmaBufAttributes &attributes);
+    bool convertToYuv(pw_buffer *buffer);
     spa_pod *buildFormat(struct spa_pod_builder *b, enum spa_video_format format, struct spa_rectangle *resolution,
                          struct spa_fraction *defaultFramerate, struct spa_fraction *minFramerate, struct spa_fraction *maxFramerate,
                          const QVector<uint64_t> &modifiers, quint32 modifiersFlags);
 
     std::shared_ptr<PipeWireCore> pwCore;
-    std::unique_ptr<ScreenCastSource> m_source;
+    std::shared_ptr<ScreenCastSource> m_source;
     struct pw_stream *pwStream = nullptr;
     struct spa_source *pwRenegotiate = nullptr;
     spa_hook streamListener;
     pw_stream_events pwStreamEvents = {};
+    // the number of events of the stream that the PipeWire thread is dispatching
+    int m_dispatching = 0;
 
     uint32_t pwNodeId = 0;
 
@@ -119,13 +137,54 @@ private:
         QRectF viewport;
         qint64 lastKey = 0;
         QRectF lastRect;
-        std::unique_ptr<GLTexture> texture;
+        // the textures of the current cursor source keyed by the image cache key, so that
+        // animated cursors don't have to be uploaded again with every frame
+        CursorSource *textureSource = nullptr;
+        std::unordered_map<qint64, std::unique_ptr<GLTexture>> textures;
         bool visible = false;
     } m_cursor;
     QRectF cursorGeometry(Cursor *cursor) const;
+    GLTexture *cursorTexture(Cursor *cursor);
+    QRect renderCursor(GLFramebuffer *target, const QSize &size);
 
     QHash<struct pw_buffer *, std::shared_ptr<DmaBufTexture>> m_dmabufDataForPwBuffer;
 
+    // NV12 DmaBuf buffers get the source rendered into an RGB texture first, which a shader
+    // converts into the luma and the chroma plane of the buffer
+    struct YuvPlanes
+    {
+        std::shared_ptr<GLTexture> luma;
+        std::shared_ptr<GLTexture> chroma;
+        std::unique_ptr<GLFramebuffer> lumaFramebuffer;
+        std::unique_ptr<GLFramebuffer> chromaFramebuffer;
+    };
+    std::unordered_map<struct pw_buffer *, YuvPlanes> m_yuvPlanes;
+    struct
+    {
+        std::unique_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+        std::unique_ptr<GLShader> shader;
+        int colorMatrixLocation = -1;
+    } m_yuv;
+    QVector<uint64_t> m_yuvModifiers;
+    bool m_hasYuvDmaBuf = false;
+
+    // MemFd buffers are read back with a pixel buffer object, which is copied into
+    // the pipewire buffer once the gpu is done with it
+    struct
+    {
+        std::unique_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+        uint pixelBuffer = 0;
+        uint bufferSize = 0;
+        int bytesPerPixel = 4;
+        QRegion region;
+        bool pending = false;
+    } m_readback;
+    // the regions that changed since a MemFd buffer has been filled the last time, the
+    // buffers keep their contents so only these have to be copied
+    QHash<struct pw_buffer *, QRegion> m_bufferDamage;
+
     pw_buffer *m_pendingBuffer = nullptr;
     std::unique_ptr<QSocketNotifier> m_pendingNotifier;
     std::unique_ptr<EGLNativeFence> m_pendingFence;
@@ -134,9 +193,14 @@ private:
     bool m_waitForNewBuffers = false;
     quint32 m_drmFormat = 0;
 
-    QDateTime m_lastSent;
+    // frames are scheduled on the vblanks of the source, every nth vblank is used so the frames
+    // are evenly spaced in streams with a lower framerate than the output
+    std::chrono::nanoseconds m_lastFrameTime = std::chrono::nanoseconds::zero();
     QRegion m_pendingDamages;
-    QTimer m_pendingFrame;
+    PreciseTimer m_pendingFrame;
+    bool m_frameRequested = false;
+    std::chrono::nanoseconds frameTime() const;
+    std::chrono::nanoseconds frameInterval() const;
 };
 
 } // namespace KWin
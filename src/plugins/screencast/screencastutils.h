@@ -16,7 +16,7 @@ namespace KWin
 {
 
 // in-place vertical mirroring
-static void mirrorVertically(uchar *data, int height, int stride)
+inline void mirrorVertically(uchar *data, int height, int stride)
 {
     const int halfHeight = height / 2;
     std::vector<uchar> temp(stride);
@@ -28,7 +28,7 @@ static void mirrorVertically(uchar *data, int height, int stride)
     }
 }
 
-static GLenum closestGLType(spa_video_format format)
+inline GLenum closestGLType(spa_video_format format)
 {
     switch (format) {
     case SPA_VIDEO_FORMAT_RGB:
@@ -47,7 +47,7 @@ static GLenum closestGLType(spa_video_format format)
     }
 }
 
-static void doGrabTexture(GLTexture *texture, spa_data *spa, spa_video_format format)
+inline void doGrabTexture(GLTexture *texture, spa_data *spa, spa_video_format format)
 {
     const QSize size = texture->size();
     const bool invertNeeded = GLPlatform::instance()->isGLES() ^ !(texture->contentTransforms() & TextureTransform::MirrorY);
@@ -76,7 +76,7 @@ static void doGrabTexture(GLTexture *texture, spa_data *spa, spa_video_format fo
     }
 }
 
-static void grabTexture(GLTexture *texture, spa_data *spa, spa_video_format format)
+inline void grabTexture(GLTexture *texture, spa_data *spa, spa_video_format format)
 {
     // transform to correct orientation with the GPU first
     const QSize size = texture->contentTransformMatrix().mapRect(QRect(QPoint(), texture->size())).size();
@@ -30,6 +30,13 @@ WindowScreenCastSource::WindowScreenCastSource(Window *window, QObject *parent)
     , m_offscreenRef(window)
 {
     connect(m_window, &Window::closed, this, &ScreenCastSource::closed);
+    connect(m_window, &Window::damaged, this, [this](Window *, const QRegion &region) {
+        if (region == infiniteRegion()) {
+            m_frameDamage = infiniteRegion();
+        } else if (m_frameDamage != infiniteRegion()) {
+            m_frameDamage += region.translated(-m_window->clientGeometry().topLeft().toPoint());
+        }
+    });
 }
 
 quint32 WindowScreenCastSource::drmFormat() const
@@ -47,17 +54,48 @@ QSize WindowScreenCastSource::textureSize() const
     return m_window->clientGeometry().size().toSize();
 }
 
-void WindowScreenCastSource::render(spa_data *spa, spa_video_format format)
+GLTexture *WindowScreenCastSource::ensureFrame()
 {
-    GLTexture offscreenTexture(hasAlphaChannel() ? GL_RGBA8 : GL_RGB8, textureSize());
-    GLFramebuffer offscreenTarget(&offscreenTexture);
+    const QSize size = textureSize();
+    if (!m_frameTexture || m_frameTexture->size() != size) {
+        m_frameTarget.reset();
+        m_frameTexture = std::make_unique<GLTexture>(hasAlphaChannel() ? GL_RGBA8 : GL_RGB8, size);
+        m_frameTarget = std::make_unique<GLFramebuffer>(m_frameTexture.get());
+        m_frameDamage = infiniteRegion();
+    }
+    if (!m_frameDamage.isEmpty()) {
+        const QRect frameRect(QPoint(0, 0), size);
+        const QRegion damage = m_frameDamage & frameRect;
+        renderWindow(m_frameTarget.get(), damage == QRegion(frameRect) ? infiniteRegion() : damage);
+        m_frameDamage = QRegion();
+    }
+    return m_frameTexture.get();
+}
 
-    render(&offscreenTarget);
-    grabTexture(&offscreenTexture, spa, format);
+void WindowScreenCastSource::render(spa_data *spa, spa_video_format format)
+{
+    grabTexture(ensureFrame(), spa, format);
 }
 
 void WindowScreenCastSource::render(GLFramebuffer *target)
 {
+    if (!GLFramebuffer::blitSupported() || target->size() != textureSize()) {
+        renderWindow(target);
+        return;
+    }
+
+    ensureFrame();
+    GLFramebuffer::pushFramebuffer(m_frameTarget.get());
+    target->blitFromFramebuffer(QRect(), QRect(), GL_NEAREST);
+    GLFramebuffer::popFramebuffer();
+}
+
+void WindowScreenCastSource::renderWindow(GLFramebuffer *target, const QRegion &region)
+{
+    if (region.isEmpty()) {
+        return;
+    }
+
     const QRectF geometry = m_window->clientGeometry();
     QMatrix4x4 projectionMatrix;
     projectionMatrix.scale(1, -1);
@@ -68,10 +106,13 @@ void WindowScreenCastSource::render(GLFramebuffer *target)
 
     RenderTarget renderTarget(target);
     RenderViewport viewport(geometry, 1, renderTarget);
+    // the region is in window coordinates, the renderer clips in global coordinates
+    const QRegion clip = region == infiniteRegion() ? infiniteRegion() : region.translated(geometry.topLeft().toPoint());
+
+    ItemRenderer *renderer = Compositor::self()->scene()->renderer();
     GLFramebuffer::pushFramebuffer(target);
-    glClearColor(0.0, 0.0, 0.0, 0.0);
-    glClear(GL_COLOR_BUFFER_BIT);
-    Compositor::self()->scene()->renderer()->renderItem(renderTarget, viewport, m_window->windowItem(), Scene::PAINT_WINDOW_TRANSFORMED, infiniteRegion(), data);
+    renderer->renderBackground(renderTarget, viewport, clip);
+    renderer->renderItem(renderTarget, viewport, m_window->windowItem(), Scene::PAINT_WINDOW_TRANSFORMED, clip, data);
     GLFramebuffer::popFramebuffer();
 }
 
@@ -80,6 +121,11 @@ std::chrono::nanoseconds WindowScreenCastSource::clock() const
     return m_window->output()->renderLoop()->lastPresentationTimestamp();
 }
 
+RenderLoop *WindowScreenCastSource::renderLoop() const
+{
+    return m_window->output()->renderLoop();
+}
+
 uint WindowScreenCastSource::refreshRate() const
 {
     return m_window->output()->refreshRate();
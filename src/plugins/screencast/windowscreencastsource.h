@@ -7,6 +7,8 @@
 #pragma once
 
 #include "screencastsource.h"
+#include "libkwineffects/kwingltexture.h"
+#include "libkwineffects/kwinglutils.h"
 #include "window.h"
 
 #include <QPointer>
@@ -30,10 +32,19 @@ public:
     void render(GLFramebuffer *target) override;
     void render(spa_data *spa, spa_video_format format) override;
     std::chrono::nanoseconds clock() const override;
+    RenderLoop *renderLoop() const override;
 
 private:
+    void renderWindow(GLFramebuffer *target, const QRegion &region = infiniteRegion());
+    GLTexture *ensureFrame();
+
     QPointer<Window> m_window;
     WindowOffscreenRenderRef m_offscreenRef;
+    // the window is rendered once per damage, streams sharing this source copy the frame.
+    // Only the parts of the frame that have been damaged are repainted, in window coordinates
+    std::unique_ptr<GLTexture> m_frameTexture;
+    std::unique_ptr<GLFramebuffer> m_frameTarget;
+    QRegion m_frameDamage = infiniteRegion();
 };
 
 } // namespace KWin
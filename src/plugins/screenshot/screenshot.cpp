@@ -11,26 +11,34 @@
 #include "screenshot.h"
 #include "screenshotdbusinterface2.h"
 
+#include "core/outputbackend.h"
+#include "dmabuftexture.h"
 #include "libkwineffects/kwinglplatform.h"
 #include "libkwineffects/kwinglutils.h"
 #include "libkwineffects/rendertarget.h"
 #include "libkwineffects/renderviewport.h"
+#include "main.h"
+#include "platformsupport/scenes/opengl/eglnativefence.h"
 
+#include <QCoreApplication>
 #include <QPainter>
+#include <QSocketNotifier>
+
+#include <drm_fourcc.h>
 
 namespace KWin
 {
 
 struct ScreenShotWindowData
 {
-    QPromise<QImage> promise;
+    QPromise<ScreenShotResult> promise;
     ScreenShotFlags flags;
     EffectWindow *window = nullptr;
 };
 
 struct ScreenShotAreaData
 {
-    QPromise<QImage> promise;
+    QPromise<ScreenShotResult> promise;
     ScreenShotFlags flags;
     QRect area;
     QImage result;
@@ -39,11 +47,62 @@ struct ScreenShotAreaData
 
 struct ScreenShotScreenData
 {
-    QPromise<QImage> promise;
+    QPromise<ScreenShotResult> promise;
     ScreenShotFlags flags;
     EffectScreen *screen = nullptr;
 };
 
+struct ScreenShotReadback
+{
+    QPromise<ScreenShotResult> promise;
+    ScreenShotFlags flags;
+    std::unique_ptr<EGLNativeFence> fence;
+    std::unique_ptr<QSocketNotifier> notifier;
+    // the pixels are read into a pixel buffer, or copied into a dmabuf
+    GLuint pixelBuffer = 0;
+    std::shared_ptr<DmaBufTexture> dmabuf;
+    QSize size;
+    qreal devicePixelRatio = 1.0;
+    QPoint cursorOffset;
+};
+
+static void releasePixelBuffer(void *info)
+{
+    // the image can be released on the thread that has written it to the pipe
+    const GLuint pixelBuffer = reinterpret_cast<uintptr_t>(info);
+    QMetaObject::invokeMethod(
+        QCoreApplication::instance(), [pixelBuffer]() {
+            if (!effects) {
+                return;
+            }
+            effects->makeOpenGLContextCurrent();
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glDeleteBuffers(1, &pixelBuffer);
+        },
+        Qt::QueuedConnection);
+}
+
+/**
+ * Returns an image that refers to the mapping of the given @a pixelBuffer, so the pixels can
+ * be written to the pipe without copying them. The buffer is deleted with the image.
+ */
+static QImage mapPixelBuffer(GLuint pixelBuffer, const QSize &size)
+{
+    const int stride = size.width() * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+    // the cursor may be painted over the pixels
+    void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, stride * size.height(), GL_MAP_READ_BIT | GL_MAP_WRITE_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!data) {
+        glDeleteBuffers(1, &pixelBuffer);
+        return QImage();
+    }
+    return QImage(static_cast<uchar *>(data), size.width(), size.height(), stride, QImage::Format_RGBA8888,
+                  releasePixelBuffer, reinterpret_cast<void *>(uintptr_t(pixelBuffer)));
+}
+
 static void convertFromGLImage(QImage &img, int w, int h, const QMatrix4x4 &renderTargetTransformation)
 {
     // from QtOpenGL/qgl.cpp
@@ -98,9 +157,18 @@ ScreenShotEffect::~ScreenShotEffect()
     cancelWindowScreenShots();
     cancelAreaScreenShots();
     cancelScreenScreenShots();
+
+    if (!m_readbacks.empty()) {
+        effects->makeOpenGLContextCurrent();
+        for (const auto &readback : m_readbacks) {
+            if (readback->pixelBuffer) {
+                glDeleteBuffers(1, &readback->pixelBuffer);
+            }
+        }
+    }
 }
 
-QFuture<QImage> ScreenShotEffect::scheduleScreenShot(EffectScreen *screen, ScreenShotFlags flags)
+QFuture<ScreenShotResult> ScreenShotEffect::scheduleScreenShot(EffectScreen *screen, ScreenShotFlags flags)
 {
     for (const ScreenShotScreenData &data : m_screenScreenShots) {
         if (data.screen == screen && data.flags == flags) {
@@ -113,7 +181,7 @@ QFuture<QImage> ScreenShotEffect::scheduleScreenShot(EffectScreen *screen, Scree
     data.flags = flags;
 
     data.promise.start();
-    QFuture<QImage> future = data.promise.future();
+    QFuture<ScreenShotResult> future = data.promise.future();
 
     m_screenScreenShots.push_back(std::move(data));
     effects->addRepaint(screen->geometry());
@@ -121,7 +189,7 @@ QFuture<QImage> ScreenShotEffect::scheduleScreenShot(EffectScreen *screen, Scree
     return future;
 }
 
-QFuture<QImage> ScreenShotEffect::scheduleScreenShot(const QRect &area, ScreenShotFlags flags)
+QFuture<ScreenShotResult> ScreenShotEffect::scheduleScreenShot(const QRect &area, ScreenShotFlags flags)
 {
     for (const ScreenShotAreaData &data : m_areaScreenShots) {
         if (data.area == area && data.flags == flags) {
@@ -154,7 +222,7 @@ QFuture<QImage> ScreenShotEffect::scheduleScreenShot(const QRect &area, ScreenSh
     data.result.setDevicePixelRatio(devicePixelRatio);
 
     data.promise.start();
-    QFuture<QImage> future = data.promise.future();
+    QFuture<ScreenShotResult> future = data.promise.future();
 
     m_areaScreenShots.push_back(std::move(data));
     effects->addRepaint(area);
@@ -162,7 +230,7 @@ QFuture<QImage> ScreenShotEffect::scheduleScreenShot(const QRect &area, ScreenSh
     return future;
 }
 
-QFuture<QImage> ScreenShotEffect::scheduleScreenShot(EffectWindow *window, ScreenShotFlags flags)
+QFuture<ScreenShotResult> ScreenShotEffect::scheduleScreenShot(EffectWindow *window, ScreenShotFlags flags)
 {
     for (const ScreenShotWindowData &data : m_windowScreenShots) {
         if (data.window == window && data.flags == flags) {
@@ -175,7 +243,7 @@ QFuture<QImage> ScreenShotEffect::scheduleScreenShot(EffectWindow *window, Scree
     data.flags = flags;
 
     data.promise.start();
-    QFuture<QImage> future = data.promise.future();
+    QFuture<ScreenShotResult> future = data.promise.future();
 
     m_windowScreenShots.push_back(std::move(data));
     window->addRepaintFull();
@@ -267,6 +335,13 @@ void ScreenShotEffect::takeScreenShot(ScreenShotWindowData *screenshot)
 
             effects->drawWindow(renderTarget, viewport, window, mask, infiniteRegion(), d);
 
+            if (canReadbackNative(renderTarget, screenshot->flags)) {
+                readbackNative(QRect(QPoint(0, 0), offscreenTexture->size()), offscreenTexture->size(), devicePixelRatio, renderTarget,
+                               screenshot->flags, geometry.topLeft().toPoint(), std::move(screenshot->promise));
+                GLFramebuffer::popFramebuffer();
+                return;
+            }
+
             // copy content from framebuffer into image
             img = QImage(offscreenTexture->size(), QImage::Format_ARGB32);
             img.setDevicePixelRatio(devicePixelRatio);
@@ -280,7 +355,7 @@ void ScreenShotEffect::takeScreenShot(ScreenShotWindowData *screenshot)
             grabPointerImage(img, geometry.x(), geometry.y());
         }
 
-        screenshot->promise.addResult(img);
+        screenshot->promise.addResult(ScreenShotResult{.image = img});
         screenshot->promise.finish();
     }
 }
@@ -293,7 +368,7 @@ bool ScreenShotEffect::takeScreenShot(const RenderTarget &renderTarget, const Re
         if (screenshot->flags & ScreenShotIncludeCursor) {
             grabPointerImage(snapshot, screenshot->area.x(), screenshot->area.y());
         }
-        screenshot->promise.addResult(snapshot);
+        screenshot->promise.addResult(ScreenShotResult{.image = snapshot});
         screenshot->promise.finish();
         return true;
     } else {
@@ -321,7 +396,7 @@ bool ScreenShotEffect::takeScreenShot(const RenderTarget &renderTarget, const Re
             if (screenshot->flags & ScreenShotIncludeCursor) {
                 grabPointerImage(screenshot->result, screenshot->area.x(), screenshot->area.y());
             }
-            screenshot->promise.addResult(screenshot->result);
+            screenshot->promise.addResult(ScreenShotResult{.image = screenshot->result});
             screenshot->promise.finish();
             return true;
         }
@@ -341,6 +416,13 @@ bool ScreenShotEffect::takeScreenShot(const RenderTarget &renderTarget, const Re
         devicePixelRatio = screenshot->screen->devicePixelRatio();
     }
 
+    if (canReadbackNative(renderTarget, screenshot->flags)) {
+        const QRect geometry = screenshot->screen->geometry();
+        readbackNative(viewport.mapToRenderTarget(geometry), geometry.size() * devicePixelRatio, devicePixelRatio, renderTarget,
+                       screenshot->flags, geometry.topLeft(), std::move(screenshot->promise));
+        return true;
+    }
+
     QImage snapshot = blitScreenshot(renderTarget, viewport, screenshot->screen->geometry(), devicePixelRatio);
     if (screenshot->flags & ScreenShotIncludeCursor) {
         const int xOffset = screenshot->screen->geometry().x();
@@ -348,12 +430,140 @@ bool ScreenShotEffect::takeScreenShot(const RenderTarget &renderTarget, const Re
         grabPointerImage(snapshot, xOffset, yOffset);
     }
 
-    screenshot->promise.addResult(snapshot);
+    screenshot->promise.addResult(ScreenShotResult{.image = snapshot});
     screenshot->promise.finish();
 
     return true;
 }
 
+static TextureTransforms contentTransforms(const RenderTarget &renderTarget)
+{
+    const GLTexture *texture = renderTarget.framebuffer() ? renderTarget.framebuffer()->colorAttachment() : nullptr;
+    return texture ? texture->contentTransforms() : TextureTransforms();
+}
+
+/**
+ * The pixels can be handed over as the GPU has produced them if the contents aren't rotated.
+ * The rows of OpenGL framebuffers go from the bottom to the top and are flipped by the blit
+ * that copies them, the ones of imported buffers, e.g. of the outputs, are already in order.
+ */
+bool ScreenShotEffect::canReadbackNative(const RenderTarget &renderTarget, ScreenShotFlags flags) const
+{
+    if (!(flags & (ScreenShotNativeFormat | ScreenShotDmaBuf)) || !effects->isOpenGLCompositing() || !GLFramebuffer::blitSupported()) {
+        return false;
+    }
+    const TextureTransforms transforms = contentTransforms(renderTarget);
+    return transforms == TextureTransforms() || transforms == TextureTransform::MirrorY;
+}
+
+/**
+ * Copies @a sourceRect of the current framebuffer into a buffer of the given @a size, without
+ * converting the pixels on the CPU. If possible, the pixels are read back asynchronously and
+ * the @a promise is fulfilled once the GPU has finished copying them.
+ */
+void ScreenShotEffect::readbackNative(const QRect &sourceRect, const QSize &size, qreal devicePixelRatio, const RenderTarget &renderTarget,
+                                      ScreenShotFlags flags, const QPoint &cursorOffset, QPromise<ScreenShotResult> &&promise)
+{
+    auto readback = std::make_unique<ScreenShotReadback>(ScreenShotReadback{
+        .promise = std::move(promise),
+        .flags = flags,
+        .size = size,
+        .devicePixelRatio = devicePixelRatio,
+        .cursorOffset = cursorOffset,
+    });
+
+    if (flags & ScreenShotDmaBuf) {
+        readback->dmabuf = kwinApp()->outputBackend()->createDmaBufTexture(size, DRM_FORMAT_ABGR8888, DRM_FORMAT_MOD_INVALID);
+    }
+
+    std::unique_ptr<GLTexture> texture;
+    std::unique_ptr<GLFramebuffer> framebuffer;
+    GLFramebuffer *target = nullptr;
+    if (readback->dmabuf) {
+        target = readback->dmabuf->framebuffer();
+    } else {
+        texture = std::make_unique<GLTexture>(GL_RGBA8, size);
+        framebuffer = std::make_unique<GLFramebuffer>(texture.get());
+        target = framebuffer.get();
+    }
+    const bool flip = !(contentTransforms(renderTarget) & TextureTransform::MirrorY);
+    target->blitFromFramebuffer(sourceRect, QRect(), GL_LINEAR, false, flip);
+
+    if (!readback->dmabuf) {
+        GLFramebuffer::pushFramebuffer(target);
+        if (!hasGLVersion(3, 0)) {
+            // without pixel buffers and fences, the pixels are read back right away
+            QImage image(size, QImage::Format_RGBA8888);
+            glReadnPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, image.sizeInBytes(), image.bits());
+            GLFramebuffer::popFramebuffer();
+
+            image.setDevicePixelRatio(devicePixelRatio);
+            if (flags & ScreenShotIncludeCursor) {
+                grabPointerImage(image, cursorOffset.x(), cursorOffset.y());
+            }
+            readback->promise.addResult(ScreenShotResult{.image = image});
+            readback->promise.finish();
+            return;
+        }
+
+        glGenBuffers(1, &readback->pixelBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size.width() * 4 * size.height(), nullptr, GL_STREAM_READ);
+        glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        GLFramebuffer::popFramebuffer();
+    }
+
+    ScreenShotReadback *pending = readback.get();
+    m_readbacks.push_back(std::move(readback));
+
+    pending->fence = std::make_unique<EGLNativeFence>(kwinApp()->outputBackend()->sceneEglDisplay());
+    if (!pending->fence->isValid()) {
+        // without native fences, there is nothing to watch
+        glFinish();
+        finishReadback(pending);
+        return;
+    }
+    glFlush();
+
+    pending->notifier = std::make_unique<QSocketNotifier>(pending->fence->fileDescriptor().get(), QSocketNotifier::Read);
+    connect(pending->notifier.get(), &QSocketNotifier::activated, this, [this, pending]() {
+        pending->notifier->setEnabled(false);
+        // finishing the readback destroys the notifier
+        QMetaObject::invokeMethod(
+            this, [this, pending]() {
+                finishReadback(pending);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void ScreenShotEffect::finishReadback(ScreenShotReadback *readback)
+{
+    effects->makeOpenGLContextCurrent();
+
+    ScreenShotResult result{
+        .dmabuf = readback->dmabuf,
+        .devicePixelRatio = readback->devicePixelRatio,
+    };
+    if (!readback->dmabuf) {
+        result.image = mapPixelBuffer(readback->pixelBuffer, readback->size);
+        result.image.setDevicePixelRatio(readback->devicePixelRatio);
+        if (!result.image.isNull() && (readback->flags & ScreenShotIncludeCursor)) {
+            grabPointerImage(result.image, readback->cursorOffset.x(), readback->cursorOffset.y());
+        }
+        // the buffer is owned by the image now
+        readback->pixelBuffer = 0;
+    }
+
+    readback->promise.addResult(result);
+    readback->promise.finish();
+
+    std::erase_if(m_readbacks, [readback](const auto &pending) {
+        return pending.get() == readback;
+    });
+}
+
 QImage ScreenShotEffect::blitScreenshot(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRect &geometry, qreal devicePixelRatio) const
 {
     QImage image;
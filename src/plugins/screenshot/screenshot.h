@@ -15,10 +15,15 @@
 #include <QFuture>
 #include <QImage>
 #include <QObject>
+#include <QPromise>
+
+#include <memory>
 
 namespace KWin
 {
 
+class DmaBufTexture;
+
 /**
  * This enum type is used to specify how a screenshot needs to be taken.
  */
@@ -26,13 +31,31 @@ enum ScreenShotFlag {
     ScreenShotIncludeDecoration = 0x1, ///< Include window titlebar and borders
     ScreenShotIncludeCursor = 0x2, ///< Include the cursor
     ScreenShotNativeResolution = 0x4, ///< Take the screenshot at the native resolution
+    ScreenShotNativeFormat = 0x8, ///< Keep the pixels in the format of the GPU, RGBA in byte order
+    ScreenShotDmaBuf = 0x10, ///< Put the pixels in a dmabuf rather than in the memory
 };
 Q_DECLARE_FLAGS(ScreenShotFlags, ScreenShotFlag)
 
+/**
+ * The ScreenShotResult type holds the contents of a screenshot. If ScreenShotDmaBuf has been
+ * requested and a dmabuf could be allocated, the contents are in the dmabuf and the image is
+ * null.
+ *
+ * If ScreenShotNativeFormat or ScreenShotDmaBuf has been requested, the pixels may not have
+ * been converted to a QImage friendly format, check QImage::format() or the dmabuf attributes.
+ */
+struct ScreenShotResult
+{
+    QImage image;
+    std::shared_ptr<DmaBufTexture> dmabuf;
+    qreal devicePixelRatio = 1.0;
+};
+
 class ScreenShotDBusInterface2;
 struct ScreenShotWindowData;
 struct ScreenShotAreaData;
 struct ScreenShotScreenData;
+struct ScreenShotReadback;
 
 /**
  * The ScreenShotEffect provides a convenient way to capture the contents of a given window,
@@ -52,23 +75,23 @@ public:
 
     /**
      * Schedules a screenshot of the given @a screen. The returned QFuture can be used to query
-     * the image data. If the screen is removed before the screenshot is taken, the future will
+     * the screenshot. If the screen is removed before the screenshot is taken, the future will
      * be cancelled.
      */
-    QFuture<QImage> scheduleScreenShot(EffectScreen *screen, ScreenShotFlags flags = {});
+    QFuture<ScreenShotResult> scheduleScreenShot(EffectScreen *screen, ScreenShotFlags flags = {});
 
     /**
      * Schedules a screenshot of the given @a area. The returned QFuture can be used to query the
-     * image data.
+     * screenshot.
      */
-    QFuture<QImage> scheduleScreenShot(const QRect &area, ScreenShotFlags flags = {});
+    QFuture<ScreenShotResult> scheduleScreenShot(const QRect &area, ScreenShotFlags flags = {});
 
     /**
      * Schedules a screenshot of the given @a window. The returned QFuture can be used to query
-     * the image data. If the window is removed before the screenshot is taken, the future will
+     * the screenshot. If the window is removed before the screenshot is taken, the future will
      * be cancelled.
      */
-    QFuture<QImage> scheduleScreenShot(EffectWindow *window, ScreenShotFlags flags = {});
+    QFuture<ScreenShotResult> scheduleScreenShot(EffectWindow *window, ScreenShotFlags flags = {});
 
     void paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, EffectScreen *screen) override;
     bool isActive() const override;
@@ -92,10 +115,16 @@ private:
 
     void grabPointerImage(QImage &snapshot, int xOffset, int yOffset) const;
     QImage blitScreenshot(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRect &geometry, qreal devicePixelRatio = 1.0) const;
+    bool canReadbackNative(const RenderTarget &renderTarget, ScreenShotFlags flags) const;
+    void readbackNative(const QRect &sourceRect, const QSize &size, qreal devicePixelRatio, const RenderTarget &renderTarget,
+                        ScreenShotFlags flags, const QPoint &cursorOffset, QPromise<ScreenShotResult> &&promise);
+    void finishReadback(ScreenShotReadback *readback);
 
     std::vector<ScreenShotWindowData> m_windowScreenShots;
     std::vector<ScreenShotAreaData> m_areaScreenShots;
     std::vector<ScreenShotScreenData> m_screenScreenShots;
+    // the native screenshots of which the GPU hasn't finished copying the pixels yet
+    std::vector<std::unique_ptr<ScreenShotReadback>> m_readbacks;
 
     std::unique_ptr<ScreenShotDBusInterface2> m_dbusInterface2;
     EffectScreen *m_paintedScreen = nullptr;
@@ -7,6 +7,7 @@
 */
 
 #include "screenshotdbusinterface2.h"
+#include "dmabuftexture.h"
 #include "screenshot2adaptor.h"
 #include "screenshotlogging.h"
 #include "utils/filedescriptor.h"
@@ -16,6 +17,7 @@
 
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
+#include <QDBusUnixFileDescriptor>
 #include <QThreadPool>
 
 #include <errno.h>
@@ -117,6 +119,16 @@ static ScreenShotFlags screenShotFlagsFromOptions(const QVariantMap &options)
         flags |= ScreenShotNativeResolution;
     }
 
+    const QVariant nativeFormat = options.value(QStringLiteral("native-format"));
+    if (nativeFormat.toBool()) {
+        flags |= ScreenShotNativeFormat;
+    }
+
+    const QVariant dmabuf = options.value(QStringLiteral("dmabuf"));
+    if (dmabuf.toBool()) {
+        flags |= ScreenShotDmaBuf;
+    }
+
     return flags;
 }
 
@@ -142,7 +154,7 @@ class ScreenShotSource2 : public QObject
     Q_OBJECT
 
 public:
-    explicit ScreenShotSource2(const QFuture<QImage> &future);
+    explicit ScreenShotSource2(const QFuture<ScreenShotResult> &future);
 
     bool isCancelled() const;
     bool isCompleted() const;
@@ -155,8 +167,8 @@ Q_SIGNALS:
     void completed();
 
 private:
-    QFuture<QImage> m_future;
-    QFutureWatcher<QImage> *m_watcher;
+    QFuture<ScreenShotResult> m_future;
+    QFutureWatcher<ScreenShotResult> *m_watcher;
 };
 
 class ScreenShotSourceScreen2 : public ScreenShotSource2
@@ -201,19 +213,19 @@ public:
     ScreenShotSinkPipe2(int fileDescriptor, QDBusMessage replyMessage);
 
     void cancel();
-    void flush(const QImage &image, const QVariantMap &attributes);
+    void flush(const ScreenShotResult &result, const QVariantMap &attributes);
 
 private:
     QDBusMessage m_replyMessage;
     FileDescriptor m_fileDescriptor;
 };
 
-ScreenShotSource2::ScreenShotSource2(const QFuture<QImage> &future)
+ScreenShotSource2::ScreenShotSource2(const QFuture<ScreenShotResult> &future)
     : m_future(future)
 {
-    m_watcher = new QFutureWatcher<QImage>(this);
-    connect(m_watcher, &QFutureWatcher<QImage>::finished, this, &ScreenShotSource2::completed);
-    connect(m_watcher, &QFutureWatcher<QImage>::canceled, this, &ScreenShotSource2::cancelled);
+    m_watcher = new QFutureWatcher<ScreenShotResult>(this);
+    connect(m_watcher, &QFutureWatcher<ScreenShotResult>::finished, this, &ScreenShotSource2::completed);
+    connect(m_watcher, &QFutureWatcher<ScreenShotResult>::canceled, this, &ScreenShotSource2::cancelled);
     m_watcher->setFuture(m_future);
 }
 
@@ -286,7 +298,7 @@ void ScreenShotSinkPipe2::cancel()
                                                                        s_errorCancelledMessage));
 }
 
-void ScreenShotSinkPipe2::flush(const QImage &image, const QVariantMap &attributes)
+void ScreenShotSinkPipe2::flush(const ScreenShotResult &result, const QVariantMap &attributes)
 {
     if (!m_fileDescriptor.isValid()) {
         return;
@@ -294,6 +306,24 @@ void ScreenShotSinkPipe2::flush(const QImage &image, const QVariantMap &attribut
 
     // Note that the type of the data stored in the vardict matters. Be careful.
     QVariantMap results = attributes;
+    if (result.dmabuf) {
+        // the dmabuf is handed over with the reply, nothing gets written to the pipe
+        const DmaBufAttributes &dmabufAttributes = result.dmabuf->attributes();
+        results.insert(QStringLiteral("type"), QStringLiteral("dmabuf"));
+        results.insert(QStringLiteral("fd"), QVariant::fromValue(QDBusUnixFileDescriptor(dmabufAttributes.fd[0].get())));
+        results.insert(QStringLiteral("format"), quint32(dmabufAttributes.format));
+        results.insert(QStringLiteral("modifier"), quint64(dmabufAttributes.modifier));
+        results.insert(QStringLiteral("width"), quint32(dmabufAttributes.width));
+        results.insert(QStringLiteral("height"), quint32(dmabufAttributes.height));
+        results.insert(QStringLiteral("stride"), quint32(dmabufAttributes.pitch[0]));
+        results.insert(QStringLiteral("offset"), quint32(dmabufAttributes.offset[0]));
+        results.insert(QStringLiteral("scale"), double(result.devicePixelRatio));
+        QDBusConnection::sessionBus().send(m_replyMessage.createReply(results));
+        m_fileDescriptor = FileDescriptor();
+        return;
+    }
+
+    const QImage &image = result.image;
     results.insert(QStringLiteral("type"), QStringLiteral("raw"));
     results.insert(QStringLiteral("format"), quint32(image.format()));
     results.insert(QStringLiteral("width"), quint32(image.width()));
@@ -325,7 +355,7 @@ ScreenShotDBusInterface2::~ScreenShotDBusInterface2()
 
 int ScreenShotDBusInterface2::version() const
 {
-    return 4;
+    return 5;
 }
 
 bool ScreenShotDBusInterface2::checkPermissions() const
@@ -26,6 +26,23 @@ namespace KWin
 ScreenTransformEffect::ScreenTransformEffect()
     : Effect()
 {
+    const QList<EffectScreen *> screens = effects->screens();
+    for (auto screen : screens) {
+        addScreen(screen);
+    }
+    connect(effects, &EffectsHandler::screenAdded, this, &ScreenTransformEffect::addScreen);
+    connect(effects, &EffectsHandler::screenRemoved, this, &ScreenTransformEffect::removeScreen);
+}
+
+ScreenTransformEffect::~ScreenTransformEffect() = default;
+
+void ScreenTransformEffect::ensureShader()
+{
+    // The shader is only needed once a screen is rotated, which usually never happens
+    if (m_shader) {
+        return;
+    }
+
     // Make sure that shaders in /effects/screentransform/shaders/* are loaded.
     ensureResources();
 
@@ -38,17 +55,8 @@ ScreenTransformEffect::ScreenTransformEffect()
     m_blendFactorLocation = m_shader->uniformLocation("blendFactor");
     m_previousTextureLocation = m_shader->uniformLocation("previousTexture");
     m_currentTextureLocation = m_shader->uniformLocation("currentTexture");
-
-    const QList<EffectScreen *> screens = effects->screens();
-    for (auto screen : screens) {
-        addScreen(screen);
-    }
-    connect(effects, &EffectsHandler::screenAdded, this, &ScreenTransformEffect::addScreen);
-    connect(effects, &EffectsHandler::screenRemoved, this, &ScreenTransformEffect::removeScreen);
 }
 
-ScreenTransformEffect::~ScreenTransformEffect() = default;
-
 bool ScreenTransformEffect::supported()
 {
     return effects->compositingType() == OpenGLCompositing && effects->waylandDisplay() && effects->animationsSupported();
@@ -81,6 +89,7 @@ void ScreenTransformEffect::addScreen(EffectScreen *screen)
     });
     connect(screen, &EffectScreen::aboutToChange, this, [this, screen] {
         effects->makeOpenGLContextCurrent();
+        ensureShader();
         auto &state = m_states[screen];
         state.m_oldTransform = screen->transform();
         state.m_oldGeometry = screen->geometry();
@@ -55,6 +55,7 @@ private:
 
     void addScreen(EffectScreen *screen);
     void removeScreen(EffectScreen *screen);
+    void ensureShader();
 
     QHash<EffectScreen *, ScreenState> m_states;
 
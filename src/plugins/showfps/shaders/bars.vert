@@ -0,0 +1,18 @@
+uniform mat4 modelViewProjectionMatrix;
+// the values of the bars in a ring buffer, bar n shows the value at (n + historyOffset),
+// and the scale that maps them to the height of the graph
+uniform float values[100];
+uniform float historyOffset;
+uniform float valueScale;
+// the bottom and the height of the graph
+uniform vec2 graph;
+
+attribute vec4 position;
+attribute vec4 texcoord;
+
+void main()
+{
+    int index = int(mod(texcoord.x + historyOffset, 100.0));
+    float height = clamp(values[index] * valueScale, 0.0, 1.0) * graph.y;
+    gl_Position = modelViewProjectionMatrix * vec4(position.x, graph.x - position.y * height, 0.0, 1.0);
+}
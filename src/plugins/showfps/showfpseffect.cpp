@@ -7,53 +7,46 @@
 */
 
 #include "showfpseffect.h"
+#include "libkwineffects/kwingltexture.h"
+#include "libkwineffects/kwinglutils.h"
 #include "libkwineffects/renderviewport.h"
 
-#include <QQmlContext>
+#include <QFontDatabase>
+#include <QFontMetricsF>
+#include <QPainter>
 
-namespace KWin
-{
+#include <cmath>
 
-ShowFpsEffect::ShowFpsEffect()
+static void ensureResources()
 {
+    // Must initialize resources manually because the effect is a static lib.
+    Q_INIT_RESOURCE(showfps);
 }
 
-ShowFpsEffect::~ShowFpsEffect() = default;
-
-int ShowFpsEffect::fps() const
+namespace KWin
 {
-    return m_fps;
-}
 
-int ShowFpsEffect::maximumFps() const
-{
-    return m_maximumFps;
-}
+static const QSize s_overlaySize(300, 150);
+static const int s_padding = 4;
+static const int s_barWidth = s_overlaySize.width() / ShowFpsEffect::historySize;
+static const QString s_glyphs = QStringLiteral(" 0123456789.abcdefghijklmnopqrstuvwxyz");
 
-int ShowFpsEffect::paintDuration() const
-{
-    return m_paintDuration;
-}
+static const QColor s_backgroundColor(0, 0, 0, 160);
+static const QColor s_gpuTimeColor(255, 128, 0);
+static const QColor s_cpuTimeColor(0, 192, 255);
 
-int ShowFpsEffect::paintAmount() const
+ShowFpsEffect::ShowFpsEffect()
 {
-    return m_paintAmount;
 }
 
-QColor ShowFpsEffect::paintColor() const
-{
-    auto normalizedDuration = std::min(1.0, m_paintDuration / 100.0);
-    return QColor::fromHsvF(0.3 - (0.3 * normalizedDuration), 1.0, 1.0);
-}
+ShowFpsEffect::~ShowFpsEffect() = default;
 
 void ShowFpsEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
 {
     effects->prePaintScreen(data, presentTime);
 
-    m_newFps += 1;
-
-    m_paintDurationTimer.restart();
-    m_paintAmount = 0;
+    m_paintStart = std::chrono::steady_clock::now();
+    m_presentTime = presentTime;
 
     // detect highest monitor refresh rate
     int maximumFps = 0;
@@ -61,58 +54,238 @@ void ShowFpsEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::millis
     for (auto screen : screens) {
         maximumFps = std::max(screen->refreshRate(), maximumFps);
     }
-    maximumFps /= 1000; // Convert from mHz to Hz.
+    m_maximumFps = maximumFps / 1000; // Convert from mHz to Hz.
 
-    if (maximumFps != m_maximumFps) {
-        m_maximumFps = maximumFps;
-        Q_EMIT maximumFpsChanged();
+    // A frame was dropped if it's presented more than one and a half refresh cycles after the
+    // previous one. The overlay is repainted continuously, so there's always a previous one
+    if (m_maximumFps > 0 && m_lastPresentTime != std::chrono::milliseconds::zero()) {
+        const auto refreshInterval = std::chrono::duration<double, std::milli>(1000.0 / m_maximumFps);
+        if (presentTime - m_lastPresentTime > refreshInterval * 1.5) {
+            m_droppedFrames++;
+        }
     }
+    m_lastPresentTime = presentTime;
 
-    if (!m_scene) {
-        m_scene = std::make_unique<OffscreenQuickScene>(nullptr);
-        const auto url = QUrl::fromLocalFile(QStandardPaths::locate(QStandardPaths::GenericDataLocation, QStringLiteral("kwin/effects/showfps/qml/main.qml")));
-        m_scene->setSource(url, {{QStringLiteral("effect"), QVariant::fromValue(this)}});
-    }
+    m_current.frames++;
+    m_overlayRegion = QRegion();
 }
 
 void ShowFpsEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, EffectScreen *screen)
 {
+    ensureGraphics(viewport.scale());
+
+    // The result of the previous frame is ready by now, so reading it doesn't stall
+    if (m_renderTimePending) {
+        m_renderTimePending = false;
+        const float gpuTime = std::chrono::duration<float, std::milli>(m_renderTimeQuery->result()).count();
+        m_gpuTimes[(m_historyOffset + historySize - 1) % historySize] = gpuTime;
+        m_current.gpuTime += gpuTime;
+    }
+
+    m_renderTimeQuery->begin();
     effects->paintScreen(renderTarget, viewport, mask, region, screen);
+    m_renderTimeQuery->end();
+    m_renderTimePending = true;
+
+    const QRectF screenRect = viewport.renderRect();
+    const QRect overlayRect(screenRect.x() + screenRect.width() - s_overlaySize.width(), screenRect.y(), s_overlaySize.width(), s_overlaySize.height());
+    paintOverlay(viewport, overlayRect);
+    m_overlayRegion += overlayRect;
+}
+
+void ShowFpsEffect::postPaintScreen()
+{
+    effects->postPaintScreen();
+
+    const auto now = std::chrono::steady_clock::now();
+    const float cpuTime = std::chrono::duration<float, std::milli>(now - m_paintStart).count();
+    // the time that is left until the frame is presented, the presentation time is in the
+    // same clock as std::chrono::steady_clock
+    const float slack = (m_presentTime - std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch())).count();
+
+    m_cpuTimes[m_historyOffset] = cpuTime;
+    m_gpuTimes[m_historyOffset] = 0;
+    m_historyOffset = (m_historyOffset + 1) % historySize;
+
+    m_current.cpuTime += cpuTime;
+    m_current.slack = m_current.frames == 1 ? slack : std::min(m_current.slack, slack);
 
-    auto now = std::chrono::steady_clock::now();
-    if ((now - m_lastFpsTime) >= std::chrono::milliseconds(1000)) {
-        m_fps = m_newFps;
-        m_newFps = 0;
-        m_lastFpsTime = now;
-        Q_EMIT fpsChanged();
+    if (now - m_lastSecond >= std::chrono::seconds(1)) {
+        m_shown = m_current;
+        m_current = Statistics();
+        m_lastSecond = now;
+        m_textDirty = true;
     }
 
-    const auto rect = viewport.renderRect();
-    m_scene->setGeometry(QRect(rect.x() + rect.width() - 300, 0, 300, 150));
-    effects->renderOffscreenQuickView(renderTarget, viewport, m_scene.get());
+    effects->addRepaint(m_overlayRegion);
 }
 
-void ShowFpsEffect::paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, QRegion region, WindowPaintData &data)
+void ShowFpsEffect::ensureGraphics(qreal scale)
 {
-    effects->paintWindow(renderTarget, viewport, w, mask, region, data);
-
-    // Take intersection of region and actual window's rect, minus the fps area
-    //  (since we keep repainting it) and count the pixels.
-    QRegion repaintRegion = region & w->frameGeometry().toRect();
-    repaintRegion -= m_scene->geometry();
-    for (const QRect &rect : repaintRegion) {
-        m_paintAmount += rect.width() * rect.height();
+    if (!m_renderTimeQuery) {
+        m_renderTimeQuery = std::make_unique<GLRenderTimeQuery>();
+    }
+
+    if (!m_barBuffer) {
+        ensureResources();
+        m_barShader = ShaderManager::instance()->generateShaderFromFile(ShaderTrait::UniformColor,
+                                                                        QStringLiteral(":/effects/showfps/shaders/bars.vert"), QString());
+        if (m_barShader->isValid()) {
+            m_valuesLocation = m_barShader->uniformLocation("values");
+            m_historyOffsetLocation = m_barShader->uniformLocation("historyOffset");
+            m_valueScaleLocation = m_barShader->uniformLocation("valueScale");
+            m_graphLocation = m_barShader->uniformLocation("graph");
+        }
+
+        // The bars never change, their heights are looked up by the vertex shader. The x
+        // coordinate is in pixels, the y coordinate is 0 for the bottom and 1 for the top
+        QVector<float> vertices;
+        QVector<float> texcoords;
+        vertices.reserve(historySize * 12);
+        texcoords.reserve(historySize * 12);
+        for (int i = 0; i < historySize; ++i) {
+            const float left = i * s_barWidth;
+            const float right = left + s_barWidth - 1;
+            vertices << right << 0 << left << 0 << left << 1;
+            vertices << left << 1 << right << 1 << right << 0;
+            for (int j = 0; j < 6; ++j) {
+                texcoords << i << 0;
+            }
+        }
+        m_barBuffer = std::make_unique<GLVertexBuffer>(GLVertexBuffer::Static);
+        m_barBuffer->setData(historySize * 6, 2, vertices.constData(), texcoords.constData());
+
+        const float background[] = {
+            float(s_overlaySize.width()), 0,
+            0, 0,
+            0, float(s_overlaySize.height()),
+            0, float(s_overlaySize.height()),
+            float(s_overlaySize.width()), float(s_overlaySize.height()),
+            float(s_overlaySize.width()), 0};
+        m_backgroundBuffer = std::make_unique<GLVertexBuffer>(GLVertexBuffer::Static);
+        m_backgroundBuffer->setData(6, 2, background, nullptr);
+
+        m_textBuffer = std::make_unique<GLVertexBuffer>(GLVertexBuffer::Dynamic);
+    }
+
+    if (m_glyphAtlasScale != scale) {
+        // The glyphs are drawn in a monospace font, so they all fit the same cell
+        QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+        font.setPixelSize(std::round(12 * scale));
+        const QFontMetricsF metrics(font);
+        const QSize cell(std::ceil(metrics.horizontalAdvance(QLatin1Char('0'))), std::ceil(metrics.height()));
+
+        QImage atlas(cell.width() * s_glyphs.size(), cell.height(), QImage::Format_ARGB32_Premultiplied);
+        atlas.fill(Qt::transparent);
+        QPainter painter(&atlas);
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+        for (int i = 0; i < s_glyphs.size(); ++i) {
+            painter.drawText(QRectF(i * cell.width(), 0, cell.width(), cell.height()), Qt::AlignCenter, s_glyphs.at(i));
+        }
+        painter.end();
+
+        m_glyphAtlas = std::make_unique<GLTexture>(atlas);
+        m_glyphAtlas->setFilter(GL_LINEAR);
+        m_glyphAtlas->setWrapMode(GL_CLAMP_TO_EDGE);
+        m_glyphSize = QSizeF(cell) / scale;
+        m_glyphAtlasScale = scale;
+        m_textDirty = true;
     }
 }
 
-void ShowFpsEffect::postPaintScreen()
+void ShowFpsEffect::updateText()
 {
-    effects->postPaintScreen();
+    const int frames = std::max(m_shown.frames, 1);
+    const QString lines[] = {
+        QStringLiteral("%1 fps  cpu %2 ms  gpu %3 ms")
+            .arg(m_shown.frames)
+            .arg(m_shown.cpuTime / frames, 0, 'f', 1)
+            .arg(m_shown.gpuTime / frames, 0, 'f', 1),
+        QStringLiteral("slack %1 ms  dropped %2")
+            .arg(m_shown.slack, 0, 'f', 1)
+            .arg(m_droppedFrames),
+    };
+
+    const QMatrix4x4 uvMatrix = m_glyphAtlas->matrix(NormalizedCoordinates);
+    const float glyphWidth = 1.0 / s_glyphs.size();
+    QVector<float> vertices;
+    QVector<float> texcoords;
+    for (int line = 0; line < 2; ++line) {
+        const float top = s_padding + line * m_glyphSize.height();
+        const float bottom = top + m_glyphSize.height();
+        for (int i = 0; i < lines[line].size(); ++i) {
+            const int glyph = s_glyphs.indexOf(lines[line].at(i));
+            if (glyph <= 0) {
+                // spaces and unknown characters are skipped
+                continue;
+            }
+            const float left = s_padding + i * m_glyphSize.width();
+            const float right = left + m_glyphSize.width();
+            vertices << right << top << left << top << left << bottom;
+            vertices << left << bottom << right << bottom << right << top;
+
+            const QPointF uvTopLeft = uvMatrix.map(QPointF(glyph * glyphWidth, 0));
+            const QPointF uvBottomRight = uvMatrix.map(QPointF((glyph + 1) * glyphWidth, 1));
+            texcoords << uvBottomRight.x() << uvTopLeft.y() << uvTopLeft.x() << uvTopLeft.y() << uvTopLeft.x() << uvBottomRight.y();
+            texcoords << uvTopLeft.x() << uvBottomRight.y() << uvBottomRight.x() << uvBottomRight.y() << uvBottomRight.x() << uvTopLeft.y();
+        }
+    }
+    m_textBuffer->setData(vertices.size() / 2, 2, vertices.constData(), texcoords.constData());
+    m_textDirty = false;
+}
+
+void ShowFpsEffect::paintOverlay(const RenderViewport &viewport, const QRect &rect)
+{
+    if (m_textDirty) {
+        updateText();
+    }
+
+    // the vertices are in logical coordinates, relative to the top left corner of the overlay
+    QMatrix4x4 projection = viewport.projectionMatrix();
+    projection.scale(viewport.scale(), viewport.scale());
+    projection.translate(rect.x(), rect.y());
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    {
+        ShaderBinder binder(ShaderTrait::UniformColor);
+        binder.shader()->setUniform(GLShader::ModelViewProjectionMatrix, projection);
+        binder.shader()->setUniform(GLShader::Color, QColor::fromRgbF(0, 0, 0, s_backgroundColor.alphaF()));
+        m_backgroundBuffer->render(GL_TRIANGLES);
+    }
+
+    if (m_barShader->isValid()) {
+        // a full bar is one refresh cycle
+        const float graphTop = s_padding * 2 + m_glyphSize.height() * 2;
+        const float valueScale = m_maximumFps > 0 ? m_maximumFps / 1000.0 : 1.0 / 16.0;
+
+        ShaderBinder binder(m_barShader.get());
+        m_barShader->setUniform(GLShader::ModelViewProjectionMatrix, projection);
+        m_barShader->setUniform(m_historyOffsetLocation, float(m_historyOffset));
+        m_barShader->setUniform(m_valueScaleLocation, valueScale);
+        m_barShader->setUniform(m_graphLocation, QVector2D(s_overlaySize.height() - s_padding, s_overlaySize.height() - s_padding - graphTop));
+
+        // the gpu time includes the cpu time, so it's drawn first
+        m_barShader->setUniform(GLShader::Color, s_gpuTimeColor);
+        glUniform1fv(m_valuesLocation, historySize, m_gpuTimes.data());
+        m_barBuffer->render(GL_TRIANGLES);
 
-    m_paintDuration = m_paintDurationTimer.elapsed();
-    Q_EMIT paintChanged();
+        m_barShader->setUniform(GLShader::Color, s_cpuTimeColor);
+        glUniform1fv(m_valuesLocation, historySize, m_cpuTimes.data());
+        m_barBuffer->render(GL_TRIANGLES);
+    }
+
+    {
+        ShaderBinder binder(ShaderTrait::MapTexture);
+        binder.shader()->setUniform(GLShader::ModelViewProjectionMatrix, projection);
+        m_glyphAtlas->bind();
+        m_textBuffer->render(GL_TRIANGLES);
+        m_glyphAtlas->unbind();
+    }
 
-    effects->addRepaint(m_scene->geometry());
+    glDisable(GL_BLEND);
 }
 
 bool ShowFpsEffect::supported()
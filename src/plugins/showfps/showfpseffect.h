@@ -8,57 +8,87 @@
 
 #pragma once
 
+#include "libkwineffects/glrendertimequery.h"
 #include "libkwineffects/kwineffects.h"
-#include "libkwineffects/kwinoffscreenquickview.h"
 
-#include <QElapsedTimer>
+#include <array>
+#include <chrono>
 
 namespace KWin
 {
 
+class GLShader;
+class GLTexture;
+class GLVertexBuffer;
+
+/**
+ * The ShowFpsEffect draws the frame rate and the frame timings in the top right corner of
+ * every screen.
+ *
+ * The overlay is drawn with OpenGL directly, so that it costs as little as possible and doesn't
+ * skew what it measures: the histogram is a pre-built vertex buffer whose bars are scaled by
+ * the vertex shader, and the text is drawn from a glyph atlas and only updated once per second.
+ */
 class ShowFpsEffect : public Effect
 {
     Q_OBJECT
-    Q_PROPERTY(int fps READ fps NOTIFY fpsChanged)
-    Q_PROPERTY(int maximumFps READ maximumFps NOTIFY maximumFpsChanged)
-    Q_PROPERTY(int paintDuration READ paintDuration NOTIFY paintChanged)
-    Q_PROPERTY(int paintAmount READ paintAmount NOTIFY paintChanged)
-    Q_PROPERTY(QColor paintColor READ paintColor NOTIFY paintChanged)
 
 public:
     ShowFpsEffect();
     ~ShowFpsEffect() override;
 
-    int fps() const;
-    int maximumFps() const;
-    int paintDuration() const;
-    int paintAmount() const;
-    QColor paintColor() const;
-
     void prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime) override;
     void paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, EffectScreen *screen) override;
-    void paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, QRegion region, KWin::WindowPaintData &data) override;
     void postPaintScreen() override;
 
     static bool supported();
 
-Q_SIGNALS:
-    void fpsChanged();
-    void maximumFpsChanged();
-    void paintChanged();
+    static constexpr int historySize = 100;
 
 private:
-    std::unique_ptr<OffscreenQuickScene> m_scene;
+    void ensureGraphics(qreal scale);
+    void updateText();
+    void paintOverlay(const RenderViewport &viewport, const QRect &rect);
+
+    std::unique_ptr<GLShader> m_barShader;
+    int m_valuesLocation = -1;
+    int m_historyOffsetLocation = -1;
+    int m_valueScaleLocation = -1;
+    int m_graphLocation = -1;
+    std::unique_ptr<GLVertexBuffer> m_barBuffer;
+    std::unique_ptr<GLVertexBuffer> m_backgroundBuffer;
+    std::unique_ptr<GLVertexBuffer> m_textBuffer;
+    std::unique_ptr<GLTexture> m_glyphAtlas;
+    QSizeF m_glyphSize;
+    qreal m_glyphAtlasScale = 0;
+    bool m_textDirty = true;
+
+    std::unique_ptr<GLRenderTimeQuery> m_renderTimeQuery;
+    bool m_renderTimePending = false;
+
+    // the frame timings in milliseconds, in a ring buffer, the oldest one is at m_historyOffset
+    std::array<float, historySize> m_cpuTimes{};
+    std::array<float, historySize> m_gpuTimes{};
+    int m_historyOffset = 0;
 
     int m_maximumFps = 0;
-
-    int m_fps = 0;
-    int m_newFps = 0;
-    std::chrono::steady_clock::time_point m_lastFpsTime;
-
-    int m_paintDuration = 0;
-    int m_paintAmount = 0;
-    QElapsedTimer m_paintDurationTimer;
+    std::chrono::milliseconds m_lastPresentTime = std::chrono::milliseconds::zero();
+    std::chrono::steady_clock::time_point m_paintStart;
+    std::chrono::milliseconds m_presentTime = std::chrono::milliseconds::zero();
+    QRegion m_overlayRegion;
+
+    // the statistics of the current second, and the ones that are shown
+    struct Statistics
+    {
+        int frames = 0;
+        float cpuTime = 0;
+        float gpuTime = 0;
+        float slack = 0;
+    };
+    Statistics m_current;
+    Statistics m_shown;
+    int m_droppedFrames = 0;
+    std::chrono::steady_clock::time_point m_lastSecond;
 };
 
 } // namespace KWin
@@ -0,0 +1,22 @@
+#version 140
+uniform sampler2D sampler;
+
+in vec2 texcoord0;
+
+out vec4 fragColor;
+
+void main()
+{
+    // the heat is the repaint rate relative to the refresh rate of the output
+    float heat = clamp(texture(sampler, texcoord0).r, 0.0, 1.0);
+
+    vec3 color;
+    if (heat < 0.5) {
+        color = mix(vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 0.0), heat * 2.0);
+    } else {
+        color = mix(vec3(0.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0), heat * 2.0 - 1.0);
+    }
+    float alpha = heat > 0.0 ? 0.2 + 0.4 * heat : 0.0;
+
+    fragColor = vec4(color * alpha, alpha);
+}
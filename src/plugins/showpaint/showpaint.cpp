@@ -10,6 +10,8 @@
 
 #include "showpaint.h"
 
+#include "libkwineffects/kwinglplatform.h"
+#include "libkwineffects/kwingltexture.h"
 #include "libkwineffects/kwinglutils.h"
 #include "libkwineffects/renderviewport.h"
 
@@ -17,8 +19,17 @@
 #include <KLocalizedString>
 
 #include <QAction>
+#include <QDBusConnection>
 #include <QPainter>
 
+#include <cmath>
+
+static void ensureResources()
+{
+    // Must initialize resources manually because the effect is a static lib.
+    Q_INIT_RESOURCE(showpaint);
+}
+
 namespace KWin
 {
 
@@ -31,6 +42,17 @@ static const QVector<QColor> s_colors{
     Qt::magenta,
     Qt::yellow,
     Qt::gray};
+// the heat of a pixel halves every second, unless it's damaged again
+static const qreal s_heatHalfLife = 1.0;
+
+static qint64 regionArea(const QRegion &region)
+{
+    qint64 area = 0;
+    for (const QRect &rect : region) {
+        area += qint64(rect.width()) * rect.height();
+    }
+    return area;
+}
 
 ShowPaintEffect::ShowPaintEffect()
 {
@@ -41,12 +63,40 @@ ShowPaintEffect::ShowPaintEffect()
     KGlobalAccel::self()->setShortcut(toggleAction, {});
 
     connect(toggleAction, &QAction::triggered, this, &ShowPaintEffect::toggle);
+
+    connect(effects, &EffectsHandler::windowDamaged, this, &ShowPaintEffect::slotWindowDamaged);
+    connect(effects, &EffectsHandler::windowDeleted, this, &ShowPaintEffect::slotWindowDeleted);
+    connect(effects, &EffectsHandler::screenRemoved, this, &ShowPaintEffect::slotScreenRemoved);
+
+    QDBusConnection::sessionBus().registerObject(QStringLiteral("/org/kde/KWin/Effect/ShowPaint1"),
+                                                 QStringLiteral("org.kde.KWin.Effect.ShowPaint1"),
+                                                 this,
+                                                 QDBusConnection::ExportScriptableContents);
+}
+
+ShowPaintEffect::~ShowPaintEffect()
+{
+    QDBusConnection::sessionBus().unregisterObject(QStringLiteral("/org/kde/KWin/Effect/ShowPaint1"));
+}
+
+void ShowPaintEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
+{
+    m_presentTime = presentTime;
+    effects->prePaintScreen(data, presentTime);
 }
 
 void ShowPaintEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, EffectScreen *screen)
 {
     m_painted = QRegion();
     effects->paintScreen(renderTarget, viewport, mask, region, screen);
+    if (m_heatmapActive && effects->isOpenGLCompositing()) {
+        Heatmap &heatmap = m_heatmaps[screen];
+        updateHeatmap(heatmap, screen, viewport);
+        paintHeatmap(heatmap, viewport);
+    }
+    if (!m_active) {
+        return;
+    }
     if (effects->isOpenGLCompositing()) {
         paintGL(viewport.projectionMatrix(), viewport.scale());
     } else if (effects->compositingType() == QPainterCompositing) {
@@ -57,6 +107,16 @@ void ShowPaintEffect::paintScreen(const RenderTarget &renderTarget, const Render
     }
 }
 
+void ShowPaintEffect::postPaintScreen()
+{
+    effects->postPaintScreen();
+    if (m_heatmapActive) {
+        // the heat decays even if nothing is damaged, the overlay doesn't damage any window
+        // so repainting it doesn't show up in the heatmap
+        effects->addRepaintFull();
+    }
+}
+
 void ShowPaintEffect::paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, QRegion region, WindowPaintData &data)
 {
     m_painted |= region;
@@ -100,9 +160,127 @@ void ShowPaintEffect::paintQPainter()
     }
 }
 
+void ShowPaintEffect::updateHeatmap(Heatmap &heatmap, EffectScreen *screen, const RenderViewport &viewport)
+{
+    const QRectF geometry = viewport.renderRect();
+    const QSize textureSize = (geometry.size() * viewport.scale()).toSize();
+    if (!heatmap.texture || heatmap.texture->size() != textureSize || heatmap.geometry != geometry) {
+        // The heat is accumulated in a float texture if possible, an 8 bit texture can't
+        // represent the slow decay of rarely damaged areas
+        const bool floatSupported = !GLPlatform::instance()->isGLES() || hasGLExtension(QByteArrayLiteral("GL_EXT_color_buffer_half_float"));
+        heatmap.texture = std::make_unique<GLTexture>(floatSupported ? GL_RGBA16F : GL_RGBA8, textureSize);
+        heatmap.texture->setFilter(GL_LINEAR);
+        heatmap.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+        heatmap.framebuffer = std::make_unique<GLFramebuffer>(heatmap.texture.get());
+        heatmap.geometry = geometry;
+        heatmap.lastPresentTime = m_presentTime;
+
+        GLFramebuffer::pushFramebuffer(heatmap.framebuffer.get());
+        glClearColor(0.0, 0.0, 0.0, 0.0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        GLFramebuffer::popFramebuffer();
+    }
+
+    // y grows downwards in the texture, paintHeatmap() samples it accordingly
+    QMatrix4x4 projection;
+    projection.ortho(geometry.x(), geometry.x() + geometry.width(), geometry.y(), geometry.y() + geometry.height(), -1, 1);
+
+    QVector<float> verts;
+    const auto addRect = [&verts](const QRectF &rect) {
+        verts << rect.x() + rect.width() << rect.y();
+        verts << rect.x() << rect.y();
+        verts << rect.x() << rect.y() + rect.height();
+        verts << rect.x() << rect.y() + rect.height();
+        verts << rect.x() + rect.width() << rect.y() + rect.height();
+        verts << rect.x() + rect.width() << rect.y();
+    };
+
+    GLFramebuffer::pushFramebuffer(heatmap.framebuffer.get());
+    ShaderBinder binder(ShaderTrait::UniformColor);
+    binder.shader()->setUniform(GLShader::ModelViewProjectionMatrix, projection);
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    glEnable(GL_BLEND);
+
+    // The heat is stored relative to the refresh rate, a pixel that's damaged every frame
+    // approaches 1. The heat decays exponentially, dst * decay
+    const qreal elapsed = std::chrono::duration<qreal>(m_presentTime - heatmap.lastPresentTime).count();
+    heatmap.lastPresentTime = m_presentTime;
+    if (elapsed > 0) {
+        const qreal decay = std::exp2(-elapsed / s_heatHalfLife);
+        verts.clear();
+        addRect(geometry);
+        vbo->reset();
+        vbo->setData(verts.count() / 2, 2, verts.data(), nullptr);
+        glBlendFunc(GL_ZERO, GL_SRC_ALPHA);
+        binder.shader()->setUniform(GLShader::Color, QVector4D(0, 0, 0, decay));
+        vbo->render(GL_TRIANGLES);
+    }
+
+    // and each damage adds to it, dst + increment
+    const QRegion damage = heatmap.damage & geometry.toAlignedRect();
+    heatmap.damage = QRegion();
+    if (!damage.isEmpty()) {
+        const qreal refreshRate = screen->refreshRate() > 0 ? screen->refreshRate() / 1000.0 : 60.0;
+        const float increment = std::log(2.0) / (s_heatHalfLife * refreshRate);
+        verts.clear();
+        verts.reserve(damage.rectCount() * 12);
+        for (const QRect &rect : damage) {
+            addRect(rect);
+        }
+        vbo->reset();
+        vbo->setData(verts.count() / 2, 2, verts.data(), nullptr);
+        glBlendFunc(GL_ONE, GL_ONE);
+        binder.shader()->setUniform(GLShader::Color, QVector4D(increment, increment, increment, increment));
+        vbo->render(GL_TRIANGLES);
+    }
+
+    glDisable(GL_BLEND);
+    GLFramebuffer::popFramebuffer();
+}
+
+void ShowPaintEffect::paintHeatmap(const Heatmap &heatmap, const RenderViewport &viewport)
+{
+    if (!m_heatmapShader) {
+        ensureResources();
+        m_heatmapShader = ShaderManager::instance()->generateShaderFromFile(ShaderTrait::MapTexture, QString(), QStringLiteral(":/effects/showpaint/shaders/heatmap.frag"));
+    }
+    if (!m_heatmapShader->isValid()) {
+        return;
+    }
+
+    const QRectF deviceRect = scaledRect(heatmap.geometry, viewport.scale());
+    const float verts[] = {
+        float(deviceRect.x() + deviceRect.width()), float(deviceRect.y()),
+        float(deviceRect.x()), float(deviceRect.y()),
+        float(deviceRect.x()), float(deviceRect.y() + deviceRect.height()),
+        float(deviceRect.x()), float(deviceRect.y() + deviceRect.height()),
+        float(deviceRect.x() + deviceRect.width()), float(deviceRect.y() + deviceRect.height()),
+        float(deviceRect.x() + deviceRect.width()), float(deviceRect.y())};
+    const float texcoords[] = {
+        1, 0,
+        0, 0,
+        0, 1,
+        0, 1,
+        1, 1,
+        1, 0};
+
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    vbo->reset();
+    vbo->setData(6, 2, verts, texcoords);
+
+    ShaderBinder binder(m_heatmapShader.get());
+    m_heatmapShader->setUniform(GLShader::ModelViewProjectionMatrix, viewport.projectionMatrix());
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    heatmap.texture->bind();
+    vbo->render(GL_TRIANGLES);
+    heatmap.texture->unbind();
+    glDisable(GL_BLEND);
+}
+
 bool ShowPaintEffect::isActive() const
 {
-    return m_active;
+    return m_active || m_heatmapActive;
 }
 
 void ShowPaintEffect::toggle()
@@ -111,4 +289,66 @@ void ShowPaintEffect::toggle()
     effects->addRepaintFull();
 }
 
+void ShowPaintEffect::toggleHeatmap()
+{
+    m_heatmapActive = !m_heatmapActive;
+    if (m_heatmapActive) {
+        m_windowStatistics.clear();
+    } else {
+        effects->makeOpenGLContextCurrent();
+        m_heatmaps.clear();
+        m_heatmapShader.reset();
+    }
+    effects->addRepaintFull();
+}
+
+QVariantList ShowPaintEffect::windowStatistics() const
+{
+    QVariantList statistics;
+    for (const auto &[window, windowStatistics] : m_windowStatistics) {
+        statistics.append(QVariantMap{
+            {QStringLiteral("internalId"), window->internalId().toString()},
+            {QStringLiteral("caption"), window->caption()},
+            {QStringLiteral("windowClass"), window->windowClass()},
+            {QStringLiteral("damageEvents"), windowStatistics.damageEvents},
+            {QStringLiteral("damagedArea"), windowStatistics.damagedArea},
+        });
+    }
+    return statistics;
+}
+
+void ShowPaintEffect::slotWindowDamaged(EffectWindow *w, const QRegion &region)
+{
+    if (!m_heatmapActive) {
+        return;
+    }
+
+    // an infinite region means that the whole window, including its decoration and shadow,
+    // has been damaged
+    const QRect windowRect = w->expandedGeometry().toAlignedRect();
+    const QRegion damage = region == infiniteRegion() ? QRegion(windowRect) : region & windowRect;
+    if (damage.isEmpty()) {
+        return;
+    }
+
+    for (auto &[screen, heatmap] : m_heatmaps) {
+        heatmap.damage += damage;
+    }
+
+    WindowStatistics &statistics = m_windowStatistics[w];
+    statistics.damageEvents++;
+    statistics.damagedArea += regionArea(damage);
+}
+
+void ShowPaintEffect::slotWindowDeleted(EffectWindow *w)
+{
+    m_windowStatistics.erase(w);
+}
+
+void ShowPaintEffect::slotScreenRemoved(EffectScreen *screen)
+{
+    effects->makeOpenGLContextCurrent();
+    m_heatmaps.erase(screen);
+}
+
 } // namespace KWin
@@ -11,31 +11,90 @@
 
 #include "libkwineffects/kwineffects.h"
 
+#include <chrono>
+#include <map>
+#include <memory>
+
 namespace KWin
 {
 
+class GLFramebuffer;
+class GLShader;
+class GLTexture;
+
+/**
+ * The ShowPaintEffect visualizes what is repainted.
+ *
+ * By default, the painted areas of every frame are flashed in a different color. The heatmap
+ * mode, which is toggled over D-Bus, instead accumulates the damage of the windows in a texture
+ * per screen that decays over time, so the areas that are damaged more often glow hotter. In
+ * the heatmap mode, how much each window damages is collected as well.
+ */
 class ShowPaintEffect : public Effect
 {
     Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.KWin.Effect.ShowPaint1")
 
 public:
     ShowPaintEffect();
+    ~ShowPaintEffect() override;
 
+    void prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime) override;
+    void postPaintScreen() override;
     void paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, EffectScreen *screen) override;
     void paintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, QRegion region, WindowPaintData &data) override;
 
     bool isActive() const override;
 
+public Q_SLOTS:
+    /**
+     * Toggles the damage heatmap. The window statistics are reset when it's turned on.
+     */
+    Q_SCRIPTABLE void toggleHeatmap();
+
+    /**
+     * Returns the damage statistics of the windows since the heatmap has been turned on, one
+     * map per window with its internalId, caption, windowClass, the number of damageEvents and
+     * the damagedArea in logical pixels.
+     */
+    Q_SCRIPTABLE QVariantList windowStatistics() const;
+
 private Q_SLOTS:
     void toggle();
+    void slotWindowDamaged(EffectWindow *w, const QRegion &region);
+    void slotWindowDeleted(EffectWindow *w);
+    void slotScreenRemoved(EffectScreen *screen);
 
 private:
+    struct Heatmap
+    {
+        std::unique_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+        QRectF geometry;
+        QRegion damage; // what's damaged since the last update, in global coordinates
+        std::chrono::milliseconds lastPresentTime = std::chrono::milliseconds::zero();
+    };
+
+    struct WindowStatistics
+    {
+        int damageEvents = 0;
+        qint64 damagedArea = 0;
+    };
+
     void paintGL(const QMatrix4x4 &projection, qreal scale);
     void paintQPainter();
+    void updateHeatmap(Heatmap &heatmap, EffectScreen *screen, const RenderViewport &viewport);
+    void paintHeatmap(const Heatmap &heatmap, const RenderViewport &viewport);
 
     bool m_active = false;
     QRegion m_painted; // what's painted in one pass
     int m_colorIndex = 0;
+
+    bool m_heatmapActive = false;
+    std::chrono::milliseconds m_presentTime = std::chrono::milliseconds::zero();
+    std::unique_ptr<GLShader> m_heatmapShader;
+    std::map<EffectScreen *, Heatmap> m_heatmaps;
+    std::map<EffectWindow *, WindowStatistics> m_windowStatistics;
 };
 
 } // namespace KWin
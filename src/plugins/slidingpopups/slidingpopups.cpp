@@ -52,6 +52,9 @@ SlidingPopupsEffect::SlidingPopupsEffect()
 
     m_slideLength = QFontMetrics(QGuiApplication::font()).height() * 8;
 
+    // only the sliding windows need the paint hooks
+    effects->setWindowHooksFiltered(this, true);
+
     m_atom = effects->announceSupportProperty("_KDE_SLIDE", this);
     connect(effects, &EffectsHandler::windowAdded, this, &SlidingPopupsEffect::slotWindowAdded);
     connect(effects, &EffectsHandler::windowClosed, this, &SlidingPopupsEffect::slideOut);
@@ -193,6 +196,7 @@ void SlidingPopupsEffect::postPaintWindow(EffectWindow *w)
                 w->setData(WindowForceBlurRole, QVariant());
             }
             m_animations.erase(animationIt);
+            effects->setWindowHooksEnabled(this, w, false);
         }
     }
 
@@ -259,6 +263,7 @@ void SlidingPopupsEffect::slotPropertyNotify(EffectWindow *w, long atom)
         }
         m_animations.remove(w);
         m_animationsData.remove(w);
+        effects->setWindowHooksEnabled(this, w, false);
         return;
     }
 
@@ -500,6 +505,7 @@ void SlidingPopupsEffect::slideIn(EffectWindow *w)
     }
 
     Animation &animation = m_animations[w];
+    effects->setWindowHooksEnabled(this, w, true);
     animation.kind = AnimationKind::In;
     animation.timeLine.setDirection(TimeLine::Forward);
     animation.timeLine.setDuration((*dataIt).slideInDuration);
@@ -535,6 +541,7 @@ void SlidingPopupsEffect::slideOut(EffectWindow *w)
     }
 
     Animation &animation = m_animations[w];
+    effects->setWindowHooksEnabled(this, w, true);
     if (w->isDeleted()) {
         animation.deletedRef = EffectWindowDeletedRef(w);
     }
@@ -568,6 +575,7 @@ void SlidingPopupsEffect::stopAnimations()
             w->setData(WindowForceBackgroundContrastRole, QVariant());
             w->setData(WindowForceBlurRole, QVariant());
         }
+        effects->setWindowHooksEnabled(this, w, false);
     }
 
     m_animations.clear();
@@ -0,0 +1,37 @@
+#version 140
+
+uniform mat4 modelViewProjectionMatrix;
+// the size of the window frame and the control points of the bezier surface, relative to the
+// top-left corner of the window frame, in device pixels
+uniform vec2 frameSize;
+uniform vec2 controlPoints[16];
+
+in vec4 position;
+in vec4 texcoord;
+
+out vec2 texcoord0;
+
+vec4 bernstein(float t)
+{
+    float s = 1.0 - t;
+    return vec4(s * s * s, 3.0 * s * s * t, 3.0 * s * t * t, t * t * t);
+}
+
+vec2 curve(vec4 weights, int row)
+{
+    return weights.x * controlPoints[row * 4]
+        + weights.y * controlPoints[row * 4 + 1]
+        + weights.z * controlPoints[row * 4 + 2]
+        + weights.w * controlPoints[row * 4 + 3];
+}
+
+void main()
+{
+    vec2 uv = position.xy / frameSize;
+    vec4 u = bernstein(uv.x);
+    vec4 v = bernstein(uv.y);
+    vec2 point = v.x * curve(u, 0) + v.y * curve(u, 1) + v.z * curve(u, 2) + v.w * curve(u, 3);
+
+    texcoord0 = texcoord.st;
+    gl_Position = modelViewProjectionMatrix * vec4(point, 0.0, 1.0);
+}
@@ -10,7 +10,13 @@
 #include "wobblywindows.h"
 #include "wobblywindowsconfig.h"
 
+#include "libkwineffects/kwinglutils.h"
+#include "libkwineffects/renderviewport.h"
+
+#include <QVector2D>
+
 #include <cmath>
+#include <limits>
 
 //#define COMPUTE_STATS
 
@@ -27,6 +33,12 @@
 
 Q_LOGGING_CATEGORY(KWIN_WOBBLYWINDOWS, "kwin_effect_wobblywindows", QtWarningMsg)
 
+static void ensureResources()
+{
+    // Must initialize resources manually because the effect is a static lib.
+    Q_INIT_RESOURCE(wobblywindows);
+}
+
 namespace KWin
 {
 
@@ -131,6 +143,26 @@ WobblyWindowsEffect::WobblyWindowsEffect()
     setVertexSnappingMode(RenderGeometry::VertexSnappingMode::None);
 }
 
+void WobblyWindowsEffect::ensureShader()
+{
+    // The shader is loaded when a window wobbles for the first time, not at startup
+    if (m_shaderLoaded) {
+        return;
+    }
+    m_shaderLoaded = true;
+
+    ensureResources();
+    m_shader = ShaderManager::instance()->generateShaderFromFile(ShaderTrait::MapTexture | ShaderTrait::Modulate | ShaderTrait::AdjustSaturation,
+                                                                 QStringLiteral(":/effects/wobblywindows/shaders/wobbly.vert"), QString());
+    if (m_shader->isValid()) {
+        m_frameSizeLocation = m_shader->uniformLocation("frameSize");
+        m_controlPointsLocation = m_shader->uniformLocation("controlPoints");
+    } else {
+        qCWarning(KWIN_WOBBLYWINDOWS) << "Failed to load the wobbly shader, falling back to deforming the windows on the cpu";
+        m_shader.reset();
+    }
+}
+
 WobblyWindowsEffect::~WobblyWindowsEffect()
 {
     if (!windows.empty()) {
@@ -260,20 +292,62 @@ void WobblyWindowsEffect::prePaintWindow(EffectWindow *w, WindowPrePaintData &da
     effects->prePaintWindow(w, data, presentTime);
 }
 
+void WobblyWindowsEffect::drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &region, WindowPaintData &data)
+{
+    // the shader works in device pixels, the quads passed to apply() are in logical pixels
+    m_renderScale = viewport.scale();
+    OffscreenEffect::drawWindow(renderTarget, viewport, w, mask, region, data);
+}
+
 void WobblyWindowsEffect::apply(EffectWindow *w, int mask, WindowPaintData &data, WindowQuadList &quads)
 {
-    if (!(mask & PAINT_SCREEN_TRANSFORMED) && windows.contains(w)) {
+    auto infoIt = windows.find(w);
+    if ((mask & PAINT_SCREEN_TRANSFORMED) || infoIt == windows.end()) {
+        setShader(w, nullptr);
+        return;
+    }
+
+    const WindowWobblyInfos &wwi = *infoIt;
+    const QRectF frameGeometry = w->frameGeometry();
+    double left = 0.0;
+    double top = 0.0;
+    double right = w->width();
+    double bottom = w->height();
+
+    ensureShader();
+    if (m_shader) {
+        // The vertices are moved by the vertex shader, only the bounds of the deformed window
+        // have to be known here.
+        QRectF uvRect;
+        for (const WindowQuad &quad : std::as_const(quads)) {
+            uvRect |= QRectF(QPointF(quad.left() / frameGeometry.width(), quad.top() / frameGeometry.height()),
+                             QPointF(quad.right() / frameGeometry.width(), quad.bottom() / frameGeometry.height()));
+        }
         quads = quads.makeRegularGrid(m_xTesselation, m_yTesselation);
 
-        WindowWobblyInfos &wwi = windows[w];
-        int tx = w->frameGeometry().x();
-        int ty = w->frameGeometry().y();
-        int width = w->frameGeometry().width();
-        int height = w->frameGeometry().height();
-        double left = 0.0;
-        double top = 0.0;
-        double right = w->width();
-        double bottom = w->height();
+        GLfloat controlPoints[16 * 2];
+        for (unsigned int i = 0; i < 16; ++i) {
+            controlPoints[i * 2] = (wwi.position[i].x - frameGeometry.x()) * m_renderScale;
+            controlPoints[i * 2 + 1] = (wwi.position[i].y - frameGeometry.y()) * m_renderScale;
+        }
+
+        ShaderBinder binder(m_shader.get());
+        m_shader->setUniform(m_frameSizeLocation, QVector2D(frameGeometry.width() * m_renderScale, frameGeometry.height() * m_renderScale));
+        glUniform2fv(m_controlPointsLocation, 16, controlPoints);
+        setShader(w, m_shader.get());
+
+        const QRectF bounds = computeBezierBounds(wwi, uvRect).translated(-frameGeometry.topLeft());
+        left = std::min(left, bounds.left());
+        top = std::min(top, bounds.top());
+        right = std::max(right, bounds.right());
+        bottom = std::max(bottom, bounds.bottom());
+    } else {
+        quads = quads.makeRegularGrid(m_xTesselation, m_yTesselation);
+
+        int tx = frameGeometry.x();
+        int ty = frameGeometry.y();
+        int width = frameGeometry.width();
+        int height = frameGeometry.height();
         for (int i = 0; i < quads.count(); ++i) {
             for (int j = 0; j < 4; ++j) {
                 WindowVertex &v = quads[i][j];
@@ -286,15 +360,16 @@ void WobblyWindowsEffect::apply(EffectWindow *w, int mask, WindowPaintData &data
             right = std::max(right, quads[i].right());
             bottom = std::max(bottom, quads[i].bottom());
         }
-        QRectF dirtyRect(
-            left * data.xScale() + w->x() + data.xTranslation(),
-            top * data.yScale() + w->y() + data.yTranslation(),
-            (right - left + 1.0) * data.xScale(),
-            (bottom - top + 1.0) * data.yScale());
-        // Expand the dirty region by 1px to fix potential round/floor issues.
-        dirtyRect.adjust(-1.0, -1.0, 1.0, 1.0);
-        m_updateRegion = m_updateRegion.united(dirtyRect.toRect());
     }
+
+    QRectF dirtyRect(
+        left * data.xScale() + w->x() + data.xTranslation(),
+        top * data.yScale() + w->y() + data.yTranslation(),
+        (right - left + 1.0) * data.xScale(),
+        (bottom - top + 1.0) * data.yScale());
+    // Expand the dirty region by 1px to fix potential round/floor issues.
+    dirtyRect.adjust(-1.0, -1.0, 1.0, 1.0);
+    m_updateRegion = m_updateRegion.united(dirtyRect.toRect());
 }
 
 void WobblyWindowsEffect::postPaintScreen()
@@ -548,6 +623,61 @@ WobblyWindowsEffect::Pair WobblyWindowsEffect::computeBezierPoint(const WindowWo
     return res;
 }
 
+/**
+ * Evaluates the blossom of the cubic bezier curve with the control points @a p at the given
+ * parameters. The blossom at (t, t, t) is the point of the curve at t.
+ */
+static WobblyWindowsEffect::Pair blossom(const WobblyWindowsEffect::Pair p[4], qreal t1, qreal t2, qreal t3)
+{
+    WobblyWindowsEffect::Pair q[3];
+    for (int i = 0; i < 3; ++i) {
+        q[i] = {(1 - t1) * p[i].x + t1 * p[i + 1].x, (1 - t1) * p[i].y + t1 * p[i + 1].y};
+    }
+    WobblyWindowsEffect::Pair r[2];
+    for (int i = 0; i < 2; ++i) {
+        r[i] = {(1 - t2) * q[i].x + t2 * q[i + 1].x, (1 - t2) * q[i].y + t2 * q[i + 1].y};
+    }
+    return {(1 - t3) * r[0].x + t3 * r[1].x, (1 - t3) * r[0].y + t3 * r[1].y};
+}
+
+QRectF WobblyWindowsEffect::computeBezierBounds(const WindowWobblyInfos &wwi, const QRectF &uvRect) const
+{
+    // The part of the surface between the given parameters (they can be outside of [0, 1] when
+    // the window has a shadow) is a bezier surface too, whose control points are given by the
+    // blossoms of the original curves. The surface lies within the convex hull of its control
+    // points, so their bounding rect bounds the deformed window.
+    const auto restrict = [](const Pair p[4], qreal a, qreal b, Pair out[4]) {
+        out[0] = blossom(p, a, a, a);
+        out[1] = blossom(p, a, a, b);
+        out[2] = blossom(p, a, b, b);
+        out[3] = blossom(p, b, b, b);
+    };
+
+    // this assume the grid is 4*4
+    Pair rows[4][4];
+    for (unsigned int j = 0; j < 4; ++j) {
+        restrict(&wwi.position[j * wwi.width], uvRect.left(), uvRect.right(), rows[j]);
+    }
+
+    qreal left = std::numeric_limits<qreal>::max();
+    qreal top = std::numeric_limits<qreal>::max();
+    qreal right = std::numeric_limits<qreal>::lowest();
+    qreal bottom = std::numeric_limits<qreal>::lowest();
+    for (unsigned int i = 0; i < 4; ++i) {
+        const Pair column[4] = {rows[0][i], rows[1][i], rows[2][i], rows[3][i]};
+        Pair hull[4];
+        restrict(column, uvRect.top(), uvRect.bottom(), hull);
+        for (const Pair &point : hull) {
+            left = std::min(left, point.x);
+            top = std::min(top, point.y);
+            right = std::max(right, point.x);
+            bottom = std::max(bottom, point.y);
+        }
+    }
+
+    return QRectF(QPointF(left, top), QPointF(right, bottom));
+}
+
 namespace
 {
 
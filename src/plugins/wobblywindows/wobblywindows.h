@@ -12,9 +12,12 @@
 // Include with base class for effects.
 #include "libkwineffects/kwinoffscreeneffect.h"
 
+#include <memory>
+
 namespace KWin
 {
 
+class GLShader;
 struct ParameterSet;
 
 /**
@@ -44,6 +47,7 @@ public:
     void prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseconds presentTime) override;
     void prePaintWindow(EffectWindow *w, WindowPrePaintData &data, std::chrono::milliseconds presentTime) override;
     void postPaintScreen() override;
+    void drawWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindow *w, int mask, const QRegion &region, WindowPaintData &data) override;
     bool isActive() const override;
 
     int requestedEffectChainPosition() const override
@@ -98,6 +102,7 @@ public Q_SLOTS:
     void slotWindowMaximizeStateChanged(KWin::EffectWindow *w, bool horizontal, bool vertical);
 
 private:
+    void ensureShader();
     void startMovedResized(EffectWindow *w);
     void stepMovedResized(EffectWindow *w);
     bool updateWindowWobblyDatas(EffectWindow *w, qreal time);
@@ -136,6 +141,13 @@ private:
 
     QRegion m_updateRegion;
 
+    // evaluates the bezier surface in the vertex shader, the quads are deformed on the cpu without it
+    std::unique_ptr<GLShader> m_shader;
+    bool m_shaderLoaded = false;
+    int m_frameSizeLocation = -1;
+    int m_controlPointsLocation = -1;
+    qreal m_renderScale = 1.0;
+
     qreal m_stiffness;
     qreal m_drag;
     qreal m_move_factor;
@@ -159,6 +171,7 @@ private:
     void initWobblyInfo(WindowWobblyInfos &wwi, QRectF geometry) const;
 
     WobblyWindowsEffect::Pair computeBezierPoint(const WindowWobblyInfos &wwi, Pair point) const;
+    QRectF computeBezierBounds(const WindowWobblyInfos &wwi, const QRectF &uvRect) const;
 
     static void heightRingLinearMean(QVector<Pair> &data, WindowWobblyInfos &wwi);
 
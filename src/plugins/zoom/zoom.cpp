@@ -110,7 +110,6 @@ ZoomEffect::ZoomEffect()
     connect(&timeline, &QTimeLine::frameChanged, this, &ZoomEffect::timelineFrameChanged);
     connect(effects, &EffectsHandler::mouseChanged, this, &ZoomEffect::slotMouseChanged);
     connect(effects, &EffectsHandler::windowDamaged, this, &ZoomEffect::slotWindowDamaged);
-    connect(effects, &EffectsHandler::screenRemoved, this, &ZoomEffect::slotScreenRemoved);
 
 #if HAVE_ACCESSIBILITY
     m_accessibilityIntegration = new ZoomAccessibilityIntegration(this);
@@ -255,36 +254,8 @@ void ZoomEffect::prePaintScreen(ScreenPrePaintData &data, std::chrono::milliseco
     effects->prePaintScreen(data, presentTime);
 }
 
-ZoomEffect::OffscreenData *ZoomEffect::ensureOffscreenData(const RenderViewport &viewport, EffectScreen *screen)
-{
-    const QRect rect = effects->waylandDisplay() ? screen->geometry() : effects->virtualScreenGeometry();
-    const qreal devicePixelRatio = effects->waylandDisplay() ? screen->devicePixelRatio() : 1;
-    const QSize nativeSize = rect.size() * devicePixelRatio;
-
-    OffscreenData &data = m_offscreenData[effects->waylandDisplay() ? screen : nullptr];
-    data.viewport = rect;
-
-    if (!data.texture || data.texture->size() != nativeSize) {
-        data.texture.reset(new GLTexture(GL_RGBA8, nativeSize));
-        data.texture->setFilter(GL_LINEAR);
-        data.texture->setWrapMode(GL_CLAMP_TO_EDGE);
-        data.framebuffer = std::make_unique<GLFramebuffer>(data.texture.get());
-    }
-
-    return &data;
-}
-
 void ZoomEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, EffectScreen *screen)
 {
-    OffscreenData *offscreenData = ensureOffscreenData(viewport, screen);
-
-    // Render the scene in an offscreen texture and then upscale it.
-    RenderTarget offscreenRenderTarget(offscreenData->framebuffer.get());
-    RenderViewport offscreenViewport(screen->geometry(), screen->devicePixelRatio(), offscreenRenderTarget);
-    GLFramebuffer::pushFramebuffer(offscreenData->framebuffer.get());
-    effects->paintScreen(offscreenRenderTarget, offscreenViewport, mask, region, screen);
-    GLFramebuffer::popFramebuffer();
-
     const QSize screenSize = effects->virtualScreenSize();
     const auto scale = viewport.scale();
 
@@ -348,22 +319,19 @@ void ZoomEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewp
         }
     }
 
-    // Render transformed offscreen texture.
+    // Rather than rendering the whole screen and upscaling it, only the part of the scene that
+    // ends up on the screen is rendered, with a projection that magnifies it. A point p of the
+    // scene is shown at p * zoom + translation.
+    const QRectF renderRect = viewport.renderRect();
+    const QRectF zoomedRect((renderRect.x() - xTranslation) / zoom,
+                            (renderRect.y() - yTranslation) / zoom,
+                            renderRect.width() / zoom,
+                            renderRect.height() / zoom);
+    const RenderViewport zoomedViewport(zoomedRect, scale * zoom, renderTarget);
+
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT);
-
-    auto shader = ShaderManager::instance()->pushShader(ShaderTrait::MapTexture);
-    for (auto &[screen, offscreen] : m_offscreenData) {
-        QMatrix4x4 matrix;
-        matrix.translate(xTranslation * scale, yTranslation * scale);
-        matrix.scale(zoom, zoom);
-        matrix.translate(offscreen.viewport.x() * scale, offscreen.viewport.y() * scale);
-
-        shader->setUniform(GLShader::ModelViewProjectionMatrix, viewport.projectionMatrix() * matrix);
-
-        offscreen.texture->render(offscreen.viewport.size(), scale);
-    }
-    ShaderManager::instance()->popShader();
+    effects->paintScreen(renderTarget, zoomedViewport, mask, infiniteRegion(), screen);
 
     if (mousePointer != MousePointerHide) {
         // Draw the mouse-texture at the position matching to zoomed-in image of the desktop. Hiding the
@@ -540,14 +508,6 @@ void ZoomEffect::slotWindowDamaged()
     }
 }
 
-void ZoomEffect::slotScreenRemoved(EffectScreen *screen)
-{
-    if (auto it = m_offscreenData.find(screen); it != m_offscreenData.end()) {
-        effects->makeOpenGLContextCurrent();
-        m_offscreenData.erase(it);
-    }
-}
-
 void ZoomEffect::moveFocus(const QPoint &point)
 {
     if (zoom == 1.0) {
@@ -23,7 +23,6 @@ namespace KWin
 class ZoomAccessibilityIntegration;
 #endif
 
-class GLFramebuffer;
 class GLTexture;
 class GLVertexBuffer;
 
@@ -77,7 +76,6 @@ private Q_SLOTS:
                           Qt::MouseButtons buttons, Qt::MouseButtons oldbuttons,
                           Qt::KeyboardModifiers modifiers, Qt::KeyboardModifiers oldmodifiers);
     void slotWindowDamaged();
-    void slotScreenRemoved(EffectScreen *screen);
 
 private:
     void showCursor();
@@ -85,15 +83,7 @@ private:
     void moveZoom(int x, int y);
 
 private:
-    struct OffscreenData
-    {
-        std::unique_ptr<GLTexture> texture;
-        std::unique_ptr<GLFramebuffer> framebuffer;
-        QRect viewport;
-    };
-
     GLTexture *ensureCursorTexture();
-    OffscreenData *ensureOffscreenData(const RenderViewport &viewport, EffectScreen *screen);
     void markCursorTextureDirty();
 
 #if HAVE_ACCESSIBILITY
@@ -130,7 +120,6 @@ private:
     int xMove, yMove;
     double moveFactor;
     std::chrono::milliseconds lastPresentTime;
-    std::map<EffectScreen *, OffscreenData> m_offscreenData;
 };
 
 } // namespace
@@ -182,7 +182,7 @@ public:
         if (s_counter == 0) {
             if (!s_scheduledPositions.isEmpty()) {
                 const auto pos = s_scheduledPositions.takeFirst();
-                m_pointer->processMotionInternal(pos.pos, pos.delta, pos.deltaNonAccelerated, pos.time, nullptr);
+                m_pointer->processMotionInternal(pos.pos, pos.delta, pos.deltaNonAccelerated, pos.time, nullptr, pos.history);
             }
         }
     }
@@ -192,9 +192,10 @@ public:
         return s_counter > 0;
     }
 
-    static void schedulePosition(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time)
+    static void schedulePosition(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time,
+                                 const QList<PointerMotionSample> &history)
     {
-        s_scheduledPositions.append({pos, delta, deltaNonAccelerated, time});
+        s_scheduledPositions.append({pos, delta, deltaNonAccelerated, time, history});
     }
 
 private:
@@ -205,6 +206,7 @@ private:
         QPointF delta;
         QPointF deltaNonAccelerated;
         std::chrono::microseconds time;
+        QList<PointerMotionSample> history;
     };
     static QVector<ScheduledPosition> s_scheduledPositions;
 
@@ -224,14 +226,35 @@ void PointerInputRedirection::processMotion(const QPointF &delta, const QPointF
     processMotionInternal(m_pos + delta, delta, deltaNonAccelerated, time, device);
 }
 
-void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device)
+void PointerInputRedirection::processMotionCoalesced(const QList<PointerMotionSample> &samples, InputDevice *device)
+{
+    if (samples.isEmpty()) {
+        return;
+    }
+
+    // the filters only see the accumulated motion, the samples are kept for the clients
+    QPointF delta;
+    QPointF deltaNonAccelerated;
+    for (const PointerMotionSample &sample : samples) {
+        delta += sample.delta;
+        deltaNonAccelerated += sample.deltaNonAccelerated;
+    }
+    processMotionInternal(m_pos + delta, delta, deltaNonAccelerated, samples.last().time, device, samples);
+}
+
+void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device,
+                                                    const QList<PointerMotionSample> &history)
 {
     input()->setLastInputHandler(this);
     if (!inited()) {
         return;
     }
+    if (m_locked && !delta.isNull() && input()->canForwardLockedPointerMotion()) {
+        processLockedMotion(delta, deltaNonAccelerated, time, device, history);
+        return;
+    }
     if (PositionUpdateBlocker::isPositionBlocked()) {
-        PositionUpdateBlocker::schedulePosition(pos, delta, deltaNonAccelerated, time);
+        PositionUpdateBlocker::schedulePosition(pos, delta, deltaNonAccelerated, time, history);
         return;
     }
 
@@ -241,10 +264,35 @@ void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QP
                      input()->keyboardModifiers(), time,
                      delta, deltaNonAccelerated, device);
     event.setModifiersRelevantForGlobalShortcuts(input()->modifiersRelevantForGlobalShortcuts());
+    event.setMotionHistory(history);
 
     update();
     input()->processSpies(std::bind(&InputEventSpy::pointerEvent, std::placeholders::_1, &event));
-    input()->processFilters(std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, 0));
+    input()->processFilters(InputEventFilter::PointerEvents, std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, 0));
+}
+
+void PointerInputRedirection::processLockedMotion(const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device,
+                                                  const QList<PointerMotionSample> &history)
+{
+    // The locked pointer doesn't move, so the focus can't change either. No filter wants the
+    // motion, but the spies still see it, e.g. to reset the idle timeout
+    MouseEvent event(QEvent::MouseMove, m_pos, Qt::NoButton, m_qtButtons,
+                     input()->keyboardModifiers(), time,
+                     delta, deltaNonAccelerated, device);
+    event.setModifiersRelevantForGlobalShortcuts(input()->modifiersRelevantForGlobalShortcuts());
+    event.setMotionHistory(history);
+    input()->processSpies(std::bind(&InputEventSpy::pointerEvent, std::placeholders::_1, &event));
+
+    auto seat = waylandServer()->seat();
+    seat->setTimestamp(time);
+    if (!history.isEmpty()) {
+        for (const PointerMotionSample &sample : history) {
+            seat->relativePointerMotion(sample.delta, sample.deltaNonAccelerated, sample.time);
+        }
+    } else {
+        seat->relativePointerMotion(delta, deltaNonAccelerated, time);
+    }
+    seat->notifyPointerFrame();
 }
 
 void PointerInputRedirection::processButton(uint32_t button, InputRedirection::PointerButtonState state, std::chrono::microseconds time, InputDevice *device)
@@ -277,7 +325,7 @@ void PointerInputRedirection::processButton(uint32_t button, InputRedirection::P
         return;
     }
 
-    input()->processFilters(std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, button));
+    input()->processFilters(InputEventFilter::PointerEvents, std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, button));
 
     if (state == InputRedirection::PointerButtonReleased) {
         update();
@@ -302,7 +350,7 @@ void PointerInputRedirection::processAxis(InputRedirection::PointerAxis axis, qr
     if (!inited()) {
         return;
     }
-    input()->processFilters(std::bind(&InputEventFilter::wheelEvent, std::placeholders::_1, &wheelEvent));
+    input()->processFilters(InputEventFilter::WheelEvents, std::bind(&InputEventFilter::wheelEvent, std::placeholders::_1, &wheelEvent));
 }
 
 void PointerInputRedirection::processSwipeGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -313,7 +361,7 @@ void PointerInputRedirection::processSwipeGestureBegin(int fingerCount, std::chr
     }
 
     input()->processSpies(std::bind(&InputEventSpy::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
-    input()->processFilters(std::bind(&InputEventFilter::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
 }
 
 void PointerInputRedirection::processSwipeGestureUpdate(const QPointF &delta, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -325,7 +373,7 @@ void PointerInputRedirection::processSwipeGestureUpdate(const QPointF &delta, st
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::swipeGestureUpdate, std::placeholders::_1, delta, time));
-    input()->processFilters(std::bind(&InputEventFilter::swipeGestureUpdate, std::placeholders::_1, delta, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::swipeGestureUpdate, std::placeholders::_1, delta, time));
 }
 
 void PointerInputRedirection::processSwipeGestureEnd(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -337,7 +385,7 @@ void PointerInputRedirection::processSwipeGestureEnd(std::chrono::microseconds t
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::swipeGestureEnd, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::swipeGestureEnd, std::placeholders::_1, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::swipeGestureEnd, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processSwipeGestureCancelled(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -349,7 +397,7 @@ void PointerInputRedirection::processSwipeGestureCancelled(std::chrono::microsec
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::swipeGestureCancelled, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::swipeGestureCancelled, std::placeholders::_1, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::swipeGestureCancelled, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processPinchGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -361,7 +409,7 @@ void PointerInputRedirection::processPinchGestureBegin(int fingerCount, std::chr
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::pinchGestureBegin, std::placeholders::_1, fingerCount, time));
-    input()->processFilters(std::bind(&InputEventFilter::pinchGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::pinchGestureBegin, std::placeholders::_1, fingerCount, time));
 }
 
 void PointerInputRedirection::processPinchGestureUpdate(qreal scale, qreal angleDelta, const QPointF &delta, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -373,7 +421,7 @@ void PointerInputRedirection::processPinchGestureUpdate(qreal scale, qreal angle
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::pinchGestureUpdate, std::placeholders::_1, scale, angleDelta, delta, time));
-    input()->processFilters(std::bind(&InputEventFilter::pinchGestureUpdate, std::placeholders::_1, scale, angleDelta, delta, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::pinchGestureUpdate, std::placeholders::_1, scale, angleDelta, delta, time));
 }
 
 void PointerInputRedirection::processPinchGestureEnd(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -385,7 +433,7 @@ void PointerInputRedirection::processPinchGestureEnd(std::chrono::microseconds t
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::pinchGestureEnd, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::pinchGestureEnd, std::placeholders::_1, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::pinchGestureEnd, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processPinchGestureCancelled(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -397,7 +445,7 @@ void PointerInputRedirection::processPinchGestureCancelled(std::chrono::microsec
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::pinchGestureCancelled, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::pinchGestureCancelled, std::placeholders::_1, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::pinchGestureCancelled, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processHoldGestureBegin(int fingerCount, std::chrono::microseconds time, KWin::InputDevice *device)
@@ -408,7 +456,7 @@ void PointerInputRedirection::processHoldGestureBegin(int fingerCount, std::chro
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::holdGestureBegin, std::placeholders::_1, fingerCount, time));
-    input()->processFilters(std::bind(&InputEventFilter::holdGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::holdGestureBegin, std::placeholders::_1, fingerCount, time));
 }
 
 void PointerInputRedirection::processHoldGestureEnd(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -419,7 +467,7 @@ void PointerInputRedirection::processHoldGestureEnd(std::chrono::microseconds ti
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::holdGestureEnd, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::holdGestureEnd, std::placeholders::_1, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::holdGestureEnd, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processHoldGestureCancelled(std::chrono::microseconds time, KWin::InputDevice *device)
@@ -430,7 +478,7 @@ void PointerInputRedirection::processHoldGestureCancelled(std::chrono::microseco
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::holdGestureCancelled, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::holdGestureCancelled, std::placeholders::_1, time));
+    input()->processFilters(InputEventFilter::GestureEvents, std::bind(&InputEventFilter::holdGestureCancelled, std::placeholders::_1, time));
 }
 
 bool PointerInputRedirection::areButtonsPressed() const
@@ -91,6 +91,10 @@ public:
      * @internal
      */
     void processMotion(const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device);
+    /**
+     * @internal
+     */
+    void processMotionCoalesced(const QList<KWin::PointerMotionSample> &samples, InputDevice *device);
     /**
      * @internal
      */
@@ -145,7 +149,10 @@ public:
     void processHoldGestureCancelled(std::chrono::microseconds time, KWin::InputDevice *device = nullptr);
 
 private:
-    void processMotionInternal(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device);
+    void processMotionInternal(const QPointF &pos, const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device,
+                               const QList<PointerMotionSample> &history = {});
+    void processLockedMotion(const QPointF &delta, const QPointF &deltaNonAccelerated, std::chrono::microseconds time, InputDevice *device,
+                             const QList<PointerMotionSample> &history);
     void cleanupDecoration(Decoration::DecoratedClientImpl *old, Decoration::DecoratedClientImpl *now) override;
 
     void focusUpdate(Window *focusOld, Window *focusNow) override;
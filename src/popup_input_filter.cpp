@@ -18,6 +18,7 @@ namespace KWin
 
 PopupInputFilter::PopupInputFilter()
     : QObject()
+    , InputEventFilter(PointerEvents | KeyEvents | TouchEvents)
 {
     connect(workspace(), &Workspace::windowAdded, this, &PopupInputFilter::handleWindowAdded);
 }
@@ -43,6 +44,12 @@ void PopupInputFilter::handleWindowAdded(Window *window)
     }
 }
 
+bool PopupInputFilter::handlesLockedPointerMotion() const
+{
+    // only button presses dismiss the popups
+    return false;
+}
+
 bool PopupInputFilter::pointerEvent(MouseEvent *event, quint32 nativeButton)
 {
     if (m_popupWindows.isEmpty()) {
@@ -21,6 +21,7 @@ class PopupInputFilter : public QObject, public InputEventFilter
 public:
     explicit PopupInputFilter();
     bool pointerEvent(MouseEvent *event, quint32 nativeButton) override;
+    bool handlesLockedPointerMotion() const override;
     bool keyEvent(KeyEvent *event) override;
     bool touchDown(qint32 id, const QPointF &pos, std::chrono::microseconds time) override;
 
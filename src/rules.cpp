@@ -17,6 +17,8 @@
 #include <QTemporaryFile>
 #include <kconfig.h>
 
+#include <algorithm>
+
 #ifndef KCMRULES
 #include "client_machine.h"
 #include "main.h"
@@ -106,6 +108,10 @@ void Rules::readFromSettings(const RuleSettings *settings)
     READ_MATCH_STRING(windowrole, );
     READ_MATCH_STRING(title, );
     READ_MATCH_STRING(clientmachine, .toLower());
+    wmclassRegExp = compileMatch(wmclass, wmclassmatch);
+    windowroleRegExp = compileMatch(windowrole, windowrolematch);
+    titleRegExp = compileMatch(title, titlematch);
+    clientmachineRegExp = compileMatch(clientmachine, clientmachinematch);
     types = NET::WindowTypeMask(settings->types());
     READ_FORCE_RULE(placement, );
     READ_SET_RULE(position);
@@ -303,6 +309,16 @@ QString Rules::getDecoColor(const QString &themeName)
                                   QLatin1String("color-schemes/") + themeName + QLatin1String(".colors"));
 }
 
+QRegularExpression Rules::compileMatch(const QString &pattern, StringMatch match)
+{
+    if (match != RegExpMatch) {
+        return QRegularExpression();
+    }
+    QRegularExpression regExp(pattern);
+    regExp.optimize();
+    return regExp;
+}
+
 bool Rules::matchType(NET::WindowType match_type) const
 {
     if (types != NET::AllTypesMask) {
@@ -323,7 +339,7 @@ bool Rules::matchWMClass(const QString &match_class, const QString &match_name)
         QString cwmclass = wmclasscomplete
             ? match_name + ' ' + match_class
             : match_class;
-        if (wmclassmatch == RegExpMatch && !QRegularExpression(wmclass).match(cwmclass).hasMatch()) {
+        if (wmclassmatch == RegExpMatch && !wmclassRegExp.match(cwmclass).hasMatch()) {
             return false;
         }
         if (wmclassmatch == ExactMatch && cwmclass != wmclass) {
@@ -339,7 +355,7 @@ bool Rules::matchWMClass(const QString &match_class, const QString &match_name)
 bool Rules::matchRole(const QString &match_role) const
 {
     if (windowrolematch != UnimportantMatch) {
-        if (windowrolematch == RegExpMatch && !QRegularExpression(windowrole).match(match_role).hasMatch()) {
+        if (windowrolematch == RegExpMatch && !windowroleRegExp.match(match_role).hasMatch()) {
             return false;
         }
         if (windowrolematch == ExactMatch && match_role != windowrole) {
@@ -355,7 +371,7 @@ bool Rules::matchRole(const QString &match_role) const
 bool Rules::matchTitle(const QString &match_title) const
 {
     if (titlematch != UnimportantMatch) {
-        if (titlematch == RegExpMatch && !QRegularExpression(title).match(match_title).hasMatch()) {
+        if (titlematch == RegExpMatch && !titleRegExp.match(match_title).hasMatch()) {
             return false;
         }
         if (titlematch == ExactMatch && title != match_title) {
@@ -377,7 +393,7 @@ bool Rules::matchClientMachine(const QString &match_machine, bool local) const
             return true;
         }
         if (clientmachinematch == RegExpMatch
-            && !QRegularExpression(clientmachine).match(match_machine).hasMatch()) {
+            && !clientmachineRegExp.match(match_machine).hasMatch()) {
             return false;
         }
         if (clientmachinematch == ExactMatch
@@ -871,12 +887,42 @@ void RuleBook::deleteAll()
 {
     qDeleteAll(m_rules);
     m_rules.clear();
+    m_indexValid = false;
+}
+
+void RuleBook::updateIndex() const
+{
+    if (m_indexValid) {
+        return;
+    }
+    m_rulesByClass.clear();
+    m_rulesByCompleteClass.clear();
+    m_otherRules.clear();
+    for (int i = 0; i < m_rules.count(); ++i) {
+        const Rules *rule = m_rules[i];
+        if (rule->wmclassmatch != Rules::ExactMatch) {
+            m_otherRules.append(i);
+        } else if (rule->wmclasscomplete) {
+            m_rulesByCompleteClass[rule->wmclass].append(i);
+        } else {
+            m_rulesByClass[rule->wmclass].append(i);
+        }
+    }
+    m_indexValid = true;
 }
 
 WindowRules RuleBook::find(const Window *window) const
 {
+    updateIndex();
+
+    QVector<int> candidates = m_otherRules;
+    candidates += m_rulesByClass.value(window->resourceClass());
+    candidates += m_rulesByCompleteClass.value(window->resourceName() + QLatin1Char(' ') + window->resourceClass());
+    std::sort(candidates.begin(), candidates.end());
+
     QVector<Rules *> ret;
-    for (Rules *rule : m_rules) {
+    for (int index : std::as_const(candidates)) {
+        Rules *rule = m_rules[index];
         if (rule->match(window)) {
             qCDebug(KWIN_CORE) << "Rule found:" << rule << ":" << window;
             ret.append(rule);
@@ -918,6 +964,7 @@ void RuleBook::load()
     RuleBookSettings book(m_config);
     book.load();
     m_rules = book.rules();
+    m_indexValid = false;
 }
 
 void RuleBook::save()
@@ -945,6 +992,7 @@ void RuleBook::discardUsed(Window *c, bool withdrawn)
                 c->removeRule(*it);
                 Rules *r = *it;
                 it = m_rules.erase(it);
+                m_indexValid = false;
                 delete r;
                 continue;
             }
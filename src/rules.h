@@ -9,7 +9,9 @@
 
 #pragma once
 
+#include <QHash>
 #include <QRectF>
+#include <QRegularExpression>
 #include <QVector>
 #include <netwm_def.h>
 
@@ -196,6 +198,7 @@ private:
 private:
 #endif
     void readFromSettings(const RuleSettings *settings);
+    static QRegularExpression compileMatch(const QString &pattern, StringMatch match);
     static ForceRule convertForceRule(int v);
     static QString getDecoColor(const QString &themeName);
 #ifndef KCMRULES
@@ -214,6 +217,11 @@ private:
     StringMatch titlematch;
     QString clientmachine;
     StringMatch clientmachinematch;
+    // the regular expressions are compiled once rather than for every matched window
+    QRegularExpression wmclassRegExp;
+    QRegularExpression windowroleRegExp;
+    QRegularExpression titleRegExp;
+    QRegularExpression clientmachineRegExp;
     NET::WindowTypes types; // types for matching
     PlacementPolicy placement;
     ForceRule placementrule;
@@ -288,6 +296,9 @@ private:
     QString desktopfile;
     SetRule desktopfilerule;
     friend QDebug &operator<<(QDebug &stream, const Rules *);
+#ifndef KCMRULES
+    friend class RuleBook;
+#endif
 };
 
 #ifndef KCMRULES
@@ -315,10 +326,18 @@ private Q_SLOTS:
 
 private:
     void deleteAll();
+    void updateIndex() const;
     QTimer *m_updateTimer;
     bool m_updatesDisabled;
     QVector<Rules *> m_rules;
     KSharedConfig::Ptr m_config;
+
+    // Most rules match a window class exactly, they are looked up by the class instead of
+    // being checked one by one. The indices refer to m_rules, so the order is preserved.
+    mutable QHash<QString, QVector<int>> m_rulesByClass;
+    mutable QHash<QString, QVector<int>> m_rulesByCompleteClass;
+    mutable QVector<int> m_otherRules;
+    mutable bool m_indexValid = false;
 };
 
 inline bool RuleBook::areUpdatesDisabled() const
@@ -37,9 +37,12 @@ void CursorScene::initialize()
 
 static void resetRepaintsHelper(Item *item, SceneDelegate *delegate)
 {
+    if (!item->hasPendingRepaints(delegate)) {
+        return;
+    }
     item->resetRepaints(delegate);
 
-    const auto childItems = item->childItems();
+    const QList<Item *> &childItems = item->childItems();
     for (Item *childItem : childItems) {
         resetRepaintsHelper(childItem, delegate);
     }
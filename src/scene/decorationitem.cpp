@@ -76,12 +76,24 @@ qreal DecorationRenderer::devicePixelRatio() const
 
 void DecorationRenderer::setDevicePixelRatio(qreal dpr)
 {
-    if (m_devicePixelRatio != dpr) {
-        m_devicePixelRatio = dpr;
+    if (m_devicePixelRatio == dpr) {
+        return;
+    }
+    const qreal previous = m_devicePixelRatio;
+    m_devicePixelRatio = dpr;
+    if (m_imageSizesDirty || !restoreDevicePixelRatio(previous)) {
         invalidate();
+    } else if (m_client) {
+        // nothing has to be rendered, but the decoration has to be repainted at the new scale
+        Q_EMIT damaged(m_client->window()->rect().toAlignedRect());
     }
 }
 
+bool DecorationRenderer::restoreDevicePixelRatio(qreal)
+{
+    return false;
+}
+
 void DecorationRenderer::renderToPainter(QPainter *painter, const QRect &rect)
 {
     client()->decoration()->paint(painter, rect);
@@ -62,6 +62,14 @@ protected:
     }
     void renderToPainter(QPainter *painter, const QRect &rect);
 
+    /**
+     * This function is called when the device pixel ratio has changed from @a previous to
+     * devicePixelRatio(). If the renderer still has the contents for the new device pixel
+     * ratio, it adds the damage they have missed and returns @c true. Otherwise the whole
+     * decoration is rendered again.
+     */
+    virtual bool restoreDevicePixelRatio(qreal previous);
+
 private:
     QPointer<Decoration::DecoratedClientImpl> m_client;
     QRegion m_damage;
@@ -5,6 +5,7 @@
 */
 
 #include "scene/dndiconitem.h"
+#include "core/renderloop.h"
 #include "scene/surfaceitem_wayland.h"
 #include "wayland/datadevice_interface.h"
 #include "wayland/surface_interface.h"
@@ -37,4 +38,12 @@ void DragAndDropIconItem::frameRendered(quint32 timestamp)
     }
 }
 
+std::unique_ptr<PresentationFeedback> DragAndDropIconItem::takePresentationFeedback(Output *output)
+{
+    if (m_surfaceItem) {
+        return m_surfaceItem->surface()->takePresentationFeedback(output);
+    }
+    return nullptr;
+}
+
 } // namespace KWin
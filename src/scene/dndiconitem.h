@@ -16,6 +16,8 @@ class DragAndDropIcon;
 namespace KWin
 {
 
+class Output;
+class PresentationFeedback;
 class SurfaceItemWayland;
 
 class DragAndDropIconItem : public Item
@@ -27,6 +29,7 @@ public:
     ~DragAndDropIconItem() override;
 
     void frameRendered(quint32 timestamp);
+    std::unique_ptr<PresentationFeedback> takePresentationFeedback(Output *output);
 
 private:
     std::unique_ptr<SurfaceItemWayland> m_surfaceItem;
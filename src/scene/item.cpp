@@ -23,9 +23,9 @@ Item::Item(Scene *scene, Item *parent)
 Item::~Item()
 {
     setParentItem(nullptr);
-    for (const auto &dirty : std::as_const(m_repaints)) {
-        if (!dirty.isEmpty()) {
-            m_scene->addRepaint(dirty);
+    for (const DelegateRepaints &repaints : std::as_const(m_repaints)) {
+        if (!repaints.region.isEmpty()) {
+            m_scene->addRepaint(repaints.region);
         }
     }
 }
@@ -82,6 +82,12 @@ void Item::setParentItem(Item *item)
     if (m_parentItem) {
         Q_ASSERT(m_parentItem->m_scene == m_scene);
         m_parentItem->addChild(this);
+        // the new ancestors must know that there are repaints in this subtree
+        for (const DelegateRepaints &repaints : std::as_const(m_repaints)) {
+            if (repaints.pending) {
+                m_parentItem->markRepaintsPending(repaints.delegate);
+            }
+        }
     }
     updateEffectiveVisibility();
 }
@@ -110,7 +116,7 @@ void Item::removeChild(Item *item)
     updateBoundingRect();
 }
 
-QList<Item *> Item::childItems() const
+const QList<Item *> &Item::childItems() const
 {
     return m_childItems;
 }
@@ -302,7 +308,8 @@ void Item::scheduleRepaintInternal(const QRegion &region)
     for (SceneDelegate *delegate : delegates) {
         const QRegion dirtyRegion = globalRegion & delegate->viewport();
         if (!dirtyRegion.isEmpty()) {
-            m_repaints[delegate] += dirtyRegion;
+            ensureRepaints(delegate).region += dirtyRegion;
+            markRepaintsPending(delegate);
             delegate->layer()->loop()->scheduleRepaint(this);
         }
     }
@@ -334,6 +341,7 @@ WindowQuadList Item::buildQuads() const
 void Item::discardQuads()
 {
     m_quads.reset();
+    m_renderGeometryCache.reset();
 }
 
 WindowQuadList Item::quads() const
@@ -344,19 +352,84 @@ WindowQuadList Item::quads() const
     return m_quads.value();
 }
 
+std::optional<Item::RenderGeometryCache> &Item::renderGeometryCache()
+{
+    return m_renderGeometryCache;
+}
+
+Item::DelegateRepaints *Item::findRepaints(SceneDelegate *delegate)
+{
+    for (DelegateRepaints &repaints : m_repaints) {
+        if (repaints.delegate == delegate) {
+            return &repaints;
+        }
+    }
+    return nullptr;
+}
+
+const Item::DelegateRepaints *Item::findRepaints(SceneDelegate *delegate) const
+{
+    for (const DelegateRepaints &repaints : m_repaints) {
+        if (repaints.delegate == delegate) {
+            return &repaints;
+        }
+    }
+    return nullptr;
+}
+
+Item::DelegateRepaints &Item::ensureRepaints(SceneDelegate *delegate)
+{
+    if (DelegateRepaints *repaints = findRepaints(delegate)) {
+        return *repaints;
+    }
+    m_repaints.append(DelegateRepaints{
+        .delegate = delegate,
+    });
+    return m_repaints.last();
+}
+
+void Item::markRepaintsPending(SceneDelegate *delegate)
+{
+    // if an item has pending repaints, so do all of its ancestors
+    for (Item *item = this; item; item = item->m_parentItem) {
+        DelegateRepaints &repaints = item->ensureRepaints(delegate);
+        if (repaints.pending) {
+            break;
+        }
+        repaints.pending = true;
+    }
+}
+
 QRegion Item::repaints(SceneDelegate *delegate) const
 {
-    return m_repaints.value(delegate);
+    if (const DelegateRepaints *repaints = findRepaints(delegate)) {
+        return repaints->region;
+    }
+    return QRegion();
+}
+
+bool Item::hasPendingRepaints(SceneDelegate *delegate) const
+{
+    const DelegateRepaints *repaints = findRepaints(delegate);
+    return repaints && repaints->pending;
 }
 
 void Item::resetRepaints(SceneDelegate *delegate)
 {
-    m_repaints.insert(delegate, QRegion());
+    if (DelegateRepaints *repaints = findRepaints(delegate)) {
+        repaints->region = QRegion();
+        repaints->pending = false;
+    }
 }
 
 void Item::removeRepaints(SceneDelegate *delegate)
 {
-    m_repaints.remove(delegate);
+    for (auto it = m_repaints.begin(); it != m_repaints.end(); ++it) {
+        if (it->delegate == delegate) {
+            m_repaints.erase(it);
+            return;
+        }
+    }
 }
 
 bool Item::explicitVisible() const
@@ -411,14 +484,14 @@ static bool compareZ(const Item *a, const Item *b)
     return a->z() < b->z();
 }
 
-QList<Item *> Item::sortedChildItems() const
+const QList<Item *> &Item::sortedChildItems() const
 {
     if (!m_sortedChildItems.has_value()) {
         QList<Item *> items = m_childItems;
         std::stable_sort(items.begin(), items.end(), compareZ);
-        m_sortedChildItems = items;
+        m_sortedChildItems = std::move(items);
     }
-    return m_sortedChildItems.value();
+    return *m_sortedChildItems;
 }
 
 void Item::markSortedChildItemsDirty()
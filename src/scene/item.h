@@ -12,6 +12,7 @@
 #include <QMatrix4x4>
 #include <QObject>
 #include <QPointer>
+#include <QVarLengthArray>
 #include <QVector>
 
 #include <optional>
@@ -65,8 +66,16 @@ public:
      */
     Item *parentItem() const;
     void setParentItem(Item *parent);
-    QList<Item *> childItems() const;
-    QList<Item *> sortedChildItems() const;
+    /**
+     * Returns the child items in the order they were added or stacked. The returned list
+     * is invalidated when the children of this item change.
+     */
+    const QList<Item *> &childItems() const;
+    /**
+     * Returns the child items sorted by their z value. The returned list is cached, and it is
+     * invalidated when the children of this item or their z values change.
+     */
+    const QList<Item *> &sortedChildItems() const;
 
     QPointF rootPosition() const;
 
@@ -106,11 +115,39 @@ public:
     void scheduleRepaint(const QRegion &region);
     void scheduleFrame();
     QRegion repaints(SceneDelegate *delegate) const;
+    /**
+     * Resets the repaints of this item for the given @a delegate. The repaints of the child
+     * items have to be reset as well, hasPendingRepaints() doesn't report them afterwards.
+     */
     void resetRepaints(SceneDelegate *delegate);
+    /**
+     * Returns @c true if this item or any of its descendants has repaints for the given
+     * @a delegate. The subtrees without pending repaints can be skipped when collecting them.
+     */
+    bool hasPendingRepaints(SceneDelegate *delegate) const;
 
     WindowQuadList quads() const;
     virtual void preprocess();
 
+    /**
+     * The RenderGeometryCache struct holds the result of clipping the quads of the item
+     * against a clip region. It lets the renderer skip clipping the quads again if neither
+     * the quads nor the clip region have changed since the last frame.
+     */
+    struct RenderGeometryCache
+    {
+        QRegion clip;
+        QPointF translation;
+        qreal scale = 1.0;
+        RenderGeometry geometry;
+    };
+
+    /**
+     * Returns the render geometry cache of the item. The cache is reset when the quads
+     * are discarded.
+     */
+    std::optional<RenderGeometryCache> &renderGeometryCache();
+
 Q_SIGNALS:
     void childAdded(Item *item);
     /**
@@ -142,6 +179,19 @@ private:
     bool computeEffectiveVisibility() const;
     void updateEffectiveVisibility();
     void removeRepaints(SceneDelegate *delegate);
+    void markRepaintsPending(SceneDelegate *delegate);
+
+    struct DelegateRepaints
+    {
+        SceneDelegate *delegate;
+        // the repaints of this item
+        QRegion region;
+        // whether this item or any of its descendants has repaints
+        bool pending = false;
+    };
+    DelegateRepaints *findRepaints(SceneDelegate *delegate);
+    const DelegateRepaints *findRepaints(SceneDelegate *delegate) const;
+    DelegateRepaints &ensureRepaints(SceneDelegate *delegate);
 
     Scene *m_scene;
     QPointer<Item> m_parentItem;
@@ -154,8 +204,10 @@ private:
     int m_z = 0;
     bool m_explicitVisible = true;
     bool m_effectiveVisible = true;
-    QMap<SceneDelegate *, QRegion> m_repaints;
+    // there are only as many delegates as outputs, so they're looked up linearly
+    QVarLengthArray<DelegateRepaints, 2> m_repaints;
     mutable std::optional<WindowQuadList> m_quads;
+    std::optional<RenderGeometryCache> m_renderGeometryCache;
     mutable std::optional<QList<Item *>> m_sortedChildItems;
 };
 
@@ -5,6 +5,7 @@
 */
 
 #include "scene/itemrenderer.h"
+#include "scene/item.h"
 
 #include <QRegion>
 
@@ -32,4 +33,15 @@ void ItemRenderer::endFrame()
 {
 }
 
+void ItemRenderer::prewarm(Item *item)
+{
+    item->preprocess();
+    const QList<Item *> childItems = item->childItems();
+    for (Item *childItem : childItems) {
+        if (childItem->explicitVisible()) {
+            prewarm(childItem);
+        }
+    }
+}
+
 } // namespace KWin
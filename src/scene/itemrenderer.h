@@ -37,6 +37,13 @@ public:
     virtual void renderItem(const RenderTarget &renderTarget, const RenderViewport &viewport, Item *item, int mask, const QRegion &region, const WindowPaintData &data) = 0;
 
     virtual ImageItem *createImageItem(Scene *scene, Item *parent = nullptr) = 0;
+
+    /**
+     * Brings the GPU resources of the hidden @a item and its children up to date, so it can
+     * be shown without having to upload its contents first. This is called while the render
+     * context is current.
+     */
+    virtual void prewarm(Item *item);
 };
 
 } // namespace KWin
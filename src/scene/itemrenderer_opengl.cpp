@@ -5,8 +5,10 @@
 */
 
 #include "scene/itemrenderer_opengl.h"
+#include "core/syncobjtimeline.h"
 #include "libkwineffects/rendertarget.h"
 #include "libkwineffects/renderviewport.h"
+#include "platformsupport/scenes/opengl/eglnativefence.h"
 #include "platformsupport/scenes/opengl/openglsurfacetexture.h"
 #include "scene/decorationitem.h"
 #include "scene/imageitem.h"
@@ -41,6 +43,20 @@ void ItemRendererOpenGL::beginFrame(const RenderTarget &renderTarget, const Rend
 
 void ItemRendererOpenGL::endFrame()
 {
+    if (!m_releasePoints.empty()) {
+        // The release points of explicitly synchronized buffers must not be signaled
+        // before the GPU is done reading from them.
+        const ::EGLDisplay display = eglGetCurrentDisplay();
+        if (display != EGL_NO_DISPLAY && epoxy_has_egl_extension(display, "EGL_ANDROID_native_fence_sync")) {
+            EGLNativeFence fence(display);
+            if (fence.isValid()) {
+                for (const auto &releasePoint : m_releasePoints) {
+                    releasePoint->addReleaseFence(fence.fileDescriptor());
+                }
+            }
+        }
+        m_releasePoints.clear();
+    }
     GLVertexBuffer::streamingBuffer()->endOfFrame();
     GLFramebuffer::popFramebuffer();
 }
@@ -93,41 +109,90 @@ static GLTexture *bindSurfaceTexture(SurfaceItem *surfaceItem)
     return platformSurfaceTexture->texture();
 }
 
+void ItemRendererOpenGL::prewarm(Item *item)
+{
+    item->preprocess();
+    if (auto surfaceItem = qobject_cast<SurfaceItem *>(item)) {
+        SurfacePixmap *pixmap = surfaceItem->pixmap();
+        if (pixmap && !pixmap->solidColor()) {
+            bindSurfaceTexture(surfaceItem);
+        }
+    }
+    const QList<Item *> childItems = item->childItems();
+    for (Item *childItem : childItems) {
+        if (childItem->explicitVisible()) {
+            prewarm(childItem);
+        }
+    }
+}
+
+// matches the saturation adjustment of the texture shader
+static QVector4D adjustColor(const QVector4D &color, float saturation)
+{
+    if (saturation == 1.0) {
+        return color;
+    }
+    const QVector3D rgb = color.toVector3D();
+    const float luminance = QVector3D::dotProduct(rgb, QVector3D(0.2126, 0.7152, 0.0722));
+    return QVector4D(QVector3D(luminance, luminance, luminance) * (1.0 - saturation) + rgb * saturation, color.w());
+}
+
+static bool canBatch(const ItemRendererOpenGL::RenderNode &node, const ItemRendererOpenGL::RenderNode &other)
+{
+    return node.texture == other.texture
+        && node.color == other.color
+        && node.opacity == other.opacity
+        && node.hasAlpha == other.hasAlpha
+        && node.transformMatrix == other.transformMatrix;
+}
+
 static QRectF logicalRectToDeviceRect(const QRectF &logical, qreal deviceScale)
 {
     return QRectF(QPointF(std::round(logical.left() * deviceScale), std::round(logical.top() * deviceScale)),
                   QPointF(std::round(logical.right() * deviceScale), std::round(logical.bottom() * deviceScale)));
 }
 
-static RenderGeometry clipQuads(const Item *item, const ItemRendererOpenGL::RenderContext *context)
+static RenderGeometry clipQuads(Item *item, const ItemRendererOpenGL::RenderContext *context)
 {
-    const WindowQuadList quads = item->quads();
-
     // Item to world translation.
     const QPointF worldTranslation = context->transformStack.top().map(QPointF(0., 0.));
     const qreal scale = context->renderTargetScale;
+    const bool softwareClipping = context->clip != infiniteRegion() && !context->hardwareClipping;
+    const QRegion clip = softwareClipping ? context->clip : infiniteRegion();
+
+    // Reuse the geometry from the previous frame if neither the quads nor the clip have changed.
+    std::optional<Item::RenderGeometryCache> &cache = item->renderGeometryCache();
+    if (cache && cache->scale == scale && cache->clip == clip && (!softwareClipping || cache->translation == worldTranslation)) {
+        return cache->geometry;
+    }
+
+    const WindowQuadList quads = item->quads();
 
     RenderGeometry geometry;
     geometry.reserve(quads.count() * 6);
 
     // split all quads in bounding rect with the actual rects in the region
     for (const WindowQuad &quad : std::as_const(quads)) {
-        if (context->clip != infiniteRegion() && !context->hardwareClipping) {
-            // Scale to device coordinates, rounding as needed.
-            QRectF deviceBounds = logicalRectToDeviceRect(quad.bounds(), scale);
-
-            for (const QRect &clipRect : std::as_const(context->clip)) {
-                QRectF deviceClipRect = logicalRectToDeviceRect(clipRect, scale).translated(-worldTranslation);
+        if (softwareClipping) {
+            // Scale to device coordinates, rounding as needed. The clip rects are in world
+            // device coordinates, so map the quad to the world rather than every clip rect
+            // to the item.
+            const QRectF deviceBounds = logicalRectToDeviceRect(quad.bounds(), scale);
+            const QRectF worldDeviceBounds = deviceBounds.translated(worldTranslation);
+            if (!worldDeviceBounds.intersects(context->deviceClipBounds)) {
+                continue;
+            }
 
-                const QRectF &intersected = deviceClipRect.intersected(deviceBounds);
+            for (const QRectF &deviceClipRect : std::as_const(context->deviceClipRects)) {
+                const QRectF intersected = deviceClipRect.intersected(worldDeviceBounds);
                 if (intersected.isValid()) {
-                    if (deviceBounds == intersected) {
+                    if (worldDeviceBounds == intersected) {
                         // case 1: completely contains, include and do not check other rects
                         geometry.appendWindowQuad(quad, scale);
                         break;
                     }
                     // case 2: intersection
-                    geometry.appendSubQuad(quad, intersected, scale);
+                    geometry.appendSubQuad(quad, intersected.translated(-worldTranslation), scale);
                 }
             }
         } else {
@@ -135,12 +200,19 @@ static RenderGeometry clipQuads(const Item *item, const ItemRendererOpenGL::Rend
         }
     }
 
+    cache = Item::RenderGeometryCache{
+        .clip = clip,
+        .translation = worldTranslation,
+        .scale = scale,
+        .geometry = geometry,
+    };
+
     return geometry;
 }
 
 void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context)
 {
-    const QList<Item *> sortedChildItems = item->sortedChildItems();
+    const QList<Item *> &sortedChildItems = item->sortedChildItems();
 
     QMatrix4x4 matrix;
     const auto logicalPosition = QVector2D(item->position().x(), item->position().y());
@@ -194,15 +266,32 @@ void ItemRendererOpenGL::createRenderNode(Item *item, RenderContext *context)
         SurfacePixmap *pixmap = surfaceItem->pixmap();
         if (pixmap) {
             if (!geometry.isEmpty()) {
-                context->renderNodes.append(RenderNode{
-                    .texture = bindSurfaceTexture(surfaceItem),
-                    .geometry = geometry,
-                    .transformMatrix = context->transformStack.top(),
-                    .opacity = context->opacityStack.top(),
-                    .hasAlpha = pixmap->hasAlphaChannel(),
-                    .coordinateType = NormalizedCoordinates,
-                    .scale = scale,
-                });
+                if (auto releasePoint = pixmap->bufferReleasePoint()) {
+                    m_releasePoints.insert(releasePoint);
+                }
+                if (const std::optional<QVector4D> color = pixmap->solidColor()) {
+                    // solid colors don't need to be uploaded, they're drawn with a uniform color
+                    surfaceItem->resetDamage();
+                    context->renderNodes.append(RenderNode{
+                        .color = *color,
+                        .geometry = geometry,
+                        .transformMatrix = context->transformStack.top(),
+                        .opacity = context->opacityStack.top(),
+                        .hasAlpha = pixmap->hasAlphaChannel(),
+                        .coordinateType = NormalizedCoordinates,
+                        .scale = scale,
+                    });
+                } else {
+                    context->renderNodes.append(RenderNode{
+                        .texture = bindSurfaceTexture(surfaceItem),
+                        .geometry = geometry,
+                        .transformMatrix = context->transformStack.top(),
+                        .opacity = context->opacityStack.top(),
+                        .hasAlpha = pixmap->hasAlphaChannel(),
+                        .coordinateType = NormalizedCoordinates,
+                        .scale = scale,
+                    });
+                }
             }
         }
     } else if (auto imageItem = qobject_cast<ImageItemOpenGL *>(item)) {
@@ -269,6 +358,16 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
     renderContext.transformStack.push(QMatrix4x4());
     renderContext.opacityStack.push(data.opacity());
 
+    // Scale the clip region to device coordinates once rather than for every quad.
+    if (region != infiniteRegion() && !renderContext.hardwareClipping) {
+        renderContext.deviceClipRects.reserve(region.rectCount());
+        for (const QRect &clipRect : region) {
+            const QRectF deviceClipRect = logicalRectToDeviceRect(clipRect, renderContext.renderTargetScale);
+            renderContext.deviceClipRects.append(deviceClipRect);
+            renderContext.deviceClipBounds |= deviceClipRect;
+        }
+    }
+
     item->setTransform(data.toMatrix(renderContext.renderTargetScale));
 
     createRenderNode(item, &renderContext);
@@ -300,7 +399,7 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
 
     for (int i = 0, v = 0; i < renderContext.renderNodes.count(); i++) {
         RenderNode &renderNode = renderContext.renderNodes[i];
-        if (renderNode.geometry.isEmpty() || !renderNode.texture) {
+        if (renderNode.geometry.isEmpty() || (!renderNode.texture && renderNode.color.isNull())) {
             continue;
         }
 
@@ -311,7 +410,9 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
         renderNode.firstVertex = v;
         renderNode.vertexCount = renderNode.geometry.count();
 
-        renderNode.geometry.postProcessTextureCoordinates(renderNode.texture->matrix(renderNode.coordinateType));
+        if (renderNode.texture) {
+            renderNode.geometry.postProcessTextureCoordinates(renderNode.texture->matrix(renderNode.coordinateType));
+        }
 
         renderNode.geometry.copy(std::span(&map[v], renderNode.geometry.count()));
         v += renderNode.geometry.count();
@@ -338,25 +439,59 @@ void ItemRendererOpenGL::renderItem(const RenderTarget &renderTarget, const Rend
         scissorRegion = viewport.mapToRenderTarget(region);
     }
 
-    for (int i = 0; i < renderContext.renderNodes.count(); i++) {
+    const RenderNode *previousNode = nullptr;
+
+    for (int i = 0; i < renderContext.renderNodes.count();) {
         const RenderNode &renderNode = renderContext.renderNodes[i];
         if (renderNode.vertexCount == 0) {
+            i++;
             continue;
         }
 
+        // The vertices of the render nodes are laid out contiguously in the vertex buffer,
+        // so subsequent nodes that need exactly the same state can be drawn in one go.
+        int vertexCount = renderNode.vertexCount;
+        for (i++; i < renderContext.renderNodes.count(); i++) {
+            const RenderNode &nextNode = renderContext.renderNodes[i];
+            if (nextNode.vertexCount == 0) {
+                continue;
+            }
+            if (!canBatch(renderNode, nextNode) || nextNode.firstVertex != renderNode.firstVertex + vertexCount) {
+                break;
+            }
+            vertexCount += nextNode.vertexCount;
+        }
+
         setBlendEnabled(renderNode.hasAlpha || renderNode.opacity < 1.0);
 
-        shader->setUniform(GLShader::ModelViewProjectionMatrix, renderContext.projectionMatrix * renderNode.transformMatrix);
+        if (!renderNode.texture) {
+            // The texture shader keeps its uniforms while the color shader is bound.
+            GLShader *colorShader = ShaderManager::instance()->pushShader(ShaderTrait::UniformColor);
+            colorShader->setUniform(GLShader::ModelViewProjectionMatrix, renderContext.projectionMatrix * renderNode.transformMatrix);
+            colorShader->setUniform(GLShader::Color, adjustColor(renderNode.color, data.saturation()) * modulate(renderNode.opacity, data.brightness()));
+            vbo->draw(scissorRegion, GL_TRIANGLES, renderNode.firstVertex,
+                      vertexCount, renderContext.hardwareClipping);
+            ShaderManager::instance()->popShader();
+            continue;
+        }
+
+        if (!previousNode || previousNode->transformMatrix != renderNode.transformMatrix) {
+            shader->setUniform(GLShader::ModelViewProjectionMatrix, renderContext.projectionMatrix * renderNode.transformMatrix);
+        }
         if (opacity != renderNode.opacity) {
             shader->setUniform(GLShader::ModulationConstant,
                                modulate(renderNode.opacity, data.brightness()));
             opacity = renderNode.opacity;
         }
 
-        renderNode.texture->bind();
+        if (!previousNode || previousNode->texture != renderNode.texture) {
+            renderNode.texture->bind();
+        }
 
         vbo->draw(scissorRegion, GL_TRIANGLES, renderNode.firstVertex,
-                  renderNode.vertexCount, renderContext.hardwareClipping);
+                  vertexCount, renderContext.hardwareClipping);
+
+        previousNode = &renderNode;
     }
 
     ShaderManager::instance()->popShader();
@@ -397,7 +532,7 @@ void ItemRendererOpenGL::visualizeFractional(const RenderViewport &viewport, con
 
     for (int i = 0; i < renderContext.renderNodes.count(); i++) {
         const RenderNode &renderNode = renderContext.renderNodes[i];
-        if (renderNode.vertexCount == 0) {
+        if (renderNode.vertexCount == 0 || !renderNode.texture) {
             continue;
         }
 
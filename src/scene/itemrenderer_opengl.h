@@ -10,15 +10,21 @@
 #include "libkwineffects/kwinglutils.h"
 #include "scene/itemrenderer.h"
 
+#include <unordered_set>
+
 namespace KWin
 {
 
+class SyncReleasePoint;
+
 class KWIN_EXPORT ItemRendererOpenGL : public ItemRenderer
 {
 public:
     struct RenderNode
     {
         GLTexture *texture = nullptr;
+        // the premultiplied color of a node without texture
+        QVector4D color;
         RenderGeometry geometry;
         QMatrix4x4 transformMatrix;
         int firstVertex = 0;
@@ -38,6 +44,8 @@ public:
         const QRegion clip;
         const bool hardwareClipping;
         const qreal renderTargetScale;
+        QVector<QRectF> deviceClipRects;
+        QRectF deviceClipBounds;
     };
 
     ItemRendererOpenGL();
@@ -49,6 +57,7 @@ public:
     void renderItem(const RenderTarget &renderTarget, const RenderViewport &viewport, Item *item, int mask, const QRegion &region, const WindowPaintData &data) override;
 
     ImageItem *createImageItem(Scene *scene, Item *parent = nullptr) override;
+    void prewarm(Item *item) override;
 
 private:
     QVector4D modulate(float opacity, float brightness) const;
@@ -57,6 +66,7 @@ private:
     void visualizeFractional(const RenderViewport &viewport, const QRegion &region, const RenderContext &renderContext);
 
     bool m_blendingEnabled = false;
+    std::unordered_set<std::shared_ptr<SyncReleasePoint>> m_releasePoints;
 
     struct
     {
@@ -6,15 +6,25 @@
 
 #include "scene/itemrenderer_qpainter.h"
 #include "libkwineffects/renderviewport.h"
+#include "platformsupport/scenes/qpainter/qpainterblit.h"
 #include "platformsupport/scenes/qpainter/qpaintersurfacetexture.h"
 #include "scene/imageitem.h"
 #include "scene/workspacescene_qpainter.h"
 
-#include <QPainter>
+#include <QThread>
+#include <QThreadPool>
+
+#include <cmath>
 
 namespace KWin
 {
 
+static QThreadPool *compositingPool()
+{
+    static QThreadPool pool;
+    return &pool;
+}
+
 ItemRendererQPainter::ItemRendererQPainter()
     : m_painter(std::make_unique<QPainter>())
 {
@@ -31,6 +41,8 @@ ImageItem *ItemRendererQPainter::createImageItem(Scene *scene, Item *parent)
 
 QPainter *ItemRendererQPainter::painter() const
 {
+    // whoever paints directly has to paint on top of what's been recorded so far
+    flush();
     return m_painter.get();
 }
 
@@ -39,15 +51,31 @@ void ItemRendererQPainter::beginFrame(const RenderTarget &renderTarget, const Re
     QImage *buffer = renderTarget.image();
     m_painter->begin(buffer);
     m_painter->setWindow(viewport.renderRect().toRect());
+    m_target = buffer;
 }
 
 void ItemRendererQPainter::endFrame()
 {
+    flush();
     m_painter->end();
+    m_target = nullptr;
 }
 
 void ItemRendererQPainter::renderBackground(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRegion &region)
 {
+    const QTransform transform = m_painter->combinedTransform();
+    if (transform.type() <= QTransform::TxScale) {
+        m_commands.push_back(DrawCommand{
+            .transform = transform,
+            .clip = transform.map(region),
+            .compositionMode = QPainter::CompositionMode_Source,
+            .targetRect = region.boundingRect(),
+            .color = Qt::transparent,
+        });
+        return;
+    }
+
+    flush();
     m_painter->setCompositionMode(QPainter::CompositionMode_Source);
     for (const QRect &rect : region) {
         m_painter->fillRect(rect, Qt::transparent);
@@ -73,6 +101,11 @@ void ItemRendererQPainter::renderItem(const RenderTarget &renderTarget, const Re
     m_painter->setClipping(true);
     m_painter->setOpacity(data.opacity());
 
+    const QTransform clipTransform = m_painter->combinedTransform();
+    if (clipTransform.type() <= QTransform::TxScale) {
+        m_deviceClip = clipTransform.map(region);
+    }
+
     if (mask & Scene::PAINT_WINDOW_TRANSFORMED) {
         m_painter->translate(data.xTranslation(), data.yTranslation());
         m_painter->scale(data.xScale(), data.yScale());
@@ -80,12 +113,13 @@ void ItemRendererQPainter::renderItem(const RenderTarget &renderTarget, const Re
 
     renderItem(m_painter.get(), item);
 
+    m_deviceClip.reset();
     m_painter->restore();
 }
 
 void ItemRendererQPainter::renderItem(QPainter *painter, Item *item) const
 {
-    const QList<Item *> sortedChildItems = item->sortedChildItems();
+    const QList<Item *> &sortedChildItems = item->sortedChildItems();
 
     painter->save();
     painter->translate(item->position());
@@ -128,6 +162,19 @@ void ItemRendererQPainter::renderSurfaceItem(QPainter *painter, SurfaceItem *sur
         return;
     }
 
+    if (const std::optional<QVector4D> color = surfaceTexture->solidColor()) {
+        surfaceItem->resetDamage();
+        // QColor expects straight alpha
+        const float alpha = color->w();
+        if (alpha > 0) {
+            const QColor straight = QColor::fromRgbF(color->x() / alpha, color->y() / alpha, color->z() / alpha, alpha);
+            for (const QRectF &rect : surfaceItem->shape()) {
+                fillRect(painter, rect, straight);
+            }
+        }
+        return;
+    }
+
     QPainterSurfaceTexture *platformSurfaceTexture =
         static_cast<QPainterSurfaceTexture *>(surfaceTexture->texture());
     if (!platformSurfaceTexture->isValid()) {
@@ -143,8 +190,7 @@ void ItemRendererQPainter::renderSurfaceItem(QPainter *painter, SurfaceItem *sur
         const QPointF bufferTopLeft = matrix.map(rect.topLeft());
         const QPointF bufferBottomRight = matrix.map(rect.bottomRight());
 
-        painter->drawImage(rect, platformSurfaceTexture->image(),
-                           QRectF(bufferTopLeft, bufferBottomRight));
+        drawImage(painter, rect, platformSurfaceTexture->image(), QRectF(bufferTopLeft, bufferBottomRight));
     }
 }
 
@@ -154,15 +200,151 @@ void ItemRendererQPainter::renderDecorationItem(QPainter *painter, DecorationIte
     QRectF dtr, dlr, drr, dbr;
     decorationItem->window()->layoutDecorationRects(dlr, dtr, drr, dbr);
 
-    painter->drawImage(dtr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Top));
-    painter->drawImage(dlr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Left));
-    painter->drawImage(drr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Right));
-    painter->drawImage(dbr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Bottom));
+    const auto drawPart = [&](const QRectF &rect, SceneQPainterDecorationRenderer::DecorationPart part) {
+        const QImage image = renderer->image(part);
+        drawImage(painter, rect, image, image.rect());
+    };
+    drawPart(dtr, SceneQPainterDecorationRenderer::DecorationPart::Top);
+    drawPart(dlr, SceneQPainterDecorationRenderer::DecorationPart::Left);
+    drawPart(drr, SceneQPainterDecorationRenderer::DecorationPart::Right);
+    drawPart(dbr, SceneQPainterDecorationRenderer::DecorationPart::Bottom);
 }
 
 void ItemRendererQPainter::renderImageItem(QPainter *painter, ImageItem *imageItem) const
 {
-    painter->drawImage(imageItem->rect(), imageItem->image());
+    const QImage image = imageItem->image();
+    drawImage(painter, imageItem->rect(), image, image.rect());
+}
+
+static std::optional<QRect> toExactRect(const QRectF &rect)
+{
+    const QRect exact = rect.toRect();
+    if (std::abs(exact.x() - rect.x()) > 0.001 || std::abs(exact.y() - rect.y()) > 0.001
+        || std::abs(exact.width() - rect.width()) > 0.001 || std::abs(exact.height() - rect.height()) > 0.001) {
+        return std::nullopt;
+    }
+    return exact;
+}
+
+bool ItemRendererQPainter::canRecord(QPainter *painter) const
+{
+    return painter == m_painter.get() && m_target && m_deviceClip;
+}
+
+void ItemRendererQPainter::drawImage(QPainter *painter, const QRectF &targetRect, const QImage &image, const QRectF &sourceRect) const
+{
+    if (!canRecord(painter)) {
+        flush();
+        painter->drawImage(targetRect, image, sourceRect);
+        return;
+    }
+    m_commands.push_back(DrawCommand{
+        .transform = painter->combinedTransform(),
+        .clip = *m_deviceClip,
+        .opacity = painter->opacity(),
+        .image = image,
+        .targetRect = targetRect,
+        .sourceRect = sourceRect,
+    });
+}
+
+void ItemRendererQPainter::fillRect(QPainter *painter, const QRectF &rect, const QColor &color) const
+{
+    if (!canRecord(painter)) {
+        flush();
+        painter->fillRect(rect, color);
+        return;
+    }
+    m_commands.push_back(DrawCommand{
+        .transform = painter->combinedTransform(),
+        .clip = *m_deviceClip,
+        .opacity = painter->opacity(),
+        .targetRect = rect,
+        .color = color,
+    });
+}
+
+void ItemRendererQPainter::replay(const std::vector<DrawCommand> &commands, QImage *target, const QRect &band, bool parallel)
+{
+    QPainter painter(target);
+    for (const DrawCommand &command : commands) {
+        const QRegion clip = command.clip & band;
+        if (clip.isEmpty()) {
+            continue;
+        }
+
+        // Most of the time, images are drawn unscaled or scaled by an integer factor and with
+        // no opacity. Such images are blitted directly, QPainter handles the rest
+        if (!command.image.isNull() && command.opacity == 1.0 && command.compositionMode == QPainter::CompositionMode_SourceOver
+            && command.transform.type() <= QTransform::TxScale && command.transform.m11() > 0 && command.transform.m22() > 0) {
+            const std::optional<QRect> deviceRect = toExactRect(command.transform.mapRect(command.targetRect));
+            const std::optional<QRect> imageRect = toExactRect(command.sourceRect);
+            if (deviceRect && imageRect && blitImage(target, *deviceRect, command.image, *imageRect, clip, BlitMode::SourceOver, parallel)) {
+                continue;
+            }
+        }
+
+        // the clip is set in device coordinates
+        painter.resetTransform();
+        painter.setClipRegion(clip);
+        painter.setTransform(command.transform);
+        painter.setOpacity(command.opacity);
+        painter.setCompositionMode(command.compositionMode);
+        if (command.image.isNull()) {
+            painter.fillRect(command.targetRect, command.color);
+        } else {
+            painter.drawImage(command.targetRect, command.image, command.sourceRect);
+        }
+    }
+}
+
+void ItemRendererQPainter::flush() const
+{
+    if (m_commands.empty()) {
+        return;
+    }
+
+    constexpr int minimumBandHeight = 32;
+    constexpr qint64 minimumParallelPixels = 256 * 256;
+
+    qint64 pixels = 0;
+    for (const DrawCommand &command : m_commands) {
+        const QRect bounds = command.clip.boundingRect();
+        pixels += qint64(bounds.width()) * bounds.height();
+    }
+
+    // The bands are painted through images that share the memory of the render target, as a
+    // paint device can only have one active painter at a time
+    const QRect targetRect = m_target->rect();
+    uchar *bits = m_target->bits();
+    const auto bandImage = [this, bits]() {
+        return QImage(bits, m_target->width(), m_target->height(), m_target->bytesPerLine(), m_target->format());
+    };
+
+    const int bandCount = std::min(QThread::idealThreadCount(), targetRect.height() / minimumBandHeight);
+    if (pixels < minimumParallelPixels || bandCount < 2) {
+        QImage target = bandImage();
+        replay(m_commands, &target, targetRect, true);
+    } else {
+        std::vector<QImage> targets(bandCount);
+        const int bandHeight = (targetRect.height() + bandCount - 1) / bandCount;
+        QThreadPool *pool = compositingPool();
+        for (int i = 0; i < bandCount; ++i) {
+            targets[i] = bandImage();
+            const QRect band(targetRect.x(), targetRect.y() + i * bandHeight, targetRect.width(), bandHeight);
+            if (i == 0) {
+                continue;
+            }
+            pool->start([this, target = &targets[i], band]() {
+                replay(m_commands, target, band, false);
+            });
+        }
+        replay(m_commands, &targets[0], QRect(targetRect.x(), targetRect.y(), targetRect.width(), bandHeight), false);
+        pool->waitForDone();
+    }
+
+    // the images of the surfaces must not be shared anymore when they're updated
+    m_commands.clear();
 }
 
 } // namespace KWin
@@ -8,7 +8,12 @@
 
 #include "scene/itemrenderer.h"
 
-class QPainter;
+#include <QImage>
+#include <QPainter>
+#include <QRegion>
+
+#include <optional>
+#include <vector>
 
 namespace KWin
 {
@@ -33,12 +38,38 @@ public:
     ImageItem *createImageItem(Scene *scene, Item *parent = nullptr) override;
 
 private:
+    /**
+     * A draw call that is recorded while the items are traversed on the main thread. The
+     * recorded draw calls are replayed in horizontal bands of the render target, which are
+     * composited in parallel. The clip is in device coordinates.
+     */
+    struct DrawCommand
+    {
+        QTransform transform;
+        QRegion clip;
+        qreal opacity = 1.0;
+        QPainter::CompositionMode compositionMode = QPainter::CompositionMode_SourceOver;
+        QImage image; // if null, the target rect is filled with the color
+        QRectF targetRect;
+        QRectF sourceRect;
+        QColor color;
+    };
+
     void renderSurfaceItem(QPainter *painter, SurfaceItem *surfaceItem) const;
     void renderDecorationItem(QPainter *painter, DecorationItem *decorationItem) const;
     void renderImageItem(QPainter *painter, ImageItem *imageItem) const;
     void renderItem(QPainter *painter, Item *item) const;
+    void drawImage(QPainter *painter, const QRectF &targetRect, const QImage &image, const QRectF &sourceRect) const;
+    void fillRect(QPainter *painter, const QRectF &rect, const QColor &color) const;
+    bool canRecord(QPainter *painter) const;
+    void flush() const;
+    static void replay(const std::vector<DrawCommand> &commands, QImage *target, const QRect &band, bool parallel);
 
     std::unique_ptr<QPainter> m_painter;
+    QImage *m_target = nullptr;
+    // the clip of the item being rendered in device coordinates, if the painter isn't rotated
+    std::optional<QRegion> m_deviceClip;
+    mutable std::vector<DrawCommand> m_commands;
 };
 
 } // namespace KWin
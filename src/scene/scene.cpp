@@ -34,6 +34,26 @@ SurfaceItem *SceneDelegate::scanoutCandidate() const
     return m_scene->scanoutCandidate();
 }
 
+QList<SurfaceItem *> SceneDelegate::scanoutOverlayCandidates() const
+{
+    return m_scene->scanoutOverlayCandidates();
+}
+
+SurfaceItem *SceneDelegate::overlayCandidate() const
+{
+    return m_scene->overlayCandidate();
+}
+
+void SceneDelegate::setOverlaySurface(SurfaceItem *item)
+{
+    m_scene->setOverlaySurface(item);
+}
+
+int SceneDelegate::contentColorDepth() const
+{
+    return m_scene->contentColorDepth();
+}
+
 void SceneDelegate::prePaint()
 {
     m_scene->prePaint(this);
@@ -134,4 +154,23 @@ SurfaceItem *Scene::scanoutCandidate() const
     return nullptr;
 }
 
+QList<SurfaceItem *> Scene::scanoutOverlayCandidates() const
+{
+    return {};
+}
+
+SurfaceItem *Scene::overlayCandidate() const
+{
+    return nullptr;
+}
+
+void Scene::setOverlaySurface(SurfaceItem *item)
+{
+}
+
+int Scene::contentColorDepth() const
+{
+    return 8;
+}
+
 } // namespace KWin
@@ -30,6 +30,10 @@ public:
 
     QRegion repaints() const override;
     SurfaceItem *scanoutCandidate() const override;
+    QList<SurfaceItem *> scanoutOverlayCandidates() const override;
+    SurfaceItem *overlayCandidate() const override;
+    void setOverlaySurface(SurfaceItem *item) override;
+    int contentColorDepth() const override;
     void prePaint() override;
     void postPaint() override;
     void paint(const RenderTarget &renderTarget, const QRegion &region) override;
@@ -81,6 +85,10 @@ public:
     void removeDelegate(SceneDelegate *delegate);
 
     virtual SurfaceItem *scanoutCandidate() const;
+    virtual QList<SurfaceItem *> scanoutOverlayCandidates() const;
+    virtual SurfaceItem *overlayCandidate() const;
+    virtual void setOverlaySurface(SurfaceItem *item);
+    virtual int contentColorDepth() const;
     virtual void prePaint(SceneDelegate *delegate) = 0;
     virtual void postPaint() = 0;
     virtual void paint(const RenderTarget &renderTarget, const QRegion &region) = 0;
@@ -5,6 +5,8 @@
 */
 
 #include "scene/surfaceitem.h"
+#include "core/syncobjtimeline.h"
+#include "utils/common.h"
 
 namespace KWin
 {
@@ -26,9 +28,9 @@ void SurfaceItem::setSurfaceToBufferMatrix(const QMatrix4x4 &matrix)
 
 void SurfaceItem::addDamage(const QRegion &region)
 {
-    m_damage += region;
+    m_damage = simplifyDamage(m_damage + region);
     scheduleRepaint(region);
-    Q_EMIT damaged();
+    Q_EMIT damaged(region);
 }
 
 void SurfaceItem::resetDamage()
@@ -173,16 +175,31 @@ SurfaceTexture *SurfacePixmap::texture() const
     return m_texture.get();
 }
 
+int SurfacePixmap::colorDepth() const
+{
+    return m_colorDepth;
+}
+
 bool SurfacePixmap::hasAlphaChannel() const
 {
     return m_hasAlphaChannel;
 }
 
+std::optional<QVector4D> SurfacePixmap::solidColor() const
+{
+    return m_solidColor;
+}
+
 QSize SurfacePixmap::size() const
 {
     return m_size;
 }
 
+std::shared_ptr<SyncReleasePoint> SurfacePixmap::bufferReleasePoint() const
+{
+    return m_bufferReleasePoint;
+}
+
 bool SurfacePixmap::isDiscarded() const
 {
     return m_isDiscarded;
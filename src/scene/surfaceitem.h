@@ -9,10 +9,15 @@
 #include "core/output.h"
 #include "scene/item.h"
 
+#include <QVector4D>
+
+#include <optional>
+
 namespace KWin
 {
 
 class SurfacePixmap;
+class SyncReleasePoint;
 class Window;
 
 /**
@@ -43,7 +48,7 @@ public:
     virtual ContentType contentType() const;
 
 Q_SIGNALS:
-    void damaged();
+    void damaged(const QRegion &region);
 
 protected:
     explicit SurfaceItem(Scene *scene, Item *parent = nullptr);
@@ -79,6 +84,17 @@ public:
     bool hasAlphaChannel() const;
     QSize size() const;
 
+    /**
+     * Returns the number of bits per color channel of the attached buffer.
+     */
+    int colorDepth() const;
+
+    /**
+     * Returns the premultiplied color of the pixmap if it consists of a single solid color,
+     * e.g. a single pixel buffer. Such pixmaps are drawn without a texture.
+     */
+    std::optional<QVector4D> solidColor() const;
+
     bool isDiscarded() const;
     void markAsDiscarded();
 
@@ -87,9 +103,17 @@ public:
 
     virtual bool isValid() const = 0;
 
+    /**
+     * Returns the release point of the attached buffer, if the client uses explicit sync.
+     */
+    std::shared_ptr<SyncReleasePoint> bufferReleasePoint() const;
+
 protected:
     QSize m_size;
     bool m_hasAlphaChannel = false;
+    int m_colorDepth = 8;
+    std::optional<QVector4D> m_solidColor;
+    std::shared_ptr<SyncReleasePoint> m_bufferReleasePoint;
 
 private:
     std::unique_ptr<SurfaceTexture> m_texture;
@@ -13,6 +13,8 @@
 #include "window.h"
 #include "x11window.h"
 
+#include <limits>
+
 namespace KWin
 {
 
@@ -28,28 +30,23 @@ SurfaceItemWayland::SurfaceItemWayland(KWaylandServer::SurfaceInterface *surface
     connect(surface, &KWaylandServer::SurfaceInterface::bufferSizeChanged,
             this, &SurfaceItemWayland::discardPixmap);
 
-    connect(surface, &KWaylandServer::SurfaceInterface::childSubSurfacesChanged,
-            this, &SurfaceItemWayland::handleChildSubSurfacesChanged);
     connect(surface, &KWaylandServer::SurfaceInterface::committed,
             this, &SurfaceItemWayland::handleSurfaceCommitted);
     connect(surface, &KWaylandServer::SurfaceInterface::damaged,
             this, &SurfaceItemWayland::addDamage);
-    connect(surface, &KWaylandServer::SurfaceInterface::childSubSurfaceRemoved,
-            this, &SurfaceItemWayland::handleChildSubSurfaceRemoved);
 
+    // The items of the sub-surfaces are updated by the item of the main surface, which gets
+    // the changes in the whole sub-surface tree batched once per commit.
     KWaylandServer::SubSurfaceInterface *subsurface = surface->subSurface();
     if (subsurface) {
-        connect(surface, &KWaylandServer::SurfaceInterface::mapped,
-                this, &SurfaceItemWayland::handleSubSurfaceMappedChanged);
-        connect(surface, &KWaylandServer::SurfaceInterface::unmapped,
-                this, &SurfaceItemWayland::handleSubSurfaceMappedChanged);
-        connect(subsurface, &KWaylandServer::SubSurfaceInterface::positionChanged,
-                this, &SurfaceItemWayland::handleSubSurfacePositionChanged);
         setVisible(surface->isMapped());
         setPosition(subsurface->position());
+    } else {
+        connect(surface, &KWaylandServer::SurfaceInterface::subSurfaceTreeChanged,
+                this, &SurfaceItemWayland::handleSubSurfaceTreeChanged);
     }
 
-    handleChildSubSurfacesChanged();
+    updateChildSubSurfaces();
     setSize(surface->size());
     setSurfaceToBufferMatrix(surface->surfaceToBufferMatrix());
 }
@@ -102,16 +99,49 @@ SurfaceItemWayland *SurfaceItemWayland::getOrCreateSubSurfaceItem(KWaylandServer
     return item;
 }
 
-void SurfaceItemWayland::handleChildSubSurfaceRemoved(KWaylandServer::SubSurfaceInterface *child)
+void SurfaceItemWayland::handleSubSurfaceTreeChanged(KWaylandServer::SubSurfaceTreeChanges changes)
+{
+    const bool restack = changes & (KWaylandServer::SubSurfaceTreeChange::Added | KWaylandServer::SubSurfaceTreeChange::Removed | KWaylandServer::SubSurfaceTreeChange::Restacked);
+    const bool relayout = changes & (KWaylandServer::SubSurfaceTreeChange::Moved | KWaylandServer::SubSurfaceTreeChange::Mapped | KWaylandServer::SubSurfaceTreeChange::Unmapped);
+    if (restack || relayout) {
+        updateSubSurfaceTree(restack);
+    }
+}
+
+void SurfaceItemWayland::updateSubSurfaceTree(bool restack)
 {
-    delete m_subsurfaces.take(child);
+    if (!m_surface) {
+        return;
+    }
+    if (restack) {
+        updateChildSubSurfaces();
+    }
+    for (SurfaceItemWayland *item : std::as_const(m_subsurfaces)) {
+        if (KWaylandServer::SurfaceInterface *surface = item->surface()) {
+            item->setVisible(surface->isMapped());
+            if (KWaylandServer::SubSurfaceInterface *subsurface = surface->subSurface()) {
+                item->setPosition(subsurface->position());
+            }
+        }
+        item->updateSubSurfaceTree(restack);
+    }
 }
 
-void SurfaceItemWayland::handleChildSubSurfacesChanged()
+void SurfaceItemWayland::updateChildSubSurfaces()
 {
     const QList<KWaylandServer::SubSurfaceInterface *> below = m_surface->below();
     const QList<KWaylandServer::SubSurfaceInterface *> above = m_surface->above();
 
+    // the removed sub-surfaces are not referenced anymore, they may be dangling
+    for (auto it = m_subsurfaces.begin(); it != m_subsurfaces.end();) {
+        if (!below.contains(it.key()) && !above.contains(it.key())) {
+            delete it.value();
+            it = m_subsurfaces.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
     for (int i = 0; i < below.count(); ++i) {
         SurfaceItemWayland *subsurfaceItem = getOrCreateSubSurfaceItem(below[i]);
         subsurfaceItem->setZ(i - below.count());
@@ -123,16 +153,6 @@ void SurfaceItemWayland::handleChildSubSurfacesChanged()
     }
 }
 
-void SurfaceItemWayland::handleSubSurfacePositionChanged()
-{
-    setPosition(m_surface->subSurface()->position());
-}
-
-void SurfaceItemWayland::handleSubSurfaceMappedChanged()
-{
-    setVisible(m_surface->isMapped());
-}
-
 std::unique_ptr<SurfacePixmap> SurfaceItemWayland::createPixmap()
 {
     return std::make_unique<SurfacePixmapWayland>(this);
@@ -152,6 +172,7 @@ SurfacePixmapWayland::SurfacePixmapWayland(SurfaceItemWayland *item, QObject *pa
 SurfacePixmapWayland::~SurfacePixmapWayland()
 {
     setBuffer(nullptr);
+    m_bufferReleasePoint.reset();
 }
 
 SurfaceItemWayland *SurfacePixmapWayland::item() const
@@ -179,6 +200,7 @@ void SurfacePixmapWayland::update()
     KWaylandServer::SurfaceInterface *surface = m_item->surface();
     if (surface) {
         setBuffer(surface->buffer());
+        m_bufferReleasePoint = surface->bufferReleasePoint();
     }
 }
 
@@ -199,7 +221,14 @@ void SurfacePixmapWayland::setBuffer(GraphicsBuffer *buffer)
     if (m_buffer) {
         m_buffer->ref();
         m_hasAlphaChannel = m_buffer->hasAlphaChannel();
+        m_colorDepth = m_buffer->colorDepth();
         m_size = m_buffer->size();
+        if (const SinglePixelAttributes *pixel = m_buffer->singlePixelAttributes()) {
+            constexpr double max = std::numeric_limits<uint32_t>::max();
+            m_solidColor = QVector4D(pixel->red / max, pixel->green / max, pixel->blue / max, pixel->alpha / max);
+        } else {
+            m_solidColor.reset();
+        }
     }
 }
 
@@ -7,11 +7,11 @@
 #pragma once
 
 #include "scene/surfaceitem.h"
+#include "wayland/surface_interface.h"
 
 namespace KWaylandServer
 {
 class SubSurfaceInterface;
-class SurfaceInterface;
 }
 
 namespace KWin
@@ -41,16 +41,15 @@ private Q_SLOTS:
     void handleSurfaceCommitted();
     void handleSurfaceSizeChanged();
 
-    void handleChildSubSurfaceRemoved(KWaylandServer::SubSurfaceInterface *child);
-    void handleChildSubSurfacesChanged();
-    void handleSubSurfacePositionChanged();
-    void handleSubSurfaceMappedChanged();
+    void handleSubSurfaceTreeChanged(KWaylandServer::SubSurfaceTreeChanges changes);
 
 protected:
     std::unique_ptr<SurfacePixmap> createPixmap() override;
 
 private:
     SurfaceItemWayland *getOrCreateSubSurfaceItem(KWaylandServer::SubSurfaceInterface *s);
+    void updateChildSubSurfaces();
+    void updateSubSurfaceTree(bool restack);
 
     QPointer<KWaylandServer::SurfaceInterface> m_surface;
     QHash<KWaylandServer::SubSurfaceInterface *, SurfaceItemWayland *> m_subsurfaces;
@@ -150,7 +150,7 @@ bool WindowItem::computeVisibility() const
         return m_window->isLockScreen() || m_window->isInputMethod() || m_window->isLockScreenOverlay();
     }
     if (m_window->isDeleted()) {
-        if (m_forceVisibleByDeleteCount == 0) {
+        if (m_forceVisibleByDeleteCount == 0 || m_resourcesReleased) {
             return false;
         }
     }
@@ -182,6 +182,33 @@ void WindowItem::updateVisibility()
     setVisible(computeVisibility());
 }
 
+static void destroySurfacePixmaps(Item *item)
+{
+    if (auto surfaceItem = qobject_cast<SurfaceItem *>(item)) {
+        surfaceItem->destroyPixmap();
+    }
+    const auto children = item->childItems();
+    for (Item *child : children) {
+        destroySurfacePixmaps(child);
+    }
+}
+
+void WindowItem::releaseResources()
+{
+    Q_ASSERT(m_window->isDeleted());
+    if (m_resourcesReleased) {
+        return;
+    }
+    m_resourcesReleased = true;
+    updateVisibility();
+
+    if (m_surfaceItem) {
+        destroySurfacePixmaps(m_surfaceItem.get());
+    }
+    m_decorationItem.reset();
+    m_shadowItem.reset();
+}
+
 void WindowItem::updatePosition()
 {
     setPosition(m_window->pos());
@@ -190,7 +217,9 @@ void WindowItem::updatePosition()
 void WindowItem::addSurfaceItemDamageConnects(Item *item)
 {
     auto surfaceItem = static_cast<SurfaceItem *>(item);
-    connect(surfaceItem, &SurfaceItem::damaged, this, &WindowItem::markDamaged);
+    connect(surfaceItem, &SurfaceItem::damaged, this, [this, surfaceItem](const QRegion &region) {
+        markSurfaceDamaged(surfaceItem, region);
+    });
     connect(surfaceItem, &SurfaceItem::childAdded, this, &WindowItem::addSurfaceItemDamageConnects);
     const auto childItems = item->childItems();
     for (const auto &child : childItems) {
@@ -232,6 +261,9 @@ void WindowItem::updateSurfaceVisibility()
 
 void WindowItem::updateShadowItem()
 {
+    if (m_resourcesReleased) {
+        return;
+    }
     Shadow *shadow = m_window->shadow();
     if (shadow) {
         if (!m_shadowItem || m_shadowItem->shadow() != shadow) {
@@ -283,7 +315,12 @@ void WindowItem::updateStackingOrder()
 
 void WindowItem::markDamaged()
 {
-    Q_EMIT m_window->damaged(m_window);
+    Q_EMIT m_window->damaged(m_window, infiniteRegion());
+}
+
+void WindowItem::markSurfaceDamaged(SurfaceItem *surfaceItem, const QRegion &region)
+{
+    Q_EMIT m_window->damaged(m_window, surfaceItem->mapToGlobal(region));
 }
 
 WindowItemX11::WindowItemX11(X11Window *window, Scene *scene, Item *parent)
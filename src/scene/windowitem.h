@@ -52,6 +52,13 @@ public:
     void refVisible(int reason);
     void unrefVisible(int reason);
 
+    /**
+     * Releases the textures of the closed window, i.e. the buffers of its surfaces, its
+     * decoration and its shadow. The window is not painted anymore afterwards, even if an
+     * effect still keeps it visible for a close animation.
+     */
+    void releaseResources();
+
     void elevate();
     void deelevate();
 
@@ -73,6 +80,7 @@ private:
     bool computeVisibility() const;
     void updateVisibility();
     void markDamaged();
+    void markSurfaceDamaged(SurfaceItem *surfaceItem, const QRegion &region);
 
     Window *m_window;
     std::unique_ptr<SurfaceItem> m_surfaceItem;
@@ -84,6 +92,7 @@ private:
     int m_forceVisibleByDesktopCount = 0;
     int m_forceVisibleByMinimizeCount = 0;
     int m_forceVisibleByActivityCount = 0;
+    bool m_resourcesReleased = false;
 };
 
 /**
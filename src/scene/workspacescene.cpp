@@ -66,6 +66,7 @@
 #include "scene/surfaceitem.h"
 #include "scene/windowitem.h"
 #include "shadow.h"
+#include "virtualdesktops.h"
 #include "wayland/seat_interface.h"
 #include "wayland/surface_interface.h"
 #include "wayland_server.h"
@@ -73,6 +74,8 @@
 #include "workspace.h"
 #include "x11window.h"
 
+#include <QElapsedTimer>
+#include <QVarLengthArray>
 #include <QtMath>
 
 namespace KWin
@@ -82,10 +85,24 @@ namespace KWin
 // Scene
 //****************************************
 
+// how often occluded windows receive frame callbacks
+static constexpr std::chrono::seconds s_occludedFrameCallbackInterval(1);
+// how much of a frame may be spent on preparing the windows of the adjacent desktops
+static constexpr std::chrono::microseconds s_prewarmBudget(1000);
+
 WorkspaceScene::WorkspaceScene(std::unique_ptr<ItemRenderer> renderer)
     : Scene(std::move(renderer))
     , m_containerItem(std::make_unique<Item>(this))
+    , m_overlayItem(std::make_unique<Item>(this))
 {
+    m_occludedFrameTimer.setSingleShot(true);
+    m_occludedFrameTimer.setInterval(s_occludedFrameCallbackInterval);
+    connect(&m_occludedFrameTimer, &QTimer::timeout, this, &WorkspaceScene::sendOccludedFrameCallbacks);
+
+    // runs once control returns to the event loop, i.e. after the frame has been presented
+    m_prewarmTimer.setSingleShot(true);
+    m_prewarmTimer.setInterval(0);
+    connect(&m_prewarmTimer, &QTimer::timeout, this, &WorkspaceScene::prewarmAdjacentDesktops);
 }
 
 WorkspaceScene::~WorkspaceScene()
@@ -135,6 +152,19 @@ Item *WorkspaceScene::containerItem() const
     return m_containerItem.get();
 }
 
+Item *WorkspaceScene::overlayItem() const
+{
+    return m_overlayItem.get();
+}
+
+static bool hasVisibleChildItems(Item *item)
+{
+    const QList<Item *> &children = item->childItems();
+    return std::any_of(children.cbegin(), children.cend(), [](Item *child) {
+        return child->isVisible();
+    });
+}
+
 QRegion WorkspaceScene::damage() const
 {
     return m_paintContext.damage;
@@ -142,7 +172,7 @@ QRegion WorkspaceScene::damage() const
 
 static SurfaceItem *findTopMostSurface(SurfaceItem *item)
 {
-    const QList<Item *> children = item->childItems();
+    const QList<Item *> &children = item->childItems();
     if (children.isEmpty()) {
         return item;
     } else {
@@ -150,18 +180,67 @@ static SurfaceItem *findTopMostSurface(SurfaceItem *item)
     }
 }
 
+static SurfaceItem *findOverlaySurface(WindowItem *windowItem, int mask)
+{
+    Window *window = windowItem->window();
+    if (window->opacity() != 1.0) {
+        return nullptr;
+    }
+    if (mask & (Effect::PAINT_WINDOW_TRANSLUCENT | Effect::PAINT_WINDOW_TRANSFORMED)) {
+        return nullptr;
+    }
+    // the window must consist of nothing but its main surface; decorations, shadows and
+    // background effects have to be composited
+    if (windowItem->decorationItem() || windowItem->shadowItem()) {
+        return nullptr;
+    }
+    SurfaceItem *surfaceItem = windowItem->surfaceItem();
+    if (!surfaceItem || !surfaceItem->childItems().isEmpty()) {
+        return nullptr;
+    }
+    const KWaylandServer::SurfaceInterface *surface = window->surface();
+    if (!surface || !surface->blur().isNull() || !surface->contrast().isNull()) {
+        return nullptr;
+    }
+    return surfaceItem;
+}
+
 SurfaceItem *WorkspaceScene::scanoutCandidate() const
+{
+    QList<SurfaceItem *> overlays;
+    return findScanoutCandidate(&overlays);
+}
+
+QList<SurfaceItem *> WorkspaceScene::scanoutOverlayCandidates() const
+{
+    QList<SurfaceItem *> overlays;
+    if (!findScanoutCandidate(&overlays)) {
+        return {};
+    }
+    return overlays;
+}
+
+SurfaceItem *WorkspaceScene::findScanoutCandidate(QList<SurfaceItem *> *overlays) const
 {
     if (!waylandServer()) {
         return nullptr;
     }
     SurfaceItem *candidate = nullptr;
-    if (!static_cast<EffectsHandlerImpl *>(effects)->blocksDirectScanout()) {
+    if (!static_cast<EffectsHandlerImpl *>(effects)->blocksDirectScanout() && !hasVisibleChildItems(m_overlayItem.get())) {
         for (int i = stacking_order.count() - 1; i >= 0; i--) {
             WindowItem *windowItem = stacking_order[i];
             Window *window = windowItem->window();
             if (window->isOnOutput(painted_screen) && window->opacity() > 0) {
-                if (!window->isClient() || !window->isFullScreen() || window->opacity() != 1.0) {
+                // small popups such as volume OSDs and panels can be put on an overlay plane instead
+                if ((window->isOnScreenDisplay() || window->isDock()) && i < m_paintContext.phase2Data.size()) {
+                    if (SurfaceItem *overlay = findOverlaySurface(windowItem, m_paintContext.phase2Data[i].mask)) {
+                        overlays->append(overlay);
+                        continue;
+                    }
+                }
+                // if nothing but the wallpaper is shown, it can be put on the primary plane
+                const bool wallpaper = window->isDesktop() && window->frameGeometry() == painted_screen->geometry();
+                if (!window->isClient() || !(window->isFullScreen() || wallpaper) || window->opacity() != 1.0) {
                     break;
                 }
                 if (!windowItem->surfaceItem()) {
@@ -184,6 +263,91 @@ SurfaceItem *WorkspaceScene::scanoutCandidate() const
     return candidate;
 }
 
+SurfaceItem *WorkspaceScene::overlayCandidate() const
+{
+    if (!waylandServer() || static_cast<EffectsHandlerImpl *>(effects)->blocksDirectScanout()) {
+        return nullptr;
+    }
+    if (m_paintContext.mask & (PAINT_SCREEN_TRANSFORMED | PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS)) {
+        return nullptr;
+    }
+
+    // Pick the biggest opaque surface that isn't covered by anything. The overlay plane is
+    // placed on top of the primary plane, so nothing may be painted over the surface.
+    // If there is none, a panel can be put on the overlay plane, it's usually static but
+    // would have to be blended into the primary plane whenever something below it changes.
+    SurfaceItem *candidate = nullptr;
+    SurfaceItem *panel = nullptr;
+    qreal candidateArea = 0;
+    QRegion occluded;
+    if (m_dndIcon && m_dndIcon->isVisible()) {
+        occluded += m_dndIcon->mapToGlobal(m_dndIcon->boundingRect()).toAlignedRect();
+    }
+    if (hasVisibleChildItems(m_overlayItem.get())) {
+        occluded += m_overlayItem->mapToGlobal(m_overlayItem->boundingRect()).toAlignedRect();
+    }
+    for (int i = m_paintContext.phase2Data.size() - 1; i >= 0; --i) {
+        const auto &paintData = m_paintContext.phase2Data.at(i);
+        WindowItem *windowItem = paintData.item;
+        Window *window = windowItem->window();
+        if (!window->isOnOutput(painted_screen)) {
+            continue;
+        }
+        SurfaceItem *surfaceItem = windowItem->surfaceItem();
+        if (surfaceItem && surfaceItem->childItems().isEmpty() && window->isClient() && window->opacity() == 1.0
+            && !(paintData.mask & (PAINT_WINDOW_TRANSLUCENT | PAINT_WINDOW_TRANSFORMED))) {
+            const QRectF rect = surfaceItem->mapToGlobal(surfaceItem->rect());
+            const qreal area = rect.width() * rect.height();
+            if (area > candidateArea
+                && surfaceItem->opaque().contains(surfaceItem->rect().toRect())
+                && !occluded.intersects(rect.toAlignedRect())) {
+                candidate = surfaceItem;
+                candidateArea = area;
+            }
+        }
+        if (!panel && window->isDock()) {
+            SurfaceItem *panelItem = findOverlaySurface(windowItem, paintData.mask);
+            if (panelItem && !occluded.intersects(windowItem->mapToGlobal(windowItem->boundingRect()).toAlignedRect())) {
+                panel = panelItem;
+            }
+        }
+        occluded += windowItem->mapToGlobal(windowItem->boundingRect()).toAlignedRect();
+    }
+    return candidate ? candidate : panel;
+}
+
+void WorkspaceScene::setOverlaySurface(SurfaceItem *item)
+{
+    m_overlaySurface = item;
+}
+
+static int surfaceColorDepth(SurfaceItem *item)
+{
+    int depth = 8;
+    if (item->isVisible()) {
+        if (SurfacePixmap *pixmap = item->pixmap()) {
+            depth = pixmap->colorDepth();
+        }
+        for (Item *child : item->childItems()) {
+            depth = std::max(depth, surfaceColorDepth(static_cast<SurfaceItem *>(child)));
+        }
+    }
+    return depth;
+}
+
+int WorkspaceScene::contentColorDepth() const
+{
+    int depth = 8;
+    for (const auto &paintData : m_paintContext.phase2Data) {
+        if (!paintData.occluded && paintData.item->window()->isOnOutput(painted_screen)) {
+            if (SurfaceItem *surfaceItem = paintData.item->surfaceItem()) {
+                depth = std::max(depth, surfaceColorDepth(surfaceItem));
+            }
+        }
+    }
+    return depth;
+}
+
 void WorkspaceScene::prePaint(SceneDelegate *delegate)
 {
     createStackingOrder();
@@ -223,6 +387,7 @@ void WorkspaceScene::prePaint(SceneDelegate *delegate)
     m_paintContext.damage = prePaintData.paint;
     m_paintContext.mask = prePaintData.mask;
     m_paintContext.phase2Data.clear();
+    m_overlaySurface = nullptr;
 
     if (m_paintContext.mask & (PAINT_SCREEN_TRANSFORMED | PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS)) {
         preparePaintGenericScreen();
@@ -233,9 +398,12 @@ void WorkspaceScene::prePaint(SceneDelegate *delegate)
 
 static void resetRepaintsHelper(Item *item, SceneDelegate *delegate)
 {
+    if (!item->hasPendingRepaints(delegate)) {
+        return;
+    }
     item->resetRepaints(delegate);
 
-    const auto childItems = item->childItems();
+    const QList<Item *> &childItems = item->childItems();
     for (Item *childItem : childItems) {
         resetRepaintsHelper(childItem, delegate);
     }
@@ -243,10 +411,13 @@ static void resetRepaintsHelper(Item *item, SceneDelegate *delegate)
 
 static void accumulateRepaints(Item *item, SceneDelegate *delegate, QRegion *repaints)
 {
+    if (!item->hasPendingRepaints(delegate)) {
+        return;
+    }
     *repaints += item->repaints(delegate);
     item->resetRepaints(delegate);
 
-    const auto childItems = item->childItems();
+    const QList<Item *> &childItems = item->childItems();
     for (Item *childItem : childItems) {
         accumulateRepaints(childItem, delegate, repaints);
     }
@@ -275,6 +446,7 @@ void WorkspaceScene::preparePaintGenericScreen()
 
 void WorkspaceScene::preparePaintSimpleScreen()
 {
+    const QRect viewport = painted_delegate->viewport();
     for (WindowItem *windowItem : std::as_const(stacking_order)) {
         Window *window = windowItem->window();
         WindowPrePaintData data;
@@ -282,7 +454,8 @@ void WorkspaceScene::preparePaintSimpleScreen()
         accumulateRepaints(windowItem, painted_delegate, &data.paint);
 
         // Clip out the decoration for opaque windows; the decoration is drawn in the second pass.
-        if (window->opacity() == 1.0) {
+        // The opaque region of a window on another output doesn't occlude anything here.
+        if (window->opacity() == 1.0 && windowItem->mapToGlobal(windowItem->boundingRect()).intersects(viewport)) {
             const SurfaceItem *surfaceItem = windowItem->surfaceItem();
             if (Q_LIKELY(surfaceItem)) {
                 data.opaque = surfaceItem->mapToGlobal(surfaceItem->opaque());
@@ -304,10 +477,15 @@ void WorkspaceScene::preparePaintSimpleScreen()
     }
 
     // Perform an occlusion cull pass, remove surface damage occluded by opaque windows.
+    const QRect screenGeometry = painted_screen->geometry();
     QRegion opaque;
     for (int i = m_paintContext.phase2Data.size() - 1; i >= 0; --i) {
-        const auto &paintData = m_paintContext.phase2Data.at(i);
+        auto &paintData = m_paintContext.phase2Data[i];
         m_paintContext.damage += paintData.region - opaque;
+        if (!(paintData.mask & PAINT_WINDOW_TRANSFORMED)) {
+            const QRect visibleRect = paintData.item->mapToGlobal(paintData.item->boundingRect()).toAlignedRect() & screenGeometry;
+            paintData.occluded = (QRegion(visibleRect) - opaque).isEmpty();
+        }
         if (!(paintData.mask & (PAINT_WINDOW_TRANSLUCENT | PAINT_WINDOW_TRANSFORMED))) {
             opaque += paintData.opaque;
         }
@@ -316,6 +494,7 @@ void WorkspaceScene::preparePaintSimpleScreen()
     if (m_dndIcon) {
         accumulateRepaints(m_dndIcon.get(), painted_delegate, &m_paintContext.damage);
     }
+    accumulateRepaints(m_overlayItem.get(), painted_delegate, &m_paintContext.damage);
 }
 
 void WorkspaceScene::postPaint()
@@ -324,18 +503,35 @@ void WorkspaceScene::postPaint()
         const std::chrono::milliseconds frameTime =
             std::chrono::duration_cast<std::chrono::milliseconds>(painted_screen->renderLoop()->lastPresentationTimestamp());
 
-        for (WindowItem *windowItem : std::as_const(stacking_order)) {
-            Window *window = windowItem->window();
+        for (const Phase2Data &paintData : std::as_const(m_paintContext.phase2Data)) {
+            Window *window = paintData.item->window();
             if (!window->isOnOutput(painted_screen)) {
                 continue;
             }
             if (auto surface = window->surface()) {
+                // Hidden clients don't need to render at the refresh rate, they are throttled,
+                // unless they're also shown in a screen cast or a thumbnail.
+                if (paintData.occluded && !window->isOffscreenRendering()) {
+                    if (!m_occludedSurfaces.contains(surface)) {
+                        m_occludedSurfaces.append(surface);
+                    }
+                    if (!m_occludedFrameTimer.isActive()) {
+                        m_occludedFrameTimer.start();
+                    }
+                    continue;
+                }
                 surface->frameRendered(frameTime.count());
+                if (auto feedback = surface->takePresentationFeedback(painted_screen)) {
+                    painted_screen->renderLoop()->addPresentationFeedback(std::move(feedback));
+                }
             }
         }
 
         if (m_dndIcon) {
             m_dndIcon->frameRendered(frameTime.count());
+            if (auto feedback = m_dndIcon->takePresentationFeedback(painted_screen)) {
+                painted_screen->renderLoop()->addPresentationFeedback(std::move(feedback));
+            }
         }
     }
 
@@ -348,6 +544,18 @@ void WorkspaceScene::postPaint()
     clearStackingOrder();
 }
 
+void WorkspaceScene::sendOccludedFrameCallbacks()
+{
+    const std::chrono::milliseconds frameTime =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    const auto surfaces = std::exchange(m_occludedSurfaces, {});
+    for (KWaylandServer::SurfaceInterface *surface : surfaces) {
+        if (surface) {
+            surface->frameRendered(frameTime.count());
+        }
+    }
+}
+
 void WorkspaceScene::paint(const RenderTarget &renderTarget, const QRegion &region)
 {
     Output *output = kwinApp()->operationMode() == Application::OperationMode::OperationModeX11 ? nullptr : painted_screen;
@@ -360,6 +568,62 @@ void WorkspaceScene::paint(const RenderTarget &renderTarget, const QRegion &regi
     Q_EMIT frameRendered();
 
     m_renderer->endFrame();
+
+    if (!m_prewarmTimer.isActive()) {
+        m_prewarmTimer.start();
+    }
+}
+
+/**
+ * Switching to another virtual desktop shows all of its windows at once, and every window
+ * whose contents changed while it was hidden would have to be uploaded in that first frame.
+ * The windows of the neighbouring desktops are kept up to date in the spare time after
+ * each frame has been presented instead, so desktop switch animations start smoothly.
+ */
+void WorkspaceScene::prewarmAdjacentDesktops()
+{
+    VirtualDesktopManager *manager = VirtualDesktopManager::self();
+    if (manager->count() < 2 || (waylandServer() && waylandServer()->isScreenLocked())) {
+        return;
+    }
+
+    VirtualDesktop *current = manager->currentDesktop();
+    const bool wrap = manager->isNavigationWrappingAround();
+    QVarLengthArray<VirtualDesktop *, 4> adjacentDesktops;
+    for (VirtualDesktop *desktop : {manager->toLeft(current, wrap), manager->toRight(current, wrap), manager->above(current, wrap), manager->below(current, wrap)}) {
+        if (desktop && desktop != current && !adjacentDesktops.contains(desktop)) {
+            adjacentDesktops.append(desktop);
+        }
+    }
+    if (adjacentDesktops.isEmpty()) {
+        return;
+    }
+
+    // the frame has been presented already, so the context may not be current anymore
+    if (effects->isOpenGLCompositing() && !makeOpenGLContextCurrent()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const QList<Window *> windows = workspace()->stackingOrder();
+    for (Window *window : windows) {
+        WindowItem *windowItem = window->windowItem();
+        if (!windowItem || windowItem->isVisible() || window->isDeleted() || window->isMinimized() || window->isOnCurrentDesktop()) {
+            continue;
+        }
+        const bool adjacent = std::any_of(adjacentDesktops.cbegin(), adjacentDesktops.cend(), [window](VirtualDesktop *desktop) {
+            return window->isOnDesktop(desktop);
+        });
+        if (!adjacent) {
+            continue;
+        }
+        m_renderer->prewarm(windowItem);
+        if (timer.nsecsElapsed() > std::chrono::nanoseconds(s_prewarmBudget).count()) {
+            break;
+        }
+    }
 }
 
 // the function that'll be eventually called by paintScreen() above
@@ -388,6 +652,8 @@ void WorkspaceScene::paintGenericScreen(const RenderTarget &renderTarget, const
     for (const Phase2Data &paintData : std::as_const(m_paintContext.phase2Data)) {
         paintWindow(renderTarget, viewport, paintData.item, paintData.mask, paintData.region);
     }
+
+    paintOverlayItems(renderTarget, viewport, infiniteRegion());
 }
 
 // The optimized case without any transformations at all.
@@ -408,6 +674,10 @@ void WorkspaceScene::paintSimpleScreen(const RenderTarget &renderTarget, const R
                 visible -= data->opaque;
             }
         }
+        // the surface is shown on an overlay plane, only what's below it has to be painted
+        if (m_overlaySurface && data->item->surfaceItem() == m_overlaySurface) {
+            data->region -= m_overlaySurface->mapToGlobal(m_overlaySurface->rect()).toAlignedRect();
+        }
     }
 
     m_renderer->renderBackground(renderTarget, viewport, visible);
@@ -422,12 +692,25 @@ void WorkspaceScene::paintSimpleScreen(const RenderTarget &renderTarget, const R
             m_renderer->renderItem(renderTarget, viewport, m_dndIcon.get(), 0, repaint, WindowPaintData(viewport.projectionMatrix()));
         }
     }
+
+    paintOverlayItems(renderTarget, viewport, region);
+}
+
+void WorkspaceScene::paintOverlayItems(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRegion &region)
+{
+    if (!hasVisibleChildItems(m_overlayItem.get())) {
+        return;
+    }
+    const QRegion repaint = region & m_overlayItem->mapToGlobal(m_overlayItem->boundingRect()).toAlignedRect();
+    if (!repaint.isEmpty()) {
+        m_renderer->renderItem(renderTarget, viewport, m_overlayItem.get(), 0, repaint, WindowPaintData(viewport.projectionMatrix()));
+    }
 }
 
 void WorkspaceScene::createStackingOrder()
 {
-    QList<Item *> items = m_containerItem->sortedChildItems();
-    for (Item *item : std::as_const(items)) {
+    const QList<Item *> &items = m_containerItem->sortedChildItems();
+    for (Item *item : items) {
         WindowItem *windowItem = static_cast<WindowItem *>(item);
         if (windowItem->isVisible()) {
             stacking_order.append(windowItem);
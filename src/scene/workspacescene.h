@@ -19,6 +19,13 @@
 
 #include <QElapsedTimer>
 #include <QMatrix4x4>
+#include <QPointer>
+#include <QTimer>
+
+namespace KWaylandServer
+{
+class SurfaceInterface;
+}
 
 namespace KWin
 {
@@ -53,9 +60,18 @@ public:
     void initialize();
 
     Item *containerItem() const;
+    /**
+     * Returns the parent of the items that are painted on top of all windows, such as the
+     * outline and on-screen notifications that are drawn without a window.
+     */
+    Item *overlayItem() const;
 
     QRegion damage() const override;
     SurfaceItem *scanoutCandidate() const override;
+    QList<SurfaceItem *> scanoutOverlayCandidates() const override;
+    SurfaceItem *overlayCandidate() const override;
+    void setOverlaySurface(SurfaceItem *item) override;
+    int contentColorDepth() const override;
     void prePaint(SceneDelegate *delegate) override;
     void postPaint() override;
     void paint(const RenderTarget &renderTarget, const QRegion &region) override;
@@ -97,6 +113,7 @@ protected:
     // shared implementation of painting the screen in an optimized way
     void preparePaintSimpleScreen();
     void paintSimpleScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region);
+    void paintOverlayItems(const RenderTarget &renderTarget, const RenderViewport &viewport, const QRegion &region);
     // called after all effects had their paintWindow() called
     void finalPaintWindow(const RenderTarget &renderTarget, const RenderViewport &viewport, EffectWindowImpl *w, int mask, const QRegion &region, WindowPaintData &data);
     // shared implementation, starts painting the window
@@ -111,6 +128,8 @@ protected:
         QRegion region;
         QRegion opaque;
         int mask = 0;
+        // whether the window is completely hidden behind opaque windows on the painted screen
+        bool occluded = false;
     };
 
     struct PaintContext
@@ -129,14 +148,25 @@ protected:
 
 private:
     void createDndIconItem();
+    SurfaceItem *findScanoutCandidate(QList<SurfaceItem *> *overlays) const;
     void destroyDndIconItem();
+    void sendOccludedFrameCallbacks();
+    void prewarmAdjacentDesktops();
 
     std::chrono::milliseconds m_expectedPresentTimestamp = std::chrono::milliseconds::zero();
     // how many times finalPaintScreen() has been called
     int m_paintScreenCount = 0;
     PaintContext m_paintContext;
+    // the surface that is shown on an overlay plane in the current frame
+    SurfaceItem *m_overlaySurface = nullptr;
     std::unique_ptr<Item> m_containerItem;
     std::unique_ptr<DragAndDropIconItem> m_dndIcon;
+    std::unique_ptr<Item> m_overlayItem;
+    // occluded surfaces only receive frame callbacks when this timer fires
+    QTimer m_occludedFrameTimer;
+    QVector<QPointer<KWaylandServer::SurfaceInterface>> m_occludedSurfaces;
+    // prepares the windows of the adjacent desktops after the current frame
+    QTimer m_prewarmTimer;
 };
 
 } // namespace
@@ -18,14 +18,23 @@
 #include "composite.h"
 #include "core/output.h"
 #include "decorations/decoratedclient.h"
+#include "main.h"
 #include "scene/itemrenderer_opengl.h"
 #include "shadow.h"
+#include "utils/common.h"
 #include "window.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <functional>
 
+#include <QHash>
 #include <QMatrix4x4>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLPaintDevice>
 #include <QPainter>
 #include <QStringList>
 #include <QVector2D>
@@ -35,6 +44,219 @@
 namespace KWin
 {
 
+/**
+ * The DecorationGLPainter paints decorations with the OpenGL paint engine in a context that
+ * shares its textures with the compositor's, so the decoration pixels don't need to be
+ * rasterized on the CPU and uploaded. Set KWIN_DECORATION_GL_PAINTER=1 to enable it.
+ */
+class DecorationGLPainter
+{
+public:
+    static std::unique_ptr<DecorationGLPainter> create(WorkspaceSceneOpenGL *scene);
+    ~DecorationGLPainter();
+
+    /**
+     * Paints an image of the given @p size and copies it to @p target at @p offset, with
+     * the rows in the same order as GLTexture::update() would upload them. The pixels
+     * outside of @p viewport are filled by repeating the edges of the viewport.
+     */
+    bool paint(GLFramebuffer *target, const QPoint &offset, const QSize &size, const QRect &viewport,
+               qreal devicePixelRatio, const std::function<void(QPainter *)> &callback);
+
+private:
+    explicit DecorationGLPainter(WorkspaceSceneOpenGL *scene);
+    bool ensureFramebuffers(const QSize &size);
+    void clamp(const QSize &size, const QRect &viewport);
+
+    WorkspaceSceneOpenGL *m_scene;
+    bool m_supportsFences;
+    std::unique_ptr<QOpenGLContext> m_context;
+    std::unique_ptr<QOffscreenSurface> m_surface;
+    std::unique_ptr<QOpenGLFramebufferObject> m_multisampleFramebuffer;
+    std::unique_ptr<QOpenGLFramebufferObject> m_resolveFramebuffer;
+    // m_resolveFramebuffer's texture, as seen from the compositor's context
+    std::unique_ptr<GLTexture> m_texture;
+    std::unique_ptr<GLFramebuffer> m_textureFramebuffer;
+};
+
+DecorationGLPainter::DecorationGLPainter(WorkspaceSceneOpenGL *scene)
+    : m_scene(scene)
+{
+    if (GLPlatform::instance()->isGLES()) {
+        m_supportsFences = hasGLVersion(3, 0);
+    } else {
+        m_supportsFences = hasGLVersion(3, 2) || hasGLExtension(QByteArrayLiteral("GL_ARB_sync"));
+    }
+}
+
+DecorationGLPainter::~DecorationGLPainter()
+{
+    if (m_context && m_context->makeCurrent(m_surface.get())) {
+        m_multisampleFramebuffer.reset();
+        m_resolveFramebuffer.reset();
+        m_context->doneCurrent();
+    }
+    m_scene->makeOpenGLContextCurrent();
+}
+
+std::unique_ptr<DecorationGLPainter> DecorationGLPainter::create(WorkspaceSceneOpenGL *scene)
+{
+    if (qEnvironmentVariableIntValue("KWIN_DECORATION_GL_PAINTER") != 1) {
+        return nullptr;
+    }
+    // The compositor's context is only shared with the contexts created by Qt on Wayland
+    if (kwinApp()->operationMode() == Application::OperationModeX11) {
+        return nullptr;
+    }
+    if (!GLFramebuffer::blitSupported()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<DecorationGLPainter> painter(new DecorationGLPainter(scene));
+
+    painter->m_context = std::make_unique<QOpenGLContext>();
+    painter->m_context->setShareContext(QOpenGLContext::globalShareContext());
+    if (!painter->m_context->create()) {
+        qCWarning(KWIN_OPENGL) << "Failed to create an OpenGL context for decorations";
+        return nullptr;
+    }
+
+    painter->m_surface = std::make_unique<QOffscreenSurface>();
+    painter->m_surface->setFormat(painter->m_context->format());
+    painter->m_surface->create();
+
+    scene->makeOpenGLContextCurrent();
+    return painter;
+}
+
+bool DecorationGLPainter::ensureFramebuffers(const QSize &size)
+{
+    if (m_resolveFramebuffer && m_resolveFramebuffer->width() >= size.width() && m_resolveFramebuffer->height() >= size.height()) {
+        return true;
+    }
+
+    // grow in steps to avoid reallocating for every damaged rect
+    QSize allocatedSize = size.expandedTo(m_resolveFramebuffer ? m_resolveFramebuffer->size() : QSize());
+    allocatedSize = QSize((allocatedSize.width() + 127) & ~127, (allocatedSize.height() + 127) & ~127);
+
+    // the texture will be wrapped in the compositor's context, so drop the old one first
+    m_textureFramebuffer.reset();
+    m_texture.reset();
+
+    QOpenGLFramebufferObjectFormat multisampleFormat;
+    multisampleFormat.setSamples(4);
+    multisampleFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    multisampleFormat.setInternalTextureFormat(GL_RGBA8);
+    m_multisampleFramebuffer = std::make_unique<QOpenGLFramebufferObject>(allocatedSize, multisampleFormat);
+
+    QOpenGLFramebufferObjectFormat resolveFormat;
+    resolveFormat.setInternalTextureFormat(GL_RGBA8);
+    m_resolveFramebuffer = std::make_unique<QOpenGLFramebufferObject>(allocatedSize, resolveFormat);
+
+    if (!m_multisampleFramebuffer->isValid() || !m_resolveFramebuffer->isValid()) {
+        m_multisampleFramebuffer.reset();
+        m_resolveFramebuffer.reset();
+        return false;
+    }
+    return true;
+}
+
+void DecorationGLPainter::clamp(const QSize &size, const QRect &viewport)
+{
+    // The paint device puts the top row of the image at the top of the size.height() rows at
+    // the bottom of the framebuffer, flip the rects to the bottom-left origin used by blits
+    const auto toGL = [&size](const QRect &rect) {
+        return QRect(rect.x(), size.height() - rect.y() - rect.height(), rect.width(), rect.height());
+    };
+    const auto blit = [this, &toGL](const QRect &source, const QRect &target) {
+        if (!target.isEmpty()) {
+            QOpenGLFramebufferObject::blitFramebuffer(m_resolveFramebuffer.get(), toGL(target), m_resolveFramebuffer.get(), toGL(source),
+                                                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+    };
+
+    const int left = viewport.left();
+    const int top = viewport.top();
+    const int right = size.width() - viewport.x() - viewport.width();
+    const int bottom = size.height() - viewport.y() - viewport.height();
+
+    // the sides first, the rows then also fill the corners
+    blit(QRect(viewport.left(), top, 1, viewport.height()), QRect(0, top, left, viewport.height()));
+    blit(QRect(viewport.x() + viewport.width() - 1, top, 1, viewport.height()), QRect(size.width() - right, top, right, viewport.height()));
+    blit(QRect(0, top, size.width(), 1), QRect(0, 0, size.width(), top));
+    blit(QRect(0, viewport.y() + viewport.height() - 1, size.width(), 1), QRect(0, size.height() - bottom, size.width(), bottom));
+}
+
+bool DecorationGLPainter::paint(GLFramebuffer *target, const QPoint &offset, const QSize &size, const QRect &viewport,
+                                qreal devicePixelRatio, const std::function<void(QPainter *)> &callback)
+{
+    if (!m_context->makeCurrent(m_surface.get())) {
+        m_scene->makeOpenGLContextCurrent();
+        return false;
+    }
+
+    if (!ensureFramebuffers(size)) {
+        m_context->doneCurrent();
+        m_scene->makeOpenGLContextCurrent();
+        return false;
+    }
+
+    m_multisampleFramebuffer->bind();
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    QOpenGLPaintDevice device(size);
+    device.setDevicePixelRatio(devicePixelRatio);
+    QPainter painter(&device);
+    callback(&painter);
+    painter.end();
+
+    const QRect imageRect(0, 0, size.width(), size.height());
+    QOpenGLFramebufferObject::blitFramebuffer(m_resolveFramebuffer.get(), imageRect, m_multisampleFramebuffer.get(), imageRect);
+    clamp(size, viewport);
+    QOpenGLFramebufferObject::bindDefault();
+
+    GLsync fence = nullptr;
+    if (m_supportsFences) {
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    if (fence) {
+        glFlush();
+    } else {
+        glFinish();
+    }
+    m_context->doneCurrent();
+
+    if (!m_scene->makeOpenGLContextCurrent()) {
+        return false;
+    }
+    if (fence) {
+        glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fence);
+    }
+
+    if (!m_textureFramebuffer) {
+        m_texture = std::make_unique<GLTexture>(m_resolveFramebuffer->texture(), GL_RGBA8, m_resolveFramebuffer->size());
+        m_textureFramebuffer = std::make_unique<GLFramebuffer>(m_texture.get());
+        if (!m_textureFramebuffer->valid()) {
+            m_textureFramebuffer.reset();
+            m_texture.reset();
+            return false;
+        }
+    }
+
+    // GLTexture::update() puts the first row of the image at the first row of the texture,
+    // which is the bottom one in the coordinates of blitFromFramebuffer(), hence the flip
+    const int sourceHeight = m_resolveFramebuffer->height();
+    const QRect source(0, sourceHeight - size.height(), size.width(), size.height());
+    const QRect destination(offset.x(), target->size().height() - offset.y() - size.height(), size.width(), size.height());
+
+    GLFramebuffer::pushFramebuffer(m_textureFramebuffer.get());
+    target->blitFromFramebuffer(source, destination, GL_NEAREST, false, true);
+    GLFramebuffer::popFramebuffer();
+    return true;
+}
+
 /************************************************
  * SceneOpenGL
  ***********************************************/
@@ -48,10 +270,20 @@ WorkspaceSceneOpenGL::WorkspaceSceneOpenGL(OpenGLBackend *backend)
         glGenVertexArrays(1, &vao);
         glBindVertexArray(vao);
     }
+
+    m_shaderWarmUpTimer.setInterval(0);
+    connect(&m_shaderWarmUpTimer, &QTimer::timeout, this, [this]() {
+        if (m_pendingShaderTraits.isEmpty() || !makeOpenGLContextCurrent()) {
+            m_shaderWarmUpTimer.stop();
+            return;
+        }
+        ShaderManager::instance()->shader(m_pendingShaderTraits.takeFirst());
+    });
 }
 
 WorkspaceSceneOpenGL::~WorkspaceSceneOpenGL()
 {
+    m_decorationPainter.reset();
     makeOpenGLContextCurrent();
 }
 
@@ -70,6 +302,28 @@ bool WorkspaceSceneOpenGL::supportsNativeFence() const
     return m_backend->supportsNativeFence();
 }
 
+void WorkspaceSceneOpenGL::warmUpShaders()
+{
+    // the permutations used by ItemRendererOpenGL and by the outlines of many effects
+    m_pendingShaderTraits = {
+        ShaderTrait::MapTexture,
+        ShaderTrait::MapTexture | ShaderTrait::Modulate,
+        ShaderTrait::MapTexture | ShaderTrait::AdjustSaturation,
+        ShaderTrait::MapTexture | ShaderTrait::Modulate | ShaderTrait::AdjustSaturation,
+        ShaderTrait::UniformColor,
+    };
+    m_shaderWarmUpTimer.start();
+}
+
+DecorationGLPainter *WorkspaceSceneOpenGL::decorationPainter()
+{
+    if (!m_decorationPainterInitialized) {
+        m_decorationPainter = DecorationGLPainter::create(this);
+        m_decorationPainterInitialized = true;
+    }
+    return m_decorationPainter.get();
+}
+
 DecorationRenderer *WorkspaceSceneOpenGL::createDecorationRenderer(Decoration::DecoratedClientImpl *impl)
 {
     return new SceneOpenGLDecorationRenderer(impl);
@@ -163,12 +417,74 @@ std::shared_ptr<GLTexture> DecorationShadowTextureCache::getTexture(ShadowTextur
     Data d;
     d.providers << provider;
     d.texture = std::make_shared<GLTexture>(shadow->decorationShadowImage());
+    d.texture->setMemoryCategory(GLTextureMemory::Category::Shadow);
     d.texture->setFilter(GL_LINEAR);
     d.texture->setWrapMode(GL_CLAMP_TO_EDGE);
     m_cache.insert(decoShadow.get(), d);
     return d.texture;
 }
 
+/**
+ * Shares the textures of client provided shadows with identical content, e.g. all the
+ * popups and panels of one toolkit use the same shadow tiles. Entries are dropped once no
+ * shadow uses the texture anymore.
+ */
+class ShadowImageTextureCache
+{
+public:
+    ShadowImageTextureCache(const ShadowImageTextureCache &) = delete;
+    static ShadowImageTextureCache &instance();
+
+    std::shared_ptr<GLTexture> getTexture(const QImage &image);
+
+private:
+    ShadowImageTextureCache() = default;
+    struct Data
+    {
+        QImage image;
+        std::weak_ptr<GLTexture> texture;
+    };
+    QMultiHash<size_t, Data> m_cache;
+};
+
+ShadowImageTextureCache &ShadowImageTextureCache::instance()
+{
+    static ShadowImageTextureCache s_instance;
+    return s_instance;
+}
+
+std::shared_ptr<GLTexture> ShadowImageTextureCache::getTexture(const QImage &image)
+{
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        if (it->texture.expired()) {
+            it = m_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const size_t key = qHashBits(image.constBits(), image.sizeInBytes(), qHashMulti(0, image.width(), image.height(), int(image.format())));
+    for (auto it = m_cache.constFind(key); it != m_cache.constEnd() && it.key() == key; ++it) {
+        if (it->image == image) {
+            return it->texture.lock();
+        }
+    }
+
+    auto texture = std::make_shared<GLTexture>(image);
+    texture->setMemoryCategory(GLTextureMemory::Category::Shadow);
+    texture->setFilter(GL_LINEAR);
+    texture->setWrapMode(GL_CLAMP_TO_EDGE);
+
+    if (texture->internalFormat() == GL_R8) {
+        // Swizzle red to alpha and all other channels to zero
+        texture->bind();
+        texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
+    }
+
+    m_cache.insert(key, Data{image, texture});
+    return texture;
+}
+
 OpenGLShadowTextureProvider::OpenGLShadowTextureProvider(Shadow *shadow)
     : ShadowTextureProvider(shadow)
 {
@@ -252,15 +568,7 @@ void OpenGLShadowTextureProvider::update()
         }
     }
 
-    m_texture = std::make_shared<GLTexture>(image);
-    m_texture->setFilter(GL_LINEAR);
-    m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
-
-    if (m_texture->internalFormat() == GL_R8) {
-        // Swizzle red to alpha and all other channels to zero
-        m_texture->bind();
-        m_texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
-    }
+    m_texture = ShadowImageTextureCache::instance().getTexture(image);
 }
 
 SceneOpenGLDecorationRenderer::SceneOpenGLDecorationRenderer(Decoration::DecoratedClientImpl *client)
@@ -326,6 +634,8 @@ static void clamp(QImage &image, const QRect &viewport)
     }
 }
 
+static const int s_maxDamageRects = 4;
+
 void SceneOpenGLDecorationRenderer::render(const QRegion &region)
 {
     if (areImageSizesDirty()) {
@@ -333,6 +643,10 @@ void SceneOpenGLDecorationRenderer::render(const QRegion &region)
         resetImageSizesDirty();
     }
 
+    for (CachedTexture &cached : m_cachedTextures) {
+        cached.damage += region;
+    }
+
     if (!m_texture) {
         // for invalid sizes we get no texture, see BUG 361551
         return;
@@ -351,12 +665,24 @@ void SceneOpenGLDecorationRenderer::render(const QRegion &region)
     const QPoint leftPosition(0, bottomPosition.y() + bottomHeight + (2 * TexturePad));
     const QPoint rightPosition(0, leftPosition.y() + leftWidth + (2 * TexturePad));
 
-    const QRect dirtyRect = region.boundingRect();
+    // Render and upload the damaged rects of every part separately, so e.g. a title change
+    // doesn't repaint the buttons as well. Many small rects are merged, every one of them
+    // costs a QImage, a decoration paint and an upload.
+    const auto renderDamage = [&](const QRect &partRect, const QPoint &position, bool rotated) {
+        const QRegion dirty = region & partRect;
+        if (dirty.rectCount() > s_maxDamageRects) {
+            renderPart(dirty.boundingRect(), partRect, position, devicePixelRatio, rotated);
+        } else {
+            for (const QRect &rect : dirty) {
+                renderPart(rect, partRect, position, devicePixelRatio, rotated);
+            }
+        }
+    };
 
-    renderPart(top.toRect().intersected(dirtyRect), top.toRect(), topPosition, devicePixelRatio);
-    renderPart(bottom.toRect().intersected(dirtyRect), bottom.toRect(), bottomPosition, devicePixelRatio);
-    renderPart(left.toRect().intersected(dirtyRect), left.toRect(), leftPosition, devicePixelRatio, true);
-    renderPart(right.toRect().intersected(dirtyRect), right.toRect(), rightPosition, devicePixelRatio, true);
+    renderDamage(top.toRect(), topPosition, false);
+    renderDamage(bottom.toRect(), bottomPosition, false);
+    renderDamage(left.toRect(), leftPosition, true);
+    renderDamage(right.toRect(), rightPosition, true);
 }
 
 void SceneOpenGLDecorationRenderer::renderPart(const QRect &rect, const QRect &partRect,
@@ -366,11 +692,16 @@ void SceneOpenGLDecorationRenderer::renderPart(const QRect &rect, const QRect &p
     if (!rect.isValid()) {
         return;
     }
+    // The rect and the part in the orientation they have in the texture, rotated parts are
+    // rotated by 90 degrees counter-clockwise
+    const QRect localPartRect = rotated ? QRect(0, 0, partRect.height(), partRect.width()) : QRect(QPoint(0, 0), partRect.size());
+    const QRect localRect = rotated ? QRect(rect.top() - partRect.top(), partRect.right() - rect.right(), rect.height(), rect.width()) : rect.translated(-partRect.topLeft());
+
     // We allow partial decoration updates and it might just so happen that the
     // dirty region is completely contained inside the decoration part, i.e.
     // the dirty region doesn't touch any of the decoration's edges. In that
     // case, we should **not** pad the dirty region.
-    const QMargins padding = texturePadForPart(rect, partRect);
+    const QMargins padding = texturePadForPart(localRect, localPartRect);
     int verticalPadding = padding.top() + padding.bottom();
     int horizontalPadding = padding.left() + padding.right();
 
@@ -381,39 +712,63 @@ void SceneOpenGLDecorationRenderer::renderPart(const QRect &rect, const QRect &p
     QSize paddedImageSize = imageSize;
     paddedImageSize.rheight() += verticalPadding;
     paddedImageSize.rwidth() += horizontalPadding;
+
+    const QRect padClip = QRect(padding.left(), padding.top(), imageSize.width(), imageSize.height());
+
+    QPoint dirtyOffset = localRect.topLeft() * devicePixelRatio;
+    if (padding.top() == 0) {
+        dirtyOffset.ry() += TexturePad;
+    }
+    if (padding.left() == 0) {
+        dirtyOffset.rx() += TexturePad;
+    }
+
+    auto scene = static_cast<WorkspaceSceneOpenGL *>(Compositor::self()->scene());
+    if (DecorationGLPainter *glPainter = scene->decorationPainter()) {
+        if (!m_framebuffer) {
+            m_framebuffer = std::make_unique<GLFramebuffer>(m_texture.get());
+        }
+        if (m_framebuffer->valid()) {
+            const auto callback = [&](QPainter *painter) {
+                paintPart(painter, rect, padClip, imageSize, devicePixelRatio, rotated);
+            };
+            if (glPainter->paint(m_framebuffer.get(), textureOffset + dirtyOffset, paddedImageSize, padClip, devicePixelRatio, callback)) {
+                return;
+            }
+        }
+    }
+
     QImage image(paddedImageSize, QImage::Format_ARGB32_Premultiplied);
     image.setDevicePixelRatio(devicePixelRatio);
     image.fill(Qt::transparent);
 
-    QRect padClip = QRect(padding.left(), padding.top(), imageSize.width(), imageSize.height());
     QPainter painter(&image);
-    const qreal inverseScale = 1.0 / devicePixelRatio;
-    painter.scale(inverseScale, inverseScale);
-    painter.setRenderHint(QPainter::Antialiasing);
-    painter.setClipRect(padClip);
-    painter.translate(padding.left(), padding.top());
-    if (rotated) {
-        painter.translate(0, imageSize.height());
-        painter.rotate(-90);
-    }
-    painter.scale(devicePixelRatio, devicePixelRatio);
-    painter.translate(-rect.topLeft());
-    renderToPainter(&painter, rect);
+    paintPart(&painter, rect, padClip, imageSize, devicePixelRatio, rotated);
     painter.end();
 
     // fill padding pixels by copying from the neighbour row
     clamp(image, padClip);
 
-    QPoint dirtyOffset = (rect.topLeft() - partRect.topLeft()) * devicePixelRatio;
-    if (padding.top() == 0) {
-        dirtyOffset.ry() += TexturePad;
-    }
-    if (padding.left() == 0) {
-        dirtyOffset.rx() += TexturePad;
-    }
     m_texture->update(image, textureOffset + dirtyOffset);
 }
 
+void SceneOpenGLDecorationRenderer::paintPart(QPainter *painter, const QRect &rect, const QRect &padClip,
+                                              const QSize &imageSize, qreal devicePixelRatio, bool rotated)
+{
+    const qreal inverseScale = 1.0 / devicePixelRatio;
+    painter->scale(inverseScale, inverseScale);
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setClipRect(padClip);
+    painter->translate(padClip.left(), padClip.top());
+    if (rotated) {
+        painter->translate(0, imageSize.height());
+        painter->rotate(-90);
+    }
+    painter->scale(devicePixelRatio, devicePixelRatio);
+    painter->translate(-rect.topLeft());
+    renderToPainter(painter, rect);
+}
+
 const QMargins SceneOpenGLDecorationRenderer::texturePadForPart(
     const QRect &rect, const QRect &partRect)
 {
@@ -438,10 +793,80 @@ static int align(int value, int align)
     return (value + align - 1) & ~(align - 1);
 }
 
+std::array<QRectF, 4> SceneOpenGLDecorationRenderer::layout() const
+{
+    std::array<QRectF, 4> rects;
+    client()->window()->layoutDecorationRects(rects[0], rects[1], rects[2], rects[3]);
+    return rects;
+}
+
+static const size_t s_maxCachedTextures = 2;
+
+bool SceneOpenGLDecorationRenderer::restoreDevicePixelRatio(qreal previous)
+{
+    // keep the texture for the previous scale
+    if (m_texture) {
+        std::erase_if(m_cachedTextures, [previous](const CachedTexture &cached) {
+            return cached.devicePixelRatio == previous;
+        });
+        CachedTexture cached{
+            .devicePixelRatio = previous,
+            .texture = std::move(m_texture),
+            .framebuffer = std::move(m_framebuffer),
+            .layout = m_layout,
+            // the pending damage hasn't been rendered into the texture yet
+            .damage = damage(),
+        };
+        cached.cacheEntry = std::make_unique<GLTextureCacheEntry>([this, previous]() {
+            auto it = std::find_if(m_cachedTextures.begin(), m_cachedTextures.end(), [previous](const CachedTexture &cached) {
+                return cached.devicePixelRatio == previous;
+            });
+            if (it != m_cachedTextures.end()) {
+                // the entry can't be destroyed while its cache entry is being evicted
+                it->framebuffer.reset();
+                it->texture.reset();
+            }
+            return true;
+        });
+        m_cachedTextures.insert(m_cachedTextures.begin(), std::move(cached));
+    }
+
+    bool restored = false;
+    auto it = std::find_if(m_cachedTextures.begin(), m_cachedTextures.end(), [this](const CachedTexture &cached) {
+        return cached.devicePixelRatio == devicePixelRatio();
+    });
+    if (it != m_cachedTextures.end()) {
+        if (it->texture && it->layout == layout()) {
+            m_texture = std::move(it->texture);
+            m_framebuffer = std::move(it->framebuffer);
+            m_layout = it->layout;
+            if (!it->damage.isEmpty()) {
+                addDamage(it->damage);
+            }
+            restored = true;
+        }
+        m_cachedTextures.erase(it);
+    }
+
+    std::erase_if(m_cachedTextures, [](const CachedTexture &cached) {
+        return !cached.texture;
+    });
+    if (m_cachedTextures.size() > s_maxCachedTextures) {
+        m_cachedTextures.erase(m_cachedTextures.begin() + s_maxCachedTextures, m_cachedTextures.end());
+    }
+
+    return restored;
+}
+
 void SceneOpenGLDecorationRenderer::resizeTexture()
 {
     QRectF left, top, right, bottom;
     client()->window()->layoutDecorationRects(left, top, right, bottom);
+    m_layout = {left, top, right, bottom};
+    // the cached textures can't be used anymore if the decoration has been laid out differently
+    std::erase_if(m_cachedTextures, [this](const CachedTexture &cached) {
+        return cached.layout != m_layout;
+    });
     QSize size;
 
     size.rwidth() = toNativeSize(std::max(std::max(top.width(), bottom.width()),
@@ -456,8 +881,10 @@ void SceneOpenGLDecorationRenderer::resizeTexture()
         return;
     }
 
+    m_framebuffer.reset();
     if (!size.isEmpty()) {
         m_texture.reset(new GLTexture(GL_RGBA8, size.width(), size.height()));
+        m_texture->setMemoryCategory(GLTextureMemory::Category::Decoration);
         m_texture->setContentTransform(TextureTransform::MirrorY);
         m_texture->setFilter(GL_LINEAR);
         m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
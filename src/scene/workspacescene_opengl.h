@@ -18,8 +18,13 @@
 
 #include "libkwineffects/kwinglutils.h"
 
+#include <QTimer>
+
+#include <array>
+
 namespace KWin
 {
+class DecorationGLPainter;
 class OpenGLBackend;
 
 class KWIN_EXPORT WorkspaceSceneOpenGL : public WorkspaceScene
@@ -44,9 +49,25 @@ public:
 
     std::shared_ptr<GLTexture> textureForOutput(Output *output) const override;
 
+    /**
+     * Returns the painter used to render decorations on the GPU, or @c null if decorations
+     * are rendered with the raster paint engine.
+     */
+    DecorationGLPainter *decorationPainter();
+
+    /**
+     * Compiles the shaders most commonly used to render windows ahead of time, one at a time
+     * whenever the event loop is idle, so the first frames that need them don't stall.
+     */
+    void warmUpShaders();
+
 private:
     OpenGLBackend *m_backend;
     GLuint vao = 0;
+    QTimer m_shaderWarmUpTimer;
+    QVector<ShaderTraits> m_pendingShaderTraits;
+    std::unique_ptr<DecorationGLPainter> m_decorationPainter;
+    bool m_decorationPainterInitialized = false;
 };
 
 /**
@@ -99,10 +120,34 @@ public:
 
 private:
     void renderPart(const QRect &rect, const QRect &partRect, const QPoint &textureOffset, qreal devicePixelRatio, bool rotated = false);
+    void paintPart(QPainter *painter, const QRect &rect, const QRect &padClip, const QSize &imageSize, qreal devicePixelRatio, bool rotated);
     static const QMargins texturePadForPart(const QRect &rect, const QRect &partRect);
     void resizeTexture();
     int toNativeSize(int size) const;
+    bool restoreDevicePixelRatio(qreal previous) override;
+    std::array<QRectF, 4> layout() const;
+
     std::unique_ptr<GLTexture> m_texture;
+    std::unique_ptr<GLFramebuffer> m_framebuffer;
+    // the decoration rects the texture has been laid out for
+    std::array<QRectF, 4> m_layout;
+
+    /**
+     * The textures for the scales the decoration has been shown at most recently, so moving
+     * a window back and forth between outputs with different scales doesn't render the whole
+     * decoration every time.
+     */
+    struct CachedTexture
+    {
+        qreal devicePixelRatio;
+        std::unique_ptr<GLTexture> texture;
+        std::unique_ptr<GLFramebuffer> framebuffer;
+        std::array<QRectF, 4> layout;
+        // what has been rendered for the current scale since the texture was cached
+        QRegion damage;
+        std::unique_ptr<GLTextureCacheEntry> cacheEntry;
+    };
+    std::vector<CachedTexture> m_cachedTextures;
 };
 
 } // namespace
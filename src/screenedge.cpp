@@ -1059,6 +1059,7 @@ void ScreenEdges::recreateEdges()
 {
     std::vector<std::unique_ptr<Edge>> oldEdges = std::move(m_edges);
     m_edges.clear();
+    m_edgeLookupDirty = true;
     const QRect fullArea = workspace()->geometry();
     QRegion processedRegion;
 
@@ -1285,6 +1286,7 @@ void ScreenEdges::reserve(Window *client, ElectricBorder border)
     });
     const bool hadBorder = it != m_edges.end();
     m_edges.erase(it, m_edges.end());
+    m_edgeLookupDirty = true;
 
     if (border != ElectricNone) {
         createEdgeForClient(client, border);
@@ -1381,6 +1383,7 @@ void ScreenEdges::createEdgeForClient(Window *client, ElectricBorder border)
 
     if (width > 0 && height > 0) {
         m_edges.push_back(createEdge(border, x, y, width, height, foundOutput, false));
+        m_edgeLookupDirty = true;
         Edge *edge = m_edges.back().get();
         edge->setClient(client);
         edge->reserve();
@@ -1396,6 +1399,7 @@ void ScreenEdges::deleteEdgeForClient(Window *window)
         return edge->client() == window;
     });
     m_edges.erase(it, m_edges.end());
+    m_edgeLookupDirty = true;
 }
 
 void ScreenEdges::check(const QPoint &pos, const QDateTime &now, bool forceNoPushBack)
@@ -1423,11 +1427,55 @@ void ScreenEdges::check(const QPoint &pos, const QDateTime &now, bool forceNoPus
     }
 }
 
+void ScreenEdges::rebuildEdgeLookup()
+{
+    m_edgeLookupDirty = false;
+    m_edgeLookup.clear();
+    for (const auto &edge : m_edges) {
+        auto lookup = std::find_if(m_edgeLookup.begin(), m_edgeLookup.end(), [&edge](const EdgeLookup &lookup) {
+            return lookup.output == edge->output();
+        });
+        if (lookup == m_edgeLookup.end()) {
+            m_edgeLookup.push_back(EdgeLookup{
+                .output = edge->output(),
+            });
+            lookup = std::prev(m_edgeLookup.end());
+        }
+        const QRect area = edge->geometry() | edge->approachGeometry();
+        lookup->bounds |= area;
+        lookup->areas.append(area);
+    }
+}
+
+bool ScreenEdges::isNearEdge(const QPoint &pos)
+{
+    if (m_edgeLookupDirty) {
+        rebuildEdgeLookup();
+    }
+    for (const EdgeLookup &lookup : m_edgeLookup) {
+        if (!lookup.bounds.contains(pos)) {
+            continue;
+        }
+        for (const QRect &area : lookup.areas) {
+            if (area.contains(pos)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 bool ScreenEdges::isEntered(QMouseEvent *event)
 {
     if (event->type() != QEvent::MouseMove) {
         return false;
     }
+    // the edges are only visited once more after the pointer has left them, to stop approaching
+    const bool nearEdge = isNearEdge(event->globalPos());
+    if (!nearEdge && !m_pointerNearEdge) {
+        return false;
+    }
+    m_pointerNearEdge = nearEdge;
     bool activated = false;
     bool activatedForClient = false;
     for (const auto &edge : m_edges) {
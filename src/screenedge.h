@@ -412,6 +412,8 @@ private:
     ElectricBorderAction actionForTouchEdge(Edge *edge) const;
     void createEdgeForClient(Window *client, ElectricBorder border);
     void deleteEdgeForClient(Window *client);
+    bool isNearEdge(const QPoint &pos);
+    void rebuildEdgeLookup();
     bool m_desktopSwitching;
     bool m_desktopSwitchingMovingClients;
     QSize m_cursorPushBackDistance;
@@ -419,6 +421,20 @@ private:
     int m_reactivateThreshold;
     Qt::Orientations m_virtualDesktopLayout;
     std::vector<std::unique_ptr<Edge>> m_edges;
+    /**
+     * The areas covered by the edges of an output, i.e. their geometries and approach geometries,
+     * and the bounding rect of all of them. Pointer motion that doesn't hit any of the areas
+     * doesn't need to look at the edges.
+     */
+    struct EdgeLookup
+    {
+        Output *output;
+        QRect bounds;
+        QVector<QRect> areas;
+    };
+    std::vector<EdgeLookup> m_edgeLookup;
+    bool m_edgeLookupDirty = true;
+    bool m_pointerNearEdge = false;
     KSharedConfig::Ptr m_config;
     ElectricBorderAction m_actionTopLeft;
     ElectricBorderAction m_actionTop;
@@ -25,10 +25,12 @@
 // Qt
 #include <QAction>
 #include <QFile>
+#include <QMetaProperty>
 #include <QQmlEngine>
 #include <QStandardPaths>
 #include <QVector>
 
+#include <algorithm>
 #include <optional>
 
 Q_DECLARE_METATYPE(KSharedConfigPtr)
@@ -268,6 +270,8 @@ bool ScriptedEffect::init(const QString &effectName, const QString &pathToScript
 
         QStringLiteral("animate"),
         QStringLiteral("set"),
+        QStringLiteral("registerAnimation"),
+        QStringLiteral("unregisterAnimation"),
         QStringLiteral("retarget"),
         QStringLiteral("freezeInTime"),
         QStringLiteral("redirect"),
@@ -327,27 +331,53 @@ QList<int> ScriptedEffect::touchEdgesForAction(const QString &action) const
     }
 }
 
-QJSValue ScriptedEffect::animate_helper(const QJSValue &object, AnimationType animationType)
+static QEasingCurve easingCurve(int curve)
 {
-    QJSValue windowProperty = object.property(QStringLiteral("window"));
-    if (!windowProperty.isObject()) {
-        m_engine->throwError(QStringLiteral("Window property missing in animation options"));
-        return QJSValue();
+    QEasingCurve qec;
+    if (curve < QEasingCurve::Custom) {
+        qec.setType(static_cast<QEasingCurve::Type>(curve));
+    } else if (curve == ScriptedEffect::GaussianCurve) {
+        qec.setCustomType(qecGaussian);
     }
+    return qec;
+}
 
-    EffectWindow *window = qobject_cast<EffectWindow *>(windowProperty.toQObject());
-    if (!window) {
-        m_engine->throwError(QStringLiteral("Window property references invalid window"));
-        return QJSValue();
-    }
+/**
+ * The AnimationTrigger type describes animations that are started when a signal of the
+ * effects handler is emitted, without calling back into the script.
+ */
+struct ScriptedEffect::AnimationTrigger
+{
+    struct Animation
+    {
+        AnimationEffect::Attribute type;
+        uint metaData;
+        int duration;
+        FPx2 to;
+        FPx2 from;
+        QEasingCurve curve;
+        int delay;
+        bool fullScreenEffect;
+        bool keepAlive;
+        uint shader;
+        qint64 frozenTime;
+    };
+
+    QMetaObject::Connection connection;
+    std::optional<DataRole> skipGrabbed;
+    QVector<QMetaProperty> windowFilter;
+    QVector<Animation> animations;
+};
 
+std::optional<QVector<AnimationSettings>> ScriptedEffect::animationSettings(const QJSValue &object)
+{
     QVector<AnimationSettings> settings{animationSettingsFromObject(object)}; // global
 
     QJSValue animations = object.property(QStringLiteral("animations")); // array
     if (!animations.isUndefined()) {
         if (!animations.isArray()) {
             m_engine->throwError(QStringLiteral("Animations provided but not an array"));
-            return QJSValue();
+            return std::nullopt;
         }
 
         const int length = static_cast<int>(animations.property(QStringLiteral("length")).toInt());
@@ -359,11 +389,11 @@ QJSValue ScriptedEffect::animate_helper(const QJSValue &object, AnimationType an
                 // Catch show stoppers (incompletable animation)
                 if (!(set & AnimationSettings::Type)) {
                     m_engine->throwError(QStringLiteral("Type property missing in animation options"));
-                    return QJSValue();
+                    return std::nullopt;
                 }
                 if (!(set & AnimationSettings::Duration)) {
                     m_engine->throwError(QStringLiteral("Duration property missing in animation options"));
-                    return QJSValue();
+                    return std::nullopt;
                 }
                 // Complete local animations from global settings
                 if (!(s.set & AnimationSettings::Duration)) {
@@ -408,11 +438,11 @@ QJSValue ScriptedEffect::animate_helper(const QJSValue &object, AnimationType an
                     auto shader = findShader(s.shader.value());
                     if (!shader) {
                         m_engine->throwError(QStringLiteral("Shader for given shaderId not found"));
-                        return {};
+                        return std::nullopt;
                     }
                     if (!effects->makeOpenGLContextCurrent()) {
                         m_engine->throwError(QStringLiteral("Failed to make OpenGL context current"));
-                        return {};
+                        return std::nullopt;
                     }
                     ShaderBinder binder{shader};
                     s.metaData = shader->uniformLocation(uniformProperty.toUtf8().constData());
@@ -427,11 +457,11 @@ QJSValue ScriptedEffect::animate_helper(const QJSValue &object, AnimationType an
         const uint set = settings.at(0).set;
         if (!(set & AnimationSettings::Type)) {
             m_engine->throwError(QStringLiteral("Type property missing in animation options"));
-            return QJSValue();
+            return std::nullopt;
         }
         if (!(set & AnimationSettings::Duration)) {
             m_engine->throwError(QStringLiteral("Duration property missing in animation options"));
-            return QJSValue();
+            return std::nullopt;
         }
     } else if (!(settings.at(0).set & AnimationSettings::Type)) { // invalid global
         settings.removeAt(0); // -> get rid of it, only used to complete the others
@@ -439,9 +469,32 @@ QJSValue ScriptedEffect::animate_helper(const QJSValue &object, AnimationType an
 
     if (settings.isEmpty()) {
         m_engine->throwError(QStringLiteral("No animations provided"));
+        return std::nullopt;
+    }
+
+    return settings;
+}
+
+QJSValue ScriptedEffect::animate_helper(const QJSValue &object, AnimationType animationType)
+{
+    QJSValue windowProperty = object.property(QStringLiteral("window"));
+    if (!windowProperty.isObject()) {
+        m_engine->throwError(QStringLiteral("Window property missing in animation options"));
         return QJSValue();
     }
 
+    EffectWindow *window = qobject_cast<EffectWindow *>(windowProperty.toQObject());
+    if (!window) {
+        m_engine->throwError(QStringLiteral("Window property references invalid window"));
+        return QJSValue();
+    }
+
+    const std::optional<QVector<AnimationSettings>> maybeSettings = animationSettings(object);
+    if (!maybeSettings) {
+        return QJSValue();
+    }
+    const QVector<AnimationSettings> &settings = *maybeSettings;
+
     QJSValue array = m_engine->newArray(settings.length());
     for (int i = 0; i < settings.count(); i++) {
         const AnimationSettings &setting = settings[i];
@@ -487,13 +540,7 @@ quint64 ScriptedEffect::animate(KWin::EffectWindow *window, KWin::AnimationEffec
                                 int ms, const QJSValue &to, const QJSValue &from, uint metaData, int curve,
                                 int delay, bool fullScreen, bool keepAlive, uint shaderId)
 {
-    QEasingCurve qec;
-    if (curve < QEasingCurve::Custom) {
-        qec.setType(static_cast<QEasingCurve::Type>(curve));
-    } else if (curve == GaussianCurve) {
-        qec.setCustomType(qecGaussian);
-    }
-    return AnimationEffect::animate(window, attribute, metaData, ms, fpx2FromScriptValue(to), qec,
+    return AnimationEffect::animate(window, attribute, metaData, ms, fpx2FromScriptValue(to), easingCurve(curve),
                                     delay, fpx2FromScriptValue(from), fullScreen, keepAlive, findShader(shaderId));
 }
 
@@ -506,13 +553,7 @@ quint64 ScriptedEffect::set(KWin::EffectWindow *window, KWin::AnimationEffect::A
                             int ms, const QJSValue &to, const QJSValue &from, uint metaData, int curve,
                             int delay, bool fullScreen, bool keepAlive, uint shaderId)
 {
-    QEasingCurve qec;
-    if (curve < QEasingCurve::Custom) {
-        qec.setType(static_cast<QEasingCurve::Type>(curve));
-    } else if (curve == GaussianCurve) {
-        qec.setCustomType(qecGaussian);
-    }
-    return AnimationEffect::set(window, attribute, metaData, ms, fpx2FromScriptValue(to), qec,
+    return AnimationEffect::set(window, attribute, metaData, ms, fpx2FromScriptValue(to), easingCurve(curve),
                                 delay, fpx2FromScriptValue(from), fullScreen, keepAlive, findShader(shaderId));
 }
 
@@ -521,6 +562,109 @@ QJSValue ScriptedEffect::set(const QJSValue &object)
     return animate_helper(object, AnimationType::Set);
 }
 
+uint ScriptedEffect::registerAnimation(const QString &trigger, const QJSValue &object)
+{
+    using WindowSignal = void (EffectsHandler::*)(EffectWindow *);
+    static const QHash<QString, WindowSignal> triggers{
+        {QStringLiteral("windowAdded"), &EffectsHandler::windowAdded},
+        {QStringLiteral("windowClosed"), &EffectsHandler::windowClosed},
+        {QStringLiteral("windowActivated"), &EffectsHandler::windowActivated},
+        {QStringLiteral("windowMinimized"), &EffectsHandler::windowMinimized},
+        {QStringLiteral("windowUnminimized"), &EffectsHandler::windowUnminimized},
+        {QStringLiteral("windowShown"), &EffectsHandler::windowShown},
+        {QStringLiteral("windowHidden"), &EffectsHandler::windowHidden},
+        {QStringLiteral("windowStartUserMovedResized"), &EffectsHandler::windowStartUserMovedResized},
+        {QStringLiteral("windowFinishUserMovedResized"), &EffectsHandler::windowFinishUserMovedResized},
+        {QStringLiteral("windowFullScreenChanged"), &EffectsHandler::windowFullScreenChanged},
+    };
+    const auto signal = triggers.constFind(trigger);
+    if (signal == triggers.constEnd()) {
+        m_engine->throwError(QStringLiteral("Unsupported animation trigger ") + trigger);
+        return 0;
+    }
+
+    const std::optional<QVector<AnimationSettings>> settings = animationSettings(object);
+    if (!settings) {
+        return 0;
+    }
+
+    auto animationTrigger = std::make_unique<AnimationTrigger>();
+    if (const QJSValue skipGrabbed = object.property(QStringLiteral("skipGrabbed")); skipGrabbed.isNumber()) {
+        animationTrigger->skipGrabbed = static_cast<DataRole>(skipGrabbed.toInt());
+    }
+    if (const QJSValue windowFilter = object.property(QStringLiteral("windowFilter")); !windowFilter.isUndefined()) {
+        const QStringList propertyNames = windowFilter.toVariant().toStringList();
+        for (const QString &propertyName : propertyNames) {
+            const int index = EffectWindow::staticMetaObject.indexOfProperty(propertyName.toLatin1().constData());
+            const QMetaProperty property = EffectWindow::staticMetaObject.property(index);
+            if (index == -1 || property.metaType() != QMetaType::fromType<bool>()) {
+                m_engine->throwError(QStringLiteral("Window filter references invalid property ") + propertyName);
+                return 0;
+            }
+            animationTrigger->windowFilter.append(property);
+        }
+    }
+    for (const AnimationSettings &setting : *settings) {
+        animationTrigger->animations.append(AnimationTrigger::Animation{
+            .type = setting.type,
+            .metaData = setting.metaData,
+            .duration = int(setting.duration),
+            .to = fpx2FromScriptValue(setting.to),
+            .from = fpx2FromScriptValue(setting.from),
+            .curve = easingCurve(setting.curve),
+            .delay = setting.delay,
+            .fullScreenEffect = setting.fullScreenEffect,
+            .keepAlive = setting.keepAlive,
+            .shader = setting.shader.value_or(0u),
+            .frozenTime = setting.frozenTime,
+        });
+    }
+
+    const uint id = m_nextAnimationTriggerId++;
+    animationTrigger->connection = connect(effects, *signal, this, [this, id](EffectWindow *window) {
+        if (window) {
+            startTriggeredAnimations(window, *m_animationTriggers[id]);
+        }
+    });
+    m_animationTriggers[id] = std::move(animationTrigger);
+    return id;
+}
+
+bool ScriptedEffect::unregisterAnimation(uint id)
+{
+    const auto it = m_animationTriggers.find(id);
+    if (it == m_animationTriggers.end()) {
+        return false;
+    }
+    disconnect(it->second->connection);
+    m_animationTriggers.erase(it);
+    return true;
+}
+
+void ScriptedEffect::startTriggeredAnimations(EffectWindow *window, const AnimationTrigger &trigger)
+{
+    if (trigger.skipGrabbed && isGrabbed(window, *trigger.skipGrabbed)) {
+        return;
+    }
+    if (!trigger.windowFilter.isEmpty()) {
+        const bool accepted = std::any_of(trigger.windowFilter.cbegin(), trigger.windowFilter.cend(), [window](const QMetaProperty &property) {
+            return property.read(window).toBool();
+        });
+        if (!accepted) {
+            return;
+        }
+    }
+
+    for (const AnimationTrigger::Animation &animation : trigger.animations) {
+        const quint64 animationId = AnimationEffect::animate(window, animation.type, animation.metaData, animation.duration,
+                                                             animation.to, animation.curve, animation.delay, animation.from,
+                                                             animation.fullScreenEffect, animation.keepAlive, findShader(animation.shader));
+        if (animation.frozenTime >= 0) {
+            freezeInTime(animationId, animation.frozenTime);
+        }
+    }
+}
+
 bool ScriptedEffect::retarget(quint64 animationId, const QJSValue &newTarget, int newRemainingTime)
 {
     return AnimationEffect::retarget(animationId, fpx2FromScriptValue(newTarget), newRemainingTime);
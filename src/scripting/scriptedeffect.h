@@ -15,12 +15,16 @@
 #include <QJSEngine>
 #include <QJSValue>
 
+#include <optional>
+
 class KConfigLoader;
 class KPluginMetaData;
 
 namespace KWin
 {
 
+struct AnimationSettings;
+
 class KWIN_EXPORT ScriptedEffect : public KWin::AnimationEffect
 {
     Q_OBJECT
@@ -144,6 +148,28 @@ public:
                              bool fullScreen = false, bool keepAlive = true, uint shaderId = 0);
     Q_SCRIPTABLE QJSValue set(const QJSValue &object);
 
+    /**
+     * Registers animations that are started whenever the effects handler emits the @p trigger
+     * signal for a window, e.g. "windowAdded". The @p object takes the same options as
+     * animate(), except for the window. The options are evaluated only once, when the animations
+     * are registered, so no script code runs when they are started.
+     *
+     * In addition, the following options are supported:
+     * @li skipGrabbed - the animations are not started if another effect has grabbed the window
+     *   with the given role
+     * @li windowFilter - a list of boolean window properties, such as "normalWindow" or "dialog";
+     *   the animations are started only if at least one of them is true
+     *
+     * @returns the id of the registered animations, or @c 0 if the options are invalid
+     */
+    Q_SCRIPTABLE uint registerAnimation(const QString &trigger, const QJSValue &object);
+
+    /**
+     * Unregisters the animations with the given @p id, the animations that are already running
+     * are not affected.
+     */
+    Q_SCRIPTABLE bool unregisterAnimation(uint id);
+
     Q_SCRIPTABLE bool retarget(quint64 animationId, const QJSValue &newTarget,
                                int newRemainingTime = -1);
     Q_SCRIPTABLE bool retarget(const QList<quint64> &animationIds, const QJSValue &newTarget,
@@ -204,7 +230,11 @@ private:
         Set
     };
 
+    struct AnimationTrigger;
+
+    std::optional<QVector<AnimationSettings>> animationSettings(const QJSValue &object);
     QJSValue animate_helper(const QJSValue &object, AnimationType animationType);
+    void startTriggeredAnimations(EffectWindow *window, const AnimationTrigger &trigger);
 
     GLShader *findShader(uint shaderId) const;
 
@@ -220,5 +250,7 @@ private:
     Effect *m_activeFullScreenEffect = nullptr;
     std::map<uint, std::unique_ptr<GLShader>> m_shaders;
     uint m_nextShaderId{1u};
+    std::map<uint, std::unique_ptr<AnimationTrigger>> m_animationTriggers;
+    uint m_nextAnimationTriggerId = 1;
 };
 }
@@ -125,9 +125,23 @@ KWin::ScriptTimer::ScriptTimer(QObject *parent)
 {
 }
 
-KWin::Script::Script(int id, QString scriptName, QString pluginName, QObject *parent)
+// the functions that are bound to the script rather than the engine
+static const QStringList s_scriptProperties{
+    QStringLiteral("readConfig"),
+    QStringLiteral("callDBus"),
+
+    QStringLiteral("registerShortcut"),
+    QStringLiteral("registerScreenEdge"),
+    QStringLiteral("unregisterScreenEdge"),
+    QStringLiteral("registerTouchScreenEdge"),
+    QStringLiteral("unregisterTouchScreenEdge"),
+    QStringLiteral("registerUserActionsMenu"),
+};
+
+KWin::Script::Script(int id, QString scriptName, QString pluginName, std::shared_ptr<QJSEngine> sharedEngine, QObject *parent)
     : AbstractScript(id, scriptName, pluginName, parent)
-    , m_engine(new QJSEngine(this))
+    , m_engine(sharedEngine ? sharedEngine : std::make_shared<QJSEngine>())
+    , m_sharedEngine(sharedEngine != nullptr)
     , m_starting(false)
 {
     // TODO: Remove in kwin 6. We have these converters only for compatibility reasons.
@@ -157,6 +171,11 @@ KWin::Script::~Script()
 {
 }
 
+bool KWin::Script::usesSharedEngine() const
+{
+    return m_sharedEngine;
+}
+
 void KWin::Script::run()
 {
     if (running() || m_starting) {
@@ -184,69 +203,31 @@ QByteArray KWin::Script::loadScriptFromFile(const QString &fileName)
     return result;
 }
 
-void KWin::Script::slotScriptLoadedFromFile()
+void KWin::Script::installGlobals(QJSEngine *engine)
 {
-    QFutureWatcher<QByteArray> *watcher = dynamic_cast<QFutureWatcher<QByteArray> *>(sender());
-    if (!watcher) {
-        // not invoked from a QFutureWatcher
-        return;
-    }
-    if (watcher->result().isNull()) {
-        // do not load empty script
-        deleteLater();
-        watcher->deleteLater();
-
-        if (m_invocationContext.type() == QDBusMessage::MethodCallMessage) {
-            auto reply = m_invocationContext.createErrorReply("org.kde.kwin.Scripting.FileError", QString("Could not open %1").arg(fileName()));
-            QDBusConnection::sessionBus().send(reply);
-            m_invocationContext = QDBusMessage();
-        }
-
-        return;
-    }
-
     // Install console functions (e.g. console.assert(), console.log(), etc).
-    m_engine->installExtensions(QJSEngine::ConsoleExtension);
+    engine->installExtensions(QJSEngine::ConsoleExtension);
 
     // Make the timer visible to QJSEngine.
-    QJSValue timerMetaObject = m_engine->newQMetaObject(&ScriptTimer::staticMetaObject);
-    m_engine->globalObject().setProperty("QTimer", timerMetaObject);
+    QJSValue timerMetaObject = engine->newQMetaObject(&ScriptTimer::staticMetaObject);
+    engine->globalObject().setProperty("QTimer", timerMetaObject);
 
     // Expose enums.
-    m_engine->globalObject().setProperty(QStringLiteral("KWin"), m_engine->newQMetaObject(&QtScriptWorkspaceWrapper::staticMetaObject));
+    engine->globalObject().setProperty(QStringLiteral("KWin"), engine->newQMetaObject(&QtScriptWorkspaceWrapper::staticMetaObject));
 
     // Make the options object visible to QJSEngine.
-    QJSValue optionsObject = m_engine->newQObject(options);
+    QJSValue optionsObject = engine->newQObject(options);
     QQmlEngine::setObjectOwnership(options, QQmlEngine::CppOwnership);
-    m_engine->globalObject().setProperty(QStringLiteral("options"), optionsObject);
+    engine->globalObject().setProperty(QStringLiteral("options"), optionsObject);
 
     // Make the workspace visible to QJSEngine.
-    QJSValue workspaceObject = m_engine->newQObject(Scripting::self()->workspaceWrapper());
+    QJSValue workspaceObject = engine->newQObject(Scripting::self()->workspaceWrapper());
     QQmlEngine::setObjectOwnership(Scripting::self()->workspaceWrapper(), QQmlEngine::CppOwnership);
-    m_engine->globalObject().setProperty(QStringLiteral("workspace"), workspaceObject);
-
-    QJSValue self = m_engine->newQObject(this);
-    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
-
-    static const QStringList globalProperties{
-        QStringLiteral("readConfig"),
-        QStringLiteral("callDBus"),
-
-        QStringLiteral("registerShortcut"),
-        QStringLiteral("registerScreenEdge"),
-        QStringLiteral("unregisterScreenEdge"),
-        QStringLiteral("registerTouchScreenEdge"),
-        QStringLiteral("unregisterTouchScreenEdge"),
-        QStringLiteral("registerUserActionsMenu"),
-    };
-
-    for (const QString &propertyName : globalProperties) {
-        m_engine->globalObject().setProperty(propertyName, self.property(propertyName));
-    }
+    engine->globalObject().setProperty(QStringLiteral("workspace"), workspaceObject);
 
     // Inject assertion functions. It would be better to create a module with all
     // this assert functions or just deprecate them in favor of console.assert().
-    QJSValue result = m_engine->evaluate(QStringLiteral(R"(
+    QJSValue result = engine->evaluate(QStringLiteral(R"(
         function assert(condition, message) {
             console.assert(condition, message || 'Assertion failed');
         }
@@ -267,8 +248,55 @@ void KWin::Script::slotScriptLoadedFromFile()
         }
     )"));
     Q_ASSERT(!result.isError());
+}
 
-    result = m_engine->evaluate(QString::fromUtf8(watcher->result()), fileName());
+void KWin::Script::slotScriptLoadedFromFile()
+{
+    QFutureWatcher<QByteArray> *watcher = dynamic_cast<QFutureWatcher<QByteArray> *>(sender());
+    if (!watcher) {
+        // not invoked from a QFutureWatcher
+        return;
+    }
+    if (watcher->result().isNull()) {
+        // do not load empty script
+        deleteLater();
+        watcher->deleteLater();
+
+        if (m_invocationContext.type() == QDBusMessage::MethodCallMessage) {
+            auto reply = m_invocationContext.createErrorReply("org.kde.kwin.Scripting.FileError", QString("Could not open %1").arg(fileName()));
+            QDBusConnection::sessionBus().send(reply);
+            m_invocationContext = QDBusMessage();
+        }
+
+        return;
+    }
+
+    QJSValue self = m_engine->newQObject(this);
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+
+    const QString source = QString::fromUtf8(watcher->result());
+    QJSValue result;
+    if (!m_sharedEngine) {
+        installGlobals(m_engine.get());
+        for (const QString &propertyName : s_scriptProperties) {
+            m_engine->globalObject().setProperty(propertyName, self.property(propertyName));
+        }
+        result = m_engine->evaluate(source, fileName());
+    } else {
+        // The script is wrapped in a function that gets the functions bound to it as arguments,
+        // so its own declarations don't clash with the ones of the other scripts. The wrapper
+        // starts on the first line of the script, so the reported line numbers stay the same.
+        result = m_engine->evaluate(QLatin1String("(function (") + s_scriptProperties.join(QLatin1String(", ")) + QLatin1String(") { ")
+                                        + source + QLatin1String("\n})"),
+                                    fileName());
+        if (!result.isError()) {
+            QJSValueList arguments;
+            for (const QString &propertyName : s_scriptProperties) {
+                arguments << self.property(propertyName);
+            }
+            result = result.call(arguments);
+        }
+    }
     if (result.isError()) {
         qCWarning(KWIN_SCRIPTING, "%s:%d: error: %s", qPrintable(fileName()),
                   result.property(QStringLiteral("lineNumber")).toInt(),
@@ -672,11 +700,18 @@ void KWin::Scripting::start()
     watcher->setFuture(QtConcurrent::run(this, &KWin::Scripting::queryScriptsToLoad, pluginStates, offers));
 #else
     LoadScriptList scriptsToLoad = queryScriptsToLoad();
+    // Running the scripts in one engine saves the memory and the setup of an engine per script,
+    // but a script may not expect to share the global object with other scripts
+    const bool sharedEngine = kwinApp()->config()->group("Scripting").readEntry("SharedEngine", false);
     for (LoadScriptList::const_iterator it = scriptsToLoad.constBegin();
          it != scriptsToLoad.constEnd();
          ++it) {
         if (it->first) {
-            loadScript(it->second.first, it->second.second);
+            if (sharedEngine) {
+                loadSharedScript(it->second.first, it->second.second);
+            } else {
+                loadScript(it->second.first, it->second.second);
+            }
         } else {
             loadDeclarativeScript(it->second.first, it->second.second);
         }
@@ -772,10 +807,29 @@ bool KWin::Scripting::unloadScript(const QString &pluginName)
 {
     QMutexLocker locker(m_scriptsLock.get());
     for (AbstractScript *script : std::as_const(scripts)) {
-        if (script->pluginName() == pluginName) {
+        if (script->pluginName() != pluginName) {
+            continue;
+        }
+        auto javaScript = qobject_cast<Script *>(script);
+        if (!javaScript || !javaScript->usesSharedEngine()) {
             script->deleteLater();
             return true;
         }
+
+        // The signal handlers that a script has connected are only disconnected when its engine
+        // is destroyed. So all the scripts in the shared engine are stopped, and the ones that
+        // are still enabled are started again in a new engine.
+        m_sharedScriptEngine.reset();
+        const QList<AbstractScript *> allScripts = scripts;
+        for (AbstractScript *other : allScripts) {
+            auto otherJavaScript = qobject_cast<Script *>(other);
+            if (otherJavaScript && otherJavaScript->usesSharedEngine()) {
+                scripts.removeOne(other);
+                other->deleteLater();
+            }
+        }
+        QMetaObject::invokeMethod(this, &Scripting::start, Qt::QueuedConnection);
+        return true;
     }
     return false;
 }
@@ -801,12 +855,37 @@ int KWin::Scripting::loadScript(const QString &filePath, const QString &pluginNa
         return -1;
     }
     const int id = scripts.size();
-    KWin::Script *script = new KWin::Script(id, filePath, pluginName, this);
+    KWin::Script *script = new KWin::Script(id, filePath, pluginName, nullptr, this);
+    connect(script, &QObject::destroyed, this, &Scripting::scriptDestroyed);
+    scripts.append(script);
+    return id;
+}
+
+int KWin::Scripting::loadSharedScript(const QString &filePath, const QString &pluginName)
+{
+    QMutexLocker locker(m_scriptsLock.get());
+    if (isScriptLoaded(pluginName)) {
+        return -1;
+    }
+    const int id = scripts.size();
+    KWin::Script *script = new KWin::Script(id, filePath, pluginName, sharedScriptEngine(), this);
     connect(script, &QObject::destroyed, this, &Scripting::scriptDestroyed);
     scripts.append(script);
     return id;
 }
 
+std::shared_ptr<QJSEngine> KWin::Scripting::sharedScriptEngine()
+{
+    if (auto engine = m_sharedScriptEngine.lock()) {
+        return engine;
+    }
+    // the engine is destroyed along with the last script that runs in it
+    auto engine = std::make_shared<QJSEngine>();
+    Script::installGlobals(engine.get());
+    m_sharedScriptEngine = engine;
+    return engine;
+}
+
 int KWin::Scripting::loadDeclarativeScript(const QString &filePath, const QString &pluginName)
 {
     QMutexLocker locker(m_scriptsLock.get());
@@ -22,6 +22,8 @@
 #include <QDBusContext>
 #include <QDBusMessage>
 
+#include <memory>
+
 class QQmlComponent;
 class QQmlContext;
 class QQmlEngine;
@@ -104,9 +106,22 @@ class Script : public AbstractScript, QDBusContext
 {
     Q_OBJECT
 public:
-    Script(int id, QString scriptName, QString pluginName, QObject *parent = nullptr);
+    /**
+     * Creates a script that runs in its own engine, or in @a sharedEngine if it's not @c null.
+     */
+    Script(int id, QString scriptName, QString pluginName, std::shared_ptr<QJSEngine> sharedEngine, QObject *parent = nullptr);
     virtual ~Script();
 
+    /**
+     * Returns @c true if the script runs in the engine that is shared by the scripts.
+     */
+    bool usesSharedEngine() const;
+
+    /**
+     * Sets up the global objects that are the same for all the scripts in @a engine.
+     */
+    static void installGlobals(QJSEngine *engine);
+
     Q_INVOKABLE QVariant readConfig(const QString &key, const QVariant &defaultValue = QVariant());
 
     Q_INVOKABLE void callDBus(const QString &service, const QString &path,
@@ -241,7 +256,8 @@ private:
      */
     QAction *createMenu(const QString &title, const QJSValue &items, QMenu *parent);
 
-    QJSEngine *m_engine;
+    std::shared_ptr<QJSEngine> m_engine;
+    const bool m_sharedEngine;
     QDBusMessage m_invocationContext;
     bool m_starting;
     QHash<int, QJSValueList> m_screenEdgeCallbacks;
@@ -322,6 +338,9 @@ private:
     // Preferably call ONLY at load time
     void runScripts();
 
+    int loadSharedScript(const QString &filePath, const QString &pluginName);
+    std::shared_ptr<QJSEngine> sharedScriptEngine();
+
 public:
     ~Scripting() override;
     Q_SCRIPTABLE Q_INVOKABLE int loadScript(const QString &filePath, const QString &pluginName = QString());
@@ -363,6 +382,7 @@ private:
     QQmlEngine *m_qmlEngine;
     QQmlContext *m_declarativeScriptSharedContext;
     QtScriptWorkspaceWrapper *m_workspaceWrapper;
+    std::weak_ptr<QJSEngine> m_sharedScriptEngine;
 };
 
 inline QQmlEngine *Scripting::qmlEngine() const
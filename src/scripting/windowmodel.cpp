@@ -29,6 +29,7 @@ WindowModel::WindowModel(QObject *parent)
 void WindowModel::markRoleChanged(Window *window, int role)
 {
     const QModelIndex row = index(m_windows.indexOf(window), 0);
+    Q_ASSERT(row.isValid());
     Q_EMIT dataChanged(row, row, {role});
 }
 
@@ -43,6 +44,9 @@ void WindowModel::setupWindowConnections(Window *window)
     connect(window, &Window::activitiesChanged, this, [this, window]() {
         markRoleChanged(window, ActivityRole);
     });
+    connect(window, &Window::minimizedChanged, this, [this, window]() {
+        markRoleChanged(window, MinimizedRole);
+    });
 }
 
 void WindowModel::handleWindowAdded(Window *window)
@@ -62,6 +66,9 @@ void WindowModel::handleWindowRemoved(Window *window)
     beginRemoveRows(QModelIndex(), index, index);
     m_windows.removeAt(index);
     endRemoveRows();
+
+    // the window may outlive its row, e.g. while it's being closed
+    disconnect(window, nullptr, this, nullptr);
 }
 
 QHash<int, QByteArray> WindowModel::roleNames() const
@@ -72,6 +79,7 @@ QHash<int, QByteArray> WindowModel::roleNames() const
         {OutputRole, QByteArrayLiteral("output")},
         {DesktopRole, QByteArrayLiteral("desktop")},
         {ActivityRole, QByteArrayLiteral("activity")},
+        {MinimizedRole, QByteArrayLiteral("minimized")},
     };
 }
 
@@ -92,6 +100,8 @@ QVariant WindowModel::data(const QModelIndex &index, int role) const
         return QVariant::fromValue(window->desktops());
     case ActivityRole:
         return window->activities();
+    case MinimizedRole:
+        return window->isMinimized();
     default:
         return QVariant();
     }
@@ -308,7 +318,7 @@ bool WindowFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourc
     return true;
 }
 
-WindowFilterModel::WindowTypes WindowFilterModel::windowTypeMask(Window *window) const
+WindowFilterModel::WindowTypes WindowFilterModel::windowTypeMask(Window *window)
 {
     WindowTypes mask;
     if (window->isNormalWindow()) {
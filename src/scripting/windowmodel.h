@@ -28,7 +28,8 @@ public:
         WindowRole = Qt::UserRole + 1,
         OutputRole,
         DesktopRole,
-        ActivityRole
+        ActivityRole,
+        MinimizedRole,
     };
 
     explicit WindowModel(QObject *parent = nullptr);
@@ -97,6 +98,11 @@ public:
     void setMinimizedWindows(bool show);
     bool minimizedWindows() const;
 
+    /**
+     * Returns the types in WindowType that the given @a window is of.
+     */
+    static WindowTypes windowTypeMask(Window *window);
+
 protected:
     bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
 
@@ -110,8 +116,6 @@ Q_SIGNALS:
     void minimizedWindowsChanged();
 
 private:
-    WindowTypes windowTypeMask(Window *window) const;
-
     WindowModel *m_windowModel = nullptr;
     std::optional<QString> m_activity;
     QPointer<Output> m_output;
@@ -0,0 +1,265 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "windowthumbnailcache.h"
+#include "composite.h"
+#include "core/graphicsbuffer.h"
+#include "libkwineffects/kwingltexture.h"
+#include "libkwineffects/kwinglutils.h"
+#include "libkwineffects/rendertarget.h"
+#include "libkwineffects/renderviewport.h"
+#include "platformsupport/scenes/opengl/openglsurfacetexture.h"
+#include "scene/itemrenderer.h"
+#include "scene/surfaceitem.h"
+#include "scene/surfaceitem_wayland.h"
+#include "scene/windowitem.h"
+#include "scene/workspacescene.h"
+#include "window.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace KWin
+{
+
+// the largest side of the thumbnail textures, in device pixels
+static const int s_sizeClasses[] = {256, 512, 1024, 2048, 4096};
+// thumbnails are refreshed at 30Hz at most
+static constexpr std::chrono::milliseconds s_refreshInterval(33);
+// buffers are sampled directly only if they don't alias noticeably without mipmaps
+static constexpr int s_maxDirectDownscale = 2;
+
+// keyed by the internal id, the address of a closed window can be reused by a new window
+static std::map<std::pair<QUuid, int>, std::weak_ptr<WindowThumbnail>> s_thumbnails;
+
+static int sizeClass(const QSize &size)
+{
+    const int extent = std::max(size.width(), size.height());
+    for (int sizeClass : s_sizeClasses) {
+        if (extent <= sizeClass) {
+            return sizeClass;
+        }
+    }
+    return std::end(s_sizeClasses)[-1];
+}
+
+WindowThumbnail::WindowThumbnail(Window *window, int extent)
+    : m_window(window)
+    , m_windowId(window->internalId())
+    , m_extent(extent)
+{
+    m_refreshTimer.setSingleShot(true);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &WindowThumbnail::changed);
+
+    connect(window, &Window::frameGeometryChanged, this, &WindowThumbnail::invalidate);
+    connect(window, &Window::damaged, this, &WindowThumbnail::invalidate);
+}
+
+WindowThumbnail::~WindowThumbnail()
+{
+    s_thumbnails.erase(std::make_pair(m_windowId, m_extent));
+    setDirectBuffer(nullptr);
+    if (m_fence) {
+        glDeleteSync(m_fence);
+    }
+}
+
+std::shared_ptr<WindowThumbnail> WindowThumbnail::get(Window *window, const QSize &size)
+{
+    const auto key = std::make_pair(window->internalId(), sizeClass(size));
+    if (auto it = s_thumbnails.find(key); it != s_thumbnails.end()) {
+        if (auto thumbnail = it->second.lock()) {
+            return thumbnail;
+        }
+    }
+
+    auto thumbnail = std::make_shared<WindowThumbnail>(window, key.second);
+    s_thumbnails[key] = thumbnail;
+    return thumbnail;
+}
+
+Window *WindowThumbnail::window() const
+{
+    return m_window;
+}
+
+std::shared_ptr<GLTexture> WindowThumbnail::texture() const
+{
+    return m_texture;
+}
+
+bool WindowThumbnail::isDirect() const
+{
+    return m_direct;
+}
+
+void WindowThumbnail::invalidate()
+{
+    if (m_dirty) {
+        return;
+    }
+    m_dirty = true;
+
+    const auto nextRefresh = m_lastRendered + s_refreshInterval;
+    const auto now = std::chrono::steady_clock::now();
+    if (now < nextRefresh) {
+        m_refreshTimer.start(std::chrono::duration_cast<std::chrono::milliseconds>(nextRefresh - now) + std::chrono::milliseconds(1));
+    } else {
+        Q_EMIT changed();
+    }
+}
+
+void WindowThumbnail::update()
+{
+    if (!m_dirty || !m_window || m_refreshTimer.isActive()) {
+        return;
+    }
+    if (std::chrono::steady_clock::now() < m_lastRendered + s_refreshInterval) {
+        return;
+    }
+    if (!updateDirect()) {
+        render();
+    }
+}
+
+void WindowThumbnail::waitForRendering()
+{
+    if (m_fence) {
+        glClientWaitSync(m_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 5000);
+    }
+}
+
+SurfaceItem *WindowThumbnail::directSurfaceItem() const
+{
+    WindowItem *windowItem = m_window->windowItem();
+    if (!windowItem || windowItem->decorationItem() || windowItem->shadowItem()) {
+        return nullptr;
+    }
+    SurfaceItem *surfaceItem = windowItem->surfaceItem();
+    if (!surfaceItem || !surfaceItem->childItems().isEmpty()) {
+        return nullptr;
+    }
+
+    // the buffer must cover the surface exactly, without being cropped, rotated or flipped
+    const SurfacePixmap *pixmap = surfaceItem->pixmap();
+    const QMatrix4x4 matrix = surfaceItem->surfaceToBufferMatrix();
+    if (!pixmap || matrix(0, 1) != 0 || matrix(1, 0) != 0 || matrix(0, 0) <= 0 || matrix(1, 1) <= 0
+        || matrix.mapRect(surfaceItem->rect()) != QRectF(QPointF(0, 0), pixmap->size())) {
+        return nullptr;
+    }
+    return surfaceItem;
+}
+
+bool WindowThumbnail::updateDirect()
+{
+    SurfaceItem *surfaceItem = directSurfaceItem();
+    if (!surfaceItem) {
+        return false;
+    }
+
+    // the window may not be painted otherwise, so its texture has to be kept up to date here
+    Compositor::self()->scene()->renderer()->prewarm(surfaceItem);
+
+    const SurfacePixmap *pixmap = surfaceItem->pixmap();
+    if (!pixmap || pixmap->solidColor()) {
+        return false;
+    }
+    std::shared_ptr<GLTexture> bufferTexture = static_cast<OpenGLSurfaceTexture *>(pixmap->texture())->textureRef();
+    if (!bufferTexture || bufferTexture->target() != GL_TEXTURE_2D
+        || std::max(bufferTexture->width(), bufferTexture->height()) > m_extent * s_maxDirectDownscale) {
+        return false;
+    }
+
+    // The thumbnail shows the buffer until it's updated again, which may be a while after the
+    // surface has moved on to another buffer. The buffer must not be handed back to the client
+    // until then, otherwise the client could draw into it while it's being sampled.
+    const auto waylandPixmap = qobject_cast<const SurfacePixmapWayland *>(pixmap);
+    setDirectBuffer(waylandPixmap ? waylandPixmap->buffer() : nullptr);
+    m_texture = std::move(bufferTexture);
+    m_framebuffer.reset();
+    m_direct = true;
+
+    finishUpdate();
+    return true;
+}
+
+void WindowThumbnail::render()
+{
+    const QRectF geometry = m_window->visibleGeometry();
+    if (geometry.isEmpty()) {
+        return;
+    }
+
+    // the texture fits the size class, the window is scaled to it as a whole
+    const qreal scale = m_extent / std::max(geometry.width(), geometry.height());
+    const QSize textureSize = (geometry.size() * scale).toSize().expandedTo(QSize(1, 1));
+
+    if (!m_texture || m_direct || m_texture->size() != textureSize) {
+        const int levels = std::floor(std::log2(std::max(textureSize.width(), textureSize.height()))) + 1;
+        // the consumers may still sample the previous texture, it's not reused
+        m_texture = std::make_shared<GLTexture>(GL_RGBA8, textureSize, levels);
+        m_texture->setMemoryCategory(GLTextureMemory::Category::Thumbnail);
+        m_texture->setFilter(GL_LINEAR_MIPMAP_LINEAR);
+        m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
+        m_framebuffer = std::make_unique<GLFramebuffer>(m_texture.get());
+        m_direct = false;
+        setDirectBuffer(nullptr);
+    }
+
+    RenderTarget renderTarget(m_framebuffer.get());
+    RenderViewport viewport(geometry, scale, renderTarget);
+    GLFramebuffer::pushFramebuffer(m_framebuffer.get());
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    QMatrix4x4 projectionMatrix;
+    projectionMatrix.ortho(geometry.x() * scale, (geometry.x() + geometry.width()) * scale,
+                           geometry.y() * scale, (geometry.y() + geometry.height()) * scale, -1, 1);
+
+    WindowPaintData data;
+    data.setProjectionMatrix(projectionMatrix);
+
+    // The thumbnail must be rendered using kwin's opengl context as VAOs are not
+    // shared across contexts. Unfortunately, this also introduces a latency of 1
+    // frame, which is not ideal, but it is acceptable for things such as thumbnails.
+    const int mask = Scene::PAINT_WINDOW_TRANSFORMED;
+    Compositor::self()->scene()->renderer()->renderItem(renderTarget, viewport, m_window->windowItem(), mask, infiniteRegion(), data);
+    GLFramebuffer::popFramebuffer();
+
+    m_texture->generateMipmaps();
+    finishUpdate();
+}
+
+void WindowThumbnail::setDirectBuffer(GraphicsBuffer *buffer)
+{
+    if (m_directBuffer == buffer) {
+        return;
+    }
+    if (m_directBuffer) {
+        m_directBuffer->unref();
+    }
+    m_directBuffer = buffer;
+    if (m_directBuffer) {
+        m_directBuffer->ref();
+    }
+}
+
+void WindowThumbnail::finishUpdate()
+{
+    // The fence is needed to avoid the case where qtquick renderer starts using
+    // the texture while all rendering commands to it haven't completed yet.
+    if (m_fence) {
+        glDeleteSync(m_fence);
+    }
+    m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_dirty = false;
+    m_lastRendered = std::chrono::steady_clock::now();
+    Q_EMIT changed();
+}
+
+} // namespace KWin
@@ -0,0 +1,106 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QSize>
+#include <QTimer>
+#include <QUuid>
+
+#include <epoxy/gl.h>
+
+#include <chrono>
+#include <memory>
+
+namespace KWin
+{
+class Window;
+class GraphicsBuffer;
+class GLFramebuffer;
+class GLTexture;
+class SurfaceItem;
+
+/**
+ * The WindowThumbnail class provides a mip-mapped texture that shows the contents of a window.
+ *
+ * Thumbnails are cached per window and size class, all consumers that need a thumbnail of
+ * roughly the same size share it. The thumbnail is released when its last consumer drops it.
+ *
+ * The thumbnail is only rendered again after the window has been damaged, and not more often
+ * than the thumbnail refresh rate permits. If the window consists of a single surface without
+ * any decoration, shadow or subsurfaces, and its buffer isn't much bigger than the thumbnail,
+ * the buffer is sampled directly rather than being rendered into a texture first.
+ */
+class WindowThumbnail : public QObject
+{
+    Q_OBJECT
+
+public:
+    WindowThumbnail(Window *window, int extent);
+    ~WindowThumbnail() override;
+
+    /**
+     * Returns the shared thumbnail of the given @a window whose texture is at least @a size
+     * big, in device pixels, except for the larger sizes, which are capped.
+     */
+    static std::shared_ptr<WindowThumbnail> get(Window *window, const QSize &size);
+
+    Window *window() const;
+
+    /**
+     * Returns the texture with the contents of the window, or @c null if the thumbnail has not
+     * been rendered yet.
+     */
+    std::shared_ptr<GLTexture> texture() const;
+
+    /**
+     * Returns @c true if texture() refers to the buffer of the window rather than a rendered
+     * thumbnail. Such textures have no mipmaps and may have a content transform.
+     */
+    bool isDirect() const;
+
+    /**
+     * Renders the thumbnail if the window has been damaged since the last time and the
+     * thumbnail is due. The OpenGL context of the scene must be current.
+     */
+    void update();
+
+    /**
+     * Waits until the rendering commands issued by the last update() have completed.
+     */
+    void waitForRendering();
+
+Q_SIGNALS:
+    /**
+     * Emitted when the texture has changed, or when the thumbnail is due to be updated.
+     */
+    void changed();
+
+private:
+    void invalidate();
+    SurfaceItem *directSurfaceItem() const;
+    bool updateDirect();
+    void setDirectBuffer(GraphicsBuffer *buffer);
+    void render();
+    void finishUpdate();
+
+    QPointer<Window> m_window;
+    const QUuid m_windowId;
+    const int m_extent;
+    std::shared_ptr<GLTexture> m_texture;
+    std::unique_ptr<GLFramebuffer> m_framebuffer;
+    // the buffer that a direct texture shows, referenced until the thumbnail is updated
+    GraphicsBuffer *m_directBuffer = nullptr;
+    GLsync m_fence = 0;
+    QTimer m_refreshTimer;
+    std::chrono::steady_clock::time_point m_lastRendered;
+    bool m_dirty = true;
+    bool m_direct = false;
+};
+
+} // namespace KWin
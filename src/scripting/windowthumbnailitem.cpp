@@ -10,14 +10,11 @@
 #include "composite.h"
 #include "core/renderbackend.h"
 #include "effects.h"
-#include "libkwineffects/rendertarget.h"
-#include "libkwineffects/renderviewport.h"
-#include "scene/itemrenderer.h"
-#include "scene/windowitem.h"
 #include "scene/workspacescene.h"
 #include "scripting_logging.h"
 #include "virtualdesktops.h"
 #include "window.h"
+#include "windowthumbnailcache.h"
 #include "workspace.h"
 
 #include "libkwineffects/kwingltexture.h"
@@ -36,7 +33,7 @@ public:
     explicit ThumbnailTextureProvider(QQuickWindow *window);
 
     QSGTexture *texture() const override;
-    void setTexture(const std::shared_ptr<GLTexture> &nativeTexture);
+    void setTexture(const std::shared_ptr<GLTexture> &nativeTexture, bool mipmaps);
     void setTexture(QSGTexture *texture);
 
 private:
@@ -55,15 +52,20 @@ QSGTexture *ThumbnailTextureProvider::texture() const
     return m_texture.get();
 }
 
-void ThumbnailTextureProvider::setTexture(const std::shared_ptr<GLTexture> &nativeTexture)
+void ThumbnailTextureProvider::setTexture(const std::shared_ptr<GLTexture> &nativeTexture, bool mipmaps)
 {
     if (m_nativeTexture != nativeTexture) {
         const GLuint textureId = nativeTexture->texture();
         m_nativeTexture = nativeTexture;
+        QQuickWindow::CreateTextureOptions options = QQuickWindow::TextureHasAlphaChannel;
+        if (mipmaps) {
+            options |= QQuickWindow::TextureHasMipmaps;
+        }
         m_texture.reset(QNativeInterface::QSGOpenGLTexture::fromNative(textureId, m_window,
                                                                        nativeTexture->size(),
-                                                                       QQuickWindow::TextureHasAlphaChannel));
+                                                                       options));
         m_texture->setFiltering(QSGTexture::Linear);
+        m_texture->setMipmapFiltering(mipmaps ? QSGTexture::Linear : QSGTexture::None);
         m_texture->setHorizontalWrapMode(QSGTexture::ClampToEdge);
         m_texture->setVerticalWrapMode(QSGTexture::ClampToEdge);
     }
@@ -180,7 +182,7 @@ void WindowThumbnailItem::setSourceSize(const QSize &sourceSize)
 {
     if (m_sourceSize != sourceSize) {
         m_sourceSize = sourceSize;
-        invalidateOffscreenTexture();
+        update();
         Q_EMIT sourceSizeChanged();
     }
 }
@@ -194,43 +196,49 @@ void WindowThumbnailItem::destroyOffscreenTexture()
         return;
     }
 
-    if (m_offscreenTexture) {
+    if (m_thumbnail) {
         WorkspaceScene *scene = Compositor::self()->scene();
         scene->makeOpenGLContextCurrent();
-        m_offscreenTarget.reset();
-        m_offscreenTexture.reset();
-
-        if (m_acquireFence) {
-            glDeleteSync(m_acquireFence);
-            m_acquireFence = 0;
-        }
+        setThumbnail(nullptr);
         scene->doneOpenGLContextCurrent();
     }
 }
 
+bool WindowThumbnailItem::evictOffscreenTexture()
+{
+    if (isVisible() || !m_thumbnail) {
+        return false;
+    }
+    // the thumbnail is only destroyed if no other item shares it
+    setThumbnail(nullptr);
+    // the texture provider holds a reference to the texture as well
+    if (m_provider && window()) {
+        m_provider->setTexture(window()->createTextureFromImage(fallbackImage()));
+    }
+    return true;
+}
+
 QSGNode *WindowThumbnailItem::updatePaintNode(QSGNode *oldNode, QQuickItem::UpdatePaintNodeData *)
 {
-    if (Compositor::compositing() && !m_offscreenTexture) {
+    const std::shared_ptr<GLTexture> texture = m_thumbnail ? m_thumbnail->texture() : nullptr;
+    if (Compositor::compositing() && !texture) {
         return oldNode;
     }
 
     // Wait for rendering commands to the offscreen texture complete if there are any.
-    if (m_acquireFence) {
-        glClientWaitSync(m_acquireFence, GL_SYNC_FLUSH_COMMANDS_BIT, 5000);
-        glDeleteSync(m_acquireFence);
-        m_acquireFence = 0;
+    if (m_thumbnail) {
+        m_thumbnail->waitForRendering();
     }
 
     if (!m_provider) {
         m_provider = new ThumbnailTextureProvider(window());
     }
 
-    if (m_offscreenTexture) {
-        m_provider->setTexture(m_offscreenTexture);
+    if (texture) {
+        m_provider->setTexture(texture, !m_thumbnail->isDirect());
+        m_cacheEntry->touch();
     } else {
-        const QImage placeholderImage = fallbackImage();
-        m_provider->setTexture(window()->createTextureFromImage(placeholderImage));
-        m_devicePixelRatio = placeholderImage.devicePixelRatio();
+        m_provider->setTexture(window()->createTextureFromImage(fallbackImage()));
     }
 
     QSGImageNode *node = static_cast<QSGImageNode *>(oldNode);
@@ -238,8 +246,12 @@ QSGNode *WindowThumbnailItem::updatePaintNode(QSGNode *oldNode, QQuickItem::Upda
         node = window()->createImageNode();
         node->setFiltering(QSGTexture::Linear);
     }
+    const bool mipmaps = texture && !m_thumbnail->isDirect();
+    node->setMipmapFiltering(mipmaps ? QSGTexture::Linear : QSGTexture::None);
     node->setTexture(m_provider->texture());
-    node->setTextureCoordinatesTransform(QSGImageNode::NoTransform);
+    // buffers of clients are stored top to bottom, unlike the rendered thumbnails
+    const bool mirrored = texture && (texture->contentTransforms() & TextureTransform::MirrorY);
+    node->setTextureCoordinatesTransform(mirrored ? QSGImageNode::MirrorVertically : QSGImageNode::NoTransform);
     node->setRect(paintedRect());
 
     return node;
@@ -260,6 +272,7 @@ void WindowThumbnailItem::setWId(const QUuid &wId)
         setClient(workspace()->findWindow(wId));
     } else if (m_client) {
         m_client = nullptr;
+        m_offscreenRef.reset();
         updateImplicitSize();
         Q_EMIT clientChanged();
     }
@@ -277,26 +290,22 @@ void WindowThumbnailItem::setClient(Window *client)
         return;
     }
     if (m_client) {
-        disconnect(m_client, &Window::frameGeometryChanged,
-                   this, &WindowThumbnailItem::invalidateOffscreenTexture);
-        disconnect(m_client, &Window::damaged,
-                   this, &WindowThumbnailItem::invalidateOffscreenTexture);
         disconnect(m_client, &Window::frameGeometryChanged,
                    this, &WindowThumbnailItem::updateImplicitSize);
     }
     m_client = client;
+    m_offscreenRef.reset();
     if (m_client) {
-        connect(m_client, &Window::frameGeometryChanged,
-                this, &WindowThumbnailItem::invalidateOffscreenTexture);
-        connect(m_client, &Window::damaged,
-                this, &WindowThumbnailItem::invalidateOffscreenTexture);
         connect(m_client, &Window::frameGeometryChanged,
                 this, &WindowThumbnailItem::updateImplicitSize);
+        m_offscreenRef = std::make_unique<WindowOffscreenRenderRef>(m_client);
         setWId(m_client->internalId());
     } else {
         setWId(QUuid());
     }
-    invalidateOffscreenTexture();
+    // the thumbnail of the new window is picked up with the next frame
+    destroyOffscreenTexture();
+    update();
     updateImplicitSize();
     Q_EMIT clientChanged();
 }
@@ -331,7 +340,7 @@ QRectF WindowThumbnailItem::paintedRect() const
     if (!m_client) {
         return QRectF();
     }
-    if (!m_offscreenTexture) {
+    if (!m_thumbnail || !m_thumbnail->texture()) {
         const QSizeF iconSize = m_client->icon().actualSize(window(), boundingRect().size().toSize());
         return centeredSize(boundingRect(), iconSize);
     }
@@ -354,65 +363,53 @@ QRectF WindowThumbnailItem::paintedRect() const
     return paintedRect;
 }
 
-void WindowThumbnailItem::invalidateOffscreenTexture()
+QSize WindowThumbnailItem::thumbnailSize() const
 {
-    m_dirty = true;
-    update();
+    const qreal devicePixelRatio = window()->devicePixelRatio();
+    QSizeF size = boundingRect().size();
+    if (sourceSize().width() > 0) {
+        size.setWidth(sourceSize().width());
+    }
+    if (sourceSize().height() > 0) {
+        size.setHeight(sourceSize().height());
+    }
+    return (size * devicePixelRatio).toSize();
 }
 
-void WindowThumbnailItem::updateOffscreenTexture()
+void WindowThumbnailItem::setThumbnail(const std::shared_ptr<WindowThumbnail> &thumbnail)
 {
-    if (m_acquireFence || !m_dirty || !m_client) {
+    if (m_thumbnail == thumbnail) {
         return;
     }
-    Q_ASSERT(window());
-
-    const QRectF geometry = m_client->visibleGeometry();
-    QSize textureSize = geometry.toAlignedRect().size();
-    if (sourceSize().width() > 0) {
-        textureSize.setWidth(sourceSize().width());
+    if (m_thumbnail) {
+        disconnect(m_thumbnail.get(), &WindowThumbnail::changed, this, &WindowThumbnailItem::update);
     }
-    if (sourceSize().height() > 0) {
-        textureSize.setHeight(sourceSize().height());
+    m_thumbnail = thumbnail;
+    if (m_thumbnail) {
+        connect(m_thumbnail.get(), &WindowThumbnail::changed, this, &WindowThumbnailItem::update);
+        update();
     }
+}
 
-    m_devicePixelRatio = window()->devicePixelRatio();
-    textureSize *= m_devicePixelRatio;
-
-    if (!m_offscreenTexture || m_offscreenTexture->size() != textureSize) {
-        m_offscreenTexture.reset(new GLTexture(GL_RGBA8, textureSize));
-        m_offscreenTexture->setFilter(GL_LINEAR);
-        m_offscreenTexture->setWrapMode(GL_CLAMP_TO_EDGE);
-        m_offscreenTarget.reset(new GLFramebuffer(m_offscreenTexture.get()));
+void WindowThumbnailItem::updateOffscreenTexture()
+{
+    // hidden thumbnails are rendered once they are shown again
+    if (!m_client || !isVisible()) {
+        return;
     }
+    Q_ASSERT(window());
 
-    RenderTarget offscreenRenderTarget(m_offscreenTarget.get());
-    RenderViewport offscreenViewport(geometry, m_devicePixelRatio, offscreenRenderTarget);
-    GLFramebuffer::pushFramebuffer(m_offscreenTarget.get());
-    glClearColor(0.0, 0.0, 0.0, 0.0);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    QMatrix4x4 projectionMatrix;
-    projectionMatrix.ortho(geometry.x() * m_devicePixelRatio, (geometry.x() + geometry.width()) * m_devicePixelRatio,
-                           geometry.y() * m_devicePixelRatio, (geometry.y() + geometry.height()) * m_devicePixelRatio, -1, 1);
-
-    WindowPaintData data;
-    data.setProjectionMatrix(projectionMatrix);
-
-    // The thumbnail must be rendered using kwin's opengl context as VAOs are not
-    // shared across contexts. Unfortunately, this also introduces a latency of 1
-    // frame, which is not ideal, but it is acceptable for things such as thumbnails.
-    const int mask = Scene::PAINT_WINDOW_TRANSFORMED;
-    Compositor::self()->scene()->renderer()->renderItem(offscreenRenderTarget, offscreenViewport, m_client->windowItem(), mask, infiniteRegion(), data);
-    GLFramebuffer::popFramebuffer();
-
-    // The fence is needed to avoid the case where qtquick renderer starts using
-    // the texture while all rendering commands to it haven't completed yet.
-    m_dirty = false;
-    m_acquireFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // items that show the same window at a similar size share the thumbnail
+    setThumbnail(WindowThumbnail::get(m_client, thumbnailSize()));
+    if (!m_cacheEntry) {
+        m_cacheEntry = std::make_unique<GLTextureCacheEntry>([this]() {
+            return evictOffscreenTexture();
+        });
+    }
+    m_cacheEntry->touch();
 
-    // We know that the texture has changed, so schedule an item update.
-    update();
+    // emits changed() if the texture gets updated, which schedules an item update
+    m_thumbnail->update();
 }
 
 } // namespace KWin
@@ -10,14 +10,14 @@
 #include <QQuickItem>
 #include <QUuid>
 
-#include <epoxy/gl.h>
-
 namespace KWin
 {
 class Window;
-class GLFramebuffer;
 class GLTexture;
+class GLTextureCacheEntry;
 class ThumbnailTextureProvider;
+class WindowThumbnail;
+class WindowOffscreenRenderRef;
 
 class WindowThumbnailItem : public QQuickItem
 {
@@ -54,9 +54,11 @@ Q_SIGNALS:
 private:
     QImage fallbackImage() const;
     QRectF paintedRect() const;
-    void invalidateOffscreenTexture();
+    QSize thumbnailSize() const;
+    void setThumbnail(const std::shared_ptr<WindowThumbnail> &thumbnail);
     void updateOffscreenTexture();
     void destroyOffscreenTexture();
+    bool evictOffscreenTexture();
     void updateImplicitSize();
     void updateFrameRenderingConnection();
     static bool useGlThumbnails();
@@ -64,13 +66,12 @@ private:
     QSize m_sourceSize;
     QUuid m_wId;
     QPointer<Window> m_client;
-    bool m_dirty = false;
+    // keeps the window rendering at the refresh rate while it's shown in the thumbnail
+    std::unique_ptr<WindowOffscreenRenderRef> m_offscreenRef;
 
     mutable ThumbnailTextureProvider *m_provider = nullptr;
-    std::shared_ptr<GLTexture> m_offscreenTexture;
-    std::unique_ptr<GLFramebuffer> m_offscreenTarget;
-    GLsync m_acquireFence = 0;
-    qreal m_devicePixelRatio = 1;
+    std::shared_ptr<WindowThumbnail> m_thumbnail;
+    std::unique_ptr<GLTextureCacheEntry> m_cacheEntry;
 
     QMetaObject::Connection m_frameRenderingConnection;
 };
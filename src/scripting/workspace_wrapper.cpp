@@ -15,6 +15,7 @@
 #include "outline.h"
 #include "tiles/tilemanager.h"
 #include "virtualdesktops.h"
+#include "windowmodel.h"
 #include "workspace.h"
 #include "x11window.h"
 #if KWIN_BUILD_ACTIVITIES
@@ -367,6 +368,32 @@ QtScriptWorkspaceWrapper::QtScriptWorkspaceWrapper(QObject *parent)
 {
 }
 
+static_assert(int(WorkspaceWrapper::NormalWindow) == int(WindowFilterModel::Normal));
+static_assert(int(WorkspaceWrapper::DialogWindow) == int(WindowFilterModel::Dialog));
+static_assert(int(WorkspaceWrapper::DockWindow) == int(WindowFilterModel::Dock));
+static_assert(int(WorkspaceWrapper::DesktopWindow) == int(WindowFilterModel::Desktop));
+static_assert(int(WorkspaceWrapper::NotificationWindow) == int(WindowFilterModel::Notification));
+static_assert(int(WorkspaceWrapper::CriticalNotificationWindow) == int(WindowFilterModel::CriticalNotification));
+
+QList<KWin::Window *> WorkspaceWrapper::filterWindows(KWin::Output *output, KWin::VirtualDesktop *desktop, int windowTypes) const
+{
+    const WindowFilterModel::WindowTypes types(windowTypes);
+    QList<KWin::Window *> windows;
+    for (Window *window : workspace()->windows()) {
+        if (output && !window->isOnOutput(output)) {
+            continue;
+        }
+        if (desktop && !window->isOnDesktop(desktop)) {
+            continue;
+        }
+        if (windowTypes != AllWindowTypes && !(WindowFilterModel::windowTypeMask(window) & types)) {
+            continue;
+        }
+        windows.append(window);
+    }
+    return windows;
+}
+
 QList<KWin::Window *> QtScriptWorkspaceWrapper::clientList() const
 {
     return workspace()->windows();
@@ -165,6 +165,17 @@ public:
         ElectricNone
     };
     Q_ENUM(ElectricBorder)
+    // the same values as in WindowFilterModel::WindowType
+    enum WindowType {
+        NormalWindow = 0x1,
+        DialogWindow = 0x2,
+        DockWindow = 0x4,
+        DesktopWindow = 0x8,
+        NotificationWindow = 0x10,
+        CriticalNotificationWindow = 0x20,
+        AllWindowTypes = 0x3f,
+    };
+    Q_ENUM(WindowType)
 
 protected:
     explicit WorkspaceWrapper(QObject *parent = nullptr);
@@ -195,6 +206,16 @@ public:
 
     Q_INVOKABLE KWin::Output *screenAt(const QPointF &pos) const;
 
+    /**
+     * Returns the windows that are on the given @a output and @a desktop, and whose type is
+     * one of the @a windowTypes, a combination of WindowType values. A @c null output or desktop
+     * matches all of them, and AllWindowTypes also matches the windows of the other types.
+     *
+     * The windows are filtered before they're passed to the script, which is cheaper than
+     * getting all of them and filtering them in the script.
+     */
+    Q_INVOKABLE QList<KWin::Window *> filterWindows(KWin::Output *output = nullptr, KWin::VirtualDesktop *desktop = nullptr, int windowTypes = AllWindowTypes) const;
+
     Q_INVOKABLE KWin::TileManager *tilingForScreen(const QString &screenName) const;
     Q_INVOKABLE KWin::TileManager *tilingForScreen(KWin::Output *output) const;
 
@@ -60,7 +60,11 @@ std::unique_ptr<Shadow> Shadow::createShadowFromX11(Window *window)
     if (!x11Window) {
         return nullptr;
     }
-    auto data = Shadow::readX11ShadowProperty(x11Window->window());
+    Xcb::Property property = x11Window->takePrefetchedShadow();
+    if (property.window() == XCB_WINDOW_NONE) {
+        property = fetchX11ShadowProperty(x11Window->window());
+    }
+    auto data = Shadow::readX11ShadowProperty(property);
     if (!data.isEmpty()) {
         auto shadow = std::make_unique<Shadow>(window);
         if (!shadow->init(data)) {
@@ -118,17 +122,28 @@ std::unique_ptr<Shadow> Shadow::createShadowFromInternalWindow(Window *window)
     return shadow;
 }
 
+Xcb::Property Shadow::fetchX11ShadowProperty(xcb_window_t id)
+{
+    if (id == XCB_WINDOW_NONE) {
+        return Xcb::Property();
+    }
+    return Xcb::Property(false, id, atoms->kde_net_wm_shadow, XCB_ATOM_CARDINAL, 0, 12);
+}
+
 QVector<uint32_t> Shadow::readX11ShadowProperty(xcb_window_t id)
+{
+    Xcb::Property property = fetchX11ShadowProperty(id);
+    return readX11ShadowProperty(property);
+}
+
+QVector<uint32_t> Shadow::readX11ShadowProperty(Xcb::Property &property)
 {
     QVector<uint32_t> ret;
-    if (id != XCB_WINDOW_NONE) {
-        Xcb::Property property(false, id, atoms->kde_net_wm_shadow, XCB_ATOM_CARDINAL, 0, 12);
-        uint32_t *shadow = property.value<uint32_t *>();
-        if (shadow) {
-            ret.reserve(12);
-            for (int i = 0; i < 12; ++i) {
-                ret << shadow[i];
-            }
+    uint32_t *shadow = property.value<uint32_t *>();
+    if (shadow) {
+        ret.reserve(12);
+        for (int i = 0; i < 12; ++i) {
+            ret << shadow[i];
         }
     }
     return ret;
@@ -136,6 +151,12 @@ QVector<uint32_t> Shadow::readX11ShadowProperty(xcb_window_t id)
 
 bool Shadow::init(const QVector<uint32_t> &data)
 {
+    // Clients tend to set the property again with the same pixmaps, the pixmap contents
+    // are only transferred again if the pixmaps or the offsets have changed.
+    if (data == m_x11ShadowData) {
+        return true;
+    }
+    m_x11ShadowData.clear();
     QVector<Xcb::WindowGeometry> pixmapGeometries(ShadowElementsCount);
     QVector<xcb_get_image_cookie_t> getImageCookies(ShadowElementsCount);
     auto *c = kwinApp()->x11Connection();
@@ -171,6 +192,7 @@ bool Shadow::init(const QVector<uint32_t> &data)
                         data[ShadowElementsCount],
                         data[ShadowElementsCount + 1],
                         data[ShadowElementsCount + 2]);
+    m_x11ShadowData = data;
     Q_EMIT offsetChanged();
     Q_EMIT textureChanged();
     return true;
@@ -26,6 +26,11 @@ class ShadowInterface;
 namespace KWin
 {
 
+namespace Xcb
+{
+class Property;
+}
+
 class Window;
 
 /**
@@ -73,6 +78,12 @@ public:
      */
     static std::unique_ptr<Shadow> createShadow(Window *window);
 
+    /**
+     * Requests the _KDE_NET_WM_SHADOW property of the X11 window @p id without waiting for
+     * the reply, so the request can be batched with other requests.
+     */
+    static Xcb::Property fetchX11ShadowProperty(xcb_window_t id);
+
     Window *window() const;
 
     bool hasDecorationShadow() const
@@ -126,6 +137,7 @@ private:
     static std::unique_ptr<Shadow> createShadowFromWayland(Window *window);
     static std::unique_ptr<Shadow> createShadowFromInternalWindow(Window *window);
     static QVector<uint32_t> readX11ShadowProperty(xcb_window_t id);
+    static QVector<uint32_t> readX11ShadowProperty(Xcb::Property &property);
     bool init(const QVector<uint32_t> &data);
     bool init(KDecoration2::Decoration *decoration);
     bool init(const QPointer<KWaylandServer::ShadowInterface> &shadow);
@@ -135,6 +147,8 @@ private:
     QImage m_shadowElements[ShadowElementsCount];
     // shadow offsets
     QMargins m_offset;
+    // the pixmap ids and offsets the X11 shadow has been read from
+    QVector<uint32_t> m_x11ShadowData;
     // caches
     QSizeF m_cachedSize;
     // Decoration based shadows
@@ -20,6 +20,7 @@
 #include "x11window.h"
 #include <QDebug>
 #include <QSessionManager>
+#include <QTimer>
 
 #include "sessionadaptor.h"
 #include <QDBusConnection>
@@ -218,10 +219,19 @@ void SessionManager::storeSubSession(const QString &name, QSet<QByteArray> sessi
  */
 void SessionManager::loadSession(const QString &sessionName)
 {
+    qDeleteAll(session);
     session.clear();
+    m_sessionIdIndex.clear();
+    m_windowClassIndex.clear();
     KConfigGroup cg(sessionConfig(sessionName, QString()), "Session");
     Q_EMIT loadSessionRequested(sessionName);
     addSessionInfo(cg);
+    startRestore();
+}
+
+static QString windowClassKey(const QString &resourceName, const QString &resourceClass)
+{
+    return resourceName + QChar() + resourceClass;
 }
 
 void SessionManager::addSessionInfo(KConfigGroup &cg)
@@ -259,6 +269,32 @@ void SessionManager::addSessionInfo(KConfigGroup &cg)
         info->active = (active_client == i);
         info->stackingOrder = cg.readEntry(QLatin1String("stackingOrder") + n, -1);
         info->activities = cg.readEntry(QLatin1String("activities") + n, QStringList());
+
+        if (!info->sessionId.isEmpty()) {
+            m_sessionIdIndex[info->sessionId].append(info);
+        }
+        m_windowClassIndex[windowClassKey(info->resourceName, info->resourceClass)].append(info);
+    }
+}
+
+void SessionManager::removeSessionInfo(SessionInfo *info)
+{
+    session.removeOne(info);
+
+    auto sessionIdIt = m_sessionIdIndex.find(info->sessionId);
+    if (sessionIdIt != m_sessionIdIndex.end()) {
+        sessionIdIt->removeOne(info);
+        if (sessionIdIt->isEmpty()) {
+            m_sessionIdIndex.erase(sessionIdIt);
+        }
+    }
+
+    auto windowClassIt = m_windowClassIndex.find(windowClassKey(info->resourceName, info->resourceClass));
+    if (windowClassIt != m_windowClassIndex.end()) {
+        windowClassIt->removeOne(info);
+        if (windowClassIt->isEmpty()) {
+            m_windowClassIndex.erase(windowClassIt);
+        }
     }
 }
 
@@ -266,6 +302,39 @@ void SessionManager::loadSubSessionInfo(const QString &name)
 {
     KConfigGroup cg(KSharedConfig::openConfig(), QLatin1String("SubSession: ") + name);
     addSessionInfo(cg);
+    startRestore();
+}
+
+/**
+ * Holds back stacking order updates while the windows of a session show up, each restored
+ * window would otherwise restack all windows and update the client list properties. The
+ * restore is over when all windows of the session have been restored, when no restored
+ * window has shown up for a moment, e.g. because some application doesn't start, or at
+ * the latest after two seconds, so a slowly starting session doesn't leave the stacking
+ * order stale for long.
+ */
+void SessionManager::startRestore()
+{
+    if (session.isEmpty()) {
+        return;
+    }
+    if (!m_restoring) {
+        m_restoring = true;
+        workspace()->blockStackingUpdates(true);
+        m_restoreDeadlineTimer->start();
+    }
+    m_restoreTimer->start();
+}
+
+void SessionManager::finishRestore()
+{
+    if (!m_restoring) {
+        return;
+    }
+    m_restoring = false;
+    m_restoreTimer->stop();
+    m_restoreDeadlineTimer->stop();
+    workspace()->blockStackingUpdates(false);
 }
 
 static bool sessionInfoWindowTypeMatch(X11Window *c, SessionInfo *info)
@@ -298,48 +367,64 @@ SessionInfo *SessionManager::takeSessionInfo(X11Window *c)
     // First search ``session''
     if (!sessionId.isEmpty()) {
         // look for a real session managed client (algorithm suggested by ICCCM)
-        for (SessionInfo *info : std::as_const(session)) {
-            if (realInfo) {
-                break;
+        const QList<SessionInfo *> candidates = m_sessionIdIndex.value(sessionId);
+        for (SessionInfo *info : candidates) {
+            if (!sessionInfoWindowTypeMatch(c, info)) {
+                continue;
             }
-            if (info->sessionId == sessionId && sessionInfoWindowTypeMatch(c, info)) {
-                if (!windowRole.isEmpty()) {
-                    if (info->windowRole == windowRole) {
-                        realInfo = info;
-                        session.removeAll(info);
-                    }
-                } else {
-                    if (info->windowRole.isEmpty()
-                        && info->resourceName == resourceName
-                        && info->resourceClass == resourceClass) {
-                        realInfo = info;
-                        session.removeAll(info);
-                    }
+            if (!windowRole.isEmpty()) {
+                if (info->windowRole == windowRole) {
+                    realInfo = info;
+                    break;
+                }
+            } else {
+                if (info->windowRole.isEmpty()
+                    && info->resourceName == resourceName
+                    && info->resourceClass == resourceClass) {
+                    realInfo = info;
+                    break;
                 }
             }
         }
     } else {
         // look for a sessioninfo with matching features.
-        for (SessionInfo *info : std::as_const(session)) {
-            if (realInfo) {
-                break;
-            }
-            if (info->resourceName == resourceName
-                && info->resourceClass == resourceClass
-                && sessionInfoWindowTypeMatch(c, info)) {
+        const QList<SessionInfo *> candidates = m_windowClassIndex.value(windowClassKey(resourceName, resourceClass));
+        for (SessionInfo *info : candidates) {
+            if (sessionInfoWindowTypeMatch(c, info)) {
                 if (wmCommand.isEmpty() || info->wmCommand == wmCommand) {
                     realInfo = info;
-                    session.removeAll(info);
+                    break;
                 }
             }
         }
     }
+
+    if (realInfo) {
+        removeSessionInfo(realInfo);
+        if (m_restoring) {
+            if (session.isEmpty()) {
+                finishRestore();
+            } else {
+                m_restoreTimer->start();
+            }
+        }
+    }
     return realInfo;
 }
 
 SessionManager::SessionManager(QObject *parent)
     : QObject(parent)
+    , m_restoreTimer(new QTimer(this))
+    , m_restoreDeadlineTimer(new QTimer(this))
 {
+    m_restoreTimer->setSingleShot(true);
+    m_restoreTimer->setInterval(250);
+    connect(m_restoreTimer, &QTimer::timeout, this, &SessionManager::finishRestore);
+
+    m_restoreDeadlineTimer->setSingleShot(true);
+    m_restoreDeadlineTimer->setInterval(2000);
+    connect(m_restoreDeadlineTimer, &QTimer::timeout, this, &SessionManager::finishRestore);
+
     new SessionAdaptor(this);
     QDBusConnection::sessionBus().registerObject(QStringLiteral("/Session"), this);
 }
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <QDataStream>
+#include <QHash>
 #include <QRect>
 #include <QStringList>
 
@@ -19,6 +20,8 @@
 #include "libkwineffects/kwinglobals.h"
 #include <netwm_def.h>
 
+class QTimer;
+
 namespace KWin
 {
 
@@ -66,6 +69,10 @@ private:
     void storeClient(KConfigGroup &cg, int num, X11Window *c);
     void loadSessionInfo(const QString &sessionName);
     void addSessionInfo(KConfigGroup &cg);
+    void removeSessionInfo(SessionInfo *info);
+
+    void startRestore();
+    void finishRestore();
 
     SessionState m_sessionState = SessionState::Normal;
 
@@ -73,6 +80,17 @@ private:
     int m_sessionDesktop;
 
     QList<SessionInfo *> session;
+    // the entries of the session by their session id and by their window class, in the order
+    // of the session, so a window is matched without walking the whole session
+    QHash<QByteArray, QList<SessionInfo *>> m_sessionIdIndex;
+    QHash<QString, QList<SessionInfo *>> m_windowClassIndex;
+
+    // while the windows of a session are being restored, stacking order updates are held back
+    // and propagated once, when no restored window has shown up for a while or the deadline
+    // has passed
+    QTimer *m_restoreTimer;
+    QTimer *m_restoreDeadlineTimer;
+    bool m_restoring = false;
 };
 
 struct SessionInfo
@@ -14,6 +14,7 @@
 #include <KLocalizedString>
 
 #include <QIcon>
+#include <QSet>
 #include <QUuid>
 
 #include <cmath>
@@ -235,9 +236,32 @@ void ClientModel::createClientList(bool partialReset)
         return;
     }
 
-    beginResetModel();
-    m_clientList = m_mutableClientList;
-    endResetModel();
+    // the rows are moved instead of resetting the model so the views keep their delegates,
+    // creating them again for every window is what makes the switcher slow to show up
+    const QSet<Window *> clients(m_mutableClientList.cbegin(), m_mutableClientList.cend());
+    for (int i = m_clientList.count() - 1; i >= 0; --i) {
+        if (!clients.contains(m_clientList[i])) {
+            beginRemoveRows(QModelIndex(), i, i);
+            m_clientList.removeAt(i);
+            endRemoveRows();
+        }
+    }
+    for (int i = 0; i < m_mutableClientList.count(); ++i) {
+        Window *client = m_mutableClientList[i];
+        if (i < m_clientList.count() && m_clientList[i] == client) {
+            continue;
+        }
+        const int from = m_clientList.indexOf(client, i);
+        if (from == -1) {
+            beginInsertRows(QModelIndex(), i, i);
+            m_clientList.insert(i, client);
+            endInsertRows();
+        } else {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+            m_clientList.move(from, i);
+            endMoveRows();
+        }
+    }
 }
 
 void ClientModel::close(int i)
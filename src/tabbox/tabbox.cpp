@@ -511,6 +511,7 @@ void TabBox::reconfigure()
     m_alternativeCurrentApplicationConfig.setClientApplicationsMode(TabBoxConfig::AllWindowsCurrentApplication);
 
     m_tabBox->setConfig(m_defaultConfig);
+    QTimer::singleShot(0, m_tabBox, &TabBoxHandler::preload);
 
     m_delayShowTime = config.readEntry<int>("DelayTime", 90);
 
@@ -54,6 +54,10 @@ public:
     void endHighlightWindows(bool abort = false);
 
     void show();
+    /**
+     * Returns the switcher item of the current layout, it's created if it doesn't exist yet.
+     */
+    QObject *loadSwitcherItem();
     QQuickWindow *window() const;
     SwitcherItem *switcherItem() const;
 
@@ -281,9 +285,9 @@ QObject *TabBoxHandlerPrivate::createSwitcherItem()
 }
 #endif
 
-void TabBoxHandlerPrivate::show()
-{
 #ifndef KWIN_UNIT_TEST
+QObject *TabBoxHandlerPrivate::loadSwitcherItem()
+{
     if (!m_qmlContext) {
         qmlRegisterType<SwitcherItem>("org.kde.kwin", 3, 0, "TabBoxSwitcher");
         m_qmlContext.reset(new QQmlContext(Scripting::self()->qmlEngine()));
@@ -298,13 +302,19 @@ void TabBoxHandlerPrivate::show()
         }
         return nullptr;
     };
-    m_mainItem = nullptr;
-    m_mainItem = findMainItem(m_clientTabBoxes);
+    if (QObject *item = findMainItem(m_clientTabBoxes)) {
+        return item;
+    }
+    return createSwitcherItem();
+}
+#endif
+
+void TabBoxHandlerPrivate::show()
+{
+#ifndef KWIN_UNIT_TEST
+    m_mainItem = loadSwitcherItem();
     if (!m_mainItem) {
-        m_mainItem = createSwitcherItem();
-        if (!m_mainItem) {
-            return;
-        }
+        return;
     }
     if (SwitcherItem *item = switcherItem()) {
         // In case the model isn't yet set (see below), index will be reset and therefore we
@@ -372,6 +382,23 @@ void TabBoxHandler::show()
     }
 }
 
+void TabBoxHandler::preload()
+{
+#ifndef KWIN_UNIT_TEST
+    if (d->isShown || !d->config.isShowTabBox()) {
+        return;
+    }
+    // the switcher stays hidden until show() is called, but its delegates are created already
+    d->m_mainItem = d->loadSwitcherItem();
+    if (SwitcherItem *item = d->switcherItem()) {
+        if (!item->model()) {
+            item->setModel(d->clientModel());
+        }
+    }
+    d->m_mainItem = nullptr;
+#endif
+}
+
 void TabBoxHandler::initHighlightWindows()
 {
     if (isKWinCompositing()) {
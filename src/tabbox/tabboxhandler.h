@@ -204,6 +204,11 @@ public:
      * @see show
      */
     void hide(bool abort = false);
+    /**
+     * Creates the switcher of the current layout ahead of time, so showing it later doesn't
+     * have to load the QML component.
+     */
+    void preload();
 
     /**
      * Sets the current model index in the view and updates
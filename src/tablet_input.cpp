@@ -85,8 +85,8 @@ void TabletInputRedirection::tabletToolEvent(KWin::InputRedirection::TabletEvent
 
     ev.setTimestamp(std::chrono::duration_cast<std::chrono::milliseconds>(time).count());
     input()->processSpies(std::bind(&InputEventSpy::tabletToolEvent, std::placeholders::_1, &ev));
-    input()->processFilters(
-        std::bind(&InputEventFilter::tabletToolEvent, std::placeholders::_1, &ev));
+    input()->processFilters(InputEventFilter::TabletToolEvents,
+                            std::bind(&InputEventFilter::tabletToolEvent, std::placeholders::_1, &ev));
 
     m_tipDown = tipDown;
     m_tipNear = tipNear;
@@ -97,7 +97,8 @@ void KWin::TabletInputRedirection::tabletToolButtonEvent(uint button, bool isPre
 {
     input()->processSpies(std::bind(&InputEventSpy::tabletToolButtonEvent,
                                     std::placeholders::_1, button, isPressed, tabletToolId, time));
-    input()->processFilters(std::bind(&InputEventFilter::tabletToolButtonEvent,
+    input()->processFilters(InputEventFilter::TabletToolEvents,
+                            std::bind(&InputEventFilter::tabletToolButtonEvent,
                                       std::placeholders::_1, button, isPressed, tabletToolId, time));
     input()->setLastInputHandler(this);
 }
@@ -107,7 +108,8 @@ void KWin::TabletInputRedirection::tabletPadButtonEvent(uint button, bool isPres
 {
     input()->processSpies(std::bind(&InputEventSpy::tabletPadButtonEvent,
                                     std::placeholders::_1, button, isPressed, tabletPadId, time));
-    input()->processFilters(std::bind(&InputEventFilter::tabletPadButtonEvent,
+    input()->processFilters(InputEventFilter::TabletPadEvents,
+                            std::bind(&InputEventFilter::tabletPadButtonEvent,
                                       std::placeholders::_1, button, isPressed, tabletPadId, time));
     input()->setLastInputHandler(this);
 }
@@ -117,7 +119,8 @@ void KWin::TabletInputRedirection::tabletPadStripEvent(int number, int position,
 {
     input()->processSpies(std::bind(&InputEventSpy::tabletPadStripEvent,
                                     std::placeholders::_1, number, position, isFinger, tabletPadId, time));
-    input()->processFilters(std::bind(&InputEventFilter::tabletPadStripEvent,
+    input()->processFilters(InputEventFilter::TabletPadEvents,
+                            std::bind(&InputEventFilter::tabletPadStripEvent,
                                       std::placeholders::_1, number, position, isFinger, tabletPadId, time));
     input()->setLastInputHandler(this);
 }
@@ -127,7 +130,8 @@ void KWin::TabletInputRedirection::tabletPadRingEvent(int number, int position,
 {
     input()->processSpies(std::bind(&InputEventSpy::tabletPadRingEvent,
                                     std::placeholders::_1, number, position, isFinger, tabletPadId, time));
-    input()->processFilters(std::bind(&InputEventFilter::tabletPadRingEvent,
+    input()->processFilters(InputEventFilter::TabletPadEvents,
+                            std::bind(&InputEventFilter::tabletPadRingEvent,
                                       std::placeholders::_1, number, position, isFinger, tabletPadId, time));
     input()->setLastInputHandler(this);
 }
@@ -63,6 +63,8 @@ void CustomTile::setRelativeGeometry(const QRectF &geom)
 
     auto *parentT = static_cast<CustomTile *>(parentTile());
 
+    manager()->blockGeometryUpdates(true);
+
     if (!m_geometryLock && parentT && parentT->layoutDirection() != LayoutDirection::Floating) {
         m_geometryLock = true;
         if (finalGeom.left() != relativeGeometry().left()) {
@@ -160,6 +162,8 @@ void CustomTile::setRelativeGeometry(const QRectF &geom)
         Q_EMIT parentT->layoutModified();
     }
     m_geometryLock = false;
+
+    manager()->blockGeometryUpdates(false);
 }
 
 bool CustomTile::supportsResizeGravity(KWin::Gravity gravity)
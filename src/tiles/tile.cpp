@@ -41,6 +41,7 @@ Tile::~Tile()
     if (m_parentTile) {
         m_parentTile->removeChild(this);
     }
+    m_tiling->m_pendingWindowGeometryUpdates.removeOne(this);
     for (auto *w : std::as_const(m_windows)) {
         Tile *tile = m_tiling->bestTileForPosition(w->moveResizeGeometry().center());
         w->setTile(tile);
@@ -108,8 +109,17 @@ void Tile::setRelativeGeometry(const QRectF &geom)
     Q_EMIT absoluteGeometryChanged();
     Q_EMIT windowGeometryChanged();
 
+    m_tiling->scheduleWindowGeometryUpdate(this);
+}
+
+void Tile::updateWindowGeometries()
+{
+    if (m_windows.isEmpty()) {
+        return;
+    }
+    const QRectF geometry = windowGeometry();
     for (auto *w : std::as_const(m_windows)) {
-        w->moveResize(windowGeometry());
+        w->moveResize(geometry);
     }
 }
 
@@ -174,12 +184,12 @@ void Tile::setPadding(qreal padding)
 
     m_padding = padding;
 
+    m_tiling->blockGeometryUpdates(true);
     for (auto *t : std::as_const(m_children)) {
         t->setPadding(padding);
     }
-    for (auto *w : std::as_const(m_windows)) {
-        w->moveResize(windowGeometry());
-    }
+    m_tiling->scheduleWindowGeometryUpdate(this);
+    m_tiling->blockGeometryUpdates(false);
 
     Q_EMIT paddingChanged(padding);
     Q_EMIT windowGeometryChanged();
@@ -152,6 +152,9 @@ protected:
     void removeChild(Tile *child);
 
 private:
+    void updateWindowGeometries();
+    friend class TileManager;
+
     QList<Tile *> m_children;
     QList<Window *> m_windows;
     Tile *m_parentTile;
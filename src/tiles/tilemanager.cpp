@@ -77,6 +77,30 @@ TileManager::~TileManager()
 {
 }
 
+void TileManager::blockGeometryUpdates(bool block)
+{
+    if (block) {
+        ++m_blockGeometryUpdates;
+        return;
+    }
+    Q_ASSERT(m_blockGeometryUpdates > 0);
+    if (--m_blockGeometryUpdates == 0) {
+        const QList<Tile *> tiles = std::exchange(m_pendingWindowGeometryUpdates, {});
+        for (Tile *tile : tiles) {
+            tile->updateWindowGeometries();
+        }
+    }
+}
+
+void TileManager::scheduleWindowGeometryUpdate(Tile *tile)
+{
+    if (m_blockGeometryUpdates == 0) {
+        tile->updateWindowGeometries();
+    } else if (!m_pendingWindowGeometryUpdates.contains(tile)) {
+        m_pendingWindowGeometryUpdates.append(tile);
+    }
+}
+
 Output *TileManager::output() const
 {
     return m_output;
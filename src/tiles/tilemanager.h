@@ -62,14 +62,25 @@ private:
     QJsonObject tileToJSon(CustomTile *parentTile);
     CustomTile *parseTilingJSon(const QJsonValue &val, const QRectF &availableArea, CustomTile *parentTile);
 
+    /**
+     * While geometry updates are blocked, the windows of the tiles whose geometry changes
+     * are only moved once the outermost block is released. Resizing a tile resizes its
+     * neighbours and children recursively, a tile can change several times in the process.
+     */
+    void blockGeometryUpdates(bool block);
+    void scheduleWindowGeometryUpdate(Tile *tile);
+
     Q_DISABLE_COPY(TileManager)
 
     Output *m_output = nullptr;
+    int m_blockGeometryUpdates = 0;
+    QList<Tile *> m_pendingWindowGeometryUpdates;
     std::unique_ptr<QTimer> m_saveTimer;
     std::unique_ptr<CustomTile> m_rootTile = nullptr;
     std::unique_ptr<QuickRootTile> m_quickRootTile = nullptr;
     std::unique_ptr<TileModel> m_tileModel = nullptr;
     friend class CustomTile;
+    friend class Tile;
 };
 
 KWIN_EXPORT QDebug operator<<(QDebug debug, const TileManager *tileManager);
@@ -273,6 +273,31 @@ QRectF gravitateGeometry(const QRectF &rect, const QRectF &bounds, Gravity gravi
     return geometry;
 }
 
+// beyond this, the cost of processing the rectangles outweighs the pixels they spare
+static const int s_maxDamageRects = 32;
+
+QRegion simplifyDamage(const QRegion &region)
+{
+    const int rectCount = region.rectCount();
+    if (rectCount <= 1) {
+        return region;
+    }
+    const QRect bounds = region.boundingRect();
+    if (rectCount > s_maxDamageRects) {
+        return bounds;
+    }
+
+    qint64 area = 0;
+    for (const QRect &rect : region) {
+        area += qint64(rect.width()) * rect.height();
+    }
+    // the bounding rectangle wastes less than a quarter of its area
+    if (qint64(bounds.width()) * bounds.height() * 3 <= area * 4) {
+        return bounds;
+    }
+    return region;
+}
+
 } // namespace
 
 #ifndef KCMRULES
@@ -125,6 +125,13 @@ Qt::KeyboardModifiers KWIN_EXPORT x11ToQtKeyboardModifiers(int state);
 KWIN_EXPORT QPointF popupOffset(const QRectF &anchorRect, const Qt::Edges anchorEdge, const Qt::Edges gravity, const QSizeF popupSize);
 KWIN_EXPORT QRectF gravitateGeometry(const QRectF &rect, const QRectF &bounds, Gravity gravity);
 
+/**
+ * Returns a simplified version of the damage @a region that covers at least the same area.
+ * Regions made of many rectangles, or that barely cover less than their bounding rectangle,
+ * are replaced with the bounding rectangle, which is a lot cheaper to process further.
+ */
+KWIN_EXPORT QRegion simplifyDamage(const QRegion &region);
+
 } // namespace
 
 // Must be outside namespace
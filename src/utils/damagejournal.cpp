@@ -0,0 +1,118 @@
+/*
+    SPDX-FileCopyrightText: 2022 Vlad Zahorodnii <vlad.zahorodnii@kde.org>
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utils/damagejournal.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+DamageJournal::DamageJournal()
+    : m_log(10)
+{
+}
+
+int DamageJournal::capacity() const
+{
+    return m_log.size();
+}
+
+void DamageJournal::setCapacity(int capacity)
+{
+    capacity = std::max(capacity, 1);
+    if (capacity == int(m_log.size())) {
+        return;
+    }
+
+    std::vector<QRegion> log(capacity);
+    const int count = std::min(m_count, capacity);
+    for (int i = 0; i < count; ++i) {
+        log[i] = at(i);
+    }
+    m_log = std::move(log);
+    m_head = 0;
+    m_count = count;
+
+    // the oldest buffer that can be asked for is as old as the journal
+    if (int(m_unions.size()) > capacity - 2) {
+        m_unions.resize(std::max(capacity - 2, 0));
+    }
+}
+
+const QRegion &DamageJournal::at(int index) const
+{
+    return m_log[(m_head + index) % m_log.size()];
+}
+
+QRegion DamageJournal::simplified(const QRegion &region)
+{
+    if (region.rectCount() > maximumRectCount()) {
+        return region.boundingRect();
+    }
+    return region;
+}
+
+void DamageJournal::add(const QRegion &region)
+{
+    // the unions are shifted by one region, the oldest one falls off if the journal is full
+    const int unionCount = std::min<int>(m_unions.size(), m_count);
+    for (int i = unionCount - 1; i > 0; --i) {
+        m_unions[i] = simplified(m_unions[i - 1] | region);
+    }
+    if (unionCount > 0) {
+        m_unions[0] = simplified(at(0) | region);
+    }
+    for (int i = unionCount; i < int(m_unions.size()); ++i) {
+        m_unions[i] = QRegion();
+    }
+
+    m_head = (m_head + m_log.size() - 1) % m_log.size();
+    m_log[m_head] = region;
+    m_count = std::min<int>(m_count + 1, m_log.size());
+}
+
+void DamageJournal::clear()
+{
+    for (QRegion &region : m_log) {
+        region = QRegion();
+    }
+    m_head = 0;
+    m_count = 0;
+}
+
+QRegion DamageJournal::accumulate(int bufferAge, const QRegion &fallback) const
+{
+    if (bufferAge <= 0 || bufferAge > m_count) {
+        return fallback;
+    }
+    if (bufferAge == 1) {
+        return QRegion();
+    }
+    if (bufferAge == 2) {
+        return at(0);
+    }
+
+    // this is the first time the journal is asked about such an old buffer, from now on
+    // the union is kept up to date when regions are added
+    const int index = bufferAge - 3;
+    if (index >= int(m_unions.size())) {
+        const int first = m_unions.size();
+        m_unions.resize(index + 1);
+        for (int i = first; i <= index; ++i) {
+            m_unions[i] = simplified((i ? m_unions[i - 1] : at(0)) | at(i + 1));
+        }
+    }
+    return m_unions[index];
+}
+
+QRegion DamageJournal::lastDamage() const
+{
+    return m_count ? at(0) : QRegion();
+}
+
+} // namespace KWin
@@ -8,54 +8,56 @@
 
 #include "kwin_export.h"
 
-#include <QList>
 #include <QRegion>
 
+#include <vector>
+
 namespace KWin
 {
 
 /**
  * The DamageJournal class is a helper that tracks last N damage regions.
+ *
+ * The regions are kept in a ring buffer. Besides that, the journal keeps the unions of the
+ * most recent regions up to the oldest buffer age that has been asked for, and updates them
+ * as regions are added, so accumulate() doesn't need to unite the regions again every frame.
+ * If a union consists of more than maximumRectCount() rects, it's replaced by its bounding
+ * rect; repainting a bit more is cheaper than dealing with very fragmented regions.
  */
 class KWIN_EXPORT DamageJournal
 {
 public:
+    DamageJournal();
+
     /**
      * Returns the maximum number of damage regions that can be stored in the journal.
      */
-    int capacity() const
-    {
-        return m_capacity;
-    }
+    int capacity() const;
 
     /**
      * Sets the maximum number of damage regions that can be stored in the journal
      * to @a capacity.
      */
-    void setCapacity(int capacity)
+    void setCapacity(int capacity);
+
+    /**
+     * Returns the maximum number of rects in an accumulated damage region.
+     */
+    static constexpr int maximumRectCount()
     {
-        m_capacity = capacity;
+        return 32;
     }
 
     /**
      * Adds the specified @a region to the journal.
      */
-    void add(const QRegion &region)
-    {
-        while (m_log.size() >= m_capacity) {
-            m_log.takeLast();
-        }
-        m_log.prepend(region);
-    }
+    void add(const QRegion &region);
 
     /**
      * Clears the damage journal. Typically, one would want to clear the damage journal
      * if a buffer swap fails for some reason.
      */
-    void clear()
-    {
-        m_log.clear();
-    }
+    void clear();
 
     /**
      * Accumulates the damage regions in the log up to the specified @a bufferAge.
@@ -63,27 +65,20 @@ public:
      * If the specified buffer age value refers to a damage region older than the last
      * one in the journal, @a fallback will be returned.
      */
-    QRegion accumulate(int bufferAge, const QRegion &fallback = QRegion()) const
-    {
-        QRegion region;
-        if (bufferAge > 0 && bufferAge <= m_log.size()) {
-            for (int i = 0; i < bufferAge - 1; ++i) {
-                region |= m_log[i];
-            }
-        } else {
-            region = fallback;
-        }
-        return region;
-    }
+    QRegion accumulate(int bufferAge, const QRegion &fallback = QRegion()) const;
 
-    QRegion lastDamage() const
-    {
-        return m_log.first();
-    }
+    QRegion lastDamage() const;
 
 private:
-    QList<QRegion> m_log;
-    int m_capacity = 10;
+    const QRegion &at(int index) const;
+    static QRegion simplified(const QRegion &region);
+
+    // the regions, the most recent one is at m_head
+    std::vector<QRegion> m_log;
+    int m_head = 0;
+    int m_count = 0;
+    // m_unions[i] contains the union of the i + 2 most recent regions
+    mutable std::vector<QRegion> m_unions;
 };
 
 } // namespace KWin
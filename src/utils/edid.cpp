@@ -134,6 +134,28 @@ static QByteArray parseSerialNumber(const uint8_t *data)
     return QByteArray();
 }
 
+static std::pair<int, int> parseRefreshRateRange(const uint8_t *data)
+{
+    for (int i = 72; i <= 108; i += 18) {
+        // Skip the block if it isn't used as monitor descriptor.
+        if (data[i]) {
+            continue;
+        }
+        if (data[i + 1]) {
+            continue;
+        }
+
+        // We have found the display range limits, the offset flags add 255 Hz to the rates.
+        if (data[i + 3] == 0xfd) {
+            const int minimum = data[i + 5] + ((data[i + 4] & 0x1) ? 255 : 0);
+            const int maximum = data[i + 6] + ((data[i + 4] & 0x2) ? 255 : 0);
+            return std::make_pair(minimum, maximum);
+        }
+    }
+
+    return std::make_pair(0, 0);
+}
+
 static QByteArray parseVendor(const uint8_t *data)
 {
     const auto pnpId = parsePnpId(data);
@@ -176,6 +198,7 @@ Edid::Edid(const void *data, uint32_t size)
     m_monitorName = parseMonitorName(bytes);
     m_serialNumber = parseSerialNumber(bytes);
     m_vendor = parseVendor(bytes);
+    std::tie(m_minimumRefreshRate, m_maximumRefreshRate) = parseRefreshRateRange(bytes);
     QCryptographicHash hash(QCryptographicHash::Md5);
     hash.addData(m_raw);
     m_hash = QString::fromLatin1(hash.result().toHex());
@@ -250,4 +273,14 @@ QString Edid::hash() const
     return m_hash;
 }
 
+int Edid::minimumRefreshRate() const
+{
+    return m_minimumRefreshRate;
+}
+
+int Edid::maximumRefreshRate() const
+{
+    return m_maximumRefreshRate;
+}
+
 } // namespace KWin
@@ -76,6 +76,13 @@ public:
 
     QString hash() const;
 
+    /**
+     * Returns the lowest and the highest vertical refresh rate of the monitor in Hz, from the
+     * display range limits descriptor, or @c 0 if the monitor doesn't specify them.
+     */
+    int minimumRefreshRate() const;
+    int maximumRefreshRate() const;
+
 private:
     QSize m_physicalSize;
     QByteArray m_vendor;
@@ -83,6 +90,8 @@ private:
     QByteArray m_monitorName;
     QByteArray m_serialNumber;
     QString m_hash;
+    int m_minimumRefreshRate = 0;
+    int m_maximumRefreshRate = 0;
 
     QByteArray m_raw;
     bool m_isValid = false;
@@ -0,0 +1,104 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "utils/precisetimer.h"
+#include "utils/common.h"
+
+#include <config-kwin.h>
+
+#include <QSocketNotifier>
+
+#if HAVE_TIMERFD
+#include <cerrno>
+#include <cstring>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+namespace KWin
+{
+
+PreciseTimer::PreciseTimer(QObject *parent)
+    : QObject(parent)
+{
+#if HAVE_TIMERFD
+    m_fd = FileDescriptor(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK));
+    if (m_fd.isValid()) {
+        m_notifier = std::make_unique<QSocketNotifier>(m_fd.get(), QSocketNotifier::Read);
+        connect(m_notifier.get(), &QSocketNotifier::activated, this, [this]() {
+            uint64_t expirations;
+            if (read(m_fd.get(), &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                // The timer has been re-armed or stopped in the meanwhile.
+                return;
+            }
+            handleTimeout();
+        });
+        return;
+    }
+    qCWarning(KWIN_CORE) << "Failed to create a timerfd, falling back to QTimer:" << strerror(errno);
+#endif
+
+    m_fallbackTimer.setSingleShot(true);
+    m_fallbackTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_fallbackTimer, &QTimer::timeout, this, &PreciseTimer::handleTimeout);
+}
+
+PreciseTimer::~PreciseTimer()
+{
+}
+
+bool PreciseTimer::isActive() const
+{
+    return m_active;
+}
+
+void PreciseTimer::start(std::chrono::nanoseconds interval)
+{
+    m_active = true;
+
+#if HAVE_TIMERFD
+    if (m_notifier) {
+        // A zero it_value would disarm the timer.
+        const std::chrono::nanoseconds timeout = std::max(interval, std::chrono::nanoseconds(1));
+        const std::chrono::seconds seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+
+        itimerspec spec{};
+        spec.it_value.tv_sec = seconds.count();
+        spec.it_value.tv_nsec = (timeout - seconds).count();
+        if (timerfd_settime(m_fd.get(), 0, &spec, nullptr) == 0) {
+            return;
+        }
+        qCWarning(KWIN_CORE) << "timerfd_settime() failed:" << strerror(errno);
+    }
+#endif
+
+    m_fallbackTimer.start(std::chrono::duration_cast<std::chrono::milliseconds>(interval));
+}
+
+void PreciseTimer::stop()
+{
+    m_active = false;
+
+#if HAVE_TIMERFD
+    if (m_notifier) {
+        const itimerspec spec{};
+        timerfd_settime(m_fd.get(), 0, &spec, nullptr);
+    }
+#endif
+
+    m_fallbackTimer.stop();
+}
+
+void PreciseTimer::handleTimeout()
+{
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+    Q_EMIT timeout();
+}
+
+} // namespace KWin
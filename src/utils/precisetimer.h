@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "utils/filedescriptor.h"
+
+#include <QObject>
+#include <QTimer>
+
+#include <chrono>
+#include <memory>
+
+class QSocketNotifier;
+
+namespace KWin
+{
+
+/**
+ * The PreciseTimer class provides a single-shot timer with nanosecond resolution.
+ *
+ * Unlike QTimer, which rounds the interval to milliseconds, the PreciseTimer is backed by
+ * a timerfd on the monotonic clock. If timerfd is unavailable, the PreciseTimer falls back
+ * to a QTimer with Qt::PreciseTimer type.
+ */
+class KWIN_EXPORT PreciseTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PreciseTimer(QObject *parent = nullptr);
+    ~PreciseTimer() override;
+
+    /**
+     * Returns @c true if the timer is running; otherwise returns @c false.
+     */
+    bool isActive() const;
+
+    /**
+     * Starts or restarts the timer. The timeout() signal will be emitted once
+     * @a interval has elapsed.
+     */
+    void start(std::chrono::nanoseconds interval);
+
+    /**
+     * Stops the timer.
+     */
+    void stop();
+
+Q_SIGNALS:
+    void timeout();
+
+private:
+    void handleTimeout();
+
+    FileDescriptor m_fd;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    QTimer m_fallbackTimer;
+    bool m_active = false;
+};
+
+} // namespace KWin
@@ -0,0 +1,88 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+namespace KWin
+{
+
+/**
+ * The SpscQueue class is an unbounded lock-free queue with a single producer and a single
+ * consumer thread.
+ *
+ * push() may only be called by the producer, front() and pop() only by the consumer.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+    SpscQueue()
+        : m_head(new Node)
+        , m_tail(m_head)
+    {
+    }
+
+    ~SpscQueue()
+    {
+        while (m_head) {
+            Node *next = m_head->next.load(std::memory_order_relaxed);
+            delete m_head;
+            m_head = next;
+        }
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    void push(T &&value)
+    {
+        Node *node = new Node;
+        node->value.emplace(std::move(value));
+        m_tail->next.store(node, std::memory_order_release);
+        m_tail = node;
+    }
+
+    /**
+     * Returns the next value in the queue without removing it, or @c null if the queue is empty.
+     */
+    T *front() const
+    {
+        Node *next = m_head->next.load(std::memory_order_acquire);
+        return next ? &*next->value : nullptr;
+    }
+
+    std::optional<T> pop()
+    {
+        Node *next = m_head->next.load(std::memory_order_acquire);
+        if (!next) {
+            return std::nullopt;
+        }
+        std::optional<T> value = std::move(next->value);
+        next->value.reset();
+        // the consumed node becomes the new sentinel
+        delete m_head;
+        m_head = next;
+        return value;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node *> next = nullptr;
+        std::optional<T> value;
+    };
+
+    // owned by the consumer, the values follow the sentinel node
+    Node *m_head;
+    // owned by the producer
+    Node *m_tail;
+};
+
+} // namespace KWin
@@ -9,9 +9,6 @@
 
 #include "subsurfacemonitor.h"
 
-#include "wayland/subcompositor_interface.h"
-#include "wayland/surface_interface.h"
-
 using namespace KWaylandServer;
 
 namespace KWin
@@ -20,70 +17,36 @@ namespace KWin
 SubSurfaceMonitor::SubSurfaceMonitor(SurfaceInterface *surface, QObject *parent)
     : QObject(parent)
 {
-    registerSurface(surface);
-}
-
-void SubSurfaceMonitor::registerSubSurface(SubSurfaceInterface *subSurface)
-{
-    SurfaceInterface *surface = subSurface->surface();
-
-    connect(subSurface, &SubSurfaceInterface::positionChanged,
-            this, &SubSurfaceMonitor::subSurfaceMoved);
-    connect(surface, &SurfaceInterface::sizeChanged,
-            this, &SubSurfaceMonitor::subSurfaceResized);
-    connect(surface, &SurfaceInterface::mapped,
-            this, &SubSurfaceMonitor::subSurfaceMapped);
-    connect(surface, &SurfaceInterface::unmapped,
-            this, &SubSurfaceMonitor::subSurfaceUnmapped);
-    connect(surface, &SurfaceInterface::surfaceToBufferMatrixChanged,
-            this, &SubSurfaceMonitor::subSurfaceSurfaceToBufferMatrixChanged);
-    connect(surface, &SurfaceInterface::bufferSizeChanged,
-            this, &SubSurfaceMonitor::subSurfaceBufferSizeChanged);
-    connect(surface, &SurfaceInterface::committed,
-            this, [this, subSurface]() {
-                Q_EMIT subSurfaceCommitted(subSurface);
-            });
-
-    registerSurface(surface);
+    connect(surface, &SurfaceInterface::subSurfaceTreeChanged,
+            this, &SubSurfaceMonitor::handleTreeChanged);
 }
 
-void SubSurfaceMonitor::unregisterSubSurface(SubSurfaceInterface *subSurface)
+void SubSurfaceMonitor::handleTreeChanged(SubSurfaceTreeChanges changes)
 {
-    SurfaceInterface *surface = subSurface->surface();
-    if (!surface) {
-        return;
+    if (changes & SubSurfaceTreeChange::Added) {
+        Q_EMIT subSurfaceAdded();
     }
-
-    disconnect(subSurface, nullptr, this, nullptr);
-
-    unregisterSurface(surface);
-}
-
-void SubSurfaceMonitor::registerSurface(SurfaceInterface *surface)
-{
-    connect(surface, &SurfaceInterface::childSubSurfaceAdded,
-            this, &SubSurfaceMonitor::subSurfaceAdded);
-    connect(surface, &SurfaceInterface::childSubSurfaceRemoved,
-            this, &SubSurfaceMonitor::subSurfaceRemoved);
-    connect(surface, &SurfaceInterface::childSubSurfaceAdded,
-            this, &SubSurfaceMonitor::registerSubSurface);
-    connect(surface, &SurfaceInterface::childSubSurfaceRemoved,
-            this, &SubSurfaceMonitor::unregisterSubSurface);
-
-    const QList<SubSurfaceInterface *> below = surface->below();
-    for (SubSurfaceInterface *childSubSurface : below) {
-        registerSubSurface(childSubSurface);
+    if (changes & SubSurfaceTreeChange::Removed) {
+        Q_EMIT subSurfaceRemoved();
     }
-
-    const QList<SubSurfaceInterface *> above = surface->above();
-    for (SubSurfaceInterface *childSubSurface : above) {
-        registerSubSurface(childSubSurface);
+    if (changes & SubSurfaceTreeChange::Moved) {
+        Q_EMIT subSurfaceMoved();
+    }
+    if (changes & SubSurfaceTreeChange::Resized) {
+        Q_EMIT subSurfaceResized();
+    }
+    if (changes & SubSurfaceTreeChange::Mapped) {
+        Q_EMIT subSurfaceMapped();
+    }
+    if (changes & SubSurfaceTreeChange::Unmapped) {
+        Q_EMIT subSurfaceUnmapped();
+    }
+    if (changes & SubSurfaceTreeChange::SurfaceToBufferMatrixChanged) {
+        Q_EMIT subSurfaceSurfaceToBufferMatrixChanged();
+    }
+    if (changes & SubSurfaceTreeChange::BufferSizeChanged) {
+        Q_EMIT subSurfaceBufferSizeChanged();
     }
-}
-
-void SubSurfaceMonitor::unregisterSurface(SurfaceInterface *surface)
-{
-    disconnect(surface, nullptr, this, nullptr);
 }
 
 } // namespace KWin
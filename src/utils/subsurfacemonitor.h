@@ -9,13 +9,9 @@
 
 #pragma once
 
-#include <QObject>
+#include "wayland/surface_interface.h"
 
-namespace KWaylandServer
-{
-class SurfaceInterface;
-class SubSurfaceInterface;
-}
+#include <QObject>
 
 namespace KWin
 {
@@ -23,6 +19,9 @@ namespace KWin
 /**
  * The SubSurfaceMonitor class provides a convenient way for monitoring changes in
  * sub-surface trees, e.g. addition or removal of sub-surfaces, etc.
+ *
+ * The changes are batched by the main surface of the tree, so the signals are emitted at most
+ * once per commit no matter how many sub-surfaces have changed.
  */
 class SubSurfaceMonitor : public QObject
 {
@@ -30,7 +29,7 @@ class SubSurfaceMonitor : public QObject
 
 public:
     /**
-     * Constructs a SubSurfaceTreeMonitor with the given @a surface and @a parent.
+     * Constructs a SubSurfaceTreeMonitor with the given main @a surface and @a parent.
      */
     SubSurfaceMonitor(KWaylandServer::SurfaceInterface *surface, QObject *parent);
 
@@ -68,13 +67,9 @@ Q_SIGNALS:
      * This signal is emitted when the buffer size of a subsurface has changed.
      */
     void subSurfaceBufferSizeChanged();
-    void subSurfaceCommitted(KWaylandServer::SubSurfaceInterface *subSurface);
 
 private:
-    void registerSubSurface(KWaylandServer::SubSurfaceInterface *subSurface);
-    void unregisterSubSurface(KWaylandServer::SubSurfaceInterface *subSurface);
-    void registerSurface(KWaylandServer::SurfaceInterface *surface);
-    void unregisterSurface(KWaylandServer::SurfaceInterface *surface);
+    void handleTreeChanged(KWaylandServer::SubSurfaceTreeChanges changes);
 };
 
 } // namespace KWin
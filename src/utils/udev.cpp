@@ -15,6 +15,9 @@
 #include <cerrno>
 #include <functional>
 #include <libudev.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace KWin
 {
@@ -280,4 +283,75 @@ UdevDevice::Ptr UdevMonitor::getDevice()
     return UdevDevice::Ptr(new UdevDevice(dev));
 }
 
+UdevMonitorThread::UdevMonitorThread(const QVector<QByteArray> &subsystems)
+    : m_udev(std::make_unique<Udev>())
+{
+    qRegisterMetaType<UdevDeviceEvent>();
+    // libudev objects must not be shared between threads, the worker gets its own context
+    if (!m_udev->isValid()) {
+        return;
+    }
+    m_monitor = m_udev->monitor();
+    if (!m_monitor || m_monitor->fd() == -1) {
+        m_monitor.reset();
+        return;
+    }
+    m_quitFd = FileDescriptor(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+    if (!m_quitFd.isValid()) {
+        m_monitor.reset();
+        return;
+    }
+    for (const QByteArray &subsystem : subsystems) {
+        m_monitor->filterSubsystemDevType(subsystem.constData());
+    }
+    m_monitor->enable();
+    m_thread = std::thread(&UdevMonitorThread::run, this);
+}
+
+UdevMonitorThread::~UdevMonitorThread()
+{
+    if (m_thread.joinable()) {
+        const uint64_t value = 1;
+        if (write(m_quitFd.get(), &value, sizeof(value)) != sizeof(value)) {
+            qCWarning(KWIN_CORE) << "Failed to stop the udev monitor thread:" << strerror(errno);
+        }
+        m_thread.join();
+    }
+}
+
+bool UdevMonitorThread::isValid() const
+{
+    return m_monitor != nullptr;
+}
+
+void UdevMonitorThread::run()
+{
+    pollfd fds[] = {
+        {m_monitor->fd(), POLLIN, 0},
+        {m_quitFd.get(), POLLIN, 0},
+    };
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            qCWarning(KWIN_CORE) << "Polling the udev monitor failed:" << strerror(errno);
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        while (const auto device = m_monitor->getDevice()) {
+            // the receivers live on another thread, so the signal is queued
+            Q_EMIT deviceEvent(UdevDeviceEvent{
+                .action = device->action(),
+                .devNode = device->devNode(),
+                .devNum = device->devNum(),
+                .seat = device->seat(),
+                .lease = qstrcmp(device->property("LEASE"), "1") == 0,
+            });
+        }
+    }
+}
+
 }
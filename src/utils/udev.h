@@ -10,7 +10,11 @@
 #include <kwin_export.h>
 #include <memory>
 
+#include "utils/filedescriptor.h"
+
+#include <QObject>
 #include <QVector>
+#include <thread>
 #include <vector>
 
 #include <sys/types.h>
@@ -72,6 +76,46 @@ private:
     udev_monitor *m_monitor;
 };
 
+/**
+ * The properties of a device from a udev event, read on the thread of the UdevMonitorThread
+ */
+struct UdevDeviceEvent
+{
+    QString action;
+    QString devNode;
+    dev_t devNum = 0;
+    QString seat;
+    // set for the change events of drm devices that are sent when a lease is created or revoked
+    bool lease = false;
+};
+
+/**
+ * The UdevMonitorThread class receives the udev events of the given subsystems on a worker
+ * thread, so that reading the devices' properties from sysfs never blocks the main thread.
+ * Only the ready to use device descriptors are posted to the thread of the receivers.
+ */
+class KWIN_EXPORT UdevMonitorThread : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UdevMonitorThread(const QVector<QByteArray> &subsystems);
+    ~UdevMonitorThread() override;
+
+    bool isValid() const;
+
+Q_SIGNALS:
+    void deviceEvent(const KWin::UdevDeviceEvent &event);
+
+private:
+    void run();
+
+    std::unique_ptr<Udev> m_udev;
+    std::unique_ptr<UdevMonitor> m_monitor;
+    FileDescriptor m_quitFd;
+    std::thread m_thread;
+};
+
 class KWIN_EXPORT Udev
 {
 public:
@@ -99,3 +143,5 @@ private:
 };
 
 }
+
+Q_DECLARE_METATYPE(KWin::UdevDeviceEvent)
@@ -18,6 +18,7 @@
 
 #include <xcb/composite.h>
 #include <xcb/randr.h>
+#include <xcb/shape.h>
 #include <xcb/xcb.h>
 
 #include <xcb/shm.h>
@@ -573,6 +574,7 @@ private:
 
 XCB_WRAPPER(WindowAttributes, xcb_get_window_attributes, xcb_window_t)
 XCB_WRAPPER(OverlayWindow, xcb_composite_get_overlay_window, xcb_window_t)
+XCB_WRAPPER(ShapeExtents, xcb_shape_query_extents, xcb_window_t)
 
 XCB_WRAPPER_DATA(GeometryData, xcb_get_geometry, xcb_drawable_t)
 class WindowGeometry : public Wrapper<GeometryData, xcb_window_t>
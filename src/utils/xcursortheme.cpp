@@ -17,6 +17,10 @@
 #include <QStack>
 #include <QStandardPaths>
 
+#include <map>
+#include <memory>
+#include <tuple>
+
 namespace KWin
 {
 
@@ -28,13 +32,19 @@ public:
     std::chrono::milliseconds delay;
 };
 
+using KXcursorSprites = std::shared_ptr<const QVector<KXcursorSprite>>;
+
 class KXcursorThemePrivate : public QSharedData
 {
 public:
-    void load(const QString &themeName, int size, qreal devicePixelRatio);
-    void loadCursors(const QString &packagePath, int size, qreal devicePixelRatio);
-
-    QHash<QByteArray, QVector<KXcursorSprite>> registry;
+    void load(const QString &themeName);
+    void discoverCursors(const QString &packagePath);
+    KXcursorSprites sprites(const QByteArray &shape) const;
+
+    int size = 0;
+    qreal devicePixelRatio = 1;
+    QHash<QByteArray, QString> files;
+    mutable QHash<QByteArray, KXcursorSprites> registry;
 };
 
 KXcursorSprite::KXcursorSprite()
@@ -106,36 +116,59 @@ static QVector<KXcursorSprite> loadCursor(const QString &filePath, int desiredSi
     return sprites;
 }
 
-void KXcursorThemePrivate::loadCursors(const QString &packagePath, int size, qreal devicePixelRatio)
+void KXcursorThemePrivate::discoverCursors(const QString &packagePath)
 {
+    // The cursors are only decoded when they're needed, aliases, which are usually symlinks,
+    // resolve to the same file, so they share the sprites
     const QDir dir(packagePath);
-    QFileInfoList entries = dir.entryInfoList(QDir::Files | QDir::NoDotAndDotDot);
-    std::partition(entries.begin(), entries.end(), [](const QFileInfo &fileInfo) {
-        return !fileInfo.isSymLink();
-    });
-
-    for (const QFileInfo &entry : std::as_const(entries)) {
+    const QFileInfoList entries = dir.entryInfoList(QDir::Files | QDir::NoDotAndDotDot);
+    for (const QFileInfo &entry : entries) {
         const QByteArray shape = QFile::encodeName(entry.fileName());
-        if (registry.contains(shape)) {
+        if (files.contains(shape)) {
             continue;
         }
-        if (entry.isSymLink()) {
-            const QFileInfo symLinkInfo(entry.symLinkTarget());
-            if (symLinkInfo.absolutePath() == entry.absolutePath()) {
-                const auto sprites = registry.value(QFile::encodeName(symLinkInfo.fileName()));
-                if (!sprites.isEmpty()) {
-                    registry.insert(shape, sprites);
-                    continue;
-                }
-            }
-        }
-        const QVector<KXcursorSprite> sprites = loadCursor(entry.absoluteFilePath(), size, devicePixelRatio);
-        if (!sprites.isEmpty()) {
-            registry.insert(shape, sprites);
+        const QString filePath = entry.canonicalFilePath();
+        if (!filePath.isEmpty()) {
+            files.insert(shape, filePath);
         }
     }
 }
 
+/**
+ * The decoded sprites are shared by all themes that use the same cursor file at the same size,
+ * so reloading the theme, e.g. because the scale of an output has changed, or another user of
+ * the theme doesn't decode them again. The sprites are dropped along with the last theme.
+ */
+static std::map<std::tuple<QString, int, qreal>, std::weak_ptr<const QVector<KXcursorSprite>>> s_spriteCache;
+
+KXcursorSprites KXcursorThemePrivate::sprites(const QByteArray &shape) const
+{
+    if (auto it = registry.constFind(shape); it != registry.constEnd()) {
+        return *it;
+    }
+
+    const QString filePath = files.value(shape);
+    if (filePath.isEmpty()) {
+        return nullptr;
+    }
+
+    const auto key = std::make_tuple(filePath, size, devicePixelRatio);
+    KXcursorSprites sprites;
+    if (auto it = s_spriteCache.find(key); it != s_spriteCache.end()) {
+        sprites = it->second.lock();
+    }
+    if (!sprites) {
+        std::erase_if(s_spriteCache, [](const auto &entry) {
+            return entry.second.expired();
+        });
+        sprites = std::make_shared<const QVector<KXcursorSprite>>(loadCursor(filePath, size, devicePixelRatio));
+        s_spriteCache[key] = sprites;
+    }
+
+    registry.insert(shape, sprites);
+    return sprites;
+}
+
 static QStringList searchPaths()
 {
     static QStringList paths;
@@ -156,7 +189,7 @@ static QStringList searchPaths()
     return paths;
 }
 
-void KXcursorThemePrivate::load(const QString &themeName, int size, qreal devicePixelRatio)
+void KXcursorThemePrivate::load(const QString &themeName)
 {
     const QStringList paths = searchPaths();
 
@@ -178,7 +211,7 @@ void KXcursorThemePrivate::load(const QString &themeName, int size, qreal device
             if (!dir.exists()) {
                 continue;
             }
-            loadCursors(dir.filePath(QStringLiteral("cursors")), size, devicePixelRatio);
+            discoverCursors(dir.filePath(QStringLiteral("cursors")));
             if (inherits.isEmpty()) {
                 const KConfig config(dir.filePath(QStringLiteral("index.theme")), KConfig::NoGlobals);
                 inherits << KConfigGroup(&config, "Icon Theme").readEntry("Inherits", QStringList());
@@ -200,7 +233,9 @@ KXcursorTheme::KXcursorTheme()
 KXcursorTheme::KXcursorTheme(const QString &themeName, int size, qreal devicePixelRatio)
     : d(new KXcursorThemePrivate)
 {
-    d->load(themeName, size, devicePixelRatio);
+    d->size = size;
+    d->devicePixelRatio = devicePixelRatio;
+    d->load(themeName);
 }
 
 KXcursorTheme::KXcursorTheme(const KXcursorTheme &other)
@@ -230,12 +265,15 @@ bool KXcursorTheme::operator!=(const KXcursorTheme &other)
 
 bool KXcursorTheme::isEmpty() const
 {
-    return d->registry.isEmpty();
+    return d->files.isEmpty();
 }
 
 QVector<KXcursorSprite> KXcursorTheme::shape(const QByteArray &name) const
 {
-    return d->registry.value(name);
+    if (const KXcursorSprites sprites = d->sprites(name)) {
+        return *sprites;
+    }
+    return {};
 }
 
 } // namespace KWin
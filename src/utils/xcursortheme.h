@@ -75,6 +75,9 @@ private:
 
 /**
  * The KXcursorTheme class represents an Xcursor theme.
+ *
+ * Only the list of cursors is read when the theme is loaded, every cursor is decoded the first
+ * time it's requested with shape().
  */
 class KWIN_EXPORT KXcursorTheme
 {
@@ -96,6 +96,7 @@ private Q_SLOTS:
     void testPointerTransformation();
     void testPointerButton_data();
     void testPointerButton();
+    void testPointerMotionCoalescing();
     void testPointerSubSurfaceTree();
     void testPointerSwipeGesture_data();
     void testPointerSwipeGesture();
@@ -728,6 +729,67 @@ void TestWaylandSeat::testPointerButton()
     QCOMPARE(buttonChangedSpy.last().at(3).value<KWayland::Client::Pointer::ButtonState>(), KWayland::Client::Pointer::ButtonState::Released);
 }
 
+void TestWaylandSeat::testPointerMotionCoalescing()
+{
+    // this test verifies that frames with nothing but a motion event are merged until the display gets flushed
+    using namespace KWaylandServer;
+
+    QSignalSpy pointerSpy(m_seat, &KWayland::Client::Seat::hasPointerChanged);
+    m_seatInterface->setHasPointer(true);
+    QVERIFY(pointerSpy.wait());
+
+    QSignalSpy surfaceCreatedSpy(m_compositorInterface, &KWaylandServer::CompositorInterface::surfaceCreated);
+    KWayland::Client::Surface *s = m_compositor->createSurface(m_compositor);
+    QVERIFY(surfaceCreatedSpy.wait());
+    SurfaceInterface *serverSurface = surfaceCreatedSpy.first().first().value<KWaylandServer::SurfaceInterface *>();
+    QVERIFY(serverSurface);
+
+    QImage image(QSize(100, 100), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::black);
+    s->attachBuffer(m_shm->createBuffer(image));
+    s->damage(image.rect());
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+    QVERIFY(committedSpy.wait());
+
+    std::unique_ptr<KWayland::Client::Pointer> p(m_seat->createPointer());
+    QVERIFY(p->isValid());
+    QSignalSpy enteredSpy(p.get(), &KWayland::Client::Pointer::entered);
+    QSignalSpy motionSpy(p.get(), &KWayland::Client::Pointer::motion);
+    QSignalSpy buttonChangedSpy(p.get(), &KWayland::Client::Pointer::buttonStateChanged);
+    QSignalSpy frameSpy(p.get(), &KWayland::Client::Pointer::frame);
+    wl_display_flush(m_connection->display());
+    QCoreApplication::processEvents();
+
+    m_seatInterface->notifyPointerEnter(serverSurface, QPointF(0, 0));
+    QVERIFY(enteredSpy.wait());
+    frameSpy.clear();
+
+    std::chrono::milliseconds timestamp(1);
+    for (int i = 1; i <= 3; ++i) {
+        m_seatInterface->setTimestamp(timestamp++);
+        m_seatInterface->notifyPointerMotion(QPointF(i, i));
+        m_seatInterface->notifyPointerFrame();
+    }
+    QVERIFY(motionSpy.wait());
+    QCOMPARE(motionSpy.count(), 1);
+    QCOMPARE(motionSpy.last().first().toPointF(), QPointF(3, 3));
+    QCOMPARE(motionSpy.last().last().value<quint32>(), quint32(3));
+    QCOMPARE(frameSpy.count(), 1);
+
+    // a button event has to be preceded by the pending motion
+    m_seatInterface->setTimestamp(timestamp++);
+    m_seatInterface->notifyPointerMotion(QPointF(5, 5));
+    m_seatInterface->notifyPointerFrame();
+    m_seatInterface->setTimestamp(timestamp++);
+    m_seatInterface->notifyPointerButton(Qt::LeftButton, PointerButtonState::Pressed);
+    m_seatInterface->notifyPointerFrame();
+    QVERIFY(buttonChangedSpy.wait());
+    QCOMPARE(motionSpy.count(), 2);
+    QCOMPARE(motionSpy.last().first().toPointF(), QPointF(5, 5));
+    QCOMPARE(frameSpy.count(), 3);
+}
+
 void TestWaylandSeat::testPointerSubSurfaceTree()
 {
     // this test verifies that pointer motion on a surface with sub-surfaces sends motion enter/leave to the sub-surface
@@ -2043,6 +2105,11 @@ void TestWaylandSeat::testKeymap()
     address = reinterpret_cast<char *>(file.map(0, keymapChangedSpy.first().last().value<quint32>()));
     QVERIFY(address);
     QCOMPARE(qstrcmp(address, "bar"), 0);
+
+    // setting the same keymap again doesn't send it again
+    keymapChangedSpy.clear();
+    m_seatInterface->keyboard()->setKeymap(QByteArrayLiteral("bar"));
+    QVERIFY(!keymapChangedSpy.wait(100));
 }
 
 QTEST_GUILESS_MAIN(TestWaylandSeat)
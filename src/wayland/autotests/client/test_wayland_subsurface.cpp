@@ -39,6 +39,7 @@ private Q_SLOTS:
     void testMode();
     void testPosition_data();
     void testPosition();
+    void testTreeChanges();
     void testPlaceAbove();
     void testPlaceBelow();
     void testSyncMode();
@@ -329,6 +330,52 @@ void TestSubSurface::testPosition()
     QCOMPARE(serverSubSurface->position(), QPoint(20, 30));
 }
 
+void TestSubSurface::testTreeChanges()
+{
+    // the changes of the sub-surfaces applied in a commit of the main surface are announced once
+    using namespace KWaylandServer;
+    std::unique_ptr<KWayland::Client::Surface> surface1(m_compositor->createSurface());
+    std::unique_ptr<KWayland::Client::Surface> surface2(m_compositor->createSurface());
+    std::unique_ptr<KWayland::Client::Surface> parent(m_compositor->createSurface());
+
+    QSignalSpy subSurfaceCreatedSpy(m_subcompositorInterface, &KWaylandServer::SubCompositorInterface::subSurfaceCreated);
+    std::unique_ptr<KWayland::Client::SubSurface> subSurface1(m_subCompositor->createSubSurface(surface1.get(), parent.get()));
+    QVERIFY(subSurfaceCreatedSpy.wait());
+    SubSurfaceInterface *serverSubSurface1 = subSurfaceCreatedSpy.first().first().value<KWaylandServer::SubSurfaceInterface *>();
+    QVERIFY(serverSubSurface1);
+    SurfaceInterface *serverParentSurface = serverSubSurface1->parentSurface();
+    QSignalSpy treeChangedSpy(serverParentSurface, &SurfaceInterface::subSurfaceTreeChanged);
+
+    subSurfaceCreatedSpy.clear();
+    std::unique_ptr<KWayland::Client::SubSurface> subSurface2(m_subCompositor->createSubSurface(surface2.get(), parent.get()));
+    QVERIFY(subSurfaceCreatedSpy.wait());
+    SubSurfaceInterface *serverSubSurface2 = subSurfaceCreatedSpy.first().first().value<KWaylandServer::SubSurfaceInterface *>();
+    QVERIFY(serverSubSurface2);
+    QCOMPARE(treeChangedSpy.count(), 1);
+    QCOMPARE(treeChangedSpy.last().first().value<SubSurfaceTreeChanges>(), SubSurfaceTreeChanges(SubSurfaceTreeChange::Added));
+
+    // moving both sub-surfaces results in one notification when the parent is committed
+    subSurface1->setPosition(QPoint(10, 20));
+    subSurface2->setPosition(QPoint(30, 40));
+    QSignalSpy parentCommittedSpy(serverParentSurface, &SurfaceInterface::committed);
+    parent->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommittedSpy.wait());
+    QCOMPARE(treeChangedSpy.count(), 2);
+    QCOMPARE(treeChangedSpy.last().first().value<SubSurfaceTreeChanges>(), SubSurfaceTreeChanges(SubSurfaceTreeChange::Moved));
+    QCOMPARE(serverSubSurface1->position(), QPoint(10, 20));
+    QCOMPARE(serverSubSurface2->position(), QPoint(30, 40));
+
+    // a commit that changes nothing in the tree is not announced
+    parent->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(parentCommittedSpy.wait());
+    QCOMPARE(treeChangedSpy.count(), 2);
+
+    // removing a sub-surface is announced immediately
+    subSurface2.reset();
+    QVERIFY(treeChangedSpy.wait());
+    QCOMPARE(treeChangedSpy.last().first().value<SubSurfaceTreeChanges>(), SubSurfaceTreeChanges(SubSurfaceTreeChange::Removed));
+}
+
 void TestSubSurface::testPlaceAbove()
 {
     using namespace KWaylandServer;
@@ -44,6 +44,7 @@ private Q_SLOTS:
     void testFrameCallback();
     void testAttachBuffer();
     void testMultipleSurfaces();
+    void testMultipleSurfacesSamePool();
     void testOpaque();
     void testInput();
     void testScale();
@@ -583,6 +584,53 @@ void TestWaylandSurface::testMultipleSurfaces()
     QCOMPARE(buffer1Data, black);
 }
 
+void TestWaylandSurface::testMultipleSurfacesSamePool()
+{
+    using namespace KWaylandServer;
+    KWayland::Client::Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy shmSpy(&registry, &KWayland::Client::Registry::shmAnnounced);
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(shmSpy.wait());
+
+    KWayland::Client::ShmPool pool;
+    pool.setup(registry.bindShm(shmSpy.first().first().value<quint32>(), shmSpy.first().last().value<quint32>()));
+    QVERIFY(pool.isValid());
+
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWaylandServer::CompositorInterface::surfaceCreated);
+    std::unique_ptr<KWayland::Client::Surface> s1(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    SurfaceInterface *serverSurface1 = serverSurfaceCreated.first().first().value<KWaylandServer::SurfaceInterface *>();
+    std::unique_ptr<KWayland::Client::Surface> s2(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    SurfaceInterface *serverSurface2 = serverSurfaceCreated.last().first().value<KWaylandServer::SurfaceInterface *>();
+
+    QImage black(24, 24, QImage::Format_RGB32);
+    black.fill(Qt::black);
+    QImage red(24, 24, QImage::Format_ARGB32_Premultiplied);
+    red.fill(QColor(255, 0, 0, 128));
+
+    s1->attachBuffer(pool.createBuffer(black));
+    s1->damage(QRect(0, 0, 24, 24));
+    s1->commit(KWayland::Client::Surface::CommitFlag::None);
+    QSignalSpy damageSpy1(serverSurface1, &KWaylandServer::SurfaceInterface::damaged);
+    QVERIFY(damageSpy1.wait());
+
+    s2->attachBuffer(pool.createBuffer(red));
+    s2->damage(QRect(0, 0, 24, 24));
+    s2->commit(KWayland::Client::Surface::CommitFlag::None);
+    QSignalSpy damageSpy2(serverSurface2, &KWaylandServer::SurfaceInterface::damaged);
+    QVERIFY(damageSpy2.wait());
+
+    // buffers from the same pool can be accessed at the same time
+    const QImage buffer1Data = qobject_cast<ShmClientBuffer *>(serverSurface1->buffer())->data();
+    const QImage buffer2Data = qobject_cast<ShmClientBuffer *>(serverSurface2->buffer())->data();
+    QCOMPARE(buffer1Data, black);
+    QCOMPARE(buffer2Data, red);
+}
+
 void TestWaylandSurface::testOpaque()
 {
     using namespace KWaylandServer;
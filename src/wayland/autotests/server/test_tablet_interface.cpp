@@ -88,12 +88,24 @@ public:
         surfaceApproximated[surface]++;
     }
 
+    void zwp_tablet_tool_v2_motion(wl_fixed_t /*x*/, wl_fixed_t /*y*/) override
+    {
+        motionCount++;
+    }
+
+    void zwp_tablet_tool_v2_pressure(uint32_t pressure) override
+    {
+        pressures << pressure;
+    }
+
     void zwp_tablet_tool_v2_frame(uint32_t time) override
     {
         Q_EMIT frame(time);
     }
 
     QHash<struct ::wl_surface *, int> surfaceApproximated;
+    int motionCount = 0;
+    QList<uint32_t> pressures;
 Q_SIGNALS:
     void frame(quint32 time);
 };
@@ -149,6 +161,7 @@ private Q_SLOTS:
     void testAddPad();
     void testInteractSimple();
     void testInteractSurfaceChange();
+    void testRedundantAxesDropped();
 
 private:
     KWayland::Client::ConnectionThread *m_connection;
@@ -356,5 +369,48 @@ void TestTabletInterface::testInteractSurfaceChange()
     QCOMPARE(m_tabletSeatClient->m_tools[0]->surfaceApproximated.count(), 2);
 }
 
+void TestTabletInterface::testRedundantAxesDropped()
+{
+    Tool *clientTool = m_tabletSeatClient->m_tools[0];
+    clientTool->motionCount = 0;
+    clientTool->pressures.clear();
+    QSignalSpy frameSpy(clientTool, &Tool::frame);
+
+    m_tool->setCurrentSurface(m_surfaces[0]);
+    m_tool->sendProximityIn(m_tablet);
+    m_tool->sendMotion({3, 3});
+    m_tool->sendPressure(10);
+    m_tool->sendFrame(s_serial++);
+
+    // nothing changed, neither the axes nor the frame should reach the client
+    m_tool->sendMotion({3, 3});
+    m_tool->sendPressure(10);
+    m_tool->sendFrame(s_serial++);
+
+    m_tool->sendMotion({3, 3});
+    m_tool->sendPressure(20);
+    m_tool->sendFrame(s_serial++);
+
+    m_tool->sendProximityOut();
+    m_tool->sendFrame(s_serial++);
+
+    QTRY_COMPARE(frameSpy.count(), 3);
+    QCOMPARE(clientTool->motionCount, 1);
+    QCOMPARE(clientTool->pressures, (QList<uint32_t>{10, 20}));
+
+    // after proximity in the client needs the full axis state again
+    m_tool->setCurrentSurface(m_surfaces[0]);
+    m_tool->sendProximityIn(m_tablet);
+    m_tool->sendMotion({3, 3});
+    m_tool->sendPressure(20);
+    m_tool->sendFrame(s_serial++);
+    m_tool->sendProximityOut();
+    m_tool->sendFrame(s_serial++);
+
+    QTRY_COMPARE(frameSpy.count(), 5);
+    QCOMPARE(clientTool->motionCount, 2);
+    QCOMPARE(clientTool->pressures, (QList<uint32_t>{10, 20, 20}));
+}
+
 QTEST_GUILESS_MAIN(TestTabletInterface)
 #include "test_tablet_interface.moc"
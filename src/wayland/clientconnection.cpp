@@ -5,8 +5,10 @@
 */
 #include "clientconnection.h"
 #include "display.h"
+#include "utils/common.h"
 #include "utils/executable_path.h"
 // Qt
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QVector>
 // Wayland
@@ -14,6 +16,9 @@
 
 namespace KWaylandServer
 {
+// a client that sends more requests in a single dispatch delays everything else
+static const int s_floodRequestsPerDispatch = 1000;
+
 class ClientConnectionPrivate
 {
 public:
@@ -29,6 +34,15 @@ public:
 
     qreal scaleOverride = 1.0;
 
+    quint64 requestCount = 0;
+    int dispatchRequestCount = 0;
+    int peakRequestsPerDispatch = 0;
+    bool flooding = false;
+
+    int boundGlobalCount = 0;
+    std::chrono::nanoseconds globalFilterTime = std::chrono::nanoseconds::zero();
+    QElapsedTimer lifetime;
+
 private:
     static void destroyListenerCallback(wl_listener *listener, void *data);
     ClientConnection *q;
@@ -48,6 +62,7 @@ ClientConnectionPrivate::ClientConnectionPrivate(wl_client *c, Display *display,
     wl_client_add_destroy_listener(c, &listener);
     wl_client_get_credentials(client, &pid, &user, &group);
     executablePath = executablePathFromPid(pid);
+    lifetime.start();
 }
 
 ClientConnectionPrivate::~ClientConnectionPrivate()
@@ -68,6 +83,9 @@ void ClientConnectionPrivate::destroyListenerCallback(wl_listener *listener, voi
     auto p = (*it);
     auto q = p->q;
     Q_EMIT q->aboutToBeDestroyed();
+    qCDebug(KWIN_CORE) << "Client with pid" << p->pid << "disconnected after" << p->lifetime.elapsed() << "ms, it bound"
+                       << p->boundGlobalCount << "globals and sent" << p->requestCount << "requests, filtering the globals took"
+                       << std::chrono::duration_cast<std::chrono::microseconds>(p->globalFilterTime).count() << "us";
     p->client = nullptr;
     wl_list_remove(&p->listener.link);
     Q_EMIT q->disconnected(q);
@@ -156,4 +174,50 @@ qreal ClientConnection::scaleOverride() const
 {
     return d->scaleOverride;
 }
+
+quint64 ClientConnection::requestCount() const
+{
+    return d->requestCount;
+}
+
+int ClientConnection::peakRequestsPerDispatch() const
+{
+    return d->peakRequestsPerDispatch;
+}
+
+int ClientConnection::boundGlobalCount() const
+{
+    return d->boundGlobalCount;
+}
+
+std::chrono::nanoseconds ClientConnection::globalFilterTime() const
+{
+    return d->globalFilterTime;
+}
+
+void ClientConnection::addBoundGlobal()
+{
+    d->boundGlobalCount++;
+}
+
+void ClientConnection::addGlobalFilterTime(std::chrono::nanoseconds time)
+{
+    d->globalFilterTime += time;
+}
+
+bool ClientConnection::addRequest()
+{
+    d->requestCount++;
+    return d->dispatchRequestCount++ == 0;
+}
+
+void ClientConnection::finishDispatch()
+{
+    d->peakRequestsPerDispatch = std::max(d->peakRequestsPerDispatch, d->dispatchRequestCount);
+    if (d->dispatchRequestCount > s_floodRequestsPerDispatch && !d->flooding) {
+        d->flooding = true;
+        qCWarning(KWIN_CORE) << "Client" << executablePath() << "( pid" << d->pid << ") sent" << d->dispatchRequestCount << "requests in a single dispatch";
+    }
+    d->dispatchRequestCount = 0;
+}
 }
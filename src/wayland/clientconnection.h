@@ -10,6 +10,7 @@
 #include <sys/types.h>
 
 #include <QObject>
+#include <chrono>
 #include <memory>
 
 struct wl_client;
@@ -125,6 +126,27 @@ public:
     void setScaleOverride(qreal scaleOverride);
     qreal scaleOverride() const;
 
+    /**
+     * Returns the number of requests the client has sent so far.
+     */
+    quint64 requestCount() const;
+
+    /**
+     * Returns the largest number of requests the client has sent within a single dispatch
+     * of the event loop.
+     */
+    int peakRequestsPerDispatch() const;
+
+    /**
+     * Returns the number of globals the client has bound so far.
+     */
+    int boundGlobalCount() const;
+
+    /**
+     * Returns the time spent deciding which globals the client is allowed to see.
+     */
+    std::chrono::nanoseconds globalFilterTime() const;
+
 Q_SIGNALS:
     /**
      * This signal is emitted when the client is about to be destroyed.
@@ -139,7 +161,13 @@ Q_SIGNALS:
 
 private:
     friend class Display;
+    friend class DisplayPrivate;
+    friend class FilteredDisplayPrivate;
     explicit ClientConnection(wl_client *c, Display *parent);
+    bool addRequest();
+    void finishDispatch();
+    void addBoundGlobal();
+    void addGlobalFilterTime(std::chrono::nanoseconds time);
     std::unique_ptr<ClientConnectionPrivate> d;
 };
 
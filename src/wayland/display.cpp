@@ -9,6 +9,7 @@
 #include "linuxdmabufv1clientbuffer.h"
 #include "output_interface.h"
 #include "shmclientbuffer.h"
+#include "singlepixelbuffer.h"
 #include "utils/common.h"
 
 #include <QAbstractEventDispatcher>
@@ -16,6 +17,8 @@
 #include <QDebug>
 #include <QRect>
 
+#include <cstring>
+
 namespace KWaylandServer
 {
 DisplayPrivate *DisplayPrivate::get(Display *display)
@@ -28,6 +31,28 @@ DisplayPrivate::DisplayPrivate(Display *q)
 {
 }
 
+void DisplayPrivate::logProtocol(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message)
+{
+    if (type != WL_PROTOCOL_LOGGER_REQUEST) {
+        return;
+    }
+    auto displayPrivate = static_cast<DisplayPrivate *>(data);
+    wl_client *client = wl_resource_get_client(message->resource);
+
+    // requests are dispatched client by client, most lookups hit the previous client
+    ClientConnection *connection = displayPrivate->lastDispatchedClient;
+    if (!connection || connection->client() != client) {
+        connection = displayPrivate->q->getConnection(client);
+        displayPrivate->lastDispatchedClient = connection;
+    }
+    if (connection->addRequest()) {
+        displayPrivate->dispatchedClients.append(connection);
+    }
+    if (strcmp(message->message->name, "bind") == 0 && wl_resource_instance_of(message->resource, &wl_registry_interface, nullptr)) {
+        connection->addBoundGlobal();
+    }
+}
+
 void DisplayPrivate::registerSocketName(const QString &socketName)
 {
     socketNames.append(socketName);
@@ -40,6 +65,7 @@ Display::Display(QObject *parent)
 {
     d->display = wl_display_create();
     d->loop = wl_display_get_event_loop(d->display);
+    wl_display_add_protocol_logger(d->display, DisplayPrivate::logProtocol, d.get());
 }
 
 Display::~Display()
@@ -113,10 +139,18 @@ void Display::dispatchEvents()
     if (wl_event_loop_dispatch(d->loop, 0) != 0) {
         qCWarning(KWIN_CORE) << "Error on dispatching Wayland event loop";
     }
+
+    // disconnected clients are deleted later, the pointers are still valid here
+    for (ClientConnection *connection : std::as_const(d->dispatchedClients)) {
+        connection->finishDispatch();
+    }
+    d->dispatchedClients.clear();
+    d->lastDispatchedClient = nullptr;
 }
 
 void Display::flush()
 {
+    Q_EMIT aboutToFlush();
     wl_display_flush_clients(d->display);
 }
 
@@ -194,6 +228,9 @@ ClientConnection *Display::getConnection(wl_client *client)
         Q_ASSERT(index != -1);
         d->clients.remove(index);
         Q_ASSERT(d->clients.indexOf(c) == -1);
+        if (d->lastDispatchedClient == c) {
+            d->lastDispatchedClient = nullptr;
+        }
         Q_EMIT clientDisconnected(c);
     });
     Q_EMIT clientConnected(c);
@@ -222,6 +259,8 @@ KWin::GraphicsBuffer *Display::bufferForResource(wl_resource *resource)
         return buffer;
     } else if (auto buffer = ShmClientBuffer::get(resource)) {
         return buffer;
+    } else if (auto buffer = SinglePixelClientBuffer::get(resource)) {
+        return buffer;
     } else {
         return nullptr;
     }
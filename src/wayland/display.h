@@ -142,6 +142,11 @@ Q_SIGNALS:
     void runningChanged(bool);
     void clientConnected(KWaylandServer::ClientConnection *);
     void clientDisconnected(KWaylandServer::ClientConnection *);
+    /**
+     * This signal is emitted right before the buffered events are flushed to the clients.
+     * Events that are held back to be merged must be sent at the latest at this point.
+     */
+    void aboutToFlush();
 
 private:
     friend class DisplayPrivate;
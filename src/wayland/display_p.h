@@ -31,6 +31,7 @@ public:
     DisplayPrivate(Display *q);
 
     void registerSocketName(const QString &socketName);
+    static void logProtocol(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message);
 
     Display *q;
     QSocketNotifier *socketNotifier = nullptr;
@@ -41,6 +42,9 @@ public:
     QList<OutputDeviceV2Interface *> outputdevicesV2;
     QVector<SeatInterface *> seats;
     QVector<ClientConnection *> clients;
+    // the clients that have sent requests during the current dispatch
+    QVector<ClientConnection *> dispatchedClients;
+    ClientConnection *lastDispatchedClient = nullptr;
     QStringList socketNames;
 };
 
@@ -5,11 +5,13 @@
 */
 
 #include "filtered_display.h"
+#include "clientconnection.h"
 #include "display.h"
 
 #include <wayland-server.h>
 
 #include <QByteArray>
+#include <QElapsedTimer>
 
 namespace KWaylandServer
 {
@@ -24,7 +26,11 @@ public:
         auto clientConnection = t->q->getConnection(const_cast<wl_client *>(client));
         auto interface = wl_global_get_interface(global);
         auto name = QByteArray::fromRawData(interface->name, strlen(interface->name));
-        return t->q->allowInterface(clientConnection, name);
+        QElapsedTimer timer;
+        timer.start();
+        const bool allowed = t->q->allowInterface(clientConnection, name);
+        clientConnection->addGlobalFilterTime(std::chrono::nanoseconds(timer.nsecsElapsed()));
+        return allowed;
     };
 };
 
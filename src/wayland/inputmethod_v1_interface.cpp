@@ -16,6 +16,7 @@
 #include "utils/ramfile.h"
 
 #include <QHash>
+#include <optional>
 
 #include <unistd.h>
 
@@ -47,11 +48,20 @@ InputMethodGrabV1::~InputMethodGrabV1()
 
 void InputMethodGrabV1::sendKeymap(const QByteArray &keymap)
 {
-    KWin::RamFile keymapFile("kwin-xkb-input-method-grab-keymap", keymap.constData(), keymap.size() + 1); // include QByteArray null terminator
+    const std::shared_ptr<KWin::RamFile> sharedFile = sharedKeymapFile(keymap);
+    std::optional<KWin::RamFile> privateFile;
 
     const auto resources = d->resourceMap();
     for (auto r : resources) {
-        d->send_keymap(r->handle, QtWaylandServer::wl_keyboard::keymap_format::keymap_format_xkb_v1, keymapFile.fd(), keymapFile.size());
+        // keymaps can be shared only with clients that map them privately
+        if (r->version() >= 7 && sharedFile) {
+            d->send_keymap(r->handle, QtWaylandServer::wl_keyboard::keymap_format::keymap_format_xkb_v1, sharedFile->fd(), sharedFile->size());
+            continue;
+        }
+        if (!privateFile) {
+            privateFile.emplace("kwin-xkb-input-method-grab-keymap", keymap.constData(), keymap.size() + 1); // include QByteArray null terminator
+        }
+        d->send_keymap(r->handle, QtWaylandServer::wl_keyboard::keymap_format::keymap_format_xkb_v1, privateFile->fd(), privateFile->size());
     }
 }
 
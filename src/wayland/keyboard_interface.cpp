@@ -16,6 +16,31 @@
 
 namespace KWaylandServer
 {
+std::shared_ptr<KWin::RamFile> sharedKeymapFile(const QByteArray &keymap)
+{
+    // every seat and the input method grab share one file per keymap
+    static QHash<QByteArray, std::weak_ptr<KWin::RamFile>> cache;
+
+    if (auto file = cache.value(keymap).lock()) {
+        return file;
+    }
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->expired()) {
+            it = cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // +1 to include QByteArray null terminator.
+    auto file = std::make_shared<KWin::RamFile>("kwin-xkb-keymap-shared", keymap.constData(), keymap.size() + 1, KWin::RamFile::Flag::SealWrite);
+    if (!file->effectiveFlags().testFlag(KWin::RamFile::Flag::SealWrite)) {
+        return nullptr;
+    }
+    cache.insert(keymap, file);
+    return file;
+}
+
 KeyboardInterfacePrivate::KeyboardInterfacePrivate(SeatInterface *s)
     : seat(s)
 {
@@ -75,8 +100,8 @@ void KeyboardInterfacePrivate::sendKeymap(Resource *resource)
 {
     // From version 7 on, keymaps must be mapped privately, so that
     // we can seal the fd and reuse it between clients.
-    if (resource->version() >= 7 && sharedKeymapFile.effectiveFlags().testFlag(KWin::RamFile::Flag::SealWrite)) {
-        send_keymap(resource->handle, keymap_format::keymap_format_xkb_v1, sharedKeymapFile.fd(), sharedKeymapFile.size());
+    if (resource->version() >= 7 && sharedKeymapFile) {
+        send_keymap(resource->handle, keymap_format::keymap_format_xkb_v1, sharedKeymapFile->fd(), sharedKeymapFile->size());
         // otherwise give each client its own unsealed copy.
     } else {
         KWin::RamFile keymapFile("kwin-xkb-keymap", keymap.constData(), keymap.size() + 1); // Include QByteArray null-terminator.
@@ -86,13 +111,12 @@ void KeyboardInterfacePrivate::sendKeymap(Resource *resource)
 
 void KeyboardInterface::setKeymap(const QByteArray &content)
 {
-    if (content.isNull()) {
+    if (content.isNull() || content == d->keymap) {
         return;
     }
 
     d->keymap = content;
-    // +1 to include QByteArray null terminator.
-    d->sharedKeymapFile = KWin::RamFile("kwin-xkb-keymap-shared", content.constData(), content.size() + 1, KWin::RamFile::Flag::SealWrite);
+    d->sharedKeymapFile = sharedKeymapFile(content);
 
     const auto keyboardResources = d->resourceMap();
     for (KeyboardInterfacePrivate::Resource *resource : keyboardResources) {
@@ -13,10 +13,20 @@
 #include <QHash>
 #include <QPointer>
 
+#include <memory>
+
 namespace KWaylandServer
 {
 class ClientConnection;
 
+/**
+ * Returns a sealed file with the given @a keymap that can be handed out to every client that
+ * maps keymaps privately, i.e. binds wl_keyboard version 7 or later. Keymaps with the same
+ * contents share one file for as long as it's referenced, or @c null if the file can't
+ * be sealed.
+ */
+std::shared_ptr<KWin::RamFile> sharedKeymapFile(const QByteArray &keymap);
+
 class KeyboardInterfacePrivate : public QtWaylandServer::wl_keyboard
 {
 public:
@@ -40,7 +50,7 @@ public:
     QMetaObject::Connection destroyConnection;
     QPointer<SurfaceInterface> modifierFocusSurface;
     QByteArray keymap;
-    KWin::RamFile sharedKeymapFile;
+    std::shared_ptr<KWin::RamFile> sharedKeymapFile;
 
     struct
     {
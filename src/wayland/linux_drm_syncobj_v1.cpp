@@ -0,0 +1,169 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "linux_drm_syncobj_v1.h"
+#include "core/syncobjtimeline.h"
+#include "display.h"
+#include "linuxdmabufv1clientbuffer.h"
+#include "surface_interface_p.h"
+
+#include <unistd.h>
+#include <xf86drm.h>
+
+namespace KWaylandServer
+{
+
+static constexpr uint32_t s_version = 1;
+
+LinuxDrmSyncObjV1Interface::LinuxDrmSyncObjV1Interface(Display *display, KWin::FileDescriptor &&drmFd, QObject *parent)
+    : QObject(parent)
+    , QtWaylandServer::wp_linux_drm_syncobj_manager_v1(*display, s_version)
+    , m_drmFd(std::move(drmFd))
+{
+}
+
+void LinuxDrmSyncObjV1Interface::wp_linux_drm_syncobj_manager_v1_get_surface(Resource *resource, uint32_t id, wl_resource *surfaceResource)
+{
+    SurfaceInterface *surface = SurfaceInterface::get(surfaceResource);
+    SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
+    if (surfacePrivate->syncObjV1) {
+        wl_resource_post_error(resource->handle, error_surface_exists, "surface already exists");
+        return;
+    }
+    surfacePrivate->syncObjV1 = new LinuxDrmSyncObjSurfaceV1(surface, resource->client(), id);
+}
+
+void LinuxDrmSyncObjV1Interface::wp_linux_drm_syncobj_manager_v1_import_timeline(Resource *resource, uint32_t id, int32_t fd)
+{
+    uint32_t handle = 0;
+    const int ret = drmSyncobjFDToHandle(m_drmFd.get(), fd, &handle);
+    close(fd);
+    if (ret != 0) {
+        wl_resource_post_error(resource->handle, error_invalid_timeline, "Importing timeline failed");
+        return;
+    }
+    new LinuxDrmSyncObjTimelineV1(resource->client(), id, std::make_unique<KWin::SyncTimeline>(m_drmFd.get(), handle));
+}
+
+void LinuxDrmSyncObjV1Interface::wp_linux_drm_syncobj_manager_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+LinuxDrmSyncObjTimelineV1::LinuxDrmSyncObjTimelineV1(wl_client *client, uint32_t id, std::unique_ptr<KWin::SyncTimeline> &&timeline)
+    : QtWaylandServer::wp_linux_drm_syncobj_timeline_v1(client, id, s_version)
+    , m_timeline(std::move(timeline))
+{
+}
+
+LinuxDrmSyncObjTimelineV1::~LinuxDrmSyncObjTimelineV1() = default;
+
+LinuxDrmSyncObjTimelineV1 *LinuxDrmSyncObjTimelineV1::get(wl_resource *resource)
+{
+    if (auto timelineResource = Resource::fromResource(resource)) {
+        return static_cast<LinuxDrmSyncObjTimelineV1 *>(timelineResource->object());
+    }
+    return nullptr;
+}
+
+std::shared_ptr<KWin::SyncTimeline> LinuxDrmSyncObjTimelineV1::timeline() const
+{
+    return m_timeline;
+}
+
+void LinuxDrmSyncObjTimelineV1::wp_linux_drm_syncobj_timeline_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void LinuxDrmSyncObjTimelineV1::wp_linux_drm_syncobj_timeline_v1_destroy_resource(Resource *resource)
+{
+    delete this;
+}
+
+LinuxDrmSyncObjSurfaceV1::LinuxDrmSyncObjSurfaceV1(SurfaceInterface *surface, wl_client *client, uint32_t id)
+    : QtWaylandServer::wp_linux_drm_syncobj_surface_v1(client, id, s_version)
+    , m_surface(surface)
+{
+}
+
+LinuxDrmSyncObjSurfaceV1::~LinuxDrmSyncObjSurfaceV1()
+{
+    if (m_surface) {
+        SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(m_surface);
+        surfacePrivate->pending.acquirePoint.timeline.reset();
+        surfacePrivate->pending.releasePoint.reset();
+        surfacePrivate->syncObjV1 = nullptr;
+    }
+}
+
+void LinuxDrmSyncObjSurfaceV1::wp_linux_drm_syncobj_surface_v1_set_acquire_point(Resource *resource, wl_resource *timeline_resource, uint32_t point_hi, uint32_t point_lo)
+{
+    if (!m_surface) {
+        wl_resource_post_error(resource->handle, error_no_surface, "Surface got destroyed already");
+        return;
+    }
+    const auto timeline = LinuxDrmSyncObjTimelineV1::get(timeline_resource);
+    const uint64_t point = (uint64_t(point_hi) << 32) | point_lo;
+    SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(m_surface);
+    surfacePrivate->pending.acquirePoint.timeline = timeline->timeline();
+    surfacePrivate->pending.acquirePoint.point = point;
+}
+
+void LinuxDrmSyncObjSurfaceV1::wp_linux_drm_syncobj_surface_v1_set_release_point(Resource *resource, wl_resource *timeline_resource, uint32_t point_hi, uint32_t point_lo)
+{
+    if (!m_surface) {
+        wl_resource_post_error(resource->handle, error_no_surface, "Surface got destroyed already");
+        return;
+    }
+    const auto timeline = LinuxDrmSyncObjTimelineV1::get(timeline_resource);
+    const uint64_t point = (uint64_t(point_hi) << 32) | point_lo;
+    SurfaceInterfacePrivate::get(m_surface)->pending.releasePoint = std::make_shared<KWin::SyncReleasePoint>(timeline->timeline(), point);
+}
+
+void LinuxDrmSyncObjSurfaceV1::wp_linux_drm_syncobj_surface_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void LinuxDrmSyncObjSurfaceV1::wp_linux_drm_syncobj_surface_v1_destroy_resource(Resource *resource)
+{
+    delete this;
+}
+
+bool LinuxDrmSyncObjSurfaceV1::maybeEmitProtocolErrors()
+{
+    const auto &pending = SurfaceInterfacePrivate::get(m_surface)->pending;
+    const bool hasPoints = pending.acquirePoint.timeline || pending.releasePoint;
+    if (!pending.bufferIsSet || !pending.buffer) {
+        if (hasPoints) {
+            wl_resource_post_error(resource()->handle, error_no_buffer, "Sync points were set without a buffer");
+            return false;
+        }
+        return true;
+    }
+    if (!qobject_cast<LinuxDmaBufV1ClientBuffer *>(pending.buffer)) {
+        if (hasPoints) {
+            wl_resource_post_error(resource()->handle, error_unsupported_buffer, "Only dmabuf buffers can be used with explicit sync");
+            return false;
+        }
+        return true;
+    }
+    if (!pending.acquirePoint.timeline) {
+        wl_resource_post_error(resource()->handle, error_no_acquire_point, "No acquire point was set for the buffer");
+        return false;
+    }
+    if (!pending.releasePoint) {
+        wl_resource_post_error(resource()->handle, error_no_release_point, "No release point was set for the buffer");
+        return false;
+    }
+    if (pending.acquirePoint.timeline.get() == pending.releasePoint->timeline() && pending.acquirePoint.point >= pending.releasePoint->timelinePoint()) {
+        wl_resource_post_error(resource()->handle, error_conflicting_points, "The release point has to be after the acquire point");
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "kwin_export.h"
+#include "utils/filedescriptor.h"
+
+#include "qwayland-server-linux-drm-syncobj-v1.h"
+
+#include <QObject>
+#include <QPointer>
+#include <memory>
+
+namespace KWin
+{
+class SyncTimeline;
+}
+
+namespace KWaylandServer
+{
+
+class Display;
+class SurfaceInterface;
+
+/**
+ * The LinuxDrmSyncObjV1Interface class implements the wp_linux_drm_syncobj_manager_v1
+ * global, which allows clients to use explicit synchronization with drm timeline syncobjs
+ * instead of relying on implicit synchronization of dmabufs.
+ */
+class KWIN_EXPORT LinuxDrmSyncObjV1Interface : public QObject, private QtWaylandServer::wp_linux_drm_syncobj_manager_v1
+{
+    Q_OBJECT
+public:
+    /**
+     * Creates the global. The timelines imported by clients are attached to @a drmFd.
+     */
+    explicit LinuxDrmSyncObjV1Interface(Display *display, KWin::FileDescriptor &&drmFd, QObject *parent = nullptr);
+
+private:
+    void wp_linux_drm_syncobj_manager_v1_get_surface(Resource *resource, uint32_t id, wl_resource *surface) override;
+    void wp_linux_drm_syncobj_manager_v1_import_timeline(Resource *resource, uint32_t id, int32_t fd) override;
+    void wp_linux_drm_syncobj_manager_v1_destroy(Resource *resource) override;
+
+    const KWin::FileDescriptor m_drmFd;
+};
+
+class LinuxDrmSyncObjTimelineV1 : private QtWaylandServer::wp_linux_drm_syncobj_timeline_v1
+{
+public:
+    LinuxDrmSyncObjTimelineV1(wl_client *client, uint32_t id, std::unique_ptr<KWin::SyncTimeline> &&timeline);
+    ~LinuxDrmSyncObjTimelineV1() override;
+
+    static LinuxDrmSyncObjTimelineV1 *get(wl_resource *resource);
+
+    std::shared_ptr<KWin::SyncTimeline> timeline() const;
+
+private:
+    void wp_linux_drm_syncobj_timeline_v1_destroy(Resource *resource) override;
+    void wp_linux_drm_syncobj_timeline_v1_destroy_resource(Resource *resource) override;
+
+    const std::shared_ptr<KWin::SyncTimeline> m_timeline;
+};
+
+class LinuxDrmSyncObjSurfaceV1 : private QtWaylandServer::wp_linux_drm_syncobj_surface_v1
+{
+public:
+    LinuxDrmSyncObjSurfaceV1(SurfaceInterface *surface, wl_client *client, uint32_t id);
+    ~LinuxDrmSyncObjSurfaceV1() override;
+
+    /**
+     * Checks the pending state of the surface. Returns @c false and posts the appropriate
+     * protocol error if the pending state can't be committed.
+     */
+    bool maybeEmitProtocolErrors();
+
+private:
+    void wp_linux_drm_syncobj_surface_v1_set_acquire_point(Resource *resource, wl_resource *timeline, uint32_t point_hi, uint32_t point_lo) override;
+    void wp_linux_drm_syncobj_surface_v1_set_release_point(Resource *resource, wl_resource *timeline, uint32_t point_hi, uint32_t point_lo) override;
+    void wp_linux_drm_syncobj_surface_v1_destroy(Resource *resource) override;
+    void wp_linux_drm_syncobj_surface_v1_destroy_resource(Resource *resource) override;
+
+    const QPointer<SurfaceInterface> m_surface;
+};
+
+}
@@ -98,7 +98,8 @@ public:
     transform m_transform = transform_normal;
     QList<OutputDeviceModeV2Interface *> m_modes;
     OutputDeviceModeV2Interface *m_currentMode = nullptr;
-    QByteArray m_edid;
+    // encoded once, rather than for every client that binds the output device
+    QString m_edid;
     bool m_enabled = true;
     QUuid m_uuid;
     uint32_t m_capabilities = 0;
@@ -317,7 +318,7 @@ void OutputDeviceV2InterfacePrivate::sendDone(Resource *resource)
 
 void OutputDeviceV2InterfacePrivate::sendEdid(Resource *resource)
 {
-    send_edid(resource->handle, QString::fromStdString(m_edid.toBase64().toStdString()));
+    send_edid(resource->handle, m_edid);
 }
 
 void OutputDeviceV2InterfacePrivate::sendEnabled(Resource *resource)
@@ -484,7 +485,7 @@ void OutputDeviceV2Interface::updateCurrentMode()
 
 void OutputDeviceV2Interface::updateEdid()
 {
-    d->m_edid = d->m_handle->edid().raw();
+    d->m_edid = QString::fromLatin1(d->m_handle->edid().raw().toBase64());
     const auto clientResources = d->resourceMap();
     for (const auto &resource : clientResources) {
         d->sendEdid(resource);
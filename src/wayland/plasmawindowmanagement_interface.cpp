@@ -49,6 +49,8 @@ public:
     void sendStackingOrderChanged(wl_resource *resource);
     void sendStackingOrderUuidsChanged();
     void sendStackingOrderUuidsChanged(wl_resource *resource);
+    void scheduleFlush(PlasmaWindowInterface *window);
+    void flush();
 
     PlasmaWindowManagementInterface::ShowingDesktopState state = PlasmaWindowManagementInterface::ShowingDesktopState::Disabled;
     QList<PlasmaWindowInterface *> windows;
@@ -56,6 +58,9 @@ public:
     quint32 windowIdCounter = 0;
     QVector<quint32> stackingOrder;
     QVector<QString> stackingOrderUuids;
+    bool stackingOrderDirty = false;
+    bool stackingOrderUuidsDirty = false;
+    QList<PlasmaWindowInterface *> dirtyWindows;
     PlasmaWindowManagementInterface *q;
 
 protected:
@@ -83,6 +88,14 @@ public:
     void setApplicationMenuPaths(const QString &service, const QString &object);
     void setResourceName(const QString &resourceName);
     wl_resource *resourceForParent(PlasmaWindowInterface *parent, Resource *child) const;
+    void flush();
+
+    enum PendingChange {
+        TitleChanged = 0x1,
+        StateChanged = 0x2,
+        GeometryChanged = 0x4,
+    };
+    void scheduleFlush(PendingChange change);
 
     quint32 windowId = 0;
     QHash<SurfaceInterface *, QRect> minimizedGeometries;
@@ -105,6 +118,8 @@ public:
     quint32 m_state = 0;
     QString uuid;
     QString m_resourceName;
+    quint32 pendingChanges = 0;
+    bool managed = false;
 
 protected:
     void org_kde_plasma_window_bind_resource(Resource *resource) override;
@@ -199,6 +214,27 @@ void PlasmaWindowManagementInterfacePrivate::sendStackingOrderUuidsChanged(wl_re
     send_stacking_order_uuid_changed(r, uuids);
 }
 
+void PlasmaWindowManagementInterfacePrivate::scheduleFlush(PlasmaWindowInterface *window)
+{
+    if (!dirtyWindows.contains(window)) {
+        dirtyWindows.append(window);
+    }
+}
+
+void PlasmaWindowManagementInterfacePrivate::flush()
+{
+    const QList<PlasmaWindowInterface *> windows = std::exchange(dirtyWindows, {});
+    for (PlasmaWindowInterface *window : windows) {
+        window->d->flush();
+    }
+    if (std::exchange(stackingOrderDirty, false)) {
+        sendStackingOrderChanged();
+    }
+    if (std::exchange(stackingOrderUuidsDirty, false)) {
+        sendStackingOrderUuidsChanged();
+    }
+}
+
 void PlasmaWindowManagementInterfacePrivate::org_kde_plasma_window_management_bind_resource(Resource *resource)
 {
     for (const auto window : std::as_const(windows)) {
@@ -261,6 +297,11 @@ PlasmaWindowManagementInterface::PlasmaWindowManagementInterface(Display *displa
     : QObject(parent)
     , d(new PlasmaWindowManagementInterfacePrivate(this, display))
 {
+    // the task manager only needs to see the final state of a restack or a property change,
+    // so the changes are collected and sent once before the events are flushed to the clients
+    connect(display, &Display::aboutToFlush, this, [this]() {
+        d->flush();
+    });
 }
 
 PlasmaWindowManagementInterface::~PlasmaWindowManagementInterface() = default;
@@ -280,6 +321,7 @@ PlasmaWindowInterface *PlasmaWindowManagementInterface::createWindow(QObject *pa
 
     window->d->uuid = uuid.toString();
     window->d->windowId = ++d->windowIdCounter; // NOTE the window id is deprecated
+    window->d->managed = true;
 
     const auto clientResources = d->resourceMap();
     for (auto resource : clientResources) {
@@ -292,6 +334,7 @@ PlasmaWindowInterface *PlasmaWindowManagementInterface::createWindow(QObject *pa
     d->windows << window;
     connect(window, &QObject::destroyed, this, [this, window] {
         d->windows.removeAll(window);
+        d->dirtyWindows.removeAll(window);
     });
     return window;
 }
@@ -307,7 +350,7 @@ void PlasmaWindowManagementInterface::setStackingOrder(const QVector<quint32> &s
         return;
     }
     d->stackingOrder = stackingOrder;
-    d->sendStackingOrderChanged();
+    d->stackingOrderDirty = true;
 }
 
 void PlasmaWindowManagementInterface::setStackingOrderUuids(const QVector<QString> &stackingOrderUuids)
@@ -316,7 +359,7 @@ void PlasmaWindowManagementInterface::setStackingOrderUuids(const QVector<QStrin
         return;
     }
     d->stackingOrderUuids = stackingOrderUuids;
-    d->sendStackingOrderUuidsChanged();
+    d->stackingOrderUuidsDirty = true;
 }
 
 void PlasmaWindowManagementInterface::setPlasmaVirtualDesktopManagementInterface(PlasmaVirtualDesktopManagementInterface *manager)
@@ -512,11 +555,7 @@ void PlasmaWindowInterfacePrivate::setTitle(const QString &title)
         return;
     }
     m_title = title;
-    const auto clientResources = resourceMap();
-
-    for (auto resource : clientResources) {
-        send_title_changed(resource->handle, truncate(m_title));
-    }
+    scheduleFlush(TitleChanged);
 }
 
 void PlasmaWindowInterfacePrivate::unmap()
@@ -524,6 +563,8 @@ void PlasmaWindowInterfacePrivate::unmap()
     if (unmapped) {
         return;
     }
+    // the pending changes must reach the clients before the window goes away
+    flush();
     unmapped = true;
     const auto clientResources = resourceMap();
 
@@ -544,10 +585,36 @@ void PlasmaWindowInterfacePrivate::setState(org_kde_plasma_window_management_sta
         return;
     }
     m_state = newState;
-    const auto clientResources = resourceMap();
+    scheduleFlush(StateChanged);
+}
 
+void PlasmaWindowInterfacePrivate::scheduleFlush(PendingChange change)
+{
+    // the temporary windows created for unknown ids aren't tracked by the manager
+    if (unmapped || !managed) {
+        return;
+    }
+    pendingChanges |= change;
+    wm->d->scheduleFlush(q);
+}
+
+void PlasmaWindowInterfacePrivate::flush()
+{
+    const quint32 changes = std::exchange(pendingChanges, 0);
+    if (!changes) {
+        return;
+    }
+    const auto clientResources = resourceMap();
     for (auto resource : clientResources) {
-        send_state_changed(resource->handle, m_state);
+        if (changes & TitleChanged) {
+            send_title_changed(resource->handle, truncate(m_title));
+        }
+        if (changes & StateChanged) {
+            send_state_changed(resource->handle, m_state);
+        }
+        if ((changes & GeometryChanged) && geometry.isValid() && resource->version() >= ORG_KDE_PLASMA_WINDOW_GEOMETRY_SINCE_VERSION) {
+            send_geometry(resource->handle, geometry.x(), geometry.y(), geometry.width(), geometry.height());
+        }
     }
 }
 
@@ -600,14 +667,7 @@ void PlasmaWindowInterfacePrivate::setGeometry(const QRect &geo)
     if (!geometry.isValid()) {
         return;
     }
-
-    const auto clientResources = resourceMap();
-    for (auto resource : clientResources) {
-        if (resource->version() < ORG_KDE_PLASMA_WINDOW_GEOMETRY_SINCE_VERSION) {
-            continue;
-        }
-        send_geometry(resource->handle, geometry.x(), geometry.y(), geometry.width(), geometry.height());
-    }
+    scheduleFlush(GeometryChanged);
 }
 
 void PlasmaWindowInterfacePrivate::setApplicationMenuPaths(const QString &service, const QString &object)
@@ -47,6 +47,9 @@ PointerInterfacePrivate::PointerInterfacePrivate(PointerInterface *q, SeatInterf
     , pinchGesturesV1(new PointerPinchGestureV1Interface(q))
     , holdGesturesV1(new PointerHoldGestureV1Interface(q))
 {
+    QObject::connect(seat->display(), &Display::aboutToFlush, q, [this]() {
+        flushDeferredMotion();
+    });
 }
 
 PointerInterfacePrivate::~PointerInterfacePrivate()
@@ -136,6 +139,32 @@ void PointerInterfacePrivate::sendFrame()
             send_frame(resource->handle);
         }
     }
+    frameHasEvents = false;
+}
+
+void PointerInterfacePrivate::sendMotion(const QPointF &localPosition, quint32 time)
+{
+    const QList<Resource *> pointerResources = pointersForClient(focusedSurface->client());
+    for (Resource *resource : pointerResources) {
+        send_motion(resource->handle, time, wl_fixed_from_double(localPosition.x()), wl_fixed_from_double(localPosition.y()));
+    }
+}
+
+void PointerInterfacePrivate::flushDeferredMotion()
+{
+    if (!deferredMotion) {
+        return;
+    }
+    const DeferredMotion motion = *deferredMotion;
+    deferredMotion.reset();
+    sendMotion(motion.position, motion.time);
+    if (deferredFrame) {
+        deferredFrame = false;
+        sendFrame();
+    } else {
+        // the motion belongs to the frame that is still being assembled
+        frameHasEvents = true;
+    }
 }
 
 PointerInterface::PointerInterface(SeatInterface *seat)
@@ -159,6 +188,7 @@ void PointerInterface::sendEnter(SurfaceInterface *surface, const QPointF &posit
     }
 
     if (d->focusedSurface) {
+        d->flushDeferredMotion();
         d->sendLeave(serial);
         if (d->focusedSurface->client() != surface->client()) {
             d->sendFrame();
@@ -168,6 +198,7 @@ void PointerInterface::sendEnter(SurfaceInterface *surface, const QPointF &posit
 
     d->focusedSurface = surface;
     d->destroyConnection = connect(d->focusedSurface, &SurfaceInterface::aboutToBeDestroyed, this, [this]() {
+        d->flushDeferredMotion();
         d->sendLeave(d->seat->display()->nextSerial());
         d->sendFrame();
         d->focusedSurface = nullptr;
@@ -187,6 +218,7 @@ void PointerInterface::sendLeave(quint32 serial)
         return;
     }
 
+    d->flushDeferredMotion();
     d->sendLeave(serial);
     d->sendFrame();
 
@@ -202,6 +234,9 @@ void PointerInterface::sendButton(quint32 button, PointerButtonState state, quin
         return;
     }
 
+    d->flushDeferredMotion();
+    d->frameHasEvents = true;
+
     const auto pointerResources = d->pointersForClient(d->focusedSurface->client());
     for (PointerInterfacePrivate::Resource *resource : pointerResources) {
         d->send_button(resource->handle, serial, d->seat->timestamp().count(), button, quint32(state));
@@ -252,6 +287,9 @@ void PointerInterface::sendAxis(Qt::Orientation orientation, qreal delta, qint32
         return;
     }
 
+    d->flushDeferredMotion();
+    d->frameHasEvents = true;
+
     qint32 valueAxisLowRes = 0;
     qint32 valueDiscrete = 0;
 
@@ -334,18 +372,29 @@ void PointerInterface::sendMotion(const QPointF &position)
     }
 
     const QPointF localPos = d->focusedSurface->toSurfaceLocal(position);
+    const quint32 time = d->seat->timestamp().count();
 
-    const auto pointerResources = d->pointersForClient(d->focusedSurface->client());
-    for (PointerInterfacePrivate::Resource *resource : pointerResources) {
-        d->send_motion(resource->handle, d->seat->timestamp().count(), wl_fixed_from_double(localPos.x()), wl_fixed_from_double(localPos.y()));
+    if (d->frameHasEvents) {
+        d->sendMotion(localPos, time);
+    } else {
+        // a newer motion event supersedes a deferred one, whether it ended its frame or not
+        d->deferredMotion = PointerInterfacePrivate::DeferredMotion{
+            .position = localPos,
+            .time = time,
+        };
     }
 }
 
 void PointerInterface::sendFrame()
 {
-    if (d->focusedSurface) {
-        d->sendFrame();
+    if (!d->focusedSurface) {
+        return;
     }
+    if (d->deferredMotion && !d->frameHasEvents) {
+        d->deferredFrame = true;
+        return;
+    }
+    d->sendFrame();
 }
 
 Cursor *PointerInterface::cursor() const
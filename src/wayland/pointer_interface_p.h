@@ -13,6 +13,8 @@
 #include <QPointer>
 #include <QVector>
 
+#include <optional>
+
 #include "qwayland-server-wayland.h"
 
 namespace KWaylandServer
@@ -46,9 +48,27 @@ public:
     QPointF accumulatorAxis;
     QPoint accumulatorV120;
 
+    /**
+     * A motion event that hasn't been sent yet. Frames that contain nothing but a motion event
+     * are held back until the display gets flushed, consecutive ones collapse into one.
+     */
+    struct DeferredMotion
+    {
+        QPointF position;
+        quint32 time;
+    };
+    std::optional<DeferredMotion> deferredMotion;
+    bool deferredFrame = false;
+    bool frameHasEvents = false;
+
     void sendLeave(quint32 serial);
     void sendEnter(const QPointF &parentSurfacePosition, quint32 serial);
     void sendFrame();
+    void sendMotion(const QPointF &localPosition, quint32 time);
+    /**
+     * Sends the deferred motion event, this must be called before any other pointer event.
+     */
+    void flushDeferredMotion();
 
 protected:
     void pointer_set_cursor(Resource *resource, uint32_t serial, ::wl_resource *surface_resource, int32_t hotspot_x, int32_t hotspot_y) override;
@@ -101,6 +101,7 @@ void PointerSwipeGestureV1Interface::sendBegin(quint32 serial, quint32 fingerCou
     if (!pointer->focusedSurface()) {
         return;
     }
+    PointerInterfacePrivate::get(pointer)->flushDeferredMotion();
 
     const SurfaceInterface *focusedSurface = pointer->focusedSurface();
     focusedClient = focusedSurface->client();
@@ -187,6 +188,7 @@ void PointerPinchGestureV1Interface::sendBegin(quint32 serial, quint32 fingerCou
     if (!pointer->focusedSurface()) {
         return;
     }
+    PointerInterfacePrivate::get(pointer)->flushDeferredMotion();
 
     const SurfaceInterface *focusedSurface = pointer->focusedSurface();
     focusedClient = focusedSurface->client();
@@ -278,6 +280,7 @@ void PointerHoldGestureV1Interface::sendBegin(quint32 serial, quint32 fingerCoun
     if (!pointer->focusedSurface()) {
         return;
     }
+    PointerInterfacePrivate::get(pointer)->flushDeferredMotion();
 
     const SurfaceInterface *focusedSurface = pointer->focusedSurface();
     focusedClient = focusedSurface->client();
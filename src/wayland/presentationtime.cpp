@@ -0,0 +1,108 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "presentationtime.h"
+#include "clientconnection.h"
+#include "display.h"
+#include "output_interface.h"
+#include "surface_interface_p.h"
+
+#include <time.h>
+
+namespace KWaylandServer
+{
+
+static const quint32 s_version = 1;
+
+PresentationTime::PresentationTime(Display *display, QObject *parent)
+    : QObject(parent)
+    , QtWaylandServer::wp_presentation(*display, s_version)
+{
+}
+
+void PresentationTime::wp_presentation_bind_resource(Resource *resource)
+{
+    // the timestamps of the render loops are sourced from the monotonic clock
+    send_clock_id(resource->handle, CLOCK_MONOTONIC);
+}
+
+void PresentationTime::wp_presentation_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void PresentationTime::wp_presentation_feedback(Resource *resource, wl_resource *surface, uint32_t callback)
+{
+    SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(SurfaceInterface::get(surface));
+
+    wl_resource *feedbackResource = wl_resource_create(resource->client(), &wp_presentation_feedback_interface, resource->version(), callback);
+    if (!feedbackResource) {
+        wl_resource_post_no_memory(resource->handle);
+        return;
+    }
+    wl_resource_set_implementation(feedbackResource, nullptr, nullptr, [](wl_resource *resource) {
+        wl_list_remove(wl_resource_get_link(resource));
+    });
+    wl_list_insert(surfacePrivate->pending.presentationFeedbacks.prev, wl_resource_get_link(feedbackResource));
+}
+
+PresentationTimeFeedback::PresentationTimeFeedback(OutputInterface *output)
+    : m_output(output)
+{
+    wl_list_init(&m_resources);
+}
+
+PresentationTimeFeedback::~PresentationTimeFeedback()
+{
+    discard(&m_resources);
+}
+
+void PresentationTimeFeedback::take(wl_list *feedbacks)
+{
+    wl_list_insert_list(m_resources.prev, feedbacks);
+    wl_list_init(feedbacks);
+}
+
+bool PresentationTimeFeedback::isEmpty() const
+{
+    return wl_list_empty(&m_resources);
+}
+
+void PresentationTimeFeedback::presented(std::chrono::nanoseconds refreshCycleDuration, std::chrono::nanoseconds timestamp, uint64_t sequence, KWin::PresentationFlags flags)
+{
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timestamp);
+    const auto nanoseconds = timestamp - seconds;
+    const uint64_t secs = seconds.count();
+    // the flags have the same values as in the protocol
+    const uint32_t presentationFlags = flags.toInt();
+
+    wl_resource *resource;
+    wl_resource *tmp;
+    wl_resource_for_each_safe (resource, tmp, &m_resources) {
+        if (m_output) {
+            ClientConnection *client = m_output->display()->getConnection(wl_resource_get_client(resource));
+            const auto outputResources = m_output->clientResources(client);
+            for (wl_resource *outputResource : outputResources) {
+                wp_presentation_feedback_send_sync_output(resource, outputResource);
+            }
+        }
+        wp_presentation_feedback_send_presented(resource, secs >> 32, secs & 0xffffffff, nanoseconds.count(),
+                                                refreshCycleDuration.count(), sequence >> 32, sequence & 0xffffffff,
+                                                presentationFlags);
+        wl_resource_destroy(resource);
+    }
+}
+
+void PresentationTimeFeedback::discard(wl_list *feedbacks)
+{
+    wl_resource *resource;
+    wl_resource *tmp;
+    wl_resource_for_each_safe (resource, tmp, feedbacks) {
+        wp_presentation_feedback_send_discarded(resource);
+        wl_resource_destroy(resource);
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "core/renderloop.h"
+#include "kwin_export.h"
+
+#include "qwayland-server-presentation-time.h"
+
+#include <QObject>
+#include <QPointer>
+
+namespace KWaylandServer
+{
+
+class Display;
+class OutputInterface;
+
+/**
+ * The PresentationTime class implements the wp_presentation global, which lets clients
+ * know when and how their content updates have been presented on the screen.
+ */
+class KWIN_EXPORT PresentationTime : public QObject, private QtWaylandServer::wp_presentation
+{
+    Q_OBJECT
+public:
+    explicit PresentationTime(Display *display, QObject *parent = nullptr);
+
+private:
+    void wp_presentation_bind_resource(Resource *resource) override;
+    void wp_presentation_destroy(Resource *resource) override;
+    void wp_presentation_feedback(Resource *resource, wl_resource *surface, uint32_t callback) override;
+};
+
+/**
+ * The PresentationTimeFeedback class collects the wp_presentation_feedback objects of
+ * the surfaces that are shown in a frame. The feedback objects that haven't been
+ * presented yet get discarded when it's destroyed.
+ */
+class PresentationTimeFeedback : public KWin::PresentationFeedback
+{
+public:
+    explicit PresentationTimeFeedback(OutputInterface *output);
+    ~PresentationTimeFeedback() override;
+
+    /**
+     * Moves all feedback resources in @a feedbacks to this object.
+     */
+    void take(wl_list *feedbacks);
+    bool isEmpty() const;
+
+    void presented(std::chrono::nanoseconds refreshCycleDuration, std::chrono::nanoseconds timestamp, uint64_t sequence, KWin::PresentationFlags flags) override;
+
+    /**
+     * Sends the discarded event to all feedback resources in @a feedbacks and destroys them.
+     */
+    static void discard(wl_list *feedbacks);
+
+private:
+    QPointer<OutputInterface> m_output;
+    wl_list m_resources;
+};
+
+}
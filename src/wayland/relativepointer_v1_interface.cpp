@@ -76,6 +76,11 @@ void RelativePointerV1Interface::sendRelativeMotion(const QPointF &delta, const
         return;
     }
 
+    // relative motion is part of the wl_pointer frames
+    PointerInterfacePrivate *pointerPrivate = PointerInterfacePrivate::get(pointer);
+    pointerPrivate->flushDeferredMotion();
+    pointerPrivate->frameHasEvents = true;
+
     auto scaleOverride = pointer->focusedSurface()->scaleOverride();
 
     ClientConnection *focusedClient = pointer->focusedSurface()->client();
@@ -15,7 +15,8 @@
 
 namespace KWaylandServer
 {
-static const ShmClientBuffer *s_accessedBuffer = nullptr;
+// libwayland guards the access to one pool per thread against SIGBUS
+static const wl_shm_pool *s_accessedPool = nullptr;
 static int s_accessCounter = 0;
 static QHash<wl_resource *, ShmClientBuffer *> s_buffers;
 
@@ -28,6 +29,7 @@ public:
 
     ShmClientBuffer *q;
     wl_resource *resource = nullptr;
+    const wl_shm_pool *pool = nullptr;
     QImage::Format format = QImage::Format_Invalid;
     uint32_t width = 0;
     uint32_t height = 0;
@@ -126,6 +128,11 @@ ShmClientBuffer::ShmClientBuffer(wl_resource *resource)
     d->hasAlphaChannel = alphaChannelFromFormat(wl_shm_buffer_get_format(buffer));
     d->format = imageFormatForShmFormat(wl_shm_buffer_get_format(buffer));
 
+    // the buffer keeps the pool alive, only the address is needed to track the access
+    wl_shm_pool *pool = wl_shm_buffer_ref_pool(buffer);
+    d->pool = pool;
+    wl_shm_pool_unref(pool);
+
     d->destroyListener.receiver = d.get();
     d->destroyListener.listener.notify = ShmClientBufferPrivate::buffer_destroy_callback;
     wl_resource_add_destroy_listener(resource, &d->destroyListener.listener);
@@ -154,19 +161,18 @@ static void cleanupShmData(void *bufferHandle)
     Q_ASSERT_X(s_accessCounter > 0, "cleanup", "access counter must be positive");
     s_accessCounter--;
     if (s_accessCounter == 0) {
-        s_accessedBuffer = nullptr;
+        s_accessedPool = nullptr;
     }
     wl_shm_buffer_end_access(static_cast<wl_shm_buffer *>(bufferHandle));
 }
 
 QImage ShmClientBuffer::data() const
 {
-    if (s_accessedBuffer && s_accessedBuffer != this) {
-        return QImage();
-    }
-
     if (wl_shm_buffer *buffer = wl_shm_buffer_get(d->resource)) {
-        s_accessedBuffer = this;
+        if (s_accessedPool && s_accessedPool != d->pool) {
+            return QImage();
+        }
+        s_accessedPool = d->pool;
         s_accessCounter++;
         wl_shm_buffer_begin_access(buffer);
         const uchar *data = static_cast<const uchar *>(wl_shm_buffer_get_data(buffer));
@@ -19,8 +19,10 @@ class ShmClientBufferPrivate;
 /**
  * The ShmClientBuffer class represents a wl_shm_buffer client buffer.
  *
- * The buffer's data can be accessed using the data() function. Note that it is not allowed
- * to access data of several shared memory buffers simultaneously.
+ * The buffer's data can be accessed using the data() function. The access ends when the last
+ * copy of the returned image is destroyed. Buffers that were allocated from the same pool can
+ * be accessed simultaneously, but it is not allowed to access data of buffers from different
+ * pools at the same time.
  */
 class KWIN_EXPORT ShmClientBuffer : public KWin::GraphicsBuffer
 {
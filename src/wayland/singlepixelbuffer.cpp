@@ -0,0 +1,95 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "singlepixelbuffer.h"
+#include "display.h"
+
+#include <wayland-server.h>
+
+#include <limits>
+
+namespace KWaylandServer
+{
+
+static const quint32 s_version = 1;
+
+SinglePixelBufferManagerV1::SinglePixelBufferManagerV1(Display *display, QObject *parent)
+    : QObject(parent)
+    , QtWaylandServer::wp_single_pixel_buffer_manager_v1(*display, s_version)
+{
+}
+
+void SinglePixelBufferManagerV1::wp_single_pixel_buffer_manager_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void SinglePixelBufferManagerV1::wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(Resource *resource, uint32_t id, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    wl_resource *bufferResource = wl_resource_create(resource->client(), &wl_buffer_interface, 1, id);
+    if (!bufferResource) {
+        wl_resource_post_no_memory(resource->handle);
+        return;
+    }
+    new SinglePixelClientBuffer(bufferResource, KWin::SinglePixelAttributes{
+                                                    .red = r,
+                                                    .green = g,
+                                                    .blue = b,
+                                                    .alpha = a,
+                                                });
+}
+
+const struct wl_buffer_interface SinglePixelClientBuffer::implementation = {
+    .destroy = buffer_destroy,
+};
+
+SinglePixelClientBuffer::SinglePixelClientBuffer(wl_resource *resource, const KWin::SinglePixelAttributes &attributes)
+    : m_resource(resource)
+    , m_attributes(attributes)
+{
+    wl_resource_set_implementation(resource, &implementation, this, buffer_destroy_resource);
+
+    connect(this, &GraphicsBuffer::released, [this]() {
+        wl_buffer_send_release(m_resource);
+    });
+}
+
+QSize SinglePixelClientBuffer::size() const
+{
+    return QSize(1, 1);
+}
+
+bool SinglePixelClientBuffer::hasAlphaChannel() const
+{
+    return m_attributes.alpha != std::numeric_limits<uint32_t>::max();
+}
+
+const KWin::SinglePixelAttributes *SinglePixelClientBuffer::singlePixelAttributes() const
+{
+    return &m_attributes;
+}
+
+SinglePixelClientBuffer *SinglePixelClientBuffer::get(wl_resource *resource)
+{
+    if (wl_resource_instance_of(resource, &wl_buffer_interface, &implementation)) {
+        return static_cast<SinglePixelClientBuffer *>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+void SinglePixelClientBuffer::buffer_destroy_resource(wl_resource *resource)
+{
+    if (SinglePixelClientBuffer *buffer = SinglePixelClientBuffer::get(resource)) {
+        buffer->m_resource = nullptr;
+        buffer->drop();
+    }
+}
+
+void SinglePixelClientBuffer::buffer_destroy(wl_client *client, wl_resource *resource)
+{
+    wl_resource_destroy(resource);
+}
+
+} // namespace KWaylandServer
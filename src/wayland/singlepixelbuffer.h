@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "core/graphicsbuffer.h"
+#include "kwin_export.h"
+
+#include "qwayland-server-single-pixel-buffer-v1.h"
+
+#include <QObject>
+
+struct wl_resource;
+
+namespace KWaylandServer
+{
+
+class Display;
+
+/**
+ * The SinglePixelBufferManagerV1 class implements the wp_single_pixel_buffer_manager_v1
+ * global, which lets clients create buffers that consist of a single solid color pixel.
+ */
+class KWIN_EXPORT SinglePixelBufferManagerV1 : public QObject, private QtWaylandServer::wp_single_pixel_buffer_manager_v1
+{
+    Q_OBJECT
+public:
+    explicit SinglePixelBufferManagerV1(Display *display, QObject *parent = nullptr);
+
+private:
+    void wp_single_pixel_buffer_manager_v1_destroy(Resource *resource) override;
+    void wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(Resource *resource, uint32_t id, uint32_t r, uint32_t g, uint32_t b, uint32_t a) override;
+};
+
+/**
+ * The SinglePixelClientBuffer class represents a wl_buffer created by the single pixel
+ * buffer manager. The renderers draw it as a solid color, without uploading a texture.
+ */
+class KWIN_EXPORT SinglePixelClientBuffer : public KWin::GraphicsBuffer
+{
+    Q_OBJECT
+
+public:
+    SinglePixelClientBuffer(wl_resource *resource, const KWin::SinglePixelAttributes &attributes);
+
+    QSize size() const override;
+    bool hasAlphaChannel() const override;
+    const KWin::SinglePixelAttributes *singlePixelAttributes() const override;
+
+    static SinglePixelClientBuffer *get(wl_resource *resource);
+
+private:
+    static void buffer_destroy_resource(wl_resource *resource);
+    static void buffer_destroy(wl_client *client, wl_resource *resource);
+    static const struct wl_buffer_interface implementation;
+
+    wl_resource *m_resource;
+    const KWin::SinglePixelAttributes m_attributes;
+};
+
+} // namespace KWaylandServer
@@ -177,11 +177,9 @@ void SubSurfaceInterfacePrivate::parentCommit()
         hasPendingPosition = false;
         position = pendingPosition;
         Q_EMIT q->positionChanged(position);
-    }
-
-    if (mode == SubSurfaceInterface::Mode::Synchronized) {
-        auto surfacePrivate = SurfaceInterfacePrivate::get(surface);
-        surfacePrivate->commitFromCache();
+        if (surface) {
+            SurfaceInterfacePrivate::get(surface)->addTreeChanges(SubSurfaceTreeChange::Moved);
+        }
     }
 }
 
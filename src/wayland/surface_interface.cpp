@@ -8,23 +8,29 @@
 #include "clientconnection.h"
 #include "compositor_interface.h"
 #include "contenttype_v1_interface.h"
+#include "core/syncobjtimeline.h"
 #include "display.h"
 #include "fractionalscale_v1_interface_p.h"
 #include "idleinhibit_v1_interface_p.h"
+#include "linux_drm_syncobj_v1.h"
 #include "linuxdmabufv1clientbuffer.h"
 #include "output_interface.h"
 #include "pointerconstraints_v1_interface_p.h"
+#include "presentationtime.h"
 #include "region_interface_p.h"
 #include "subcompositor_interface.h"
 #include "subsurface_interface_p.h"
 #include "surface_interface_p.h"
 #include "surfacerole_p.h"
+#include "transaction.h"
 #include "utils.h"
+#include "utils/common.h"
 
 #include <wayland-server.h>
 // std
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 namespace KWaylandServer
 {
@@ -43,7 +49,8 @@ SurfaceInterfacePrivate::SurfaceInterfacePrivate(SurfaceInterface *q)
 {
     wl_list_init(&current.frameCallbacks);
     wl_list_init(&pending.frameCallbacks);
-    wl_list_init(&cached.frameCallbacks);
+    wl_list_init(&current.presentationFeedbacks);
+    wl_list_init(&pending.presentationFeedbacks);
 }
 
 SurfaceInterfacePrivate::~SurfaceInterfacePrivate()
@@ -57,9 +64,8 @@ SurfaceInterfacePrivate::~SurfaceInterfacePrivate()
     wl_resource_for_each_safe (resource, tmp, &pending.frameCallbacks) {
         wl_resource_destroy(resource);
     }
-    wl_resource_for_each_safe (resource, tmp, &cached.frameCallbacks) {
-        wl_resource_destroy(resource);
-    }
+    PresentationTimeFeedback::discard(&current.presentationFeedbacks);
+    PresentationTimeFeedback::discard(&pending.presentationFeedbacks);
 
     if (current.buffer) {
         current.buffer->unref();
@@ -70,13 +76,18 @@ void SurfaceInterfacePrivate::addChild(SubSurfaceInterface *child)
 {
     // protocol is not precise on how to handle the addition of new sub surfaces
     pending.above.append(child);
-    cached.above.append(child);
     current.above.append(child);
+    for (SurfaceState *state : unappliedStates()) {
+        state->above.append(child);
+    }
     child->surface()->setOutputs(outputs);
     child->surface()->setPreferredScale(preferredScale);
 
     Q_EMIT q->childSubSurfaceAdded(child);
     Q_EMIT q->childSubSurfacesChanged();
+
+    addTreeChanges(SubSurfaceTreeChange::Added);
+    flushTreeChanges();
 }
 
 void SurfaceInterfacePrivate::removeChild(SubSurfaceInterface *child)
@@ -84,12 +95,17 @@ void SurfaceInterfacePrivate::removeChild(SubSurfaceInterface *child)
     // protocol is not precise on how to handle the addition of new sub surfaces
     pending.below.removeAll(child);
     pending.above.removeAll(child);
-    cached.below.removeAll(child);
-    cached.above.removeAll(child);
     current.below.removeAll(child);
     current.above.removeAll(child);
+    for (SurfaceState *state : unappliedStates()) {
+        state->below.removeAll(child);
+        state->above.removeAll(child);
+    }
     Q_EMIT q->childSubSurfaceRemoved(child);
     Q_EMIT q->childSubSurfacesChanged();
+
+    addTreeChanges(SubSurfaceTreeChange::Removed);
+    flushTreeChanges();
 }
 
 bool SurfaceInterfacePrivate::raiseChild(SubSurfaceInterface *subsurface, SurfaceInterface *anchor)
@@ -276,6 +292,8 @@ void SurfaceInterfacePrivate::surface_attach(Resource *resource, struct ::wl_res
 void SurfaceInterfacePrivate::surface_damage(Resource *, int32_t x, int32_t y, int32_t width, int32_t height)
 {
     pending.damage |= QRect(x, y, width, height);
+    // don't let clients that send lots of small rectangles build pathological regions
+    pending.damage = KWin::simplifyDamage(pending.damage);
 }
 
 void SurfaceInterfacePrivate::surface_frame(Resource *resource, uint32_t callback)
@@ -312,10 +330,36 @@ void SurfaceInterfacePrivate::surface_set_input_region(Resource *resource, struc
 
 void SurfaceInterfacePrivate::surface_commit(Resource *resource)
 {
-    if (subSurface) {
-        commitSubSurface();
+    if (syncObjV1 && !syncObjV1->maybeEmitProtocolErrors()) {
+        return;
+    }
+
+    // The state of a synchronized subsurface is kept until its parent is committed, the
+    // states of the whole subsurface tree are then applied at once.
+    const bool synchronized = subSurface && subSurface->isSynchronized();
+    Transaction *transaction;
+    if (synchronized) {
+        if (!cachedTransaction) {
+            cachedTransaction = std::make_unique<Transaction>();
+        }
+        transaction = cachedTransaction.get();
     } else {
-        applyState(&pending);
+        transaction = new Transaction();
+    }
+
+    for (const QList<SubSurfaceInterface *> &children : {pending.below, pending.above}) {
+        for (SubSurfaceInterface *subsurface : children) {
+            auto surfacePrivate = SurfaceInterfacePrivate::get(subsurface->surface());
+            if (surfacePrivate->cachedTransaction) {
+                transaction->merge(surfacePrivate->cachedTransaction.get());
+                surfacePrivate->cachedTransaction.reset();
+            }
+        }
+    }
+
+    transaction->add(q);
+    if (!synchronized) {
+        transaction->commit();
     }
 }
 
@@ -342,6 +386,7 @@ void SurfaceInterfacePrivate::surface_set_buffer_scale(Resource *resource, int32
 void SurfaceInterfacePrivate::surface_damage_buffer(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height)
 {
     pending.bufferDamage |= QRect(x, y, width, height);
+    pending.bufferDamage = KWin::simplifyDamage(pending.bufferDamage);
 }
 
 void SurfaceInterfacePrivate::surface_offset(Resource *resource, int32_t x, int32_t y)
@@ -407,6 +452,34 @@ void SurfaceInterface::frameRendered(quint32 msec)
     }
 }
 
+std::unique_ptr<KWin::PresentationFeedback> SurfaceInterface::takePresentationFeedback(KWin::Output *output)
+{
+    OutputInterface *outputInterface = nullptr;
+    for (OutputInterface *candidate : std::as_const(d->outputs)) {
+        if (candidate->handle() == output) {
+            outputInterface = candidate;
+            break;
+        }
+    }
+    auto feedback = std::make_unique<PresentationTimeFeedback>(outputInterface);
+    d->takePresentationFeedback(feedback.get());
+    if (feedback->isEmpty()) {
+        return nullptr;
+    }
+    return feedback;
+}
+
+void SurfaceInterfacePrivate::takePresentationFeedback(PresentationTimeFeedback *feedback)
+{
+    feedback->take(&current.presentationFeedbacks);
+    for (SubSurfaceInterface *subsurface : std::as_const(current.below)) {
+        SurfaceInterfacePrivate::get(subsurface->surface())->takePresentationFeedback(feedback);
+    }
+    for (SubSurfaceInterface *subsurface : std::as_const(current.above)) {
+        SurfaceInterfacePrivate::get(subsurface->surface())->takePresentationFeedback(feedback);
+    }
+}
+
 bool SurfaceInterface::hasFrameCallbacks() const
 {
     return !wl_list_empty(&d->current.frameCallbacks);
@@ -482,11 +555,14 @@ QMatrix4x4 SurfaceInterfacePrivate::buildSurfaceToBufferMatrix()
 void SurfaceState::mergeInto(SurfaceState *target)
 {
     if (bufferIsSet) {
-        target->buffer = buffer;
+        target->buffer = std::move(buffer);
         target->offset = offset;
-        target->damage = damage;
-        target->bufferDamage = bufferDamage;
+        target->damage = std::move(damage);
+        target->bufferDamage = std::move(bufferDamage);
         target->bufferIsSet = bufferIsSet;
+        target->acquirePoint.timeline = std::move(acquirePoint.timeline);
+        target->acquirePoint.point = acquirePoint.point;
+        target->releasePoint = std::move(releasePoint);
     }
     if (viewport.sourceGeometryIsSet) {
         target->viewport.sourceGeometry = viewport.sourceGeometry;
@@ -497,34 +573,38 @@ void SurfaceState::mergeInto(SurfaceState *target)
         target->viewport.destinationSizeIsSet = true;
     }
     if (childrenChanged) {
-        target->below = below;
-        target->above = above;
+        target->below = std::move(below);
+        target->above = std::move(above);
         target->childrenChanged = true;
     }
     wl_list_insert_list(&target->frameCallbacks, &frameCallbacks);
 
+    // the previous content update has been superseded before it got presented
+    PresentationTimeFeedback::discard(&target->presentationFeedbacks);
+    wl_list_insert_list(&target->presentationFeedbacks, &presentationFeedbacks);
+
     if (shadowIsSet) {
-        target->shadow = shadow;
+        target->shadow = std::move(shadow);
         target->shadowIsSet = true;
     }
     if (blurIsSet) {
-        target->blur = blur;
+        target->blur = std::move(blur);
         target->blurIsSet = true;
     }
     if (contrastIsSet) {
-        target->contrast = contrast;
+        target->contrast = std::move(contrast);
         target->contrastIsSet = true;
     }
     if (slideIsSet) {
-        target->slide = slide;
+        target->slide = std::move(slide);
         target->slideIsSet = true;
     }
     if (inputIsSet) {
-        target->input = input;
+        target->input = std::move(input);
         target->inputIsSet = true;
     }
     if (opaqueIsSet) {
-        target->opaque = opaque;
+        target->opaque = std::move(opaque);
         target->opaqueIsSet = true;
     }
     if (bufferScaleIsSet) {
@@ -544,10 +624,12 @@ void SurfaceState::mergeInto(SurfaceState *target)
         target->tearingIsSet = true;
     }
 
+    // the values have been moved rather than copied, resetting the state doesn't allocate
     *this = SurfaceState{};
     below = target->below;
     above = target->above;
     wl_list_init(&frameCallbacks);
+    wl_list_init(&presentationFeedbacks);
 }
 
 void SurfaceInterfacePrivate::applyState(SurfaceState *next)
@@ -664,7 +746,7 @@ void SurfaceInterfacePrivate::applyState(SurfaceState *next)
         if (current.buffer && (!current.damage.isEmpty() || !current.bufferDamage.isEmpty())) {
             const QRegion windowRegion = QRegion(0, 0, q->size().width(), q->size().height());
             const QRegion bufferDamage = q->mapFromBuffer(current.bufferDamage);
-            current.damage = windowRegion.intersected(current.damage.united(bufferDamage));
+            current.damage = KWin::simplifyDamage(windowRegion.intersected(current.damage.united(bufferDamage)));
             Q_EMIT q->damaged(current.damage);
         }
     }
@@ -691,6 +773,20 @@ void SurfaceInterfacePrivate::applyState(SurfaceState *next)
     }
     if (childrenChanged) {
         Q_EMIT q->childSubSurfacesChanged();
+        addTreeChanges(SubSurfaceTreeChange::Restacked);
+    }
+    if (subSurface) {
+        SubSurfaceTreeChanges changes;
+        if (surfaceSize != oldSurfaceSize) {
+            changes |= SubSurfaceTreeChange::Resized;
+        }
+        if (bufferSize != oldBufferSize) {
+            changes |= SubSurfaceTreeChange::BufferSizeChanged;
+        }
+        if (surfaceToBufferMatrix != oldSurfaceToBufferMatrix) {
+            changes |= SubSurfaceTreeChange::SurfaceToBufferMatrixChanged;
+        }
+        addTreeChanges(changes);
     }
     // The position of a sub-surface is applied when its parent is committed.
     for (SubSurfaceInterface *subsurface : std::as_const(current.below)) {
@@ -701,36 +797,54 @@ void SurfaceInterfacePrivate::applyState(SurfaceState *next)
         auto subsurfacePrivate = SubSurfaceInterfacePrivate::get(subsurface);
         subsurfacePrivate->parentCommit();
     }
+    // The sub-surfaces in the same transaction have been applied by now, announce the changes
+    // in the tree once so the role and the scene see the final state.
+    if (!subSurface) {
+        flushTreeChanges();
+    }
     if (role) {
         role->commit();
     }
     Q_EMIT q->committed();
 }
 
-void SurfaceInterfacePrivate::commitSubSurface()
+void SurfaceInterfacePrivate::commitFromCache()
 {
-    if (subSurface->isSynchronized()) {
-        commitToCache();
-    } else {
-        if (hasCacheState) {
-            commitToCache();
-            commitFromCache();
-        } else {
-            applyState(&pending);
+    if (cachedTransaction) {
+        cachedTransaction.release()->commit();
+    }
+
+    // desynchronized subsurfaces have been synchronized only because of this surface
+    for (const QList<SubSurfaceInterface *> &children : {pending.below, pending.above}) {
+        for (SubSurfaceInterface *subsurface : children) {
+            if (subsurface->mode() == SubSurfaceInterface::Mode::Desynchronized) {
+                SurfaceInterfacePrivate::get(subsurface->surface())->commitFromCache();
+            }
         }
     }
 }
 
-void SurfaceInterfacePrivate::commitToCache()
+QList<SurfaceState *> SurfaceInterfacePrivate::unappliedStates()
 {
-    pending.mergeInto(&cached);
-    hasCacheState = true;
-}
+    QList<SurfaceState *> states;
+    for (Transaction *transaction = lastTransaction; transaction;) {
+        TransactionEntry *entry = transaction->entry(q);
+        states.append(entry->state.get());
+        transaction = entry->previousTransaction;
+    }
 
-void SurfaceInterfacePrivate::commitFromCache()
-{
-    applyState(&cached);
-    hasCacheState = false;
+    // the state of a synchronized subsurface may have been merged into the cached
+    // transaction of one of its ancestors
+    for (SurfaceInterface *surface = q; surface;) {
+        SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
+        if (surfacePrivate->cachedTransaction) {
+            if (TransactionEntry *entry = surfacePrivate->cachedTransaction->entry(q)) {
+                states.append(entry->state.get());
+            }
+        }
+        surface = surfacePrivate->subSurface ? surfacePrivate->subSurface->parentSurface() : nullptr;
+    }
+    return states;
 }
 
 bool SurfaceInterfacePrivate::computeEffectiveMapped() const
@@ -759,6 +873,10 @@ void SurfaceInterfacePrivate::updateEffectiveMapped()
         Q_EMIT q->unmapped();
     }
 
+    if (subSurface) {
+        addTreeChanges(mapped ? SubSurfaceTreeChange::Mapped : SubSurfaceTreeChange::Unmapped);
+    }
+
     for (SubSurfaceInterface *subsurface : std::as_const(current.below)) {
         auto surfacePrivate = SurfaceInterfacePrivate::get(subsurface->surface());
         surfacePrivate->updateEffectiveMapped();
@@ -769,6 +887,29 @@ void SurfaceInterfacePrivate::updateEffectiveMapped()
     }
 }
 
+void SurfaceInterfacePrivate::addTreeChanges(SubSurfaceTreeChanges changes)
+{
+    if (!changes) {
+        return;
+    }
+    SurfaceInterface *mainSurface = subSurface ? subSurface->mainSurface() : q;
+    if (mainSurface) {
+        SurfaceInterfacePrivate::get(mainSurface)->treeChanges |= changes;
+    }
+}
+
+void SurfaceInterfacePrivate::flushTreeChanges()
+{
+    SurfaceInterface *mainSurface = subSurface ? subSurface->mainSurface() : q;
+    if (!mainSurface) {
+        return;
+    }
+    SurfaceInterfacePrivate *mainSurfacePrivate = SurfaceInterfacePrivate::get(mainSurface);
+    if (mainSurfacePrivate->treeChanges) {
+        Q_EMIT mainSurface->subSurfaceTreeChanged(std::exchange(mainSurfacePrivate->treeChanges, SubSurfaceTreeChanges()));
+    }
+}
+
 bool SurfaceInterfacePrivate::contains(const QPointF &position) const
 {
     // avoid QRectF::contains as that includes all edges
@@ -1109,6 +1250,21 @@ PresentationHint SurfaceInterface::presentationHint() const
     return d->current.presentationHint;
 }
 
+KWin::SyncTimeline *SurfaceInterface::bufferAcquireTimeline() const
+{
+    return d->current.acquirePoint.timeline.get();
+}
+
+uint64_t SurfaceInterface::bufferAcquirePoint() const
+{
+    return d->current.acquirePoint.point;
+}
+
+std::shared_ptr<KWin::SyncReleasePoint> SurfaceInterface::bufferReleasePoint() const
+{
+    return d->current.releasePoint;
+}
+
 void SurfaceInterface::setPreferredScale(qreal scale)
 {
     if (scale == d->preferredScale) {
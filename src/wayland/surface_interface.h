@@ -13,11 +13,16 @@
 #include <QPointer>
 #include <QRegion>
 
+#include <memory>
+
 struct wl_resource;
 
 namespace KWin
 {
 class GraphicsBuffer;
+class PresentationFeedback;
+class SyncReleasePoint;
+class SyncTimeline;
 }
 
 namespace KWaylandServer
@@ -40,6 +45,50 @@ enum class PresentationHint {
     Async
 };
 
+/**
+ * The SubSurfaceTreeChange type describes what has changed in a sub-surface tree.
+ */
+enum class SubSurfaceTreeChange {
+    /**
+     * A sub-surface has been added to the tree.
+     */
+    Added = 1 << 0,
+    /**
+     * A sub-surface has been removed from the tree.
+     */
+    Removed = 1 << 1,
+    /**
+     * The stacking order of the sub-surfaces of a surface in the tree has changed.
+     */
+    Restacked = 1 << 2,
+    /**
+     * A sub-surface has been moved relative to its parent.
+     */
+    Moved = 1 << 3,
+    /**
+     * A sub-surface has been resized.
+     */
+    Resized = 1 << 4,
+    /**
+     * A sub-surface has been mapped.
+     */
+    Mapped = 1 << 5,
+    /**
+     * A sub-surface has been unmapped.
+     */
+    Unmapped = 1 << 6,
+    /**
+     * The mapping between the surface-local coordinate space and the buffer coordinate
+     * space of a sub-surface has changed.
+     */
+    SurfaceToBufferMatrixChanged = 1 << 7,
+    /**
+     * The buffer size of a sub-surface has changed.
+     */
+    BufferSizeChanged = 1 << 8,
+};
+Q_DECLARE_FLAGS(SubSurfaceTreeChanges, SubSurfaceTreeChange)
+
 /**
  * @brief Resource representing a wl_surface.
  *
@@ -171,6 +220,13 @@ public:
     void frameRendered(quint32 msec);
     bool hasFrameCallbacks() const;
 
+    /**
+     * Takes the presentation feedback of the current content of this surface and its
+     * subsurfaces, to be notified once the frame showing it on @a output is presented.
+     * Returns @c nullptr if no client asked for presentation feedback.
+     */
+    std::unique_ptr<KWin::PresentationFeedback> takePresentationFeedback(KWin::Output *output);
+
     QRegion damage() const;
     QRegion opaque() const;
     QRegion input() const;
@@ -353,6 +409,21 @@ public:
      */
     PresentationHint presentationHint() const;
 
+    /**
+     * @returns the timeline the current buffer has to be waited on with, or @c nullptr if
+     * the client uses implicit synchronization
+     */
+    KWin::SyncTimeline *bufferAcquireTimeline() const;
+    /**
+     * @returns the point on the acquire timeline that signals the buffer is ready to be read
+     */
+    uint64_t bufferAcquirePoint() const;
+    /**
+     * @returns the release point for the current buffer, or @c nullptr if the client
+     * uses implicit synchronization. The point gets signaled once all references to it are dropped
+     */
+    std::shared_ptr<KWin::SyncReleasePoint> bufferReleasePoint() const;
+
     /**
     * Sets a preferred scale that clients should provide buffers in
      * @param scale
@@ -429,6 +500,14 @@ Q_SIGNALS:
      * This signal is emitted when the list of child subsurfaces changes.
      */
     void childSubSurfacesChanged();
+    /**
+     * This signal is emitted when the sub-surface tree of this surface has changed. It's only
+     * emitted for the main surface of the tree. The changes of all sub-surfaces that are applied
+     * together, e.g. in a commit of the main surface, are batched in @p changes.
+     *
+     * The signal is emitted before the role of the main surface handles the commit.
+     */
+    void subSurfaceTreeChanged(KWaylandServer::SubSurfaceTreeChanges changes);
 
     /**
      * Emitted whenever a pointer constraint get (un)installed on this SurfaceInterface.
@@ -463,3 +542,4 @@ private:
 }
 
 Q_DECLARE_METATYPE(KWaylandServer::SurfaceInterface *)
+Q_DECLARE_OPERATORS_FOR_FLAGS(KWaylandServer::SubSurfaceTreeChanges)
@@ -11,6 +11,8 @@
 // Qt
 #include <QHash>
 #include <QVector>
+// std
+#include <memory>
 // Wayland
 #include "qwayland-server-wayland.h"
 
@@ -22,6 +24,9 @@ class ViewportInterface;
 class ContentTypeV1Interface;
 class TearingControlV1Interface;
 class FractionalScaleV1Interface;
+class LinuxDrmSyncObjSurfaceV1;
+class PresentationTimeFeedback;
+class Transaction;
 
 struct SurfaceState
 {
@@ -46,6 +51,7 @@ struct SurfaceState
     qint32 bufferScale = 1;
     KWin::Output::Transform bufferTransform = KWin::Output::Transform::Normal;
     wl_list frameCallbacks;
+    wl_list presentationFeedbacks;
     QPoint offset = QPoint();
     QPointer<KWin::GraphicsBuffer> buffer;
     QPointer<ShadowInterface> shadow;
@@ -68,6 +74,13 @@ struct SurfaceState
         bool sourceGeometryIsSet = false;
         bool destinationSizeIsSet = false;
     } viewport;
+
+    struct
+    {
+        std::shared_ptr<KWin::SyncTimeline> timeline;
+        uint64_t point = 0;
+    } acquirePoint;
+    std::shared_ptr<KWin::SyncReleasePoint> releasePoint;
 };
 
 class SurfaceInterfacePrivate : public QtWaylandServer::wl_surface
@@ -93,16 +106,19 @@ public:
     void installPointerConstraint(ConfinedPointerV1Interface *confinement);
     void installIdleInhibitor(IdleInhibitorV1Interface *inhibitor);
 
-    void commitToCache();
     void commitFromCache();
+    QList<SurfaceState *> unappliedStates();
 
-    void commitSubSurface();
+    void takePresentationFeedback(PresentationTimeFeedback *feedback);
     QMatrix4x4 buildSurfaceToBufferMatrix();
     void applyState(SurfaceState *next);
 
     bool computeEffectiveMapped() const;
     void updateEffectiveMapped();
 
+    void addTreeChanges(SubSurfaceTreeChanges changes);
+    void flushTreeChanges();
+
     /**
      * Returns true if this surface (not including subsurfaces) contains a given point
      * @param position in surface-local co-ordiantes
@@ -115,8 +131,15 @@ public:
     SurfaceRole *role = nullptr;
     SurfaceState current;
     SurfaceState pending;
-    SurfaceState cached;
+    // the state committed while the surface is a synchronized subsurface, it's applied
+    // together with the parent surface
+    std::unique_ptr<Transaction> cachedTransaction;
+    // the last transaction that has been committed but not applied yet
+    Transaction *lastTransaction = nullptr;
     SubSurfaceInterface *subSurface = nullptr;
+    // the changes in the sub-surface tree that haven't been announced yet, only the main
+    // surface of the tree keeps track of them
+    SubSurfaceTreeChanges treeChanges;
     QMatrix4x4 surfaceToBufferMatrix;
     QMatrix4x4 bufferToSurfaceMatrix;
     QSize bufferSize = QSize(0, 0);
@@ -127,7 +150,6 @@ public:
     QRegion opaqueRegion;
     KWin::GraphicsBuffer *bufferRef = nullptr;
     bool mapped = false;
-    bool hasCacheState = false;
     qreal scaleOverride = 1.;
     qreal pendingScaleOverride = 1.;
 
@@ -146,6 +168,7 @@ public:
     FractionalScaleV1Interface *fractionalScaleExtension = nullptr;
     ClientConnection *client = nullptr;
     TearingControlV1Interface *tearing = nullptr;
+    LinuxDrmSyncObjSurfaceV1 *syncObjV1 = nullptr;
 
 protected:
     void surface_destroy_resource(Resource *resource) override;
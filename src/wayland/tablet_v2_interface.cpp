@@ -12,6 +12,9 @@
 #include "qwayland-server-tablet-unstable-v2.h"
 #include <QHash>
 
+#include <optional>
+#include <utility>
+
 namespace KWaylandServer
 {
 static int s_version = 1;
@@ -178,6 +181,9 @@ public:
     void zwp_tablet_tool_v2_destroy_resource(Resource *resource) override
     {
         delete m_cursors.take(resource->handle);
+        if (resource->handle == m_axisResource) {
+            resetAxisState();
+        }
         if (m_removed && resourceMap().isEmpty()) {
             delete q;
         }
@@ -188,8 +194,56 @@ public:
         wl_resource_destroy(resource->handle);
     }
 
+    /**
+     * Returns the resource axis events should be sent to, the cached axis state is dropped
+     * whenever the target changes so the new client gets the full state.
+     */
+    wl_resource *axisTarget()
+    {
+        wl_resource *resource = targetResource();
+        if (resource != m_axisResource) {
+            resetAxisState();
+            m_axisResource = resource;
+        }
+        return resource;
+    }
+
+    void resetAxisState()
+    {
+        m_axisResource = nullptr;
+        m_lastMotion.reset();
+        m_lastPressure.reset();
+        m_lastDistance.reset();
+        m_lastTilt.reset();
+        m_lastRotation.reset();
+        m_lastSlider.reset();
+    }
+
+    /**
+     * Updates the cached value of an axis and returns whether it differs from what the client
+     * has been sent already.
+     */
+    template<typename T>
+    static bool updateAxis(std::optional<T> &last, const T &value)
+    {
+        if (last == value) {
+            return false;
+        }
+        last = value;
+        return true;
+    }
+
     Display *const m_display;
     bool m_cleanup = false;
+    // whether anything was sent since the last frame event
+    bool m_frameHasEvents = false;
+    wl_resource *m_axisResource = nullptr;
+    std::optional<std::pair<wl_fixed_t, wl_fixed_t>> m_lastMotion;
+    std::optional<uint32_t> m_lastPressure;
+    std::optional<uint32_t> m_lastDistance;
+    std::optional<std::pair<wl_fixed_t, wl_fixed_t>> m_lastTilt;
+    std::optional<wl_fixed_t> m_lastRotation;
+    std::optional<int32_t> m_lastSlider;
     bool m_removed = false;
     QPointer<SurfaceInterface> m_surface;
     QPointer<TabletV2Interface> m_lastTablet;
@@ -258,22 +312,36 @@ void TabletToolV2Interface::sendButton(uint32_t button, bool pressed)
                    d->m_display->nextSerial(),
                    button,
                    pressed ? QtWaylandServer::zwp_tablet_tool_v2::button_state_pressed : QtWaylandServer::zwp_tablet_tool_v2::button_state_released);
+    d->m_frameHasEvents = true;
 }
 
 void TabletToolV2Interface::sendMotion(const QPointF &pos)
 {
     const QPointF surfacePos = d->m_surface->toSurfaceLocal(pos);
-    d->send_motion(d->targetResource(), wl_fixed_from_double(surfacePos.x()), wl_fixed_from_double(surfacePos.y()));
+    const auto motion = std::make_pair(wl_fixed_from_double(surfacePos.x()), wl_fixed_from_double(surfacePos.y()));
+    wl_resource *resource = d->axisTarget();
+    if (d->updateAxis(d->m_lastMotion, motion)) {
+        d->send_motion(resource, motion.first, motion.second);
+        d->m_frameHasEvents = true;
+    }
 }
 
 void TabletToolV2Interface::sendDistance(uint32_t distance)
 {
-    d->send_distance(d->targetResource(), distance);
+    wl_resource *resource = d->axisTarget();
+    if (d->updateAxis(d->m_lastDistance, distance)) {
+        d->send_distance(resource, distance);
+        d->m_frameHasEvents = true;
+    }
 }
 
 void TabletToolV2Interface::sendFrame(uint32_t time)
 {
-    d->send_frame(d->targetResource(), time);
+    // a frame is only needed if it terminates at least one event, skipped axis updates don't count
+    if (d->m_frameHasEvents) {
+        d->send_frame(d->targetResource(), time);
+        d->m_frameHasEvents = false;
+    }
 
     if (d->m_cleanup) {
         d->m_surface = nullptr;
@@ -284,27 +352,46 @@ void TabletToolV2Interface::sendFrame(uint32_t time)
 
 void TabletToolV2Interface::sendPressure(uint32_t pressure)
 {
-    d->send_pressure(d->targetResource(), pressure);
+    wl_resource *resource = d->axisTarget();
+    if (d->updateAxis(d->m_lastPressure, pressure)) {
+        d->send_pressure(resource, pressure);
+        d->m_frameHasEvents = true;
+    }
 }
 
 void TabletToolV2Interface::sendRotation(qreal rotation)
 {
-    d->send_rotation(d->targetResource(), wl_fixed_from_double(rotation));
+    const wl_fixed_t degrees = wl_fixed_from_double(rotation);
+    wl_resource *resource = d->axisTarget();
+    if (d->updateAxis(d->m_lastRotation, degrees)) {
+        d->send_rotation(resource, degrees);
+        d->m_frameHasEvents = true;
+    }
 }
 
 void TabletToolV2Interface::sendSlider(int32_t position)
 {
-    d->send_slider(d->targetResource(), position);
+    wl_resource *resource = d->axisTarget();
+    if (d->updateAxis(d->m_lastSlider, position)) {
+        d->send_slider(resource, position);
+        d->m_frameHasEvents = true;
+    }
 }
 
 void TabletToolV2Interface::sendTilt(qreal degreesX, qreal degreesY)
 {
-    d->send_tilt(d->targetResource(), wl_fixed_from_double(degreesX), wl_fixed_from_double(degreesY));
+    const auto tilt = std::make_pair(wl_fixed_from_double(degreesX), wl_fixed_from_double(degreesY));
+    wl_resource *resource = d->axisTarget();
+    if (d->updateAxis(d->m_lastTilt, tilt)) {
+        d->send_tilt(resource, tilt.first, tilt.second);
+        d->m_frameHasEvents = true;
+    }
 }
 
 void TabletToolV2Interface::sendWheel(int32_t degrees, int32_t clicks)
 {
     d->send_wheel(d->targetResource(), degrees, clicks);
+    d->m_frameHasEvents = true;
 }
 
 void TabletToolV2Interface::sendProximityIn(TabletV2Interface *tablet)
@@ -312,22 +399,29 @@ void TabletToolV2Interface::sendProximityIn(TabletV2Interface *tablet)
     wl_resource *tabletResource = tablet->d->resourceForSurface(d->m_surface);
     d->send_proximity_in(d->targetResource(), d->m_display->nextSerial(), tabletResource, d->m_surface->resource());
     d->m_lastTablet = tablet;
+    d->m_frameHasEvents = true;
+    // the client forgets the axis state between proximity out and in
+    d->resetAxisState();
 }
 
 void TabletToolV2Interface::sendProximityOut()
 {
     d->send_proximity_out(d->targetResource());
     d->m_cleanup = true;
+    d->m_frameHasEvents = true;
+    d->resetAxisState();
 }
 
 void TabletToolV2Interface::sendDown()
 {
     d->send_down(d->targetResource(), d->m_display->nextSerial());
+    d->m_frameHasEvents = true;
 }
 
 void TabletToolV2Interface::sendUp()
 {
     d->send_up(d->targetResource());
+    d->m_frameHasEvents = true;
 }
 
 class TabletPadRingV2InterfacePrivate : public QtWaylandServer::zwp_tablet_pad_ring_v2
@@ -0,0 +1,610 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "KWayland/Client/compositor.h"
+#include "KWayland/Client/connection_thread.h"
+#include "KWayland/Client/datadevice.h"
+#include "KWayland/Client/datadevicemanager.h"
+#include "KWayland/Client/dataoffer.h"
+#include "KWayland/Client/datasource.h"
+#include "KWayland/Client/event_queue.h"
+#include "KWayland/Client/fakeinput.h"
+#include "KWayland/Client/keyboard.h"
+#include "KWayland/Client/registry.h"
+#include "KWayland/Client/seat.h"
+#include "KWayland/Client/shm_pool.h"
+#include "KWayland/Client/subcompositor.h"
+#include "KWayland/Client/subsurface.h"
+#include "KWayland/Client/surface.h"
+#include "KWayland/Client/xdgshell.h"
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QRandomGenerator>
+#include <QSocketNotifier>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+// system
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <wayland-client-protocol.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace KWayland::Client;
+using namespace std::chrono_literals;
+
+enum class DamagePattern {
+    Full,
+    Partial,
+    Scattered,
+};
+
+struct LoadOptions
+{
+    int clients = 10;
+    int commitRate = 60;
+    QSize size = QSize(256, 256);
+    DamagePattern damage = DamagePattern::Full;
+    int subsurfaceDepth = 0;
+    int inputRate = 0;
+    int clipboardRate = 0;
+    int clipboardSize = 4096;
+};
+
+/**
+ * A list of durations, in the order they were measured.
+ */
+class Samples
+{
+public:
+    void add(std::chrono::nanoseconds sample)
+    {
+        m_samples.push_back(sample);
+    }
+
+    void append(const Samples &other)
+    {
+        m_samples.insert(m_samples.end(), other.m_samples.begin(), other.m_samples.end());
+    }
+
+    int count() const
+    {
+        return m_samples.size();
+    }
+
+    QString summary() const
+    {
+        if (m_samples.empty()) {
+            return QStringLiteral("no samples");
+        }
+        std::vector<std::chrono::nanoseconds> sorted = m_samples;
+        std::sort(sorted.begin(), sorted.end());
+        const auto percentile = [&sorted](qreal p) {
+            const size_t index = std::min(sorted.size() - 1, size_t(p / 100 * sorted.size()));
+            return std::chrono::duration<qreal, std::milli>(sorted[index]).count();
+        };
+        return QStringLiteral("%1 samples, p50 %2 ms, p90 %3 ms, p99 %4 ms, max %5 ms")
+            .arg(sorted.size())
+            .arg(percentile(50), 0, 'f', 3)
+            .arg(percentile(90), 0, 'f', 3)
+            .arg(percentile(99), 0, 'f', 3)
+            .arg(std::chrono::duration<qreal, std::milli>(sorted.back()).count(), 0, 'f', 3);
+    }
+
+private:
+    std::vector<std::chrono::nanoseconds> m_samples;
+};
+
+struct Statistics
+{
+    int commits = 0;
+    int throttledCommits = 0;
+    int inputEvents = 0;
+    int clipboardTransfers = 0;
+    // from a commit until the compositor asks for the next frame
+    Samples frameLatency;
+    // how long it takes the compositor to dispatch a wl_display.sync request
+    Samples roundtripLatency;
+    // from setting the selection until its data has been read
+    Samples clipboardLatency;
+
+    void append(const Statistics &other)
+    {
+        commits += other.commits;
+        throttledCommits += other.throttledCommits;
+        inputEvents += other.inputEvents;
+        clipboardTransfers += other.clipboardTransfers;
+        frameLatency.append(other.frameLatency);
+        roundtripLatency.append(other.roundtripLatency);
+        clipboardLatency.append(other.clipboardLatency);
+    }
+};
+
+/**
+ * A client with its own connection that commits buffers to a toplevel surface and its
+ * subsurfaces at a fixed rate.
+ */
+class LoadClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    LoadClient(int index, const LoadOptions &options, QObject *parent = nullptr);
+    ~LoadClient() override;
+
+    void init();
+    void stop();
+    const Statistics &statistics() const;
+
+Q_SIGNALS:
+    void ready();
+
+private:
+    void setupRegistry(Registry *registry);
+    void createSurfaces();
+    void commit();
+    void sendInput();
+    void sync();
+    void setSelection();
+    void receiveSelection(DataOffer *offer);
+    void sendSelection(const QString &mimeType, qint32 fd);
+    QRegion nextDamage();
+
+    static void syncDone(void *data, wl_callback *callback, uint32_t time);
+    static const wl_callback_listener s_syncListener;
+
+    const int m_index;
+    const LoadOptions m_options;
+    QThread *m_connectionThread;
+    ConnectionThread *m_connectionThreadObject;
+    EventQueue *m_eventQueue = nullptr;
+    Compositor *m_compositor = nullptr;
+    SubCompositor *m_subCompositor = nullptr;
+    XdgShell *m_xdgShell = nullptr;
+    ShmPool *m_shm = nullptr;
+    Seat *m_seat = nullptr;
+    Keyboard *m_keyboard = nullptr;
+    FakeInput *m_fakeInput = nullptr;
+    DataDeviceManager *m_dataDeviceManager = nullptr;
+    DataDevice *m_dataDevice = nullptr;
+    DataSource *m_dataSource = nullptr;
+    Surface *m_surface = nullptr;
+    XdgShellSurface *m_shellSurface = nullptr;
+    std::vector<Surface *> m_subsurfaces;
+    QTimer m_commitTimer;
+    QTimer m_inputTimer;
+    QTimer m_syncTimer;
+    QTimer m_clipboardTimer;
+    QElapsedTimer m_clock;
+    std::chrono::nanoseconds m_commitTimestamp = 0ns;
+    std::chrono::nanoseconds m_syncTimestamp = 0ns;
+    std::chrono::nanoseconds m_selectionTimestamp = 0ns;
+    bool m_framePending = false;
+    bool m_syncPending = false;
+    quint32 m_keyboardSerial = 0;
+    int m_frame = 0;
+    QByteArray m_clipboardData;
+    Statistics m_statistics;
+};
+
+const wl_callback_listener LoadClient::s_syncListener = {
+    .done = LoadClient::syncDone,
+};
+
+LoadClient::LoadClient(int index, const LoadOptions &options, QObject *parent)
+    : QObject(parent)
+    , m_index(index)
+    , m_options(options)
+    , m_connectionThread(new QThread(this))
+    , m_connectionThreadObject(new ConnectionThread())
+    , m_clipboardData(options.clipboardSize, 'x')
+{
+    m_clock.start();
+
+    connect(&m_commitTimer, &QTimer::timeout, this, &LoadClient::commit);
+    m_commitTimer.setTimerType(Qt::PreciseTimer);
+    m_commitTimer.setInterval(std::chrono::milliseconds(1000 / std::max(1, options.commitRate)));
+
+    connect(&m_inputTimer, &QTimer::timeout, this, &LoadClient::sendInput);
+    m_inputTimer.setTimerType(Qt::PreciseTimer);
+    m_inputTimer.setInterval(std::chrono::milliseconds(1000 / std::max(1, options.inputRate)));
+
+    connect(&m_clipboardTimer, &QTimer::timeout, this, &LoadClient::setSelection);
+    m_clipboardTimer.setInterval(std::chrono::milliseconds(1000 / std::max(1, options.clipboardRate)));
+
+    connect(&m_syncTimer, &QTimer::timeout, this, &LoadClient::sync);
+    m_syncTimer.setInterval(100ms);
+}
+
+LoadClient::~LoadClient()
+{
+    m_connectionThread->quit();
+    m_connectionThread->wait();
+
+    // the wayland objects have to go away before the connection they belong to, the event
+    // queue was created first, so it's destroyed last
+    const QObjectList children = this->children();
+    for (auto it = children.crbegin(); it != children.crend(); ++it) {
+        if (*it != m_connectionThread) {
+            delete *it;
+        }
+    }
+    // the thread has finished, so a deleteLater() would never be processed
+    delete m_connectionThreadObject;
+}
+
+const Statistics &LoadClient::statistics() const
+{
+    return m_statistics;
+}
+
+void LoadClient::init()
+{
+    connect(
+        m_connectionThreadObject,
+        &ConnectionThread::connected,
+        this,
+        [this] {
+            m_eventQueue = new EventQueue(this);
+            m_eventQueue->setup(m_connectionThreadObject);
+
+            Registry *registry = new Registry(this);
+            setupRegistry(registry);
+        },
+        Qt::QueuedConnection);
+    connect(
+        m_connectionThreadObject,
+        &ConnectionThread::failed,
+        this,
+        [this] {
+            qFatal("Client %d failed to connect to the compositor", m_index);
+        },
+        Qt::QueuedConnection);
+    m_connectionThreadObject->moveToThread(m_connectionThread);
+    m_connectionThread->start();
+
+    m_connectionThreadObject->initConnection();
+}
+
+void LoadClient::stop()
+{
+    m_commitTimer.stop();
+    m_inputTimer.stop();
+    m_syncTimer.stop();
+    m_clipboardTimer.stop();
+}
+
+void LoadClient::setupRegistry(Registry *registry)
+{
+    connect(registry, &Registry::compositorAnnounced, this, [this, registry](quint32 name, quint32 version) {
+        m_compositor = registry->createCompositor(name, version, this);
+    });
+    connect(registry, &Registry::subCompositorAnnounced, this, [this, registry](quint32 name, quint32 version) {
+        m_subCompositor = registry->createSubCompositor(name, version, this);
+    });
+    connect(registry, &Registry::xdgShellStableAnnounced, this, [this, registry](quint32 name, quint32 version) {
+        m_xdgShell = registry->createXdgShell(name, version, this);
+    });
+    connect(registry, &Registry::shmAnnounced, this, [this, registry](quint32 name, quint32 version) {
+        m_shm = registry->createShmPool(name, version, this);
+    });
+    connect(registry, &Registry::seatAnnounced, this, [this, registry](quint32 name, quint32 version) {
+        m_seat = registry->createSeat(name, version, this);
+    });
+    connect(registry, &Registry::fakeInputAnnounced, this, [this, registry](quint32 name, quint32 version) {
+        m_fakeInput = registry->createFakeInput(name, version, this);
+    });
+    connect(registry, &Registry::dataDeviceManagerAnnounced, this, [this, registry](quint32 name, quint32 version) {
+        m_dataDeviceManager = registry->createDataDeviceManager(name, version, this);
+    });
+    connect(registry, &Registry::interfacesAnnounced, this, [this] {
+        if (!m_compositor || !m_xdgShell || !m_shm) {
+            qFatal("The compositor doesn't support wl_compositor, xdg_wm_base or wl_shm");
+        }
+        if (m_options.subsurfaceDepth && !m_subCompositor) {
+            qFatal("The compositor doesn't support wl_subcompositor");
+        }
+        if (m_options.inputRate && !m_fakeInput) {
+            qFatal("The compositor doesn't support org_kde_kwin_fake_input");
+        }
+        if (m_options.clipboardRate && (!m_dataDeviceManager || !m_seat)) {
+            qFatal("The compositor doesn't support wl_data_device_manager or wl_seat");
+        }
+        createSurfaces();
+    });
+    registry->setEventQueue(m_eventQueue);
+    registry->create(m_connectionThreadObject);
+    registry->setup();
+}
+
+void LoadClient::createSurfaces()
+{
+    m_surface = m_compositor->createSurface(this);
+    connect(m_surface, &Surface::frameRendered, this, [this]() {
+        m_framePending = false;
+        m_statistics.frameLatency.add(std::chrono::nanoseconds(m_clock.nsecsElapsed()) - m_commitTimestamp);
+    });
+
+    m_shellSurface = m_xdgShell->createSurface(m_surface, this);
+    m_shellSurface->setTitle(QStringLiteral("load generator %1").arg(m_index));
+    connect(m_shellSurface, &XdgShellSurface::configureRequested, this, [this](const QSize &size, XdgShellSurface::States states, quint32 serial) {
+        m_shellSurface->ackConfigure(serial);
+        if (!m_commitTimer.isActive()) {
+            m_commitTimer.start();
+            m_syncTimer.start();
+            if (m_options.inputRate) {
+                m_inputTimer.start();
+            }
+            commit();
+            Q_EMIT ready();
+        }
+    });
+
+    // every subsurface is the child of the previous one, they are offset so all of them are visible
+    Surface *parent = m_surface;
+    for (int i = 0; i < m_options.subsurfaceDepth; ++i) {
+        Surface *surface = m_compositor->createSurface(this);
+        SubSurface *subsurface = m_subCompositor->createSubSurface(surface, parent, this);
+        subsurface->setPosition(QPoint(8, 8));
+        subsurface->setMode(SubSurface::Mode::Desynchronized);
+        m_subsurfaces.push_back(surface);
+        parent = surface;
+    }
+
+    if (m_options.clipboardRate) {
+        m_keyboard = m_seat->createKeyboard(this);
+        connect(m_keyboard, &Keyboard::entered, this, [this](quint32 serial) {
+            m_keyboardSerial = serial;
+            m_clipboardTimer.start();
+        });
+        connect(m_keyboard, &Keyboard::left, this, [this]() {
+            m_clipboardTimer.stop();
+        });
+
+        m_dataDevice = m_dataDeviceManager->getDataDevice(m_seat, this);
+        connect(m_dataDevice, &DataDevice::selectionOffered, this, &LoadClient::receiveSelection);
+    }
+
+    m_surface->commit(Surface::CommitFlag::None);
+}
+
+QRegion LoadClient::nextDamage()
+{
+    const QRect rect(QPoint(0, 0), m_options.size);
+    switch (m_options.damage) {
+    case DamagePattern::Full:
+        return rect;
+    case DamagePattern::Partial: {
+        // a band that sweeps across the surface, like a progress bar or a blinking cursor
+        const int width = std::max(1, rect.width() / 8);
+        return QRect((m_frame * width) % rect.width(), 0, width, rect.height());
+    }
+    case DamagePattern::Scattered: {
+        QRegion region;
+        QRandomGenerator *generator = QRandomGenerator::global();
+        for (int i = 0; i < 16; ++i) {
+            region += QRect(generator->bounded(rect.width()), generator->bounded(rect.height()), 8, 8);
+        }
+        return region & rect;
+    }
+    }
+    Q_UNREACHABLE();
+}
+
+void LoadClient::commit()
+{
+    if (m_framePending) {
+        // the compositor hasn't caught up yet
+        m_statistics.throttledCommits++;
+        return;
+    }
+
+    const QRegion damage = nextDamage();
+    const QColor color = QColor::fromHsv((m_index * 36 + m_frame) % 360, 255, 255);
+    const auto paint = [this, &damage, &color](Surface *surface, const QSize &size) {
+        auto buffer = m_shm->getBuffer(size, size.width() * 4).toStrongRef();
+        buffer->setUsed(true);
+        QImage image(buffer->address(), size.width(), size.height(), QImage::Format_ARGB32_Premultiplied);
+        image.fill(color);
+        surface->attachBuffer(*buffer);
+        surface->damageBuffer(damage);
+        buffer->setUsed(false);
+    };
+
+    for (Surface *subsurface : m_subsurfaces) {
+        paint(subsurface, m_options.size / 2);
+        subsurface->commit(Surface::CommitFlag::None);
+    }
+    paint(m_surface, m_options.size);
+    m_surface->commit(Surface::CommitFlag::FrameCallback);
+
+    m_commitTimestamp = std::chrono::nanoseconds(m_clock.nsecsElapsed());
+    m_framePending = true;
+    m_statistics.commits++;
+    m_frame++;
+}
+
+void LoadClient::sendInput()
+{
+    if (!m_fakeInput->isValid()) {
+        return;
+    }
+    if (m_statistics.inputEvents == 0) {
+        m_fakeInput->authenticate(QStringLiteral("Load generator"), QStringLiteral("Stress testing"));
+    }
+    // wiggle the pointer around so it stays in the same spot
+    const qreal delta = m_statistics.inputEvents % 2 ? 1 : -1;
+    m_fakeInput->requestPointerMove(QSizeF(delta, delta));
+    m_statistics.inputEvents++;
+}
+
+void LoadClient::sync()
+{
+    if (m_syncPending) {
+        return;
+    }
+    wl_callback *callback = wl_display_sync(m_connectionThreadObject->display());
+    m_eventQueue->addProxy(callback);
+    wl_callback_add_listener(callback, &s_syncListener, this);
+    m_connectionThreadObject->flush();
+    m_syncTimestamp = std::chrono::nanoseconds(m_clock.nsecsElapsed());
+    m_syncPending = true;
+}
+
+void LoadClient::syncDone(void *data, wl_callback *callback, uint32_t time)
+{
+    auto client = static_cast<LoadClient *>(data);
+    client->m_syncPending = false;
+    client->m_statistics.roundtripLatency.add(std::chrono::nanoseconds(client->m_clock.nsecsElapsed()) - client->m_syncTimestamp);
+    wl_callback_destroy(callback);
+}
+
+void LoadClient::setSelection()
+{
+    if (m_dataSource) {
+        // the previous transfer hasn't finished yet
+        return;
+    }
+    m_dataSource = m_dataDeviceManager->createDataSource(this);
+    m_dataSource->offer(QStringLiteral("text/plain"));
+    connect(m_dataSource, &DataSource::sendDataRequested, this, &LoadClient::sendSelection);
+    m_dataDevice->setSelection(m_keyboardSerial, m_dataSource);
+    m_selectionTimestamp = std::chrono::nanoseconds(m_clock.nsecsElapsed());
+}
+
+void LoadClient::sendSelection(const QString &mimeType, qint32 fd)
+{
+    // the data is smaller than the pipe buffer by default, so it can be written right away
+    qsizetype written = 0;
+    while (written < m_clipboardData.size()) {
+        const ssize_t result = write(fd, m_clipboardData.constData() + written, m_clipboardData.size() - written);
+        if (result < 0) {
+            break;
+        }
+        written += result;
+    }
+    close(fd);
+}
+
+void LoadClient::receiveSelection(DataOffer *offer)
+{
+    if (!m_dataSource) {
+        return;
+    }
+
+    int pipeFds[2];
+    if (pipe2(pipeFds, O_CLOEXEC | O_NONBLOCK) != 0) {
+        return;
+    }
+    offer->receive(QStringLiteral("text/plain"), pipeFds[1]);
+    close(pipeFds[1]);
+    m_connectionThreadObject->flush();
+
+    auto notifier = new QSocketNotifier(pipeFds[0], QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, [this, notifier]() {
+        char buffer[4096];
+        const ssize_t result = read(notifier->socket(), buffer, sizeof(buffer));
+        if (result > 0 || (result < 0 && errno == EAGAIN)) {
+            return;
+        }
+        close(notifier->socket());
+        notifier->deleteLater();
+
+        m_statistics.clipboardTransfers++;
+        m_statistics.clipboardLatency.add(std::chrono::nanoseconds(m_clock.nsecsElapsed()) - m_selectionTimestamp);
+        m_dataSource->deleteLater();
+        m_dataSource = nullptr;
+    });
+}
+
+static DamagePattern parseDamagePattern(const QString &name)
+{
+    if (name == QLatin1String("partial")) {
+        return DamagePattern::Partial;
+    } else if (name == QLatin1String("scattered")) {
+        return DamagePattern::Scattered;
+    }
+    return DamagePattern::Full;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Connects many clients to a Wayland compositor and reports how fast the compositor keeps up with them."));
+    parser.addHelpOption();
+    const QCommandLineOption clientsOption(QStringLiteral("clients"), QStringLiteral("The number of clients."), QStringLiteral("count"), QStringLiteral("10"));
+    const QCommandLineOption rateOption(QStringLiteral("rate"), QStringLiteral("How many times per second each client commits."), QStringLiteral("hz"), QStringLiteral("60"));
+    const QCommandLineOption sizeOption(QStringLiteral("size"), QStringLiteral("The size of the surfaces."), QStringLiteral("widthxheight"), QStringLiteral("256x256"));
+    const QCommandLineOption damageOption(QStringLiteral("damage"), QStringLiteral("The damage pattern: full, partial or scattered."), QStringLiteral("pattern"), QStringLiteral("full"));
+    const QCommandLineOption subsurfacesOption(QStringLiteral("subsurfaces"), QStringLiteral("The depth of the subsurface tree of each client."), QStringLiteral("depth"), QStringLiteral("0"));
+    const QCommandLineOption inputOption(QStringLiteral("input"), QStringLiteral("How many fake pointer events per second each client sends."), QStringLiteral("hz"), QStringLiteral("0"));
+    const QCommandLineOption clipboardOption(QStringLiteral("clipboard"), QStringLiteral("How many times per second the focused client sets the selection and reads it back."), QStringLiteral("hz"), QStringLiteral("0"));
+    const QCommandLineOption clipboardSizeOption(QStringLiteral("clipboard-size"), QStringLiteral("The size of the selection data in bytes."), QStringLiteral("bytes"), QStringLiteral("4096"));
+    const QCommandLineOption durationOption(QStringLiteral("duration"), QStringLiteral("How long to run, in seconds."), QStringLiteral("seconds"), QStringLiteral("10"));
+    parser.addOptions({clientsOption, rateOption, sizeOption, damageOption, subsurfacesOption, inputOption, clipboardOption, clipboardSizeOption, durationOption});
+    parser.process(app);
+
+    LoadOptions options;
+    options.clients = std::max(1, parser.value(clientsOption).toInt());
+    options.commitRate = parser.value(rateOption).toInt();
+    const QStringList size = parser.value(sizeOption).split(QLatin1Char('x'));
+    if (size.count() == 2) {
+        options.size = QSize(size[0].toInt(), size[1].toInt()).expandedTo(QSize(16, 16));
+    }
+    options.damage = parseDamagePattern(parser.value(damageOption));
+    options.subsurfaceDepth = parser.value(subsurfacesOption).toInt();
+    options.inputRate = parser.value(inputOption).toInt();
+    options.clipboardRate = parser.value(clipboardOption).toInt();
+    options.clipboardSize = parser.value(clipboardSizeOption).toInt();
+    const int duration = parser.value(durationOption).toInt();
+
+    std::vector<std::unique_ptr<LoadClient>> clients;
+    int readyCount = 0;
+    for (int i = 0; i < options.clients; ++i) {
+        auto client = std::make_unique<LoadClient>(i, options);
+        QObject::connect(client.get(), &LoadClient::ready, &app, [&]() {
+            // the measurement starts once all clients are mapped
+            if (++readyCount == options.clients) {
+                QTimer::singleShot(std::chrono::seconds(duration), &app, &QCoreApplication::quit);
+            }
+        });
+        client->init();
+        clients.push_back(std::move(client));
+    }
+
+    app.exec();
+
+    Statistics total;
+    for (const auto &client : clients) {
+        client->stop();
+        total.append(client->statistics());
+    }
+
+    QTextStream out(stdout);
+    out << "clients: " << options.clients << ", duration: " << duration << " s\n";
+    out << "commits: " << total.commits << " (" << qreal(total.commits) / std::max(1, duration) << " per second)"
+        << ", throttled: " << total.throttledCommits << "\n";
+    out << "commit to frame callback: " << total.frameLatency.summary() << "\n";
+    out << "wl_display.sync roundtrip: " << total.roundtripLatency.summary() << "\n";
+    if (options.inputRate) {
+        out << "input events: " << total.inputEvents << "\n";
+    }
+    if (options.clipboardRate) {
+        out << "clipboard transfers: " << total.clipboardTransfers << ", " << total.clipboardLatency.summary() << "\n";
+    }
+
+    return 0;
+}
+
+#include "loadgenerator.moc"
@@ -0,0 +1,309 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "transaction.h"
+#include "core/graphicsbuffer.h"
+#include "core/syncobjtimeline.h"
+#include "presentationtime.h"
+#include "subcompositor_interface.h"
+#include "surface_interface_p.h"
+
+#include <QSocketNotifier>
+
+#include <wayland-server.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <linux/dma-buf.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+
+#ifndef DMA_BUF_IOCTL_EXPORT_SYNC_FILE
+struct dma_buf_export_sync_file
+{
+    __u32 flags;
+    __s32 fd;
+};
+#define DMA_BUF_IOCTL_EXPORT_SYNC_FILE _IOWR(DMA_BUF_BASE, 2, struct dma_buf_export_sync_file)
+#endif
+
+namespace KWaylandServer
+{
+
+/**
+ * The TransactionFence class keeps a transaction locked until a fence is signaled.
+ */
+class TransactionFence
+{
+public:
+    TransactionFence(Transaction *transaction, KWin::FileDescriptor &&fence)
+        : m_fence(std::move(fence))
+        , m_notifier(m_fence.get(), QSocketNotifier::Read)
+    {
+        transaction->lock();
+        QObject::connect(&m_notifier, &QSocketNotifier::activated, &m_notifier, [this, transaction]() {
+            m_notifier.setEnabled(false);
+            // unlocking can apply the transaction, which destroys this fence
+            QMetaObject::invokeMethod(
+                &m_notifier, [transaction]() {
+                    transaction->unlock();
+                },
+                Qt::QueuedConnection);
+        });
+    }
+
+private:
+    KWin::FileDescriptor m_fence;
+    QSocketNotifier m_notifier;
+};
+
+/**
+ * Returns a fence that is signaled once all rendering commands writing to the dmabuf
+ * @a fd have finished. With older kernels that can't export the fence as a sync file,
+ * the dmabuf itself is polled instead, it becomes readable at the same time.
+ */
+static KWin::FileDescriptor exportReadFence(const KWin::FileDescriptor &fd)
+{
+    dma_buf_export_sync_file request{
+        .flags = DMA_BUF_SYNC_READ,
+        .fd = -1,
+    };
+    if (ioctl(fd.get(), DMA_BUF_IOCTL_EXPORT_SYNC_FILE, &request) == 0) {
+        return KWin::FileDescriptor(request.fd);
+    }
+    if (errno == ENOTTY) {
+        return fd.duplicate();
+    }
+    return KWin::FileDescriptor{};
+}
+
+static bool isSignaled(const KWin::FileDescriptor &fence)
+{
+    pollfd pfd{
+        .fd = fence.get(),
+        .events = POLLIN,
+        .revents = 0,
+    };
+    return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+static int surfaceDepth(SurfaceInterface *surface)
+{
+    int depth = 0;
+    for (SubSurfaceInterface *subsurface = surface->subSurface(); subsurface && subsurface->parentSurface(); subsurface = subsurface->parentSurface()->subSurface()) {
+        depth++;
+    }
+    return depth;
+}
+
+Transaction::Transaction()
+{
+}
+
+Transaction::~Transaction()
+{
+    // applied states are empty, only the states that have been dropped still hold resources
+    for (TransactionEntry &entry : m_entries) {
+        wl_resource *resource;
+        wl_resource *tmp;
+        wl_resource_for_each_safe (resource, tmp, &entry.state->frameCallbacks) {
+            wl_resource_destroy(resource);
+        }
+        PresentationTimeFeedback::discard(&entry.state->presentationFeedbacks);
+    }
+}
+
+void Transaction::lock()
+{
+    m_locks++;
+}
+
+void Transaction::unlock()
+{
+    Q_ASSERT(m_locks > 0);
+    m_locks--;
+    tryApply();
+}
+
+void Transaction::add(SurfaceInterface *surface)
+{
+    SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
+    if (TransactionEntry *existing = entry(surface)) {
+        surfacePrivate->pending.mergeInto(existing->state.get());
+        return;
+    }
+
+    auto state = std::make_unique<SurfaceState>();
+    wl_list_init(&state->frameCallbacks);
+    wl_list_init(&state->presentationFeedbacks);
+    // mergeInto() copies the child lists only if they have changed, they must be valid regardless
+    state->below = surfacePrivate->pending.below;
+    state->above = surfacePrivate->pending.above;
+    surfacePrivate->pending.mergeInto(state.get());
+
+    m_entries.push_back(TransactionEntry{
+        .surface = surface,
+        .state = std::move(state),
+    });
+}
+
+void Transaction::merge(Transaction *other)
+{
+    Q_ASSERT(!m_committed && !other->m_committed);
+    for (TransactionEntry &otherEntry : other->m_entries) {
+        TransactionEntry *existing = otherEntry.surface ? entry(otherEntry.surface) : nullptr;
+        if (existing) {
+            otherEntry.state->mergeInto(existing->state.get());
+        } else {
+            m_entries.push_back(std::move(otherEntry));
+        }
+    }
+    // the merged states are empty now, so destroying them doesn't touch any resources
+    other->m_entries.clear();
+}
+
+TransactionEntry *Transaction::entry(SurfaceInterface *surface)
+{
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [surface](const TransactionEntry &entry) {
+        return entry.surface == surface;
+    });
+    return it != m_entries.end() ? &*it : nullptr;
+}
+
+bool Transaction::isEmpty() const
+{
+    return m_entries.empty();
+}
+
+void Transaction::commit()
+{
+    Q_ASSERT(!m_committed);
+    for (TransactionEntry &entry : m_entries) {
+        if (!entry.surface) {
+            continue;
+        }
+        SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(entry.surface);
+        if (surfacePrivate->lastTransaction) {
+            entry.previousTransaction = surfacePrivate->lastTransaction;
+            entry.previousTransaction->entry(entry.surface)->nextTransaction = this;
+        }
+        surfacePrivate->lastTransaction = this;
+    }
+    m_committed = true;
+
+    watchBuffers();
+    tryApply();
+}
+
+void Transaction::watchBuffers()
+{
+    for (const TransactionEntry &entry : m_entries) {
+        const SurfaceState *state = entry.state.get();
+        if (!state->bufferIsSet || !state->buffer) {
+            continue;
+        }
+        if (state->acquirePoint.timeline) {
+            // with explicit sync, the acquire point replaces the implicit fences of the buffer
+            KWin::FileDescriptor eventFd = state->acquirePoint.timeline->eventFd(state->acquirePoint.point);
+            if (eventFd.isValid() && !isSignaled(eventFd)) {
+                m_fences.push_back(std::make_unique<TransactionFence>(this, std::move(eventFd)));
+            }
+            continue;
+        }
+        const KWin::DmaBufAttributes *attributes = state->buffer->dmabufAttributes();
+        if (!attributes) {
+            continue;
+        }
+        for (int i = 0; i < attributes->planeCount; ++i) {
+            KWin::FileDescriptor fence = exportReadFence(attributes->fd[i]);
+            if (fence.isValid() && !isSignaled(fence)) {
+                m_fences.push_back(std::make_unique<TransactionFence>(this, std::move(fence)));
+            }
+        }
+    }
+}
+
+bool Transaction::isReady() const
+{
+    if (!m_committed || m_locks) {
+        return false;
+    }
+    return std::none_of(m_entries.cbegin(), m_entries.cend(), [](const TransactionEntry &entry) {
+        return entry.previousTransaction;
+    });
+}
+
+void Transaction::tryApply()
+{
+    if (!isReady()) {
+        return;
+    }
+
+    // applying a transaction can unblock the ones queued behind it, they are applied
+    // iteratively rather than recursively as they delete themselves
+    std::deque<Transaction *> ready{this};
+    while (!ready.empty()) {
+        Transaction *transaction = ready.front();
+        ready.pop_front();
+
+        const std::vector<Transaction *> next = transaction->apply();
+        delete transaction;
+
+        for (Transaction *candidate : next) {
+            if (candidate->isReady() && std::find(ready.cbegin(), ready.cend(), candidate) == ready.cend()) {
+                ready.push_back(candidate);
+            }
+        }
+    }
+}
+
+std::vector<Transaction *> Transaction::apply()
+{
+    // Subsurfaces are applied before their parents, so the parent sees the final state of
+    // its subsurface tree, e.g. when its role computes the window geometry.
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const TransactionEntry &a, const TransactionEntry &b) {
+        const int depthA = a.surface ? surfaceDepth(a.surface) : 0;
+        const int depthB = b.surface ? surfaceDepth(b.surface) : 0;
+        return depthA > depthB;
+    });
+
+    for (TransactionEntry &entry : m_entries) {
+        if (entry.surface) {
+            SurfaceInterfacePrivate::get(entry.surface)->applyState(entry.state.get());
+        }
+    }
+
+    // if the main surface is not part of the transaction, e.g. a desynchronized subsurface has
+    // been committed, the changes in its sub-surface tree are still pending
+    for (TransactionEntry &entry : m_entries) {
+        if (entry.surface) {
+            SurfaceInterfacePrivate::get(entry.surface)->flushTreeChanges();
+        }
+    }
+
+    std::vector<Transaction *> next;
+    for (TransactionEntry &entry : m_entries) {
+        if (entry.surface) {
+            SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(entry.surface);
+            if (surfacePrivate->lastTransaction == this) {
+                surfacePrivate->lastTransaction = nullptr;
+            }
+        }
+        if (entry.nextTransaction) {
+            for (TransactionEntry &nextEntry : entry.nextTransaction->m_entries) {
+                if (nextEntry.previousTransaction == this) {
+                    nextEntry.previousTransaction = nullptr;
+                }
+            }
+            if (std::find(next.cbegin(), next.cend(), entry.nextTransaction) == next.cend()) {
+                next.push_back(entry.nextTransaction);
+            }
+        }
+    }
+    return next;
+}
+
+} // namespace KWaylandServer
@@ -0,0 +1,121 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include <QPointer>
+
+#include <memory>
+#include <vector>
+
+namespace KWaylandServer
+{
+
+class SurfaceInterface;
+struct SurfaceState;
+class Transaction;
+class TransactionFence;
+
+/**
+ * The TransactionEntry type represents the state of a single surface in a transaction.
+ */
+struct TransactionEntry
+{
+    /**
+     * The surface the state belongs to.
+     */
+    QPointer<SurfaceInterface> surface;
+
+    /**
+     * The state that is applied to the surface when the transaction is applied.
+     */
+    std::unique_ptr<SurfaceState> state;
+
+    /**
+     * The transaction that has to be applied before this one, or @c null.
+     */
+    Transaction *previousTransaction = nullptr;
+
+    /**
+     * The transaction that has to be applied after this one, or @c null.
+     */
+    Transaction *nextTransaction = nullptr;
+};
+
+/**
+ * The Transaction class represents a set of surface states that are applied atomically.
+ *
+ * A transaction is applied only after all transactions that have been committed before it
+ * and touch the same surfaces have been applied, and after all its locks have been released.
+ * Both the queued states of a synchronized subsurface tree and the states that wait for
+ * their buffers to become ready are expressed this way, the states are moved around rather
+ * than merged into intermediate caches.
+ *
+ * When a transaction is committed, it's locked until the client buffers it contains are
+ * ready to be sampled, i.e. the rendering commands of the client have finished, so the
+ * compositor never has to wait for the client's GPU work while rendering a frame. Until
+ * then, the previously committed buffers keep being shown.
+ *
+ * A committed transaction deletes itself after being applied. A transaction that has not
+ * been committed yet is owned by whoever created it; its locks are only meant to be taken
+ * once it's committed, merging doesn't carry them over.
+ */
+class Transaction
+{
+public:
+    Transaction();
+    ~Transaction();
+
+    /**
+     * Locks the transaction. The transaction won't be applied until it's unlocked.
+     */
+    void lock();
+
+    /**
+     * Unlocks the transaction. If it's ready, the transaction is applied.
+     */
+    void unlock();
+
+    /**
+     * Moves the pending state of the given @a surface into the transaction. If the
+     * transaction already has a state for the surface, the pending state is merged into it.
+     */
+    void add(SurfaceInterface *surface);
+
+    /**
+     * Moves all entries of the @a other transaction into this one. The @a other transaction
+     * must not have been committed yet and is empty afterwards.
+     */
+    void merge(Transaction *other);
+
+    /**
+     * Returns the entry for the given @a surface, or @c null if there's none.
+     */
+    TransactionEntry *entry(SurfaceInterface *surface);
+
+    /**
+     * Returns @c true if the transaction contains no states.
+     */
+    bool isEmpty() const;
+
+    /**
+     * Queues the transaction behind the transactions that have been committed for the same
+     * surfaces. The transaction is applied as soon as it's ready, possibly right away.
+     */
+    void commit();
+
+private:
+    bool isReady() const;
+    void tryApply();
+    void watchBuffers();
+    std::vector<Transaction *> apply();
+
+    std::vector<TransactionEntry> m_entries;
+    std::vector<std::unique_ptr<TransactionFence>> m_fences;
+    int m_locks = 0;
+    bool m_committed = false;
+};
+
+} // namespace KWaylandServer
@@ -19,14 +19,15 @@ namespace KWaylandServer
 {
 
 /**
- * Returns an infinite region.
+ * Returns an infinite region. The region is shared, so this doesn't allocate memory.
  */
 inline QRegion KWIN_EXPORT infiniteRegion()
 {
-    return QRegion(std::numeric_limits<int>::min() / 2, // "/ 2" is to avoid integer overflows
-                   std::numeric_limits<int>::min() / 2,
-                   std::numeric_limits<int>::max(),
-                   std::numeric_limits<int>::max());
+    static const QRegion region(std::numeric_limits<int>::min() / 2, // "/ 2" is to avoid integer overflows
+                                std::numeric_limits<int>::min() / 2,
+                                std::numeric_limits<int>::max(),
+                                std::numeric_limits<int>::max());
+    return region;
 }
 
 template<typename T>
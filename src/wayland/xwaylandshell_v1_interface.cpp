@@ -12,6 +12,8 @@
 
 #include "qwayland-server-xwayland-shell-v1.h"
 
+#include <QHash>
+
 namespace KWaylandServer
 {
 
@@ -22,8 +24,10 @@ class XwaylandShellV1InterfacePrivate : public QtWaylandServer::xwayland_shell_v
 public:
     XwaylandShellV1InterfacePrivate(Display *display, XwaylandShellV1Interface *q);
 
+    void associate(XwaylandSurfaceV1Interface *surface, uint64_t serial);
+
     XwaylandShellV1Interface *q;
-    QList<XwaylandSurfaceV1Interface *> m_surfaces;
+    QHash<uint64_t, XwaylandSurfaceV1Interface *> m_surfaces;
 
 protected:
     void xwayland_shell_v1_destroy(Resource *resource) override;
@@ -73,10 +77,18 @@ void XwaylandShellV1InterfacePrivate::xwayland_shell_v1_get_xwayland_surface(Res
         return;
     }
 
-    auto xwaylandSurface = new XwaylandSurfaceV1Interface(q, surface, resource->client(), id, resource->version());
-    m_surfaces.append(xwaylandSurface);
-    QObject::connect(xwaylandSurface, &QObject::destroyed, q, [this, xwaylandSurface]() {
-        m_surfaces.removeOne(xwaylandSurface);
+    new XwaylandSurfaceV1Interface(q, surface, resource->client(), id, resource->version());
+}
+
+void XwaylandShellV1InterfacePrivate::associate(XwaylandSurfaceV1Interface *surface, uint64_t serial)
+{
+    // only surfaces with a serial can be looked up, a serial is assigned at most once
+    m_surfaces.insert(serial, surface);
+    QObject::connect(surface, &QObject::destroyed, q, [this, surface, serial]() {
+        auto it = m_surfaces.find(serial);
+        if (it != m_surfaces.end() && *it == surface) {
+            m_surfaces.erase(it);
+        }
     });
 }
 
@@ -92,6 +104,7 @@ void XwaylandSurfaceV1InterfacePrivate::commit()
 {
     if (pending.serial.has_value()) {
         current.serial = std::exchange(pending.serial, std::nullopt);
+        shell->d->associate(q, current.serial.value());
         Q_EMIT shell->surfaceAssociated(q);
     }
 }
@@ -135,12 +148,7 @@ XwaylandShellV1Interface::~XwaylandShellV1Interface()
 
 XwaylandSurfaceV1Interface *XwaylandShellV1Interface::findSurface(uint64_t serial) const
 {
-    for (XwaylandSurfaceV1Interface *surface : std::as_const(d->m_surfaces)) {
-        if (surface->serial() == serial) {
-            return surface;
-        }
-    }
-    return nullptr;
+    return d->m_surfaces.value(serial);
 }
 
 XwaylandSurfaceV1Interface::XwaylandSurfaceV1Interface(XwaylandShellV1Interface *shell, SurfaceInterface *surface, wl_client *client, uint32_t id, int version)
@@ -54,6 +54,7 @@ Q_SIGNALS:
 
 private:
     std::unique_ptr<XwaylandShellV1InterfacePrivate> d;
+    friend class XwaylandSurfaceV1InterfacePrivate;
 };
 
 } // namespace KWaylandServer
@@ -36,6 +36,7 @@
 #include "wayland/inputmethod_v1_interface.h"
 #include "wayland/keyboard_shortcuts_inhibit_v1_interface.h"
 #include "wayland/keystate_interface.h"
+#include "wayland/linux_drm_syncobj_v1.h"
 #include "wayland/linuxdmabufv1clientbuffer.h"
 #include "wayland/lockscreen_overlay_v1_interface.h"
 #include "wayland/output_interface.h"
@@ -47,12 +48,14 @@
 #include "wayland/plasmawindowmanagement_interface.h"
 #include "wayland/pointerconstraints_v1_interface.h"
 #include "wayland/pointergestures_v1_interface.h"
+#include "wayland/presentationtime.h"
 #include "wayland/primaryselectiondevicemanager_v1_interface.h"
 #include "wayland/relativepointer_v1_interface.h"
 #include "wayland/seat_interface.h"
 #include "wayland/server_decoration_interface.h"
 #include "wayland/server_decoration_palette_interface.h"
 #include "wayland/shadow_interface.h"
+#include "wayland/singlepixelbuffer.h"
 #include "wayland/subcompositor_interface.h"
 #include "wayland/tablet_v2_interface.h"
 #include "wayland/tearingcontrol_v1_interface.h"
@@ -74,6 +77,10 @@
 #include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
+
+// KF
+#include <KSycoca>
 
 // system
 #include <sys/socket.h>
@@ -98,6 +105,10 @@ public:
     KWinDisplay(QObject *parent)
         : KWaylandServer::FilteredDisplay(parent)
     {
+        // the cached interfaces are stale once desktop files are installed, changed or removed
+        connect(KSycoca::self(), &KSycoca::databaseChanged, this, [this]() {
+            m_requestedInterfaces.clear();
+        });
     }
 
     static QByteArray sha256(const QString &fileName)
@@ -125,9 +136,16 @@ public:
         return trusted;
     }
 
-    QStringList fetchRequestedInterfaces(KWaylandServer::ClientConnection *client) const
+    QStringList fetchRequestedInterfaces(KWaylandServer::ClientConnection *client)
     {
-        return KWin::fetchRequestedInterfaces(client->executablePath());
+        // looking up the desktop file walks all installed services, helper processes that are
+        // spawned over and over again should pay that price only once
+        const QString executablePath = client->executablePath();
+        auto it = m_requestedInterfaces.constFind(executablePath);
+        if (it == m_requestedInterfaces.constEnd()) {
+            it = m_requestedInterfaces.insert(executablePath, KWin::fetchRequestedInterfaces(executablePath));
+        }
+        return *it;
     }
 
     const QSet<QByteArray> interfacesBlackList = {
@@ -147,6 +165,7 @@ public:
     };
 
     QSet<QString> m_reported;
+    QHash<QString, QStringList> m_requestedInterfaces;
 
     bool allowInterface(KWaylandServer::ClientConnection *client, const QByteArray &interfaceName) override
     {
@@ -227,6 +246,41 @@ KWaylandServer::ClientConnection *WaylandServer::inputMethodConnection() const
     return m_inputMethodServerConnection;
 }
 
+/**
+ * Remembers the @p window in the given table of pending associations until it's associated or closed.
+ */
+template<typename Key>
+static void addPendingAssociation(WaylandServer *server, QHash<Key, X11Window *> &pending, Key key, X11Window *window)
+{
+    pending.insert(key, window);
+    QObject::connect(
+        window, &Window::closed, server, [&pending, key, window]() {
+            auto it = pending.find(key);
+            if (it != pending.end() && *it == window) {
+                pending.erase(it);
+            }
+        },
+        Qt::SingleShotConnection);
+}
+
+void WaylandServer::associateXwaylandSurfaceSerial(X11Window *window, quint64 serial)
+{
+    if (KWaylandServer::XwaylandSurfaceV1Interface *xwaylandSurface = m_xwaylandShell->findSurface(serial)) {
+        window->setSurface(xwaylandSurface->surface());
+    } else {
+        addPendingAssociation(this, m_pendingXwaylandSerials, serial, window);
+    }
+}
+
+void WaylandServer::associateXwaylandSurfaceId(X11Window *window, quint32 id)
+{
+    if (SurfaceInterface *surface = SurfaceInterface::get(id, xWaylandConnection())) {
+        window->setSurface(surface);
+    } else {
+        addPendingAssociation(this, m_pendingXwaylandSurfaceIds, id, window);
+    }
+}
+
 void WaylandServer::registerWindow(Window *window)
 {
     if (window->readyForPainting()) {
@@ -331,52 +385,20 @@ bool WaylandServer::init(InitializationFlags flags)
     m_initFlags = flags;
     m_compositor = new CompositorInterface(m_display, m_display);
     connect(m_compositor, &CompositorInterface::surfaceCreated, this, [this](SurfaceInterface *surface) {
-        // check whether we have a Window with the Surface's id
-        Workspace *ws = Workspace::self();
-        if (!ws) {
-            // it's possible that a Surface gets created before Workspace is created
-            return;
-        }
         if (surface->client() != xWaylandConnection()) {
             // setting surface is only relevant for Xwayland clients
             return;
         }
-
-        X11Window *window = ws->findClient([surface](const X11Window *window) {
-            return window->pendingSurfaceId() == surface->id();
-        });
-        if (window) {
+        // if no window has claimed the surface id yet, it does so when its WL_SURFACE_ID message arrives
+        if (X11Window *window = m_pendingXwaylandSurfaceIds.take(surface->id())) {
             window->setSurface(surface);
-            return;
-        }
-
-        X11Window *unmanaged = ws->findUnmanaged([surface](const X11Window *unmanaged) {
-            return unmanaged->pendingSurfaceId() == surface->id();
-        });
-        if (unmanaged) {
-            unmanaged->setSurface(surface);
-            return;
         }
-
-        // The surface will be bound later when a WL_SURFACE_ID message is received.
     });
 
     m_xwaylandShell = new KWaylandServer::XwaylandShellV1Interface(m_display, m_display);
-    connect(m_xwaylandShell, &KWaylandServer::XwaylandShellV1Interface::surfaceAssociated, this, [](KWaylandServer::XwaylandSurfaceV1Interface *surface) {
-        X11Window *window = workspace()->findClient([&surface](const X11Window *window) {
-            return window->surfaceSerial() == surface->serial();
-        });
-        if (window) {
+    connect(m_xwaylandShell, &KWaylandServer::XwaylandShellV1Interface::surfaceAssociated, this, [this](KWaylandServer::XwaylandSurfaceV1Interface *surface) {
+        if (X11Window *window = m_pendingXwaylandSerials.take(surface->serial().value())) {
             window->setSurface(surface->surface());
-            return;
-        }
-
-        X11Window *unmanaged = workspace()->findUnmanaged([&surface](const X11Window *window) {
-            return window->surfaceSerial() == surface->serial();
-        });
-        if (unmanaged) {
-            unmanaged->setSurface(surface->surface());
-            return;
         }
     });
 
@@ -403,6 +425,7 @@ bool WaylandServer::init(InitializationFlags flags)
     });
 
     new ViewporterInterface(m_display, m_display);
+    new SinglePixelBufferManagerV1(m_display, m_display);
     new FractionalScaleManagerV1Interface(m_display, m_display);
     m_display->createShm();
     m_seat = new SeatInterface(m_display, m_display);
@@ -509,6 +532,7 @@ bool WaylandServer::init(InitializationFlags flags)
 
     m_contentTypeManager = new KWaylandServer::ContentTypeManagerV1Interface(m_display, m_display);
     m_tearingControlInterface = new KWaylandServer::TearingControlManagerV1Interface(m_display, m_display);
+    new PresentationTime(m_display, m_display);
 
     return true;
 }
@@ -529,6 +553,18 @@ KWaylandServer::LinuxDmaBufV1ClientBufferIntegration *WaylandServer::linuxDmabuf
     return m_linuxDmabuf;
 }
 
+void WaylandServer::initLinuxDrmSyncObj(FileDescriptor &&drmFd)
+{
+    if (!m_linuxDrmSyncObj) {
+        m_linuxDrmSyncObj = new LinuxDrmSyncObjV1Interface(m_display, std::move(drmFd), m_display);
+    }
+}
+
+KWaylandServer::LinuxDrmSyncObjV1Interface *WaylandServer::linuxDrmSyncObj() const
+{
+    return m_linuxDrmSyncObj;
+}
+
 SurfaceInterface *WaylandServer::findForeignTransientForSurface(SurfaceInterface *surface)
 {
     return m_XdgForeign->transientFor(surface);
@@ -39,6 +39,7 @@ class XdgForeignV2Interface;
 class XdgOutputManagerV1Interface;
 class DrmClientBufferIntegration;
 class LinuxDmaBufV1ClientBufferIntegration;
+class LinuxDrmSyncObjV1Interface;
 class TabletManagerV2Interface;
 class KeyboardShortcutsInhibitManagerV1Interface;
 class XdgDecorationManagerV1Interface;
@@ -53,8 +54,10 @@ class OutputOrderV1Interface;
 namespace KWin
 {
 
+class FileDescriptor;
 class Window;
 class Output;
+class X11Window;
 class XdgActivationV1Integration;
 class XdgPopupWindow;
 class XdgSurfaceWindow;
@@ -134,6 +137,13 @@ public:
     KWaylandServer::DrmClientBufferIntegration *drm();
     KWaylandServer::LinuxDmaBufV1ClientBufferIntegration *linuxDmabuf();
 
+    /**
+     * Creates the linux-drm-syncobj-v1 global. Timelines imported by clients are
+     * attached to @a drmFd, which has to support timeline syncobjs.
+     */
+    void initLinuxDrmSyncObj(FileDescriptor &&drmFd);
+    KWaylandServer::LinuxDrmSyncObjV1Interface *linuxDrmSyncObj() const;
+
     KWaylandServer::InputMethodV1Interface *inputMethod() const
     {
         return m_inputMethod;
@@ -186,6 +196,18 @@ public:
 
     KWaylandServer::ClientConnection *xWaylandConnection() const;
     KWaylandServer::ClientConnection *inputMethodConnection() const;
+
+    /**
+     * Associates the X11 @p window with the Xwayland surface that has the given @p serial. If
+     * there's no such surface yet, the window is associated once the surface gets the serial.
+     */
+    void associateXwaylandSurfaceSerial(X11Window *window, quint64 serial);
+    /**
+     * Associates the X11 @p window with the Xwayland surface that has the object @p id, the
+     * legacy WL_SURFACE_ID way. If there's no such surface yet, the window is associated once
+     * the surface is created.
+     */
+    void associateXwaylandSurfaceId(X11Window *window, quint32 id);
     KWaylandServer::ClientConnection *screenLockerClientConnection() const
     {
         return m_screenLockerClientConnection;
@@ -268,6 +290,7 @@ private:
     KWaylandServer::XdgDecorationManagerV1Interface *m_xdgDecorationManagerV1 = nullptr;
     KWaylandServer::DrmClientBufferIntegration *m_drm = nullptr;
     KWaylandServer::LinuxDmaBufV1ClientBufferIntegration *m_linuxDmabuf = nullptr;
+    KWaylandServer::LinuxDrmSyncObjV1Interface *m_linuxDrmSyncObj = nullptr;
     KWaylandServer::KeyboardShortcutsInhibitManagerV1Interface *m_keyboardShortcutsInhibitManager = nullptr;
     QPointer<KWaylandServer::ClientConnection> m_xwaylandConnection;
     KWaylandServer::InputMethodV1Interface *m_inputMethod = nullptr;
@@ -279,6 +302,8 @@ private:
     KWaylandServer::ContentTypeManagerV1Interface *m_contentTypeManager = nullptr;
     KWaylandServer::TearingControlManagerV1Interface *m_tearingControlInterface = nullptr;
     KWaylandServer::XwaylandShellV1Interface *m_xwaylandShell = nullptr;
+    QHash<quint64, X11Window *> m_pendingXwaylandSerials;
+    QHash<quint32, X11Window *> m_pendingXwaylandSurfaceIds;
     QList<Window *> m_windows;
     InitializationFlags m_initFlags;
     QHash<Output *, KWaylandServer::OutputInterface *> m_waylandOutputs;
@@ -44,9 +44,12 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QMetaMethod>
 #include <QMouseEvent>
 #include <QStyleHints>
 
+#include <optional>
+
 namespace KWin
 {
 
@@ -77,6 +80,27 @@ Window::Window()
 
     connect(this, &Window::paletteChanged, this, &Window::triggerDecorationRepaint);
 
+    connect(this, &Window::frameGeometryChanged, this, [this]() {
+        markChanged(GeometryChange);
+    });
+    connect(this, &Window::captionChanged, this, [this]() {
+        markChanged(CaptionChange);
+    });
+    for (auto signal : {&Window::activeChanged, &Window::minimizedChanged, &Window::maximizedChanged, &Window::fullScreenChanged, &Window::shadeChanged}) {
+        connect(this, signal, this, [this]() {
+            markChanged(StateChange);
+        });
+    }
+    connect(this, &Window::keepAboveChanged, this, [this]() {
+        markChanged(StateChange);
+    });
+    connect(this, &Window::keepBelowChanged, this, [this]() {
+        markChanged(StateChange);
+    });
+    connect(this, &Window::desktopsChanged, this, [this]() {
+        markChanged(DesktopChange);
+    });
+
     // If the user manually moved the window, don't restore it after the keyboard closes
     connect(this, &Window::interactiveMoveResizeFinished, this, [this]() {
         m_keyboardGeometryRestore = QRectF();
@@ -164,6 +188,15 @@ QRectF Window::visibleGeometry() const
     return QRectF();
 }
 
+QRectF Window::inputGeometry() const
+{
+    QRectF geometry = visibleGeometry() | m_bufferGeometry;
+    if (isDecorated()) {
+        geometry |= QRectF(m_decoration.inputRegion.boundingRect()).translated(frameGeometry().topLeft());
+    }
+    return geometry;
+}
+
 /**
  * Returns client machine for this window,
  * taken either from its window or from the leader window.
@@ -1418,10 +1451,16 @@ void Window::updateInteractiveMoveResize(const QPointF &currentGlobalCursor)
 void Window::handleInteractiveMoveResize(const QPointF &local, const QPointF &global)
 {
     const QRectF oldGeo = moveResizeGeometry();
-    handleInteractiveMoveResize(local.x(), local.y(), global.x(), global.y());
-    if (!isRequestedFullScreen() && isInteractiveMove()) {
-        if (quickTileMode() != QuickTileMode(QuickTileFlag::None) && oldGeo != moveResizeGeometry()) {
-            GeometryUpdatesBlocker blocker(this);
+    {
+        // Dragging a window out of its tile moves it, restores its size and moves it again,
+        // the geometry is applied once for all the steps.
+        std::optional<GeometryUpdatesBlocker> blocker;
+        const bool tiled = quickTileMode() != QuickTileMode(QuickTileFlag::None);
+        if (tiled) {
+            blocker.emplace(this);
+        }
+        handleInteractiveMoveResize(local.x(), local.y(), global.x(), global.y());
+        if (tiled && !isRequestedFullScreen() && isInteractiveMove() && oldGeo != moveResizeGeometry()) {
             setQuickTileMode(QuickTileFlag::None);
             const QRectF &geom_restore = geometryRestore();
             setInteractiveMoveOffset(QPointF(double(interactiveMoveOffset().x()) / double(oldGeo.width()) * double(geom_restore.width()),
@@ -1431,7 +1470,8 @@ void Window::handleInteractiveMoveResize(const QPointF &local, const QPointF &gl
             }
             handleInteractiveMoveResize(local.x(), local.y(), global.x(), global.y()); // fix position
         }
-
+    }
+    if (!isRequestedFullScreen() && isInteractiveMove()) {
         if (input()->modifiersRelevantForGlobalShortcuts() & Qt::ShiftModifier) {
             resetQuickTilingMaximizationZones();
             const auto &r = quickTileGeometry(QuickTileFlag::Custom, global);
@@ -2684,7 +2724,10 @@ void Window::setDecoration(std::shared_ptr<KDecoration2::Decoration> decoration)
 void Window::updateDecorationInputShape()
 {
     if (!isDecorated()) {
-        m_decoration.inputRegion = QRegion();
+        if (!m_decoration.inputRegion.isEmpty()) {
+            m_decoration.inputRegion = QRegion();
+            Q_EMIT decorationInputShapeChanged();
+        }
         return;
     }
 
@@ -2695,6 +2738,7 @@ void Window::updateDecorationInputShape()
     const QRectF outerRect = innerRect + borders + resizeBorders;
 
     m_decoration.inputRegion = QRegion(outerRect.toAlignedRect()) - innerRect.toAlignedRect();
+    Q_EMIT decorationInputShapeChanged();
 }
 
 bool Window::decorationHasAlpha() const
@@ -4200,6 +4244,27 @@ bool Window::isLockScreenOverlay() const
     return m_lockScreenOverlay;
 }
 
+void Window::markChanged(Change change)
+{
+    // nobody needs the coalesced notification for most windows, don't schedule it in vain
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&Window::propertiesChanged);
+    if (!isSignalConnected(signal)) {
+        return;
+    }
+    if (!m_pendingChanges) {
+        QMetaObject::invokeMethod(this, &Window::emitPropertiesChanged, Qt::QueuedConnection);
+    }
+    m_pendingChanges |= change;
+}
+
+void Window::emitPropertiesChanged()
+{
+    const Changes changes = std::exchange(m_pendingChanges, Changes());
+    if (changes) {
+        Q_EMIT propertiesChanged(changes);
+    }
+}
+
 void Window::refOffscreenRendering()
 {
     if (m_offscreenRenderCount == 0) {
@@ -4217,8 +4282,22 @@ void Window::unrefOffscreenRendering()
     }
 }
 
+bool Window::isOffscreenRendering() const
+{
+    return m_offscreenRenderCount > 0;
+}
+
 void Window::maybeSendFrameCallback()
 {
+    const QList<Output *> outputs = workspace()->outputs();
+    const bool outputsOff = std::none_of(outputs.begin(), outputs.end(), [](Output *output) {
+        return output->dpmsMode() == Output::DpmsMode::On;
+    });
+    if (outputsOff) {
+        // nothing can be shown while all outputs are off, check back once in a while
+        m_offscreenFramecallbackTimer.start(std::chrono::seconds(1));
+        return;
+    }
     if (m_surface && !m_windowItem->isVisible()) {
         m_surface->frameRendered(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
         // update refresh rate, it might have changed
@@ -609,6 +609,10 @@ public:
      * Returns a rectangle that the window occupies on the screen, including drop-shadows.
      */
     QRectF visibleGeometry() const;
+    /**
+     * Returns a rectangle that contains every point for which hitTest() can return @c true.
+     */
+    QRectF inputGeometry() const;
 
     /**
      * Maps the specified @a point from the global screen coordinates to the frame coordinates.
@@ -1238,6 +1242,16 @@ public:
         AllowCrossProcesses = 1 << 1
     };
     Q_DECLARE_FLAGS(SameApplicationChecks, SameApplicationCheck)
+
+    enum Change {
+        GeometryChange = 1 << 0,
+        CaptionChange = 1 << 1,
+        StateChange = 1 << 2,
+        DesktopChange = 1 << 3,
+    };
+    Q_DECLARE_FLAGS(Changes, Change)
+    Q_FLAG(Changes)
+
     static bool belongToSameApplication(const Window *c1, const Window *c2, SameApplicationChecks checks = SameApplicationChecks());
 
     bool hasApplicationMenu() const;
@@ -1309,6 +1323,11 @@ public:
 
     void refOffscreenRendering();
     void unrefOffscreenRendering();
+    /**
+     * Returns @c true if the window is shown somewhere else than on the screen,
+     * for example in a screen cast or a thumbnail.
+     */
+    bool isOffscreenRendering() const;
 
 public Q_SLOTS:
     virtual void closeWindow() = 0;
@@ -1320,7 +1339,11 @@ Q_SIGNALS:
     void stackingOrderChanged();
     void shadeChanged();
     void opacityChanged(KWin::Window *window, qreal oldOpacity);
-    void damaged(KWin::Window *window);
+    /**
+     * Emitted when the contents of the @a window change, the @a region is in global
+     * coordinates. An infinite region means that the whole window has been damaged.
+     */
+    void damaged(KWin::Window *window, const QRegion &region);
     void inputTransformationChanged();
     void geometryShapeChanged(const QRectF &old);
     void closed();
@@ -1378,6 +1401,11 @@ Q_SIGNALS:
      */
     void visibleGeometryChanged();
 
+    /**
+     * This signal is emitted when the input shape of the decoration has changed.
+     */
+    void decorationInputShapeChanged();
+
     /**
      * This signal is emitted when associated tile has changed, including from and to none
      */
@@ -1424,6 +1452,14 @@ Q_SIGNALS:
     void hiddenChanged();
     void lockScreenOverlayChanged();
 
+    /**
+     * This signal is emitted once per event loop iteration if any of the @a changes happened
+     * during the previous one. It's meant for the consumers that only need the final state
+     * of the window, e.g. scripts, that would otherwise run once for every pointer motion
+     * during an interactive move.
+     */
+    void propertiesChanged(KWin::Window::Changes changes);
+
 protected:
     Window();
 
@@ -1831,6 +1867,12 @@ protected:
     bool m_lockScreenOverlay = false;
     uint32_t m_offscreenRenderCount = 0;
     QTimer m_offscreenFramecallbackTimer;
+
+private:
+    void markChanged(Change change);
+    void emitPropertiesChanged();
+
+    Changes m_pendingChanges;
 };
 
 /**
@@ -2137,3 +2179,4 @@ private:
 Q_DECLARE_METATYPE(KWin::Window *)
 Q_DECLARE_METATYPE(QList<KWin::Window *>)
 Q_DECLARE_OPERATORS_FOR_FLAGS(KWin::Window::SameApplicationChecks)
+Q_DECLARE_OPERATORS_FOR_FLAGS(KWin::Window::Changes)
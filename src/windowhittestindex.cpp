@@ -0,0 +1,105 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "windowhittestindex.h"
+#include "window.h"
+#include "workspace.h"
+
+#include <cmath>
+
+namespace KWin
+{
+
+// the cells are large enough for a typical window to span only a handful of them
+static const int s_cellSize = 256;
+
+WindowHitTestIndex::WindowHitTestIndex(QObject *parent)
+    : QObject(parent)
+{
+    connect(workspace(), &Workspace::stackingOrderChanged, this, &WindowHitTestIndex::invalidate);
+    connect(workspace(), &Workspace::geometryChanged, this, &WindowHitTestIndex::invalidate);
+}
+
+quint64 WindowHitTestIndex::cellKey(int column, int row)
+{
+    return (quint64(quint32(column)) << 32) | quint32(row);
+}
+
+void WindowHitTestIndex::invalidate()
+{
+    m_dirty = true;
+}
+
+void WindowHitTestIndex::track(Window *window)
+{
+    if (m_tracked.contains(window)) {
+        return;
+    }
+    m_tracked.insert(window);
+    connect(window, &Window::frameGeometryChanged, this, &WindowHitTestIndex::invalidate);
+    connect(window, &Window::bufferGeometryChanged, this, &WindowHitTestIndex::invalidate);
+    connect(window, &Window::visibleGeometryChanged, this, &WindowHitTestIndex::invalidate);
+    connect(window, &Window::decorationChanged, this, &WindowHitTestIndex::invalidate);
+    connect(window, &Window::decorationInputShapeChanged, this, &WindowHitTestIndex::invalidate);
+    connect(window, &QObject::destroyed, this, [this, window]() {
+        m_tracked.remove(window);
+        m_dirty = true;
+    });
+}
+
+void WindowHitTestIndex::rebuild()
+{
+    m_dirty = false;
+    m_cells.clear();
+    m_area = workspace()->geometry();
+
+    const QList<Window *> &stacking = workspace()->stackingOrder();
+    for (auto it = stacking.crbegin(); it != stacking.crend(); ++it) {
+        Window *window = *it;
+        if (window->isDeleted()) {
+            // a deleted window doesn't get mouse events
+            continue;
+        }
+        track(window);
+
+        const QRectF bounds = window->inputGeometry() & QRectF(m_area);
+        if (bounds.isEmpty()) {
+            continue;
+        }
+        const int left = std::floor((bounds.left() - m_area.x()) / s_cellSize);
+        const int top = std::floor((bounds.top() - m_area.y()) / s_cellSize);
+        const int right = std::ceil((bounds.right() - m_area.x()) / s_cellSize);
+        const int bottom = std::ceil((bounds.bottom() - m_area.y()) / s_cellSize);
+        for (int row = top; row < bottom; ++row) {
+            for (int column = left; column < right; ++column) {
+                m_cells[cellKey(column, row)].append(window);
+            }
+        }
+    }
+}
+
+bool WindowHitTestIndex::covers(const QPointF &pos)
+{
+    if (m_dirty) {
+        rebuild();
+    }
+    return QRectF(m_area).contains(pos);
+}
+
+const QList<Window *> &WindowHitTestIndex::candidates(const QPointF &pos)
+{
+    static const QList<Window *> empty;
+    if (m_dirty) {
+        rebuild();
+    }
+    const int column = std::floor((pos.x() - m_area.x()) / s_cellSize);
+    const int row = std::floor((pos.y() - m_area.y()) / s_cellSize);
+    const auto it = m_cells.constFind(cellKey(column, row));
+    return it != m_cells.constEnd() ? *it : empty;
+}
+
+} // namespace KWin
@@ -0,0 +1,60 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QRect>
+#include <QSet>
+
+namespace KWin
+{
+
+class Window;
+
+/**
+ * The WindowHitTestIndex class is a uniform grid over the workspace that maps every cell to
+ * the windows whose input geometry overlaps it, ordered from the top of the stack to the
+ * bottom. It lets the input code hit test only the windows under a point instead of the
+ * whole stacking order.
+ *
+ * The index is rebuilt lazily, on the first query after the stacking order or the input
+ * geometry of a window has changed.
+ */
+class WindowHitTestIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WindowHitTestIndex(QObject *parent = nullptr);
+
+    /**
+     * Returns @c true if @a pos lies within the indexed area, i.e. candidates() is complete.
+     */
+    bool covers(const QPointF &pos);
+
+    /**
+     * Returns the windows that may accept input at @a pos, from top to bottom.
+     */
+    const QList<Window *> &candidates(const QPointF &pos);
+
+    void invalidate();
+
+private:
+    void rebuild();
+    void track(Window *window);
+    static quint64 cellKey(int column, int row);
+
+    QHash<quint64, QList<Window *>> m_cells;
+    QSet<Window *> m_tracked;
+    QRect m_area;
+    bool m_dirty = true;
+};
+
+} // namespace KWin
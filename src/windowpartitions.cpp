@@ -0,0 +1,92 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "windowpartitions.h"
+#include "virtualdesktops.h"
+#include "window.h"
+#include "workspace.h"
+#if KWIN_BUILD_ACTIVITIES
+#include "activities.h"
+#endif
+
+namespace KWin
+{
+
+size_t qHash(const WindowPartitions::Key &key, size_t seed)
+{
+    return qHashMulti(seed, key.activity, key.desktop, key.output);
+}
+
+WindowPartitions::WindowPartitions(Workspace *workspace)
+    : m_workspace(workspace)
+{
+    connect(workspace, &Workspace::stackingOrderChanged, this, &WindowPartitions::invalidate);
+    connect(workspace, &Workspace::windowAdded, this, &WindowPartitions::invalidate);
+    connect(workspace, &Workspace::windowRemoved, this, &WindowPartitions::invalidate);
+    connect(workspace, &Workspace::outputRemoved, this, &WindowPartitions::invalidate);
+    connect(VirtualDesktopManager::self(), &VirtualDesktopManager::desktopRemoved, this, &WindowPartitions::invalidate);
+}
+
+void WindowPartitions::invalidate()
+{
+    m_partitions.clear();
+}
+
+void WindowPartitions::track(Window *window)
+{
+    if (m_tracked.contains(window)) {
+        return;
+    }
+    m_tracked.insert(window);
+    connect(window, &Window::desktopsChanged, this, &WindowPartitions::invalidate);
+    connect(window, &Window::activitiesChanged, this, &WindowPartitions::invalidate);
+    connect(window, &Window::outputChanged, this, &WindowPartitions::invalidate);
+    connect(window, &QObject::destroyed, this, [this, window]() {
+        m_tracked.remove(window);
+        invalidate();
+    });
+}
+
+QString WindowPartitions::currentActivity() const
+{
+#if KWIN_BUILD_ACTIVITIES
+    if (Activities *activities = m_workspace->activities()) {
+        return activities->current();
+    }
+#endif
+    return QString();
+}
+
+QList<Window *> WindowPartitions::windows(VirtualDesktop *desktop, Output *output)
+{
+    const Key key{
+        .activity = currentActivity(),
+        .desktop = desktop,
+        .output = output,
+    };
+    auto it = m_partitions.find(key);
+    if (it != m_partitions.end()) {
+        return *it;
+    }
+
+    QList<Window *> partition;
+    const QList<Window *> &stacking = m_workspace->stackingOrder();
+    for (Window *window : stacking) {
+        track(window);
+        if (!window->isOnDesktop(desktop) || !window->isOnCurrentActivity()) {
+            continue;
+        }
+        if (output && window->output() != output) {
+            continue;
+        }
+        partition.append(window);
+    }
+    m_partitions.insert(key, partition);
+    return partition;
+}
+
+} // namespace KWin
@@ -0,0 +1,70 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+namespace KWin
+{
+
+class Output;
+class VirtualDesktop;
+class Window;
+class Workspace;
+
+/**
+ * The WindowPartitions class caches the windows in the stacking order that are on a given
+ * activity, virtual desktop and, optionally, output. Code that walks the stack looking for
+ * a window on the current desktop can iterate a partition instead of testing the membership
+ * of every window in the stack.
+ *
+ * A partition is built on the first query after the stacking order or the activities, the
+ * desktops or the output of a window have changed.
+ */
+class WindowPartitions : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WindowPartitions(Workspace *workspace);
+
+    /**
+     * Returns the windows on the current activity and @a desktop, from the bottom of the stack
+     * to the top. If @a output is not @c null, only the windows on that output are returned.
+     *
+     * The list is returned by value, since building another partition or an invalidation
+     * while the caller walks the list would leave a reference into the cache dangling.
+     */
+    QList<Window *> windows(VirtualDesktop *desktop, Output *output = nullptr);
+
+    void invalidate();
+
+private:
+    struct Key
+    {
+        QString activity;
+        VirtualDesktop *desktop;
+        Output *output;
+
+        bool operator==(const Key &other) const = default;
+    };
+    friend size_t qHash(const Key &key, size_t seed);
+
+    void track(Window *window);
+    QString currentActivity() const;
+
+    Workspace *m_workspace;
+    QHash<Key, QList<Window *>> m_partitions;
+    QSet<Window *> m_tracked;
+};
+
+} // namespace KWin
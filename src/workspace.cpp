@@ -37,6 +37,7 @@
 #include "placement.h"
 #include "pluginmanager.h"
 #include "rules.h"
+#include "scene/windowitem.h"
 #include "screenedge.h"
 #include "scripting/scripting.h"
 #include "syncalarmx11filter.h"
@@ -57,6 +58,7 @@
 #include "virtualdesktops.h"
 #include "was_user_interaction_x11_filter.h"
 #include "wayland_server.h"
+#include "windowpartitions.h"
 // KDE
 #include <KConfig>
 #include <KConfigGroup>
@@ -135,6 +137,8 @@ Workspace::Workspace()
 
     _self = this;
 
+    m_windowPartitions = std::make_unique<WindowPartitions>(this);
+
 #if KWIN_BUILD_ACTIVITIES
     if (kwinApp()->usesKActivities()) {
         m_activities = std::make_unique<Activities>();
@@ -750,6 +754,50 @@ void Workspace::addDeleted(Window *c)
 {
     Q_ASSERT(!deleted.contains(c));
     deleted.append(c);
+    releaseDeletedResources();
+}
+
+/**
+ * Closed windows are kept around as long as effects animate them, along with the textures
+ * of their last contents. If many windows are closed at once, only the most recently closed
+ * ones keep their textures, the remaining ones are not painted anymore.
+ *
+ * The limits can be changed with KWIN_DELETED_WINDOWS_MAX and KWIN_DELETED_WINDOWS_MEMORY
+ * (in MiB).
+ */
+void Workspace::releaseDeletedResources()
+{
+    static const int maxCount = [] {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("KWIN_DELETED_WINDOWS_MAX", &ok);
+        return ok && value > 0 ? value : 16;
+    }();
+    static const qint64 memoryBudget = [] {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("KWIN_DELETED_WINDOWS_MEMORY", &ok);
+        return qint64(ok && value > 0 ? value : 256) << 20;
+    }();
+
+    int count = 0;
+    qint64 memory = 0;
+    for (auto it = deleted.crbegin(); it != deleted.crend(); ++it) {
+        Window *window = *it;
+        WindowItem *windowItem = window->windowItem();
+        if (!windowItem) {
+            continue;
+        }
+
+        // a rough estimate, the decoration, the shadow and the subsurfaces are not accounted
+        const qreal scale = window->output() ? window->output()->scale() : 1;
+        const QSizeF size = window->frameGeometry().size() * scale;
+        memory += qint64(size.width()) * qint64(size.height()) * 4;
+        ++count;
+
+        // the most recently closed window is always kept
+        if (count > 1 && (count > maxCount || memory > memoryBudget)) {
+            windowItem->releaseResources();
+        }
+    }
 }
 
 void Workspace::removeDeleted(Window *c)
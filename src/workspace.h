@@ -65,6 +65,7 @@ class X11EventFilter;
 class FocusChain;
 class ApplicationMenu;
 class PlacementTracker;
+class WindowPartitions;
 enum class Predicate;
 class Outline;
 class RuleBook;
@@ -283,6 +284,12 @@ public:
     QList<X11Window *> ensureStackingOrder(const QList<X11Window *> &windows) const;
     QList<Window *> ensureStackingOrder(const QList<Window *> &windows) const;
 
+    /**
+     * Returns the windows on the current activity and the given @a desktop, in the stacking
+     * order. If @a output is not @c null, only the windows on that output are returned.
+     */
+    QList<Window *> windowsOn(VirtualDesktop *desktop, Output *output = nullptr) const;
+
     Window *topWindowOnDesktop(VirtualDesktop *desktop, Output *output = nullptr, bool unconstrained = false,
                                bool only_normal = true) const;
     Window *findDesktop(bool topmost, VirtualDesktop *desktop) const;
@@ -355,6 +362,7 @@ public:
     void removeUnmanaged(X11Window *);
     void removeDeleted(Window *);
     void addDeleted(Window *);
+    void releaseDeletedResources();
 
     bool checkStartupNotification(xcb_window_t w, KStartupInfoId &id, KStartupInfoData &data);
 
@@ -718,6 +726,7 @@ private:
     std::unique_ptr<Activities> m_activities;
 #endif
     std::unique_ptr<PlacementTracker> m_placementTracker;
+    std::unique_ptr<WindowPartitions> m_windowPartitions;
 
     PlaceholderOutput *m_placeholderOutput = nullptr;
     std::unique_ptr<PlaceholderInputEventFilter> m_placeholderFilter;
@@ -619,6 +619,9 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     auto activitiesCookie = fetchActivities();
     auto applicationMenuServiceNameCookie = fetchApplicationMenuServiceName();
     auto applicationMenuObjectPathCookie = fetchApplicationMenuObjectPath();
+    auto syncCounterCookie = fetchSyncCounter();
+    auto shapeCookie = fetchShape();
+    m_prefetchedShadow = Shadow::fetchX11ShadowProperty(window());
 
     m_geometryHints.init(window());
     m_motif.init(window());
@@ -637,7 +640,7 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     getResourceClass();
     readWmClientLeader(wmClientLeaderCookie);
     getWmClientMachine();
-    getSyncCounter();
+    readSyncCounter(syncCounterCookie);
     // First only read the caption text, so that setupWindowRules() can use it for matching,
     // and only then really set the caption using setCaption(), which checks for duplicates etc.
     // and also relies on rules already existing
@@ -650,7 +653,7 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     if (Xcb::Extensions::self()->isShapeAvailable()) {
         xcb_shape_select_input(kwinApp()->x11Connection(), window(), true);
     }
-    detectShape();
+    readShape(shapeCookie);
     detectNoBorder();
     fetchIconicName();
     setClientFrameExtents(info->gtkFrameExtents());
@@ -682,6 +685,8 @@ bool X11Window::manage(xcb_window_t w, bool isMapped)
     setSkipSwitcher((info->state() & NET::SkipSwitcher) != 0);
 
     setupCompositing();
+    // discard the prefetched shadow if it hasn't been used, it may be outdated later
+    m_prefetchedShadow = Xcb::Property();
 
     KStartupInfoId asn_id;
     KStartupInfoData asn_data;
@@ -1529,7 +1534,28 @@ void X11Window::checkNoBorder()
 
 void X11Window::detectShape()
 {
-    is_shape = Xcb::Extensions::self()->hasShape(window());
+    Xcb::ShapeExtents extents = fetchShape();
+    readShape(extents);
+}
+
+Xcb::ShapeExtents X11Window::fetchShape() const
+{
+    if (!Xcb::Extensions::self()->isShapeAvailable()) {
+        return Xcb::ShapeExtents();
+    }
+    return Xcb::ShapeExtents(window());
+}
+
+void X11Window::readShape(Xcb::ShapeExtents &extents)
+{
+    is_shape = !extents.isNull() && extents->bounding_shaped > 0;
+}
+
+Xcb::Property X11Window::takePrefetchedShadow()
+{
+    // the copy takes over the pending request
+    Xcb::Property property = m_prefetchedShadow;
+    return property;
 }
 
 void X11Window::updateShape()
@@ -2439,12 +2465,36 @@ void X11Window::getMotifHints()
     }
 }
 
+/**
+ * Returns a checksum of the icons that the window provides itself, i.e. the contents of
+ * _NET_WM_ICON and the icon pixmap ids in WM_HINTS.
+ */
+static size_t iconChecksum(const NETWinInfo *info)
+{
+    size_t seed = qHashMulti(0, info->icccmIconPixmap(), info->icccmIconPixmapMask());
+    const int *sizes = info->iconSizes();
+    for (int i = 0; sizes && (sizes[i] || sizes[i + 1]); i += 2) {
+        const NETIcon icon = info->icon(sizes[i], sizes[i + 1]);
+        if (icon.data) {
+            seed = qHashBits(icon.data, size_t(icon.size.width) * icon.size.height * 4, seed);
+        }
+    }
+    return seed;
+}
+
 void X11Window::getIcons()
 {
     // First read icons from the window itself
     const QString themedIconName = iconFromDesktopFile();
     if (!themedIconName.isEmpty()) {
         setIcon(QIcon::fromTheme(themedIconName));
+        m_iconChecksum = 0;
+        return;
+    }
+    // Clients rewrite their icon properties with the same contents, e.g. WM_HINTS whenever
+    // the urgency hint changes. Don't fetch the icon pixmaps and notify about a new icon then.
+    const size_t checksum = iconChecksum(info);
+    if (m_iconChecksum && m_iconChecksum == checksum) {
         return;
     }
     QIcon icon;
@@ -2459,6 +2509,8 @@ void X11Window::getIcons()
     readIcon(48, false);
     readIcon(64, false);
     readIcon(128, false);
+    // the other sources are not covered by the checksum, they are always read again
+    m_iconChecksum = icon.isNull() ? 0 : checksum;
     if (icon.isNull()) {
         // Then try window group
         icon = group()->icon();
@@ -2501,6 +2553,20 @@ bool X11Window::wantsSyncCounter() const
 }
 
 void X11Window::getSyncCounter()
+{
+    Xcb::Property property = fetchSyncCounter();
+    readSyncCounter(property);
+}
+
+Xcb::Property X11Window::fetchSyncCounter() const
+{
+    if (!Xcb::Extensions::self()->isSyncAvailable()) {
+        return Xcb::Property();
+    }
+    return Xcb::Property(false, window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 0, 1);
+}
+
+void X11Window::readSyncCounter(Xcb::Property &property)
 {
     if (!Xcb::Extensions::self()->isSyncAvailable()) {
         return;
@@ -2509,8 +2575,7 @@ void X11Window::getSyncCounter()
         return;
     }
 
-    Xcb::Property syncProp(false, window(), atoms->net_wm_sync_request_counter, XCB_ATOM_CARDINAL, 0, 1);
-    const xcb_sync_counter_t counter = syncProp.value<xcb_sync_counter_t>(XCB_NONE);
+    const xcb_sync_counter_t counter = property.value<xcb_sync_counter_t>(XCB_NONE);
     if (counter != XCB_NONE) {
         m_syncRequest.counter = counter;
         m_syncRequest.value.hi = 0;
@@ -3039,6 +3104,7 @@ void X11Window::handleSync()
         }
         performInteractiveResize();
         updateWindowPixmap();
+        continueInteractiveResize();
     }
 }
 
@@ -3047,6 +3113,18 @@ void X11Window::performInteractiveResize()
     resize(moveResizeGeometry().size());
 }
 
+/**
+ * The pointer motion is ignored while waiting for the client to redraw, so the pointer has
+ * usually moved on by the time the client is done. Catch up with it right away rather than
+ * on the next motion event, which may never come if the pointer has stopped.
+ */
+void X11Window::continueInteractiveResize()
+{
+    if (isInteractiveResize() && isInteractiveMoveResizePointerButtonDown()) {
+        updateInteractiveMoveResize(Cursors::self()->mouse()->pos());
+    }
+}
+
 bool X11Window::belongToSameApplication(const X11Window *c1, const X11Window *c2, SameApplicationChecks checks)
 {
     bool same_app = false;
@@ -4889,6 +4967,9 @@ void X11Window::handleSyncTimeout()
     if (m_syncRequest.counter == XCB_NONE) { // client w/o XSYNC support. allow the next resize event
         m_syncRequest.isPending = false; // NEVER do this for clients with a valid counter
         m_syncRequest.interactiveResize = false; // (leads to sync request races in some clients)
+        performInteractiveResize();
+        continueInteractiveResize();
+        return;
     }
     performInteractiveResize();
 }
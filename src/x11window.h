@@ -188,6 +188,12 @@ public:
     void detectShape();
     void updateShape();
 
+    /**
+     * Returns the _KDE_NET_WM_SHADOW property that has been requested while managing the
+     * window, or a null property if it's not pending anymore.
+     */
+    Xcb::Property takePrefetchedShadow();
+
     /// resizeWithChecks() resizes according to gravity, and checks workarea position
     QRectF resizeWithChecks(const QRectF &geometry, const QSizeF &size) override;
     QRectF resizeWithChecks(const QRectF &geometry, qreal w, qreal h, xcb_gravity_t gravity);
@@ -382,6 +388,10 @@ private:
     Xcb::Property fetchSkipCloseAnimation() const;
     void readSkipCloseAnimation(Xcb::Property &prop);
     void getSkipCloseAnimation();
+    Xcb::Property fetchSyncCounter() const;
+    void readSyncCounter(Xcb::Property &property);
+    Xcb::ShapeExtents fetchShape() const;
+    void readShape(Xcb::ShapeExtents &extents);
 
     void configureRequest(int value_mask, qreal rx, qreal ry, qreal rw, qreal rh, int gravity, bool from_tool);
     NETExtendedStrut strut() const;
@@ -390,6 +400,7 @@ private:
     void sendSyncRequest();
     void leaveInteractiveMoveResize() override;
     void performInteractiveResize();
+    void continueInteractiveResize();
     void establishCommandWindowGrab(uint8_t button);
     void establishCommandAllGrab(uint8_t button);
     void resizeDecoration();
@@ -477,6 +488,7 @@ private:
     xcb_window_t m_originalTransientForId;
     X11Window *shade_below;
     Xcb::MotifHints m_motif;
+    Xcb::Property m_prefetchedShadow;
     uint hidden : 1; ///< Forcibly hidden by calling hide()
     uint noborder : 1;
     uint app_noborder : 1; ///< App requested no border via window type, shape extension, etc.
@@ -537,6 +549,7 @@ private:
     bool m_outline = false;
     quint32 m_pendingSurfaceId = 0;
     quint64 m_surfaceSerial = 0;
+    size_t m_iconChecksum = 0; ///< Checksum of the icon properties, 0 if the icon doesn't come from them
 };
 
 inline xcb_visualid_t X11Window::visual() const
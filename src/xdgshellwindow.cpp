@@ -110,6 +110,15 @@ void XdgSurfaceWindow::scheduleConfigure()
 
 void XdgSurfaceWindow::sendConfigure()
 {
+    // During interactive resize, the pointer moves a lot faster than most clients can draw.
+    // Only one configure event is kept in flight, the next one is sent when the client has
+    // committed a frame and carries the latest size, the intermediate sizes are dropped.
+    if (isInteractiveResize() && !m_configureEvents.isEmpty()) {
+        m_configureThrottled = true;
+        return;
+    }
+    m_configureThrottled = false;
+
     XdgSurfaceConfigure *configureEvent = sendRoleConfigure();
 
     // The configure event inherits configure flags from the previous event.
@@ -156,6 +165,10 @@ void XdgSurfaceWindow::handleCommit()
     m_lastAcknowledgedConfigure.reset();
     m_lastAcknowledgedConfigureSerial.reset();
 
+    if (m_configureThrottled) {
+        scheduleConfigure();
+    }
+
     markAsMapped();
 }
 
@@ -170,7 +183,7 @@ void XdgSurfaceWindow::handleRoleCommit()
 void XdgSurfaceWindow::maybeUpdateMoveResizeGeometry(const QRectF &rect)
 {
     // We are about to send a configure event, ignore the committed window geometry.
-    if (m_configureTimer->isActive()) {
+    if (m_configureTimer->isActive() || m_configureThrottled) {
         return;
     }
 
@@ -290,6 +303,7 @@ void XdgSurfaceWindow::destroyWindow()
         Q_EMIT interactiveMoveResizeFinished();
     }
     m_configureTimer->stop();
+    m_configureThrottled = false;
     qDeleteAll(m_configureEvents);
     m_configureEvents.clear();
     cleanTabBox();
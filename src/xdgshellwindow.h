@@ -101,6 +101,7 @@ private:
     std::optional<quint32> m_lastAcknowledgedConfigureSerial;
     QRectF m_windowGeometry;
     bool m_haveNextWindowGeometry = false;
+    bool m_configureThrottled = false;
 };
 
 class XdgToplevelConfigure final : public XdgSurfaceConfigure
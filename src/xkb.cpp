@@ -17,8 +17,16 @@
 // frameworks
 #include <KConfigGroup>
 // Qt
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
 #include <QKeyEvent>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QTemporaryFile>
+#include <QtConcurrentRun>
 #include <QtGui/private/qxkbcommon_p.h>
 // xkbcommon
 #include <xkbcommon/xkbcommon-compose.h>
@@ -113,10 +121,18 @@ Xkb::Xkb(bool followLocale1)
             locale = QByteArrayLiteral("C");
         }
 
-        m_compose.table = xkb_compose_table_new_from_locale(m_context, locale.constData(), XKB_COMPOSE_COMPILE_NO_FLAGS);
-        if (m_compose.table) {
-            m_compose.state = xkb_compose_state_new(m_compose.table, XKB_COMPOSE_STATE_NO_FLAGS);
-        }
+        // Parsing the compose file of the locale takes a while and isn't needed until the first
+        // key press, so it's done in a thread. The table gets its own context, as xkb contexts
+        // can't be shared between threads
+        m_compose.pendingTable = QtConcurrent::run([locale]() -> xkb_compose_table * {
+            xkb_context *context = xkb_context_new(KWIN_XKB_CONTEXT_FLAGS);
+            if (!context) {
+                return nullptr;
+            }
+            xkb_compose_table *table = xkb_compose_table_new_from_locale(context, locale.constData(), XKB_COMPOSE_COMPILE_NO_FLAGS);
+            xkb_context_unref(context);
+            return table;
+        });
     }
 
     if (m_followLocale1) {
@@ -132,6 +148,9 @@ Xkb::Xkb(bool followLocale1)
 
 Xkb::~Xkb()
 {
+    if (m_compose.pendingTable.isValid()) {
+        xkb_compose_table_unref(m_compose.pendingTable.result());
+    }
     xkb_compose_state_unref(m_compose.state);
     xkb_compose_table_unref(m_compose.table);
     xkb_state_unref(m_state);
@@ -231,7 +250,7 @@ xkb_keymap *Xkb::loadKeymapFromConfig()
 
     m_layoutList = QString::fromLatin1(ruleNames.layout).split(QLatin1Char(','));
 
-    return xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    return compileKeymap(ruleNames);
 }
 
 xkb_keymap *Xkb::loadDefaultKeymap()
@@ -239,7 +258,7 @@ xkb_keymap *Xkb::loadDefaultKeymap()
     xkb_rule_names ruleNames = {};
     applyEnvironmentRules(ruleNames);
     m_layoutList = QString::fromLatin1(ruleNames.layout).split(QLatin1Char(','));
-    return xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    return compileKeymap(ruleNames);
 }
 
 xkb_keymap *Xkb::loadKeymapFromLocale1()
@@ -256,7 +275,90 @@ xkb_keymap *Xkb::loadKeymapFromLocale1()
     };
     applyEnvironmentRules(ruleNames);
     m_layoutList = layouts.split(QLatin1Char(','));
-    return xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    return compileKeymap(ruleNames);
+}
+
+/**
+ * Compiling a keymap from the rule names means resolving the rules and parsing dozens of
+ * files from the xkb data directories. The resulting keymap is stored as a string in the
+ * cache, keyed by the rule names and the state of the data directories, loading it from
+ * there skips most of the work.
+ *
+ * Set KWIN_XKB_KEYMAP_CACHE=0 to disable the cache.
+ */
+xkb_keymap *Xkb::compileKeymap(const xkb_rule_names &ruleNames)
+{
+    static const bool cacheEnabled = qgetenv("KWIN_XKB_KEYMAP_CACHE") != QByteArrayLiteral("0");
+    if (!cacheEnabled) {
+        return xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const char *name : {ruleNames.rules, ruleNames.model, ruleNames.layout, ruleNames.variant, ruleNames.options}) {
+        hash.addData(QByteArrayView(name ? name : ""));
+        hash.addData(QByteArrayView("\0", 1));
+    }
+    // editing a data file in place doesn't change the modification time of its directory,
+    // so every file that the keymap could have been compiled from is taken into account
+    for (unsigned int i = 0; i < xkb_context_num_include_paths(m_context); ++i) {
+        const QString path = QFile::decodeName(xkb_context_include_path_get(m_context, i));
+        hash.addData(QFile::encodeName(path));
+        for (const char *directory : {"rules", "keycodes", "types", "compat", "symbols"}) {
+            QStringList files;
+            QDirIterator it(path + QLatin1Char('/') + QLatin1String(directory), QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+            while (it.hasNext()) {
+                it.next();
+                files.append(it.filePath() + QLatin1Char(':') + QString::number(it.fileInfo().lastModified().toMSecsSinceEpoch()));
+            }
+            // the order of the directory entries is unspecified
+            files.sort();
+            for (const QString &file : std::as_const(files)) {
+                hash.addData(QFile::encodeName(file));
+                hash.addData(QByteArrayView("\0", 1));
+            }
+        }
+    }
+
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/kwin/xkb");
+    const QString filePath = directory + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex());
+
+    QFile cached(filePath);
+    if (cached.open(QIODevice::ReadOnly)) {
+        const QByteArray contents = cached.readAll();
+        if (xkb_keymap *keymap = xkb_keymap_new_from_string(m_context, contents.constData(), XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS)) {
+            return keymap;
+        }
+        qCDebug(KWIN_XKB) << "Discarding invalid cached keymap" << filePath;
+        cached.remove();
+    }
+
+    xkb_keymap *keymap = xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    if (!keymap || !QDir().mkpath(directory)) {
+        return keymap;
+    }
+    UniqueCPtr<char> keymapString(xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1));
+    if (keymapString) {
+        QSaveFile file(filePath);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(keymapString.get());
+            file.commit();
+        }
+    }
+    return keymap;
+}
+
+void Xkb::ensureComposeState()
+{
+    if (!m_compose.pendingTable.isValid()) {
+        return;
+    }
+    // the table has usually been loaded long before the first key press, if not, wait for it
+    // rather than losing the compose sequence
+    m_compose.table = m_compose.pendingTable.result();
+    m_compose.pendingTable = QFuture<xkb_compose_table *>();
+    if (m_compose.table) {
+        m_compose.state = xkb_compose_state_new(m_compose.table, XKB_COMPOSE_STATE_NO_FLAGS);
+    }
 }
 
 void Xkb::updateKeymap(xkb_keymap *keymap)
@@ -389,6 +491,7 @@ void Xkb::updateKey(uint32_t key, InputRedirection::KeyboardKeyState state)
     }
     xkb_state_update_key(m_state, key + EVDEV_OFFSET, static_cast<xkb_key_direction>(state));
     if (state == InputRedirection::KeyboardKeyPressed) {
+        ensureComposeState();
         const auto sym = toKeysym(key);
         if (m_compose.state && xkb_compose_state_feed(m_compose.state, sym) == XKB_COMPOSE_FEED_ACCEPTED) {
             switch (xkb_compose_state_get_status(m_compose.state)) {
@@ -14,6 +14,7 @@
 
 #include <KConfigGroup>
 
+#include <QFuture>
 #include <QLoggingCategory>
 
 #include <optional>
@@ -120,6 +121,8 @@ private:
     xkb_keymap *loadKeymapFromConfig();
     xkb_keymap *loadDefaultKeymap();
     xkb_keymap *loadKeymapFromLocale1();
+    xkb_keymap *compileKeymap(const xkb_rule_names &ruleNames);
+    void ensureComposeState();
     void updateKeymap(xkb_keymap *keymap);
     void createKeymapFile();
     void updateModifiers();
@@ -144,6 +147,8 @@ private:
 
     struct
     {
+        // the compose table is loaded in a thread, it's picked up with the first key press
+        QFuture<xkb_compose_table *> pendingTable;
         xkb_compose_table *table = nullptr;
         xkb_compose_state *state = nullptr;
     } m_compose;
@@ -23,6 +23,8 @@
 #include <xcb/xfixes.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <xwayland_logging.h>
@@ -32,8 +34,22 @@ namespace KWin
 namespace Xwl
 {
 
-// in Bytes: equals 64KB
-static const uint32_t s_incrChunkSize = 63 * 1024;
+// in Bytes: the chunk size if the X server can't take larger requests
+static const uint32_t s_minIncrChunkSize = 63 * 1024;
+// in Bytes: larger chunks would mainly make the clients allocate large properties
+static const uint32_t s_maxIncrChunkSize = 1024 * 1024;
+
+/**
+ * Returns the size of the chunks of an incremental transfer. The less chunks, the less round
+ * trips to the requestor, so they are made as large as the X server's request limit allows.
+ */
+static uint32_t incrChunkSize()
+{
+    // the maximum request length is in 4 byte units, leave some room for the request itself
+    const uint64_t maxRequestSize = uint64_t(xcb_get_maximum_request_length(kwinApp()->x11Connection())) * 4;
+    const uint64_t maxDataSize = maxRequestSize > 1024 ? maxRequestSize - 1024 : 0;
+    return std::clamp<uint64_t>(maxDataSize, s_minIncrChunkSize, s_maxIncrChunkSize);
+}
 
 Transfer::Transfer(xcb_atom_t selection, qint32 fd, xcb_timestamp_t timestamp, QObject *parent)
     : QObject(parent)
@@ -41,6 +57,13 @@ Transfer::Transfer(xcb_atom_t selection, qint32 fd, xcb_timestamp_t timestamp, Q
     , m_fd(fd)
     , m_timestamp(timestamp)
 {
+    // The data is pumped on the main thread, a slow Wayland client must not block it.
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+#ifdef F_SETPIPE_SZ
+    // A pipe buffer that fits a whole chunk lets every wakeup move a chunk at once rather than
+    // the default 64 KiB. It's only a hint, the kernel caps it for unprivileged processes.
+    fcntl(m_fd, F_SETPIPE_SZ, s_maxIncrChunkSize);
+#endif
 }
 
 void Transfer::createSocketNotifier(QSocketNotifier::Type type)
@@ -83,6 +106,7 @@ TransferWltoX::TransferWltoX(xcb_atom_t selection, xcb_selection_request_event_t
                              qint32 fd, QObject *parent)
     : Transfer(selection, fd, 0, parent)
     , m_request(request)
+    , m_chunkSize(incrChunkSize())
 {
 }
 
@@ -134,7 +158,7 @@ void TransferWltoX::startIncr()
                                  XCB_CW_EVENT_MASK, mask);
 
     // spec says to make the available space larger
-    const uint32_t chunkSpace = 1024 + s_incrChunkSize;
+    const uint32_t chunkSpace = 1024 + m_chunkSize;
     xcb_change_property(xcbConn,
                         XCB_PROP_MODE_REPLACE,
                         m_request->requestor,
@@ -153,19 +177,22 @@ void TransferWltoX::startIncr()
 
 void TransferWltoX::readWlSource()
 {
-    if (m_chunks.size() == 0 || m_chunks.last().second == s_incrChunkSize) {
+    if (m_chunks.size() == 0 || m_chunks.last().second == m_chunkSize) {
         // append new chunk
         auto next = QPair<QByteArray, int>();
-        next.first.resize(s_incrChunkSize);
+        next.first.resize(m_chunkSize);
         next.second = 0;
         m_chunks.append(next);
     }
 
     const auto oldLen = m_chunks.last().second;
-    const auto avail = s_incrChunkSize - m_chunks.last().second;
+    const auto avail = m_chunkSize - m_chunks.last().second;
     Q_ASSERT(avail > 0);
 
     ssize_t readLen = read(fd(), m_chunks.last().first.data() + oldLen, avail);
+    if (readLen == -1 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
     if (readLen == -1) {
         qCWarning(KWIN_XWL) << "Error reading in Wl data.";
 
@@ -194,7 +221,7 @@ void TransferWltoX::readWlSource()
             Q_EMIT selectionNotify(m_request, true);
             endTransfer();
         }
-    } else if (m_chunks.last().second == s_incrChunkSize) {
+    } else if (m_chunks.last().second == m_chunkSize) {
         // first chunk full, but not yet at fd end -> go incremental
         if (incr()) {
             m_flushPropertyOnDelete = true;
@@ -206,6 +233,10 @@ void TransferWltoX::readWlSource()
             // starting incremental transfer
             startIncr();
         }
+        if (m_chunks.size() >= s_maxQueuedChunks) {
+            // the requestor is slower than the source, don't buffer the whole selection
+            socketNotifier()->setEnabled(false);
+        }
     }
     resetTimeout();
 }
@@ -250,6 +281,9 @@ void TransferWltoX::handlePropertyDelete()
             endTransfer();
         } else if (!m_chunks.isEmpty()) {
             flushSourceData();
+            if (socketNotifier() && !socketNotifier()->isEnabled()) {
+                socketNotifier()->setEnabled(true);
+            }
         }
     }
 }
@@ -374,10 +408,17 @@ void TransferXtoWl::getIncrChunk()
         // receive mechanism has not yet been setup
         return;
     }
+    if (socketNotifier()) {
+        // the previous chunk is still being written, fetch this one afterwards
+        m_incrChunkPending = true;
+        return;
+    }
     xcb_connection_t *xcbConn = kwinApp()->x11Connection();
 
+    // Deleting the property right away lets the source prepare the next chunk while this one
+    // is written to the Wayland client.
     auto cookie = xcb_get_property(xcbConn,
-                                   0,
+                                   1,
                                    m_window,
                                    atoms->wl_selection,
                                    XCB_GET_PROPERTY_TYPE_ANY,
@@ -446,6 +487,10 @@ void TransferXtoWl::dataSourceWrite()
     QByteArray property = m_receiver->data();
 
     ssize_t len = write(fd(), property.constData(), property.size());
+    if (len == -1 && (errno == EAGAIN || errno == EINTR)) {
+        // the pipe is full, wait until the client has read from it
+        len = 0;
+    }
     if (len == -1) {
         qCWarning(KWIN_XWL) << "X11 to Wayland write error on fd:" << fd();
         endTransfer();
@@ -457,11 +502,10 @@ void TransferXtoWl::dataSourceWrite()
         // property completely transferred
         if (incr()) {
             clearSocketNotifier();
-            xcb_connection_t *xcbConn = kwinApp()->x11Connection();
-            xcb_delete_property(xcbConn,
-                                m_window,
-                                atoms->wl_selection);
-            xcb_flush(xcbConn);
+            if (std::exchange(m_incrChunkPending, false)) {
+                getIncrChunk();
+                return;
+            }
         } else {
             // transfer complete
             endTransfer();
@@ -132,6 +132,9 @@ private:
     void handlePropertyDelete();
 
     xcb_selection_request_event_t *m_request = nullptr;
+    uint32_t m_chunkSize;
+    // how many chunks can be read from the source ahead of the requestor
+    static constexpr int s_maxQueuedChunks = 4;
 
     /* contains all received data portioned in chunks
      * TODO: explain second QPair component
@@ -190,6 +193,7 @@ private:
 
     xcb_window_t m_window;
     DataReceiver *m_receiver = nullptr;
+    bool m_incrChunkPending = false;
 
     Q_DISABLE_COPY(TransferXtoWl)
 };
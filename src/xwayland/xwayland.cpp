@@ -12,6 +12,7 @@
 
 #include <config-kwin.h>
 
+#include "atoms.h"
 #include "cursor.h"
 #include "databridge.h"
 #include "dnd.h"
@@ -43,6 +44,7 @@
 #include <QHostInfo>
 #include <QRandomGenerator>
 #include <QScopeGuard>
+#include <QSet>
 #include <QSocketNotifier>
 #include <QTimer>
 #include <QtConcurrentRun>
@@ -52,6 +54,7 @@
 #include <input_event.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <vector>
 #include <xkbcommon/xkbcommon-keysyms.h>
 
 namespace KWin
@@ -217,6 +220,13 @@ void Xwayland::init()
     qputenv("DISPLAY", m_launcher->displayName().toLatin1());
     qputenv("XAUTHORITY", m_launcher->xauthority().toLatin1());
     m_app->setProcessStartupEnvironment(env);
+
+    // Usually Xwayland is started when the first X11 client connects, which has to wait until
+    // the server is up and the window manager has been set up. Starting it right away hides that
+    // delay from the first X11 client, at the cost of running Xwayland even if it's not needed.
+    if (options->xwaylandPrestart()) {
+        m_launcher->start();
+    }
 }
 
 XwaylandLauncher *Xwayland::xwaylandLauncher() const
@@ -224,6 +234,61 @@ XwaylandLauncher *Xwayland::xwaylandLauncher() const
     return m_launcher;
 }
 
+static quint64 eventKey(xcb_window_t window, uint32_t detail)
+{
+    return (quint64(window) << 32) | detail;
+}
+
+static bool isCompressibleProperty(xcb_atom_t atom)
+{
+    // the handlers of these properties read the current value, they don't need every change
+    return atom == XCB_ATOM_WM_NAME
+        || atom == XCB_ATOM_WM_ICON_NAME
+        || atom == atoms->net_wm_name
+        || atom == atoms->net_wm_icon_name
+        || atom == atoms->net_wm_icon
+        || atom == atoms->net_wm_user_time;
+}
+
+/**
+ * Drops the events that are superseded by a later event in the same batch, i.e. the
+ * ConfigureNotify events of a window that is configured again, and the changes of a title or
+ * an icon that are followed by another change. The dropped events are freed and set to null.
+ */
+static void compressEvents(std::vector<xcb_generic_event_t *> &events)
+{
+    // walk backwards, so the last event of each kind is kept and the earlier ones are dropped
+    QSet<quint64> configuredWindows;
+    QSet<quint64> changedProperties;
+    for (auto it = events.rbegin(); it != events.rend(); ++it) {
+        xcb_generic_event_t *event = *it;
+        bool superseded = false;
+        switch (event->response_type) {
+        case XCB_CONFIGURE_NOTIFY: {
+            const auto configureEvent = reinterpret_cast<xcb_configure_notify_event_t *>(event);
+            // every ConfigureNotify carries the complete geometry and stacking position
+            superseded = configuredWindows.contains(eventKey(configureEvent->event, configureEvent->window));
+            configuredWindows.insert(eventKey(configureEvent->event, configureEvent->window));
+            break;
+        }
+        case XCB_PROPERTY_NOTIFY: {
+            const auto propertyEvent = reinterpret_cast<xcb_property_notify_event_t *>(event);
+            if (isCompressibleProperty(propertyEvent->atom)) {
+                superseded = changedProperties.contains(eventKey(propertyEvent->window, propertyEvent->atom));
+                changedProperties.insert(eventKey(propertyEvent->window, propertyEvent->atom));
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        if (superseded) {
+            free(event);
+            *it = nullptr;
+        }
+    }
+}
+
 void Xwayland::dispatchEvents(DispatchEventsMode mode)
 {
     xcb_connection_t *connection = kwinApp()->x11Connection();
@@ -241,10 +306,18 @@ void Xwayland::dispatchEvents(DispatchEventsMode mode)
 
     auto pollEventFunc = mode == DispatchEventsMode::Poll ? xcb_poll_for_event : xcb_poll_for_queued_event;
 
+    std::vector<xcb_generic_event_t *> events;
     while (xcb_generic_event_t *event = pollEventFunc(connection)) {
-        qintptr result = 0;
+        events.push_back(event);
+    }
+    compressEvents(events);
 
-        QAbstractEventDispatcher *dispatcher = QCoreApplication::eventDispatcher();
+    QAbstractEventDispatcher *dispatcher = QCoreApplication::eventDispatcher();
+    for (xcb_generic_event_t *event : events) {
+        if (!event) {
+            continue;
+        }
+        qintptr result = 0;
         dispatcher->filterNativeEvent(QByteArrayLiteral("xcb_generic_event_t"), event, &result);
         free(event);
     }
@@ -278,6 +278,9 @@ void XwaylandLauncher::handleXwaylandFinished(int exitCode, QProcess::ExitStatus
         if (++m_crashCount <= options->xwaylandMaxCrashCount()) {
             stop();
             m_resetCrashCountTimer->start(std::chrono::minutes(10));
+            if (options->xwaylandPrestart()) {
+                start();
+            }
         } else {
             qCWarning(KWIN_XWL, "Stopping Xwayland server because it has crashed %d times "
                                 "over the past 10 minutes",